@@ -462,6 +462,14 @@ namespace Ogre {
             global keyframe time list.
         */
         TimeIndex _getTimeIndex(Real timePos) const;
+
+        /** Internal method building the data apply otherwise builds on demand.
+        @remarks
+            This covers the base keyframe, the global keyframe time list and the
+            interpolation splines. Once done, the animation can be applied to
+            different skeletons from several threads at once, until it is modified.
+        */
+        void _buildApplyCaches(void);
         
         /** Sets a base keyframe which for the skeletal / pose keyframes 
             in this animation. 
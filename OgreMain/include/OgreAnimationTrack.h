@@ -384,6 +384,15 @@ namespace Ogre
         NodeAnimationTrack* _clone(Animation* newParent) const;
         
         void _applyBaseKeyFrame(const KeyFrame* base);
+
+        /** Internal method building the interpolation splines now if they are
+            out of date, rather than on demand from getInterpolatedKeyFrame.
+        */
+        void _buildInterpolationSplines(void) const
+        {
+            if (mSplineBuildNeeded)
+                buildInterpolationSplines();
+        }
         
     protected:
         /// Specialised keyframe creation
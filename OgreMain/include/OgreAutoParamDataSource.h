@@ -54,9 +54,31 @@ namespace Ogre {
         will calculate concatenated matrices etc only when required, passing back precalculated
         matrices when they are requested more than once when the underlying information has
         not altered.
+    @par
+        The inputs are also versioned by group, so GpuProgramParameters can tell whether the
+        auto constants it computed earlier are still current. Subclasses which override the
+        get methods to supply their own values must call _markChanged when those values change.
     */
     class _OgreExport AutoParamDataSource : public SceneMgtAlloc
     {
+    public:
+        /** Groups of inputs the values depend on.
+        @see getVersion
+        */
+        enum InputGroup
+        {
+            /// The camera, viewport and render target
+            IG_CAMERA = 0x1,
+            /// The light list and texture projectors
+            IG_LIGHTS = 0x2,
+            /// The current pass and pass number
+            IG_PASS = 0x4,
+            /// Ambient light, fog and other scene wide settings
+            IG_SCENE = 0x8,
+            IG_ALL = 0xF
+        };
+        static const size_t NUM_INPUT_GROUPS = 4;
+
     protected:
         const Light& getLight(size_t index) const;
         mutable Matrix4 mWorldMatrix[256];
@@ -121,8 +143,13 @@ namespace Ogre {
         const SceneManager* mCurrentSceneManager;
         const VisibleObjectsBoundsInfo* mMainCamBoundsInfo;
         const Pass* mCurrentPass;
+        bool mUseIdentityView;
+        bool mUseIdentityProjection;
 
         Light mBlankLight;
+
+        /// Latest version of each input group
+        uint64 mVersions[NUM_INPUT_GROUPS];
     public:
         AutoParamDataSource();
         virtual ~AutoParamDataSource();
@@ -149,6 +176,28 @@ namespace Ogre {
         /** Sets the current pass */
         virtual void setCurrentPass(const Pass* pass);
 
+        /** Gets the latest version of the given input groups.
+        @remarks
+            Versions are taken from a counter shared by all data sources, so they never
+            repeat. A value computed from the given inputs is still current as long as
+            this returns the same version as when it was computed.
+        @param inputs Combination of InputGroup flags
+        */
+        uint64 getVersion(uint16 inputs) const
+        {
+            uint64 version = 0;
+            for (size_t i = 0; i < NUM_INPUT_GROUPS; ++i)
+            {
+                if ((inputs & (1 << i)) && mVersions[i] > version)
+                    version = mVersions[i];
+            }
+            return version;
+        }
+        /** Marks the given input groups as changed.
+        @param inputs Combination of InputGroup flags
+        */
+        void _markChanged(uint16 inputs);
+
 		/** Returns the current bounded camera */
 		const Camera* getCurrentCamera() const;
 
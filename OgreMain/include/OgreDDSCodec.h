@@ -39,15 +39,13 @@ namespace Ogre {
     *  @{
     */
 
-    // Forward declarations
-    struct DXTColourBlock;
-    struct DXTExplicitAlphaBlock;
-    struct DXTInterpolatedAlphaBlock;
-
     /** Codec specialized in loading DDS (Direct Draw Surface) images.
     @remarks
         We implement our own codec here since we need to be able to keep DXT
         data compressed if the card supports it.
+    @par
+        Images in PF_DXT1, PF_DXT3, PF_DXT5, PF_BC4_UNORM or PF_BC5_UNORM
+        are saved compressed, see compress for making them.
     */
     class _OgreExport DDSCodec : public ImageCodec
     {
@@ -62,13 +60,6 @@ namespace Ogre {
         PixelFormat convertPixelFormat(uint32 rgbBits, uint32 rMask,
             uint32 gMask, uint32 bMask, uint32 aMask) const;
 
-        /// Unpack DXT colours into array of 16 colour values
-        void unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, ColourValue* pCol) const;
-        /// Unpack DXT alphas into array of 16 colour values
-        void unpackDXTAlpha(const DXTExplicitAlphaBlock& block, ColourValue* pCol) const;
-        /// Unpack DXT alphas into array of 16 colour values
-        void unpackDXTAlpha(const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const;
-
         /// Single registered codec instance
         static DDSCodec* msInstance;
     public:
@@ -91,6 +82,29 @@ namespace Ogre {
         /// Static method to shutdown and unregister the DDS codec
         static void shutdown(void);
 
+        /** Decompresses block compressed pixels.
+        @remarks
+            Used by decode when the render system can't take the compressed
+            data. Large images are split by rows of blocks over the threads
+            of the Root's TaskScheduler, if there is a Root.
+        @param src Pixels in PF_DXT1 to PF_DXT5, PF_BC4_UNORM or PF_BC5_UNORM,
+            the whole box starting at the first block
+        @param dst Box of the same size in any uncompressed format. BC4 and
+            BC5 decompress to red and red and green.
+        */
+        static void decompress(const PixelBox& src, const PixelBox& dst);
+
+        /** Compresses pixels to blocks, e.g. to save a texture as DXT.
+        @remarks
+            Threaded like decompress. Colours are fitted along their principal
+            axis, alpha and the BC4 and BC5 channels between their extremes.
+            With PF_DXT1, texels with less than half alpha become transparent.
+        @param src Pixels in any uncompressed format
+        @param dst Box of the same size in PF_DXT1, PF_DXT3, PF_DXT5,
+            PF_BC4_UNORM or PF_BC5_UNORM, the whole box starting at the first block
+        */
+        static void compress(const PixelBox& src, const PixelBox& dst);
+
     };
     /** @} */
     /** @} */
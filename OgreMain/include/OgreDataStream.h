@@ -298,6 +298,16 @@ namespace Ogre {
         */
         size_t size(void) const { return mSize; }
 
+        /** Returns a pointer to the data at the current position if the whole
+            stream is held in memory, or 0 if it isn't.
+        @remarks
+            Consumers which need the stream contents as a single block can
+            parse them in place through this, rather than buffering the stream
+            into a MemoryDataStream first. The pointer stays valid until the
+            stream is closed and covers size() - tell() bytes.
+        */
+        virtual const uchar* getCurrentMemoryPtr(void) const { return 0; }
+
         /** Close the stream; this makes further operations invalid. */
         virtual void close(void) = 0;
         
@@ -434,6 +444,10 @@ namespace Ogre {
         
         /** Get a pointer to the current position in the memory block this stream holds. */
         uchar* getCurrentPtr(void) { return mPos; }
+
+        /** @copydoc DataStream::getCurrentMemoryPtr
+        */
+        const uchar* getCurrentMemoryPtr(void) const { return mPos; }
         
         /** @copydoc DataStream::read
         */
@@ -475,6 +489,59 @@ namespace Ogre {
         void setFreeOnClose(bool free) { mFreeOnClose = free; }
     };
 
+    /** Common subclass of MemoryDataStream for read-only files mapped into memory.
+    @remarks
+        The file contents are paged in by the OS as they are read, so the data
+        can be parsed in place through getPtr() or getCurrentMemoryPtr()
+        without ever being copied into a heap buffer. The file must not be
+        truncated by anyone while it is mapped.
+    @par
+        Mapping is only available where isSupported() returns true, currently
+        on the POSIX platforms.
+    */
+    class _OgreExport MappedFileDataStream : public MemoryDataStream
+    {
+    public:
+        /** Map a file into memory.
+        @param name The name to give the stream
+        @param path The path of the file to map
+        */
+        MappedFileDataStream(const String& name, const String& path);
+
+        ~MappedFileDataStream();
+
+        /** @copydoc DataStream::close
+        */
+        void close(void);
+
+        /** Returns whether files can be mapped on this platform. */
+        static bool isSupported(void);
+    };
+
+    /** Common subclass of MemoryDataStream for a range of another stream's memory.
+    @remarks
+        Lets part of a memory-resident stream, e.g. a MappedFileDataStream, be
+        handed out as a stream of its own without copying it. The view keeps
+        the source stream open until it is closed itself.
+    */
+    class _OgreExport StreamViewDataStream : public MemoryDataStream
+    {
+    public:
+        /** Wrap a range of a stream's memory.
+        @param source The stream which owns the memory
+        @param data The start of the range, within the source's memory
+        @param size The size of the range in bytes
+        */
+        StreamViewDataStream(const DataStreamPtr& source, const uchar* data, size_t size);
+
+        /** @copydoc DataStream::close
+        */
+        void close(void);
+
+    private:
+        DataStreamPtr mSource;
+    };
+
     /** Common subclass of DataStream for handling data from 
         std::basic_istream.
     */
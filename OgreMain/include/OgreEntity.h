@@ -180,8 +180,21 @@ namespace Ogre {
         /// Records the last frame in which animation was updated.
         unsigned long mFrameAnimationLastUpdated;
 
-        /// Perform all the updates required for an animated entity.
-        void updateAnimation(void);
+        /** Perform all the updates required for an animated entity.
+        @param allowDeferredSkinning
+            Whether the skeleton and software skinning updates may be queued with the
+            SceneManager, see SceneManager::setParallelSoftwareSkinningEnabled.
+        */
+        void updateAnimation(bool allowDeferredSkinning = false);
+
+        /** Software blends queued with the SceneManager, by their index in its batch
+            and the sub entity they're for, or NULL for the shared geometry.
+        */
+        typedef vector<std::pair<size_t, SubEntity*> >::type QueuedSoftwareBlendList;
+        QueuedSoftwareBlendList mQueuedSoftwareBlends;
+
+        /// Checks out the software skinning buffers and queues the blends with the SceneManager
+        void queueSoftwareSkinning(bool blendNormals);
 
         /// Records the last frame in which the bones was updated.
         /// It's a pointer because it can be shared between different entities with
@@ -742,6 +755,17 @@ namespace Ogre {
         */
         void _updateAnimation(void);
 
+        /** Internal method performing the skinning queued with the SceneManager.
+        @remarks
+            Updates the skeleton and performs the queued blends of the batch, which
+            the SceneManager has locked. May be called from a worker thread, along
+            with other entities which don't share a skeleton with this one.
+        */
+        void _updateQueuedSoftwareSkinning(const SoftwareVertexBlendBatch& batch);
+
+        /** Whether the skinning of this entity is queued with the SceneManager. */
+        bool _isSoftwareSkinningQueued(void) const { return !mQueuedSoftwareBlends.empty(); }
+
         /** Tests if any animation applied to this entity.
         @remarks
             An entity is animated if any animation state is enabled, or any manual bone
@@ -120,7 +120,27 @@ namespace Ogre {
             return msIgnoreHidden;
         }
 
+        /** Set whether files opened read-only are mapped into memory.
+        @remarks
+            Mapped streams let consumers parse the data in place rather than
+            copying it into a buffer first, see MappedFileDataStream. Only
+            used where MappedFileDataStream::isSupported. Files must not be
+            truncated while they are open; turn this off if your files may be
+            rewritten under a running application. The default is true.
+        */
+        static void setUseMemoryMapping(bool use)
+        {
+            msUseMemoryMapping = use;
+        }
+
+        /// Get whether files opened read-only are mapped into memory.
+        static bool getUseMemoryMapping()
+        {
+            return msUseMemoryMapping;
+        }
+
         static bool msIgnoreHidden;
+        static bool msUseMemoryMapping;
     };
 
     /** Specialisation of ArchiveFactory for FileSystem files. */
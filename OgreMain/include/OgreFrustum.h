@@ -471,6 +471,27 @@ namespace Ogre
         */
         virtual bool isVisible(const Vector3& vert, FrustumPlane* culledBy = 0) const;
 
+        /** Tests whether the given boxes are visible in the Frustum.
+        @remarks
+            Gives the same results as testing each box with
+            isVisible(const AxisAlignedBox&, FrustumPlane*), but tests many
+            boxes at once using OptimisedUtil::calculateBoxVisibility. Null and
+            infinite boxes can't be expressed and must be handled by the caller.
+        @param centres
+            Box centres (world space), packed in (x, y, z) format.
+        @param halfSizes
+            Box half sizes, packed in (x, y, z) format.
+        @param numBoxes
+            Number of boxes to test.
+        @param visibility
+            An array of (numBoxes + 31) / 32 words, bit (i % 32) of word (i / 32)
+            will be set if box i is visible.
+        @return
+            @c true if any of the boxes is visible.
+        */
+        virtual bool isVisible(const float* centres, const float* halfSizes,
+            size_t numBoxes, uint32* visibility) const;
+
         /// Overridden from MovableObject::getTypeFlags
         uint32 getTypeFlags(void) const;
 
@@ -471,6 +471,53 @@ namespace Ogre {
     };
     typedef map<String, GpuConstantDefinition>::type GpuConstantDefinitionMap;
     typedef ConstMapIterator<GpuConstantDefinitionMap> GpuConstantDefinitionIterator;
+    /** Handle of an interned constant name, @see GpuNamedConstants::getConstantHandle.
+        @remarks
+        Names are interned once for the whole application, so the same handle can
+        be used with the parameters of every program which has a constant of that name.
+    */
+    typedef uint32 GpuConstantHandle;
+
+    /** Map of constant definitions which keeps a hashed index of its entries,
+        by name and by handle, up to date as entries are added and removed.
+        @note
+        Entries must be added and removed through this class rather than
+        through a reference to the base map, which the index doesn't see.
+    */
+    class _OgreExport GpuConstantDefinitionIndexedMap : public GpuConstantDefinitionMap
+    {
+    public:
+        GpuConstantDefinitionIndexedMap() {}
+        /// Copies the entries, indexing the copies
+        GpuConstantDefinitionIndexedMap(const GpuConstantDefinitionIndexedMap& rhs);
+        GpuConstantDefinitionIndexedMap& operator=(const GpuConstantDefinitionIndexedMap& rhs);
+
+        /// @copydoc std::map::insert
+        std::pair<iterator, bool> insert(const value_type& val);
+        /// Gets the entry of a name, adding a default one if there's none
+        GpuConstantDefinition& operator[](const String& name);
+        /// @copydoc std::map::erase
+        void erase(iterator i);
+        /// @copydoc std::map::erase
+        size_type erase(const String& name);
+        /// @copydoc std::map::clear
+        void clear(void);
+
+        /// Finds the definition of a name through the index, or returns null
+        const GpuConstantDefinition* findIndexed(const String& name) const;
+        /// Finds the definition of a handle through the index, or returns null
+        const GpuConstantDefinition* findIndexed(GpuConstantHandle handle) const;
+
+    protected:
+        void addToIndex(const value_type& val);
+        void rebuildIndex(void);
+
+        typedef OGRE_HashMap<String, const GpuConstantDefinition*> NameIndex;
+        typedef OGRE_HashMap<GpuConstantHandle, const GpuConstantDefinition*> HandleIndex;
+        /// Entries of the map by name and by handle
+        NameIndex mNameIndex;
+        HandleIndex mHandleIndex;
+    };
 
     /// Struct collecting together the information for named constants.
     struct _OgreExport GpuNamedConstants : public GpuParamsAlloc
@@ -486,11 +533,31 @@ namespace Ogre {
         /// Total size of the bool buffer required
         // size_t boolBufferSize;
         /// Map of parameter names to GpuConstantDefinition
-        GpuConstantDefinitionMap map;
+        GpuConstantDefinitionIndexedMap map;
 
     GpuNamedConstants() : floatBufferSize(0), doubleBufferSize(0),
             intBufferSize(0), uintBufferSize(0) {  } //boolBufferSize(0) {}
 
+        /** Finds the definition of a constant, or returns null if there is none.
+            @remarks
+            The lookup goes through the hashed index of the map rather than the
+            map itself. It only reads, so may be done from several threads as
+            long as the map isn't changed meanwhile.
+        */
+        const GpuConstantDefinition* findConstantDefinition(const String& name) const;
+        /// @copydoc GpuNamedConstants::findConstantDefinition(const String&) const
+        const GpuConstantDefinition* findConstantDefinition(GpuConstantHandle handle) const;
+
+        /** Gets the handle of a constant name, interning the name if it's new.
+            @remarks
+            Looking a constant up by handle avoids hashing and comparing its name,
+            so resolve the names you set often once and keep their handles around.
+            Handles stay valid for the lifetime of the application.
+        */
+        static GpuConstantHandle getConstantHandle(const String& name);
+        /// Gets the name a handle was created from
+        static const String& getConstantName(GpuConstantHandle handle);
+
         /** Generate additional constant entries for arrays based on a base definition.
             @remarks
             Array uniforms will be added just with their base name with no array
@@ -1481,16 +1548,21 @@ namespace Ogre {
             };
             /// The variability of this parameter (see GpuParamVariability)
             uint16 variability;
+            /** The inputs of the data source this parameter depends on (see
+                AutoParamDataSource::InputGroup), 0 if it has to be updated every time */
+            uint16 inputs;
+            /// The version of the inputs the current value was computed from
+            uint64 version;
 
         AutoConstantEntry(AutoConstantType theType, size_t theIndex, size_t theData,
                           uint16 theVariability, size_t theElemCount = 4)
             : paramType(theType), physicalIndex(theIndex), elementCount(theElemCount),
-                data(theData), variability(theVariability) {}
+                data(theData), variability(theVariability), inputs(0), version(0) {}
 
         AutoConstantEntry(AutoConstantType theType, size_t theIndex, Real theData,
                           uint16 theVariability, size_t theElemCount = 4)
             : paramType(theType), physicalIndex(theIndex), elementCount(theElemCount),
-                fData(theData), variability(theVariability) {}
+                fData(theData), variability(theVariability), inputs(0), version(0) {}
 
         };
         // Auto parameter storage
@@ -1563,6 +1635,8 @@ namespace Ogre {
 
         /// Return the variability for an auto constant
         uint16 deriveVariability(AutoConstantType act);
+        /// Return the data source inputs an auto constant depends on
+        static uint16 deriveInputs(AutoConstantType act);
 
         void copySharedParamSetUsage(const GpuSharedParamUsageList& srcList);
 
@@ -2100,6 +2174,9 @@ namespace Ogre {
         const AutoConstantEntry* _findRawAutoConstantEntryBool(size_t physicalIndex) const;
 
         /** Update automatic parameters.
+            @remarks
+            Autos whose inputs haven't changed since they were last updated from the
+            same source are skipped, see AutoParamDataSource::getVersion.
             @param source The source of the parameters
             @param variabilityMask A mask of GpuParamVariability which identifies which autos will need updating
         */
@@ -2298,6 +2375,41 @@ namespace Ogre {
         */
         void setNamedConstant(const String& name, const uint *val, size_t count,
                               size_t multiple = 4);
+
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, Real val)
+            @remarks
+            The handle versions skip looking the name up,
+            @see GpuNamedConstants::getConstantHandle.
+        */
+        void setNamedConstant(GpuConstantHandle handle, Real val);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, int val) */
+        void setNamedConstant(GpuConstantHandle handle, int val);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, uint val) */
+        void setNamedConstant(GpuConstantHandle handle, uint val);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const Vector4& vec) */
+        void setNamedConstant(GpuConstantHandle handle, const Vector4& vec);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const Vector3& vec) */
+        void setNamedConstant(GpuConstantHandle handle, const Vector3& vec);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const Vector2& vec) */
+        void setNamedConstant(GpuConstantHandle handle, const Vector2& vec);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const Matrix4& m) */
+        void setNamedConstant(GpuConstantHandle handle, const Matrix4& m);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const Matrix4* m, size_t numEntries) */
+        void setNamedConstant(GpuConstantHandle handle, const Matrix4* m, size_t numEntries);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const ColourValue& colour) */
+        void setNamedConstant(GpuConstantHandle handle, const ColourValue& colour);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const float *val, size_t count, size_t multiple) */
+        void setNamedConstant(GpuConstantHandle handle, const float *val, size_t count,
+                              size_t multiple = 4);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const double *val, size_t count, size_t multiple) */
+        void setNamedConstant(GpuConstantHandle handle, const double *val, size_t count,
+                              size_t multiple = 4);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const int *val, size_t count, size_t multiple) */
+        void setNamedConstant(GpuConstantHandle handle, const int *val, size_t count,
+                              size_t multiple = 4);
+        /** @copydoc GpuProgramParameters::setNamedConstant(const String& name, const uint *val, size_t count, size_t multiple) */
+        void setNamedConstant(GpuConstantHandle handle, const uint *val, size_t count,
+                              size_t multiple = 4);
         // Sets a multiple value constant boolean parameter to the program.
         //     @par
         //     Some systems only allow constants to be set on certain boundaries,
@@ -2373,6 +2485,11 @@ namespace Ogre {
         */
         const GpuConstantDefinition* _findNamedConstantDefinition(
             const String& name, bool throwExceptionIfMissing = false) const;
+        /** Find a constant definition by the handle of its name.
+            @see _findNamedConstantDefinition(const String&, bool) const
+        */
+        const GpuConstantDefinition* _findNamedConstantDefinition(
+            GpuConstantHandle handle, bool throwExceptionIfMissing = false) const;
         /** Gets the physical buffer index associated with a logical float constant index.
             @note Only applicable to low-level programs.
             @param logicalIndex The logical parameter index
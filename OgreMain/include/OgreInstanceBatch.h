@@ -118,6 +118,8 @@ namespace Ogre
         Real                mBoundingRadius;
         bool                mBoundsDirty;
         bool                mBoundsUpdated; //Set to false by derived classes that need it
+        /// Instances may be moved from several threads, see SceneManager::setNumWorkerThreads
+        OGRE_MUTEX(mBoundsDirtyMutex);
         Camera              *mCurrentCamera;
 
         unsigned short      mMaterialLodIndex;
@@ -0,0 +1,149 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OGRE_MAPPED_ZIP_H__
+#define __OGRE_MAPPED_ZIP_H__
+
+#if OGRE_NO_ZIP_ARCHIVE == 0
+
+#include "OgrePrerequisites.h"
+#include "OgreArchive.h"
+#include "OgreHeaderPrefix.h"
+#include "Threading/OgreThreadHeaders.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Zip archive which reads the archive through a memory mapping of it.
+    @remarks
+        The central directory is parsed once on load into a hash index, so
+        opening a file doesn't search the archive. Stored (uncompressed)
+        entries are opened as streams over the mapping, so they are never
+        copied and their data can be parsed in place. Deflated entries are
+        inflated in one go into a buffer of their uncompressed size, which
+        makes their streams seekable at no cost.
+    @par
+        Only the zip features used by asset archives are supported: the
+        stored and deflate methods, without encryption or zip64 extensions.
+        Files can be opened from several threads at once.
+    @par
+        ZipArchiveFactory creates these rather than the zziplib based
+        ZipArchive where MappedFileDataStream::isSupported, see
+        ZipArchive::setUseMemoryMapping.
+    */
+    class _OgreExport MappedZipArchive : public Archive
+    {
+    public:
+        MappedZipArchive(const String& name, const String& archType);
+        ~MappedZipArchive();
+        /// @copydoc Archive::isCaseSensitive
+        bool isCaseSensitive(void) const { return OGRE_RESOURCEMANAGER_STRICT; }
+
+        /// @copydoc Archive::load
+        void load();
+        /// @copydoc Archive::unload
+        void unload();
+
+        /// @copydoc Archive::open
+        DataStreamPtr open(const String& filename, bool readOnly = true) const;
+
+        /// @copydoc Archive::create
+        DataStreamPtr create(const String& filename);
+
+        /// @copydoc Archive::remove
+        void remove(const String& filename);
+
+        /// @copydoc Archive::list
+        StringVectorPtr list(bool recursive = true, bool dirs = false) const;
+
+        /// @copydoc Archive::listFileInfo
+        FileInfoListPtr listFileInfo(bool recursive = true, bool dirs = false) const;
+
+        /// @copydoc Archive::find
+        StringVectorPtr find(const String& pattern, bool recursive = true,
+            bool dirs = false) const;
+
+        /// @copydoc Archive::findFileInfo
+        FileInfoListPtr findFileInfo(const String& pattern, bool recursive = true,
+            bool dirs = false) const;
+
+        /// @copydoc Archive::exists
+        bool exists(const String& filename) const;
+
+        /// @copydoc Archive::getModifiedTime
+        time_t getModifiedTime(const String& filename) const;
+
+    protected:
+        /// Where to find an entry's data, from the central directory
+        struct Entry
+        {
+            /// Offset of the local file header
+            size_t headerOffset;
+            size_t compressedSize;
+            size_t uncompressedSize;
+            uint16 method;
+            uint16 flags;
+        };
+        typedef vector<Entry>::type EntryList;
+        /// Lookup name to position in mFileList and mEntries
+        typedef OGRE_HashMap<String, size_t> EntryIndex;
+
+        /// The mapped archive, shared with the streams over stored entries
+        DataStreamPtr mMapping;
+        /// File list, in the order of the central directory
+        FileInfoList mFileList;
+        /// The entry for each item of mFileList
+        EntryList mEntries;
+        EntryIndex mIndex;
+
+        OGRE_AUTO_MUTEX;
+
+        /// Reads the central directory into mFileList, mEntries and mIndex
+        void readCentralDirectory(void);
+        /// Adds the lookup names of the entries to mIndex
+        void buildIndex(void);
+        /// Finds the position of an entry, returns false if there is no such entry
+        bool findEntry(const String& filename, size_t& index) const;
+        /// Throws about a corrupt archive
+        void corrupted(const String& reason) const;
+    };
+
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
+
+#endif
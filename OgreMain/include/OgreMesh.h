@@ -93,6 +93,8 @@ namespace Ogre {
         friend class MeshSerializerImpl_v1_3;
         friend class MeshSerializerImpl_v1_2;
         friend class MeshSerializerImpl_v1_1;
+        friend class MeshCacheSerializer;
+        friend class MeshManager;
 
     public:
         typedef vector<Real>::type LodValueList;
@@ -128,6 +130,17 @@ namespace Ogre {
 
         DataStreamPtr mFreshFromDisk;
 
+        /// Checksum of the file the mesh was prepared from, for the mesh cache
+        uint64 mSourceChecksum[2];
+        /// Modification time of that file, zero if unknown
+        int64 mSourceTime;
+        /// Whether mSourceChecksum is known, i.e. the mesh cache was enabled when preparing
+        bool mSourceChecksumValid;
+        /// Whether to write the mesh to the cache once it's loaded
+        bool mWriteToMeshCache;
+        /// Whether mFreshFromDisk is a mesh cache entry rather than a .mesh file
+        bool mReadFromMeshCache;
+
         SubMeshNameMap mSubMeshNameMap ;
 
         /// Local bounding box volume.
@@ -795,6 +808,7 @@ namespace Ogre {
             as a hint for optimisation.
         @param blendNormals
             If @c true, normals are blended as well as positions.
+        @see SoftwareVertexBlendBatch for performing many blends at once.
         */
         static void softwareVertexBlend(const VertexData* sourceVertexData, 
             const VertexData* targetVertexData,
@@ -1013,6 +1027,100 @@ namespace Ogre {
         MeshLodUsage() : userValue(0.0), value(0.0), edgeData(0) {}
     };
 
+    /** A set of software vertex blends sharing one lock of their buffers.
+    @remarks
+        Mesh::softwareVertexBlend locks and unlocks the buffers of every
+        blend, which has to happen on the thread owning the render system.
+        This class splits that up: the blends are added and their buffers
+        locked on that thread, each buffer only once even when it is shared
+        by several blends (e.g. the source data of entities using the same
+        mesh), after which the blends themselves may run on any number of
+        threads at once. Unlocking, and so uploading the results, happens
+        on the first thread again.
+    */
+    class _OgreExport SoftwareVertexBlendBatch : public AnimationAlloc
+    {
+    public:
+        SoftwareVertexBlendBatch();
+        ~SoftwareVertexBlendBatch();
+
+        /** Adds a blend, see Mesh::softwareVertexBlend for the parameters.
+        @note
+            Must not be called while the batch is locked.
+        @return
+            The index to pass to blend.
+        */
+        size_t addBlend(const VertexData* sourceVertexData,
+            const VertexData* targetVertexData, bool blendNormals);
+
+        /** Gets the number of blends added since the batch was last cleared. */
+        size_t getNumBlends(void) const { return mBlends.size(); }
+
+        /** Locks the buffers of all the blends. */
+        void lock(void);
+
+        /** Performs a blend of a locked batch.
+        @remarks
+            Different blends may be performed concurrently, as long as their
+            targets don't overlap.
+        @param index
+            The index returned by addBlend.
+        @param blendMatrices
+            Pointer to an array of matrix pointers to be used to blend,
+            indexed by blend indices in the source vertex data.
+        */
+        void blend(size_t index, const Matrix4* const* blendMatrices) const;
+
+        /** Unlocks the buffers and removes all the blends. */
+        void unlock(void);
+
+        /** Removes all the blends, unlocking the buffers if they are locked. */
+        void clear(void);
+
+        /** Whether the buffers are currently locked. */
+        bool isLocked(void) const { return mLocked; }
+
+    protected:
+        struct LockedBuffer
+        {
+            HardwareVertexBufferSharedPtr buffer;
+            HardwareBuffer::LockOptions options;
+            unsigned char* data;
+        };
+        typedef vector<LockedBuffer>::type LockedBufferList;
+        typedef map<HardwareVertexBuffer*, size_t>::type LockedBufferIndexMap;
+
+        /// A stream of a blend, as an offset into one of the locked buffers
+        struct Stream
+        {
+            size_t buffer;
+            size_t offset;
+            size_t stride;
+        };
+        struct Blend
+        {
+            Stream srcPos, srcNorm, blendIdx, blendWeight, destPos, destNorm;
+            unsigned short numWeightsPerVertex;
+            bool includeNormals;
+            size_t vertexCount;
+        };
+        typedef vector<Blend>::type BlendList;
+
+        /// Adds a stream reading the element from the buffer, locked with the given options
+        Stream addStream(const HardwareVertexBufferSharedPtr& buffer,
+            const VertexElement* elem, HardwareBuffer::LockOptions options);
+        /// Gets the address of the first element of a stream, once locked
+        float* getStreamPointer(const Stream& stream) const
+        {
+            return reinterpret_cast<float*>(mBuffers[stream.buffer].data + stream.offset);
+        }
+
+        LockedBufferList mBuffers;
+        LockedBufferIndexMap mBufferIndices;
+        BlendList mBlends;
+        bool mLocked;
+    };
+
     /** @} */
     /** @} */
 
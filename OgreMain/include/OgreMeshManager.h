@@ -409,6 +409,67 @@ namespace Ogre {
         */
         MeshSerializerListener *getListener();
 
+        /** Sets a directory to cache loaded meshes in, so they load faster the
+            next time.
+        @remarks
+            Meshes loaded from a file are written to the directory once they
+            are loaded, with their edge lists, before they are prepared for
+            shadow volumes. Entries hold the mesh as laid out in memory: the
+            vertex declarations, the raw bytes of the vertex and index buffers
+            and the edge lists and bone assignments as arrays. Later loads of
+            the same file map the entry and upload the buffers straight from
+            it, which skips parsing the file, upgrading older formats and
+            building edge lists. Entries are only meant for the machine and
+            build which wrote them.
+        @par
+            The buffers are read from their shadow buffers, hardware buffers
+            are never read back. Meshes with buffers that have neither a
+            shadow buffer nor system memory aren't cached, see
+            Mesh::setVertexBufferPolicy and Mesh::setIndexBufferPolicy.
+        @par
+            Entries are keyed by the checksum of the file they were made from
+            and the OGRE version, otherwise they are replaced. While the
+            modification time of the file matches the one recorded, the file
+            isn't read at all. The directory is created if it doesn't exist.
+            An empty path, the default, disables the cache.
+        @note
+            The listener set through setListener is called for cache entries
+            too, which it has processed once already.
+        */
+        void setMeshCacheDirectory(const String& path);
+
+        /** Gets the directory meshes are cached in, empty if the cache is disabled. */
+        const String& getMeshCacheDirectory(void) const { return mMeshCacheDirectory; }
+
+        /** Writes a mesh to the cache as it is now.
+        @remarks
+            Meshes are cached as they are after loading. Use this after
+            processing one further, e.g. generating LOD levels or tangents, so
+            the next load gets the result without the work. Only meshes loaded
+            from a file while the cache was enabled can be cached.
+        */
+        void updateMeshCache(const MeshPtr& mesh);
+
+        /** Internal method which opens the cache entry of a mesh if it was made
+            from a file with the current modification time.
+        @return The mesh data of the entry, or a null pointer
+        */
+        DataStreamPtr _openMeshCache(Mesh* mesh);
+
+        /** Internal method which opens the cache entry of a mesh if it was made
+            from the same data.
+        @param mesh The mesh being prepared
+        @param source The file the mesh is prepared from, in memory
+        @return The mesh data of the entry, or a null pointer
+        */
+        DataStreamPtr _openMeshCache(Mesh* mesh, const DataStreamPtr& source);
+
+        /** Internal method which writes a loaded mesh to the cache.
+        @remarks
+            Failures are logged, they don't affect the mesh.
+        */
+        void _writeMeshCache(const Mesh* mesh);
+
         /** @see ManualResourceLoader::loadResource */
         void loadResource(Resource* res);
 
@@ -428,6 +489,13 @@ namespace Ogre {
         void createPrefabPlane(void);
         void createPrefabCube(void);
         void createPrefabSphere(void);
+
+        /** Gets the path of the cache entry of a mesh. */
+        String getMeshCachePath(const String& name, const String& group) const;
+        /** Opens the cache entry of a mesh, positioned at the mesh data.
+        @return A null pointer if there is no valid entry
+        */
+        DataStreamPtr openMeshCacheEntry(const Mesh* mesh, uint64 checksum[2], int64& sourceTime);
     
         /** Enum identifying the types of manual mesh built by this manager */
         enum MeshBuildType
@@ -476,6 +544,9 @@ namespace Ogre {
 
         // The listener to pass to serializers
         MeshSerializerListener *mListener;
+
+        /// See setMeshCacheDirectory, empty when disabled
+        String mMeshCacheDirectory;
     };
 
     /** @} */
@@ -156,6 +156,15 @@ namespace Ogre {
         virtual void readMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readSubMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh, 
             SubMesh* sub);
+        /** Reads the assignment of the chunk just entered along with all directly
+            following chunks of the same type, a block at a time.
+        @remarks
+            Exporters write one chunk per assignment, sorted by vertex, so meshes
+            carry long runs of them. Reading those one field at a time and
+            inserting them without a hint was a large part of the load time.
+        */
+        void readBoneAssignments(DataStreamPtr& stream, unsigned short chunkID,
+            multimap<size_t, VertexBoneAssignment>::type& assignments);
         virtual void readMeshLodLevel(DataStreamPtr& stream, Mesh* pMesh);
 #if !OGRE_NO_MESHLOD
         virtual void readMeshLodUsageManual(DataStreamPtr& stream, Mesh* pMesh, unsigned short lodNum, MeshLodUsage& usage);
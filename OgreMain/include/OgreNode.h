@@ -201,6 +201,24 @@ namespace Ogre {
         */
         virtual void updateFromParentImpl(void) const;
 
+        /** Class-specific implementation of the deferred update callback.
+        @remarks
+            Called on the main thread by processDeferredUpdates for every node which
+            queued itself with queueDeferredUpdate while the scene graph was being
+            updated in parallel, for the work which couldn't be done on the worker
+            thread. The default implementation does nothing; the
+            Listener::nodeUpdated event skipped on the worker thread is raised
+            separately, and only if the node was actually updated.
+        */
+        virtual void deferredUpdateImpl(void);
+
+        /** Queues this node for a deferred update callback on the main thread.
+        @remarks
+            Only valid while deferred update callbacks are enabled, may be called
+            from any worker thread. The node is queued at most once.
+        */
+        void queueDeferredUpdate(void) const;
+
 
         /** Internal method for creating a new child node - must be overridden per subclass. */
         virtual Node* createChildImpl(void) = 0;
@@ -225,6 +243,22 @@ namespace Ogre {
         typedef vector<Node*>::type QueuedUpdates;
         static QueuedUpdates msQueuedUpdates;
 
+        /// Flag indicating that the node has been queued for a deferred update callback
+        mutable bool mQueuedForDeferredUpdate;
+        /// Flag indicating that the Listener::nodeUpdated event was deferred
+        mutable bool mDeferredNodeUpdated;
+
+        /// Nodes waiting for their deferred update callback, see queueDeferredUpdate
+        static QueuedUpdates msDeferredUpdates;
+        /// Whether update callbacks are currently being deferred to the main thread
+        static bool msDeferUpdateCallbacks;
+        OGRE_STATIC_MUTEX(msDeferredUpdatesMutex);
+
+        /// Structure of arrays storage mirroring the transforms of this node, if any
+        NodeTransformStorage* mTransformStorage;
+        /// Slot of this node in mTransformStorage
+        uint32 mTransformSlot;
+
         DebugRenderable* mDebug;
 
         /// User objects binding.
@@ -573,6 +607,22 @@ namespace Ogre {
         */
         virtual void _update(bool updateChildren, bool parentHasChanged);
 
+        typedef vector<std::pair<Node*, bool> >::type ChildUpdateList;
+
+        /** Internal method to update this Node without cascading to its children.
+        @remarks
+            Behaves like _update with updateChildren set to true, except that instead
+            of recursing it appends every child which would have been updated to
+            the given list, paired with the parentHasChanged flag it must be updated
+            with. This lets a SceneManager update the resulting independent subtrees
+            separately, e.g. on several threads.
+        @param parentHasChanged
+            See _update.
+        @param children
+            List to append the children which still need updating to.
+        */
+        void _updateSelf(bool parentHasChanged, ChildUpdateList& children);
+
         /** Sets a listener for this Node.
         @remarks
             Note for size and performance reasons only one listener per node is
@@ -666,6 +716,32 @@ namespace Ogre {
         /** Process queued 'needUpdate' calls. */
         static void processQueuedUpdates(void);
 
+        /** Notifies this node that its transforms are mirrored in a NodeTransformStorage.
+        @remarks
+            Called by NodeTransformStorage when laying out the hierarchy, pass a null
+            storage to stop mirroring.
+        */
+        void _notifyTransformStorage(NodeTransformStorage* storage, uint32 slot);
+
+        /** Gets the NodeTransformStorage mirroring the transforms of this node, if any. */
+        NodeTransformStorage* _getTransformStorage(void) const { return mTransformStorage; }
+
+        /** Sets whether update callbacks should be deferred to the main thread.
+        @remarks
+            While enabled, Listener::nodeUpdated and other callbacks which are not
+            safe to raise on a worker thread are queued instead of being executed
+            during _update. This is enabled by the SceneManager while it updates
+            the scene graph on several threads, you should not need to call it yourself.
+        */
+        static void _setDeferUpdateCallbacks(bool defer) { msDeferUpdateCallbacks = defer; }
+        /** Gets whether update callbacks are being deferred to the main thread. */
+        static bool _getDeferUpdateCallbacks(void) { return msDeferUpdateCallbacks; }
+        /** Process the update callbacks deferred while updating in parallel.
+        @remarks
+            Must be called from the main thread once all worker threads are done.
+        */
+        static void processDeferredUpdates(void);
+
 
         /** @deprecated use UserObjectBindings::setUserAny via getUserObjectBindings() instead.
             Sets any kind of user value on this object.
@@ -0,0 +1,160 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __NodeTransformStorage_H__
+#define __NodeTransformStorage_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Stores the transforms of a node hierarchy as structure of arrays.
+    @remarks
+        The local and derived transforms of every node in the hierarchy are
+        kept in contiguous, SIMD aligned float streams, one per component.
+        Nodes are laid out breadth first and every depth level starts on a
+        multiple of 4, so all nodes of a level can be concatenated with their
+        parents in batches using OptimisedUtil::concatenateNodeTransforms.
+    @par
+        Nodes mirror their local transform into the storage whenever it changes
+        and pick up their derived transform from it while the storage is
+        updating, so the regular Node interface keeps working on top of it.
+        This class is used by SceneManager, see
+        SceneManager::setNodeTransformStorageEnabled.
+    @note
+        Transforms are stored in single precision regardless of OGRE_DOUBLE_PRECISION.
+    */
+    class _OgreExport NodeTransformStorage : public NodeAlloc
+    {
+    public:
+        /// The streams each transform is split into
+        enum Stream
+        {
+            TS_POSITION_X,
+            TS_POSITION_Y,
+            TS_POSITION_Z,
+            TS_ORIENTATION_W,
+            TS_ORIENTATION_X,
+            TS_ORIENTATION_Y,
+            TS_ORIENTATION_Z,
+            TS_SCALE_X,
+            TS_SCALE_Y,
+            TS_SCALE_Z,
+            TS_COUNT
+        };
+
+    protected:
+        /// Nodes by slot, null for padding and destroyed nodes
+        vector<Node*>::type mNodes;
+        /// Index of the first slot of each depth level, plus the end
+        vector<size_t>::type mLevelOffsets;
+        /// Number of slots the streams have been allocated for
+        size_t mCapacity;
+        /// Single SIMD aligned allocation holding all the streams
+        void* mBuffer;
+        float* mLocal[TS_COUNT];
+        float* mDerived[TS_COUNT];
+        uint32* mParentIndices;
+        uint32* mInheritOrientation;
+        uint32* mInheritScale;
+        /// Whether the hierarchy changed since the last rebuild
+        bool mHierarchyDirty;
+        /// Whether the derived streams are current, see isDerivedValid
+        bool mDerivedValid;
+
+        /// Reallocate the streams for at least the given number of slots
+        void reserve(size_t numSlots);
+
+    public:
+        NodeTransformStorage();
+        ~NodeTransformStorage();
+
+        /** Lays out the hierarchy below (and including) the given node.
+        @remarks
+            Nodes previously stored are released first.
+        */
+        void rebuild(Node* root);
+
+        /** Releases all nodes. */
+        void clear(void);
+
+        /** Calculates the derived transforms of all nodes.
+        @remarks
+            The layout is rebuilt first if the hierarchy changed. Afterwards the
+            derived transforms are valid until _finishUpdate is called, or until
+            a local transform or the hierarchy changes.
+        */
+        void update(Node* root);
+
+        /** Marks the end of the update started with update. */
+        void _finishUpdate(void) { mDerivedValid = false; }
+
+        /** Whether the derived transforms may be used by the nodes. */
+        bool isDerivedValid(void) const { return mDerivedValid; }
+
+        /** Whether the hierarchy changed since the last rebuild. */
+        bool isHierarchyDirty(void) const { return mHierarchyDirty; }
+
+        /** Number of slots in use, including padding. */
+        size_t getNumSlots(void) const { return mNodes.size(); }
+
+        /** Gets the node stored in the given slot, null for padding. */
+        Node* getNode(size_t slot) const { return mNodes[slot]; }
+
+        /** Gets a stream of the local transforms, indexed by slot. */
+        const float* getLocalStream(Stream stream) const { return mLocal[stream]; }
+
+        /** Gets a stream of the derived transforms, indexed by slot. */
+        const float* getDerivedStream(Stream stream) const { return mDerived[stream]; }
+
+        /** Gets the derived transform of the node in the given slot. */
+        void getDerivedTransform(size_t slot, Vector3& position, Quaternion& orientation, Vector3& scale) const;
+
+        /** Notifies the storage that the hierarchy of its nodes changed. */
+        void _notifyHierarchyChanged(void);
+
+        /** Copies the local transform of the node in the given slot. */
+        void _notifyLocalTransform(size_t slot, const Node* node);
+
+        /** Notifies the storage that the node in the given slot is being destroyed. */
+        void _notifyNodeDestroyed(size_t slot);
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif // __NodeTransformStorage_H__
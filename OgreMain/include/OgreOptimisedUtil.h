@@ -203,6 +203,61 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) = 0;
+
+        /** Concatenate node transforms stored as structure of arrays.
+        @remarks
+            Each stream array holds 10 pointers to float streams in the order
+            position x, y, z, orientation w, x, y, z, scale x, y, z. The
+            derived transform of node i is calculated from its local
+            transform and the derived transform of node parentIndices[i]
+            exactly like Node::_updateFromParent does, the parent must
+            have been calculated before.
+        @param localStreams The local transform streams.
+        @param derivedStreams The derived transform streams, read for the
+            parents and written for the nodes in the range.
+        @param parentIndices The index of the parent of each node.
+        @param inheritOrientation Mask per node, 0xFFFFFFFF if the node
+            inherits the orientation of its parent, 0 otherwise.
+        @param inheritScale Mask per node, 0xFFFFFFFF if the node inherits
+            the scale of its parent, 0 otherwise.
+        @param first Index of the first node to calculate, must be a multiple
+            of 4 and all the streams must be aligned to SIMD alignment.
+        @param numNodes Number of nodes to calculate, none of them may be
+            the parent of another node in the range.
+        */
+        virtual void concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes) = 0;
+
+        /** Calculate the visibility of axis aligned boxes against a set of planes.
+        @remarks
+            A box is culled when it lies entirely on the negative side of any
+            of the planes, the same test Plane::getSide does for a box centre
+            and half size.
+        @param planes The planes, packed in (normal.x, normal.y, normal.z, d)
+            format. No alignment requirement.
+        @param numPlanes Number of planes.
+        @param centres Pointer to the box centres, packed in (x, y, z) format.
+            No alignment requirement.
+        @param halfSizes Pointer to the box half sizes, packed in (x, y, z)
+            format. No alignment requirement.
+        @param visibility An array of (numBoxes + 31) / 32 words to store the
+            results, bit (i % 32) of word (i / 32) is set if box i is visible
+            and cleared otherwise. Unused bits of the last word are cleared.
+        @param numBoxes Number of boxes to test.
+        */
+        virtual void calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes) = 0;
     };
 
     /** Returns raw offseted of the given pointer.
@@ -0,0 +1,233 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OGRE_PACK_ARCHIVE_H__
+#define __OGRE_PACK_ARCHIVE_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreArchive.h"
+#include "OgreArchiveFactory.h"
+#include "OgreHeaderPrefix.h"
+#include "Threading/OgreThreadHeaders.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Archive of files compressed with LZ4, which decompresses several
+        times faster than the deflate used by zip.
+    @remarks
+        Each file is split into chunks of a fixed size, compressed
+        independently, so a stream only decompresses the chunks that are
+        read and can seek without decompressing from the start. Chunks that
+        don't compress are stored as they are. Reads of whole chunks are
+        decompressed straight into the caller's buffer.
+    @par
+        The index of the files is at the end of the pack and read once on
+        load. Packs are mapped into memory where MappedFileDataStream is
+        supported, and read through a file stream otherwise. Packs are
+        written by PackArchiveWriter, or the OgrePackBuilder tool.
+    @par
+        The file format, all numbers little endian:
+        - Header: the magic 'OPAK', the version, the chunk size and a
+          reserved uint32.
+        - The compressed chunks of all files.
+        - Index: the number of files, then for each file the uint16 length
+          of its name, the name, its uint64 size, the uint64 offset of its
+          first chunk and the uint32 compressed size of each chunk. Sizes
+          with the top bit set are chunks stored uncompressed.
+        - Trailer: the uint64 offset of the index, its uint32 size and the
+          magic again.
+    */
+    class _OgreExport PackArchive : public Archive
+    {
+    public:
+        PackArchive(const String& name, const String& archType);
+        ~PackArchive();
+        /// @copydoc Archive::isCaseSensitive
+        bool isCaseSensitive(void) const { return OGRE_RESOURCEMANAGER_STRICT; }
+
+        /// @copydoc Archive::load
+        void load();
+        /// @copydoc Archive::unload
+        void unload();
+
+        /// @copydoc Archive::open
+        DataStreamPtr open(const String& filename, bool readOnly = true) const;
+
+        /// @copydoc Archive::create
+        DataStreamPtr create(const String& filename);
+
+        /// @copydoc Archive::remove
+        void remove(const String& filename);
+
+        /// @copydoc Archive::list
+        StringVectorPtr list(bool recursive = true, bool dirs = false) const;
+
+        /// @copydoc Archive::listFileInfo
+        FileInfoListPtr listFileInfo(bool recursive = true, bool dirs = false) const;
+
+        /// @copydoc Archive::find
+        StringVectorPtr find(const String& pattern, bool recursive = true,
+            bool dirs = false) const;
+
+        /// @copydoc Archive::findFileInfo
+        FileInfoListPtr findFileInfo(const String& pattern, bool recursive = true,
+            bool dirs = false) const;
+
+        /// @copydoc Archive::exists
+        bool exists(const String& filename) const;
+
+        /// @copydoc Archive::getModifiedTime
+        time_t getModifiedTime(const String& filename) const;
+
+    protected:
+        /// Where to find a file's chunks
+        struct Entry
+        {
+            uint64 dataOffset;
+            size_t compressedSize;
+            /// Position of the file's first chunk in mChunkSizes
+            size_t firstChunk;
+        };
+        typedef vector<Entry>::type EntryList;
+        /// Lookup name to position in mFileList and mEntries
+        typedef OGRE_HashMap<String, size_t> EntryIndex;
+
+        /// The pack, mapped or as a file stream
+        DataStreamPtr mFile;
+        /// The start of the mapping, null when reading through a file stream
+        const uchar* mMappedData;
+        uint32 mChunkSize;
+        /// File list, directories included, in the order of the index
+        FileInfoList mFileList;
+        /// The entry for each item of mFileList
+        EntryList mEntries;
+        /// Compressed sizes of the chunks of all files
+        vector<uint32>::type mChunkSizes;
+        EntryIndex mIndex;
+
+        OGRE_AUTO_MUTEX;
+
+        /// Opens the pack and reads the index
+        void readIndex(void);
+        /// Adds an item to mFileList and mEntries, with its directories before it
+        void addFileInfo(const String& filename, size_t uncompressedSize, const Entry& entry,
+                         set<String>::type& directories);
+        /// Adds the lookup names of the entries to mIndex
+        void buildIndex(void);
+        /// Finds the position of an entry, returns false if there is no such entry
+        bool findEntry(const String& filename, size_t& index) const;
+        /// Throws about a corrupt pack
+        void corrupted(void) const;
+    };
+
+    /** Specialisation of ArchiveFactory for packs. */
+    class _OgreExport PackArchiveFactory : public ArchiveFactory
+    {
+    public:
+        virtual ~PackArchiveFactory() {}
+        /// @copydoc FactoryObj::getType
+        const String& getType(void) const;
+        /// @copydoc FactoryObj::createInstance
+        Archive *createInstance( const String& name, bool readOnly )
+        {
+            if(!readOnly)
+                return NULL;
+
+            return OGRE_NEW PackArchive(name, "Pack");
+        }
+        /// @copydoc FactoryObj::destroyInstance
+        void destroyInstance( Archive* ptr) { OGRE_DELETE ptr; }
+    };
+
+    /** Writes packs for PackArchive.
+    @remarks
+        Files are compressed and written as they are added, the index is
+        written by finish.
+    @code
+        PackArchiveWriter writer(outputStream);
+        writer.addArchive(sourceArchive);
+        writer.finish();
+    @endcode
+    */
+    class _OgreExport PackArchiveWriter : public ArchiveAlloc
+    {
+    public:
+        /// The default chunk size, as large as LZ4 can reference
+        static const uint32 DEFAULT_CHUNK_SIZE = 65536;
+
+        /** Starts a pack.
+        @param stream Writable stream to write the pack to
+        @param chunkSize Size files are split into. Smaller chunks make
+            seeking cheaper, larger ones compress a little better.
+        */
+        PackArchiveWriter(const DataStreamPtr& stream, uint32 chunkSize = DEFAULT_CHUNK_SIZE);
+
+        /** Compresses a file into the pack.
+        @param filename Name of the file in the pack, with '/' between directories
+        @param data The file's contents, read up to its end
+        */
+        void addFile(const String& filename, const DataStreamPtr& data);
+
+        /// Adds all files of an archive, with their paths
+        void addArchive(Archive* archive);
+
+        /// Writes the index, the pack can't be added to afterwards
+        void finish(void);
+
+        /// The size of the files added so far
+        uint64 getUncompressedSize(void) const { return mUncompressedSize; }
+        /// The size of the pack so far
+        uint64 getSize(void) const { return mOffset; }
+
+    protected:
+        DataStreamPtr mStream;
+        uint32 mChunkSize;
+        /// Where the next chunk goes
+        uint64 mOffset;
+        uint64 mUncompressedSize;
+        /// The index, written by finish
+        vector<uchar>::type mIndex;
+        uint32 mNumFiles;
+        bool mFinished;
+
+        void write(const void* data, size_t size);
+    };
+
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
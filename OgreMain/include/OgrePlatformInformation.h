@@ -98,6 +98,18 @@ namespace Ogre {
 #   define __OGRE_HAVE_SSE  1
 #endif
 
+/* Define whether or not Ogre compiled with AVX2 support, the code is only
+   built for AVX2 where needed and picked at run-time, so this merely depends
+   on the compiler being able to emit it.
+*/
+#if __OGRE_HAVE_SSE && OGRE_COMPILER == OGRE_COMPILER_MSVC && OGRE_COMP_VER >= 1700
+#   define __OGRE_HAVE_AVX2  1
+#elif __OGRE_HAVE_SSE && OGRE_COMPILER == OGRE_COMPILER_GNUC && OGRE_COMP_VER >= 490
+#   define __OGRE_HAVE_AVX2  1
+#elif __OGRE_HAVE_SSE && OGRE_COMPILER == OGRE_COMPILER_CLANG && OGRE_COMP_VER >= 380
+#   define __OGRE_HAVE_AVX2  1
+#endif
+
 /* Define whether or not Ogre compiled with VFP support.
  */
 #if OGRE_DOUBLE_PRECISION == 0 && OGRE_CPU == OGRE_CPU_ARM && (OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG) && defined(__ARM_ARCH_6K__) && defined(__VFP_FP__)
@@ -120,6 +132,10 @@ namespace Ogre {
 #   define __OGRE_HAVE_SSE  0
 #endif
 
+#ifndef __OGRE_HAVE_AVX2
+#   define __OGRE_HAVE_AVX2  0
+#endif
+
 #ifndef __OGRE_HAVE_VFP
 #   define __OGRE_HAVE_VFP  0
 #endif
@@ -176,6 +192,10 @@ namespace Ogre {
             CPU_FEATURE_FPU             = 1 << 12,
             CPU_FEATURE_PRO             = 1 << 13,
             CPU_FEATURE_HTT             = 1 << 14,
+            CPU_FEATURE_AVX             = 1 << 18,
+            CPU_FEATURE_AVX2            = 1 << 19,
+            CPU_FEATURE_FMA             = 1 << 20,
+            CPU_FEATURE_AVX512F         = 1 << 21,
 #elif OGRE_CPU == OGRE_CPU_ARM          
             CPU_FEATURE_VFP             = 1 << 15,
             CPU_FEATURE_NEON            = 1 << 16,
@@ -140,6 +140,7 @@ namespace Ogre {
     class AnimationStateSet;
     class AnimationTrack;
     class Archive;
+    class AsyncReadQueue;
     class ArchiveFactory;
     class ArchiveManager;
     class AutoParamDataSource;
@@ -221,6 +222,7 @@ namespace Ogre {
     class MovablePlane;
     class Node;
     class NodeAnimationTrack;
+    class NodeTransformStorage;
     class NodeKeyFrame;
     class NumericAnimationTrack;
     class NumericKeyFrame;
@@ -291,6 +293,7 @@ namespace Ogre {
     class Skeleton;
     class SkeletonInstance;
     class SkeletonManager;
+    class SoftwareVertexBlendBatch;
     class Sphere;
     class SphereSceneQuery;
     class StaticGeometry;
@@ -304,6 +307,8 @@ namespace Ogre {
     class TempBlendedBufferInfo;
     class ExternalTextureSource;
     class TextureUnitState;
+    class Task;
+    class TaskScheduler;
     class Texture;
     class TextureManager;
     class TransformKeyFrame;
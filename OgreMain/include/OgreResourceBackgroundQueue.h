@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreSingleton.h"
 #include "OgreResource.h"
 #include "OgreWorkQueue.h"
+#include "Threading/OgreAsyncReadQueue.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -105,6 +106,23 @@ namespace Ogre {
 
         };
 
+        /** Processes the files read by readFile, for example by decoding them.
+        */
+        class _OgreExport FileProcessor
+        {
+        public:
+            virtual ~FileProcessor() {}
+
+            /** Called on a WorkQueue worker thread once the file has been read.
+            @remarks
+                Exceptions are reported to the Listener as errors.
+            @param stream The contents of the file, in memory
+            @param filename, group As passed to readFile
+            */
+            virtual void processFile(const DataStreamPtr& stream, const String& filename,
+                const String& group) = 0;
+        };
+
     protected:
 
         uint16 mWorkQueueChannel;
@@ -118,7 +136,8 @@ namespace Ogre {
             RT_LOAD_GROUP = 4,
             RT_LOAD_RESOURCE = 5,
             RT_UNLOAD_GROUP = 6,
-            RT_UNLOAD_RESOURCE = 7
+            RT_UNLOAD_RESOURCE = 7,
+            RT_PROCESS_FILE = 8
         };
         /** Encapsulates a queued request for the background queue */
         struct ResourceRequest
@@ -133,13 +152,40 @@ namespace Ogre {
             NameValuePairList* loadParams;
             Listener* listener;
             BackgroundProcessResult result;
+            BackgroundProcessTicket ticket;
+            FileProcessor* processor;
+            /// The file read for RT_PROCESS_FILE
+            DataStreamPtr stream;
 
             friend std::ostream& operator<<(std::ostream& o, const ResourceRequest& r)
             { (void)r; return o; }
         };
 
-        typedef set<BackgroundProcessTicket>::type OutstandingRequestSet;   
-        OutstandingRequestSet mOutstandingRequestSet;
+        class FileRead;
+
+        /** How to abort a request which hasn't completed yet. The fields of
+            RT_PROCESS_FILE requests are set from an I/O thread once the file
+            has been read, so are guarded by mFileRequestsMutex.
+        */
+        struct OutstandingRequest
+        {
+            WorkQueue::RequestID workQueueID;
+            /// Set while the file of an RT_PROCESS_FILE request may still be read
+            FileRead* read;
+            AsyncReadQueue::RequestID readID;
+        };
+        typedef map<BackgroundProcessTicket, OutstandingRequest>::type OutstandingRequestMap;
+        OutstandingRequestMap mOutstandingRequests;
+        BackgroundProcessTicket mNextTicket;
+
+        typedef set<BackgroundProcessTicket>::type TicketSet;
+        /// RT_PROCESS_FILE requests aborted after their file was read, the
+        /// WorkQueue request is issued from an I/O thread so isn't known
+        TicketSet mAbortedFileRequests;
+        OGRE_MUTEX(mFileRequestsMutex);
+
+        /// Whether the request was aborted, forgets about it if so
+        bool wasFileRequestAborted(BackgroundProcessTicket ticket, bool forget);
 
         /// Struct that holds details of queued notifications
         struct ResourceResponse
@@ -156,6 +202,9 @@ namespace Ogre {
         };
 
         BackgroundProcessTicket addRequest(ResourceRequest& req);
+        /// Queues the processing of a file once it has been read, from an I/O thread
+        void addFileRequest(const ResourceRequest& req, const AsyncReadQueue::Result& result,
+            OutstandingRequest* outstanding);
 
     public:
         ResourceBackgroundQueue();
@@ -298,6 +347,25 @@ namespace Ogre {
             ManualResourceLoader* loader = 0, 
             const NameValuePairList* loadParams = 0, 
             Listener* listener = 0);
+
+        /** Reads a file in the background, then processes it on the WorkQueue.
+        @remarks
+            The file is read on the AsyncReadQueue of Root, so the WorkQueue
+            only gets the request once the bytes are in memory, and none of
+            its workers waits for the disk. Any number of reads can be
+            outstanding like this.
+        @param filename The file to read
+        @param group The resource group to open the file from
+        @param processor Called on a worker thread with the contents of the
+            file, must stay alive until the process has completed
+        @param listener Optional callback interface, take note of warnings in
+            the header and only use if you understand them.
+        @return Ticket identifying the request, use isProcessComplete() to 
+            determine if completed if not using listener
+        */
+        virtual BackgroundProcessTicket readFile(const String& filename,
+            const String& group, FileProcessor* processor, Listener* listener = 0);
+
         /** Returns whether a previously queued process has completed or not. 
         @remarks
             This method of checking that a background process has completed is
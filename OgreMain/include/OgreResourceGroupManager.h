@@ -291,6 +291,8 @@ namespace Ogre {
             Archive* archive;
             /// Whether this location was added recursively
             bool recursive;
+            /// The files in the location, when they were listed through the resource index cache
+            StringVectorPtr files;
         };
         /// List of possible file locations
         typedef list<ResourceLocation*>::type LocationList;
@@ -328,6 +330,8 @@ namespace Ogre {
                     OGRE_AUTO_MUTEX;
             /// Status-specific mutex, separate from content-changing mutex
                     OGRE_MUTEX(statusMutex);
+            /// Guards the resource indexes, so lookups don't wait for the group mutex
+            OGRE_RW_MUTEX(indexMutex);
             /// Group name
             String name;
             /// Group status
@@ -362,6 +366,13 @@ namespace Ogre {
         /// Map from resource group names to groups
         typedef map<String, ResourceGroup*>::type ResourceGroupMap;
         ResourceGroupMap mResourceGroupMap;
+        /** Guards mResourceGroupMap and mResourceManagerMap, so lookups don't
+            block each other.
+        @remarks
+            Changes to the maps hold both the auto mutex and this one for
+            writing, so code holding the auto mutex may read them without it.
+        */
+        OGRE_RW_MUTEX(mLookupMutex);
 
         /// Group name for world resources
         String mWorldGroupName;
@@ -433,6 +444,42 @@ namespace Ogre {
 
         /// Stored current group - optimisation for when bulk loading a group
         ResourceGroup* mCurrentGroup;
+
+        /// Whether resource groups are prepared on the Root's TaskScheduler
+        bool mPrepareInParallel;
+        /// Whether scripts are prepared on the Root's TaskScheduler
+        bool mParseScriptsInParallel;
+
+        /** Prepares the resources of a group on the Root's TaskScheduler.
+        @remarks
+            The calling thread fires the per resource events and finishes
+            each resource in order, loading it if load is true. Must be called
+            without holding the manager's or the group's mutex, as the
+            preparing threads need them.
+        */
+        void processResourcesInParallel(ResourceGroup* grp, bool load);
+
+        /// Cached listing of an archive, see setUseResourceIndexCache
+        struct ResourceIndexCacheEntry
+        {
+            /// Modification time of each directory the listing depends on
+            map<String, int64>::type directoryTimes;
+            /// The files in the archive
+            StringVectorPtr files;
+        };
+        /// Map from archive type, name and recursive flag to its cached listing
+        typedef map<String, ResourceIndexCacheEntry>::type ResourceIndexCache;
+        ResourceIndexCache mResourceIndexCache;
+        bool mUseResourceIndexCache;
+        /// Whether the cache changed since it was loaded
+        bool mResourceIndexCacheDirty;
+
+        /** Lists all files in an archive, through the resource index cache if it is used.
+        @param fromCache Set to whether the listing came from the cache
+        */
+        StringVectorPtr listResourceLocation(Archive* arch, bool recursive, bool& fromCache);
+        /// Finds files in a location, using the cached listing if there is one
+        FileInfoListPtr findFileInfoInLocation(const ResourceLocation* loc, const String& pattern) const;
     public:
         ResourceGroupManager();
         virtual ~ResourceGroupManager();
@@ -1049,6 +1096,91 @@ namespace Ogre {
         */      
         const LocationList& getResourceLocationList(const String& groupName) const;
 
+        /** Sets whether prepareResourceGroup and loadResourceGroup prepare the
+            resources in parallel.
+        @remarks
+            When enabled, Resource::prepare, which does the file I/O and the
+            decoding, runs for many resources at once on the Root's
+            TaskScheduler. The resources are still loaded one after another
+            on the calling thread, in the usual order, as loading may talk to
+            the render system. The ResourceGroupListener events are fired on
+            the calling thread too, once per resource as before.
+        @par
+            Resource managers and listeners have to be safe to use from
+            several threads while their resources are prepared, which the
+            built-in ones are when OGRE_THREAD_SUPPORT is enabled. Without
+            thread support everything runs on the calling thread. The default
+            is false.
+        */
+        void setPrepareInParallel(bool parallel) { mPrepareInParallel = parallel; }
+
+        /** Gets whether resource groups are prepared in parallel.
+        @see setPrepareInParallel
+        */
+        bool getPrepareInParallel() const { return mPrepareInParallel; }
+
+        /** Sets whether initialiseResourceGroup parses scripts in parallel.
+        @remarks
+            When enabled, ScriptLoader::prepareScript, which reads the file
+            and does the work not depending on other scripts, runs for many
+            scripts at once on the Root's TaskScheduler. For the
+            ScriptCompilerManager this is lexing, parsing and building the
+            AST. The scripts are then finished one after another on the
+            calling thread, in the usual order, so the resources they create
+            and the ResourceGroupListener events are the same as before.
+        @par
+            Only scripts in FileSystem archives are prepared ahead, and only
+            while no ResourceLoadingListener is set, since it may replace the
+            streams. The default is false.
+        */
+        void setParseScriptsInParallel(bool parallel) { mParseScriptsInParallel = parallel; }
+
+        /** Gets whether scripts are parsed in parallel.
+        @see setParseScriptsInParallel
+        */
+        bool getParseScriptsInParallel() const { return mParseScriptsInParallel; }
+
+        /** Sets whether listing the files of new resource locations goes
+            through the resource index cache.
+        @remarks
+            addResourceLocation lists every file in the archive to build the
+            group's index, and initialiseResourceGroup searches it again for
+            scripts. With the cache, an archive whose listing is cached and
+            which is unchanged since is not scanned at all. Scripts are then
+            found in the cached listing too.
+        @par
+            A listing is considered unchanged while the modification times
+            of the archive's directories (all of them for recursive
+            locations) are. Adding, removing or renaming a file changes the
+            time of the directory it is in. Stale listings are replaced by a
+            fresh scan. The default is false.
+        @see loadResourceIndexCache, saveResourceIndexCache
+        */
+        void setUseResourceIndexCache(bool use) { mUseResourceIndexCache = use; }
+
+        /** Gets whether the resource index cache is used.
+        @see setUseResourceIndexCache
+        */
+        bool getUseResourceIndexCache() const { return mUseResourceIndexCache; }
+
+        /** Returns true if archives were scanned and cached since the
+            resource index cache was last loaded or saved.
+        */
+        bool isResourceIndexCacheDirty(void) const;
+
+        /** Saves the resource index cache.
+        @param stream The destination stream
+        */
+        void saveResourceIndexCache(DataStreamPtr stream);
+
+        /** Loads the resource index cache, replacing the current one.
+        @remarks
+            Call this before adding the resource locations it should be
+            used for. A cache written by an incompatible version is ignored.
+        @param stream The source stream
+        */
+        void loadResourceIndexCache(DataStreamPtr stream);
+
         /// Sets a new loading listener
         void setLoadingListener(ResourceLoadingListener *listener);
         /// Returns the current loading listener
@@ -558,6 +558,13 @@ namespace Ogre {
         ResourceHandleMap mResourcesByHandle;
         ResourceMap mResources;
         ResourceWithGroupMap mResourcesWithGroup;
+        /** Guards the resource maps above, so lookups don't block each other.
+        @remarks
+            Changes to the maps hold both the auto mutex and this one for
+            writing, so code holding the auto mutex may read them without it.
+            Nothing may be called back while it is held.
+        */
+        OGRE_RW_MUTEX(mResourcesMutex);
         size_t mMemoryBudget; /// In bytes
         AtomicScalar<ResourceHandle> mNextHandle;
         AtomicScalar<size_t> mMemoryUsage; /// In bytes
@@ -94,6 +94,7 @@ namespace Ogre
         ArchiveFactory *mZipArchiveFactory;
         ArchiveFactory *mEmbeddedZipArchiveFactory;
         ArchiveFactory *mFileSystemArchiveFactory;
+        ArchiveFactory *mPackArchiveFactory;
         
 #if OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
         AndroidLogListener* mAndroidLogger;
@@ -146,6 +147,10 @@ namespace Ogre
 
         WorkQueue* mWorkQueue;
 
+        TaskScheduler* mTaskScheduler;
+
+        AsyncReadQueue* mAsyncReadQueue;
+
         ///Tells whether blend indices information needs to be passed to the GPU
         bool mIsBlendIndicesGpuRedundant;
         ///Tells whether blend weights information needs to be passed to the GPU
@@ -1034,6 +1039,23 @@ namespace Ogre
             at shutdown, so do not destroy it yourself.
         */
         void setWorkQueue(WorkQueue* queue);
+
+        /** Get the TaskScheduler for splitting per frame work over several threads.
+        @remarks
+            Unlike the WorkQueue, work given to the scheduler is waited for by
+            the submitting thread, see TaskScheduler::parallelFor. Its worker
+            threads are started and stopped along with the WorkQueue; until
+            then tasks run on the thread waiting for them.
+        */
+        TaskScheduler* getTaskScheduler() const { return mTaskScheduler; }
+
+        /** Get the AsyncReadQueue for reading streams and files without
+            blocking a thread until the bytes arrive.
+        @remarks
+            Its I/O threads are started and stopped along with the WorkQueue;
+            until then reads complete on the thread issuing them.
+        */
+        AsyncReadQueue* getAsyncReadQueue() const { return mAsyncReadQueue; }
             
         /** Sets whether blend indices information needs to be passed to the GPU.
             When entities use software animation they remove blend information such as
@@ -49,6 +49,8 @@ Torus Knot Software Ltd.
 #include "OgreLodListener.h"
 #include "OgreHeaderPrefix.h"
 #include "OgreNameGenerator.h"
+#include "OgreNode.h"
+#include "Threading/OgreThreads.h"
 
 namespace Ogre {
     /** \addtogroup Core
@@ -66,6 +68,7 @@ namespace Ogre {
     };
 
     // Forward declarations
+    class Barrier;
     class CompositorChain;
     class InstancedGeometry;
     class Rectangle2D;
@@ -791,6 +794,7 @@ namespace Ogre {
 
         typedef vector<InstanceManager*>::type      InstanceManagerVec;
         InstanceManagerVec mDirtyInstanceManagers;
+        OGRE_MUTEX(mDirtyInstanceManagersMutex);
         InstanceManagerVec mDirtyInstanceMgrsTmp;
 
         /** Updates all instance managaers with dirty instance batches. @see _addDirtyInstanceManager */
@@ -871,6 +875,84 @@ namespace Ogre {
         uint32 mVisibilityMask;
         bool mFindVisibleObjects;
 
+        /// Work the worker threads are woken up to perform, see fireWorkerThreadsAndWait
+        enum WorkerThreadRequest
+        {
+            WTR_NONE,
+            WTR_UPDATE_SCENE_GRAPH,
+            WTR_FIND_VISIBLE_OBJECTS,
+            WTR_SHUTDOWN
+        };
+
+        /// Number of worker threads, not counting the main thread which also takes a share
+        size_t mNumWorkerThreads;
+        /// Request currently being processed by the worker threads
+        WorkerThreadRequest mWorkerThreadRequest;
+        /// Synchronises the worker threads with the main thread, NULL if there are none
+        Barrier* mWorkerThreadsBarrier;
+        ThreadHandleVec mWorkerThreads;
+        /// Independent subtrees of the root node being updated by the worker threads
+        Node::ChildUpdateList mSubtreesToUpdate;
+        /** Nodes updated, or culled, on the main thread to split their children into
+            subtrees, parents first */
+        vector<SceneNode*>::type mSplitNodes;
+
+        /// Creates mNumWorkerThreads worker threads, or none if it is 0
+        void startWorkerThreads(void);
+        /// Shuts down and joins all the worker threads
+        void stopWorkerThreads(void);
+        /** Wakes up the worker threads to process the given request, processes the main
+            thread's share of it and blocks until every thread is done.
+        */
+        void fireWorkerThreadsAndWait(WorkerThreadRequest request);
+        /// Processes the current request's share belonging to the given thread
+        virtual void executeWorkerThreadRequest(size_t threadIdx);
+        /** Updates the scene graph from the root, splitting it into independent
+            subtrees which are updated by all the worker threads.
+        @remarks
+            Node listener callbacks are deferred while the worker threads run and fired
+            on the calling thread once all of them have finished.
+        */
+        virtual void updateSceneGraphParallel(void);
+        /// Updates the given thread's share of mSubtreesToUpdate
+        virtual void updateSubtreesThread(size_t threadIdx);
+
+        /// Camera the worker threads are culling against
+        Camera* mCullCamera;
+        typedef vector<SceneNode*>::type VisibleNodeList;
+        /// Independent subtrees of the scene being culled by the worker threads
+        VisibleNodeList mSubtreesToCull;
+        /// Visible nodes found by each thread, merged in thread order
+        vector<VisibleNodeList>::type mVisibleNodesPerThread;
+
+        /** Finds the visible objects like _findVisibleObjects does, culling the subtrees
+            of the root node on all the worker threads. Large subtrees are split
+            like in updateSceneGraphParallel.
+        @remarks
+            The worker threads only test world bounds against the camera, the visible
+            nodes they find are then added to the render queue on the calling thread
+            in a deterministic order.
+        */
+        virtual void findVisibleObjectsParallel(Camera* cam,
+            VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters);
+        /** Culls the given thread's share of the scene, see findVisibleObjectsParallel.
+        @remarks
+            Subclasses overriding _findVisibleObjects can override this to make use of
+            WTR_FIND_VISIBLE_OBJECTS requests with their own data.
+        */
+        virtual void findVisibleObjectsThread(size_t threadIdx);
+
+        /// Structure of arrays copy of the scene graph transforms, NULL if disabled
+        NodeTransformStorage* mNodeTransformStorage;
+
+        /// Whether entities queue their software skinning, see setParallelSoftwareSkinningEnabled
+        bool mParallelSoftwareSkinning;
+        /// Blends of the entities in mSoftwareSkinningQueue
+        SoftwareVertexBlendBatch* mSoftwareSkinningBatch;
+        typedef vector<Entity*>::type SoftwareSkinningQueue;
+        /// Entities whose software skinning is waiting for _updateQueuedSoftwareSkinning
+        SoftwareSkinningQueue mSoftwareSkinningQueue;
+
         /// Suppress render state changes?
         bool mSuppressRenderStateChanges;
         /// Suppress shadows?
@@ -3209,6 +3291,87 @@ namespace Ogre {
         */
         virtual bool getFindVisibleObjects(void) { return mFindVisibleObjects; }
 
+        /** Sets the number of worker threads used to parallelise per-frame work.
+        @remarks
+            When non-zero, _updateSceneGraph splits the scene graph into independent
+            subtrees, going down past the children of the root scene node where they
+            hold many nodes, and updates them on the worker threads and the calling
+            thread at the same time, joining before any visible objects are
+            searched for. _findVisibleObjects then culls those subtrees against the
+            camera on all the threads, and adds the objects of the visible nodes to the
+            render queue on the calling thread. The default of 0 keeps all the work on
+            the calling thread.
+        @par
+            Node::Listener::nodeUpdated events are still raised on the calling thread,
+            after all the worker threads are done. Other code run during the update
+            (e.g. MovableObject::_notifyMoved, MovableObject::Listener::objectMoved
+            and getWorldBoundingBox) may be called from a worker thread, so objects
+            attached to different nodes must not share mutable state.
+            Likewise Camera::isVisible is called concurrently for world bounds, so custom
+            cameras must allow that once their frustum planes are up to date.
+        @note
+            Has no effect when Ogre is built without thread support.
+        */
+        void setNumWorkerThreads(size_t numThreads);
+
+        /** Gets the number of worker threads, see setNumWorkerThreads. */
+        size_t getNumWorkerThreads(void) const { return mNumWorkerThreads; }
+
+        /// Internal method, entry point of the worker threads.
+        unsigned long _updateWorkerThread(ThreadHandle* threadHandle);
+
+        /** Sets whether node transforms are also kept in structure of arrays storage.
+        @remarks
+            When enabled, the transforms of all the nodes below the root scene node
+            are mirrored into a NodeTransformStorage owned by this SceneManager, and
+            _updateSceneGraph concatenates them with their parents in SIMD batches
+            before walking the scene graph. The nodes then just pick up their derived
+            transforms, so the Node interface is unchanged. This pays off for large,
+            mostly animated scene graphs, the layout is rebuilt whenever the
+            hierarchy changes.
+        @note
+            Transforms are calculated in single precision.
+        */
+        void setNodeTransformStorageEnabled(bool enabled);
+
+        /** Gets whether node transforms are kept in structure of arrays storage. */
+        bool isNodeTransformStorageEnabled(void) const { return mNodeTransformStorage != 0; }
+
+        /** Gets the structure of arrays node transform storage, NULL if disabled. */
+        NodeTransformStorage* _getNodeTransformStorage(void) const { return mNodeTransformStorage; }
+
+        /** Sets whether software skinning of the visible entities is done all at once.
+        @remarks
+            Normally every Entity updates its skeleton and blends its vertices in
+            software as it is added to the render queue, when hardware skinning isn't
+            used. With this enabled, entities only check out their blending buffers
+            then and queue themselves instead. Once all the visible objects have been
+            found, the skeletons of the queued entities are updated and their vertices
+            blended together, split over the threads of the Root's TaskScheduler
+            and with each vertex buffer only locked once.
+        @par
+            Entities using hardware skinning, sharing their skeleton with other
+            entities or having objects attached to their bones are still updated
+            right away.
+        */
+        void setParallelSoftwareSkinningEnabled(bool enabled);
+
+        /** Gets whether software skinning of the visible entities is done all at once. */
+        bool isParallelSoftwareSkinningEnabled(void) const { return mParallelSoftwareSkinning; }
+
+        /** Internal method to get the batch entities add their queued blends to. */
+        SoftwareVertexBlendBatch& _getSoftwareSkinningBatch(void) { return *mSoftwareSkinningBatch; }
+
+        /** Internal method used by entities to queue their software skinning. */
+        void _queueSoftwareSkinning(Entity* entity);
+
+        /** Performs the software skinning of all the queued entities.
+        @remarks
+            Called by _renderScene once the visible objects have been found, call it
+            yourself if you add entities to a render queue outside of it.
+        */
+        void _updateQueuedSoftwareSkinning(void);
+
         /** Set whether to automatically normalise normals on objects whenever they
             are scaled.
         @remarks
@@ -208,6 +208,29 @@ namespace Ogre {
             VisibleObjectsBoundsInfo* visibleBounds, 
             bool includeChildren = true, bool displayNodes = false, bool onlyShadowCasters = false);
 
+        typedef vector<SceneNode*>::type VisibleNodeList;
+
+        /** Internal method which collects this node and its descendants if they are visible.
+            @remarks
+                This is the culling half of _findVisibleObjects, a child is only visited if its
+                parent is visible. It doesn't modify any state so it may be called for disjoint
+                subtrees from several threads at once, see SceneManager::setNumWorkerThreads.
+            @param
+                cam The active camera, its frustum planes must be up to date
+            @param
+                visibleNodes The list the visible nodes are appended to, parents before children
+        */
+        void _findVisibleNodes(Camera* cam, VisibleNodeList& visibleNodes);
+
+        /** Internal method which adds the objects attached to this node to the passed in queue.
+            @remarks
+                This is the queueing half of _findVisibleObjects, for nodes already known to be
+                visible. The parameters are the same as for _findVisibleObjects.
+        */
+        void _addVisibleObjectsToQueue(Camera* cam, RenderQueue* queue,
+            VisibleObjectsBoundsInfo* visibleBounds,
+            bool displayNodes = false, bool onlyShadowCasters = false);
+
         /** Gets the axis-aligned bounding box of this node (and hence all subnodes).
         @remarks
             Recommended only if you are extending a SceneManager, because the bounding box returned
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreScriptLoader.h"
 #include "OgreGpuProgram.h"
 #include "OgreAny.h"
+#include "OgreScriptLexer.h"
 #include "Threading/OgreThreadHeaders.h"
 #include "OgreHeaderPrefix.h"
 
@@ -72,6 +73,50 @@ namespace Ogre
         ConcreteNode *parent;
     };
 
+    /** A ConcreteNode allocated from a ScriptArena, referring to its token
+        rather than holding a copy.
+    @remarks
+        Children are linked through the nodes themselves, so building a tree
+        of these allocates nothing but the nodes.
+    */
+    struct ConcreteNodeView;
+    struct ConcreteNodeViewList
+    {
+        ConcreteNodeView *front, *back;
+        size_t size;
+
+        ConcreteNodeViewList() : front(0), back(0), size(0) {}
+        void push_back(ConcreteNodeView *node);
+    };
+    struct ConcreteNodeView
+    {
+        /// The token, not null terminated
+        const char *token;
+        size_t length;
+        const String *file;
+        unsigned int line;
+        ConcreteNodeType type;
+        ConcreteNodeViewList children;
+        ConcreteNodeView *parent, *prev, *next;
+
+        String getToken() const { return String(token, length); }
+        bool equals(const char *str) const
+        {
+            return strncmp(token, str, length) == 0 && str[length] == 0;
+        }
+    };
+    inline void ConcreteNodeViewList::push_back(ConcreteNodeView *node)
+    {
+        node->prev = back;
+        node->next = 0;
+        if(back)
+            back->next = node;
+        else
+            front = node;
+        back = node;
+        ++size;
+    }
+
     /** This enum holds the types of the possible abstract nodes */
     enum AbstractNodeType
     {
@@ -218,6 +263,36 @@ namespace Ogre
             CE_REFERENCETOANONEXISTINGOBJECT
         };
         static String formatErrorCode(uint32 code);
+
+        /// The checksum of a script imported by a cached script
+        struct ImportChecksum
+        {
+            // Whether the script was found, the checksum is only set if it was
+            bool found;
+            uint64 checksum[2];
+        };
+        typedef map<String,ImportChecksum>::type ImportChecksumMap;
+
+        /// A script converted to an AST by _parse, to be compiled by _compileParsed
+        struct ParsedScript : public ScriptCompilerAlloc
+        {
+            AbstractNodeListPtr nodes;
+            // The variables set at the top level
+            map<String,String>::type env;
+            // The errors found while parsing, not reported yet
+            ErrorList errors;
+            // Whether nodes came from the cache, already imported and expanded
+            bool cached;
+            // The name and the checksum of the script, set when the cache is used
+            String source;
+            uint64 checksum[2];
+            // The text of a cached script, parsed if its imports have changed
+            String text;
+            // The imports a cached script was expanded with
+            ImportChecksumMap imports;
+
+            ParsedScript() : cached(false) { checksum[0] = checksum[1] = 0; }
+        };
     public:
         ScriptCompiler();
         virtual ~ScriptCompiler() {}
@@ -235,6 +310,35 @@ namespace Ogre
         AbstractNodeListPtr _generateAST(const String &str, const String &source, bool doImports = false, bool doObjects = false, bool doVariables = false);
         /// Compiles the given abstract syntax tree
         bool _compile(AbstractNodeListPtr nodes, const String &group, bool doImports = true, bool doObjects = true, bool doVariables = true);
+        /** Lexes, parses and converts a script to an AST without translating it.
+        @remarks
+            The errors are kept in the parsed script instead of being reported,
+            and the listener isn't called, so compilers without a listener can
+            parse on several threads at once.
+        */
+        void _parse(const String &str, const String &source, const String &group, ParsedScript &script);
+        /// Reports the errors of a script returned by _parse, then compiles it
+        bool _compileParsed(ParsedScript &script, const String &group);
+        /** Parses, imports and expands a script and writes it to the cache,
+            without translating it.
+        @return Whether the script was cached, it isn't if it has errors
+        */
+        bool _buildCache(const String &str, const String &source, const String &group);
+
+        /** Sets a directory to cache the ASTs of compiled scripts in.
+        @remarks
+            The AST of each script is stored once its imports, inheritance
+            and variables have been processed, keyed by a checksum of the
+            script and of the scripts it imports. Compiling the same script
+            again reads the AST from the cache and only translates it,
+            skipping the lexer and the parser. Scripts with errors before
+            translation aren't cached. The cache is only used while no
+            listener is set, as the listener can change the AST. An empty
+            path, the default, disables the cache.
+        */
+        void setCacheDirectory(const String &path);
+        /// Gets the directory ASTs are cached in, empty if the cache is disabled
+        const String &getCacheDirectory() const;
         /// Adds the given error to the compiler's list of errors
         void addError(uint32 code, const String &file, int line, const String &msg = "");
         /// Sets the listener used by the compiler
@@ -270,6 +374,8 @@ namespace Ogre
 
     private: // Tree processing
         AbstractNodeListPtr convertToAST(const ConcreteNodeListPtr &nodes);
+        /// Lexes and parses a script and converts it to an AST, like convertToAST after ScriptParser::parse
+        AbstractNodeListPtr convertToAST(const String &str, const String &source);
         /// This built-in function processes import nodes
         void processImports(AbstractNodeListPtr &nodes);
         /// Loads the requested script and converts it to an AST
@@ -286,6 +392,25 @@ namespace Ogre
         bool isNameExcluded(const String &cls, AbstractNode *parent);
         /// This function sets up the initial values in word id map
         void initWordMap();
+        /// Processes the imports, inheritance and variables of the script being compiled
+        void processAST(AbstractNodeListPtr &ast);
+        /// Translates the processed AST of the script being compiled
+        bool translateAST(const AbstractNodeListPtr &ast);
+        /// Gets the path of the cache entry of a script of the current group
+        String getCachePath(const String &source) const;
+        /** Reads the AST of a script from the cache, null if there's no entry
+            for this checksum.
+        @remarks
+            Doesn't open any resources, the imports the AST depends on are
+            returned to be checked with checkImports.
+        */
+        AbstractNodeListPtr readCache(const String &source, const uint64 checksum[2], ImportChecksumMap &imports);
+        /// Whether the imported scripts still have the given checksums
+        bool checkImports(const ImportChecksumMap &imports);
+        /// Writes the processed AST of a script to the cache, returns whether it was written
+        bool writeCache(const String &source, const uint64 checksum[2], const AbstractNodeList &nodes);
+        /// Passes an error on to the listener, or logs it
+        void reportError(const Error &err);
     private:
         // Resource group
         String mGroup;
@@ -307,11 +432,23 @@ namespace Ogre
         // This stores the imports of the scripts, so they are separated and can be treated specially
         AbstractNodeList mImportTable;
 
+        // The directory ASTs are cached in, empty if disabled
+        String mCacheDirectory;
+        // Checksums of the scripts imported, a cache entry depends on them
+        ImportChecksumMap mImportChecksums;
+
         // Error list
         ErrorList mErrors;
+        // Whether errors are only added to the list, while parsing with _parse
+        bool mDeferErrors;
 
         // The listener
         ScriptCompilerListener *mListener;
+
+        // Holds the tokens and concrete nodes of the script being converted,
+        // reused for every script
+        ScriptArena mArena;
+        ScriptTokenViewList mTokens;
     private: // Internal helper classes and processors
         class AbstractTreeBuilder
         {
@@ -322,8 +459,8 @@ namespace Ogre
         public:
             AbstractTreeBuilder(ScriptCompiler *compiler);
             const AbstractNodeListPtr &getResult() const;
-            void visit(ConcreteNode *node);
-            static void visit(AbstractTreeBuilder *visitor, const ConcreteNodeList &nodes);
+            void visit(ConcreteNodeView *node);
+            static void visit(AbstractTreeBuilder *visitor, const ConcreteNodeViewList &nodes);
         };
         friend class AbstractTreeBuilder;
     public: // Public translator definitions
@@ -418,6 +555,27 @@ namespace Ogre
 
         // A pointer to the specific compiler instance used
         OGRE_THREAD_POINTER(ScriptCompiler, mScriptCompiler);
+
+        // The custom words, in the order they were registered
+        StringVector mCustomWords;
+
+        // See setScriptCacheDirectory
+        String mScriptCacheDirectory;
+
+        // Compilers for prepareScript which aren't in use, see createPrepareCompiler
+        vector<ScriptCompiler*>::type mPrepareCompilers;
+        // Bumped when a custom word is registered, compilers created before are stale
+        size_t mPrepareCompilersGeneration;
+        OGRE_MUTEX(mPrepareCompilersMutex);
+
+        /// The prepared script of this manager
+        struct PreparedScript : public ScriptLoader::PreparedScript
+        {
+            ScriptCompiler::ParsedScript parsed;
+        };
+
+        /// Creates a compiler which only parses, knowing the custom words
+        ScriptCompiler *createPrepareCompiler();
     public:
         ScriptCompilerManager();
         virtual ~ScriptCompilerManager();
@@ -455,6 +613,30 @@ namespace Ogre
         const StringVector& getScriptPatterns(void) const;
         /// @copydoc ScriptLoader::parseScript
         void parseScript(DataStreamPtr& stream, const String& groupName);
+        /** @copydoc ScriptLoader::prepareScript
+        @remarks
+            Lexes, parses and builds the AST on a compiler of its own. Scripts
+            are only prepared while no listener is set, as the listener may
+            change the AST.
+        */
+        ScriptLoader::PreparedScript* prepareScript(DataStreamPtr& stream, const String& groupName);
+        /// @copydoc ScriptLoader::parsePreparedScript
+        void parsePreparedScript(ScriptLoader::PreparedScript* script, const String& groupName);
+
+        /** Sets a directory to cache the ASTs of compiled scripts in, see
+            ScriptCompiler::setCacheDirectory. Empty disables the cache.
+        */
+        void setScriptCacheDirectory(const String& path);
+        /// Gets the directory ASTs are cached in, empty if the cache is disabled
+        const String& getScriptCacheDirectory() const { return mScriptCacheDirectory; }
+        /** Writes the cache entries of all the scripts of a resource group,
+            without creating any resources.
+        @remarks
+            The resource group needs to have its locations, it doesn't need
+            to be initialised.
+        @return The number of scripts cached, scripts with errors aren't
+        */
+        size_t buildScriptCache(const String& groupName);
         /// @copydoc ScriptLoader::getLoadingOrder
         Real getLoadingOrder(void) const;
 
@@ -72,13 +72,76 @@ namespace Ogre {
     typedef vector<ScriptTokenPtr>::type ScriptTokenList;
     typedef SharedPtr<ScriptTokenList> ScriptTokenListPtr;
 
+    /** Allocates memory for the lexer and the parser, freed all at once.
+    @remarks
+        Memory is handed out from large blocks. reset frees everything but
+        keeps the blocks, so scripts parsed one after the other with the
+        same arena don't allocate once it has grown to the size they need.
+    */
+    class _OgreExport ScriptArena : public ScriptCompilerAlloc
+    {
+    public:
+        ScriptArena();
+        ~ScriptArena();
+
+        /// Allocates memory aligned for any type, valid until the next reset
+        void *allocate(size_t size);
+        /// Frees all the memory allocated
+        void reset();
+    private:
+        struct Block
+        {
+            char *data;
+            size_t size;
+        };
+        vector<Block>::type mBlocks;
+        // The block being allocated from and how much of it is used
+        size_t mCurrent, mUsed;
+
+        // Non-copyable
+        ScriptArena(const ScriptArena&);
+        ScriptArena &operator = (const ScriptArena&);
+    };
+
+    /** A token referring to its lexeme in the text it was read from, rather
+        than holding a copy.
+    */
+    struct ScriptTokenView
+    {
+        /// The lexeme, not null terminated
+        const char *lexeme;
+        size_t length;
+        /// The name of the text the token was read from
+        const String *file;
+        /// The id of the token, one of the TID_ values
+        uint32 type;
+        /// The line number of the input stream where the token was found
+        uint32 line;
+
+        bool equals(const char *str) const
+        {
+            return strncmp(lexeme, str, length) == 0 && str[length] == 0;
+        }
+    };
+    typedef vector<ScriptTokenView>::type ScriptTokenViewList;
+
     class _OgreExport ScriptLexer : public ScriptCompilerAlloc
     {
     public:
         /** Tokenizes the given input and returns the list of tokens found */
         static ScriptTokenListPtr tokenize(const String &str, const String &source);
+        /** Tokenizes the given input into tokens referring to it.
+        @remarks
+            Finds the same tokens as the other overload without allocating
+            for each of them. Quoted lexemes with escaped characters are
+            stored in the arena, the others point into str. The tokens are
+            valid as long as str, source and the memory of the arena.
+        @param tokens The tokens found are added to this list
+        */
+        static void tokenize(const String &str, const String &source, ScriptTokenViewList &tokens, ScriptArena &arena);
     private: // Private utility operations
-        static void setToken(const String &lexeme, uint32 line, const String &source, ScriptTokenList *tokens);
+        static void setToken(const char *lexeme, size_t length, uint32 line, const String &source, ScriptTokenViewList &tokens);
+        static const char *unescapeQuote(const char *lexeme, size_t &length, ScriptArena &arena);
         static bool isWhitespace(Ogre::String::value_type c);
         static bool isNewline(Ogre::String::value_type c);
     };
@@ -77,6 +77,33 @@ namespace Ogre {
         */
         virtual void parseScript(DataStreamPtr& stream, const String& groupName) = 0;
 
+        /// A script partly parsed by prepareScript
+        class PreparedScript : public ScriptingAllocatedObject
+        {
+        public:
+            virtual ~PreparedScript() {}
+        };
+
+        /** Does the part of parsing a script which doesn't depend on any other
+            script, such as lexing it.
+        @remarks
+            ResourceGroupManager calls this on the worker threads of the Root's
+            TaskScheduler for many scripts at once when parsing scripts in
+            parallel, see ResourceGroupManager::setParseScriptsInParallel. It
+            then calls parsePreparedScript with the result, one script after
+            another in the usual order. Must be safe to call from any thread
+            while another script is parsed. The default prepares nothing.
+        @return The prepared script, deleted by the caller, or null to have
+            the script parsed by parseScript instead
+        */
+        virtual PreparedScript* prepareScript(DataStreamPtr& stream, const String& groupName) { return 0; }
+
+        /** Finishes parsing a script returned by prepareScript.
+        @param script The prepared script
+        @param groupName The name of the resource group, as for parseScript
+        */
+        virtual void parsePreparedScript(PreparedScript* script, const String& groupName) {}
+
         /** Gets the relative loading order of scripts of this type.
         @remarks
             There are dependencies between some kinds of scripts, and to enforce
@@ -47,10 +47,18 @@ namespace Ogre {
     {
     public:
         static ConcreteNodeListPtr parse(const ScriptTokenListPtr &tokens);
+        /** Parses tokens into nodes allocated from an arena.
+        @remarks
+            Builds the same tree as the other overload, the nodes refer to
+            the lexemes of the tokens.
+        @param nodes The top level nodes are added to this list
+        */
+        static void parse(const ScriptTokenViewList &tokens, ConcreteNodeViewList &nodes, ScriptArena &arena);
         static ConcreteNodeListPtr parseChunk(const ScriptTokenListPtr &tokens);
     private:
-        static ScriptToken *getToken(ScriptTokenList::iterator i, ScriptTokenList::iterator end, int offset);
-        static ScriptTokenList::iterator skipNewlines(ScriptTokenList::iterator i, ScriptTokenList::iterator end);
+        static ConcreteNodeView *createNode(const ScriptTokenView &token, ConcreteNodeType type, ScriptArena &arena);
+        static void addNode(ConcreteNodeView *node, ConcreteNodeView *parent, ConcreteNodeViewList &nodes);
+        static size_t skipNewlines(const ScriptTokenViewList &tokens, size_t i);
     };
     
     /** @} */
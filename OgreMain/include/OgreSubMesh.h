@@ -63,6 +63,7 @@ namespace Ogre {
         friend class MeshSerializerImpl;
         friend class MeshSerializerImpl_v1_2;
         friend class MeshSerializerImpl_v1_1;
+        friend class MeshCacheSerializer;
     public:
         SubMesh();
         ~SubMesh();
@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreArchive.h"
 #include "OgreArchiveFactory.h"
+#include "OgreMappedZip.h"
 #include "OgreHeaderPrefix.h"
 #include "Threading/OgreThreadHeaders.h"
 
@@ -106,6 +107,27 @@ namespace Ogre {
 
         /// @copydoc Archive::getModifiedTime
         time_t getModifiedTime(const String& filename) const;
+
+        /** Set whether Zip archives are read through a memory mapping.
+        @remarks
+            If true, ZipArchiveFactory creates a MappedZipArchive rather than
+            a ZipArchive where MappedFileDataStream::isSupported. It opens
+            files faster and doesn't copy stored entries, but doesn't support
+            encrypted or zip64 archives. Archives must not be rewritten while
+            they are loaded. The default is true.
+        */
+        static void setUseMemoryMapping(bool use)
+        {
+            msUseMemoryMapping = use;
+        }
+
+        /// Get whether Zip archives are read through a memory mapping.
+        static bool getUseMemoryMapping()
+        {
+            return msUseMemoryMapping;
+        }
+
+        static bool msUseMemoryMapping;
     };
 
     /** Specialisation of ArchiveFactory for Zip files. */
@@ -121,6 +143,10 @@ namespace Ogre {
             if(!readOnly)
                 return NULL;
 
+#if OGRE_NO_ZIP_ARCHIVE == 0
+            if (ZipArchive::getUseMemoryMapping() && MappedFileDataStream::isSupported())
+                return OGRE_NEW MappedZipArchive(name, "Zip");
+#endif
             return OGRE_NEW ZipArchive(name, "Zip");
         }
         /// @copydoc FactoryObj::destroyInstance
@@ -0,0 +1,231 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreAsyncReadQueue_H__
+#define __OgreAsyncReadQueue_H__
+
+#include "../OgrePrerequisites.h"
+#include "../OgreAtomicScalar.h"
+#include "../OgreDataStream.h"
+#include "../OgreHeaderPrefix.h"
+
+/// Whether reads are run on I/O threads, the TBB provider lacks the
+/// primitives they need and reads complete on the calling thread
+#if OGRE_THREAD_SUPPORT && OGRE_THREAD_PROVIDER != 3
+#   define OGRE_ASYNC_READ_THREADS 1
+#else
+#   define OGRE_ASYNC_READ_THREADS 0
+#endif
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Reads streams and files on a small pool of I/O threads, and notifies
+        a listener once the bytes are in memory.
+    @remarks
+        DataStream reads block, so loading in the background through the
+        WorkQueue keeps a worker waiting on the disk for every outstanding
+        read. Reads issued here are queued instead, any number of them, and
+        only occupy one of the few I/O threads while they are running. The
+        listener then hands the CPU heavy part, such as decoding, to a
+        WorkQueue or TaskScheduler.
+    @par
+        Streams which are already in memory, such as memory mapped files,
+        aren't copied. Their pages are touched on the I/O thread instead, so
+        the thread decoding them doesn't stall on page faults.
+    @par
+        Reads of the same stream are run one at a time in the order they were
+        issued, since DataStream has a single read position. The stream must
+        not be used elsewhere until its reads have completed.
+    @par
+        Without I/O threads, or when OGRE_THREAD_SUPPORT is 0, reads run on
+        the thread issuing them, before the read call returns.
+    */
+    class _OgreExport AsyncReadQueue : public UtilityAlloc
+    {
+    public:
+        typedef unsigned long long int RequestID;
+
+        /** The outcome of a read. */
+        struct Result
+        {
+            /// The ID returned when the read was issued
+            RequestID id;
+            /// The stream which was read, or opened for reading a file
+            DataStreamPtr source;
+            /// The bytes read, positioned at the start, null if the read failed
+            MemoryDataStreamPtr data;
+            /// Description of the failure
+            String error;
+
+            Result() : id(0) {}
+
+            bool succeeded() const { return data.get() != 0; }
+        };
+
+        /** Notified about completed reads. */
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+
+            /** Called once a read has completed or failed.
+            @note
+                Called on an I/O thread, or on the thread issuing the read
+                when there are no I/O threads. Anything more than queueing
+                further work holds up the reads waiting behind this one.
+                Must not throw.
+            */
+            virtual void readCompleted(const Result& result) = 0;
+        };
+
+        /** Constructor.
+        @param name Name used in the log
+        */
+        AsyncReadQueue(const String& name = BLANKSTRING);
+        virtual ~AsyncReadQueue();
+
+        /** Sets the number of I/O threads, takes effect on the next startup.
+        @remarks
+            This is the number of reads in flight at once. Threads spend
+            most of their time waiting for the disk, so there can be more of
+            them than there are cores.
+        */
+        void setThreadCount(size_t count) { mThreadCount = count; }
+
+        /** Gets the number of I/O threads. */
+        size_t getThreadCount() const { return mThreadCount; }
+
+        /** Starts the I/O threads.
+        @param forceRestart If the queue is already running, whether to shut
+            it down and restart.
+        */
+        void startup(bool forceRestart = true);
+
+        /** Stops the I/O threads, after completing all the queued reads. */
+        void shutdown();
+
+        /** Reads part of a stream.
+        @param stream The stream to read
+        @param offset The position to read from
+        @param count The number of bytes to read, reads stop early at the
+            end of the stream
+        @param listener Notified once the read has completed
+        */
+        RequestID read(const DataStreamPtr& stream, size_t offset, size_t count, Listener* listener);
+
+        /** Opens a file from an archive and reads all of it.
+        @remarks
+            The archive must stay loaded until the read has completed.
+        */
+        RequestID readFile(Archive* archive, const String& filename, Listener* listener);
+
+        /** Opens a file from a resource group and reads all of it.
+        @see ResourceGroupManager::openResource
+        */
+        RequestID readFile(const String& filename, const String& group, Listener* listener);
+
+        /** Removes a read which hasn't started yet from the queue.
+        @return Whether the read was removed, its listener isn't called then
+        */
+        bool abortRequest(RequestID id);
+
+        /** The number of reads which haven't completed yet. */
+        size_t getPendingCount() const { return mNumPending.get(); }
+
+        /// Main function of the I/O threads
+        void _threadMain();
+
+    protected:
+        struct Request
+        {
+            RequestID id;
+            /// The stream to read, null when reading a file
+            DataStreamPtr stream;
+            size_t offset;
+            size_t count;
+            Archive* archive;
+            String filename;
+            String group;
+            Listener* listener;
+        };
+
+        struct _OgreExport WorkerFunc OGRE_THREAD_WORKER_INHERIT
+        {
+            AsyncReadQueue* mQueue;
+
+            WorkerFunc(AsyncReadQueue* queue) : mQueue(queue) {}
+
+            void operator()();
+
+            void operator()() const;
+
+            void run();
+        };
+
+        /// Queues a request, or processes it right away without I/O threads
+        RequestID addRequest(Request& request);
+
+        /// Runs a read and notifies the listener
+        void processRequest(const Request& request);
+
+        /// Reads the bytes of a request from its stream
+        MemoryDataStreamPtr readStream(const Request& request, const DataStreamPtr& stream);
+
+        String mName;
+        size_t mThreadCount;
+        bool mIsRunning;
+        bool mShuttingDown;
+        AtomicScalar<RequestID> mNextRequestID;
+        AtomicScalar<size_t> mNumPending;
+
+        typedef deque<Request>::type RequestQueue;
+        RequestQueue mQueue;
+        /// Streams with a read running, so that their next read waits
+        typedef set<DataStream*>::type StreamSet;
+        StreamSet mBusyStreams;
+        OGRE_MUTEX(mQueueMutex);
+#if OGRE_ASYNC_READ_THREADS
+        OGRE_THREAD_SYNCHRONISER(mQueueCondition);
+        typedef vector<OGRE_THREAD_TYPE*>::type ThreadList;
+        ThreadList mThreads;
+        WorkerFunc* mWorkerFunc;
+#endif
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "../OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,276 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreTaskScheduler_H__
+#define __OgreTaskScheduler_H__
+
+#include "../OgrePrerequisites.h"
+#include "../OgreAtomicScalar.h"
+#include "../OgreHeaderPrefix.h"
+
+/// Whether the task scheduler runs tasks on worker threads, the TBB
+/// provider lacks the primitives it needs and runs them serially
+#if OGRE_THREAD_SUPPORT && OGRE_THREAD_PROVIDER != 3
+#   define OGRE_TASK_SCHEDULER_THREADS 1
+#else
+#   define OGRE_TASK_SCHEDULER_THREADS 0
+#endif
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+    /** A unit of work to be run by a TaskScheduler.
+    @remarks
+        Subclasses implement execute. A task may depend on other tasks, in
+        which case it is only run once all of them have finished. Tasks are
+        owned by the caller, and must stay alive until they have finished.
+        A finished task can be submitted again, its dependencies have to be
+        added again first.
+    */
+    class _OgreExport Task : public UtilityAlloc
+    {
+        friend class TaskScheduler;
+    public:
+        Task();
+        virtual ~Task();
+
+        /** Runs the work of the task, on any thread.
+        @note
+            Must not throw.
+        */
+        virtual void execute() = 0;
+
+        /** Makes this task wait for another one to finish before it is run.
+        @remarks
+            Must be called before this task is submitted, the other task
+            may have been submitted or even finished already.
+        */
+        void addDependency(Task* task);
+
+        /** Whether the task has finished running since it was last submitted. */
+        bool isFinished() const { return mFinished.get() != 0; }
+
+    protected:
+        typedef vector<Task*>::type TaskList;
+
+        /// Dependencies still running, plus one until the task is submitted
+        AtomicScalar<uint32> mUnfinished;
+        AtomicScalar<uint32> mFinished;
+        /// Tasks depending on this one, guarded by mDependentsMutex
+        TaskList mDependents;
+        /// Set once the task has finished and doesn't take dependents anymore
+        bool mDependentsClosed;
+        OGRE_MUTEX(mDependentsMutex);
+        TaskScheduler* mScheduler;
+    };
+
+    /** Runs tasks and data parallel loops on a pool of worker threads.
+    @remarks
+        This is meant for fine grained work which is started and waited for
+        within the same frame, such as culling or animation, while WorkQueue
+        remains the place for background jobs which respond asynchronously.
+    @par
+        Threads waiting for a task help running the queued tasks instead of
+        blocking, so tasks can wait for other tasks without starving the
+        pool. Without worker threads, or when OGRE_THREAD_SUPPORT is 0, all
+        tasks run on the thread calling wait or parallelFor, in an order
+        satisfying their dependencies.
+    */
+    class _OgreExport TaskScheduler : public UtilityAlloc
+    {
+    public:
+        /** Constructor.
+        @param name Name used in the log
+        */
+        TaskScheduler(const String& name = BLANKSTRING);
+        virtual ~TaskScheduler();
+
+        /** Sets the number of worker threads, besides the threads waiting for
+            tasks, takes effect on the next startup.
+        */
+        void setWorkerThreadCount(size_t count) { mWorkerThreadCount = count; }
+
+        /** Gets the number of worker threads. */
+        size_t getWorkerThreadCount() const { return mWorkerThreadCount; }
+
+        /** Starts the worker threads.
+        @param forceRestart If the scheduler is already running, whether to
+            shut it down and restart.
+        */
+        void startup(bool forceRestart = true);
+
+        /** Stops the worker threads, after running all the queued tasks. */
+        void shutdown();
+
+        /** Queues a task, it is run as soon as all its dependencies have finished. */
+        void submit(Task* task);
+
+        /** Returns once the task has finished, running queued tasks meanwhile. */
+        void wait(Task* task);
+
+        /** Submits a task and waits for it. */
+        void run(Task* task) { submit(task); wait(task); }
+
+        /** Calls func(begin, end) for consecutive sub ranges of [first, last)
+            in parallel, and returns once the whole range has been processed.
+        @remarks
+            func is shared by all the threads. Its operator() must be const
+            and safe to call concurrently for disjoint sub ranges.
+        @param first, last The range of indices
+        @param grainSize The maximum number of indices per call, 0 to split
+            the range evenly over the available threads
+        @param func Functor with a void operator()(size_t begin, size_t end) const
+        */
+        template <typename Func>
+        void parallelFor(size_t first, size_t last, size_t grainSize, const Func& func)
+        {
+            if (first >= last)
+                return;
+
+            size_t numThreads = getNumThreads();
+            if (!grainSize)
+                grainSize = (last - first + numThreads - 1) / numThreads;
+            size_t numChunks = (last - first + grainSize - 1) / grainSize;
+            if (numChunks == 1 || numThreads == 1)
+            {
+                // Not worth the synchronisation
+                for (size_t begin = first; begin < last; begin += grainSize)
+                    func(begin, std::min(begin + grainSize, last));
+                return;
+            }
+
+            ParallelForRange<Func> range(first, last, grainSize, func);
+            size_t numHelpers = std::min(numChunks, numThreads) - 1;
+            typename vector<ParallelForTask<Func> >::type helpers(numHelpers, ParallelForTask<Func>(&range));
+            for (size_t i = 0; i < numHelpers; ++i)
+                submit(&helpers[i]);
+            // Take part, helpers which start too late find nothing left to do
+            range.process();
+            for (size_t i = 0; i < numHelpers; ++i)
+                wait(&helpers[i]);
+        }
+
+        /** The number of threads tasks are spread over, including the
+            calling thread.
+        */
+        size_t getNumThreads() const;
+
+        /** Runs one queued task, if any.
+        @return Whether a task was run
+        */
+        bool _runNextTask();
+
+        /// Main function of the worker threads
+        void _threadMain();
+
+    protected:
+        /// Shared state of a parallelFor, hands out the chunks
+        template <typename Func>
+        struct ParallelForRange
+        {
+            AtomicScalar<size_t> next;
+            size_t last;
+            size_t grainSize;
+            const Func& func;
+
+            ParallelForRange(size_t first, size_t l, size_t grain, const Func& f)
+                : next(first), last(l), grainSize(grain), func(f) {}
+
+            void process()
+            {
+                while (true)
+                {
+                    size_t end = (next += grainSize);
+                    size_t begin = end - grainSize;
+                    if (begin >= last)
+                        return;
+                    func(begin, std::min(end, last));
+                }
+            }
+        };
+
+        template <typename Func>
+        class ParallelForTask : public Task
+        {
+            ParallelForRange<Func>* mRange;
+        public:
+            ParallelForTask(ParallelForRange<Func>* range) : mRange(range) {}
+            ParallelForTask(const ParallelForTask& rhs) : Task(), mRange(rhs.mRange) {}
+            void execute() { mRange->process(); }
+        };
+
+        struct _OgreExport WorkerFunc OGRE_THREAD_WORKER_INHERIT
+        {
+            TaskScheduler* mScheduler;
+
+            WorkerFunc(TaskScheduler* scheduler) : mScheduler(scheduler) {}
+
+            void operator()();
+
+            void operator()() const;
+
+            void run();
+        };
+
+        /// Queues a task whose dependencies have all finished
+        void enqueue(Task* task);
+
+        /// Marks the task finished and queues the dependents it was holding back
+        void finish(Task* task);
+
+        String mName;
+        size_t mWorkerThreadCount;
+        bool mIsRunning;
+        bool mShuttingDown;
+
+        typedef deque<Task*>::type TaskQueue;
+        TaskQueue mQueue;
+        /// Number of tasks in mQueue, so idle threads can check without locking
+        AtomicScalar<size_t> mNumQueued;
+        OGRE_MUTEX(mQueueMutex);
+#if OGRE_TASK_SCHEDULER_THREADS
+        /// Number of threads sleeping in wait or _threadMain
+        AtomicScalar<size_t> mNumSleeping;
+        OGRE_THREAD_SYNCHRONISER(mQueueCondition);
+        typedef vector<OGRE_THREAD_TYPE*>::type WorkerThreadList;
+        WorkerThreadList mWorkers;
+        WorkerFunc* mWorkerFunc;
+#endif
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "../OgreHeaderSuffix.h"
+
+#endif
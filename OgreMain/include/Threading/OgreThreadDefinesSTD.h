@@ -82,6 +82,92 @@ namespace Ogre
 
     template< typename T >
     thread_local std::int64_t ThreadLocalPtr<T>::m_VarCounter = 0;
+
+    /** Reader/writer mutex, std::shared_timed_mutex needs C++14.
+    @remarks
+        While no writer holds or waits for the mutex, readers only update an
+        atomic count and never wait for each other. A waiting writer keeps new
+        readers out until it is done. Not recursive.
+    */
+    class SharedMutex
+    {
+    private:
+        SharedMutex(const SharedMutex&) = delete;
+        SharedMutex& operator = (const SharedMutex&) = delete;
+
+        /// Set in mState while a writer holds or waits for the mutex
+        static const std::uint32_t WRITER = 0x80000000u;
+
+        /// Readers holding the mutex plus the WRITER bit
+        std::atomic<std::uint32_t> mState;
+        bool mWriterEntered;
+        std::mutex mMutex;
+        /// Signalled when a writer leaves
+        std::condition_variable mGate;
+        /// Signalled when the last reader leaves while a writer waits
+        std::condition_variable mWriterGate;
+
+        bool tryLockShared()
+        {
+            std::uint32_t state = mState.load();
+            while (!(state & WRITER))
+            {
+                if (mState.compare_exchange_weak(state, state + 1))
+                    return true;
+            }
+            return false;
+        }
+    public:
+        SharedMutex() : mState(0), mWriterEntered(false) {}
+
+        void lock_shared()
+        {
+            if (tryLockShared())
+                return;
+            std::unique_lock<std::mutex> lock(mMutex);
+            mGate.wait(lock, [this] { return tryLockShared(); });
+        }
+
+        void unlock_shared()
+        {
+            if (--mState == WRITER)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mWriterGate.notify_one();
+            }
+        }
+
+        void lock()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mGate.wait(lock, [this] { return !mWriterEntered; });
+            mWriterEntered = true;
+            mState |= WRITER;
+            mWriterGate.wait(lock, [this] { return mState.load() == WRITER; });
+        }
+
+        void unlock()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mWriterEntered = false;
+                mState &= ~WRITER;
+            }
+            mGate.notify_all();
+        }
+
+        /// Scoped shared lock
+        class ReadLock
+        {
+        private:
+            ReadLock(const ReadLock&) = delete;
+            ReadLock& operator = (const ReadLock&) = delete;
+            SharedMutex& mMutex;
+        public:
+            explicit ReadLock(SharedMutex& mutex) : mMutex(mutex) { mMutex.lock_shared(); }
+            ~ReadLock() { mMutex.unlock_shared(); }
+        };
+    };
 }
 
 #define OGRE_TOKEN_PASTE(x, y) x ## y
@@ -110,9 +196,9 @@ namespace Ogre
 #define OGRE_THREAD_NOTIFY_ALL(sync) sync.notify_all()
 
 // Read-write mutex
-#define OGRE_RW_MUTEX(name) mutable std::recursive_mutex name
-#define OGRE_LOCK_RW_MUTEX_READ(name) std::unique_lock<std::recursive_mutex> OGRE_TOKEN_PASTE_EXTRA(ogrenameLock, __LINE__) (name)
-#define OGRE_LOCK_RW_MUTEX_WRITE(name) std::unique_lock<std::recursive_mutex> OGRE_TOKEN_PASTE_EXTRA(ogrenameLock, __LINE__) (name)
+#define OGRE_RW_MUTEX(name) mutable Ogre::SharedMutex name
+#define OGRE_LOCK_RW_MUTEX_READ(name) Ogre::SharedMutex::ReadLock OGRE_TOKEN_PASTE_EXTRA(ogrenameLock, __LINE__) (name)
+#define OGRE_LOCK_RW_MUTEX_WRITE(name) std::unique_lock<Ogre::SharedMutex> OGRE_TOKEN_PASTE_EXTRA(ogrenameLock, __LINE__) (name)
 
 // Thread-local pointer
 #define OGRE_THREAD_POINTER(T, var) Ogre::ThreadLocalPtr<T> var
@@ -26,6 +26,7 @@ THE SOFTWARE
 #ifndef __OgreThreadHeadersSTD_H__
 #define __OgreThreadHeadersSTD_H__
 
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -0,0 +1,234 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreWorkStealingWorkQueue_H__
+#define __OgreWorkStealingWorkQueue_H__
+
+#include "../OgreWorkQueue.h"
+#include "../OgreAtomicScalar.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+    /** Work queue which distributes requests over per-worker lock-free queues.
+    @remarks
+        DefaultWorkQueue funnels every request through a single mutex protected
+        queue, which becomes a contention point when several subsystems submit
+        requests at the same time. This implementation gives every worker
+        thread its own bounded lock-free queue. Requests are spread over the
+        queues in round robin order, each worker takes requests from its own
+        queue first and steals from the queues of the other workers when its
+        own queue runs dry.
+    @par
+        The channel, RequestHandler and ResponseHandler contract is the same as
+        for DefaultWorkQueue, and so is the abort behaviour: queued and running
+        requests are flagged through a registry which is split into several
+        independently locked parts, so submitting threads and workers rarely
+        meet on the same lock. Requests for the idle thread, and requests which
+        don't fit in the worker queues, take the regular DefaultWorkQueueBase
+        path.
+    @par
+        To use it, create it in place of the default queue and hand it to
+        Root::setWorkQueue.
+    */
+    class _OgreExport WorkStealingWorkQueue : public DefaultWorkQueueBase
+    {
+    public:
+
+        WorkStealingWorkQueue(const String& name = BLANKSTRING);
+        virtual ~WorkStealingWorkQueue();
+
+        /** Main function for threads not started by this queue.
+        @remarks
+            The calling thread has no queue of its own and only steals.
+        */
+        virtual void _threadMain();
+
+        /** Main function for each thread spawned. */
+        virtual void _threadMain(size_t workerIndex);
+
+        /// @copydoc DefaultWorkQueueBase::_processNextRequest
+        virtual void _processNextRequest();
+
+        /// @copydoc WorkQueue::shutdown
+        virtual void shutdown();
+
+        /// @copydoc WorkQueue::startup
+        virtual void startup(bool forceRestart = true);
+
+        /// @copydoc WorkQueue::addRequest
+        virtual RequestID addRequest(uint16 channel, uint16 requestType, const Any& rData, uint8 retryCount = 0,
+            bool forceSynchronous = false, bool idleThread = false);
+        /// @copydoc WorkQueue::abortRequest
+        virtual void abortRequest(RequestID id);
+        /// @copydoc WorkQueue::abortRequestsByChannel
+        virtual void abortRequestsByChannel(uint16 channel);
+        /// @copydoc WorkQueue::abortPendingRequestsByChannel
+        virtual void abortPendingRequestsByChannel(uint16 channel);
+        /// @copydoc WorkQueue::abortAllRequests
+        virtual void abortAllRequests();
+
+    protected:
+        /** Bounded lock-free queue of requests, safe for any number of
+            producers and consumers.
+        */
+        class _OgreExport RequestRing : public UtilityAlloc
+        {
+        protected:
+            struct Cell
+            {
+                /// Position of the cell in the sequence of pushes and pops
+                AtomicScalar<size_t> sequence;
+                Request* volatile request;
+            };
+            vector<Cell>::type mCells;
+            size_t mMask;
+            AtomicScalar<size_t> mPushPos;
+            /// Keeps producers and consumers off the same cache line
+            char mPad[64];
+            AtomicScalar<size_t> mPopPos;
+
+        public:
+            /// Capacity must be a power of two
+            RequestRing(size_t capacity);
+
+            /// Adds a request, false if the ring is full
+            bool push(Request* r);
+
+            /// Removes the oldest request, null if the ring is empty
+            Request* pop();
+        };
+
+        /// Thread function, knows which queue belongs to the thread
+        struct _OgreExport IndexedWorkerFunc OGRE_THREAD_WORKER_INHERIT
+        {
+            WorkStealingWorkQueue* mQueue;
+            size_t mIndex;
+
+            IndexedWorkerFunc(WorkStealingWorkQueue* q, size_t index)
+                : mQueue(q), mIndex(index) {}
+
+            void operator()();
+
+            void operator()() const;
+
+            void run();
+        };
+
+        /** Part of the registry of requests which have been queued but whose
+            processing has not finished yet.
+        */
+        struct PendingRequests
+        {
+            typedef map<RequestID, Request*>::type RequestMap;
+            OGRE_MUTEX(mutex);
+            RequestMap queued;
+            RequestMap processing;
+        };
+        static const size_t NUM_PENDING_PARTS = 16;
+        PendingRequests mPending[NUM_PENDING_PARTS];
+
+        PendingRequests& getPending(RequestID id) { return mPending[id % NUM_PENDING_PARTS]; }
+
+        typedef vector<RequestRing*>::type RequestRingList;
+        RequestRingList mRings; // Only changed by startup / shutdown
+        AtomicScalar<size_t> mNextRing;
+        AtomicScalar<RequestID> mNextRequestID;
+        /// Number of requests in the rings
+        AtomicScalar<size_t> mNumQueued;
+        /// Set when requests may be waiting in mRequestQueue
+        AtomicScalar<uint32> mOverflowQueued;
+        /// Set when requests may be waiting in mIdleRequestQueue
+        AtomicScalar<uint32> mIdleQueued;
+        AtomicScalar<size_t> mNumSleeping;
+
+        OGRE_MUTEX(mSleepMutex);
+        OGRE_THREAD_SYNCHRONISER(mRequestCondition);
+        size_t mNumThreadsRegisteredWithRS;
+        /// Init notification mutex (must lock before waiting on initCondition)
+        OGRE_MUTEX(mInitMutex);
+        /// Synchroniser token to wait / notify on thread init
+        OGRE_THREAD_SYNCHRONISER(mInitSync);
+#if OGRE_THREAD_SUPPORT
+        typedef vector<OGRE_THREAD_TYPE*>::type WorkerThreadList;
+        WorkerThreadList mWorkers;
+        typedef vector<IndexedWorkerFunc*>::type WorkerFuncList;
+        WorkerFuncList mWorkerFuncs;
+#endif
+
+        /// Notify that a thread has registered itself with the render system
+        void notifyThreadRegistered();
+
+        /// Notify workers about a request added to mRequestQueue or mIdleRequestQueue
+        virtual void notifyWorkers();
+
+        /// Wakes up one sleeping worker, if any
+        void wakeWorker();
+
+        /** Suspends the calling thread until new requests are added, returns
+            immediately if there might be requests already.
+        */
+        void waitForNextRequest();
+
+        /** Whether any requests might be waiting. */
+        bool hasQueuedRequests() const;
+
+        /** Puts a registered request into one of the rings, or the overflow
+            queue if they're all full.
+        */
+        void pushRequest(Request* r);
+
+        /** Takes the next request, trying the given worker's ring first.
+        @return The request, or null if none could be found
+        */
+        Request* takeRequest(size_t workerIndex);
+
+        /** Processes the next request, trying the given worker's ring first.
+        @return Whether a request was processed
+        */
+        bool processNextRequest(size_t workerIndex);
+
+        /** Calls the request handlers for the request. */
+        Response* handleRequest(Request* r);
+
+        /** Processes a request taken from the queues and queues its response. */
+        void processQueuedRequest(Request* r);
+
+        /** Processes a request on the calling thread and its response right away. */
+        void processRequestSynchronous(Request* r);
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#endif
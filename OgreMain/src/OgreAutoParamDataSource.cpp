@@ -48,10 +48,16 @@ namespace Ogre {
         0,      0,    1,    0,
         0,      0,    0,    1);
 
+    namespace {
+        /// Shared by all the data sources, so versions never repeat
+        uint64 VersionCounter = 0;
+    }
+
     //-----------------------------------------------------------------------------
     AutoParamDataSource::AutoParamDataSource()
         : mWorldMatrixCount(0),
          mWorldMatrixArray(0),
+         mDirLightExtrusionDistance(0),
          mWorldMatrixDirty(true),
          mViewMatrixDirty(true),
          mProjMatrixDirty(true),
@@ -65,6 +71,7 @@ namespace Ogre {
          mInverseTransposeWorldViewMatrixDirty(true),
          mCameraPositionDirty(true),
          mCameraPositionObjectSpaceDirty(true),
+         mFogParams(Vector4::ZERO),
          mPassNumber(0),
          mSceneDepthRangeDirty(true),
          mLodCameraPositionDirty(true),
@@ -77,7 +84,9 @@ namespace Ogre {
          mCurrentViewport(0), 
          mCurrentSceneManager(0),
          mMainCamBoundsInfo(0),
-         mCurrentPass(0)
+         mCurrentPass(0),
+         mUseIdentityView(false),
+         mUseIdentityProjection(false)
     {
         mBlankLight.setDiffuseColour(ColourValue::Black);
         mBlankLight.setSpecularColour(ColourValue::Black);
@@ -91,12 +100,22 @@ namespace Ogre {
             mCurrentTextureProjector[i] = 0;
             mShadowCamDepthRangesDirty[i] = false;
         }
-
+        _markChanged(IG_ALL);
     }
     //-----------------------------------------------------------------------------
     AutoParamDataSource::~AutoParamDataSource()
     {
     }
+    //-----------------------------------------------------------------------------
+    void AutoParamDataSource::_markChanged(uint16 inputs)
+    {
+        uint64 version = ++VersionCounter;
+        for (size_t i = 0; i < NUM_INPUT_GROUPS; ++i)
+        {
+            if (inputs & (1 << i))
+                mVersions[i] = version;
+        }
+    }
     //-----------------------------------------------------------------------------
 	const Camera* AutoParamDataSource::getCurrentCamera() const
 	{
@@ -138,6 +157,15 @@ namespace Ogre {
             mSpotlightWorldViewProjMatrixDirty[i] = true;
         }
 
+        // The view and projection matrices depend on the renderable too
+        bool identityView = rend && rend->getUseIdentityView();
+        bool identityProjection = rend && rend->getUseIdentityProjection();
+        if (identityView != mUseIdentityView || identityProjection != mUseIdentityProjection)
+        {
+            mUseIdentityView = identityView;
+            mUseIdentityProjection = identityProjection;
+            _markChanged(IG_CAMERA);
+        }
     }
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentCamera(const Camera* cam, bool useCameraRelative)
@@ -157,6 +185,9 @@ namespace Ogre {
         mCameraPositionDirty = true;
         mLodCameraPositionObjectSpaceDirty = true;
         mLodCameraPositionDirty = true;
+        // Lights, passes and the scene are read from their objects, which may have
+        // changed since the camera was last set
+        _markChanged(IG_ALL);
     }
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentLightList(const LightList* ll)
@@ -167,7 +198,7 @@ namespace Ogre {
             mSpotlightViewProjMatrixDirty[i] = true;
             mSpotlightWorldViewProjMatrixDirty[i] = true;
         }
-
+        _markChanged(IG_LIGHTS);
     }
     //---------------------------------------------------------------------
     float AutoParamDataSource::getLightNumber(size_t index) const
@@ -267,10 +298,13 @@ namespace Ogre {
     {
         mMainCamBoundsInfo = info;
         mSceneDepthRangeDirty = true;
+        _markChanged(IG_SCENE);
     }
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentSceneManager(const SceneManager* sm)
     {
+        if (sm != mCurrentSceneManager)
+            _markChanged(IG_SCENE);
         mCurrentSceneManager = sm;
     }
     //-----------------------------------------------------------------------------
@@ -521,6 +555,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setAmbientLightColour(const ColourValue& ambient)
     {
+        if (ambient != mAmbientLight)
+            _markChanged(IG_SCENE);
         mAmbientLight = ambient;
     }
     //---------------------------------------------------------------------
@@ -542,6 +578,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentPass(const Pass* pass)
     {
+        if (pass != mCurrentPass)
+            _markChanged(IG_PASS);
         mCurrentPass = pass;
     }
     //-----------------------------------------------------------------------------
@@ -627,11 +665,12 @@ namespace Ogre {
         Real expDensity, Real linearStart, Real linearEnd)
     {
         (void)mode; // ignored
+        Vector4 params(expDensity, linearStart, linearEnd,
+                       linearEnd != linearStart ? 1 / (linearEnd - linearStart) : 0);
+        if (colour != mFogColour || params != mFogParams)
+            _markChanged(IG_SCENE);
         mFogColour = colour;
-        mFogParams.x = expDensity;
-        mFogParams.y = linearStart;
-        mFogParams.z = linearEnd;
-        mFogParams.w = linearEnd != linearStart ? 1 / (linearEnd - linearStart) : 0;
+        mFogParams = params;
     }
     //-----------------------------------------------------------------------------
     const ColourValue& AutoParamDataSource::getFogColour(void) const
@@ -648,6 +687,8 @@ namespace Ogre {
     {
         if (index < OGRE_MAX_SIMULTANEOUS_LIGHTS)
         {
+            if (frust != mCurrentTextureProjector[index])
+                _markChanged(IG_LIGHTS);
             mCurrentTextureProjector[index] = frust;
             mTextureViewProjMatrixDirty[index] = true;
             mTextureWorldViewProjMatrixDirty[index] = true;
@@ -801,6 +842,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentRenderTarget(const RenderTarget* target)
     {
+        if (target != mCurrentRenderTarget)
+            _markChanged(IG_CAMERA);
         mCurrentRenderTarget = target;
     }
     //-----------------------------------------------------------------------------
@@ -811,11 +854,15 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setCurrentViewport(const Viewport* viewport)
     {
+        if (viewport != mCurrentViewport)
+            _markChanged(IG_CAMERA);
         mCurrentViewport = viewport;
     }
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setShadowDirLightExtrusionDistance(Real dist)
     {
+        if (dist != mDirLightExtrusionDistance)
+            _markChanged(IG_LIGHTS);
         mDirLightExtrusionDistance = dist;
     }
     //-----------------------------------------------------------------------------
@@ -1056,11 +1103,14 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::setPassNumber(const int passNumber)
     {
+        if (passNumber != mPassNumber)
+            _markChanged(IG_PASS);
         mPassNumber = passNumber;
     }
     //-----------------------------------------------------------------------------
     void AutoParamDataSource::incPassNumber(void)
     {
+        _markChanged(IG_PASS);
         ++mPassNumber;
     }
     //-----------------------------------------------------------------------------
@@ -879,6 +879,19 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    bool Camera::isVisible(const float* centres, const float* halfSizes,
+        size_t numBoxes, uint32* visibility) const
+    {
+        if (mCullFrustum)
+        {
+            return mCullFrustum->isVisible(centres, halfSizes, numBoxes, visibility);
+        }
+        else
+        {
+            return Frustum::isVisible(centres, halfSizes, numBoxes, visibility);
+        }
+    }
+    //-----------------------------------------------------------------------
     bool Camera::isVisible(const Sphere& bound, FrustumPlane* culledBy) const
     {
         if (mCullFrustum)
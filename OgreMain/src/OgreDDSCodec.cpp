@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreLogManager.h"
 #include "OgreBitwise.h"
+#include "Threading/OgreTaskScheduler.h"
 
 namespace Ogre {
     // Internal DDS structure definitions
@@ -103,22 +104,6 @@ namespace Ogre {
         // 16 2-bit indexes, each byte here is one row
         uint8 indexRow[4];
     };
-    // An 8-byte DXT explicit alpha block, represents a 4x4 texel area. Used by DXT2/3
-    struct DXTExplicitAlphaBlock
-    {
-        // 16 4-bit values, each 16-bit value is one row
-        uint16 alphaRow[4];
-    };
-    // An 8-byte DXT interpolated alpha block, represents a 4x4 texel area. Used by DXT4/5
-    struct DXTInterpolatedAlphaBlock
-    {
-        // 2 alpha ranges
-        uint8 alpha_0;
-        uint8 alpha_1;
-        // 16 3-bit indexes. Unfortunately 3 bits doesn't map too well to row bytes
-        // so just stored raw
-        uint8 indexes[6];
-    };
     
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #pragma pack (pop)
@@ -135,6 +120,7 @@ namespace Ogre {
     const uint32 DDSD_HEIGHT = 0x00000002;
     const uint32 DDSD_WIDTH = 0x00000004;
     const uint32 DDSD_PIXELFORMAT = 0x00001000;
+    const uint32 DDSD_LINEARSIZE = 0x00080000;
     const uint32 DDSD_DEPTH = 0x00800000;
     const uint32 DDPF_ALPHAPIXELS = 0x00000001;
     const uint32 DDPF_FOURCC = 0x00000004;
@@ -154,7 +140,6 @@ namespace Ogre {
     // Currently unused
 //    const uint32 DDSD_PITCH = 0x00000008;
 //    const uint32 DDSD_MIPMAPCOUNT = 0x00020000;
-//    const uint32 DDSD_LINEARSIZE = 0x00080000;
 
     // Special FourCC codes
     const uint32 D3DFMT_R16F            = 111;
@@ -164,6 +149,604 @@ namespace Ogre {
     const uint32 D3DFMT_G32R32F         = 115;
     const uint32 D3DFMT_A32B32G32R32F   = 116;
 
+    // Block compression, DXT2 and DXT4 are treated like DXT3 and DXT5
+    namespace
+    {
+        /// Bytes per 4x4 block
+        size_t getBlockSize(PixelFormat format)
+        {
+            return (format == PF_DXT1 || format == PF_BC4_UNORM) ? 8 : 16;
+        }
+
+        bool isSupportedBlockFormat(PixelFormat format)
+        {
+            switch (format)
+            {
+            case PF_DXT1:
+            case PF_DXT2:
+            case PF_DXT3:
+            case PF_DXT4:
+            case PF_DXT5:
+            case PF_BC4_UNORM:
+            case PF_BC5_UNORM:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        /// Expands an R5G6B5 colour to 8 bits per channel
+        void unpack565(uint32 colour, uint8* rgba)
+        {
+            uint32 r = (colour >> 11) & 0x1F, g = (colour >> 5) & 0x3F, b = colour & 0x1F;
+            rgba[0] = static_cast<uint8>((r << 3) | (r >> 2));
+            rgba[1] = static_cast<uint8>((g << 2) | (g >> 4));
+            rgba[2] = static_cast<uint8>((b << 3) | (b >> 2));
+            rgba[3] = 0xFF;
+        }
+
+        /** Builds the 4 colours a colour block's indexes refer to, the way
+            decoding does, so the encoder picks indexes against the same values.
+        */
+        void buildColourPalette(uint32 colour0, uint32 colour1, bool dxt1, uint8 palette[4][4])
+        {
+            unpack565(colour0, palette[0]);
+            unpack565(colour1, palette[1]);
+            if (dxt1 && colour0 <= colour1)
+            {
+                // One colour half way between the others, and transparent black
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    palette[2][i] = static_cast<uint8>((palette[0][i] + palette[1][i] + 1) / 2);
+                    palette[3][i] = 0;
+                }
+                palette[2][3] = 0xFF;
+                palette[3][3] = 0;
+            }
+            else
+            {
+                // Two colours 1/3 and 2/3 of the way along
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    palette[2][i] = static_cast<uint8>((2 * palette[0][i] + palette[1][i] + 1) / 3);
+                    palette[3][i] = static_cast<uint8>((palette[0][i] + 2 * palette[1][i] + 1) / 3);
+                }
+                palette[2][3] = palette[3][3] = 0xFF;
+            }
+        }
+
+        /** Builds the 8 values an interpolated alpha block's indexes refer to. */
+        void buildAlphaPalette(uint32 alpha0, uint32 alpha1, uint8 palette[8])
+        {
+            palette[0] = static_cast<uint8>(alpha0);
+            palette[1] = static_cast<uint8>(alpha1);
+            if (alpha0 > alpha1)
+            {
+                // 6 values in between
+                for (uint32 i = 1; i < 7; ++i)
+                    palette[i + 1] = static_cast<uint8>(((7 - i) * alpha0 + i * alpha1 + 3) / 7);
+            }
+            else
+            {
+                // 4 values in between, plus both extremes
+                for (uint32 i = 1; i < 5; ++i)
+                    palette[i + 1] = static_cast<uint8>(((5 - i) * alpha0 + i * alpha1 + 2) / 5);
+                palette[6] = 0;
+                palette[7] = 0xFF;
+            }
+        }
+
+        /** Decodes a colour block: two R5G6B5 colours, then 2 bit indexes of
+            the texels in rows, least significant bits first.
+        @param dxt1 Whether the block is DXT1, which may have transparency,
+            otherwise alpha is left alone
+        */
+        void decodeColourBlock(const uint8* block, uint8* rgba, bool dxt1)
+        {
+            uint8 palette[4][4];
+            buildColourPalette(block[0] | (block[1] << 8), block[2] | (block[3] << 8), dxt1, palette);
+
+            uint32 indexes = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32(block[7]) << 24);
+            size_t texelSize = dxt1 ? 4 : 3;
+            for (size_t i = 0; i < 16; ++i, indexes >>= 2)
+                memcpy(rgba + i * 4, palette[indexes & 0x3], texelSize);
+        }
+
+        /** Decodes an interpolated alpha block, as used by DXT5, BC4 and BC5:
+            two values, then 3 bit indexes of the texels.
+        @param stride Bytes between the values written
+        */
+        void decodeAlphaBlock(const uint8* block, uint8* values, size_t stride)
+        {
+            uint8 palette[8];
+            buildAlphaPalette(block[0], block[1], palette);
+
+            uint64 indexes = 0;
+            for (size_t i = 0; i < 6; ++i)
+                indexes |= uint64(block[i + 2]) << (i * 8);
+            for (size_t i = 0; i < 16; ++i, indexes >>= 3)
+                values[i * stride] = palette[indexes & 0x7];
+        }
+
+        /// Decodes an explicit alpha block of DXT3, 4 bits per texel
+        void decodeExplicitAlphaBlock(const uint8* block, uint8* rgba)
+        {
+            for (size_t i = 0; i < 16; ++i)
+                rgba[i * 4 + 3] = static_cast<uint8>(((block[i / 2] >> ((i & 1) * 4)) & 0xF) * 0x11);
+        }
+
+        /// Decodes a block into 16 RGBA texels
+        void decodeBlock(PixelFormat format, const uint8* block, uint8* rgba)
+        {
+            switch (format)
+            {
+            case PF_DXT1:
+                decodeColourBlock(block, rgba, true);
+                break;
+            case PF_DXT2:
+            case PF_DXT3:
+                decodeExplicitAlphaBlock(block, rgba);
+                decodeColourBlock(block + 8, rgba, false);
+                break;
+            case PF_DXT4:
+            case PF_DXT5:
+                decodeAlphaBlock(block, rgba + 3, 4);
+                decodeColourBlock(block + 8, rgba, false);
+                break;
+            case PF_BC4_UNORM:
+                for (size_t i = 0; i < 16; ++i)
+                    rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0, rgba[i * 4 + 3] = 0xFF;
+                decodeAlphaBlock(block, rgba, 4);
+                break;
+            case PF_BC5_UNORM:
+                for (size_t i = 0; i < 16; ++i)
+                    rgba[i * 4 + 2] = 0, rgba[i * 4 + 3] = 0xFF;
+                decodeAlphaBlock(block, rgba, 4);
+                decodeAlphaBlock(block + 8, rgba + 1, 4);
+                break;
+            default:
+                break;
+            }
+        }
+
+        /// Squared distance of two RGB colours
+        inline uint32 colourDistance(const uint8* a, const uint8* b)
+        {
+            int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+            return static_cast<uint32>(dr * dr + dg * dg + db * db);
+        }
+
+        /// Rounds a colour with 8 bits per channel to R5G6B5
+        uint32 pack565(const float* rgb)
+        {
+            int r = static_cast<int>(Math::Clamp(rgb[0], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+            int g = static_cast<int>(Math::Clamp(rgb[1], 0.0f, 255.0f) * (63.0f / 255.0f) + 0.5f);
+            int b = static_cast<int>(Math::Clamp(rgb[2], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+            return static_cast<uint32>((r << 11) | (g << 5) | b);
+        }
+
+        /** Picks the closest palette entry for every texel.
+        @param transparent Texels to use the transparent entry of a DXT1 block
+            for, or null
+        @param threeColours Whether the last entry is DXT1's transparent one
+        @return The squared error of the opaque texels
+        */
+        uint32 pickColourIndexes(const uint8* rgba, const bool* transparent, bool threeColours,
+            const uint8 palette[4][4], uint8* indexes)
+        {
+            uint32 error = 0;
+            uint8 numCandidates = threeColours ? 3 : 4;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                if (transparent && transparent[i])
+                {
+                    indexes[i] = 3;
+                    continue;
+                }
+                uint32 best = colourDistance(rgba + i * 4, palette[0]);
+                indexes[i] = 0;
+                for (uint8 j = 1; j < numCandidates; ++j)
+                {
+                    uint32 d = colourDistance(rgba + i * 4, palette[j]);
+                    if (d < best)
+                    {
+                        best = d;
+                        indexes[i] = j;
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        /** Puts two R5G6B5 colours in the order which selects the palette
+            wanted, and picks the indexes.
+        @return The squared error
+        */
+        uint32 fitColourBlock(uint32& colour0, uint32& colour1, const uint8* rgba,
+            const bool* transparent, bool dxt1, uint8* indexes)
+        {
+            // DXT1 blocks with transparent texels need the 3 colour palette,
+            // all others the 4 colour one, which only has to be avoided when
+            // both colours are the same
+            if (transparent ? colour0 > colour1 : colour0 < colour1)
+                std::swap(colour0, colour1);
+            uint8 palette[4][4];
+            buildColourPalette(colour0, colour1, dxt1, palette);
+            return pickColourIndexes(rgba, transparent, dxt1 && colour0 <= colour1, palette, indexes);
+        }
+
+        /** Encodes 16 RGBA texels as a colour block.
+        @remarks
+            The end points are the extremes of the texels along their
+            principal axis, which are then refined by a least squares fit to
+            the indexes picked, if that lowers the error.
+        */
+        void encodeColourBlock(const uint8* rgba, uint8* block, bool dxt1)
+        {
+            // With DXT1, texels with little alpha are made transparent
+            bool transparent[16];
+            bool anyTransparent = false;
+            float mean[3] = { 0, 0, 0 };
+            size_t numOpaque = 0;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                transparent[i] = dxt1 && rgba[i * 4 + 3] < 128;
+                anyTransparent |= transparent[i];
+                if (transparent[i])
+                    continue;
+                for (size_t c = 0; c < 3; ++c)
+                    mean[c] += rgba[i * 4 + c];
+                ++numOpaque;
+            }
+
+            uint32 colour0 = 0, colour1 = 0;
+            uint8 indexes[16];
+            if (numOpaque == 0)
+            {
+                // Both colours black selects the 3 colour palette
+                for (size_t i = 0; i < 16; ++i)
+                    indexes[i] = 3;
+            }
+            else
+            {
+                for (size_t c = 0; c < 3; ++c)
+                    mean[c] /= numOpaque;
+
+                // Covariance, then the principal axis by power iteration,
+                // starting from the diagonal of the bounding box
+                float cov[6] = { 0, 0, 0, 0, 0, 0 };
+                float minColour[3] = { 255, 255, 255 }, maxColour[3] = { 0, 0, 0 };
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    if (transparent[i])
+                        continue;
+                    float d[3];
+                    for (size_t c = 0; c < 3; ++c)
+                    {
+                        d[c] = rgba[i * 4 + c] - mean[c];
+                        minColour[c] = std::min(minColour[c], float(rgba[i * 4 + c]));
+                        maxColour[c] = std::max(maxColour[c], float(rgba[i * 4 + c]));
+                    }
+                    cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+                    cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+                }
+                float axis[3] = { maxColour[0] - minColour[0], maxColour[1] - minColour[1],
+                    maxColour[2] - minColour[2] };
+                for (int iteration = 0; iteration < 4; ++iteration)
+                {
+                    float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                    float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                    float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                    float length = std::max(std::max(Math::Abs(x), Math::Abs(y)), Math::Abs(z));
+                    if (length < 1e-6f)
+                        break;
+                    axis[0] = x / length;
+                    axis[1] = y / length;
+                    axis[2] = z / length;
+                }
+
+                // The extremes along the axis
+                float minDot = std::numeric_limits<float>::max(), maxDot = -minDot;
+                const uint8* minTexel = 0;
+                const uint8* maxTexel = 0;
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    if (transparent[i])
+                        continue;
+                    const uint8* texel = rgba + i * 4;
+                    float dot = texel[0] * axis[0] + texel[1] * axis[1] + texel[2] * axis[2];
+                    if (dot < minDot)
+                    {
+                        minDot = dot;
+                        minTexel = texel;
+                    }
+                    if (dot > maxDot)
+                    {
+                        maxDot = dot;
+                        maxTexel = texel;
+                    }
+                }
+                float end0[3] = { float(maxTexel[0]), float(maxTexel[1]), float(maxTexel[2]) };
+                float end1[3] = { float(minTexel[0]), float(minTexel[1]), float(minTexel[2]) };
+                colour0 = pack565(end0);
+                colour1 = pack565(end1);
+                bool* transparentTexels = anyTransparent ? transparent : 0;
+                uint32 error = fitColourBlock(colour0, colour1, rgba, transparentTexels, dxt1, indexes);
+
+                // Least squares end points for the indexes of the 4 colour palette
+                if (!(dxt1 && colour0 <= colour1) && error > 0)
+                {
+                    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+                    float aa = 0, bb = 0, ab = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+                    for (size_t i = 0; i < 16; ++i)
+                    {
+                        float a = weights[indexes[i]], b = 1.0f - a;
+                        aa += a * a;
+                        bb += b * b;
+                        ab += a * b;
+                        for (size_t c = 0; c < 3; ++c)
+                        {
+                            ax[c] += a * rgba[i * 4 + c];
+                            bx[c] += b * rgba[i * 4 + c];
+                        }
+                    }
+                    float det = aa * bb - ab * ab;
+                    if (Math::Abs(det) > 1e-6f)
+                    {
+                        for (size_t c = 0; c < 3; ++c)
+                        {
+                            end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+                            end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+                        }
+                        uint32 refined0 = pack565(end0), refined1 = pack565(end1);
+                        uint8 refinedIndexes[16];
+                        if (fitColourBlock(refined0, refined1, rgba, transparentTexels, dxt1, refinedIndexes) < error)
+                        {
+                            colour0 = refined0;
+                            colour1 = refined1;
+                            memcpy(indexes, refinedIndexes, sizeof(indexes));
+                        }
+                    }
+                }
+            }
+
+            block[0] = static_cast<uint8>(colour0);
+            block[1] = static_cast<uint8>(colour0 >> 8);
+            block[2] = static_cast<uint8>(colour1);
+            block[3] = static_cast<uint8>(colour1 >> 8);
+            for (size_t row = 0; row < 4; ++row)
+            {
+                block[4 + row] = static_cast<uint8>(indexes[row * 4] | (indexes[row * 4 + 1] << 2) |
+                    (indexes[row * 4 + 2] << 4) | (indexes[row * 4 + 3] << 6));
+            }
+        }
+
+        /** Encodes 16 values as an interpolated alpha block, using the 8
+            value palette between their extremes.
+        @param stride Bytes between the values read
+        */
+        void encodeAlphaBlock(const uint8* values, size_t stride, uint8* block)
+        {
+            uint8 minValue = 0xFF, maxValue = 0;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                minValue = std::min(minValue, values[i * stride]);
+                maxValue = std::max(maxValue, values[i * stride]);
+            }
+
+            block[0] = maxValue;
+            block[1] = minValue;
+
+            // The palette runs from the maximum, index 0, over indexes 2 to 7
+            // to the minimum, index 1
+            uint64 indexes = 0;
+            int range = maxValue - minValue;
+            if (range)
+            {
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    int step = ((maxValue - values[i * stride]) * 14 + range) / (2 * range);
+                    uint64 index = step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+                    indexes |= index << (i * 3);
+                }
+            }
+            for (size_t i = 0; i < 6; ++i)
+                block[i + 2] = static_cast<uint8>(indexes >> (i * 8));
+        }
+
+        /// Encodes the alpha of 16 RGBA texels as an explicit alpha block
+        void encodeExplicitAlphaBlock(const uint8* rgba, uint8* block)
+        {
+            for (size_t i = 0; i < 8; ++i)
+            {
+                uint32 a0 = (rgba[i * 8 + 3] * 15 + 127) / 255;
+                uint32 a1 = (rgba[i * 8 + 7] * 15 + 127) / 255;
+                block[i] = static_cast<uint8>(a0 | (a1 << 4));
+            }
+        }
+
+        /// Encodes 16 RGBA texels as a block
+        void encodeBlock(PixelFormat format, const uint8* rgba, uint8* block)
+        {
+            switch (format)
+            {
+            case PF_DXT1:
+                encodeColourBlock(rgba, block, true);
+                break;
+            case PF_DXT2:
+            case PF_DXT3:
+                encodeExplicitAlphaBlock(rgba, block);
+                encodeColourBlock(rgba, block + 8, false);
+                break;
+            case PF_DXT4:
+            case PF_DXT5:
+                encodeAlphaBlock(rgba + 3, 4, block);
+                encodeColourBlock(rgba, block + 8, false);
+                break;
+            case PF_BC4_UNORM:
+                encodeAlphaBlock(rgba, 4, block);
+                break;
+            case PF_BC5_UNORM:
+                encodeAlphaBlock(rgba, 4, block);
+                encodeAlphaBlock(rgba + 1, 4, block + 8);
+                break;
+            default:
+                break;
+            }
+        }
+
+        /** Copies rows between RGBA texels and a box of any format.
+        @remarks
+            The formats the decoder produces are copied directly, the rest go
+            through PixelUtil::bulkPixelConversion.
+        */
+        void copyRows(const PixelBox& src, const PixelBox& dst)
+        {
+            PixelFormat format = src.format == PF_BYTE_RGBA ? dst.format : src.format;
+            bool toRGBA = dst.format == PF_BYTE_RGBA;
+            if (format != PF_BYTE_RGB && format != PF_R8 && format != PF_RG8)
+            {
+                PixelUtil::bulkPixelConversion(src, dst);
+                return;
+            }
+
+            size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
+            size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+            for (size_t y = 0; y < src.getHeight(); ++y)
+            {
+                const uint8* s = static_cast<const uint8*>(src.data) +
+                    ((src.top + y) * src.rowPitch + src.left + src.front * src.slicePitch) * srcPixelSize;
+                uint8* d = static_cast<uint8*>(dst.data) +
+                    ((dst.top + y) * dst.rowPitch + dst.left + dst.front * dst.slicePitch) * dstPixelSize;
+                for (size_t x = 0; x < src.getWidth(); ++x, s += srcPixelSize, d += dstPixelSize)
+                {
+                    switch (format)
+                    {
+                    case PF_BYTE_RGB:
+                        d[0] = s[0];
+                        d[1] = s[1];
+                        d[2] = s[2];
+                        if (toRGBA)
+                            d[3] = 0xFF;
+                        break;
+                    case PF_R8:
+                        if (toRGBA)
+                            d[0] = s[0], d[1] = d[2] = 0, d[3] = 0xFF;
+                        else
+                            d[0] = s[0];
+                        break;
+                    default:
+                        // PF_RG8 is native endian, red in the high byte
+                        if (toRGBA)
+                        {
+                            uint16 rg;
+                            memcpy(&rg, s, sizeof(rg));
+                            d[0] = static_cast<uint8>(rg >> 8);
+                            d[1] = static_cast<uint8>(rg);
+                            d[2] = 0;
+                            d[3] = 0xFF;
+                        }
+                        else
+                        {
+                            uint16 rg = static_cast<uint16>((s[0] << 8) | s[1]);
+                            memcpy(d, &rg, sizeof(rg));
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        /** Decompresses or compresses the rows of blocks in a range, counted
+            over all slices.
+        */
+        struct BlockRowCoder
+        {
+            const PixelBox* uncompressed;
+            const PixelBox* compressed;
+            bool encode;
+            size_t blocksX;
+            size_t blocksY;
+
+            void operator()(size_t begin, size_t end) const
+            {
+                PixelFormat format = compressed->format;
+                size_t blockSize = getBlockSize(format);
+                size_t width = uncompressed->getWidth();
+                size_t height = uncompressed->getHeight();
+                // 4 rows of texels, whole blocks wide
+                vector<uint8>::type texels(blocksX * 4 * 4 * 4);
+                PixelBox texelRows(blocksX * 4, 4, 1, PF_BYTE_RGBA, &texels[0]);
+                uint8 rgba[16 * 4];
+
+                for (size_t row = begin; row < end; ++row)
+                {
+                    size_t z = row / blocksY;
+                    size_t y = (row % blocksY) * 4;
+                    size_t numRows = std::min<size_t>(4, height - y);
+                    uint8* blocks = static_cast<uint8*>(compressed->data) + row * blocksX * blockSize;
+                    PixelBox texelBox = texelRows.getSubVolume(Box(0, 0, 0, width, numRows, 1));
+                    PixelBox imageBox = uncompressed->getSubVolume(Box(
+                        uncompressed->left, uncompressed->top + y, uncompressed->front + z,
+                        uncompressed->right, uncompressed->top + y + numRows, uncompressed->front + z + 1));
+
+                    if (encode)
+                    {
+                        copyRows(imageBox, texelBox);
+                        for (size_t bx = 0; bx < blocksX; ++bx, blocks += blockSize)
+                        {
+                            // Blocks over the edge repeat the last texels
+                            for (size_t i = 0; i < 16; ++i)
+                            {
+                                size_t tx = std::min(bx * 4 + i % 4, width - 1);
+                                size_t ty = std::min(i / 4, numRows - 1);
+                                memcpy(rgba + i * 4, &texels[(ty * blocksX * 4 + tx) * 4], 4);
+                            }
+                            encodeBlock(format, rgba, blocks);
+                        }
+                    }
+                    else
+                    {
+                        for (size_t bx = 0; bx < blocksX; ++bx, blocks += blockSize)
+                        {
+                            decodeBlock(format, blocks, rgba);
+                            for (size_t ty = 0; ty < 4; ++ty)
+                                memcpy(&texels[(ty * blocksX * 4 + bx * 4) * 4], rgba + ty * 16, 16);
+                        }
+                        copyRows(texelBox, imageBox);
+                    }
+                }
+            }
+        };
+
+        void codeBlocks(const PixelBox& uncompressed, const PixelBox& compressed, bool encode)
+        {
+            if (!isSupportedBlockFormat(compressed.format) || PixelUtil::isCompressed(uncompressed.format))
+            {
+                OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                    "Cannot convert between " + PixelUtil::getFormatName(compressed.format) +
+                    " and " + PixelUtil::getFormatName(uncompressed.format),
+                    encode ? "DDSCodec::compress" : "DDSCodec::decompress");
+            }
+
+            BlockRowCoder coder;
+            coder.uncompressed = &uncompressed;
+            coder.compressed = &compressed;
+            coder.encode = encode;
+            coder.blocksX = (uncompressed.getWidth() + 3) / 4;
+            coder.blocksY = (uncompressed.getHeight() + 3) / 4;
+            size_t numRows = coder.blocksY * uncompressed.getDepth();
+
+            // Enough blocks per call to be worth handing to another thread
+            Root* root = Root::getSingletonPtr();
+            if (root && root->getTaskScheduler())
+                root->getTaskScheduler()->parallelFor(0, numRows, std::max<size_t>(1, 256 / coder.blocksX), coder);
+            else
+                coder(0, numRows);
+        }
+    }
+
 
     //---------------------------------------------------------------------
     DDSCodec* DDSCodec::msInstance = 0;
@@ -223,6 +806,7 @@ namespace Ogre {
         bool isFloat32r = (imgData->format == PF_FLOAT32_R);
         bool isFloat16 = (imgData->format == PF_FLOAT16_RGBA);
         bool isFloat32 = (imgData->format == PF_FLOAT32_RGBA);
+        bool isCompressed = PixelUtil::isCompressed(imgData->format);
         bool notImplemented = false;
         String notImplementedString = "";
 
@@ -257,6 +841,11 @@ namespace Ogre {
         case PF_FLOAT32_R:
         case PF_FLOAT16_RGBA:
         case PF_FLOAT32_RGBA:
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_BC4_UNORM:
+        case PF_BC5_UNORM:
             break;
         default:
             // No crazy FOURCC or 565 et al. file formats at this stage
@@ -389,6 +978,36 @@ namespace Ogre {
             if( flipRgbMasks )
                 std::swap( ddsHeader.pixelFormat.redMask, ddsHeader.pixelFormat.blueMask );
 
+            if (isCompressed)
+            {
+                // Size of the top level instead of the pitch
+                ddsHeader.flags |= DDSD_LINEARSIZE;
+                ddsHeader.sizeOrPitch = static_cast<uint32>(PixelUtil::getMemorySize(
+                    imgData->width, imgData->height, 1, imgData->format));
+                ddsHeader.pixelFormat.flags = DDPF_FOURCC;
+                ddsHeader.pixelFormat.rgbBits = 0;
+                ddsHeader.pixelFormat.redMask = ddsHeader.pixelFormat.greenMask = 0;
+                ddsHeader.pixelFormat.blueMask = ddsHeader.pixelFormat.alphaMask = 0;
+                switch (imgData->format)
+                {
+                case PF_DXT1:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D','X','T','1');
+                    break;
+                case PF_DXT3:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D','X','T','3');
+                    break;
+                case PF_DXT5:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D','X','T','5');
+                    break;
+                case PF_BC4_UNORM:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('A','T','I','1');
+                    break;
+                default:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('A','T','I','2');
+                    break;
+                }
+            }
+
             ddsHeader.caps.caps1 = ddsHeaderCaps1;
             ddsHeader.caps.caps2 = ddsHeaderCaps2;
 //          ddsHeader.caps.reserved[0] = 0;
@@ -530,125 +1149,18 @@ namespace Ogre {
             "DDSCodec::convertPixelFormat");
     }
     //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, 
-        ColourValue* pCol) const
+    void DDSCodec::decompress(const PixelBox& src, const PixelBox& dst)
     {
-        // Note - we assume all values have already been endian swapped
-
-        // Colour lookup table
-        ColourValue derivedColours[4];
-
-        if (pf == PF_DXT1 && block.colour_0 <= block.colour_1)
-        {
-            // 1-bit alpha
-            PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-            PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-            // one intermediate colour, half way between the other two
-            derivedColours[2] = (derivedColours[0] + derivedColours[1]) / 2;
-            // transparent colour
-            derivedColours[3] = ColourValue::ZERO;
-        }
-        else
-        {
-            PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-            PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-            // first interpolated colour, 1/3 of the way along
-            derivedColours[2] = (2 * derivedColours[0] + derivedColours[1]) / 3;
-            // second interpolated colour, 2/3 of the way along
-            derivedColours[3] = (derivedColours[0] + 2 * derivedColours[1]) / 3;
-        }
-
-        // Process 4x4 block of texels
-        for (size_t row = 0; row < 4; ++row)
-        {
-            for (size_t x = 0; x < 4; ++x)
-            {
-                // LSB come first
-                uint8 colIdx = static_cast<uint8>(block.indexRow[row] >> (x * 2) & 0x3);
-                if (pf == PF_DXT1)
-                {
-                    // Overwrite entire colour
-                    pCol[(row * 4) + x] = derivedColours[colIdx];
-                }
-                else
-                {
-                    // alpha has already been read (alpha precedes colour)
-                    ColourValue& col = pCol[(row * 4) + x];
-                    col.r = derivedColours[colIdx].r;
-                    col.g = derivedColours[colIdx].g;
-                    col.b = derivedColours[colIdx].b;
-                }
-            }
-
-        }
-
-
+        assert(src.getWidth() == dst.getWidth() && src.getHeight() == dst.getHeight() &&
+               src.getDepth() == dst.getDepth());
+        codeBlocks(dst, src, false);
     }
     //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTAlpha(
-        const DXTExplicitAlphaBlock& block, ColourValue* pCol) const
+    void DDSCodec::compress(const PixelBox& src, const PixelBox& dst)
     {
-        // Note - we assume all values have already been endian swapped
-        
-        // This is an explicit alpha block, 4 bits per pixel, LSB first
-        for (size_t row = 0; row < 4; ++row)
-        {
-            for (size_t x = 0; x < 4; ++x)
-            {
-                // Shift and mask off to 4 bits
-                uint8 val = static_cast<uint8>(block.alphaRow[row] >> (x * 4) & 0xF);
-                // Convert to [0,1]
-                pCol->a = (Real)val / (Real)0xF;
-                pCol++;
-                
-            }
-            
-        }
-
-    }
-    //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTAlpha(
-        const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const
-    {
-        // Adaptive 3-bit alpha part
-        float derivedAlphas[8];
-
-        // Explicit extremes
-        derivedAlphas[0] = ((float) block.alpha_0) * (1.0f / 255.0f);
-        derivedAlphas[1] = ((float) block.alpha_1) * (1.0f / 255.0f);
-
-        if(block.alpha_0 > block.alpha_1)
-        {
-            // 6 interpolated alpha values.
-            // full range including extremes at [0] and [7]
-            // we want to fill in [1] through [6] at weights ranging
-            // from 1/7 to 6/7
-            for(size_t i = 1; i < 7; ++i)
-                derivedAlphas[i + 1] = (derivedAlphas[0] * (7 - i) + derivedAlphas[1] * i) * (1.0f / 7.0f);
-        }
-        else
-        {
-            // 4 interpolated alpha values.
-            // full range including extremes at [0] and [5]
-            // we want to fill in [1] through [4] at weights ranging
-            // from 1/5 to 4/5
-            for(size_t i = 1; i < 5; ++i)
-                derivedAlphas[i + 1] = (derivedAlphas[0] * (5 - i) + derivedAlphas[1] * i) * (1.0f / 5.0f);
-
-            derivedAlphas[6] = 0.0f;
-            derivedAlphas[7] = 1.0f;
-        }
-
-        // Ok, now we've built the reference values, process the indexes
-        uint32 dw = block.indexes[0] | (block.indexes[1] << 8) | (block.indexes[2] << 16);
-
-        for(size_t i = 0; i < 8; ++i, dw >>= 3)
-            pCol[i].a = derivedAlphas[dw & 0x7];
-
-        dw = block.indexes[3] | (block.indexes[4] << 8) | (block.indexes[5] << 16);
-
-        for(size_t i = 8; i < 16; ++i, dw >>= 3)
-            pCol[i].a = derivedAlphas[dw & 0x7];
+        assert(src.getWidth() == dst.getWidth() && src.getHeight() == dst.getHeight() &&
+               src.getDepth() == dst.getDepth());
+        codeBlocks(src, dst, true);
     }
     //---------------------------------------------------------------------
     Codec::DecodeResult DDSCodec::decode(DataStreamPtr& stream) const
@@ -785,9 +1297,17 @@ namespace Ogre {
                     // full alpha present, formats vary only in encoding 
                     imgData->format = PF_BYTE_RGBA;
                     break;
-                default:
-                    // all other cases need no special format handling
+                case PF_BC4_UNORM:
+                    imgData->format = PF_R8;
+                    break;
+                case PF_BC5_UNORM:
+                    imgData->format = PF_RG8;
                     break;
+                default:
+                    OGRE_DELETE imgData;
+                    OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                        "Cannot decompress " + PixelUtil::getFormatName(sourceFormat),
+                        "DDSCodec::decode");
                 }
             }
             else
@@ -832,92 +1352,25 @@ namespace Ogre {
                     // Compressed data
                     if (decompressDXT)
                     {
-                        DXTColourBlock col;
-                        DXTInterpolatedAlphaBlock iAlpha;
-                        DXTExplicitAlphaBlock eAlpha;
-                        // 4x4 block of decompressed colour
-                        ColourValue tempColours[16];
-                        size_t destBpp = PixelUtil::getNumElemBytes(imgData->format);
-
-                        // slices are done individually
-                        for(size_t z = 0; z < depth; ++z)
+                        // Parsed in place if the file is in memory
+                        size_t dxtSize = PixelUtil::getMemorySize(width, height, depth, sourceFormat);
+                        const uchar* srcPtr = stream->getCurrentMemoryPtr();
+                        vector<uchar>::type buffer;
+                        if (srcPtr && stream->size() - stream->tell() >= dxtSize)
                         {
-                            size_t remainingHeight = height;
-
-                            // 4x4 blocks in x/y
-                            for (size_t y = 0; y < height; y += 4)
-                            {
-                                size_t sy = std::min<size_t>( remainingHeight, 4u );
-                                remainingHeight -= sy;
-
-                                size_t remainingWidth = width;
-
-                                for (size_t x = 0; x < width; x += 4)
-                                {
-                                    size_t sx = std::min<size_t>( remainingWidth, 4u );
-                                    size_t destPitchMinus4 = dstPitch - destBpp * sx;
-
-                                    remainingWidth -= sx;
-
-                                    if (sourceFormat == PF_DXT2 || 
-                                        sourceFormat == PF_DXT3)
-                                    {
-                                        // explicit alpha
-                                        stream->read(&eAlpha, sizeof(DXTExplicitAlphaBlock));
-                                        flipEndian(eAlpha.alphaRow, sizeof(uint16), 4);
-                                        unpackDXTAlpha(eAlpha, tempColours) ;
-                                    }
-                                    else if (sourceFormat == PF_DXT4 || 
-                                        sourceFormat == PF_DXT5)
-                                    {
-                                        // interpolated alpha
-                                        stream->read(&iAlpha, sizeof(DXTInterpolatedAlphaBlock));
-                                        flipEndian(&(iAlpha.alpha_0), sizeof(uint16));
-                                        flipEndian(&(iAlpha.alpha_1), sizeof(uint16));
-                                        unpackDXTAlpha(iAlpha, tempColours) ;
-                                    }
-                                    // always read colour
-                                    stream->read(&col, sizeof(DXTColourBlock));
-                                    flipEndian(&(col.colour_0), sizeof(uint16));
-                                    flipEndian(&(col.colour_1), sizeof(uint16));
-                                    unpackDXTColour(sourceFormat, col, tempColours);
-
-                                    // write 4x4 block to uncompressed version
-                                    for (size_t by = 0; by < sy; ++by)
-                                    {
-                                        for (size_t bx = 0; bx < sx; ++bx)
-                                        {
-                                            PixelUtil::packColour(tempColours[by*4+bx],
-                                                imgData->format, destPtr);
-                                            destPtr = static_cast<void*>(
-                                                static_cast<uchar*>(destPtr) + destBpp);
-                                        }
-                                        // advance to next row
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) + destPitchMinus4);
-                                    }
-                                    // next block. Our dest pointer is 4 lines down
-                                    // from where it started
-                                    if (x + 4 >= width)
-                                    {
-                                        // Jump back to the start of the line
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) - destPitchMinus4);
-                                    }
-                                    else
-                                    {
-                                        // Jump back up 4 rows and 4 pixels to the
-                                        // right to be at the next block to the right
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) - dstPitch * sy + destBpp * sx);
-
-                                    }
-
-                                }
-
-                            }
+                            stream->skip(static_cast<long>(dxtSize));
+                        }
+                        else
+                        {
+                            buffer.resize(dxtSize);
+                            stream->read(&buffer[0], dxtSize);
+                            srcPtr = &buffer[0];
                         }
 
+                        decompress(PixelBox(width, height, depth, sourceFormat, const_cast<uchar*>(srcPtr)),
+                                   PixelBox(width, height, depth, imgData->format, destPtr));
+                        destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) +
+                            PixelUtil::getMemorySize(width, height, depth, imgData->format));
                     }
                     else
                     {
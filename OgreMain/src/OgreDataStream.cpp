@@ -30,6 +30,17 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreException.h"
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_LINUX || OGRE_PLATFORM == OGRE_PLATFORM_APPLE || \
+    OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS || OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
+#   define OGRE_MAPPED_FILE_SUPPORT 1
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#else
+#   define OGRE_MAPPED_FILE_SUPPORT 0
+#endif
+
 namespace Ogre {
 
     //-----------------------------------------------------------------------
@@ -470,6 +481,92 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
+    MappedFileDataStream::MappedFileDataStream(const String& name, const String& path)
+        : MemoryDataStream(name, 0, 0, false, true)
+    {
+#if OGRE_MAPPED_FILE_SUPPORT
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                "Cannot open file: " + name,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+
+        struct stat tagStat;
+        if (fstat(fd, &tagStat) != 0)
+        {
+            ::close(fd);
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                "Cannot determine size of file: " + name,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+
+        // Empty files can't be mapped, they are an empty stream
+        void* data = 0;
+        size_t size = (size_t)tagStat.st_size;
+        if (size)
+        {
+            data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                    "Cannot map file: " + name,
+                    "MappedFileDataStream::MappedFileDataStream");
+            }
+#   ifdef MADV_WILLNEED
+            // Start reading ahead, the file is most likely read whole
+            madvise(data, size, MADV_WILLNEED);
+#   endif
+        }
+        // The mapping keeps the file open
+        ::close(fd);
+
+        mData = mPos = static_cast<uchar*>(data);
+        mSize = size;
+        mEnd = mData + mSize;
+#else
+        (void)path;
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+            "Mapping files is not supported on this platform",
+            "MappedFileDataStream::MappedFileDataStream");
+#endif
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        close();
+    }
+    //-----------------------------------------------------------------------
+    void MappedFileDataStream::close(void)
+    {
+#if OGRE_MAPPED_FILE_SUPPORT
+        if (mData)
+            munmap(mData, mSize);
+#endif
+        mData = mPos = mEnd = 0;
+    }
+    //-----------------------------------------------------------------------
+    bool MappedFileDataStream::isSupported(void)
+    {
+        return OGRE_MAPPED_FILE_SUPPORT != 0;
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    StreamViewDataStream::StreamViewDataStream(const DataStreamPtr& source, const uchar* data, size_t size)
+        : MemoryDataStream(source->getName(), const_cast<uchar*>(data), size, false, true)
+        , mSource(source)
+    {
+    }
+    //-----------------------------------------------------------------------
+    void StreamViewDataStream::close(void)
+    {
+        MemoryDataStream::close();
+        mSource.reset();
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
     FileStreamDataStream::FileStreamDataStream(std::ifstream* s, bool freeOnClose)
         : DataStream(), mInStream(s), mFStreamRO(s), mFStream(0), mFreeOnClose(freeOnClose)
     {
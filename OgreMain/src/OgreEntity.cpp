@@ -243,6 +243,10 @@ namespace Ogre {
         if (!mInitialised)
             return;
 
+        // The queued blends refer to our vertex data
+        if (_isSoftwareSkinningQueued())
+            mManager->_updateQueuedSoftwareSkinning();
+
         // Delete submeshes
         SubEntityList::iterator i, iend;
         iend = mSubEntityList.end();
@@ -750,7 +754,7 @@ namespace Ogre {
         // update the animation
         if (displayEntity->hasSkeleton() || displayEntity->hasVertexAnimation())
         {
-            displayEntity->updateAnimation();
+            displayEntity->updateAnimation(true);
 
             //--- pass this point,  we are sure that the transformation matrix of each bone and tagPoint have been updated
             ChildObjectList::iterator child_itr = mChildObjectList.begin();
@@ -874,7 +878,7 @@ namespace Ogre {
         return true;
     }
     //-----------------------------------------------------------------------
-    void Entity::updateAnimation(void)
+    void Entity::updateAnimation(bool allowDeferredSkinning)
     {
         // Do nothing if not initialised yet
         if (!mInitialised)
@@ -943,7 +947,18 @@ namespace Ogre {
                 applyVertexAnimation(hwAnimation, stencilShadows);
             }
 
-            if (hasSkeleton())
+            // Leave the skinning to the SceneManager if it does it for all the
+            // visible entities at once, unless something depends on the bones
+            // right away
+            bool deferSkinning = allowDeferredSkinning && softwareAnimation &&
+                !hwAnimation && mChildObjectList.empty() && !mSharedSkeletonEntities &&
+                mManager && mManager->isParallelSoftwareSkinningEnabled();
+
+            if (hasSkeleton() && deferSkinning)
+            {
+                queueSoftwareSkinning(blendNormals);
+            }
+            else if (hasSkeleton())
             {
                 cacheBoneMatrices();
 
@@ -1047,6 +1062,80 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Entity::queueSoftwareSkinning(bool blendNormals)
+    {
+        if (_isSoftwareSkinningQueued())
+            return;
+
+        // Locking and binding buffers has to happen on this thread, as well as
+        // anything shared with other entities
+        SoftwareVertexBlendBatch& batch = mManager->_getSoftwareSkinningBatch();
+        if (mSkelAnimVertexData)
+        {
+            mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
+            mTempSkelAnimInfo.bindTempCopies(mSkelAnimVertexData, false);
+            // Blend, taking source from either mesh data or morph data
+            size_t index = batch.addBlend(
+                (mMesh->getSharedVertexDataAnimationType() != VAT_NONE) ?
+                mSoftwareVertexAnimVertexData : mMesh->sharedVertexData,
+                mSkelAnimVertexData, blendNormals);
+            mQueuedSoftwareBlends.push_back(QueuedSoftwareBlendList::value_type(index, 0));
+        }
+        SubEntityList::iterator i, iend;
+        iend = mSubEntityList.end();
+        for (i = mSubEntityList.begin(); i != iend; ++i)
+        {
+            SubEntity* se = *i;
+            if (se->isVisible() && se->mSkelAnimVertexData)
+            {
+                se->mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
+                se->mTempSkelAnimInfo.bindTempCopies(se->mSkelAnimVertexData, false);
+                size_t index = batch.addBlend(
+                    (se->getSubMesh()->getVertexAnimationType() != VAT_NONE)?
+                    se->mSoftwareVertexAnimVertexData : se->mSubMesh->vertexData,
+                    se->mSkelAnimVertexData, blendNormals);
+                mQueuedSoftwareBlends.push_back(QueuedSoftwareBlendList::value_type(index, se));
+            }
+        }
+
+        if (mQueuedSoftwareBlends.empty())
+        {
+            // Nothing to blend, just keep the bones up to date
+            cacheBoneMatrices();
+            return;
+        }
+
+        // Animations are shared between skeleton instances, make sure the data
+        // they build on demand is ready before they are applied concurrently
+        EnabledAnimationStateList::const_iterator it, itend;
+        itend = mAnimationState->getEnabledAnimationStates().end();
+        for (it = mAnimationState->getEnabledAnimationStates().begin(); it != itend; ++it)
+        {
+            Animation* anim = mSkeletonInstance->_getAnimationImpl((*it)->getAnimationName());
+            if (anim)
+                anim->_buildApplyCaches();
+        }
+
+        mManager->_queueSoftwareSkinning(this);
+    }
+    //-----------------------------------------------------------------------
+    void Entity::_updateQueuedSoftwareSkinning(const SoftwareVertexBlendBatch& batch)
+    {
+        cacheBoneMatrices();
+
+        const Matrix4* blendMatrices[256];
+        QueuedSoftwareBlendList::const_iterator i, iend;
+        iend = mQueuedSoftwareBlends.end();
+        for (i = mQueuedSoftwareBlends.begin(); i != iend; ++i)
+        {
+            const Mesh::IndexMap& indexMap = i->second ?
+                i->second->mSubMesh->blendIndexToBoneIndexMap : mMesh->sharedBlendIndexToBoneIndexMap;
+            Mesh::prepareMatricesForVertexBlend(blendMatrices, mBoneMatrices, indexMap);
+            batch.blend(i->first, blendMatrices);
+        }
+        mQueuedSoftwareBlends.clear();
+    }
+    //-----------------------------------------------------------------------
     ushort Entity::initHardwareAnimationElements(VertexData* vdata,
                                                  ushort numberOfElements, bool animateNormals)
     {
@@ -54,6 +54,7 @@ THE SOFTWARE.
 namespace Ogre {
 
     bool FileSystemArchive::msIgnoreHidden = true;
+    bool FileSystemArchive::msUseMemoryMapping = true;
 
     //-----------------------------------------------------------------------
     FileSystemArchive::FileSystemArchive(const String& name, const String& archType, bool readOnly )
@@ -208,7 +209,6 @@ namespace Ogre {
         struct stat tagStat;
         int ret = stat(full_path.c_str(), &tagStat);
         assert(ret == 0 && "Problem getting file size" );
-        (void)ret;  // Silence warning
 
         // Always open in binary mode
         // Also, always include reading
@@ -224,6 +224,13 @@ namespace Ogre {
                         "FileSystemArchive::open");
         }
 
+        // Map regular files, so they needn't be copied to be parsed in place
+        if (readOnly && msUseMemoryMapping && MappedFileDataStream::isSupported() &&
+            ret == 0 && (tagStat.st_mode & S_IFMT) == S_IFREG)
+        {
+            return DataStreamPtr(OGRE_NEW MappedFileDataStream(filename, full_path));
+        }
+
         if (!readOnly)
         {
             mode |= std::ios::out;
@@ -398,11 +398,21 @@ namespace Ogre {
     //---------------------------------------------------------------------
     Codec::DecodeResult FreeImageCodec::decode(DataStreamPtr& input) const
     {
-        // Buffer stream into memory (TODO: override IO functions instead?)
-        MemoryDataStream memStream(input, true);
+        // Decode in place if the stream is held in memory already,
+        // otherwise buffer it (TODO: override IO functions instead?)
+        const uchar* data = input->getCurrentMemoryPtr();
+        size_t dataSize = input->size() - input->tell();
+        MemoryDataStreamPtr memStream;
+        if (!data)
+        {
+            memStream.reset(OGRE_NEW MemoryDataStream(input, true));
+            data = memStream->getPtr();
+            dataSize = memStream->size();
+        }
 
+        // FreeImage only reads from the memory when loading
         FIMEMORY* fiMem = 
-            FreeImage_OpenMemory(memStream.getPtr(), static_cast<DWORD>(memStream.size()));
+            FreeImage_OpenMemory(const_cast<uchar*>(data), static_cast<DWORD>(dataSize));
 
         FIBITMAP* fiBitmap = FreeImage_LoadFromMemory(
             (FREE_IMAGE_FORMAT)mFreeImageType, fiMem);
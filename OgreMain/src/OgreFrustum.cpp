@@ -39,6 +39,7 @@ THE SOFTWARE.
 #include "OgreMaterialManager.h"
 #include "OgreRenderSystem.h"
 #include "OgreMovablePlane.h"
+#include "OgreOptimisedUtil.h"
 
 namespace Ogre {
 
@@ -259,6 +260,39 @@ namespace Ogre {
         return true;
     }
 
+    //-----------------------------------------------------------------------
+    bool Frustum::isVisible(const float* centres, const float* halfSizes,
+        size_t numBoxes, uint32* visibility) const
+    {
+        // Make any pending updates to the calculated frustum planes
+        updateFrustumPlanes();
+
+        float planes[6 * 4];
+        size_t numPlanes = 0;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            // Skip far plane if infinite view frustum
+            if (plane == FRUSTUM_PLANE_FAR && mFarDist == 0)
+                continue;
+
+            const Plane& p = mFrustumPlanes[plane];
+            planes[numPlanes * 4 + 0] = static_cast<float>(p.normal.x);
+            planes[numPlanes * 4 + 1] = static_cast<float>(p.normal.y);
+            planes[numPlanes * 4 + 2] = static_cast<float>(p.normal.z);
+            planes[numPlanes * 4 + 3] = static_cast<float>(p.d);
+            ++numPlanes;
+        }
+
+        OptimisedUtil::getImplementation()->calculateBoxVisibility(
+            planes, numPlanes, centres, halfSizes, visibility, numBoxes);
+
+        for (size_t i = 0; i < (numBoxes + 31) / 32; ++i)
+        {
+            if (visibility[i])
+                return true;
+        }
+        return false;
+    }
     //-----------------------------------------------------------------------
     bool Frustum::isVisible(const Vector3& vert, FrustumPlane* culledBy) const
     {
@@ -549,10 +583,19 @@ namespace Ogre {
 #endif
 
         RenderSystem* renderSystem = Root::getSingleton().getRenderSystem();
-        // API specific
-        renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRS);
-        // API specific for Gpu Programs
-        renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRSDepth, true);
+        if (renderSystem)
+        {
+            // API specific
+            renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRS);
+            // API specific for Gpu Programs
+            renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRSDepth, true);
+        }
+        else
+        {
+            // No render system (e.g. headless culling), nothing API specific to do
+            mProjMatrixRS = mProjMatrix;
+            mProjMatrixRSDepth = mProjMatrix;
+        }
 
 
         // Calculate bounding box (local)
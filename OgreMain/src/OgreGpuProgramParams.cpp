@@ -258,6 +258,138 @@ namespace Ogre
         return memSize;
     }
     //---------------------------------------------------------------------
+    namespace {
+        /// Interned constant names, shared by all the named constants
+        struct ConstantNameTable
+        {
+            typedef OGRE_HashMap<String, GpuConstantHandle> HandleMap;
+            HandleMap handles;
+            // A deque, so names don't move as more are added
+            deque<String>::type names;
+            OGRE_MUTEX(mutex);
+
+            static ConstantNameTable& get()
+            {
+                static ConstantNameTable table;
+                return table;
+            }
+        };
+    }
+    //---------------------------------------------------------------------
+    GpuConstantHandle GpuNamedConstants::getConstantHandle(const String& name)
+    {
+        ConstantNameTable& table = ConstantNameTable::get();
+        OGRE_LOCK_MUTEX(table.mutex);
+        std::pair<ConstantNameTable::HandleMap::iterator, bool> inserted =
+            table.handles.insert(ConstantNameTable::HandleMap::value_type(
+                name, static_cast<GpuConstantHandle>(table.names.size())));
+        if (inserted.second)
+            table.names.push_back(name);
+        return inserted.first->second;
+    }
+    //---------------------------------------------------------------------
+    const String& GpuNamedConstants::getConstantName(GpuConstantHandle handle)
+    {
+        ConstantNameTable& table = ConstantNameTable::get();
+        OGRE_LOCK_MUTEX(table.mutex);
+        if (handle >= table.names.size())
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                        "Unknown constant handle " + StringConverter::toString(handle),
+                        "GpuNamedConstants::getConstantName");
+        return table.names[handle];
+    }
+    //---------------------------------------------------------------------
+    const GpuConstantDefinition* GpuNamedConstants::findConstantDefinition(const String& name) const
+    {
+        return map.findIndexed(name);
+    }
+    //---------------------------------------------------------------------
+    const GpuConstantDefinition* GpuNamedConstants::findConstantDefinition(GpuConstantHandle handle) const
+    {
+        return map.findIndexed(handle);
+    }
+    //---------------------------------------------------------------------
+    //  GpuConstantDefinitionIndexedMap methods
+    //---------------------------------------------------------------------
+    GpuConstantDefinitionIndexedMap::GpuConstantDefinitionIndexedMap(const GpuConstantDefinitionIndexedMap& rhs)
+        : GpuConstantDefinitionMap(rhs)
+    {
+        // The index of rhs points into its own entries
+        rebuildIndex();
+    }
+    //---------------------------------------------------------------------
+    GpuConstantDefinitionIndexedMap& GpuConstantDefinitionIndexedMap::operator=(const GpuConstantDefinitionIndexedMap& rhs)
+    {
+        if (this != &rhs)
+        {
+            GpuConstantDefinitionMap::operator=(rhs);
+            rebuildIndex();
+        }
+        return *this;
+    }
+    //---------------------------------------------------------------------
+    std::pair<GpuConstantDefinitionIndexedMap::iterator, bool> GpuConstantDefinitionIndexedMap::insert(const value_type& val)
+    {
+        std::pair<iterator, bool> ret = GpuConstantDefinitionMap::insert(val);
+        if (ret.second)
+            addToIndex(*ret.first);
+        return ret;
+    }
+    //---------------------------------------------------------------------
+    GpuConstantDefinition& GpuConstantDefinitionIndexedMap::operator[](const String& name)
+    {
+        return insert(value_type(name, GpuConstantDefinition())).first->second;
+    }
+    //---------------------------------------------------------------------
+    void GpuConstantDefinitionIndexedMap::erase(iterator i)
+    {
+        mNameIndex.erase(i->first);
+        mHandleIndex.erase(GpuNamedConstants::getConstantHandle(i->first));
+        GpuConstantDefinitionMap::erase(i);
+    }
+    //---------------------------------------------------------------------
+    GpuConstantDefinitionIndexedMap::size_type GpuConstantDefinitionIndexedMap::erase(const String& name)
+    {
+        iterator i = find(name);
+        if (i == end())
+            return 0;
+        erase(i);
+        return 1;
+    }
+    //---------------------------------------------------------------------
+    void GpuConstantDefinitionIndexedMap::clear(void)
+    {
+        GpuConstantDefinitionMap::clear();
+        mNameIndex.clear();
+        mHandleIndex.clear();
+    }
+    //---------------------------------------------------------------------
+    const GpuConstantDefinition* GpuConstantDefinitionIndexedMap::findIndexed(const String& name) const
+    {
+        NameIndex::const_iterator i = mNameIndex.find(name);
+        return i == mNameIndex.end() ? 0 : i->second;
+    }
+    //---------------------------------------------------------------------
+    const GpuConstantDefinition* GpuConstantDefinitionIndexedMap::findIndexed(GpuConstantHandle handle) const
+    {
+        HandleIndex::const_iterator i = mHandleIndex.find(handle);
+        return i == mHandleIndex.end() ? 0 : i->second;
+    }
+    //---------------------------------------------------------------------
+    void GpuConstantDefinitionIndexedMap::addToIndex(const value_type& val)
+    {
+        mNameIndex[val.first] = &val.second;
+        mHandleIndex[GpuNamedConstants::getConstantHandle(val.first)] = &val.second;
+    }
+    //---------------------------------------------------------------------
+    void GpuConstantDefinitionIndexedMap::rebuildIndex(void)
+    {
+        mNameIndex.clear();
+        mHandleIndex.clear();
+        for (const_iterator i = begin(); i != end(); ++i)
+            addToIndex(*i);
+    }
+    //---------------------------------------------------------------------
     //  GpuNamedConstantsSerializer methods
     //---------------------------------------------------------------------
     GpuNamedConstantsSerializer::GpuNamedConstantsSerializer()
@@ -543,14 +675,14 @@ namespace Ogre
     //---------------------------------------------------------------------
     const GpuConstantDefinition& GpuSharedParameters::getConstantDefinition(const String& name) const
     {
-        GpuConstantDefinitionMap::const_iterator i = mNamedConstants.map.find(name);
-        if (i == mNamedConstants.map.end())
+        const GpuConstantDefinition* def = mNamedConstants.findConstantDefinition(name);
+        if (!def)
         {
             OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
                         "Constant entry with name '" + name + "' does not exist. ",
                         "GpuSharedParameters::getConstantDefinition");
         }
-        return i->second;
+        return *def;
     }
     //---------------------------------------------------------------------
     const GpuNamedConstants& GpuSharedParameters::getConstantDefinitions() const
@@ -1509,6 +1641,125 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    uint16 GpuProgramParameters::deriveInputs(GpuProgramParameters::AutoConstantType act)
+    {
+        // Light positions are relative to the camera with camera relative rendering
+        const uint16 camera = (uint16)AutoParamDataSource::IG_CAMERA;
+        const uint16 lights = (uint16)AutoParamDataSource::IG_LIGHTS | camera;
+        const uint16 pass = (uint16)AutoParamDataSource::IG_PASS;
+        const uint16 scene = (uint16)AutoParamDataSource::IG_SCENE;
+
+        switch(act)
+        {
+        case ACT_VIEW_MATRIX:
+        case ACT_INVERSE_VIEW_MATRIX:
+        case ACT_TRANSPOSE_VIEW_MATRIX:
+        case ACT_INVERSE_TRANSPOSE_VIEW_MATRIX:
+        case ACT_PROJECTION_MATRIX:
+        case ACT_INVERSE_PROJECTION_MATRIX:
+        case ACT_TRANSPOSE_PROJECTION_MATRIX:
+        case ACT_INVERSE_TRANSPOSE_PROJECTION_MATRIX:
+        case ACT_VIEWPROJ_MATRIX:
+        case ACT_INVERSE_VIEWPROJ_MATRIX:
+        case ACT_TRANSPOSE_VIEWPROJ_MATRIX:
+        case ACT_INVERSE_TRANSPOSE_VIEWPROJ_MATRIX:
+        case ACT_RENDER_TARGET_FLIPPING:
+        case ACT_CAMERA_POSITION:
+        case ACT_LOD_CAMERA_POSITION:
+        case ACT_VIEWPORT_WIDTH:
+        case ACT_VIEWPORT_HEIGHT:
+        case ACT_INVERSE_VIEWPORT_WIDTH:
+        case ACT_INVERSE_VIEWPORT_HEIGHT:
+        case ACT_VIEWPORT_SIZE:
+        case ACT_VIEW_DIRECTION:
+        case ACT_VIEW_SIDE_VECTOR:
+        case ACT_VIEW_UP_VECTOR:
+        case ACT_FOV:
+        case ACT_NEAR_CLIP_DISTANCE:
+        case ACT_FAR_CLIP_DISTANCE:
+
+            return camera;
+
+        case ACT_AMBIENT_LIGHT_COLOUR:
+        case ACT_FOG_COLOUR:
+        case ACT_FOG_PARAMS:
+        case ACT_SCENE_DEPTH_RANGE:
+        case ACT_SHADOW_COLOUR:
+
+            return scene;
+
+        case ACT_SURFACE_AMBIENT_COLOUR:
+        case ACT_SURFACE_DIFFUSE_COLOUR:
+        case ACT_SURFACE_SPECULAR_COLOUR:
+        case ACT_SURFACE_EMISSIVE_COLOUR:
+        case ACT_SURFACE_SHININESS:
+        case ACT_SURFACE_ALPHA_REJECTION_VALUE:
+        case ACT_PASS_NUMBER:
+        case ACT_TEXTURE_SIZE:
+        case ACT_INVERSE_TEXTURE_SIZE:
+        case ACT_PACKED_TEXTURE_SIZE:
+        case ACT_TEXTURE_MATRIX:
+
+            return pass;
+
+        case ACT_DERIVED_AMBIENT_LIGHT_COLOUR:
+        case ACT_DERIVED_SCENE_COLOUR:
+
+            return scene | pass;
+
+        case ACT_LIGHT_COUNT:
+        case ACT_LIGHT_DIFFUSE_COLOUR:
+        case ACT_LIGHT_SPECULAR_COLOUR:
+        case ACT_LIGHT_ATTENUATION:
+        case ACT_SPOTLIGHT_PARAMS:
+        case ACT_LIGHT_POSITION:
+        case ACT_LIGHT_POSITION_VIEW_SPACE:
+        case ACT_LIGHT_DIRECTION:
+        case ACT_LIGHT_DIRECTION_VIEW_SPACE:
+        case ACT_LIGHT_POWER_SCALE:
+        case ACT_LIGHT_DIFFUSE_COLOUR_POWER_SCALED:
+        case ACT_LIGHT_SPECULAR_COLOUR_POWER_SCALED:
+        case ACT_LIGHT_DIFFUSE_COLOUR_ARRAY:
+        case ACT_LIGHT_SPECULAR_COLOUR_ARRAY:
+        case ACT_LIGHT_DIFFUSE_COLOUR_POWER_SCALED_ARRAY:
+        case ACT_LIGHT_SPECULAR_COLOUR_POWER_SCALED_ARRAY:
+        case ACT_LIGHT_ATTENUATION_ARRAY:
+        case ACT_LIGHT_POSITION_ARRAY:
+        case ACT_LIGHT_POSITION_VIEW_SPACE_ARRAY:
+        case ACT_LIGHT_DIRECTION_ARRAY:
+        case ACT_LIGHT_DIRECTION_VIEW_SPACE_ARRAY:
+        case ACT_LIGHT_POWER_SCALE_ARRAY:
+        case ACT_SPOTLIGHT_PARAMS_ARRAY:
+        case ACT_LIGHT_NUMBER:
+        case ACT_LIGHT_CASTS_SHADOWS:
+        case ACT_LIGHT_CASTS_SHADOWS_ARRAY:
+        case ACT_TEXTURE_VIEWPROJ_MATRIX:
+        case ACT_TEXTURE_VIEWPROJ_MATRIX_ARRAY:
+        case ACT_SPOTLIGHT_VIEWPROJ_MATRIX:
+        case ACT_SPOTLIGHT_VIEWPROJ_MATRIX_ARRAY:
+
+            return lights;
+
+        case ACT_DERIVED_LIGHT_DIFFUSE_COLOUR:
+        case ACT_DERIVED_LIGHT_SPECULAR_COLOUR:
+        case ACT_DERIVED_LIGHT_DIFFUSE_COLOUR_ARRAY:
+        case ACT_DERIVED_LIGHT_SPECULAR_COLOUR_ARRAY:
+
+            return lights | pass;
+
+        case ACT_SHADOW_SCENE_DEPTH_RANGE:
+        case ACT_SHADOW_SCENE_DEPTH_RANGE_ARRAY:
+
+            return lights | scene;
+
+        default:
+            // Per object values change with almost every renderable, and time,
+            // custom parameters and the like are read from elsewhere, so these
+            // are updated every time
+            return 0;
+        };
+    }
+    //---------------------------------------------------------------------
     GpuLogicalIndexUse* GpuProgramParameters::_getFloatConstantLogicalIndexUse(
         size_t logicalIndex, size_t requestedSize, uint16 variability)
     {
@@ -2195,8 +2446,8 @@ namespace Ogre
             return 0;
         }
 
-        GpuConstantDefinitionMap::const_iterator i = mNamedConstants->map.find(name);
-        if (i == mNamedConstants->map.end())
+        const GpuConstantDefinition* def = mNamedConstants->findConstantDefinition(name);
+        if (!def)
         {
             if (throwExceptionIfNotFound)
 			{
@@ -2204,7 +2455,7 @@ namespace Ogre
 #if OGRE_DEBUG_MODE
 				// make it easy to catch typo and/or unused shader parameter elimination made by some drivers
 				knownNames = "Known names are: ";
-				for (i = mNamedConstants->map.begin(); i != mNamedConstants->map.end(); ++i)
+				for (GpuConstantDefinitionMap::const_iterator i = mNamedConstants->map.begin(); i != mNamedConstants->map.end(); ++i)
 					knownNames.append(i->first).append(" ");
 #endif
                 OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
@@ -2213,10 +2464,18 @@ namespace Ogre
 			}
             return 0;
         }
-        else
-        {
-            return &(i->second);
-        }
+        return def;
+    }
+    //-----------------------------------------------------------------------------
+    const GpuConstantDefinition*
+    GpuProgramParameters::_findNamedConstantDefinition(GpuConstantHandle handle,
+                                                       bool throwExceptionIfNotFound) const
+    {
+        const GpuConstantDefinition* def = mNamedConstants ? mNamedConstants->findConstantDefinition(handle) : 0;
+        // Report the name, along with why the lookup failed
+        if (!def && throwExceptionIfNotFound)
+            return _findNamedConstantDefinition(GpuNamedConstants::getConstantName(handle), true);
+        return def;
     }
     //-----------------------------------------------------------------------------
     void GpuProgramParameters::setAutoConstant(size_t index, AutoConstantType acType, size_t extraInfo)
@@ -2256,12 +2515,17 @@ namespace Ogre
                 i->data = extraInfo;
                 i->elementCount = elementSize;
                 i->variability = variability;
+                i->inputs = deriveInputs(acType);
+                i->version = 0;
                 found = true;
                 break;
             }
         }
         if (!found)
+        {
             mAutoConstants.push_back(AutoConstantEntry(acType, physicalIndex, extraInfo, variability, elementSize));
+            mAutoConstants.back().inputs = deriveInputs(acType);
+        }
 
         mCombinedVariability |= variability;
 
@@ -2306,12 +2570,17 @@ namespace Ogre
                 i->fData = rData;
                 i->elementCount = elementSize;
                 i->variability = variability;
+                i->inputs = deriveInputs(acType);
+                i->version = 0;
                 found = true;
                 break;
             }
         }
         if (!found)
+        {
             mAutoConstants.push_back(AutoConstantEntry(acType, physicalIndex, rData, variability, elementSize));
+            mAutoConstants.back().inputs = deriveInputs(acType);
+        }
 
         mCombinedVariability |= variability;
     }
@@ -2415,11 +2684,19 @@ namespace Ogre
         mActivePassIterationIndex = std::numeric_limits<size_t>::max();
 
         // Autoconstant index is not a physical index
-        for (AutoConstantList::const_iterator i = mAutoConstants.begin(); i != mAutoConstants.end(); ++i)
+        for (AutoConstantList::iterator i = mAutoConstants.begin(); i != mAutoConstants.end(); ++i)
         {
             // Only update needed slots
             if (i->variability & mask)
             {
+                // Skip the ones whose inputs haven't changed since they were computed
+                if (i->inputs)
+                {
+                    uint64 version = source->getVersion(i->inputs);
+                    if (version == i->version)
+                        continue;
+                    i->version = version;
+                }
 
                 switch(i->paramType)
                 {
@@ -3180,6 +3457,132 @@ namespace Ogre
             _writeRawConstants(def->physicalIndex, val, rawCount);
     }
     //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, Real val)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, val);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, int val)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, val);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, uint val)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, val);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const Vector4& vec)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, vec, def->elementSize);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const Vector3& vec)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, vec);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const Vector2& vec)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, vec);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const Matrix4& m)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, m, def->elementSize);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const Matrix4* m,
+                                                size_t numEntries)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, m, numEntries);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle, const ColourValue& colour)
+    {
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstant(def->physicalIndex, colour, def->elementSize);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle,
+                                                const float *val, size_t count, size_t multiple)
+    {
+        size_t rawCount = count * multiple;
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstants(def->physicalIndex, val, rawCount);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle,
+                                                const double *val, size_t count, size_t multiple)
+    {
+        size_t rawCount = count * multiple;
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstants(def->physicalIndex, val, rawCount);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle,
+                                                const int *val, size_t count, size_t multiple)
+    {
+        size_t rawCount = count * multiple;
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstants(def->physicalIndex, val, rawCount);
+    }
+    //---------------------------------------------------------------------------
+    void GpuProgramParameters::setNamedConstant(GpuConstantHandle handle,
+                                                const uint *val, size_t count, size_t multiple)
+    {
+        size_t rawCount = count * multiple;
+        // look up, and throw an exception if we're not ignoring missing
+        const GpuConstantDefinition* def =
+            _findNamedConstantDefinition(handle, !mIgnoreMissingParams);
+        if (def)
+            _writeRawConstants(def->physicalIndex, val, rawCount);
+    }
+    //---------------------------------------------------------------------------
     // void GpuProgramParameters::setNamedConstant(const String& name,
     //                                             const bool *val, size_t count, size_t multiple)
     // {
@@ -3526,6 +3929,10 @@ namespace Ogre
                     addSharedParameters(usage.getSharedParams());
                 }
             }
+
+            // The copies may have overwritten autos, have them all computed again
+            for (AutoConstantList::iterator i = mAutoConstants.begin(); i != mAutoConstants.end(); ++i)
+                i->version = 0;
         }
     }
     //-----------------------------------------------------------------------
@@ -170,6 +170,13 @@ namespace Ogre
     {
         mVisible = false;
 
+        //Instances are culled in batches. Their bounding spheres are tested as the
+        //enclosing cubes, which can only err on the visible side
+        const size_t batchSize = 64;
+        float centres[batchSize * 3];
+        float halfSizes[batchSize * 3];
+        uint32 visibility[batchSize / 32];
+
         InstancedEntityVec::const_iterator itor = mInstancedEntities.begin();
         InstancedEntityVec::const_iterator end  = mInstancedEntities.end();
 
@@ -179,8 +186,31 @@ namespace Ogre
             //Because we do Camera::isVisible(), it is better if the SceneNode from the
             //InstancedEntity is not part of the scene graph (i.e. ultimate parent is root node)
             //to avoid unnecessary wasteful calculations
-            mVisible |= (*itor)->findVisible( mCurrentCamera );
-            ++itor;
+            size_t numBoxes = 0;
+            while( itor != end && numBoxes < batchSize && !mVisible )
+            {
+                const InstancedEntity *entity = *itor++;
+                if( !entity->isInScene() || !entity->isVisible() )
+                    continue;
+
+                if( !mCurrentCamera )
+                {
+                    mVisible = true;
+                    break;
+                }
+
+                const Vector3 &position = entity->_getDerivedPosition();
+                const float radius = static_cast<float>( entity->getBoundingRadius() );
+                for( size_t i = 0; i < 3; ++i )
+                {
+                    centres[numBoxes * 3 + i]   = static_cast<float>( position[i] );
+                    halfSizes[numBoxes * 3 + i] = radius;
+                }
+                ++numBoxes;
+            }
+
+            if( numBoxes && !mVisible )
+                mVisible = mCurrentCamera->isVisible( centres, halfSizes, numBoxes, visibility );
         }
     }
     //-----------------------------------------------------------------------
@@ -471,9 +501,13 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void InstanceBatch::_boundsDirty(void)
     {
-        if( mCreator && !mBoundsDirty ) 
-            mCreator->_addDirtyBatch( this );
-        mBoundsDirty = true;
+        if( !mBoundsDirty )
+        {
+            OGRE_LOCK_MUTEX( mBoundsDirtyMutex );
+            if( mCreator && !mBoundsDirty )
+                mCreator->_addDirtyBatch( this );
+            mBoundsDirty = true;
+        }
     }
     //-----------------------------------------------------------------------
     const String& InstanceBatch::getMovableType(void) const
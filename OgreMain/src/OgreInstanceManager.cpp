@@ -491,6 +491,7 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void InstanceManager::_addDirtyBatch( InstanceBatch *dirtyBatch )
     {
+        OGRE_LOCK_MUTEX( mDirtyBatchesMutex );
         if( mDirtyBatches.empty() )
             mSceneManager->_addDirtyInstanceManager( this );
 
@@ -0,0 +1,255 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreLZ4.h"
+
+namespace Ogre {
+namespace LZ4 {
+
+    namespace {
+        const size_t MIN_MATCH = 4;
+        /// The last bytes of a block are always literals
+        const size_t LAST_LITERALS = 5;
+        /// No match can start this close to the end of a block
+        const size_t MATCH_FIND_LIMIT = 12;
+        const size_t MAX_OFFSET = 65535;
+        const int HASH_LOG = 12;
+        /// Skip ahead faster through data that doesn't match
+        const int SKIP_TRIGGER = 6;
+
+        inline uint32 read32(const uchar* p)
+        {
+            uint32 v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint32 hash(uint32 v)
+        {
+            return (v * 2654435761U) >> (32 - HASH_LOG);
+        }
+
+        /// Writes the part of a length which doesn't fit into the token
+        inline uchar* writeLength(uchar* op, size_t length)
+        {
+            for (; length >= 255; length -= 255)
+                *op++ = 255;
+            *op++ = (uchar)length;
+            return op;
+        }
+
+        inline uchar* writeLiterals(uchar* op, const uchar* literals, size_t length, uchar* token)
+        {
+            if (length >= 15)
+            {
+                *token = 15 << 4;
+                op = writeLength(op, length - 15);
+            }
+            else
+            {
+                *token = uchar(length << 4);
+            }
+            memcpy(op, literals, length);
+            return op + length;
+        }
+
+        /** Reads the rest of a length that didn't fit into the token.
+        @remarks
+            Fails as soon as the length exceeds limit, so a run of 255 bytes
+            in a corrupt block can't overflow it.
+        */
+        inline bool readLength(const uchar*& ip, const uchar* iend, size_t limit, size_t& length)
+        {
+            uchar b;
+            do
+            {
+                if (ip == iend)
+                    return false;
+                b = *ip++;
+                length += b;
+                if (length > limit)
+                    return false;
+            } while (b == 255);
+            return true;
+        }
+    }
+    //-----------------------------------------------------------------------
+    size_t compress(const uchar* src, size_t srcSize, uchar* dst)
+    {
+        uchar* op = dst;
+        const uchar* anchor = src;
+
+        if (srcSize > MATCH_FIND_LIMIT)
+        {
+            // Positions of the last occurrence of each hashed sequence
+            uint32 table[1 << HASH_LOG];
+            memset(table, 0, sizeof(table));
+
+            const uchar* ip = src + 1;
+            const uchar* matchLimit = src + srcSize - LAST_LITERALS;
+            const uchar* findLimit = src + srcSize - MATCH_FIND_LIMIT;
+
+            while (ip <= findLimit)
+            {
+                // Find a match
+                const uchar* match;
+                uint32 searched = 1 << SKIP_TRIGGER;
+                for (;;)
+                {
+                    uint32 h = hash(read32(ip));
+                    match = src + table[h];
+                    table[h] = uint32(ip - src);
+                    if (match < ip && size_t(ip - match) <= MAX_OFFSET && read32(match) == read32(ip))
+                        break;
+                    ip += searched++ >> SKIP_TRIGGER;
+                    if (ip > findLimit)
+                        break;
+                }
+                if (ip > findLimit)
+                    break;
+
+                // Extend it backwards over the literals
+                while (ip > anchor && match > src && ip[-1] == match[-1])
+                {
+                    --ip;
+                    --match;
+                }
+
+                uchar* token = op++;
+                op = writeLiterals(op, anchor, size_t(ip - anchor), token);
+
+                size_t offset = size_t(ip - match);
+                *op++ = uchar(offset);
+                *op++ = uchar(offset >> 8);
+
+                // And forwards
+                const uchar* matchStart = ip;
+                ip += MIN_MATCH;
+                match += MIN_MATCH;
+                while (ip < matchLimit && *ip == *match)
+                {
+                    ++ip;
+                    ++match;
+                }
+                size_t matchLength = size_t(ip - matchStart) - MIN_MATCH;
+                if (matchLength >= 15)
+                {
+                    *token |= 15;
+                    op = writeLength(op, matchLength - 15);
+                }
+                else
+                {
+                    *token |= uchar(matchLength);
+                }
+
+                anchor = ip;
+                if (ip <= findLimit)
+                    table[hash(read32(ip - 2))] = uint32(ip - 2 - src);
+            }
+        }
+
+        uchar* token = op++;
+        op = writeLiterals(op, anchor, size_t(src + srcSize - anchor), token);
+        return size_t(op - dst);
+    }
+    //-----------------------------------------------------------------------
+    bool decompress(const uchar* src, size_t srcSize, uchar* dst, size_t dstSize)
+    {
+        const uchar* ip = src;
+        const uchar* iend = src + srcSize;
+        uchar* op = dst;
+        uchar* oend = dst + dstSize;
+
+        while (ip < iend)
+        {
+            uchar token = *ip++;
+
+            // Short literal runs are copied 16 bytes at a time, where the
+            // extra bytes fit into both buffers. Later output overwrites them.
+            size_t literals = token >> 4;
+            if (literals != 15 && iend - ip >= 16 && oend - op >= 16)
+            {
+                memcpy(op, ip, 16);
+            }
+            else
+            {
+                if (literals == 15 && !readLength(ip, iend, size_t(oend - op), literals))
+                    return false;
+                if (literals > size_t(iend - ip) || literals > size_t(oend - op))
+                    return false;
+                memcpy(op, ip, literals);
+            }
+            ip += literals;
+            op += literals;
+
+            // The last sequence has no match
+            if (ip == iend)
+                break;
+
+            if (iend - ip < 2)
+                return false;
+            size_t offset = ip[0] | (size_t(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > size_t(op - dst))
+                return false;
+
+            size_t length = token & 15;
+            if (length == 15 && !readLength(ip, iend, size_t(oend - op), length))
+                return false;
+            length += MIN_MATCH;
+            if (length > size_t(oend - op))
+                return false;
+
+            // The match can overlap what it writes, which repeats the data.
+            // Copies of at most the offset don't overlap, and can overshoot
+            // as long as they stay in the buffer.
+            const uchar* match = op - offset;
+            uchar* matchEnd = op + length;
+            if (offset >= 16 && size_t(oend - op) >= length + 15)
+            {
+                for (; op < matchEnd; op += 16, match += 16)
+                    memcpy(op, match, 16);
+            }
+            else if (offset >= 8 && size_t(oend - op) >= length + 7)
+            {
+                for (; op < matchEnd; op += 8, match += 8)
+                    memcpy(op, match, 8);
+            }
+            else
+            {
+                while (op < matchEnd)
+                    *op++ = *match++;
+            }
+            op = matchEnd;
+        }
+
+        return op == oend;
+    }
+
+}
+}
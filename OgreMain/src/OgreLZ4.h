@@ -0,0 +1,71 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OGRE_LZ4_H__
+#define __OGRE_LZ4_H__
+
+/** Internal include file -- do not use externally */
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre {
+namespace LZ4 {
+
+    /** Compression in the LZ4 block format.
+    @remarks
+        A small self contained implementation, so packs can be built and
+        read without an external library. The output is a standard LZ4
+        block, without frame headers, which any LZ4 decoder can read.
+        It favours decompression speed over ratio, the compressor is the
+        single pass greedy one.
+    */
+
+    /// The largest possible size of compressing srcSize bytes
+    inline size_t compressBound(size_t srcSize)
+    {
+        return srcSize + srcSize / 255 + 16;
+    }
+
+    /** Compresses a block.
+    @param dst Buffer of at least compressBound(srcSize) bytes
+    @return The compressed size, which can be larger than srcSize
+    */
+    size_t _OgreExport compress(const uchar* src, size_t srcSize, uchar* dst);
+
+    /** Decompresses a block, checking it never reads or writes out of bounds.
+    @remarks
+        Blocks aren't checksummed, a corrupt block which still decodes to
+        dstSize bytes gives wrong data rather than failing.
+    @return false if the block is corrupt or doesn't decompress to
+        exactly dstSize bytes
+    */
+    bool _OgreExport decompress(const uchar* src, size_t srcSize, uchar* dst, size_t dstSize);
+
+}
+}
+
+#endif
@@ -0,0 +1,471 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#if OGRE_NO_ZIP_ARCHIVE == 0
+
+#include "OgreMappedZip.h"
+#include "OgreException.h"
+
+#include <zlib.h>
+#include <sys/stat.h>
+
+namespace Ogre {
+
+    namespace {
+        /// Zip record signatures
+        const uint32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+        const uint32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+        const uint32 END_OF_CENTRAL_DIR_SIGNATURE = 0x06054b50;
+        /// Fixed sizes of the records, without their variable length fields
+        const size_t LOCAL_HEADER_SIZE = 30;
+        const size_t CENTRAL_HEADER_SIZE = 46;
+        const size_t END_OF_CENTRAL_DIR_SIZE = 22;
+        /// The end of central directory record can be followed by a comment this long
+        const size_t MAX_COMMENT_SIZE = 0xffff;
+
+        const uint16 METHOD_STORED = 0;
+        const uint16 METHOD_DEFLATED = 8;
+        const uint16 FLAG_ENCRYPTED = 0x1;
+
+        /// Stored in the index for base names shared by several files
+        const size_t AMBIGUOUS_ENTRY = size_t(-1);
+
+        /// Zip is little endian, regardless of the platform
+        uint16 readUint16(const uchar* p)
+        {
+            return uint16(p[0] | (p[1] << 8));
+        }
+
+        uint32 readUint32(const uchar* p)
+        {
+            return uint32(p[0]) | (uint32(p[1]) << 8) | (uint32(p[2]) << 16) | (uint32(p[3]) << 24);
+        }
+
+        String toLookupName(const String& filename)
+        {
+            String name = filename;
+#if !OGRE_RESOURCEMANAGER_STRICT
+            // zip is case insensitive
+            StringUtil::toLowerCase(name);
+#endif
+            return name;
+        }
+
+        /** Stream over a stored entry, straight out of the mapping.
+        @remarks
+            Holds on to the mapping, so the stream stays valid after the
+            archive is unloaded.
+        */
+        class MappedZipEntryDataStream : public MemoryDataStream
+        {
+        public:
+            MappedZipEntryDataStream(const String& name, const DataStreamPtr& mapping,
+                                     const uchar* data, size_t size)
+                : MemoryDataStream(name, const_cast<uchar*>(data), size, false, true)
+                , mMapping(mapping)
+            {
+            }
+
+            void close(void)
+            {
+                MemoryDataStream::close();
+                mMapping.setNull();
+            }
+
+        private:
+            DataStreamPtr mMapping;
+        };
+    }
+    //-----------------------------------------------------------------------
+    MappedZipArchive::MappedZipArchive(const String& name, const String& archType)
+        : Archive(name, archType)
+    {
+    }
+    //-----------------------------------------------------------------------
+    MappedZipArchive::~MappedZipArchive()
+    {
+        unload();
+    }
+    //-----------------------------------------------------------------------
+    void MappedZipArchive::load()
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        if (mMapping.isNull())
+        {
+            mMapping = DataStreamPtr(OGRE_NEW MappedFileDataStream(mName, mName));
+            try
+            {
+                readCentralDirectory();
+                buildIndex();
+            }
+            catch (...)
+            {
+                unload();
+                throw;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MappedZipArchive::unload()
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        // Streams over stored entries keep their own reference to the mapping
+        mMapping.setNull();
+        mFileList.clear();
+        mEntries.clear();
+        mIndex.clear();
+    }
+    //-----------------------------------------------------------------------
+    void MappedZipArchive::readCentralDirectory(void)
+    {
+        const uchar* data = mMapping->getCurrentMemoryPtr();
+        size_t size = mMapping->size();
+
+        // The end of central directory record is last, apart from the comment
+        if (size < END_OF_CENTRAL_DIR_SIZE)
+            corrupted("Zip file is too short.");
+        const uchar* end = 0;
+        size_t searchStart = size > END_OF_CENTRAL_DIR_SIZE + MAX_COMMENT_SIZE ?
+            size - END_OF_CENTRAL_DIR_SIZE - MAX_COMMENT_SIZE : 0;
+        for (size_t pos = size - END_OF_CENTRAL_DIR_SIZE + 1; pos-- > searchStart; )
+        {
+            if (readUint32(data + pos) == END_OF_CENTRAL_DIR_SIGNATURE)
+            {
+                end = data + pos;
+                break;
+            }
+        }
+        if (!end)
+            corrupted("Zip-file's central directory record missing. Is this a 7z file?");
+
+        size_t numEntries = readUint16(end + 10);
+        size_t dirSize = readUint32(end + 12);
+        size_t dirOffset = readUint32(end + 16);
+        if (readUint16(end + 4) != 0 || readUint16(end + 6) != 0)
+            corrupted("Multi-part archives are not supported.");
+        if (numEntries == 0xffff || dirOffset == 0xffffffff)
+            corrupted("Zip64 archives are not supported.");
+        if (dirOffset > size || dirSize > size - dirOffset)
+            corrupted("Corrupted archive.");
+
+        mFileList.reserve(numEntries);
+        mEntries.reserve(numEntries);
+
+        const uchar* p = data + dirOffset;
+        const uchar* dirEnd = p + dirSize;
+        for (size_t i = 0; i < numEntries; ++i)
+        {
+            if (size_t(dirEnd - p) < CENTRAL_HEADER_SIZE || readUint32(p) != CENTRAL_HEADER_SIGNATURE)
+                corrupted("Corrupted archive.");
+
+            Entry entry;
+            entry.flags = readUint16(p + 8);
+            entry.method = readUint16(p + 10);
+            entry.compressedSize = readUint32(p + 20);
+            entry.uncompressedSize = readUint32(p + 24);
+            size_t nameLength = readUint16(p + 28);
+            size_t extraLength = readUint16(p + 30);
+            size_t commentLength = readUint16(p + 32);
+            entry.headerOffset = readUint32(p + 42);
+
+            size_t recordSize = CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+            if (size_t(dirEnd - p) < recordSize)
+                corrupted("Corrupted archive.");
+            if (entry.compressedSize == 0xffffffff || entry.uncompressedSize == 0xffffffff ||
+                entry.headerOffset == 0xffffffff)
+                corrupted("Zip64 archives are not supported.");
+
+            FileInfo info;
+            info.archive = this;
+            info.filename.assign(reinterpret_cast<const char*>(p + CENTRAL_HEADER_SIZE), nameLength);
+            StringUtil::splitFilename(info.filename, info.basename, info.path);
+            info.compressedSize = entry.compressedSize;
+            info.uncompressedSize = entry.uncompressedSize;
+            // folder entries
+            if (info.basename.empty())
+            {
+                info.filename = info.filename.substr(0, info.filename.length() - 1);
+                StringUtil::splitFilename(info.filename, info.basename, info.path);
+                // Same as ZipArchive, nobody checks the compressed size of a folder
+                info.compressedSize = size_t(-1);
+            }
+#if !OGRE_RESOURCEMANAGER_STRICT
+            else
+            {
+                info.filename = info.basename;
+            }
+#endif
+            mFileList.push_back(info);
+            mEntries.push_back(entry);
+
+            p += recordSize;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MappedZipArchive::buildIndex(void)
+    {
+        // Full paths first, they win over base names
+        for (size_t i = 0; i < mFileList.size(); ++i)
+        {
+            const FileInfo& info = mFileList[i];
+            mIndex.insert(EntryIndex::value_type(toLookupName(info.path + info.basename), i));
+        }
+#if !OGRE_RESOURCEMANAGER_STRICT
+        // Files can be opened by their base name, as long as it is unique
+        for (size_t i = 0; i < mFileList.size(); ++i)
+        {
+            const FileInfo& info = mFileList[i];
+            if (info.path.empty())
+                continue;
+
+            std::pair<EntryIndex::iterator, bool> inserted =
+                mIndex.insert(EntryIndex::value_type(toLookupName(info.basename), i));
+            if (!inserted.second && inserted.first->second != AMBIGUOUS_ENTRY &&
+                !mFileList[inserted.first->second].path.empty())
+            {
+                inserted.first->second = AMBIGUOUS_ENTRY;
+            }
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------
+    bool MappedZipArchive::findEntry(const String& filename, size_t& index) const
+    {
+        EntryIndex::const_iterator i = mIndex.find(toLookupName(filename));
+#if !OGRE_RESOURCEMANAGER_STRICT
+        if (i == mIndex.end())
+        {
+            // Try if we find the file by its name alone
+            String basename, path;
+            StringUtil::splitFilename(filename, basename, path);
+            i = mIndex.find(toLookupName(basename));
+        }
+#endif
+        if (i == mIndex.end())
+            return false;
+        index = i->second;
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr MappedZipArchive::open(const String& filename, bool readOnly) const
+    {
+        DataStreamPtr mapping;
+        Entry entry;
+        String lookUpFileName;
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            size_t index;
+            if (!findEntry(filename, index) || index == AMBIGUOUS_ENTRY)
+            {
+                // If there are more files with the same name do not open any
+                OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                    mName + " Cannot open file: " + filename + " - File not in archive.",
+                    "MappedZipArchive::open");
+            }
+            mapping = mMapping;
+            entry = mEntries[index];
+            lookUpFileName = mFileList[index].path + mFileList[index].basename;
+        }
+
+        // The index can't change any more, the rest needs no lock
+        if (entry.flags & FLAG_ENCRYPTED)
+        {
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                mName + " Cannot open file: " + lookUpFileName + " - Encrypted files are not supported.",
+                "MappedZipArchive::open");
+        }
+
+        const uchar* data = mapping->getCurrentMemoryPtr();
+        size_t size = mapping->size();
+        if (entry.headerOffset > size || size - entry.headerOffset < LOCAL_HEADER_SIZE ||
+            readUint32(data + entry.headerOffset) != LOCAL_HEADER_SIGNATURE)
+            corrupted("Corrupted archive.");
+
+        // The extra field can be different from the central directory's
+        const uchar* header = data + entry.headerOffset;
+        size_t dataOffset = entry.headerOffset + LOCAL_HEADER_SIZE +
+            readUint16(header + 26) + readUint16(header + 28);
+        if (dataOffset > size || size - dataOffset < entry.compressedSize)
+            corrupted("Corrupted archive.");
+
+        if (entry.method == METHOD_STORED)
+        {
+            if (entry.compressedSize != entry.uncompressedSize)
+                corrupted("Corrupted archive.");
+            return DataStreamPtr(OGRE_NEW MappedZipEntryDataStream(
+                lookUpFileName, mapping, data + dataOffset, entry.uncompressedSize));
+        }
+
+        if (entry.method != METHOD_DEFLATED)
+        {
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                mName + " Cannot open file: " + lookUpFileName + " - Unsupported compression format.",
+                "MappedZipArchive::open");
+        }
+
+        // Inflate the whole entry at once, straight into the stream's buffer
+        MemoryDataStream* stream = OGRE_NEW MemoryDataStream(lookUpFileName, entry.uncompressedSize, true, true);
+        DataStreamPtr ret(stream);
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // Negative window bits for raw deflate data, without a zlib header
+        if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                mName + " - error whilst opening " + lookUpFileName + ": Out of memory.",
+                "MappedZipArchive::open");
+        }
+        zs.next_in = const_cast<Bytef*>(data + dataOffset);
+        zs.avail_in = static_cast<uInt>(entry.compressedSize);
+        // Something to write to for empty files, inflate needs to see the end of the data
+        Bytef dummy;
+        zs.next_out = entry.uncompressedSize ? stream->getPtr() : &dummy;
+        zs.avail_out = static_cast<uInt>(entry.uncompressedSize ? entry.uncompressedSize : 1);
+        int result = inflate(&zs, Z_FINISH);
+        size_t inflated = zs.total_out;
+        inflateEnd(&zs);
+
+        if (result != Z_STREAM_END || inflated != entry.uncompressedSize)
+            corrupted("Corrupted archive.");
+
+        return ret;
+    }
+    //---------------------------------------------------------------------
+    DataStreamPtr MappedZipArchive::create(const String& filename)
+    {
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+            "Modification of zipped archives is not supported",
+            "MappedZipArchive::create");
+    }
+    //---------------------------------------------------------------------
+    void MappedZipArchive::remove(const String& filename)
+    {
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+            "Modification of zipped archives is not supported",
+            "MappedZipArchive::remove");
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr MappedZipArchive::list(bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || i->path.empty()))
+                ret->push_back(i->filename);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr MappedZipArchive::listFileInfo(bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        FileInfoList* fil = OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)();
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || i->path.empty()))
+                fil->push_back(*i);
+
+        return FileInfoListPtr(fil, SPFM_DELETE_T);
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr MappedZipArchive::find(const String& pattern, bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        // If pattern contains a directory name, do a full match
+        bool full_match = (pattern.find ('/') != String::npos) ||
+                          (pattern.find ('\\') != String::npos);
+        bool wildCard = pattern.find("*") != String::npos;
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || full_match || wildCard))
+                // Check basename matches pattern (zip is case insensitive)
+                if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+                    ret->push_back(i->filename);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr MappedZipArchive::findFileInfo(const String& pattern,
+        bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        FileInfoListPtr ret = FileInfoListPtr(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        // If pattern contains a directory name, do a full match
+        bool full_match = (pattern.find ('/') != String::npos) ||
+                          (pattern.find ('\\') != String::npos);
+        bool wildCard = pattern.find("*") != String::npos;
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || full_match || wildCard))
+                // Check name matches pattern (zip is case insensitive)
+                if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+                    ret->push_back(*i);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    bool MappedZipArchive::exists(const String& filename) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        size_t index;
+        return findEntry(filename, index);
+    }
+    //---------------------------------------------------------------------
+    time_t MappedZipArchive::getModifiedTime(const String& filename) const
+    {
+        // Same as ZipArchive, the mod time of the zip itself
+        struct stat tagStat;
+        if (stat(mName.c_str(), &tagStat) == 0)
+            return tagStat.st_mtime;
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void MappedZipArchive::corrupted(const String& reason) const
+    {
+        OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+            mName + " - error whilst reading archive: " + reason,
+            "MappedZipArchive::corrupted");
+    }
+}
+
+#endif
@@ -46,12 +46,17 @@ THE SOFTWARE.
 #include "OgreTangentSpaceCalc.h"
 #include "OgreLodStrategyManager.h"
 #include "OgrePixelCountLodStrategy.h"
+#include "OgreMeshCacheSerializer.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
     Mesh::Mesh(ResourceManager* creator, const String& name, ResourceHandle handle,
         const String& group, bool isManual, ManualResourceLoader* loader)
         : Resource(creator, name, handle, group, isManual, loader),
+        mSourceTime(0),
+        mSourceChecksumValid(false),
+        mWriteToMeshCache(false),
+        mReadFromMeshCache(false),
         mBoundRadius(0.0f),
         mBoneBoundingRadius(0.0f),
         mNumBlendWeightsPerVertex(0),
@@ -177,6 +182,18 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Mesh::postLoadImpl(void)
     {
+        // Written before preparing for shadow volumes, and while the buffers
+        // still have the data they were loaded with
+        if (mWriteToMeshCache)
+        {
+            mWriteToMeshCache = false;
+            // Current mesh files never build edge lists on demand, so they
+            // have to be part of the cache entry
+            if (!mEdgeListsBuilt && mAutoBuildEdgeLists)
+                buildEdgeList();
+            MeshManager::getSingleton()._writeMeshCache(this);
+        }
+
         // Prepare for shadow volumes?
         if (MeshManager::getSingleton().getPrepareAllMeshesForShadowVolumes())
         {
@@ -208,12 +225,40 @@ namespace Ogre {
         if (getCreator()->getVerbose())
             LogManager::getSingleton().logMessage("Mesh: Loading "+mName+".");
 
+        // Prefer the mesh cache, whose entry is used without reading the file
+        // at all while the file's time matches
+        MeshManager& meshManager = MeshManager::getSingleton();
+        bool useCache = !meshManager.getMeshCacheDirectory().empty();
+        mSourceChecksumValid = false;
+        mWriteToMeshCache = false;
+        mReadFromMeshCache = false;
+        if (useCache)
+        {
+            mFreshFromDisk = meshManager._openMeshCache(this);
+            mReadFromMeshCache = mFreshFromDisk.get() != 0;
+            if (mReadFromMeshCache)
+                return;
+        }
+
         mFreshFromDisk =
             ResourceGroupManager::getSingleton().openResource(
                 mName, mGroup, this);
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM, unless the archive already holds it
+        // in memory (e.g. mapped it) and it can be parsed in place
+        if (!mFreshFromDisk->getCurrentMemoryPtr())
+            mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+
+        // Or an entry made from the same data, e.g. of a file which was touched
+        if (useCache)
+        {
+            DataStreamPtr cached = meshManager._openMeshCache(this, mFreshFromDisk);
+            if (cached)
+            {
+                mFreshFromDisk = cached;
+                mReadFromMeshCache = true;
+            }
+        }
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -222,8 +267,7 @@ namespace Ogre {
     }
     void Mesh::loadImpl()
     {
-        MeshSerializer serializer;
-        serializer.setListener(MeshManager::getSingleton().getListener());
+        MeshSerializerListener* listener = MeshManager::getSingleton().getListener();
 
         // If the only copy is local on the stack, it will be cleaned
         // up reliably in case of exceptions, etc
@@ -236,7 +280,19 @@ namespace Ogre {
                         "Mesh::loadImpl()");
         }
 
-        serializer.importMesh(data, this);
+        if (mReadFromMeshCache)
+        {
+            MeshCacheSerializer serializer;
+            serializer.importCache(data, this, listener);
+            if (listener)
+                listener->processMeshCompleted(this);
+        }
+        else
+        {
+            MeshSerializer serializer;
+            serializer.setListener(listener);
+            serializer.importMesh(data, this);
+        }
 
         /* check all submeshes to see if their materials should be
            updated.  If the submesh has texture aliases that match those
@@ -1850,143 +1906,11 @@ namespace Ogre {
         const Matrix4* const* blendMatrices, size_t numMatrices,
         bool blendNormals)
     {
-        float *pSrcPos = 0;
-        float *pSrcNorm = 0;
-        float *pDestPos = 0;
-        float *pDestNorm = 0;
-        float *pBlendWeight = 0;
-        unsigned char* pBlendIdx = 0;
-        size_t srcPosStride = 0;
-        size_t srcNormStride = 0;
-        size_t destPosStride = 0;
-        size_t destNormStride = 0;
-        size_t blendWeightStride = 0;
-        size_t blendIdxStride = 0;
-
-
-        // Get elements for source
-        const VertexElement* srcElemPos =
-            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
-        const VertexElement* srcElemNorm =
-            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
-        const VertexElement* srcElemBlendIndices =
-            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_BLEND_INDICES);
-        const VertexElement* srcElemBlendWeights =
-            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_BLEND_WEIGHTS);
-        OgreAssert(srcElemPos && srcElemBlendIndices && srcElemBlendWeights,
-            "You must supply at least positions, blend indices and blend weights");
-        // Get elements for target
-        const VertexElement* destElemPos =
-            targetVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
-        const VertexElement* destElemNorm =
-            targetVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
-
-        // Do we have normals and want to blend them?
-        bool includeNormals = blendNormals && (srcElemNorm != NULL) && (destElemNorm != NULL);
-
-
-        // Get buffers for source
-        HardwareVertexBufferSharedPtr srcPosBuf = sourceVertexData->vertexBufferBinding->getBuffer(srcElemPos->getSource());
-        HardwareVertexBufferSharedPtr srcIdxBuf = sourceVertexData->vertexBufferBinding->getBuffer(srcElemBlendIndices->getSource());
-        HardwareVertexBufferSharedPtr srcWeightBuf = sourceVertexData->vertexBufferBinding->getBuffer(srcElemBlendWeights->getSource());
-        HardwareVertexBufferSharedPtr srcNormBuf;
-
-        srcPosStride = srcPosBuf->getVertexSize();
-        
-        blendIdxStride = srcIdxBuf->getVertexSize();
-        
-        blendWeightStride = srcWeightBuf->getVertexSize();
-        if (includeNormals)
-        {
-            srcNormBuf = sourceVertexData->vertexBufferBinding->getBuffer(srcElemNorm->getSource());
-            srcNormStride = srcNormBuf->getVertexSize();
-        }
-        // Get buffers for target
-        HardwareVertexBufferSharedPtr destPosBuf = targetVertexData->vertexBufferBinding->getBuffer(destElemPos->getSource());
-        HardwareVertexBufferSharedPtr destNormBuf;
-        destPosStride = destPosBuf->getVertexSize();
-        if (includeNormals)
-        {
-            destNormBuf = targetVertexData->vertexBufferBinding->getBuffer(destElemNorm->getSource());
-            destNormStride = destNormBuf->getVertexSize();
-        }
-
-        void* pBuffer;
-
-        // Lock source buffers for reading
-        pBuffer = srcPosBuf->lock(HardwareBuffer::HBL_READ_ONLY);
-        srcElemPos->baseVertexPointerToElement(pBuffer, &pSrcPos);
-        if (includeNormals)
-        {
-            if (srcNormBuf != srcPosBuf)
-            {
-                // Different buffer
-                pBuffer = srcNormBuf->lock(HardwareBuffer::HBL_READ_ONLY);
-            }
-            srcElemNorm->baseVertexPointerToElement(pBuffer, &pSrcNorm);
-        }
-
-        // Indices must be 4 bytes
-        assert(srcElemBlendIndices->getType() == VET_UBYTE4 &&
-               "Blend indices must be VET_UBYTE4");
-        pBuffer = srcIdxBuf->lock(HardwareBuffer::HBL_READ_ONLY);
-        srcElemBlendIndices->baseVertexPointerToElement(pBuffer, &pBlendIdx);
-        if (srcWeightBuf != srcIdxBuf)
-        {
-            // Lock buffer
-            pBuffer = srcWeightBuf->lock(HardwareBuffer::HBL_READ_ONLY);
-        }
-        srcElemBlendWeights->baseVertexPointerToElement(pBuffer, &pBlendWeight);
-        unsigned short numWeightsPerVertex =
-            VertexElement::getTypeCount(srcElemBlendWeights->getType());
-
-
-        // Lock destination buffers for writing
-        pBuffer = destPosBuf->lock(
-            (destNormBuf != destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize()) ||
-            (destNormBuf == destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize() + destElemNorm->getSize()) ?
-            HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
-        destElemPos->baseVertexPointerToElement(pBuffer, &pDestPos);
-        if (includeNormals)
-        {
-            if (destNormBuf != destPosBuf)
-            {
-                pBuffer = destNormBuf->lock(
-                    destNormBuf->getVertexSize() == destElemNorm->getSize() ?
-                    HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
-            }
-            destElemNorm->baseVertexPointerToElement(pBuffer, &pDestNorm);
-        }
-
-        OptimisedUtil::getImplementation()->softwareVertexSkinning(
-            pSrcPos, pDestPos,
-            pSrcNorm, pDestNorm,
-            pBlendWeight, pBlendIdx,
-            blendMatrices,
-            srcPosStride, destPosStride,
-            srcNormStride, destNormStride,
-            blendWeightStride, blendIdxStride,
-            numWeightsPerVertex,
-            targetVertexData->vertexCount);
-
-        // Unlock source buffers
-        srcPosBuf->unlock();
-        srcIdxBuf->unlock();
-        if (srcWeightBuf != srcIdxBuf)
-        {
-            srcWeightBuf->unlock();
-        }
-        if (includeNormals && srcNormBuf != srcPosBuf)
-        {
-            srcNormBuf->unlock();
-        }
-        // Unlock destination buffers
-        destPosBuf->unlock();
-        if (includeNormals && destNormBuf != destPosBuf)
-        {
-            destNormBuf->unlock();
-        }
-
+        SoftwareVertexBlendBatch batch;
+        batch.addBlend(sourceVertexData, targetVertexData, blendNormals);
+        batch.lock();
+        batch.blend(0, blendMatrices);
+        batch.unlock();
     }
     //---------------------------------------------------------------------
     void Mesh::softwareVertexMorph(Real t,
@@ -2482,5 +2406,180 @@ namespace Ogre {
     }
 #endif
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    SoftwareVertexBlendBatch::SoftwareVertexBlendBatch()
+        : mLocked(false)
+    {
+    }
+    //---------------------------------------------------------------------
+    SoftwareVertexBlendBatch::~SoftwareVertexBlendBatch()
+    {
+        clear();
+    }
+    //---------------------------------------------------------------------
+    SoftwareVertexBlendBatch::Stream SoftwareVertexBlendBatch::addStream(
+        const HardwareVertexBufferSharedPtr& buffer, const VertexElement* elem,
+        HardwareBuffer::LockOptions options)
+    {
+        std::pair<LockedBufferIndexMap::iterator, bool> inserted =
+            mBufferIndices.insert(LockedBufferIndexMap::value_type(buffer.get(), mBuffers.size()));
+        if (inserted.second)
+        {
+            LockedBuffer locked;
+            locked.buffer = buffer;
+            locked.options = options;
+            locked.data = 0;
+            mBuffers.push_back(locked);
+        }
+        else
+        {
+            // Shared by several streams, only discard if all of them just write
+            LockedBuffer& locked = mBuffers[inserted.first->second];
+            if (locked.options != options)
+                locked.options = HardwareBuffer::HBL_NORMAL;
+        }
+
+        Stream stream;
+        stream.buffer = inserted.first->second;
+        stream.offset = elem->getOffset();
+        stream.stride = buffer->getVertexSize();
+        return stream;
+    }
+    //---------------------------------------------------------------------
+    size_t SoftwareVertexBlendBatch::addBlend(const VertexData* sourceVertexData,
+        const VertexData* targetVertexData, bool blendNormals)
+    {
+        assert(!mLocked && "Can't add blends to a locked batch");
+
+        // Get elements for source
+        const VertexElement* srcElemPos =
+            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        const VertexElement* srcElemNorm =
+            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+        const VertexElement* srcElemBlendIndices =
+            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_BLEND_INDICES);
+        const VertexElement* srcElemBlendWeights =
+            sourceVertexData->vertexDeclaration->findElementBySemantic(VES_BLEND_WEIGHTS);
+        OgreAssert(srcElemPos && srcElemBlendIndices && srcElemBlendWeights,
+            "You must supply at least positions, blend indices and blend weights");
+        // Get elements for target
+        const VertexElement* destElemPos =
+            targetVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        const VertexElement* destElemNorm =
+            targetVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+
+        // Indices must be 4 bytes
+        assert(srcElemBlendIndices->getType() == VET_UBYTE4 &&
+               "Blend indices must be VET_UBYTE4");
+
+        Blend blend;
+        // Do we have normals and want to blend them?
+        blend.includeNormals = blendNormals && (srcElemNorm != NULL) && (destElemNorm != NULL);
+        blend.numWeightsPerVertex = VertexElement::getTypeCount(srcElemBlendWeights->getType());
+        blend.vertexCount = targetVertexData->vertexCount;
+
+        const VertexBufferBinding* srcBinding = sourceVertexData->vertexBufferBinding;
+        const VertexBufferBinding* destBinding = targetVertexData->vertexBufferBinding;
+
+        // Source buffers are only read
+        blend.srcPos = addStream(srcBinding->getBuffer(srcElemPos->getSource()),
+            srcElemPos, HardwareBuffer::HBL_READ_ONLY);
+        blend.blendIdx = addStream(srcBinding->getBuffer(srcElemBlendIndices->getSource()),
+            srcElemBlendIndices, HardwareBuffer::HBL_READ_ONLY);
+        blend.blendWeight = addStream(srcBinding->getBuffer(srcElemBlendWeights->getSource()),
+            srcElemBlendWeights, HardwareBuffer::HBL_READ_ONLY);
+        if (blend.includeNormals)
+        {
+            blend.srcNorm = addStream(srcBinding->getBuffer(srcElemNorm->getSource()),
+                srcElemNorm, HardwareBuffer::HBL_READ_ONLY);
+        }
+
+        // Destination buffers may be discarded if the blend overwrites all of them
+        const HardwareVertexBufferSharedPtr& destPosBuf = destBinding->getBuffer(destElemPos->getSource());
+        HardwareVertexBufferSharedPtr destNormBuf;
+        if (blend.includeNormals)
+            destNormBuf = destBinding->getBuffer(destElemNorm->getSource());
+        blend.destPos = addStream(destPosBuf, destElemPos,
+            (destNormBuf != destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize()) ||
+            (destNormBuf == destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize() + destElemNorm->getSize()) ?
+            HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
+        if (blend.includeNormals)
+        {
+            blend.destNorm = addStream(destNormBuf, destElemNorm,
+                destNormBuf == destPosBuf ? mBuffers[blend.destPos.buffer].options :
+                destNormBuf->getVertexSize() == destElemNorm->getSize() ?
+                HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
+        }
+
+        mBlends.push_back(blend);
+        return mBlends.size() - 1;
+    }
+    //---------------------------------------------------------------------
+    void SoftwareVertexBlendBatch::lock(void)
+    {
+        assert(!mLocked && "Batch is already locked");
+
+        for (LockedBufferList::iterator i = mBuffers.begin(); i != mBuffers.end(); ++i)
+        {
+            i->data = static_cast<unsigned char*>(i->buffer->lock(i->options));
+        }
+        mLocked = true;
+    }
+    //---------------------------------------------------------------------
+    void SoftwareVertexBlendBatch::blend(size_t index, const Matrix4* const* blendMatrices) const
+    {
+        assert(mLocked && "Batch must be locked before blending");
+        assert(index < mBlends.size());
+
+        const Blend& blend = mBlends[index];
+        float* pSrcNorm = 0;
+        float* pDestNorm = 0;
+        size_t srcNormStride = 0;
+        size_t destNormStride = 0;
+        if (blend.includeNormals)
+        {
+            pSrcNorm = getStreamPointer(blend.srcNorm);
+            pDestNorm = getStreamPointer(blend.destNorm);
+            srcNormStride = blend.srcNorm.stride;
+            destNormStride = blend.destNorm.stride;
+        }
+
+        OptimisedUtil::getImplementation()->softwareVertexSkinning(
+            getStreamPointer(blend.srcPos), getStreamPointer(blend.destPos),
+            pSrcNorm, pDestNorm,
+            getStreamPointer(blend.blendWeight),
+            reinterpret_cast<unsigned char*>(getStreamPointer(blend.blendIdx)),
+            blendMatrices,
+            blend.srcPos.stride, blend.destPos.stride,
+            srcNormStride, destNormStride,
+            blend.blendWeight.stride, blend.blendIdx.stride,
+            blend.numWeightsPerVertex,
+            blend.vertexCount);
+    }
+    //---------------------------------------------------------------------
+    void SoftwareVertexBlendBatch::unlock(void)
+    {
+        assert(mLocked && "Batch isn't locked");
+
+        for (LockedBufferList::iterator i = mBuffers.begin(); i != mBuffers.end(); ++i)
+        {
+            i->buffer->unlock();
+            i->data = 0;
+        }
+        mLocked = false;
+        clear();
+    }
+    //---------------------------------------------------------------------
+    void SoftwareVertexBlendBatch::clear(void)
+    {
+        if (mLocked)
+            unlock();
+
+        mBuffers.clear();
+        mBufferIndices.clear();
+        mBlends.clear();
+    }
+
 }
 
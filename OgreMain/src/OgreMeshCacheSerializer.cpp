@@ -0,0 +1,719 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshCacheSerializer.h"
+#include "OgreMeshFileFormat.h"
+#include "OgreMeshSerializer.h"
+#include "OgreSubMesh.h"
+#include "OgreException.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreLodStrategy.h"
+#include "OgreLodStrategyManager.h"
+
+namespace Ogre {
+
+    namespace {
+        /// Whether Mesh::prepareForShadowVolume reorganises a submesh's own vertex data
+        bool isShadowVolumeOperation(RenderOperation::OperationType op)
+        {
+            return op == RenderOperation::OT_TRIANGLE_FAN ||
+                op == RenderOperation::OT_TRIANGLE_LIST ||
+                op == RenderOperation::OT_TRIANGLE_STRIP;
+        }
+    }
+    //---------------------------------------------------------------------
+    MeshCacheSerializer::MeshCacheSerializer()
+    {
+    }
+    //---------------------------------------------------------------------
+    MeshCacheSerializer::~MeshCacheSerializer()
+    {
+    }
+    //---------------------------------------------------------------------
+    bool MeshCacheSerializer::canExport(const HardwareBuffer* buf)
+    {
+        return !buf || buf->hasShadowBuffer() || buf->isSystemMemory();
+    }
+    //---------------------------------------------------------------------
+    bool MeshCacheSerializer::canExport(const VertexData* vertexData)
+    {
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            vertexData->vertexBufferBinding->getBindings();
+        VertexBufferBinding::VertexBufferBindingMap::const_iterator i;
+        for (i = bindings.begin(); i != bindings.end(); ++i)
+        {
+            if (!canExport(i->second.get()))
+                return false;
+        }
+        return true;
+    }
+    //---------------------------------------------------------------------
+    bool MeshCacheSerializer::canExport(const IndexData* indexData)
+    {
+        return canExport(indexData->indexBuffer.get());
+    }
+    //---------------------------------------------------------------------
+    bool MeshCacheSerializer::canExport(const Mesh* pMesh)
+    {
+        if (pMesh->sharedVertexData && !canExport(pMesh->sharedVertexData))
+            return false;
+
+        for (ushort i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            const SubMesh* sm = pMesh->getSubMesh(i);
+            if ((!sm->useSharedVertices && !canExport(sm->vertexData)) || !canExport(sm->indexData))
+                return false;
+            for (size_t l = 0; l < sm->mLodFaceList.size(); ++l)
+            {
+                if (!canExport(sm->mLodFaceList[l]))
+                    return false;
+            }
+        }
+
+        for (ushort a = 0; a < pMesh->getNumAnimations(); ++a)
+        {
+            const Animation::VertexTrackList& tracks = pMesh->getAnimation(a)->_getVertexTrackList();
+            Animation::VertexTrackList::const_iterator t;
+            for (t = tracks.begin(); t != tracks.end(); ++t)
+            {
+                if (t->second->getAnimationType() != VAT_MORPH)
+                    continue;
+                for (ushort k = 0; k < t->second->getNumKeyFrames(); ++k)
+                {
+                    if (!canExport(t->second->getVertexMorphKeyFrame(k)->getVertexBuffer().get()))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+    //---------------------------------------------------------------------
+    uint32 MeshCacheSerializer::getLayoutId(void)
+    {
+#if OGRE_NO_MESHLOD
+        const uint32 lodLevels = 0;
+#else
+        const uint32 lodLevels = 1;
+#endif
+        return static_cast<uint32>(sizeof(EdgeData::Triangle) | sizeof(EdgeData::Edge) << 8 |
+            sizeof(VertexBoneAssignment) << 16 | lodLevels << 24);
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::exportCache(const Mesh* pMesh, const DataStreamPtr& stream)
+    {
+        determineEndianness(ENDIAN_NATIVE);
+        mStream = stream;
+
+        writeString(pMesh->getSkeletonName());
+
+        // Bounds
+        const AxisAlignedBox& bounds = pMesh->getBounds();
+        uint32 extent = bounds.isNull() ? 0 : bounds.isInfinite() ? 2 : 1;
+        writeInts(&extent, 1);
+        float boundsInfo[7] = {
+            bounds.getMinimum().x, bounds.getMinimum().y, bounds.getMinimum().z,
+            bounds.getMaximum().x, bounds.getMaximum().y, bounds.getMaximum().z,
+            pMesh->getBoundingSphereRadius() };
+        writeFloats(boundsInfo, 7);
+
+        bool prepared = pMesh->isPreparedForShadowVolumes();
+        bool hasSharedVertices = pMesh->sharedVertexData != 0;
+        writeBools(&hasSharedVertices, 1);
+        if (hasSharedVertices)
+            writeVertexData(pMesh->sharedVertexData, prepared);
+        writeBoneAssignments(pMesh->mBoneAssignments);
+
+        uint16 numSubMeshes = pMesh->getNumSubMeshes();
+        writeShorts(&numSubMeshes, 1);
+        for (ushort i = 0; i < numSubMeshes; ++i)
+        {
+            const SubMesh* sm = pMesh->getSubMesh(i);
+            writeString(sm->getMaterialName());
+            writeBools(&sm->useSharedVertices, 1);
+            uint16 operationType = static_cast<uint16>(sm->operationType);
+            writeShorts(&operationType, 1);
+            if (!sm->useSharedVertices)
+                writeVertexData(sm->vertexData, prepared && isShadowVolumeOperation(sm->operationType));
+            writeIndexData(sm->indexData);
+            writeBoneAssignments(sm->mBoneAssignments);
+
+            uint32 numAliases = static_cast<uint32>(sm->mTextureAliases.size());
+            writeInts(&numAliases, 1);
+            AliasTextureNamePairList::const_iterator a;
+            for (a = sm->mTextureAliases.begin(); a != sm->mTextureAliases.end(); ++a)
+            {
+                writeString(a->first);
+                writeString(a->second);
+            }
+
+            uint32 numExtremes = static_cast<uint32>(sm->extremityPoints.size());
+            writeInts(&numExtremes, 1);
+            if (numExtremes)
+                writeData(&sm->extremityPoints[0], sizeof(Vector3), numExtremes);
+        }
+
+        uint32 numNames = static_cast<uint32>(pMesh->mSubMeshNameMap.size());
+        writeInts(&numNames, 1);
+        Mesh::SubMeshNameMap::const_iterator n;
+        for (n = pMesh->mSubMeshNameMap.begin(); n != pMesh->mSubMeshNameMap.end(); ++n)
+        {
+            writeString(n->first);
+            writeShorts(&n->second, 1);
+        }
+
+#if !OGRE_NO_MESHLOD
+        writeLodLevels(pMesh);
+#endif
+
+        // Edge lists of the levels which aren't manual
+        writeBools(&pMesh->mEdgeListsBuilt, 1);
+        if (pMesh->mEdgeListsBuilt)
+        {
+            for (ushort i = 0; i < pMesh->mMeshLodUsageList.size(); ++i)
+            {
+                const EdgeData* edgeData = pMesh->mMeshLodUsageList[i].edgeData;
+                bool hasEdgeData = edgeData && !pMesh->_isManualLodLevel(i);
+                writeBools(&hasEdgeData, 1);
+                if (hasEdgeData)
+                    writeEdgeData(edgeData);
+            }
+        }
+
+        // Poses and animations as in .mesh files, in chunks to the end
+        pushInnerChunk(mStream);
+        writePoses(pMesh);
+        if (pMesh->getNumAnimations())
+            writeAnimations(pMesh);
+        popInnerChunk(mStream);
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeVertexData(const VertexData* vertexData, bool preparedForShadowVolume)
+    {
+        uint32 vertexRange[2] = {
+            static_cast<uint32>(vertexData->vertexStart), static_cast<uint32>(vertexData->vertexCount) };
+        writeInts(vertexRange, 2);
+
+        const VertexDeclaration::VertexElementList& elements = vertexData->vertexDeclaration->getElements();
+        uint16 numElements = static_cast<uint16>(elements.size());
+        writeShorts(&numElements, 1);
+        VertexDeclaration::VertexElementList::const_iterator e;
+        for (e = elements.begin(); e != elements.end(); ++e)
+        {
+            uint16 element[5] = { e->getSource(), static_cast<uint16>(e->getType()),
+                static_cast<uint16>(e->getSemantic()), static_cast<uint16>(e->getOffset()), e->getIndex() };
+            writeShorts(element, 5);
+        }
+
+        // The position buffer of prepared data holds the positions twice,
+        // the copy is made again when the loaded mesh is prepared
+        const VertexElement* posElem = preparedForShadowVolume ?
+            vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION) : 0;
+
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            vertexData->vertexBufferBinding->getBindings();
+        uint16 numBuffers = static_cast<uint16>(bindings.size());
+        writeShorts(&numBuffers, 1);
+        VertexBufferBinding::VertexBufferBindingMap::const_iterator b;
+        for (b = bindings.begin(); b != bindings.end(); ++b)
+        {
+            const HardwareVertexBufferSharedPtr& vbuf = b->second;
+            size_t numVertices = vbuf->getNumVertices();
+            if (posElem && posElem->getSource() == b->first)
+                numVertices /= 2;
+
+            writeShorts(&b->first, 1);
+            uint32 layout[2] = { static_cast<uint32>(vbuf->getVertexSize()), static_cast<uint32>(numVertices) };
+            writeInts(layout, 2);
+            writeBuffer(vbuf.get(), vbuf->getVertexSize() * numVertices);
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeIndexData(const IndexData* indexData)
+    {
+        uint32 indexRange[2] = {
+            static_cast<uint32>(indexData->indexStart), static_cast<uint32>(indexData->indexCount) };
+        writeInts(indexRange, 2);
+
+        const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+        uint32 numIndexes = ibuf ? static_cast<uint32>(ibuf->getNumIndexes()) : 0;
+        writeInts(&numIndexes, 1);
+        if (numIndexes)
+        {
+            bool is32Bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
+            writeBools(&is32Bit, 1);
+            writeBuffer(ibuf.get(), ibuf->getSizeInBytes());
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeBuffer(HardwareBuffer* buf, size_t size)
+    {
+        // Read from the shadow buffer, or system memory, see canExport
+        if (size)
+        {
+            const void* data = buf->lock(0, size, HardwareBuffer::HBL_READ_ONLY);
+            writeData(data, 1, size);
+            buf->unlock();
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeBoneAssignments(const Mesh::VertexBoneAssignmentList& assignments)
+    {
+        vector<VertexBoneAssignment>::type block;
+        block.reserve(assignments.size());
+        Mesh::VertexBoneAssignmentList::const_iterator i;
+        for (i = assignments.begin(); i != assignments.end(); ++i)
+            block.push_back(i->second);
+
+        uint32 count = static_cast<uint32>(block.size());
+        writeInts(&count, 1);
+        if (count)
+            writeData(&block[0], sizeof(VertexBoneAssignment), count);
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeLodLevels(const Mesh* pMesh)
+    {
+        writeString(pMesh->getLodStrategy()->getName());
+        uint16 numLods = pMesh->getNumLodLevels();
+        writeShorts(&numLods, 1);
+        for (ushort i = 1; i < numLods; ++i)
+        {
+            const MeshLodUsage& usage = pMesh->mMeshLodUsageList[i];
+            float userValue = static_cast<float>(usage.userValue);
+            writeFloats(&userValue, 1);
+            bool isManual = pMesh->_isManualLodLevel(i);
+            writeBools(&isManual, 1);
+            if (isManual)
+            {
+                writeString(usage.manualName);
+                continue;
+            }
+
+            for (ushort s = 0; s < pMesh->getNumSubMeshes(); ++s)
+            {
+                const SubMesh* sm = pMesh->getSubMesh(s);
+                const IndexData* indexData = sm->mLodFaceList[i - 1];
+
+                // Levels may share their buffer with a previous one
+                uint16 bufferLevel = 0;
+                for (ushort l = 1; l < i; ++l)
+                {
+                    if (indexData->indexBuffer && sm->mLodFaceList[l - 1]->indexBuffer == indexData->indexBuffer)
+                        bufferLevel = l;
+                }
+                writeShorts(&bufferLevel, 1);
+                if (bufferLevel)
+                {
+                    uint32 indexRange[2] = {
+                        static_cast<uint32>(indexData->indexStart), static_cast<uint32>(indexData->indexCount) };
+                    writeInts(indexRange, 2);
+                }
+                else
+                {
+                    writeIndexData(indexData);
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::writeEdgeData(const EdgeData* edgeData)
+    {
+        writeBools(&edgeData->isClosed, 1);
+        uint32 numTriangles = static_cast<uint32>(edgeData->triangles.size());
+        writeInts(&numTriangles, 1);
+        if (numTriangles)
+        {
+            writeData(&edgeData->triangles[0], sizeof(EdgeData::Triangle), numTriangles);
+            writeData(&edgeData->triangleFaceNormals[0], sizeof(Vector4), numTriangles);
+        }
+
+        uint32 numEdgeGroups = static_cast<uint32>(edgeData->edgeGroups.size());
+        writeInts(&numEdgeGroups, 1);
+        EdgeData::EdgeGroupList::const_iterator g;
+        for (g = edgeData->edgeGroups.begin(); g != edgeData->edgeGroups.end(); ++g)
+        {
+            uint32 group[4] = { static_cast<uint32>(g->vertexSet), static_cast<uint32>(g->triStart),
+                static_cast<uint32>(g->triCount), static_cast<uint32>(g->edges.size()) };
+            writeInts(group, 4);
+            if (!g->edges.empty())
+                writeData(&g->edges[0], sizeof(EdgeData::Edge), g->edges.size());
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::importCache(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener* listener)
+    {
+        determineEndianness(ENDIAN_NATIVE);
+
+        // The edge lists are in the entry or not built at all
+        pMesh->mAutoBuildEdgeLists = false;
+
+        String skeletonName = readString(stream);
+        if (listener)
+            listener->processSkeletonName(pMesh, &skeletonName);
+        if (!skeletonName.empty())
+            pMesh->setSkeletonName(skeletonName);
+
+        uint32 extent;
+        readInts(stream, &extent, 1);
+        float boundsInfo[7];
+        readFloats(stream, boundsInfo, 7);
+        AxisAlignedBox bounds;
+        if (extent == 1)
+            bounds.setExtents(boundsInfo[0], boundsInfo[1], boundsInfo[2],
+                boundsInfo[3], boundsInfo[4], boundsInfo[5]);
+        else if (extent == 2)
+            bounds.setInfinite();
+        pMesh->_setBounds(bounds, false);
+        pMesh->_setBoundingSphereRadius(boundsInfo[6]);
+
+        bool hasSharedVertices;
+        readBools(stream, &hasSharedVertices, 1);
+        if (hasSharedVertices)
+        {
+            pMesh->sharedVertexData = OGRE_NEW VertexData();
+            readVertexData(stream, pMesh, pMesh->sharedVertexData);
+        }
+        readBoneAssignments(stream, pMesh, 0);
+
+        uint16 numSubMeshes;
+        readShorts(stream, &numSubMeshes, 1);
+        for (ushort i = 0; i < numSubMeshes; ++i)
+        {
+            SubMesh* sm = pMesh->createSubMesh();
+            String materialName = readString(stream);
+            if (listener)
+                listener->processMaterialName(pMesh, &materialName);
+            sm->setMaterialName(materialName, pMesh->getGroup());
+
+            readBools(stream, &sm->useSharedVertices, 1);
+            if (sm->useSharedVertices && !pMesh->sharedVertexData)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Submesh uses shared vertices the entry doesn't have in " + stream->getName(),
+                    "MeshCacheSerializer::importCache");
+            }
+            uint16 operationType;
+            readShorts(stream, &operationType, 1);
+            sm->operationType = static_cast<RenderOperation::OperationType>(operationType);
+            if (!sm->useSharedVertices)
+            {
+                sm->vertexData = OGRE_NEW VertexData();
+                readVertexData(stream, pMesh, sm->vertexData);
+            }
+            readIndexData(stream, pMesh, sm->indexData);
+            readBoneAssignments(stream, pMesh, sm);
+
+            uint32 numAliases;
+            readInts(stream, &numAliases, 1);
+            for (uint32 a = 0; a < numAliases; ++a)
+            {
+                String aliasName = readString(stream);
+                String textureName = readString(stream);
+                sm->addTextureAlias(aliasName, textureName);
+            }
+
+            uint32 numExtremes = readCount(stream, sizeof(Vector3));
+            sm->extremityPoints.resize(numExtremes);
+            readArray(stream, sm->extremityPoints, numExtremes);
+        }
+
+        uint32 numNames;
+        readInts(stream, &numNames, 1);
+        for (uint32 n = 0; n < numNames; ++n)
+        {
+            String name = readString(stream);
+            uint16 index;
+            readShorts(stream, &index, 1);
+            pMesh->nameSubMesh(name, index);
+        }
+
+#if !OGRE_NO_MESHLOD
+        readLodLevels(stream, pMesh);
+#endif
+
+        readBools(stream, &pMesh->mEdgeListsBuilt, 1);
+        if (pMesh->mEdgeListsBuilt)
+        {
+            for (ushort i = 0; i < pMesh->mMeshLodUsageList.size(); ++i)
+            {
+                bool hasEdgeData;
+                readBools(stream, &hasEdgeData, 1);
+                if (hasEdgeData)
+                {
+                    MeshLodUsage& usage = pMesh->mMeshLodUsageList[i];
+                    usage.edgeData = OGRE_NEW EdgeData();
+                    readEdgeData(stream, pMesh, usage.edgeData);
+                }
+            }
+        }
+
+        pushInnerChunk(stream);
+        while (!stream->eof())
+        {
+            unsigned short streamID = readChunk(stream);
+            switch (streamID)
+            {
+            case M_POSES:
+                readPoses(stream, pMesh);
+                break;
+            case M_ANIMATIONS:
+                readAnimations(stream, pMesh);
+                break;
+            default:
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Unexpected chunk in " + stream->getName(),
+                    "MeshCacheSerializer::importCache");
+            }
+        }
+        popInnerChunk(stream);
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::readVertexData(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest)
+    {
+        uint32 vertexRange[2];
+        readInts(stream, vertexRange, 2);
+        dest->vertexStart = vertexRange[0];
+        dest->vertexCount = vertexRange[1];
+
+        uint16 numElements;
+        readShorts(stream, &numElements, 1);
+        for (uint16 i = 0; i < numElements; ++i)
+        {
+            // source, type, semantic, offset, index
+            uint16 element[5];
+            readShorts(stream, element, 5);
+            dest->vertexDeclaration->addElement(element[0], element[3],
+                static_cast<VertexElementType>(element[1]),
+                static_cast<VertexElementSemantic>(element[2]), element[4]);
+        }
+
+        uint16 numBuffers;
+        readShorts(stream, &numBuffers, 1);
+        for (uint16 i = 0; i < numBuffers; ++i)
+        {
+            uint16 bindIndex;
+            readShorts(stream, &bindIndex, 1);
+            uint32 layout[2];
+            readInts(stream, layout, 2);
+            size_t size = static_cast<size_t>(layout[0]) * layout[1];
+            const void* data = readBlock(stream, size);
+
+            // Uploaded straight from the entry
+            HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+                layout[0], layout[1], pMesh->mVertexBufferUsage, pMesh->mVertexBufferShadowBuffer);
+            if (size)
+                vbuf->writeData(0, size, data, true);
+            dest->vertexBufferBinding->setBinding(bindIndex, vbuf);
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::readIndexData(DataStreamPtr& stream, Mesh* pMesh, IndexData* dest)
+    {
+        uint32 indexRange[2];
+        readInts(stream, indexRange, 2);
+        dest->indexStart = indexRange[0];
+        dest->indexCount = indexRange[1];
+
+        uint32 numIndexes;
+        readInts(stream, &numIndexes, 1);
+        if (numIndexes)
+        {
+            bool is32Bit;
+            readBools(stream, &is32Bit, 1);
+            size_t size = numIndexes * (is32Bit ? sizeof(uint32) : sizeof(uint16));
+            const void* data = readBlock(stream, size);
+
+            dest->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                is32Bit ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT,
+                numIndexes, pMesh->mIndexBufferUsage, pMesh->mIndexBufferShadowBuffer);
+            dest->indexBuffer->writeData(0, size, data, true);
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::readBoneAssignments(DataStreamPtr& stream, Mesh* pMesh, SubMesh* sub)
+    {
+        uint32 count = readCount(stream, sizeof(VertexBoneAssignment));
+        const uchar* block = static_cast<const uchar*>(readBlock(stream, count * sizeof(VertexBoneAssignment)));
+        for (uint32 i = 0; i < count; ++i)
+        {
+            VertexBoneAssignment assignment;
+            memcpy(&assignment, block + i * sizeof(VertexBoneAssignment), sizeof(VertexBoneAssignment));
+            if (sub)
+                sub->addBoneAssignment(assignment);
+            else
+                pMesh->addBoneAssignment(assignment);
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::readLodLevels(DataStreamPtr& stream, Mesh* pMesh)
+    {
+        String strategyName = readString(stream);
+        LodStrategy* strategy = LodStrategyManager::getSingleton().getStrategy(strategyName);
+        if (strategy == 0)
+            strategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+        pMesh->setLodStrategy(strategy);
+
+        readShorts(stream, &pMesh->mNumLods, 1);
+        if (pMesh->mNumLods == 0)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "No LOD levels in " + stream->getName(), "MeshCacheSerializer::readLodLevels");
+        }
+        pMesh->mMeshLodUsageList.resize(pMesh->mNumLods);
+        for (ushort s = 0; s < pMesh->getNumSubMeshes(); ++s)
+            pMesh->getSubMesh(s)->mLodFaceList.resize(pMesh->mNumLods - 1);
+
+        for (ushort i = 1; i < pMesh->mNumLods; ++i)
+        {
+            MeshLodUsage& usage = pMesh->mMeshLodUsageList[i];
+            float userValue;
+            readFloats(stream, &userValue, 1);
+            usage.userValue = userValue;
+            usage.manualMesh.reset();
+            usage.edgeData = 0;
+            bool isManual;
+            readBools(stream, &isManual, 1);
+            if (isManual)
+            {
+                pMesh->mHasManualLodLevel = true;
+                usage.manualName = readString(stream);
+                for (ushort s = 0; s < pMesh->getNumSubMeshes(); ++s)
+                    pMesh->getSubMesh(s)->mLodFaceList[i - 1] = OGRE_NEW IndexData();
+                continue;
+            }
+
+            usage.manualName = "";
+            for (ushort s = 0; s < pMesh->getNumSubMeshes(); ++s)
+            {
+                SubMesh* sm = pMesh->getSubMesh(s);
+                IndexData* indexData = OGRE_NEW IndexData();
+                sm->mLodFaceList[i - 1] = indexData;
+
+                uint16 bufferLevel;
+                readShorts(stream, &bufferLevel, 1);
+                if (bufferLevel)
+                {
+                    if (bufferLevel >= i)
+                    {
+                        OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                            "Invalid LOD buffer in " + stream->getName(), "MeshCacheSerializer::readLodLevels");
+                    }
+                    uint32 indexRange[2];
+                    readInts(stream, indexRange, 2);
+                    indexData->indexStart = indexRange[0];
+                    indexData->indexCount = indexRange[1];
+                    indexData->indexBuffer = sm->mLodFaceList[bufferLevel - 1]->indexBuffer;
+                }
+                else
+                {
+                    readIndexData(stream, pMesh, indexData);
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshCacheSerializer::readEdgeData(DataStreamPtr& stream, Mesh* pMesh, EdgeData* edgeData)
+    {
+        readBools(stream, &edgeData->isClosed, 1);
+        uint32 numTriangles = readCount(stream, sizeof(EdgeData::Triangle) + sizeof(Vector4));
+        edgeData->triangles.resize(numTriangles);
+        edgeData->triangleFaceNormals.resize(numTriangles);
+        edgeData->triangleLightFacings.resize(numTriangles);
+        readArray(stream, edgeData->triangles, numTriangles);
+        readArray(stream, edgeData->triangleFaceNormals, numTriangles);
+
+        uint32 numEdgeGroups = readCount(stream, 4 * sizeof(uint32));
+        edgeData->edgeGroups.resize(numEdgeGroups);
+        for (uint32 g = 0; g < numEdgeGroups; ++g)
+        {
+            EdgeData::EdgeGroup& edgeGroup = edgeData->edgeGroups[g];
+            uint32 group[3];
+            readInts(stream, group, 3);
+            edgeGroup.vertexSet = group[0];
+            edgeGroup.triStart = group[1];
+            edgeGroup.triCount = group[2];
+            uint32 numEdges = readCount(stream, sizeof(EdgeData::Edge));
+            edgeGroup.edges.resize(numEdges);
+            readArray(stream, edgeGroup.edges, numEdges);
+
+            // vertexSet 0 is the shared vertex data if there is any, as in .mesh files
+            size_t subMesh = edgeGroup.vertexSet - (pMesh->sharedVertexData ? 1 : 0);
+            if (pMesh->sharedVertexData && edgeGroup.vertexSet == 0)
+            {
+                edgeGroup.vertexData = pMesh->sharedVertexData;
+            }
+            else if (subMesh < pMesh->getNumSubMeshes())
+            {
+                edgeGroup.vertexData = pMesh->getSubMesh(static_cast<ushort>(subMesh))->vertexData;
+            }
+            else
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Invalid edge group vertex set in " + stream->getName(),
+                    "MeshCacheSerializer::readEdgeData");
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    uint32 MeshCacheSerializer::readCount(DataStreamPtr& stream, size_t elementSize)
+    {
+        uint32 count;
+        readInts(stream, &count, 1);
+        if (count > (stream->size() - stream->tell()) / elementSize)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Truncated mesh cache entry " + stream->getName(),
+                "MeshCacheSerializer::readCount");
+        }
+        return count;
+    }
+    //---------------------------------------------------------------------
+    const void* MeshCacheSerializer::readBlock(DataStreamPtr& stream, size_t size)
+    {
+        if (size > stream->size() - stream->tell())
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Truncated mesh cache entry " + stream->getName(),
+                "MeshCacheSerializer::readBlock");
+        }
+
+        const uchar* data = stream->getCurrentMemoryPtr();
+        if (data)
+        {
+            stream->skip(static_cast<long>(size));
+            return data;
+        }
+        mBlock.resize(size);
+        if (size)
+            stream->read(&mBlock[0], size);
+        return mBlock.empty() ? 0 : &mBlock[0];
+    }
+}
@@ -0,0 +1,119 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OGRE_MESH_CACHE_SERIALIZER_H__
+#define __OGRE_MESH_CACHE_SERIALIZER_H__
+
+/** Internal include file -- do not use externally */
+
+#include "OgrePrerequisites.h"
+#include "OgreMeshSerializerImpl.h"
+#include "OgreMesh.h"
+
+namespace Ogre {
+
+    /** Reads and writes the mesh data of MeshManager cache entries.
+    @remarks
+        Entries are only ever read by the build which wrote them, so they
+        hold the mesh as laid out in memory rather than in a portable
+        format: the vertex declarations, the raw bytes of the vertex and
+        index buffers, and the bone assignments and edge lists as arrays of
+        their structures. Loading an entry creates each buffer and uploads
+        it straight from the entry, which is normally mapped. Poses and
+        animations, which aren't uploaded, are kept in their .mesh chunks.
+    @par
+        The buffers are read through their shadow buffers, so a mesh can
+        only be written if canExport allows it; hardware buffers are never
+        read back. Geometry reorganised by Mesh::prepareForShadowVolume is
+        stored as it was before, so entries are the same whether the mesh
+        was prepared or not.
+    */
+    class _OgrePrivate MeshCacheSerializer : public MeshSerializerImpl
+    {
+    public:
+        MeshCacheSerializer();
+        virtual ~MeshCacheSerializer();
+
+        /** Whether all buffers of a mesh can be read without reading back
+            hardware buffers, i.e. have a shadow buffer or are in system memory.
+        */
+        static bool canExport(const Mesh* pMesh);
+
+        /** Identifies the layout of the arrays in entries, which depends on
+            the build options.
+        */
+        static uint32 getLayoutId(void);
+
+        /** Writes a mesh to a stream, which must be native endian. */
+        void exportCache(const Mesh* pMesh, const DataStreamPtr& stream);
+
+        /** Reads a mesh written by exportCache into an empty mesh.
+        @remarks
+            The stream must hold the whole entry in memory.
+        */
+        void importCache(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener* listener);
+
+    protected:
+        static bool canExport(const HardwareBuffer* buf);
+        static bool canExport(const VertexData* vertexData);
+        static bool canExport(const IndexData* indexData);
+
+        void writeVertexData(const VertexData* vertexData, bool preparedForShadowVolume);
+        void writeIndexData(const IndexData* indexData);
+        void writeBuffer(HardwareBuffer* buf, size_t size);
+        void writeBoneAssignments(const Mesh::VertexBoneAssignmentList& assignments);
+        void writeLodLevels(const Mesh* pMesh);
+        void writeEdgeData(const EdgeData* edgeData);
+
+        void readVertexData(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
+        void readIndexData(DataStreamPtr& stream, Mesh* pMesh, IndexData* dest);
+        void readBoneAssignments(DataStreamPtr& stream, Mesh* pMesh, SubMesh* sub);
+        void readLodLevels(DataStreamPtr& stream, Mesh* pMesh);
+        void readEdgeData(DataStreamPtr& stream, Mesh* pMesh, EdgeData* edgeData);
+
+        /** Reads the element count of an array, checking the entry holds them. */
+        uint32 readCount(DataStreamPtr& stream, size_t elementSize);
+        /** Reads size bytes, in place unless the stream isn't in memory. */
+        const void* readBlock(DataStreamPtr& stream, size_t size);
+        /** Reads count elements of an array into a vector of that size.
+        @remarks
+            The elements are copied bytewise, so they must not own anything.
+        */
+        template<typename T> void readArray(DataStreamPtr& stream, T& dest, size_t count)
+        {
+            if (count)
+                memcpy(static_cast<void*>(&dest[0]), readBlock(stream, count * sizeof(dest[0])),
+                       count * sizeof(dest[0]));
+        }
+
+        /// Holds blocks read from streams which aren't in memory
+        vector<uchar>::type mBlock;
+    };
+
+}
+
+#endif
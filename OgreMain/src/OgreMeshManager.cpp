@@ -35,9 +35,14 @@ THE SOFTWARE.
 #include "OgrePatchMesh.h"
 #include "OgreHardwareBufferManager.h"
 #include "OgreException.h"
+#include "OgreMeshCacheSerializer.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreLogManager.h"
 
 #include "OgrePrefabFactory.h"
 
+#include <fstream>
+
 namespace Ogre
 {
     //-----------------------------------------------------------------------
@@ -390,6 +395,186 @@ namespace Ogre
         return mListener;
     }
     //-----------------------------------------------------------------------
+    /// Identifies mesh cache entries, "MCH2"
+    static const uint32 MESH_CACHE_ID = 0x4d434832;
+    //-----------------------------------------------------------------------
+    void MeshManager::setMeshCacheDirectory(const String& path)
+    {
+        mMeshCacheDirectory = path;
+        if (!path.empty() && !FileSystemLayer::createDirectory(path))
+        {
+            LogManager::getSingleton().logMessage(
+                "MeshManager: Cannot create mesh cache directory " + path, LML_CRITICAL);
+        }
+    }
+    //-----------------------------------------------------------------------
+    String MeshManager::getMeshCachePath(const String& name, const String& group) const
+    {
+        // The base name keeps the cache readable, the hash of the full name
+        // tells meshes from different directories or groups apart
+        String baseName, path;
+        StringUtil::splitFilename(name, baseName, path);
+        String key = group + "/" + name;
+        uint32 hash = FastHash(key.c_str(), static_cast<int>(key.size()));
+
+        String dir = mMeshCacheDirectory;
+        if (!StringUtil::endsWith(dir, "/", false) && !StringUtil::endsWith(dir, "\\", false))
+            dir += "/";
+        char hashString[9];
+        sprintf(hashString, "%08x", hash);
+        return dir + baseName + "." + hashString + ".meshcache";
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::updateMeshCache(const MeshPtr& mesh)
+    {
+        if (mMeshCacheDirectory.empty() || !mesh->mSourceChecksumValid)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+                "Mesh " + mesh->getName() + " wasn't loaded from a file with the mesh cache enabled",
+                "MeshManager::updateMeshCache");
+        }
+        _writeMeshCache(mesh.get());
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr MeshManager::openMeshCacheEntry(const Mesh* mesh, uint64 checksum[2],
+        int64& sourceTime)
+    {
+        String path = getMeshCachePath(mesh->getName(), mesh->getGroup());
+        if (!FileSystemLayer::fileExists(path))
+            return DataStreamPtr();
+
+        // Mapped if possible, the buffers are uploaded straight from the entry
+        DataStreamPtr stream;
+        try
+        {
+            if (MappedFileDataStream::isSupported())
+            {
+                stream = DataStreamPtr(OGRE_NEW MappedFileDataStream(mesh->getName(), path));
+            }
+            else
+            {
+                std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)();
+                file->open(path.c_str(), std::ios::in | std::ios::binary);
+                DataStreamPtr fileStream(OGRE_NEW FileStreamDataStream(path, file, true));
+                stream = DataStreamPtr(OGRE_NEW MemoryDataStream(mesh->getName(), fileStream));
+            }
+        }
+        catch (Exception& e)
+        {
+            LogManager::getSingleton().logMessage(
+                "MeshManager: Cannot open mesh cache entry " + path + ": " + e.getDescription());
+            return DataStreamPtr();
+        }
+
+        uint32 header[3];
+        if (stream->read(header, sizeof(header)) != sizeof(header) ||
+            header[0] != MESH_CACHE_ID || header[1] != OGRE_VERSION ||
+            header[2] != MeshCacheSerializer::getLayoutId() ||
+            stream->read(checksum, 2 * sizeof(uint64)) != 2 * sizeof(uint64) ||
+            stream->read(&sourceTime, sizeof(sourceTime)) != sizeof(sourceTime))
+        {
+            return DataStreamPtr();
+        }
+
+        return DataStreamPtr(OGRE_NEW StreamViewDataStream(stream,
+            stream->getCurrentMemoryPtr(), stream->size() - stream->tell()));
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr MeshManager::_openMeshCache(Mesh* mesh)
+    {
+        // Taken before the file is read, so a change made meanwhile can't be
+        // recorded as already cached
+        mesh->mSourceTime = ResourceGroupManager::getSingleton().resourceModifiedTime(
+            mesh->getGroup(), mesh->getName());
+        if (mesh->mSourceTime == 0)
+            return DataStreamPtr();
+
+        int64 entryTime;
+        DataStreamPtr entry = openMeshCacheEntry(mesh, mesh->mSourceChecksum, entryTime);
+        if (!entry || entryTime != mesh->mSourceTime)
+            return DataStreamPtr();
+
+        mesh->mSourceChecksumValid = true;
+        return entry;
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr MeshManager::_openMeshCache(Mesh* mesh, const DataStreamPtr& source)
+    {
+        MurmurHash3_x64_128(source->getCurrentMemoryPtr(),
+            static_cast<int>(source->size() - source->tell()), 0, mesh->mSourceChecksum);
+        mesh->mSourceChecksumValid = true;
+
+        uint64 entryChecksum[2];
+        int64 entryTime;
+        DataStreamPtr entry = openMeshCacheEntry(mesh, entryChecksum, entryTime);
+        if (!entry || entryChecksum[0] != mesh->mSourceChecksum[0] ||
+            entryChecksum[1] != mesh->mSourceChecksum[1])
+        {
+            // Entries of other versions or source files are replaced once loaded
+            mesh->mWriteToMeshCache = true;
+            return DataStreamPtr();
+        }
+
+        // Written again to record the current time, so the file isn't read
+        // next time
+        mesh->mWriteToMeshCache = mesh->mSourceTime != 0 && entryTime != mesh->mSourceTime;
+        return entry;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::_writeMeshCache(const Mesh* mesh)
+    {
+        if (!MeshCacheSerializer::canExport(mesh))
+        {
+            LogManager::getSingleton().logMessage(
+                "MeshManager: Not caching mesh " + mesh->getName() +
+                ", its buffers have neither shadow buffers nor system memory to read them from");
+            return;
+        }
+
+        // A file modified within the last second may still be written to
+        // with the same time, so its time isn't trusted
+        int64 sourceTime = mesh->mSourceTime;
+        if (sourceTime >= static_cast<int64>(time(0)) - 1)
+            sourceTime = 0;
+
+        // Written under another name first, so a partly written entry is
+        // never picked up
+        String path = getMeshCachePath(mesh->getName(), mesh->getGroup());
+        String tempPath = path + ".tmp";
+        try
+        {
+            std::fstream* file = OGRE_NEW_T(std::fstream, MEMCATEGORY_GENERAL)();
+            file->open(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            DataStreamPtr stream(OGRE_NEW FileStreamDataStream(tempPath, file, true));
+            if (!*file)
+            {
+                OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                    "Cannot create " + tempPath, "MeshManager::_writeMeshCache");
+            }
+
+            uint32 header[3] = { MESH_CACHE_ID, OGRE_VERSION, MeshCacheSerializer::getLayoutId() };
+            stream->write(header, sizeof(header));
+            stream->write(mesh->mSourceChecksum, 2 * sizeof(uint64));
+            stream->write(&sourceTime, sizeof(sourceTime));
+            MeshCacheSerializer serializer;
+            serializer.exportCache(mesh, stream);
+            stream->close();
+
+            if (!FileSystemLayer::renameFile(tempPath, path))
+            {
+                OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                    "Cannot rename " + tempPath, "MeshManager::_writeMeshCache");
+            }
+        }
+        catch (Exception& e)
+        {
+            FileSystemLayer::removeFile(tempPath);
+            LogManager::getSingleton().logMessage(
+                "MeshManager: Cannot cache mesh " + mesh->getName() + ": " + e.getDescription(),
+                LML_CRITICAL);
+        }
+    }
+    //-----------------------------------------------------------------------
     void MeshManager::loadResource(Resource* res)
     {
         Mesh* msh = static_cast<Mesh*>(res);
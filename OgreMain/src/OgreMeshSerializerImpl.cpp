@@ -825,12 +825,16 @@ namespace Ogre {
         void* pBuf = vbuf->lock(HardwareBuffer::HBL_DISCARD);
         stream->read(pBuf, dest->vertexCount * vertexSize);
 
-        // endian conversion for OSX
-        flipFromLittleEndian(
-            pBuf,
-            dest->vertexCount,
-            vertexSize,
-            dest->vertexDeclaration->findElementsBySource(bindIndex));
+        // endian conversion for OSX, skip collecting the elements when there
+        // is nothing to flip
+        if (mFlipEndian)
+        {
+            flipFromLittleEndian(
+                pBuf,
+                dest->vertexCount,
+                vertexSize,
+                dest->vertexDeclaration->findElementsBySource(bindIndex));
+        }
         vbuf->unlock();
 
         // Set binding
@@ -1176,33 +1180,86 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh)
     {
-        VertexBoneAssignment assign;
-
-        // unsigned int vertexIndex;
-        readInts(stream, &(assign.vertexIndex),1);
-        // unsigned short boneIndex;
-        readShorts(stream, &(assign.boneIndex),1);
-        // float weight;
-        readFloats(stream, &(assign.weight), 1);
-
-        pMesh->addBoneAssignment(assign);
-
+        readBoneAssignments(stream, M_MESH_BONE_ASSIGNMENT, pMesh->mBoneAssignments);
+        pMesh->mBoneAssignmentsOutOfDate = true;
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readSubMeshBoneAssignment(DataStreamPtr& stream,
         Mesh* pMesh, SubMesh* sub)
     {
-        VertexBoneAssignment assign;
+        if (sub->useSharedVertices)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "This SubMesh uses shared geometry,  you "
+                "must assign bones to the Mesh, not the SubMesh", "SubMesh.addBoneAssignment");
+        }
+        readBoneAssignments(stream, M_SUBMESH_BONE_ASSIGNMENT, sub->mBoneAssignments);
+        sub->mBoneAssignmentsOutOfDate = true;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readBoneAssignments(DataStreamPtr& stream, unsigned short chunkID,
+        multimap<size_t, VertexBoneAssignment>::type& assignments)
+    {
+        typedef multimap<size_t, VertexBoneAssignment>::type VertexBoneAssignmentList;
 
+        // The chunk header has been read by the caller
+        VertexBoneAssignment assign;
+        uint32 vertexIndex;
         // unsigned int vertexIndex;
-        readInts(stream, &(assign.vertexIndex),1);
+        readInts(stream, &vertexIndex, 1);
+        assign.vertexIndex = vertexIndex;
         // unsigned short boneIndex;
-        readShorts(stream, &(assign.boneIndex),1);
+        readShorts(stream, &(assign.boneIndex), 1);
         // float weight;
         readFloats(stream, &(assign.weight), 1);
+        // Sorted by vertex, so hinting at the end appends in constant time
+        assignments.insert(assignments.end(),
+            VertexBoneAssignmentList::value_type(assign.vertexIndex, assign));
+
+        // Then the chunks following it, until one of a different type
+        const size_t chunkSize = MSTREAM_OVERHEAD_SIZE + sizeof(uint32) + sizeof(uint16) + sizeof(float);
+        unsigned char block[64 * chunkSize];
+        size_t available;
+        do
+        {
+            available = stream->read(block, sizeof(block));
+            size_t pos = 0;
+            for (; pos + chunkSize <= available; pos += chunkSize)
+            {
+                const unsigned char* chunk = block + pos;
+                uint16 id;
+                uint32 length;
+                memcpy(&id, chunk, sizeof(uint16));
+                memcpy(&length, chunk + sizeof(uint16), sizeof(uint32));
+                Serializer::flipFromLittleEndian(&id, sizeof(uint16));
+                Serializer::flipFromLittleEndian(&length, sizeof(uint32));
+                if (id != chunkID || length != chunkSize)
+                    break;
 
-        sub->addBoneAssignment(assign);
+                chunk += MSTREAM_OVERHEAD_SIZE;
+                memcpy(&vertexIndex, chunk, sizeof(uint32));
+                memcpy(&assign.boneIndex, chunk + sizeof(uint32), sizeof(uint16));
+                float weight;
+                memcpy(&weight, chunk + sizeof(uint32) + sizeof(uint16), sizeof(float));
+                Serializer::flipFromLittleEndian(&vertexIndex, sizeof(uint32));
+                Serializer::flipFromLittleEndian(&assign.boneIndex, sizeof(uint16));
+                Serializer::flipFromLittleEndian(&weight, sizeof(float));
+                assign.vertexIndex = vertexIndex;
+                assign.weight = weight;
+                assignments.insert(assignments.end(),
+                    VertexBoneAssignmentList::value_type(assign.vertexIndex, assign));
+            }
 
+            if (pos < available)
+            {
+                // Leave the rest, from the chunk which ended the run, to the caller
+                stream->skip(-(long)(available - pos));
+                break;
+            }
+        } while (available == sizeof(block));
+#if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
+        if (!mChunkSizeStack.empty())
+            mChunkSizeStack.back() = stream->tell();
+#endif
     }
     //---------------------------------------------------------------------
     size_t MeshSerializerImpl::calcBoneAssignmentSize(void)
@@ -2014,32 +2071,32 @@ namespace Ogre {
         readInts(stream, &numEdgeGroups, 1);
         // Allocate correct amount of memory
         edgeData->edgeGroups.resize(numEdgeGroups);
-        // Triangle* triangleList
-        uint32 tmp[3];
+        // Triangle* triangleList, read in one block. Each triangle is 8 ints
+        // and 4 floats, all 4 bytes so a single endian flip covers them
+        const size_t triangleWords = 12;
+        vector<uint32>::type block(numTriangles * triangleWords);
+        if (!block.empty())
+            readInts(stream, &block[0], block.size());
         for (size_t t = 0; t < numTriangles; ++t)
         {
             EdgeData::Triangle& tri = edgeData->triangles[t];
+            const uint32* src = &block[t * triangleWords];
             // unsigned long indexSet
-            readInts(stream, tmp, 1);
-            tri.indexSet = tmp[0];
+            tri.indexSet = src[0];
             // unsigned long vertexSet
-            readInts(stream, tmp, 1);
-            tri.vertexSet = tmp[0];
+            tri.vertexSet = src[1];
             // unsigned long vertIndex[3]
-            readInts(stream, tmp, 3);
-
-            tri.vertIndex[0] = tmp[0];
-            tri.vertIndex[1] = tmp[1];
-            tri.vertIndex[2] = tmp[2];
+            tri.vertIndex[0] = src[2];
+            tri.vertIndex[1] = src[3];
+            tri.vertIndex[2] = src[4];
             // unsigned long sharedVertIndex[3]
-            readInts(stream, tmp, 3);
-            tri.sharedVertIndex[0] = tmp[0];
-            tri.sharedVertIndex[1] = tmp[1];
-            tri.sharedVertIndex[2] = tmp[2];
+            tri.sharedVertIndex[0] = src[5];
+            tri.sharedVertIndex[1] = src[6];
+            tri.sharedVertIndex[2] = src[7];
             // float normal[4]
-            readFloats(stream, &(edgeData->triangleFaceNormals[t].x), 4);
-
+            memcpy(edgeData->triangleFaceNormals[t].ptr(), src + 8, 4 * sizeof(float));
         }
+        uint32 tmp[3];
         pushInnerChunk(stream);
         for (uint32 eg = 0; eg < numEdgeGroups; ++eg)
         {
@@ -2065,24 +2122,30 @@ namespace Ogre {
             uint32 numEdges;
             readInts(stream, &numEdges, 1);
             edgeGroup.edges.resize(numEdges);
-            // Edge* edgeList
+            // Edge* edgeList, read in one block. Each edge is 6 ints and a
+            // one byte bool, so they aren't aligned
+            const size_t edgeSize = 6 * sizeof(uint32) + 1;
+            vector<unsigned char>::type edgeBlock(numEdges * edgeSize);
+            if (!edgeBlock.empty())
+                stream->read(&edgeBlock[0], edgeBlock.size());
             for (uint32 e = 0; e < numEdges; ++e)
             {
                 EdgeData::Edge& edge = edgeGroup.edges[e];
+                const unsigned char* src = &edgeBlock[e * edgeSize];
+                uint32 ints[6];
+                memcpy(ints, src, sizeof(ints));
+                Serializer::flipFromLittleEndian(ints, sizeof(uint32), 6);
                 // unsigned long  triIndex[2]
-                readInts(stream, tmp, 2);
-                edge.triIndex[0] = tmp[0];
-                edge.triIndex[1] = tmp[1];
+                edge.triIndex[0] = ints[0];
+                edge.triIndex[1] = ints[1];
                 // unsigned long  vertIndex[2]
-                readInts(stream, tmp, 2);
-                edge.vertIndex[0] = tmp[0];
-                edge.vertIndex[1] = tmp[1];
+                edge.vertIndex[0] = ints[2];
+                edge.vertIndex[1] = ints[3];
                 // unsigned long  sharedVertIndex[2]
-                readInts(stream, tmp, 2);
-                edge.sharedVertIndex[0] = tmp[0];
-                edge.sharedVertIndex[1] = tmp[1];
+                edge.sharedVertIndex[0] = ints[4];
+                edge.sharedVertIndex[1] = ints[5];
                 // bool degenerate
-                readBools(stream, &(edge.degenerate), 1);
+                edge.degenerate = src[sizeof(ints)] != 0;
             }
         }
         popInnerChunk(stream);
@@ -39,12 +39,16 @@ THE SOFTWARE.
 #include "OgreTechnique.h"
 #include "OgreManualObject.h"
 #include "OgreNameGenerator.h"
+#include "OgreNodeTransformStorage.h"
 #include "OgreMesh.h"
 
 namespace Ogre {
 
     NameGenerator Node::msNameGenerator("Unnamed_");
     Node::QueuedUpdates Node::msQueuedUpdates;
+    Node::QueuedUpdates Node::msDeferredUpdates;
+    bool Node::msDeferUpdateCallbacks = false;
+    OGRE_STATIC_MUTEX_INSTANCE(Node::msDeferredUpdatesMutex);
     //-----------------------------------------------------------------------
     Node::Node()
         :mParent(0),
@@ -65,6 +69,10 @@ namespace Ogre {
         mInitialScale(Vector3::UNIT_SCALE),
         mCachedTransformOutOfDate(true),
         mListener(0), 
+        mQueuedForDeferredUpdate(false),
+        mDeferredNodeUpdated(false),
+        mTransformStorage(0),
+        mTransformSlot(0),
         mDebug(0)
     {
         // Generate a name
@@ -95,6 +103,10 @@ namespace Ogre {
         mInitialScale(Vector3::UNIT_SCALE),
         mCachedTransformOutOfDate(true),
         mListener(0), 
+        mQueuedForDeferredUpdate(false),
+        mDeferredNodeUpdated(false),
+        mTransformStorage(0),
+        mTransformSlot(0),
         mDebug(0)
 
     {
@@ -115,6 +127,12 @@ namespace Ogre {
             mListener->nodeDestroyed(this);
         }
 
+        if (mTransformStorage)
+        {
+            mTransformStorage->_notifyNodeDestroyed(mTransformSlot);
+            mTransformStorage = 0;
+        }
+
         removeAllChildren();
         if(mParent)
             mParent->removeChild(this);
@@ -133,6 +151,15 @@ namespace Ogre {
             }
         }
 
+        if (mQueuedForDeferredUpdate)
+        {
+            OGRE_LOCK_MUTEX(msDeferredUpdatesMutex);
+            QueuedUpdates::iterator it =
+                std::find(msDeferredUpdates.begin(), msDeferredUpdates.end(), this);
+            if (it != msDeferredUpdates.end())
+                msDeferredUpdates.erase(it);
+        }
+
     }
 
     //-----------------------------------------------------------------------
@@ -140,6 +167,15 @@ namespace Ogre {
     {
         bool different = (parent != mParent);
 
+        // The layout of the storage depends on the hierarchy
+        if (different)
+        {
+            if (mTransformStorage)
+                mTransformStorage->_notifyHierarchyChanged();
+            if (parent && parent->mTransformStorage)
+                parent->mTransformStorage->_notifyHierarchyChanged();
+        }
+
         mParent = parent;
         // Request update from parent
         mParentNotified = false ;
@@ -251,6 +287,42 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Node::_updateSelf(bool parentHasChanged, ChildUpdateList& children)
+    {
+        // always clear information about parent notification
+        mParentNotified = false;
+
+        // See if we should process everyone
+        if (mNeedParentUpdate || parentHasChanged)
+        {
+            // Update transforms from parent
+            _updateFromParent();
+        }
+
+        if (mNeedChildUpdate || parentHasChanged)
+        {
+            ChildNodeMap::iterator it, itend;
+            itend = mChildren.end();
+            for (it = mChildren.begin(); it != itend; ++it)
+            {
+                children.push_back(std::make_pair(it->second, true));
+            }
+        }
+        else
+        {
+            // Just update selected children
+            ChildUpdateSet::iterator it, itend;
+            itend = mChildrenToUpdate.end();
+            for(it = mChildrenToUpdate.begin(); it != itend; ++it)
+            {
+                children.push_back(std::make_pair(*it, false));
+            }
+        }
+
+        mChildrenToUpdate.clear();
+        mNeedChildUpdate = false;
+    }
+    //-----------------------------------------------------------------------
     void Node::_updateFromParent(void) const
     {
         updateFromParentImpl();
@@ -258,7 +330,54 @@ namespace Ogre {
         // Call listener (note, this method only called if there's something to do)
         if (mListener)
         {
-            mListener->nodeUpdated(this);
+            // Listeners expect to be called from the main thread
+            if (msDeferUpdateCallbacks)
+            {
+                mDeferredNodeUpdated = true;
+                queueDeferredUpdate();
+            }
+            else
+                mListener->nodeUpdated(this);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Node::deferredUpdateImpl(void)
+    {
+    }
+    //-----------------------------------------------------------------------
+    void Node::queueDeferredUpdate(void) const
+    {
+        // Each node is only ever updated by a single thread, so the flag needs no lock
+        if (!mQueuedForDeferredUpdate)
+        {
+            mQueuedForDeferredUpdate = true;
+            OGRE_LOCK_MUTEX(msDeferredUpdatesMutex);
+            msDeferredUpdates.push_back(const_cast<Node*>(this));
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Node::processDeferredUpdates(void)
+    {
+        // Callbacks may queue further updates (e.g. queueNeedUpdate), so swap out first
+        QueuedUpdates deferred;
+        {
+            OGRE_LOCK_MUTEX(msDeferredUpdatesMutex);
+            deferred.swap(msDeferredUpdates);
+        }
+
+        for (QueuedUpdates::iterator i = deferred.begin(); i != deferred.end(); ++i)
+        {
+            Node* n = *i;
+            n->mQueuedForDeferredUpdate = false;
+            n->deferredUpdateImpl();
+
+            // Nodes may be queued for other work without having been updated
+            if (n->mDeferredNodeUpdated)
+            {
+                n->mDeferredNodeUpdated = false;
+                if (n->mListener)
+                    n->mListener->nodeUpdated(n);
+            }
         }
     }
     //-----------------------------------------------------------------------
@@ -266,6 +385,15 @@ namespace Ogre {
     {
         mCachedTransformOutOfDate = true;
 
+#if !OGRE_NODE_INHERIT_TRANSFORM
+        if (mTransformStorage && mTransformStorage->isDerivedValid())
+        {
+            // Already calculated in batches by the scene manager
+            mTransformStorage->getDerivedTransform(mTransformSlot,
+                mDerivedPosition, mDerivedOrientation, mDerivedScale);
+        }
+        else
+#endif
         if (mParent)
         {
 #if OGRE_NODE_INHERIT_TRANSFORM
@@ -796,6 +924,10 @@ namespace Ogre {
         mNeedChildUpdate = true;
         mCachedTransformOutOfDate = true;
 
+        // Keep the mirrored local transform in sync
+        if (mTransformStorage)
+            mTransformStorage->_notifyLocalTransform(mTransformSlot, this);
+
         // Make sure we're not root and parent hasn't been notified before
         if (mParent && (!mParentNotified || forceParentUpdate))
         {
@@ -807,6 +939,14 @@ namespace Ogre {
         mChildrenToUpdate.clear();
     }
     //-----------------------------------------------------------------------
+    void Node::_notifyTransformStorage(NodeTransformStorage* storage, uint32 slot)
+    {
+        mTransformStorage = storage;
+        mTransformSlot = slot;
+        if (mTransformStorage)
+            mTransformStorage->_notifyLocalTransform(mTransformSlot, this);
+    }
+    //-----------------------------------------------------------------------
     void Node::requestUpdate(Node* child, bool forceParentUpdate)
     {
         // If we're already going to update everything this doesn't matter
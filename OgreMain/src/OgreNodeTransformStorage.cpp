@@ -0,0 +1,220 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreNodeTransformStorage.h"
+#include "OgreNode.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreQuaternion.h"
+#include "OgreVector3.h"
+
+namespace Ogre {
+
+    //-----------------------------------------------------------------------
+    NodeTransformStorage::NodeTransformStorage()
+        : mCapacity(0)
+        , mBuffer(0)
+        , mParentIndices(0)
+        , mInheritOrientation(0)
+        , mInheritScale(0)
+        , mHierarchyDirty(true)
+        , mDerivedValid(false)
+    {
+        for (size_t i = 0; i < TS_COUNT; ++i)
+        {
+            mLocal[i] = 0;
+            mDerived[i] = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
+    NodeTransformStorage::~NodeTransformStorage()
+    {
+        clear();
+        OGRE_FREE_SIMD(mBuffer, MEMCATEGORY_SCENE_CONTROL);
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::reserve(size_t numSlots)
+    {
+        if (numSlots <= mCapacity)
+            return;
+
+        // Grow geometrically, keep every stream aligned
+        size_t capacity = std::max(numSlots, mCapacity + mCapacity / 2);
+        capacity = (capacity + 3) & ~size_t(3);
+
+        // Contents don't need to be preserved, rebuild fills everything in
+        OGRE_FREE_SIMD(mBuffer, MEMCATEGORY_SCENE_CONTROL);
+        mBuffer = OGRE_MALLOC_SIMD(
+            capacity * (TS_COUNT * 2 * sizeof(float) + 3 * sizeof(uint32)), MEMCATEGORY_SCENE_CONTROL);
+        mCapacity = capacity;
+
+        float* stream = static_cast<float*>(mBuffer);
+        for (size_t i = 0; i < TS_COUNT; ++i, stream += capacity)
+            mLocal[i] = stream;
+        for (size_t i = 0; i < TS_COUNT; ++i, stream += capacity)
+            mDerived[i] = stream;
+        mInheritOrientation = reinterpret_cast<uint32*>(stream);
+        mInheritScale = mInheritOrientation + capacity;
+        mParentIndices = mInheritScale + capacity;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::clear(void)
+    {
+        for (vector<Node*>::type::iterator i = mNodes.begin(); i != mNodes.end(); ++i)
+        {
+            if (*i)
+                (*i)->_notifyTransformStorage(0, 0);
+        }
+        mNodes.clear();
+        mLevelOffsets.clear();
+        mHierarchyDirty = true;
+        mDerivedValid = false;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::rebuild(Node* root)
+    {
+        clear();
+
+        // Breadth first, each level padded to a multiple of 4 so a batch never
+        // holds a node and its parent
+        typedef vector<std::pair<Node*, uint32> >::type Level;
+        Level level, nextLevel;
+        level.push_back(std::make_pair(root, uint32(0)));
+        vector<uint32>::type parents;
+
+        while (!level.empty())
+        {
+            mLevelOffsets.push_back(mNodes.size());
+            nextLevel.clear();
+            for (Level::iterator i = level.begin(); i != level.end(); ++i)
+            {
+                uint32 slot = static_cast<uint32>(mNodes.size());
+                mNodes.push_back(i->first);
+                parents.push_back(i->second);
+
+                Node::ChildNodeIterator it = i->first->getChildIterator();
+                while (it.hasMoreElements())
+                    nextLevel.push_back(std::make_pair(it.getNext(), slot));
+            }
+            while (mNodes.size() & 3)
+            {
+                mNodes.push_back(0);
+                parents.push_back(0);
+            }
+            level.swap(nextLevel);
+        }
+        mLevelOffsets.push_back(mNodes.size());
+
+        reserve(mNodes.size());
+        for (size_t slot = 0; slot < mNodes.size(); ++slot)
+        {
+            mParentIndices[slot] = parents[slot];
+            if (mNodes[slot])
+            {
+                mNodes[slot]->_notifyTransformStorage(this, static_cast<uint32>(slot));
+            }
+            else
+            {
+                // Padding, an identity transform parented to the root
+                _notifyLocalTransform(slot, 0);
+            }
+        }
+
+        mHierarchyDirty = false;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::update(Node* root)
+    {
+        if (mHierarchyDirty)
+            rebuild(root);
+
+        // The root level has no parent
+        for (size_t i = 0; i < TS_COUNT; ++i)
+            std::copy(mLocal[i], mLocal[i] + mLevelOffsets[1], mDerived[i]);
+
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        for (size_t level = 1; level + 1 < mLevelOffsets.size(); ++level)
+        {
+            util->concatenateNodeTransforms(
+                mLocal, mDerived,
+                mParentIndices, mInheritOrientation, mInheritScale,
+                mLevelOffsets[level], mLevelOffsets[level + 1] - mLevelOffsets[level]);
+        }
+
+        mDerivedValid = true;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::getDerivedTransform(size_t slot,
+        Vector3& position, Quaternion& orientation, Vector3& scale) const
+    {
+        position.x = mDerived[TS_POSITION_X][slot];
+        position.y = mDerived[TS_POSITION_Y][slot];
+        position.z = mDerived[TS_POSITION_Z][slot];
+        orientation.w = mDerived[TS_ORIENTATION_W][slot];
+        orientation.x = mDerived[TS_ORIENTATION_X][slot];
+        orientation.y = mDerived[TS_ORIENTATION_Y][slot];
+        orientation.z = mDerived[TS_ORIENTATION_Z][slot];
+        scale.x = mDerived[TS_SCALE_X][slot];
+        scale.y = mDerived[TS_SCALE_Y][slot];
+        scale.z = mDerived[TS_SCALE_Z][slot];
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::_notifyHierarchyChanged(void)
+    {
+        mHierarchyDirty = true;
+        mDerivedValid = false;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::_notifyLocalTransform(size_t slot, const Node* node)
+    {
+        const Vector3& position = node ? node->getPosition() : Vector3::ZERO;
+        const Quaternion& orientation = node ? node->getOrientation() : Quaternion::IDENTITY;
+        const Vector3& scale = node ? node->getScale() : Vector3::UNIT_SCALE;
+
+        mLocal[TS_POSITION_X][slot] = position.x;
+        mLocal[TS_POSITION_Y][slot] = position.y;
+        mLocal[TS_POSITION_Z][slot] = position.z;
+        mLocal[TS_ORIENTATION_W][slot] = orientation.w;
+        mLocal[TS_ORIENTATION_X][slot] = orientation.x;
+        mLocal[TS_ORIENTATION_Y][slot] = orientation.y;
+        mLocal[TS_ORIENTATION_Z][slot] = orientation.z;
+        mLocal[TS_SCALE_X][slot] = scale.x;
+        mLocal[TS_SCALE_Y][slot] = scale.y;
+        mLocal[TS_SCALE_Z][slot] = scale.z;
+        mInheritOrientation[slot] = (node && node->getInheritOrientation()) ? 0xFFFFFFFF : 0;
+        mInheritScale[slot] = (node && node->getInheritScale()) ? 0xFFFFFFFF : 0;
+
+        // Derived transforms calculated before the change are stale now
+        mDerivedValid = false;
+    }
+    //-----------------------------------------------------------------------
+    void NodeTransformStorage::_notifyNodeDestroyed(size_t slot)
+    {
+        mNodes[slot] = 0;
+        _notifyHierarchyChanged();
+    }
+}
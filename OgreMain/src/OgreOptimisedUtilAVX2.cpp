@@ -0,0 +1,642 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreOptimisedUtil.h"
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_AVX2
+
+#include "OgreMatrix4.h"
+
+// Should keep this includes at latest to avoid potential "xmmintrin.h" included by
+// other header file on some platform for some reason.
+#include "OgreSIMDHelper.h"
+#include <immintrin.h>
+
+//-------------------------------------------------------------------------
+//
+// Unlike the SSE version, this file is compiled with the same options as
+// the rest of the engine, since AVX2 can't be assumed to be there. The
+// functions using AVX2 are marked to be compiled for it instead, and are
+// only called once PlatformInformation has reported AVX2 and FMA.
+//
+// Everything that can't be made wider, such as the remaining elements of
+// a batch, is handed over to the SSE version.
+//
+//-------------------------------------------------------------------------
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG
+#define __OGRE_AVX2_TARGET  __attribute__((target("avx2,fma")))
+#else
+#define __OGRE_AVX2_TARGET
+#endif
+
+namespace Ogre {
+
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** AVX2 implementation of OptimisedUtil.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX2 : public OptimisedUtil
+    {
+    public:
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Matrix4* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET softwareVertexMorph(
+            Real t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+            size_t numVertices,
+            bool morphNormals);
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET concatenateAffineMatrices(
+            const Matrix4& baseMatrix,
+            const Matrix4* srcMatrices,
+            Matrix4* dstMatrices,
+            size_t numMatrices);
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles);
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces);
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_AVX2_TARGET extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateNodeTransforms
+        virtual void concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes)
+        {
+            // Dependent on the parents, gains nothing from wider registers
+            _getOptimisedUtilSSE()->concatenateNodeTransforms(
+                localStreams, derivedStreams, parentIndices,
+                inheritOrientation, inheritScale, first, numNodes);
+        }
+
+        /// @copydoc OptimisedUtil::calculateBoxVisibility
+        virtual void calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes)
+        {
+            _getOptimisedUtilSSE()->calculateBoxVisibility(
+                planes, numPlanes, centres, halfSizes, visibility, numBoxes);
+        }
+    };
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+    //---------------------------------------------------------------------
+    // Two four-vectors as one, 'lo' in the lower and 'hi' in the upper half.
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET __m256 _combine(__m128 lo, __m128 hi)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    }
+    //---------------------------------------------------------------------
+    // Load Vector3 as: (x, y, z, 0), without reading past it.
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET __m128 _loadVector3(const float* p)
+    {
+        return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p), _mm_load_ss(p + 2));
+    }
+    //---------------------------------------------------------------------
+    // Store x, y and z of the four-vector, without writing past them.
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET void _storeVector3(float* p, __m128 v)
+    {
+        _mm_storel_pi((__m64*)p, v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+    //---------------------------------------------------------------------
+    // Load four Vector3 as: (x0, x1, x2, x3), (y0, y1, y2, y3), (z0, z1, z2, z3),
+    // without reading past them. Gathering them is slower on current CPUs.
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET void _loadFourVector3(
+        __m128& x, __m128& y, __m128& z,
+        const float* p0, const float* p1, const float* p2, const float* p3)
+    {
+        // Loaded as: (x, --, y, z)
+        __m128 v0 = _mm_loadh_pi(_mm_load_ss(p0), (const __m64*)(p0 + 1));
+        __m128 v1 = _mm_loadh_pi(_mm_load_ss(p1), (const __m64*)(p1 + 1));
+        __m128 v2 = _mm_loadh_pi(_mm_load_ss(p2), (const __m64*)(p2 + 1));
+        __m128 v3 = _mm_loadh_pi(_mm_load_ss(p3), (const __m64*)(p3 + 1));
+
+        __m128 t0 = _mm_unpacklo_ps(v0, v2);    // x0 x2 -- --
+        __m128 t1 = _mm_unpacklo_ps(v1, v3);    // x1 x3 -- --
+        x = _mm_unpacklo_ps(t0, t1);            // x0 x1 x2 x3
+
+        t0 = _mm_unpackhi_ps(v0, v2);           // y0 y2 z0 z2
+        t1 = _mm_unpackhi_ps(v1, v3);           // y1 y3 z1 z3
+        y = _mm_unpacklo_ps(t0, t1);            // y0 y1 y2 y3
+        z = _mm_unpackhi_ps(t0, t1);            // z0 z1 z2 z3
+    }
+    //---------------------------------------------------------------------
+    // Load two Vector3 as: (x0, y0, z0, w | x1, y1, z1, w).
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET __m256 _loadTwoVector3(const float* p0, const float* p1, float w)
+    {
+        return _combine(_mm_setr_ps(p0[0], p0[1], p0[2], w), _mm_setr_ps(p1[0], p1[1], p1[2], w));
+    }
+    //---------------------------------------------------------------------
+    // Transform two vectors by their own 3x4 matrix, rows of the matrices
+    // in 'row0', 'row1' and 'row2', the vectors and matrices of the first
+    // one in the lower halves. Returns (x0, y0, z0, z0 | x1, y1, z1, z1).
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET __m256 _transformTwoAffine(
+        __m256 row0, __m256 row1, __m256 row2, __m256 v)
+    {
+        __m256 t0 = _mm256_mul_ps(row0, v);
+        __m256 t1 = _mm256_mul_ps(row1, v);
+        __m256 t2 = _mm256_mul_ps(row2, v);
+        return _mm256_hadd_ps(_mm256_hadd_ps(t0, t1), _mm256_hadd_ps(t2, t2));
+    }
+    //---------------------------------------------------------------------
+    // Store the x, y and z of two four-vectors, without writing past them.
+    static OGRE_FORCE_INLINE __OGRE_AVX2_TARGET void _storeTwoVector3(float* p0, float* p1, __m256 v)
+    {
+        __m128 v0 = _mm256_castps256_ps128(v);
+        __m128 v1 = _mm256_extractf128_ps(v, 1);
+        _mm_storel_pi((__m64*)p0, v0);
+        _mm_store_ss(p0 + 2, _mm_movehl_ps(v0, v0));
+        _mm_storel_pi((__m64*)p1, v1);
+        _mm_store_ss(p1 + 2, _mm_movehl_ps(v1, v1));
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Matrix4* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        // Two vertices per-iteration, one in each half of the registers.
+        // Collapse the weighted matrices like the SSE version, each weight
+        // costs three 8-wide multiply-adds for the pair.
+        size_t numIterations = numVertices / 2;
+
+        for (size_t i = 0; i < numIterations; ++i)
+        {
+            const float* pSrcPos1 = rawOffsetPointer(pSrcPos, srcPosStride);
+            float* pDestPos1 = rawOffsetPointer(pDestPos, destPosStride);
+            const float* pBlendWeight1 = rawOffsetPointer(pBlendWeight, blendWeightStride);
+            const unsigned char* pBlendIndex1 = rawOffsetPointer(pBlendIndex, blendIndexStride);
+
+            __m256 row0 = _mm256_setzero_ps();
+            __m256 row1 = _mm256_setzero_ps();
+            __m256 row2 = _mm256_setzero_ps();
+            for (size_t j = 0; j < numWeightsPerVertex; ++j)
+            {
+                const Matrix4& m0 = *blendMatrices[pBlendIndex[j]];
+                const Matrix4& m1 = *blendMatrices[pBlendIndex1[j]];
+                __m256 weight = _combine(_mm_broadcast_ss(pBlendWeight + j), _mm_broadcast_ss(pBlendWeight1 + j));
+                row0 = _mm256_fmadd_ps(weight, _combine(_mm_loadu_ps(m0[0]), _mm_loadu_ps(m1[0])), row0);
+                row1 = _mm256_fmadd_ps(weight, _combine(_mm_loadu_ps(m0[1]), _mm_loadu_ps(m1[1])), row1);
+                row2 = _mm256_fmadd_ps(weight, _combine(_mm_loadu_ps(m0[2]), _mm_loadu_ps(m1[2])), row2);
+            }
+
+            // Positions, with w = 1 to pick up the translation
+            __m256 pos = _loadTwoVector3(pSrcPos, pSrcPos1, 1.0f);
+            _storeTwoVector3(pDestPos, pDestPos1, _transformTwoAffine(row0, row1, row2, pos));
+
+            if (pSrcNorm)
+            {
+                const float* pSrcNorm1 = rawOffsetPointer(pSrcNorm, srcNormStride);
+                float* pDestNorm1 = rawOffsetPointer(pDestNorm, destNormStride);
+
+                // Normals, rotated only. The 3x3 part is assumed to be
+                // orthogonal, see the general version. Normalised with the
+                // same precision as the SSE version.
+                __m256 norm = _transformTwoAffine(row0, row1, row2, _loadTwoVector3(pSrcNorm, pSrcNorm1, 0.0f));
+                norm = _mm256_mul_ps(norm, _mm256_rsqrt_ps(_mm256_dp_ps(norm, norm, 0x7F)));
+                _storeTwoVector3(pDestNorm, pDestNorm1, norm);
+
+                advanceRawPointer(pSrcNorm, 2 * srcNormStride);
+                advanceRawPointer(pDestNorm, 2 * destNormStride);
+            }
+
+            advanceRawPointer(pSrcPos, 2 * srcPosStride);
+            advanceRawPointer(pDestPos, 2 * destPosStride);
+            advanceRawPointer(pBlendWeight, 2 * blendWeightStride);
+            advanceRawPointer(pBlendIndex, 2 * blendIndexStride);
+        }
+
+        // Dealing with remaining vertex
+        if (numVertices & 1)
+        {
+            _getOptimisedUtilSSE()->softwareVertexSkinning(
+                pSrcPos, pDestPos,
+                pSrcNorm, pDestNorm,
+                pBlendWeight, pBlendIndex,
+                blendMatrices,
+                srcPosStride, destPosStride,
+                srcNormStride, destNormStride,
+                blendWeightStride, blendIndexStride,
+                numWeightsPerVertex,
+                1);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::softwareVertexMorph(
+        Real t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        const size_t floatsPerVertex = morphNormals ? 6 : 3;
+        const size_t packedVSize = floatsPerVertex * sizeof(float);
+        if (pos1VSize != packedVSize || pos2VSize != packedVSize || dstVSize != packedVSize)
+        {
+            // Interleaved with other elements, can't lerp the buffers as a whole
+            _getOptimisedUtilGeneral()->softwareVertexMorph(
+                t, pSrc1, pSrc2, pDst,
+                pos1VSize, pos2VSize, dstVSize,
+                numVertices, morphNormals);
+            return;
+        }
+
+        // Lerp the buffers as flat arrays of floats, positions and normals alike
+        const __m256 t8 = _mm256_set1_ps(t);
+        const size_t numFloats = numVertices * floatsPerVertex;
+        size_t i = 0;
+        for (; i + 8 <= numFloats; i += 8)
+        {
+            __m256 src1 = _mm256_loadu_ps(pSrc1 + i);
+            __m256 src2 = _mm256_loadu_ps(pSrc2 + i);
+            _mm256_storeu_ps(pDst + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(src2, src1), src1));
+        }
+
+        if (i < numFloats)
+        {
+            // Remaining floats, the masked out ones are neither read nor written
+            __m256i mask = _mm256_cmpgt_epi32(
+                _mm256_set1_epi32(int(numFloats - i)),
+                _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256 src1 = _mm256_maskload_ps(pSrc1 + i, mask);
+            __m256 src2 = _mm256_maskload_ps(pSrc2 + i, mask);
+            _mm256_maskstore_ps(pDst + i, mask, _mm256_fmadd_ps(t8, _mm256_sub_ps(src2, src1), src1));
+        }
+
+        if (morphNormals)
+        {
+            // nlerp, normals follow the positions
+            float* pNorm = pDst + 3;
+            for (size_t n = 0; n < numVertices; ++n, pNorm += 6)
+            {
+                __m128 norm = _loadVector3(pNorm);
+                norm = _mm_div_ps(norm, _mm_sqrt_ps(_mm_dp_ps(norm, norm, 0x7F)));
+                _storeVector3(pNorm, norm);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::concatenateAffineMatrices(
+        const Matrix4& baseMatrix,
+        const Matrix4* pSrcMat,
+        Matrix4* pDstMat,
+        size_t numMatrices)
+    {
+        const Matrix4& m = baseMatrix;
+
+        // Coefficients of the base matrix, for rows 0 and 1 of the results
+        // side by side, and for row 2
+        const __m256 c0 = _combine(_mm_set1_ps(m[0][0]), _mm_set1_ps(m[1][0]));
+        const __m256 c1 = _combine(_mm_set1_ps(m[0][1]), _mm_set1_ps(m[1][1]));
+        const __m256 c2 = _combine(_mm_set1_ps(m[0][2]), _mm_set1_ps(m[1][2]));
+        const __m256 t01 = _mm256_setr_ps(0, 0, 0, m[0][3], 0, 0, 0, m[1][3]);
+        const __m128 c20 = _mm_set1_ps(m[2][0]);
+        const __m128 c21 = _mm_set1_ps(m[2][1]);
+        const __m128 c22 = _mm_set1_ps(m[2][2]);
+        const __m128 t2 = _mm_setr_ps(0, 0, 0, m[2][3]);
+        const __m128 row3 = _mm_setr_ps(0, 0, 0, 1);
+
+        for (size_t i = 0; i < numMatrices; ++i)
+        {
+            // Rows of the source matrix, duplicated to both halves
+            __m256 s0 = _mm256_broadcast_ps((const __m128*)(*pSrcMat)[0]);
+            __m256 s1 = _mm256_broadcast_ps((const __m128*)(*pSrcMat)[1]);
+            __m256 s2 = _mm256_broadcast_ps((const __m128*)(*pSrcMat)[2]);
+            ++pSrcMat;
+
+            __m256 d01 = _mm256_fmadd_ps(c0, s0, _mm256_fmadd_ps(c1, s1, _mm256_fmadd_ps(c2, s2, t01)));
+            __m128 d2 = _mm_fmadd_ps(c20, _mm256_castps256_ps128(s0),
+                _mm_fmadd_ps(c21, _mm256_castps256_ps128(s1),
+                _mm_fmadd_ps(c22, _mm256_castps256_ps128(s2), t2)));
+
+            _mm256_storeu_ps((*pDstMat)[0], d01);
+            _mm_storeu_ps((*pDstMat)[2], d2);
+            _mm_storeu_ps((*pDstMat)[3], row3);
+            ++pDstMat;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        size_t numIterations = numTriangles / 8;
+        numTriangles &= 7;
+
+        // Eight triangles per-iteration
+        for (size_t i = 0; i < numIterations; ++i)
+        {
+            // Load the vertices of eight triangles, packed as component-major
+            // format: xxxxxxxx yyyyyyyy zzzzzzzz
+            __m256 x[3], y[3], z[3];
+            for (int v = 0; v < 3; ++v)
+            {
+                __m128 x0, y0, z0, x1, y1, z1;
+                _loadFourVector3(x0, y0, z0,
+                    positions + triangles[0].vertIndex[v] * 3,
+                    positions + triangles[1].vertIndex[v] * 3,
+                    positions + triangles[2].vertIndex[v] * 3,
+                    positions + triangles[3].vertIndex[v] * 3);
+                _loadFourVector3(x1, y1, z1,
+                    positions + triangles[4].vertIndex[v] * 3,
+                    positions + triangles[5].vertIndex[v] * 3,
+                    positions + triangles[6].vertIndex[v] * 3,
+                    positions + triangles[7].vertIndex[v] * 3);
+                x[v] = _combine(x0, x1);
+                y[v] = _combine(y0, y1);
+                z[v] = _combine(z0, z1);
+            }
+            triangles += 8;
+
+            // a = v1 - v0
+            __m256 ax = _mm256_sub_ps(x[1], x[0]);
+            __m256 ay = _mm256_sub_ps(y[1], y[0]);
+            __m256 az = _mm256_sub_ps(z[1], z[0]);
+
+            // b = v2 - v0
+            __m256 bx = _mm256_sub_ps(x[2], x[0]);
+            __m256 by = _mm256_sub_ps(y[2], y[0]);
+            __m256 bz = _mm256_sub_ps(z[2], z[0]);
+
+            // n = a cross b
+            __m256 nx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+            __m256 ny = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+            __m256 nz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+
+            // w = - (n dot v0)
+            __m256 nw = _mm256_fnmsub_ps(nz, z[0],
+                _mm256_fmadd_ps(ny, y[0], _mm256_mul_ps(nx, x[0])));
+
+            // Arrange to per-triangle face normal major format, triangles
+            // 0-3 in the lower and 4-7 in the upper halves
+            __m256 t0 = _mm256_unpacklo_ps(nx, ny);     // x0 y0 x1 y1 | x4 y4 x5 y5
+            __m256 t1 = _mm256_unpackhi_ps(nx, ny);     // x2 y2 x3 y3 | x6 y6 x7 y7
+            __m256 t2 = _mm256_unpacklo_ps(nz, nw);     // z0 w0 z1 w1 | z4 w4 z5 w5
+            __m256 t3 = _mm256_unpackhi_ps(nz, nw);     // z2 w2 z3 w3 | z6 w6 z7 w7
+            __m256 r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1,0,1,0));    // n0 | n4
+            __m256 r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3,2,3,2));    // n1 | n5
+            __m256 r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1,0,1,0));    // n2 | n6
+            __m256 r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3,2,3,2));    // n3 | n7
+
+            // Store results
+            _mm256_storeu_ps(&faceNormals[0].x, _mm256_permute2f128_ps(r0, r1, 0x20));
+            _mm256_storeu_ps(&faceNormals[2].x, _mm256_permute2f128_ps(r2, r3, 0x20));
+            _mm256_storeu_ps(&faceNormals[4].x, _mm256_permute2f128_ps(r0, r1, 0x31));
+            _mm256_storeu_ps(&faceNormals[6].x, _mm256_permute2f128_ps(r2, r3, 0x31));
+            faceNormals += 8;
+        }
+
+        // Dealing with remaining triangles
+        if (numTriangles)
+            _getOptimisedUtilSSE()->calculateFaceNormals(positions, triangles, faceNormals, numTriangles);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        // Map to convert 4-bits mask to 4 byte values
+        static const char msMaskMapping[16][4] =
+        {
+            {0, 0, 0, 0},   {1, 0, 0, 0},   {0, 1, 0, 0},   {1, 1, 0, 0},
+            {0, 0, 1, 0},   {1, 0, 1, 0},   {0, 1, 1, 0},   {1, 1, 1, 0},
+            {0, 0, 0, 1},   {1, 0, 0, 1},   {0, 1, 0, 1},   {1, 1, 0, 1},
+            {0, 0, 1, 1},   {1, 0, 1, 1},   {0, 1, 1, 1},   {1, 1, 1, 1},
+        };
+
+        // Light vector in both halves
+        const __m256 lp = _mm256_broadcast_ps((const __m128*)&lightPos.x);
+        const __m256 zero = _mm256_setzero_ps();
+        // Puts the dot products back in face order
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+        size_t numIterations = numFaces / 8;
+        numFaces &= 7;
+
+        // Eight faces per-iteration
+        for (size_t i = 0; i < numIterations; ++i)
+        {
+            __m256 n01 = _mm256_mul_ps(_mm256_loadu_ps(&faceNormals[0].x), lp);
+            __m256 n23 = _mm256_mul_ps(_mm256_loadu_ps(&faceNormals[2].x), lp);
+            __m256 n45 = _mm256_mul_ps(_mm256_loadu_ps(&faceNormals[4].x), lp);
+            __m256 n67 = _mm256_mul_ps(_mm256_loadu_ps(&faceNormals[6].x), lp);
+            faceNormals += 8;
+
+            // Horizontal add, each half holds every other face
+            __m256 dp = _mm256_hadd_ps(                 // dp0 dp2 dp4 dp6 | dp1 dp3 dp5 dp7
+                _mm256_hadd_ps(n01, n23),
+                _mm256_hadd_ps(n45, n67));
+            dp = _mm256_permutevar8x32_ps(dp, order);   // dp0 .. dp7
+
+            int bitmask = _mm256_movemask_ps(_mm256_cmp_ps(dp, zero, _CMP_GT_OQ));
+
+            // Convert 8-bits mask to 8 bytes, and store results.
+            memcpy(lightFacings + 0, msMaskMapping[bitmask & 15], sizeof(uint32));
+            memcpy(lightFacings + 4, msMaskMapping[bitmask >> 4], sizeof(uint32));
+            lightFacings += 8;
+        }
+
+        // Dealing with remaining faces
+        if (numFaces)
+            _getOptimisedUtilSSE()->calculateLightFacing(lightPos, faceNormals, lightFacings, numFaces);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        // Eight vertices per-iteration, kept in their interleaved format
+        // as three registers:
+        //
+        //   s0: x0 y0 z0 x1 y1 z1 x2 y2
+        //   s1: z2 x3 y3 z3 x4 y4 z4 x5
+        //   s2: y5 z5 x6 y6 z6 x7 y7 z7
+        //
+        size_t numIterations = numVertices / 8;
+        size_t numRemaining = numVertices & 7;
+
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, extrusion is along light direction
+            Vector3 dir(-lightPos.x, -lightPos.y, -lightPos.z);
+            dir.normalise();
+            dir *= extrudeDist;
+
+            const __m256 d0 = _mm256_setr_ps(dir.x, dir.y, dir.z, dir.x, dir.y, dir.z, dir.x, dir.y);
+            const __m256 d1 = _mm256_setr_ps(dir.z, dir.x, dir.y, dir.z, dir.x, dir.y, dir.z, dir.x);
+            const __m256 d2 = _mm256_setr_ps(dir.y, dir.z, dir.x, dir.y, dir.z, dir.x, dir.y, dir.z);
+
+            for (size_t i = 0; i < numIterations; ++i)
+            {
+                _mm256_storeu_ps(pDestPos + 0, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 0), d0));
+                _mm256_storeu_ps(pDestPos + 8, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 8), d1));
+                _mm256_storeu_ps(pDestPos + 16, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 16), d2));
+                pSrcPos += 24;
+                pDestPos += 24;
+            }
+        }
+        else
+        {
+            // Point light, calculate extrusion direction for every vertex
+            assert(lightPos.w == 1.0f);
+
+            const __m256 l0 = _mm256_setr_ps(lightPos.x, lightPos.y, lightPos.z, lightPos.x, lightPos.y, lightPos.z, lightPos.x, lightPos.y);
+            const __m256 l1 = _mm256_setr_ps(lightPos.z, lightPos.x, lightPos.y, lightPos.z, lightPos.x, lightPos.y, lightPos.z, lightPos.x);
+            const __m256 l2 = _mm256_setr_ps(lightPos.y, lightPos.z, lightPos.x, lightPos.y, lightPos.z, lightPos.x, lightPos.y, lightPos.z);
+            const __m256 extrudeDist8 = _mm256_set1_ps(extrudeDist);
+
+            // Gather the squared x, y and z of each vertex into its own element
+            const __m256i orderX = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+            const __m256i orderY = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+            const __m256i orderZ = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+            // Spread the per vertex scales back to the interleaved format
+            const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+            const __m256i spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+            const __m256i spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+            for (size_t i = 0; i < numIterations; ++i)
+            {
+                __m256 s0 = _mm256_loadu_ps(pSrcPos + 0);
+                __m256 s1 = _mm256_loadu_ps(pSrcPos + 8);
+                __m256 s2 = _mm256_loadu_ps(pSrcPos + 16);
+                pSrcPos += 24;
+
+                // Unnormalised extrusion directions
+                __m256 d0 = _mm256_sub_ps(s0, l0);
+                __m256 d1 = _mm256_sub_ps(s1, l1);
+                __m256 d2 = _mm256_sub_ps(s2, l2);
+
+                // Squared lengths, component-major
+                __m256 q0 = _mm256_mul_ps(d0, d0);
+                __m256 q1 = _mm256_mul_ps(d1, d1);
+                __m256 q2 = _mm256_mul_ps(d2, d2);
+                __m256 xx = _mm256_permutevar8x32_ps(
+                    _mm256_blend_ps(_mm256_blend_ps(q0, q1, 0x92), q2, 0x24), orderX);
+                __m256 yy = _mm256_permutevar8x32_ps(
+                    _mm256_blend_ps(_mm256_blend_ps(q0, q1, 0x24), q2, 0x49), orderY);
+                __m256 zz = _mm256_permutevar8x32_ps(
+                    _mm256_blend_ps(_mm256_blend_ps(q0, q1, 0x49), q2, 0x92), orderZ);
+
+                // Normalise extrusion direction and multiply by extrude distance,
+                // the SSE reciprocal square root is precise enough here too
+                __m256 scale = _mm256_mul_ps(
+                    _mm256_rsqrt_ps(_mm256_add_ps(_mm256_add_ps(xx, yy), zz)), extrudeDist8);
+
+                _mm256_storeu_ps(pDestPos + 0, _mm256_fmadd_ps(d0, _mm256_permutevar8x32_ps(scale, spread0), s0));
+                _mm256_storeu_ps(pDestPos + 8, _mm256_fmadd_ps(d1, _mm256_permutevar8x32_ps(scale, spread1), s1));
+                _mm256_storeu_ps(pDestPos + 16, _mm256_fmadd_ps(d2, _mm256_permutevar8x32_ps(scale, spread2), s2));
+                pDestPos += 24;
+            }
+        }
+
+        // Dealing with remaining vertices
+        if (numRemaining)
+            _getOptimisedUtilSSE()->extrudeVertices(lightPos, extrudeDist, pSrcPos, pDestPos, numRemaining);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void)
+    {
+        static OptimisedUtilAVX2 msOptimisedUtilAVX2;
+        return &msOptimisedUtilAVX2;
+    }
+
+}
+
+#endif // __OGRE_HAVE_AVX2
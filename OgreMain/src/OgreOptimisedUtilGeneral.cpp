@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreVector3.h"
 #include "OgreMatrix4.h"
+#include "OgreQuaternion.h"
 
 namespace Ogre {
 
@@ -94,6 +95,25 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateNodeTransforms
+        virtual void concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes);
+
+        /// @copydoc OptimisedUtil::calculateBoxVisibility
+        virtual void calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes);
     };
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -392,6 +412,79 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::concatenateNodeTransforms(
+        const float* const* localStreams,
+        float* const* derivedStreams,
+        const uint32* parentIndices,
+        const uint32* inheritOrientation,
+        const uint32* inheritScale,
+        size_t first,
+        size_t numNodes)
+    {
+        const float* const* l = localStreams;
+        float* const* d = derivedStreams;
+
+        for (size_t i = first; i < first + numNodes; ++i)
+        {
+            size_t p = parentIndices[i];
+
+            Quaternion parentOrientation(d[3][p], d[4][p], d[5][p], d[6][p]);
+            Vector3 parentScale(d[7][p], d[8][p], d[9][p]);
+
+            Quaternion orientation(l[3][i], l[4][i], l[5][i], l[6][i]);
+            if (inheritOrientation[i])
+                orientation = parentOrientation * orientation;
+
+            Vector3 scale(l[7][i], l[8][i], l[9][i]);
+            if (inheritScale[i])
+                scale = parentScale * scale;
+
+            Vector3 position = parentOrientation * (parentScale * Vector3(l[0][i], l[1][i], l[2][i]));
+
+            d[0][i] = position.x + d[0][p];
+            d[1][i] = position.y + d[1][p];
+            d[2][i] = position.z + d[2][p];
+            d[3][i] = orientation.w;
+            d[4][i] = orientation.x;
+            d[5][i] = orientation.y;
+            d[6][i] = orientation.z;
+            d[7][i] = scale.x;
+            d[8][i] = scale.y;
+            d[9][i] = scale.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::calculateBoxVisibility(
+        const float* planes,
+        size_t numPlanes,
+        const float* centres,
+        const float* halfSizes,
+        uint32* visibility,
+        size_t numBoxes)
+    {
+        std::fill(visibility, visibility + (numBoxes + 31) / 32, 0);
+
+        for (size_t i = 0; i < numBoxes; ++i, centres += 3, halfSizes += 3)
+        {
+            bool visible = true;
+            const float* plane = planes;
+            for (size_t j = 0; j < numPlanes; ++j, plane += 4)
+            {
+                // Distance of the centre against the largest distance of a corner
+                float dist = plane[0] * centres[0] + plane[1] * centres[1] + plane[2] * centres[2] + plane[3];
+                float maxAbsDist = Math::Abs(plane[0]) * halfSizes[0] + Math::Abs(plane[1]) * halfSizes[1] + Math::Abs(plane[2]) * halfSizes[2];
+                if (dist < -maxAbsDist)
+                {
+                    visible = false;
+                    break;
+                }
+            }
+
+            if (visible)
+                visibility[i >> 5] |= uint32(1) << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilGeneral(void)
@@ -132,6 +132,25 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateNodeTransforms
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes);
+
+        /// @copydoc OptimisedUtil::calculateBoxVisibility
+        virtual void __OGRE_SIMD_ALIGN_ATTRIBUTE calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes);
     };
 
 #if defined(__OGRE_SIMD_ALIGN_STACK)
@@ -271,6 +290,48 @@ namespace Ogre {
                 destPositions,
                 numVertices);
         }
+
+        /// @copydoc OptimisedUtil::concatenateNodeTransforms
+        virtual void concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->concatenateNodeTransforms(
+                localStreams,
+                derivedStreams,
+                parentIndices,
+                inheritOrientation,
+                inheritScale,
+                first,
+                numNodes);
+        }
+
+        /// @copydoc OptimisedUtil::calculateBoxVisibility
+        virtual void calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->calculateBoxVisibility(
+                planes,
+                numPlanes,
+                centres,
+                halfSizes,
+                visibility,
+                numBoxes);
+        }
     };
 #endif  // !defined(__OGRE_SIMD_ALIGN_STACK)
 
@@ -1495,21 +1556,14 @@ namespace Ogre {
                 // This loads into [2,3]. [1] is unused
                 norm = _mm_loadh_pi(norm, (__m64*)(pNorm + 0));
                 
-                // Fill a 4-vec with vector length
-                // square
+                // Squared length, the elements are z 0 x y
                 __m128 tmp = _mm_mul_ps(norm, norm);
-                // Add - for this we want this effect:
-                // orig   3 | 2 | 1 | 0
-                // add1   0 | 0 | 0 | 2
-                // add2   2 | 3 | 0 | 3
-                // This way elements 0, 2 and 3 have the sum of all entries (except 1 which is unused)
-                
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(0,0,0,2)));
-                // Add final combination & sqrt 
-                // bottom 3 elements of l will have length, we don't care about 4
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2,3,0,3)));
+                // z+x y -- --
+                tmp = _mm_add_ps(tmp, _mm_movehl_ps(tmp, tmp));
+                // z+x+y in element 0
+                tmp = _mm_add_ss(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(1,1,1,1)));
                 // Then divide to normalise
-                norm = _mm_div_ps(norm, _mm_sqrt_ps(tmp));
+                norm = _mm_div_ps(norm, _mm_sqrt_ps(__MM_SELECT(tmp, 0)));
                 
                 // Store back in the same place
                 _mm_storeh_pi((__m64*)(pNorm + 0), norm);
@@ -2136,6 +2190,155 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilSSE::concatenateNodeTransforms(
+        const float* const* localStreams,
+        float* const* derivedStreams,
+        const uint32* parentIndices,
+        const uint32* inheritOrientation,
+        const uint32* inheritScale,
+        size_t first,
+        size_t numNodes)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert((first & 3) == 0);
+
+        const float* const* l = localStreams;
+        float* const* d = derivedStreams;
+        const __m128 two = _mm_set_ps1(2.0f);
+
+        for (size_t i = first; i < first + numNodes; i += 4)
+        {
+            const uint32* p = parentIndices + i;
+
+            // Gather the derived transforms of the parents
+            __m128 pqw = _mm_set_ps(d[3][p[3]], d[3][p[2]], d[3][p[1]], d[3][p[0]]);
+            __m128 pqx = _mm_set_ps(d[4][p[3]], d[4][p[2]], d[4][p[1]], d[4][p[0]]);
+            __m128 pqy = _mm_set_ps(d[5][p[3]], d[5][p[2]], d[5][p[1]], d[5][p[0]]);
+            __m128 pqz = _mm_set_ps(d[6][p[3]], d[6][p[2]], d[6][p[1]], d[6][p[0]]);
+            __m128 psx = _mm_set_ps(d[7][p[3]], d[7][p[2]], d[7][p[1]], d[7][p[0]]);
+            __m128 psy = _mm_set_ps(d[8][p[3]], d[8][p[2]], d[8][p[1]], d[8][p[0]]);
+            __m128 psz = _mm_set_ps(d[9][p[3]], d[9][p[2]], d[9][p[1]], d[9][p[0]]);
+
+            // Orientation: parentOrientation * orientation
+            __m128 qw = _mm_load_ps(l[3] + i);
+            __m128 qx = _mm_load_ps(l[4] + i);
+            __m128 qy = _mm_load_ps(l[5] + i);
+            __m128 qz = _mm_load_ps(l[6] + i);
+            __m128 mask = _mm_load_ps(reinterpret_cast<const float*>(inheritOrientation + i));
+            __m128 rw = _mm_sub_ps(_mm_mul_ps(pqw, qw), __MM_ACCUM3_PS(_mm_mul_ps(pqx, qx), _mm_mul_ps(pqy, qy), _mm_mul_ps(pqz, qz)));
+            __m128 rx = _mm_sub_ps(__MM_ACCUM3_PS(_mm_mul_ps(pqw, qx), _mm_mul_ps(pqx, qw), _mm_mul_ps(pqy, qz)), _mm_mul_ps(pqz, qy));
+            __m128 ry = _mm_sub_ps(__MM_ACCUM3_PS(_mm_mul_ps(pqw, qy), _mm_mul_ps(pqy, qw), _mm_mul_ps(pqz, qx)), _mm_mul_ps(pqx, qz));
+            __m128 rz = _mm_sub_ps(__MM_ACCUM3_PS(_mm_mul_ps(pqw, qz), _mm_mul_ps(pqz, qw), _mm_mul_ps(pqx, qy)), _mm_mul_ps(pqy, qx));
+            _mm_store_ps(d[3] + i, __MM_BLEND_PS(mask, rw, qw));
+            _mm_store_ps(d[4] + i, __MM_BLEND_PS(mask, rx, qx));
+            _mm_store_ps(d[5] + i, __MM_BLEND_PS(mask, ry, qy));
+            _mm_store_ps(d[6] + i, __MM_BLEND_PS(mask, rz, qz));
+
+            // Scale: parentScale * scale
+            __m128 sx = _mm_load_ps(l[7] + i);
+            __m128 sy = _mm_load_ps(l[8] + i);
+            __m128 sz = _mm_load_ps(l[9] + i);
+            mask = _mm_load_ps(reinterpret_cast<const float*>(inheritScale + i));
+            _mm_store_ps(d[7] + i, __MM_BLEND_PS(mask, _mm_mul_ps(psx, sx), sx));
+            _mm_store_ps(d[8] + i, __MM_BLEND_PS(mask, _mm_mul_ps(psy, sy), sy));
+            _mm_store_ps(d[9] + i, __MM_BLEND_PS(mask, _mm_mul_ps(psz, sz), sz));
+
+            // Position: parentOrientation * (parentScale * position) + parentPosition
+            __m128 vx = _mm_mul_ps(psx, _mm_load_ps(l[0] + i));
+            __m128 vy = _mm_mul_ps(psy, _mm_load_ps(l[1] + i));
+            __m128 vz = _mm_mul_ps(psz, _mm_load_ps(l[2] + i));
+            // uv = qvec x v, uuv = qvec x uv
+            __m128 uvx = _mm_sub_ps(_mm_mul_ps(pqy, vz), _mm_mul_ps(pqz, vy));
+            __m128 uvy = _mm_sub_ps(_mm_mul_ps(pqz, vx), _mm_mul_ps(pqx, vz));
+            __m128 uvz = _mm_sub_ps(_mm_mul_ps(pqx, vy), _mm_mul_ps(pqy, vx));
+            __m128 uuvx = _mm_sub_ps(_mm_mul_ps(pqy, uvz), _mm_mul_ps(pqz, uvy));
+            __m128 uuvy = _mm_sub_ps(_mm_mul_ps(pqz, uvx), _mm_mul_ps(pqx, uvz));
+            __m128 uuvz = _mm_sub_ps(_mm_mul_ps(pqx, uvy), _mm_mul_ps(pqy, uvx));
+            // v + uv * 2w + uuv * 2
+            __m128 w2 = _mm_mul_ps(pqw, two);
+            _mm_store_ps(d[0] + i, _mm_add_ps(
+                __MM_ACCUM3_PS(vx, _mm_mul_ps(uvx, w2), _mm_mul_ps(uuvx, two)),
+                _mm_set_ps(d[0][p[3]], d[0][p[2]], d[0][p[1]], d[0][p[0]])));
+            _mm_store_ps(d[1] + i, _mm_add_ps(
+                __MM_ACCUM3_PS(vy, _mm_mul_ps(uvy, w2), _mm_mul_ps(uuvy, two)),
+                _mm_set_ps(d[1][p[3]], d[1][p[2]], d[1][p[1]], d[1][p[0]])));
+            _mm_store_ps(d[2] + i, _mm_add_ps(
+                __MM_ACCUM3_PS(vz, _mm_mul_ps(uvz, w2), _mm_mul_ps(uuvz, two)),
+                _mm_set_ps(d[2][p[3]], d[2][p[2]], d[2][p[1]], d[2][p[0]])));
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::calculateBoxVisibility(
+        const float* planes,
+        size_t numPlanes,
+        const float* centres,
+        const float* halfSizes,
+        uint32* visibility,
+        size_t numBoxes)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        std::fill(visibility, visibility + (numBoxes + 31) / 32, 0);
+
+        const __m128 signMask = _mm_set_ps1(-0.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        // Four boxes at a time, each group lands in the same word
+        size_t numIterations = numBoxes / 4;
+        for (size_t i = 0; i < numIterations; ++i, centres += 12, halfSizes += 12)
+        {
+            __m128 cx = _mm_loadu_ps(centres + 0);
+            __m128 cy = _mm_loadu_ps(centres + 4);
+            __m128 cz = _mm_loadu_ps(centres + 8);
+            __MM_TRANSPOSE4x3_PS(cx, cy, cz);
+            __m128 hx = _mm_loadu_ps(halfSizes + 0);
+            __m128 hy = _mm_loadu_ps(halfSizes + 4);
+            __m128 hz = _mm_loadu_ps(halfSizes + 8);
+            __MM_TRANSPOSE4x3_PS(hx, hy, hz);
+
+            __m128 culled = zero;
+            const float* plane = planes;
+            for (size_t j = 0; j < numPlanes; ++j, plane += 4)
+            {
+                __m128 nx = _mm_load_ps1(plane + 0);
+                __m128 ny = _mm_load_ps1(plane + 1);
+                __m128 nz = _mm_load_ps1(plane + 2);
+                __m128 d = _mm_load_ps1(plane + 3);
+
+                // Distance of the centre against the largest distance of a corner
+                __m128 dist = _mm_add_ps(__MM_DOT3x3_PS(nx, ny, nz, cx, cy, cz), d);
+                __m128 maxAbsDist = __MM_DOT3x3_PS(
+                    _mm_andnot_ps(signMask, nx), _mm_andnot_ps(signMask, ny), _mm_andnot_ps(signMask, nz),
+                    hx, hy, hz);
+                culled = _mm_or_ps(culled, _mm_cmplt_ps(dist, _mm_sub_ps(zero, maxAbsDist)));
+            }
+
+            uint32 mask = static_cast<uint32>(~_mm_movemask_ps(culled) & 0xF);
+            visibility[i >> 3] |= mask << ((i & 7) * 4);
+        }
+
+        // Left over boxes
+        for (size_t i = numIterations * 4; i < numBoxes; ++i, centres += 3, halfSizes += 3)
+        {
+            bool visible = true;
+            const float* plane = planes;
+            for (size_t j = 0; j < numPlanes; ++j, plane += 4)
+            {
+                float dist = plane[0] * centres[0] + plane[1] * centres[1] + plane[2] * centres[2] + plane[3];
+                float maxAbsDist = Math::Abs(plane[0]) * halfSizes[0] + Math::Abs(plane[1]) * halfSizes[1] + Math::Abs(plane[2]) * halfSizes[2];
+                if (dist < -maxAbsDist)
+                {
+                    visible = false;
+                    break;
+                }
+            }
+
+            if (visible)
+                visibility[i >> 5] |= uint32(1) << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilSSE(void)
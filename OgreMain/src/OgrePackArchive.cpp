@@ -0,0 +1,757 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgrePackArchive.h"
+#include "OgreException.h"
+#include "OgreLZ4.h"
+
+#include <sys/stat.h>
+
+namespace Ogre {
+
+    namespace {
+        const uint32 PACK_MAGIC = 0x4B41504F; // "OPAK"
+        const uint32 PACK_VERSION = 1;
+        const size_t HEADER_SIZE = 16;
+        const size_t TRAILER_SIZE = 16;
+        /// Set on the compressed size of chunks stored as they are
+        const uint32 CHUNK_STORED = 0x80000000;
+
+        /// Stored in the index for base names shared by several files
+        const size_t AMBIGUOUS_ENTRY = size_t(-1);
+
+        /// Packs are little endian, regardless of the platform
+        uint16 readUint16(const uchar* p)
+        {
+            return uint16(p[0] | (p[1] << 8));
+        }
+
+        uint32 readUint32(const uchar* p)
+        {
+            return uint32(p[0]) | (uint32(p[1]) << 8) | (uint32(p[2]) << 16) | (uint32(p[3]) << 24);
+        }
+
+        uint64 readUint64(const uchar* p)
+        {
+            return uint64(readUint32(p)) | (uint64(readUint32(p + 4)) << 32);
+        }
+
+        void writeUint16(vector<uchar>::type& buffer, uint16 v)
+        {
+            buffer.push_back(uchar(v));
+            buffer.push_back(uchar(v >> 8));
+        }
+
+        void writeUint32(vector<uchar>::type& buffer, uint32 v)
+        {
+            for (int i = 0; i < 4; ++i)
+                buffer.push_back(uchar(v >> (i * 8)));
+        }
+
+        void writeUint64(vector<uchar>::type& buffer, uint64 v)
+        {
+            writeUint32(buffer, uint32(v));
+            writeUint32(buffer, uint32(v >> 32));
+        }
+
+        size_t getNumChunks(size_t size, uint32 chunkSize)
+        {
+            return (size + chunkSize - 1) / chunkSize;
+        }
+
+        String toLookupName(const String& filename)
+        {
+            String name = filename;
+#if !OGRE_RESOURCEMANAGER_STRICT
+            StringUtil::toLowerCase(name);
+#endif
+            return name;
+        }
+
+        /** Stream over a file in a pack, which decompresses chunks as they
+            are read.
+        */
+        class PackDataStream : public DataStream
+        {
+        public:
+            /**
+            @param source Keeps data alive, the mapped pack or the file's chunks
+            @param data The file's first chunk
+            @param chunkSizes The compressed size of each chunk
+            */
+            PackDataStream(const String& name, const DataStreamPtr& source, const uchar* data,
+                           size_t size, uint32 chunkSize, const uint32* chunkSizes)
+                : DataStream(name)
+                , mSource(source)
+                , mData(data)
+                , mChunkSize(chunkSize)
+                , mPos(0)
+                , mDecodedChunk(size_t(-1))
+            {
+                mSize = size;
+                size_t numChunks = getNumChunks(size, chunkSize);
+                mChunks.resize(numChunks);
+                size_t offset = 0;
+                for (size_t i = 0; i < numChunks; ++i)
+                {
+                    mChunks[i].offset = offset;
+                    mChunks[i].size = chunkSizes[i] & ~CHUNK_STORED;
+                    mChunks[i].stored = (chunkSizes[i] & CHUNK_STORED) != 0;
+                    offset += mChunks[i].size;
+                }
+            }
+
+            ~PackDataStream()
+            {
+                close();
+            }
+
+            size_t read(void* buf, size_t count)
+            {
+                uchar* dst = static_cast<uchar*>(buf);
+                count = std::min(count, mSize - mPos);
+                size_t remaining = count;
+                while (remaining)
+                {
+                    size_t chunk = mPos / mChunkSize;
+                    size_t offset = mPos % mChunkSize;
+                    size_t chunkLength = std::min(size_t(mChunkSize), mSize - chunk * mChunkSize);
+                    size_t n = std::min(remaining, chunkLength - offset);
+
+                    if (n == chunkLength && chunk != mDecodedChunk)
+                        decode(chunk, dst, chunkLength);
+                    else
+                        memcpy(dst, getChunk(chunk, chunkLength) + offset, n);
+
+                    dst += n;
+                    mPos += n;
+                    remaining -= n;
+                }
+                return count;
+            }
+
+            size_t write(const void* buf, size_t count)
+            {
+                // not supported
+                return 0;
+            }
+
+            void skip(long count)
+            {
+                if (count < 0 && size_t(-count) > mPos)
+                    mPos = 0;
+                else
+                    mPos = std::min(mPos + count, mSize);
+            }
+
+            void seek(size_t pos)
+            {
+                mPos = std::min(pos, mSize);
+            }
+
+            size_t tell(void) const
+            {
+                return mPos;
+            }
+
+            bool eof(void) const
+            {
+                return mPos >= mSize;
+            }
+
+            void close(void)
+            {
+                mSource.reset();
+                mData = 0;
+                mBuffer.clear();
+            }
+
+        private:
+            struct Chunk
+            {
+                size_t offset;
+                size_t size;
+                bool stored;
+            };
+
+            DataStreamPtr mSource;
+            const uchar* mData;
+            uint32 mChunkSize;
+            vector<Chunk>::type mChunks;
+            size_t mPos;
+            /// The chunk in mBuffer
+            size_t mDecodedChunk;
+            vector<uchar>::type mBuffer;
+
+            /// Returns the data of a chunk, decompressing it into mBuffer if needed
+            const uchar* getChunk(size_t chunk, size_t length)
+            {
+                const Chunk& c = mChunks[chunk];
+                if (c.stored && c.size == length)
+                    return mData + c.offset;
+                if (chunk != mDecodedChunk)
+                {
+                    mBuffer.resize(mChunkSize);
+                    // Reset first, in case decode throws
+                    mDecodedChunk = size_t(-1);
+                    decode(chunk, &mBuffer[0], length);
+                    mDecodedChunk = chunk;
+                }
+                return &mBuffer[0];
+            }
+
+            void decode(size_t chunk, uchar* dst, size_t length)
+            {
+                const Chunk& c = mChunks[chunk];
+                bool ok;
+                if (c.stored)
+                {
+                    ok = c.size == length;
+                    if (ok)
+                        memcpy(dst, mData + c.offset, length);
+                }
+                else
+                {
+                    ok = LZ4::decompress(mData + c.offset, c.size, dst, length);
+                }
+
+                if (!ok)
+                {
+                    OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                        mName + " - corrupted chunk " + StringConverter::toString(chunk),
+                        "PackDataStream::read");
+                }
+            }
+        };
+    }
+    //-----------------------------------------------------------------------
+    PackArchive::PackArchive(const String& name, const String& archType)
+        : Archive(name, archType), mMappedData(0), mChunkSize(0)
+    {
+    }
+    //-----------------------------------------------------------------------
+    PackArchive::~PackArchive()
+    {
+        unload();
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::load()
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        if (!mFile)
+        {
+            try
+            {
+                readIndex();
+                buildIndex();
+            }
+            catch (...)
+            {
+                unload();
+                throw;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::unload()
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        // Open streams keep their own reference to the data
+        mFile.reset();
+        mMappedData = 0;
+        mFileList.clear();
+        mEntries.clear();
+        mChunkSizes.clear();
+        mIndex.clear();
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::readIndex(void)
+    {
+        if (MappedFileDataStream::isSupported())
+        {
+            MappedFileDataStream* mapped = OGRE_NEW MappedFileDataStream(mName, mName);
+            mFile = DataStreamPtr(mapped);
+            mMappedData = mapped->getPtr();
+        }
+        else
+        {
+            std::ifstream* stream = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)();
+            stream->open(mName.c_str(), std::ios::in | std::ios::binary);
+            if (stream->fail())
+            {
+                OGRE_DELETE_T(stream, basic_ifstream, MEMCATEGORY_GENERAL);
+                OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                    "Cannot open file: " + mName,
+                    "PackArchive::load");
+            }
+            mFile = DataStreamPtr(OGRE_NEW FileStreamDataStream(mName, stream, true));
+        }
+
+        size_t size = mFile->size();
+        uchar header[HEADER_SIZE];
+        uchar trailer[TRAILER_SIZE];
+        if (size < HEADER_SIZE + TRAILER_SIZE || mFile->read(header, HEADER_SIZE) != HEADER_SIZE)
+            corrupted();
+        mFile->seek(size - TRAILER_SIZE);
+        if (mFile->read(trailer, TRAILER_SIZE) != TRAILER_SIZE)
+            corrupted();
+
+        if (readUint32(header) != PACK_MAGIC || readUint32(trailer + 12) != PACK_MAGIC)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                mName + " is not a pack",
+                "PackArchive::load");
+        }
+        if (readUint32(header + 4) != PACK_VERSION)
+        {
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                mName + " has unsupported version " + StringConverter::toString(readUint32(header + 4)),
+                "PackArchive::load");
+        }
+        mChunkSize = readUint32(header + 8);
+
+        uint64 indexOffset = readUint64(trailer);
+        size_t indexSize = readUint32(trailer + 8);
+        if (mChunkSize == 0 || (mChunkSize & CHUNK_STORED) || indexOffset < HEADER_SIZE ||
+            indexOffset > size - TRAILER_SIZE || indexSize != size - TRAILER_SIZE - indexOffset)
+            corrupted();
+
+        vector<uchar>::type index(indexSize);
+        mFile->seek(size_t(indexOffset));
+        if (indexSize < 4 || mFile->read(&index[0], indexSize) != indexSize)
+            corrupted();
+
+        const uchar* p = &index[0];
+        const uchar* end = p + indexSize;
+        uint32 numFiles = readUint32(p);
+        p += 4;
+
+        set<String>::type directories;
+        for (uint32 i = 0; i < numFiles; ++i)
+        {
+            if (end - p < 2)
+                corrupted();
+            size_t nameLength = readUint16(p);
+            p += 2;
+            if (size_t(end - p) < nameLength + 16)
+                corrupted();
+            String filename(reinterpret_cast<const char*>(p), nameLength);
+            p += nameLength;
+            uint64 uncompressedSize = readUint64(p);
+            Entry entry;
+            entry.dataOffset = readUint64(p + 8);
+            p += 16;
+
+            // Every chunk takes 4 bytes of the index, which also bounds the
+            // size before it's rounded up to whole chunks
+            uint64 numChunks = uncompressedSize / mChunkSize + (uncompressedSize % mChunkSize != 0);
+            if (uint64(end - p) / 4 < numChunks || uncompressedSize > uint64(size_t(-1)))
+                corrupted();
+            entry.firstChunk = mChunkSizes.size();
+            uint64 compressedSize = 0;
+            for (size_t c = 0; c < numChunks; ++c, p += 4)
+            {
+                // Stored chunks are their exact length, compressed ones can't
+                // be empty nor larger than compressing them could make them
+                uint32 chunkSize = readUint32(p);
+                uint32 length = c + 1 < numChunks ? mChunkSize : uint32(uncompressedSize - c * uint64(mChunkSize));
+                uint32 storedSize = chunkSize & ~CHUNK_STORED;
+                if ((chunkSize & CHUNK_STORED) ? storedSize != length :
+                    storedSize == 0 || storedSize > LZ4::compressBound(length))
+                    corrupted();
+                mChunkSizes.push_back(chunkSize);
+                compressedSize += storedSize;
+            }
+            if (entry.dataOffset < HEADER_SIZE || entry.dataOffset > indexOffset ||
+                compressedSize > indexOffset - entry.dataOffset)
+                corrupted();
+            entry.compressedSize = size_t(compressedSize);
+
+            addFileInfo(filename, size_t(uncompressedSize), entry, directories);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::addFileInfo(const String& filename, size_t uncompressedSize,
+                                  const Entry& entry, set<String>::type& directories)
+    {
+        FileInfo info;
+        info.archive = this;
+        StringUtil::splitFilename(filename, info.basename, info.path);
+
+        // The directories aren't stored, list them when first used
+        if (!info.path.empty() && directories.insert(info.path).second)
+        {
+            // Same as ZipArchive, nobody checks the compressed size of a folder
+            Entry dir = { 0, size_t(-1), 0 };
+            addFileInfo(info.path.substr(0, info.path.length() - 1), 0, dir, directories);
+        }
+
+        info.filename = filename;
+#if !OGRE_RESOURCEMANAGER_STRICT
+        if (entry.compressedSize != size_t(-1))
+            info.filename = info.basename;
+#endif
+        info.compressedSize = entry.compressedSize;
+        info.uncompressedSize = uncompressedSize;
+        mFileList.push_back(info);
+        mEntries.push_back(entry);
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::buildIndex(void)
+    {
+        // Full paths first, they win over base names
+        for (size_t i = 0; i < mFileList.size(); ++i)
+        {
+            const FileInfo& info = mFileList[i];
+            mIndex.insert(EntryIndex::value_type(toLookupName(info.path + info.basename), i));
+        }
+#if !OGRE_RESOURCEMANAGER_STRICT
+        // Files can be opened by their base name, as long as it is unique
+        for (size_t i = 0; i < mFileList.size(); ++i)
+        {
+            const FileInfo& info = mFileList[i];
+            if (info.path.empty())
+                continue;
+
+            std::pair<EntryIndex::iterator, bool> inserted =
+                mIndex.insert(EntryIndex::value_type(toLookupName(info.basename), i));
+            if (!inserted.second && inserted.first->second != AMBIGUOUS_ENTRY &&
+                !mFileList[inserted.first->second].path.empty())
+            {
+                inserted.first->second = AMBIGUOUS_ENTRY;
+            }
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------
+    bool PackArchive::findEntry(const String& filename, size_t& index) const
+    {
+        EntryIndex::const_iterator i = mIndex.find(toLookupName(filename));
+#if !OGRE_RESOURCEMANAGER_STRICT
+        if (i == mIndex.end())
+        {
+            // Try if we find the file by its name alone
+            String basename, path;
+            StringUtil::splitFilename(filename, basename, path);
+            i = mIndex.find(toLookupName(basename));
+        }
+#endif
+        if (i == mIndex.end())
+            return false;
+        index = i->second;
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr PackArchive::open(const String& filename, bool readOnly) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        size_t index;
+        if (!findEntry(filename, index) || index == AMBIGUOUS_ENTRY ||
+            mFileList[index].compressedSize == size_t(-1))
+        {
+            // If there are more files with the same name do not open any
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                mName + " Cannot open file: " + filename + " - File not in pack.",
+                "PackArchive::open");
+        }
+
+        const FileInfo& info = mFileList[index];
+        const Entry& entry = mEntries[index];
+        String name = info.path + info.basename;
+        const uint32* chunkSizes = mChunkSizes.empty() ? 0 : &mChunkSizes[entry.firstChunk];
+
+        if (mMappedData)
+        {
+            return DataStreamPtr(OGRE_NEW PackDataStream(name, mFile,
+                mMappedData + entry.dataOffset, info.uncompressedSize, mChunkSize, chunkSizes));
+        }
+
+        // Read all of the file's chunks, they are small compared to the file
+        MemoryDataStream* chunks = OGRE_NEW MemoryDataStream(entry.compressedSize, true, true);
+        DataStreamPtr source(chunks);
+        mFile->seek(size_t(entry.dataOffset));
+        if (mFile->read(chunks->getPtr(), entry.compressedSize) != entry.compressedSize)
+            corrupted();
+        return DataStreamPtr(OGRE_NEW PackDataStream(name, source,
+            chunks->getPtr(), info.uncompressedSize, mChunkSize, chunkSizes));
+    }
+    //---------------------------------------------------------------------
+    DataStreamPtr PackArchive::create(const String& filename)
+    {
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+            "Modification of packs is not supported, use PackArchiveWriter",
+            "PackArchive::create");
+    }
+    //---------------------------------------------------------------------
+    void PackArchive::remove(const String& filename)
+    {
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+            "Modification of packs is not supported, use PackArchiveWriter",
+            "PackArchive::remove");
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr PackArchive::list(bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || i->path.empty()))
+                ret->push_back(i->filename);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr PackArchive::listFileInfo(bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        FileInfoList* fil = OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)();
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || i->path.empty()))
+                fil->push_back(*i);
+
+        return FileInfoListPtr(fil, SPFM_DELETE_T);
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr PackArchive::find(const String& pattern, bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        // If pattern contains a directory name, do a full match
+        bool full_match = (pattern.find ('/') != String::npos) ||
+                          (pattern.find ('\\') != String::npos);
+        bool wildCard = pattern.find("*") != String::npos;
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || full_match || wildCard))
+                // Check basename matches pattern (case insensitive, like zip)
+                if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+                    ret->push_back(i->filename);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr PackArchive::findFileInfo(const String& pattern,
+        bool recursive, bool dirs) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        FileInfoListPtr ret = FileInfoListPtr(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        // If pattern contains a directory name, do a full match
+        bool full_match = (pattern.find ('/') != String::npos) ||
+                          (pattern.find ('\\') != String::npos);
+        bool wildCard = pattern.find("*") != String::npos;
+
+        FileInfoList::const_iterator i, iend;
+        iend = mFileList.end();
+        for (i = mFileList.begin(); i != iend; ++i)
+            if ((dirs == (i->compressedSize == size_t (-1))) &&
+                (recursive || full_match || wildCard))
+                // Check name matches pattern (case insensitive, like zip)
+                if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+                    ret->push_back(*i);
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    bool PackArchive::exists(const String& filename) const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        size_t index;
+        return findEntry(filename, index);
+    }
+    //---------------------------------------------------------------------
+    time_t PackArchive::getModifiedTime(const String& filename) const
+    {
+        // The mod time of the pack itself
+        struct stat tagStat;
+        if (stat(mName.c_str(), &tagStat) == 0)
+            return tagStat.st_mtime;
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::corrupted(void) const
+    {
+        OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+            mName + " - error whilst reading pack: Corrupted pack.",
+            "PackArchive::corrupted");
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //  PackArchiveFactory
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    const String& PackArchiveFactory::getType(void) const
+    {
+        static String name = "Pack";
+        return name;
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //  PackArchiveWriter
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    PackArchiveWriter::PackArchiveWriter(const DataStreamPtr& stream, uint32 chunkSize)
+        : mStream(stream)
+        , mChunkSize(chunkSize)
+        , mOffset(0)
+        , mUncompressedSize(0)
+        , mNumFiles(0)
+        , mFinished(false)
+    {
+        if (mChunkSize == 0 || (mChunkSize & CHUNK_STORED))
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Invalid chunk size " + StringConverter::toString(mChunkSize),
+                "PackArchiveWriter::PackArchiveWriter");
+        }
+
+        vector<uchar>::type header;
+        writeUint32(header, PACK_MAGIC);
+        writeUint32(header, PACK_VERSION);
+        writeUint32(header, mChunkSize);
+        writeUint32(header, 0);
+        write(&header[0], header.size());
+
+        // Reserve room for the file count
+        writeUint32(mIndex, 0);
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::addFile(const String& filename, const DataStreamPtr& data)
+    {
+        if (mFinished)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+                "The pack is already finished",
+                "PackArchiveWriter::addFile");
+        }
+
+        String name = filename;
+        std::replace(name.begin(), name.end(), '\\', '/');
+        if (name.length() > 0xffff)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "File name too long: " + name,
+                "PackArchiveWriter::addFile");
+        }
+
+        uint64 dataOffset = mOffset;
+        vector<uint32>::type chunkSizes;
+        vector<uchar>::type chunk(mChunkSize);
+        vector<uchar>::type compressed(LZ4::compressBound(mChunkSize));
+        uint64 size = 0;
+        for (;;)
+        {
+            // Fill whole chunks, streams can return less than asked for
+            size_t length = 0;
+            while (length < mChunkSize)
+            {
+                size_t n = data->read(&chunk[length], mChunkSize - length);
+                if (n == 0)
+                    break;
+                length += n;
+            }
+            if (length == 0)
+                break;
+
+            size_t compressedLength = LZ4::compress(&chunk[0], length, &compressed[0]);
+            if (compressedLength < length)
+            {
+                write(&compressed[0], compressedLength);
+                chunkSizes.push_back(uint32(compressedLength));
+            }
+            else
+            {
+                write(&chunk[0], length);
+                chunkSizes.push_back(uint32(length) | CHUNK_STORED);
+            }
+            size += length;
+            if (length < mChunkSize)
+                break;
+        }
+
+        writeUint16(mIndex, uint16(name.length()));
+        mIndex.insert(mIndex.end(), name.begin(), name.end());
+        writeUint64(mIndex, size);
+        writeUint64(mIndex, dataOffset);
+        for (size_t i = 0; i < chunkSizes.size(); ++i)
+            writeUint32(mIndex, chunkSizes[i]);
+
+        ++mNumFiles;
+        mUncompressedSize += size;
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::addArchive(Archive* archive)
+    {
+        FileInfoListPtr files = archive->listFileInfo(true, false);
+        for (FileInfoList::const_iterator i = files->begin(); i != files->end(); ++i)
+        {
+            String filename = i->path + i->basename;
+            addFile(filename, archive->open(filename));
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::finish(void)
+    {
+        if (mFinished)
+            return;
+        mFinished = true;
+
+        // Fill in the file count
+        for (int i = 0; i < 4; ++i)
+            mIndex[i] = uchar(mNumFiles >> (i * 8));
+
+        uint64 indexOffset = mOffset;
+        write(&mIndex[0], mIndex.size());
+
+        vector<uchar>::type trailer;
+        writeUint64(trailer, indexOffset);
+        writeUint32(trailer, uint32(mIndex.size()));
+        writeUint32(trailer, PACK_MAGIC);
+        write(&trailer[0], trailer.size());
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::write(const void* data, size_t size)
+    {
+        if (mStream->write(data, size) != size)
+        {
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                "Cannot write to " + mStream->getName(),
+                "PackArchiveWriter::write");
+        }
+        mOffset += size;
+    }
+}
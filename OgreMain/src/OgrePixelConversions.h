@@ -86,12 +86,6 @@ template <typename T, typename U, int id> struct PixelConverter {
 };
 
 
-/** Type for PF_R8G8B8/PF_B8G8R8 */
-struct Col3b {
-    Col3b(unsigned int a, unsigned int b, unsigned int c): 
-        x((Ogre::uint8)a), y((Ogre::uint8)b), z((Ogre::uint8)c) { }
-    Ogre::uint8 x,y,z;
-};
 /** Type for PF_FLOAT32_RGB */
 struct Col3f {
     Col3f(float inR, float inG, float inB):
@@ -105,279 +99,611 @@ struct Col4f {
     float r,g,b,a;
 };
 
-struct A8R8G8B8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_A8B8G8R8)>
+struct L8toL16: public PixelConverter <Ogre::uint8, Ogre::uint16, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_L16)>
 {
     inline static DstType pixelConvert(SrcType inp)
     {
-        return ((inp&0x000000FF)<<16)|(inp&0xFF00FF00)|((inp&0x00FF0000)>>16);
+        return (Ogre::uint16)((((unsigned int)inp)<<8)|(((unsigned int)inp)));
     }
 };
 
-struct A8R8G8B8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_B8G8R8A8)>
+struct L16toL8: public PixelConverter <Ogre::uint16, Ogre::uint8, FMTCONVERTERID(Ogre::PF_L16, Ogre::PF_L8)>
 {
     inline static DstType pixelConvert(SrcType inp)
     {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
+        return (Ogre::uint8)(inp>>8);
     }
 };
 
-struct A8R8G8B8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_R8G8B8A8)>
+/** Conversions between formats made of whole 8 bit, 16 bit float and 32 bit
+    float channels, driven by a table of where each format keeps its channels.
+@remarks
+    The results are exactly those of unpacking to floats and packing again,
+    only cheaper: 8 bit channels are moved as bytes, widened through lookup
+    tables or narrowed with SSE2, a row at a time. Colour channels missing
+    from the source convert to 0, a missing alpha to 1.
+*/
+enum ChannelType
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x00FFFFFF)<<8)|((inp&0xFF000000)>>24);
-    }
+    CT_NONE,
+    CT_BYTE,
+    CT_HALF,
+    CT_FLOAT
 };
 
-struct A8B8G8R8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_A8R8G8B8)>
+struct PixelLayout
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<16)|(inp&0xFF00FF00)|((inp&0x00FF0000)>>16);
-    }
+    ChannelType type;
+    size_t size;
+    /// Offsets of R, G, B and A as unpackColour reads them, -1 if missing
+    int read[4];
+    /// Offsets of R, G, B and A as packColour writes them, -1 if dropped
+    int write[4];
 };
 
-struct A8B8G8R8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_B8G8R8A8)>
+/** Moves the bytes of pixels of up to 4 bytes around, a whole pixel at a time
+    as a 32 bit word which is shifted and masked.
+*/
+struct WordShuffle
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x00FFFFFF)<<8)|((inp&0xFF000000)>>24);
-    }
+    size_t srcSize;
+    size_t dstSize;
+    /// Destination bytes that don't come from the source
+    Ogre::uint32 constant;
+    size_t numTerms;
+    unsigned int left[4];
+    unsigned int right[4];
+    Ogre::uint32 mask[4];
 };
 
-struct A8B8G8R8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_R8G8B8A8)>
+/// The bit where a byte at the given offset ends up when loaded as a word
+inline unsigned int wordBitOf(int offset)
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+    return 24 - 8 * offset;
+#else
+    return 8 * offset;
+#endif
+}
 
-struct B8G8R8A8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8R8G8B8)>
+/** Sets up the shuffle from a layout's read offsets to another layout's
+    write offsets, both of bytes.
+*/
+void initWordShuffle(WordShuffle& s, const PixelLayout& src, const PixelLayout& dst)
 {
-    inline static DstType pixelConvert(SrcType inp)
+    s.srcSize = src.size;
+    s.dstSize = dst.size;
+    s.constant = 0;
+    s.numTerms = 0;
+    for (int d = 0; d < (int)dst.size; ++d)
     {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
+        int from = -1;
+        Ogre::uint32 value = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            if (dst.write[c] != d)
+                continue;
+            if (src.read[c] < 0)
+                value = c == 3 ? 0xFF : 0;
+            else
+                from = src.read[c];
+        }
+
+        if (from < 0)
+        {
+            s.constant |= value << wordBitOf(d);
+            continue;
+        }
+        // Bytes moving by the same amount share a term
+        int shift = (int)wordBitOf(d) - (int)wordBitOf(from);
+        unsigned int left = shift > 0 ? shift : 0;
+        unsigned int right = shift < 0 ? -shift : 0;
+        size_t t = 0;
+        while (t < s.numTerms && (s.left[t] != left || s.right[t] != right))
+            ++t;
+        if (t == s.numTerms)
+        {
+            s.left[t] = left;
+            s.right[t] = right;
+            s.mask[t] = 0;
+            ++s.numTerms;
+        }
+        s.mask[t] |= (Ogre::uint32)0xFF << wordBitOf(d);
     }
-};
+}
 
-struct B8G8R8A8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8B8G8R8)>
+inline Ogre::uint32 shuffleWord(const WordShuffle& s, Ogre::uint32 word)
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0xFFFFFF00)>>8);
-    }
-};
+    Ogre::uint32 result = s.constant;
+    for (size_t t = 0; t < s.numTerms; ++t)
+        result |= ((word << s.left[t]) >> s.right[t]) & s.mask[t];
+    return result;
+}
 
-struct B8G8R8A8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF00)<<16)|(inp&0x00FF00FF)|((inp&0xFF000000)>>16);
-    }
-};
+/// Reads a pixel of S bytes into a word, as if the memory was read as a whole
+template <size_t S>
+inline Ogre::uint32 readWord(const Ogre::uint8* src)
+{
+    Ogre::uint32 word = (Ogre::uint32)src[0] << wordBitOf(0);
+    if (S > 1)
+        word |= (Ogre::uint32)src[1] << wordBitOf(1);
+    if (S > 2)
+        word |= (Ogre::uint32)src[2] << wordBitOf(2);
+    if (S > 3)
+        word |= (Ogre::uint32)src[3] << wordBitOf(3);
+    return word;
+}
 
-struct R8G8B8A8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8R8G8B8)>
+template <size_t D>
+inline void writeWord(Ogre::uint8* dst, Ogre::uint32 word)
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0xFFFFFF00)>>8);
-    }
-};
+    dst[0] = (Ogre::uint8)(word >> wordBitOf(0));
+    if (D > 1)
+        dst[1] = (Ogre::uint8)(word >> wordBitOf(1));
+    if (D > 2)
+        dst[2] = (Ogre::uint8)(word >> wordBitOf(2));
+    if (D > 3)
+        dst[3] = (Ogre::uint8)(word >> wordBitOf(3));
+}
 
-struct R8G8B8A8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8B8G8R8)>
+/** Shuffles a row of S byte pixels into D byte pixels.
+@remarks
+    Only the bytes of each pixel are read and written, which keeps in place
+    conversions between formats of the same size working.
+*/
+template <size_t S, size_t D>
+void shuffleRow(const WordShuffle& s, const Ogre::uint8* src, Ogre::uint8* dst, size_t count)
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
+    for (size_t i = 0; i < count; ++i, src += S, dst += D)
+        writeWord<D>(dst, shuffleWord(s, readWord<S>(src)));
+}
 
-struct R8G8B8A8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF00)<<16)|(inp&0x00FF00FF)|((inp&0xFF000000)>>16);
-    }
-};
+typedef void (*ShuffleRowFunc)(const WordShuffle& s, const Ogre::uint8* src, Ogre::uint8* dst, size_t count);
 
-struct A8B8G8R8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_L8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return (Ogre::uint8)(inp&0x000000FF);
-    }
-};
+#if __OGRE_HAVE_SSE
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG
+#define __OGRE_SSE2_TARGET  __attribute__((target("sse2")))
+#else
+#define __OGRE_SSE2_TARGET
+#endif
 
-struct L8toA8B8G8R8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return 0xFF000000|(((unsigned int)inp)<<0)|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16);
-    }
-};
+/** Loads 4 pixels of S bytes into the lanes of a register, as readWord
+    does. Pixels of 3 bytes are loaded 16 bytes at a time, so 6 of them must be
+    left to read.
+*/
+template <size_t S>
+inline __m128i __OGRE_SSE2_TARGET loadPixelsSSE2(const Ogre::uint8* src)
+{
+    const __m128i zero = _mm_setzero_si128();
+    if (S == 4)
+        return _mm_loadu_si128((const __m128i*)src);
+    if (S == 2)
+        return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)src), zero);
+    if (S == 1)
+    {
+        int bytes;
+        memcpy(&bytes, src, 4);
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    }
+
+    // Moves pixel n from byte 3n to byte 4n, the fourth byte of each lane
+    // isn't masked by any term
+    const __m128i lane0 = _mm_setr_epi32(-1, 0, 0, 0);
+    const __m128i lane1 = _mm_setr_epi32(0, -1, 0, 0);
+    const __m128i lane2 = _mm_setr_epi32(0, 0, -1, 0);
+    const __m128i lane3 = _mm_setr_epi32(0, 0, 0, -1);
+    __m128i bytes = _mm_loadu_si128((const __m128i*)src);
+    return _mm_or_si128(_mm_or_si128(_mm_and_si128(bytes, lane0), _mm_and_si128(_mm_slli_si128(bytes, 1), lane1)),
+                        _mm_or_si128(_mm_and_si128(_mm_slli_si128(bytes, 2), lane2), _mm_and_si128(_mm_slli_si128(bytes, 3), lane3)));
+}
 
-struct A8R8G8B8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_L8)>
+/// Stores the lanes of a register as 4 pixels of D bytes, as writeWord does
+template <size_t D>
+inline void __OGRE_SSE2_TARGET storePixelsSSE2(Ogre::uint8* dst, __m128i pixels)
 {
-    inline static DstType pixelConvert(SrcType inp)
+    if (D == 4)
     {
-        return (Ogre::uint8)((inp&0x00FF0000)>>16);
+        _mm_storeu_si128((__m128i*)dst, pixels);
     }
-};
-
-struct L8toA8R8G8B8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    else if (D == 3)
     {
-        return 0xFF000000|(((unsigned int)inp)<<0)|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16);
+        const __m128i lane0 = _mm_setr_epi32(0xFFFFFF, 0, 0, 0);
+        const __m128i lane1 = _mm_setr_epi32(0, 0xFFFFFF, 0, 0);
+        const __m128i lane2 = _mm_setr_epi32(0, 0, 0xFFFFFF, 0);
+        const __m128i lane3 = _mm_setr_epi32(0, 0, 0, 0xFFFFFF);
+        pixels = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(pixels, lane0), _mm_srli_si128(_mm_and_si128(pixels, lane1), 1)),
+            _mm_or_si128(_mm_srli_si128(_mm_and_si128(pixels, lane2), 2), _mm_srli_si128(_mm_and_si128(pixels, lane3), 3)));
+        _mm_storel_epi64((__m128i*)dst, pixels);
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(pixels, 8));
+        memcpy(dst + 8, &last, 4);
     }
-};
-
-struct B8G8R8A8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_L8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    else if (D == 2)
     {
-        return (Ogre::uint8)((inp&0x0000FF00)>>8);
+        pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+        pixels = _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storel_epi64((__m128i*)dst, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 1, 2, 0)));
     }
-};
-
-struct L8toB8G8R8A8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    else
     {
-        return 0x000000FF|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16)|(((unsigned int)inp)<<24);
+        // Only the lowest byte of each lane is set
+        int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(pixels, pixels), pixels));
+        memcpy(dst, &bytes, 4);
     }
-};
+}
 
-struct L8toL16: public PixelConverter <Ogre::uint8, Ogre::uint16, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_L16)>
+/// shuffleRow, 8 pixels at a time
+template <size_t S, size_t D>
+void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_SSE2_TARGET shuffleRowSSE2(
+    const WordShuffle& s, const Ogre::uint8* src, Ogre::uint8* dst, size_t count)
 {
-    inline static DstType pixelConvert(SrcType inp)
+    const __m128i constant = _mm_set1_epi32((int)s.constant);
+    __m128i left[4], right[4], mask[4];
+    for (size_t t = 0; t < s.numTerms; ++t)
     {
-        return (Ogre::uint16)((((unsigned int)inp)<<8)|(((unsigned int)inp)));
+        left[t] = _mm_cvtsi32_si128((int)s.left[t]);
+        right[t] = _mm_cvtsi32_si128((int)s.right[t]);
+        mask[t] = _mm_set1_epi32((int)s.mask[t]);
     }
-};
 
-struct L16toL8: public PixelConverter <Ogre::uint16, Ogre::uint8, FMTCONVERTERID(Ogre::PF_L16, Ogre::PF_L8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    const size_t margin = S == 3 ? 2 : 0;
+    size_t i = 0;
+    for (; i + 8 + margin <= count; i += 8, src += 8 * S, dst += 8 * D)
     {
-        return (Ogre::uint8)(inp>>8);
-    }
-};
+        __m128i word0 = loadPixelsSSE2<S>(src);
+        __m128i word1 = loadPixelsSSE2<S>(src + 4 * S);
+        __m128i result0 = constant;
+        __m128i result1 = constant;
+        for (size_t t = 0; t < s.numTerms; ++t)
+        {
+            __m128i moved0 = _mm_srl_epi32(_mm_sll_epi32(word0, left[t]), right[t]);
+            __m128i moved1 = _mm_srl_epi32(_mm_sll_epi32(word1, left[t]), right[t]);
+            result0 = _mm_or_si128(result0, _mm_and_si128(moved0, mask[t]));
+            result1 = _mm_or_si128(result1, _mm_and_si128(moved1, mask[t]));
+        }
+        storePixelsSSE2<D>(dst, result0);
+        storePixelsSSE2<D>(dst + 4 * D, result1);
+    }
+    shuffleRow<S, D>(s, src, dst, count - i);
+}
 
-struct R8G8B8toB8G8R8: public PixelConverter <Col3b, Col3b, FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_B8G8R8)>
-{
-    inline static DstType pixelConvert(const SrcType &inp)
-    {
-        return Col3b(inp.z, inp.y, inp.x);
-    }  
-};
+/// Bitwise::floatToFixed(x, 8) of 16 floats at a time
+void __OGRE_SIMD_ALIGN_ATTRIBUTE __OGRE_SSE2_TARGET floatsToBytesSSE2(
+    const float* src, Ogre::uint8* dst, size_t count)
+{
+    // Above 255 the truncation is clamped by the minimum, below 0 or NaN it
+    // saturates to 0 when packing
+    const __m128 scale = _mm_set1_ps(256.0f);
+    const __m128 maximum = _mm_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v0 = _mm_cvttps_epi32(_mm_min_ps(maximum, _mm_mul_ps(_mm_loadu_ps(src + i), scale)));
+        __m128i v1 = _mm_cvttps_epi32(_mm_min_ps(maximum, _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale)));
+        __m128i v2 = _mm_cvttps_epi32(_mm_min_ps(maximum, _mm_mul_ps(_mm_loadu_ps(src + i + 8), scale)));
+        __m128i v3 = _mm_cvttps_epi32(_mm_min_ps(maximum, _mm_mul_ps(_mm_loadu_ps(src + i + 12), scale)));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+    for (; i < count; ++i)
+        dst[i] = (Ogre::uint8)Ogre::Bitwise::floatToFixed(src[i], 8);
+}
+#endif
 
-struct B8G8R8toR8G8B8: public PixelConverter <Col3b, Col3b, FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_R8G8B8)>
-{
-    inline static DstType pixelConvert(const SrcType &inp)
-    {
-        return Col3b(inp.z, inp.y, inp.x);
-    }  
-};
+/// Pixels converted through the RGBA intermediates at a time
+const size_t CONVERSION_CHUNK_SIZE = 256;
 
-// X8Y8Z8 ->  X8<<xshift Y8<<yshift Z8<<zshift A8<<ashift
-template <int id, unsigned int xshift, unsigned int yshift, unsigned int zshift, unsigned int ashift> struct Col3btoUint32swizzler:
-    public PixelConverter <Col3b, Ogre::uint32, id>
+/// Builds the layouts once and picks the row converters for a pair
+class PixelConversionTable
 {
-    inline static Ogre::uint32 pixelConvert(const Col3b &inp)
+public:
+    PixelConversionTable()
     {
+        mIdentityBytes = true;
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            mByteToFloat[i] = Ogre::Bitwise::fixedToFloat(i, 8);
+            mByteToHalf[i] = Ogre::Bitwise::floatToHalf(mByteToFloat[i]);
+            if (Ogre::Bitwise::floatToFixed(mByteToFloat[i], 8) != i)
+                mIdentityBytes = false;
+        }
+
+        for (int i = 0; i < Ogre::PF_COUNT; ++i)
+            initLayout(mLayouts[i], (Ogre::PixelFormat)i);
+        setLayout(mRGBA8, CT_BYTE, 4, 0, 1, 2, 3);
+
+        mShuffleRows[0][0] = shuffleRow<1, 1>;
+        mShuffleRows[0][1] = shuffleRow<1, 2>;
+        mShuffleRows[0][2] = shuffleRow<1, 3>;
+        mShuffleRows[0][3] = shuffleRow<1, 4>;
+        mShuffleRows[1][0] = shuffleRow<2, 1>;
+        mShuffleRows[1][1] = shuffleRow<2, 2>;
+        mShuffleRows[1][2] = shuffleRow<2, 3>;
+        mShuffleRows[1][3] = shuffleRow<2, 4>;
+        mShuffleRows[2][0] = shuffleRow<3, 1>;
+        mShuffleRows[2][1] = shuffleRow<3, 2>;
+        mShuffleRows[2][2] = shuffleRow<3, 3>;
+        mShuffleRows[2][3] = shuffleRow<3, 4>;
+        mShuffleRows[3][0] = shuffleRow<4, 1>;
+        mShuffleRows[3][1] = shuffleRow<4, 2>;
+        mShuffleRows[3][2] = shuffleRow<4, 3>;
+        mShuffleRows[3][3] = shuffleRow<4, 4>;
+
+        mUseSSE2 = false;
+#if __OGRE_HAVE_SSE
+        if (Ogre::PlatformInformation::getCpuFeatures() & Ogre::PlatformInformation::CPU_FEATURE_SSE2)
+        {
+            mUseSSE2 = true;
+            mShuffleRows[0][0] = shuffleRowSSE2<1, 1>;
+            mShuffleRows[0][1] = shuffleRowSSE2<1, 2>;
+            mShuffleRows[0][2] = shuffleRowSSE2<1, 3>;
+            mShuffleRows[0][3] = shuffleRowSSE2<1, 4>;
+            mShuffleRows[1][0] = shuffleRowSSE2<2, 1>;
+            mShuffleRows[1][1] = shuffleRowSSE2<2, 2>;
+            mShuffleRows[1][2] = shuffleRowSSE2<2, 3>;
+            mShuffleRows[1][3] = shuffleRowSSE2<2, 4>;
+            mShuffleRows[2][0] = shuffleRowSSE2<3, 1>;
+            mShuffleRows[2][1] = shuffleRowSSE2<3, 2>;
+            mShuffleRows[2][2] = shuffleRowSSE2<3, 3>;
+            mShuffleRows[2][3] = shuffleRowSSE2<3, 4>;
+            mShuffleRows[3][0] = shuffleRowSSE2<4, 1>;
+            mShuffleRows[3][1] = shuffleRowSSE2<4, 2>;
+            mShuffleRows[3][2] = shuffleRowSSE2<4, 3>;
+            mShuffleRows[3][3] = shuffleRowSSE2<4, 4>;
+        }
+#endif
+    }
+
+    /// Converts the boxes if both formats are in the table
+    bool convert(const Ogre::PixelBox& src, const Ogre::PixelBox& dst) const
+    {
+        const PixelLayout& srcLayout = mLayouts[src.format];
+        const PixelLayout& dstLayout = mLayouts[dst.format];
+        if (srcLayout.type == CT_NONE || dstLayout.type == CT_NONE)
+            return false;
+        if (srcLayout.type == CT_BYTE && dstLayout.type == CT_BYTE && !mIdentityBytes)
+            return false;
+
+        WordShuffle shuffle;
+        if (srcLayout.type == CT_BYTE)
+            initWordShuffle(shuffle, srcLayout, dstLayout.type == CT_BYTE ? dstLayout : mRGBA8);
+        else if (dstLayout.type == CT_BYTE)
+            initWordShuffle(shuffle, mRGBA8, dstLayout);
+
+        Ogre::uint8* srcptr = static_cast<Ogre::uint8*>(src.data)
+            + (src.left + src.top * src.rowPitch + src.front * src.slicePitch) * srcLayout.size;
+        Ogre::uint8* dstptr = static_cast<Ogre::uint8*>(dst.data)
+            + (dst.left + dst.top * dst.rowPitch + dst.front * dst.slicePitch) * dstLayout.size;
+        const size_t width = src.getWidth();
+        for (size_t z = src.front; z < src.back; z++)
+        {
+            Ogre::uint8* srcRow = srcptr;
+            Ogre::uint8* dstRow = dstptr;
+            for (size_t y = src.top; y < src.bottom; y++)
+            {
+                for (size_t x = 0; x < width; x += CONVERSION_CHUNK_SIZE)
+                {
+                    size_t count = std::min(width - x, CONVERSION_CHUNK_SIZE);
+                    convertPixels(srcLayout, dstLayout, shuffle,
+                                  srcRow + x * srcLayout.size, dstRow + x * dstLayout.size, count);
+                }
+                srcRow += src.rowPitch * srcLayout.size;
+                dstRow += dst.rowPitch * dstLayout.size;
+            }
+            srcptr += src.slicePitch * srcLayout.size;
+            dstptr += dst.slicePitch * dstLayout.size;
+        }
+        return true;
+    }
+
+private:
+    PixelLayout mLayouts[Ogre::PF_COUNT];
+    /// The intermediate of conversions between bytes and floats
+    PixelLayout mRGBA8;
+    /// Indexed by the source and destination pixel size minus 1
+    ShuffleRowFunc mShuffleRows[4][4];
+    float mByteToFloat[256];
+    Ogre::uint16 mByteToHalf[256];
+    /// Whether bytes come back unchanged from floats, so they can be moved as they are
+    bool mIdentityBytes;
+    bool mUseSSE2;
+
+    static void setLayout(PixelLayout& layout, ChannelType type, size_t size, int r, int g, int b, int a)
+    {
+        layout.type = type;
+        layout.size = size;
+        layout.read[0] = layout.write[0] = r;
+        layout.read[1] = layout.write[1] = g;
+        layout.read[2] = layout.write[2] = b;
+        layout.read[3] = layout.write[3] = a;
+    }
+
+    /// The offset of a native endian channel, -2 if it isn't a whole byte
+    static int getByteOffset(const Ogre::PixelFormatDescription& des, unsigned char bits,
+                             Ogre::uint64 mask, unsigned char shift)
+    {
+        if (bits == 0)
+            return -1;
+        if (bits != 8 || shift % 8 != 0 || mask != ((Ogre::uint64)0xFF << shift))
+            return -2;
 #if OGRE_ENDIAN == OGRE_ENDIAN_BIG
-        return (0xFF<<ashift) | (((unsigned int)inp.x)<<xshift) | (((unsigned int)inp.y)<<yshift) | (((unsigned int)inp.z)<<zshift);
+        return des.elemBytes - 1 - shift / 8;
 #else
-        return (0xFF<<ashift) | (((unsigned int)inp.x)<<zshift) | (((unsigned int)inp.y)<<yshift) | (((unsigned int)inp.z)<<xshift);
+        return shift / 8;
 #endif
     }
-};
-
-struct R8G8B8toA8R8G8B8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8R8G8B8), 16, 8, 0, 24> { };
-struct B8G8R8toA8R8G8B8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8R8G8B8), 0, 8, 16, 24> { };
-struct R8G8B8toA8B8G8R8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8B8G8R8), 0, 8, 16, 24> { };
-struct B8G8R8toA8B8G8R8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8B8G8R8), 16, 8, 0, 24> { };
-struct R8G8B8toB8G8R8A8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_B8G8R8A8), 8, 16, 24, 0> { };
-struct B8G8R8toB8G8R8A8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_B8G8R8A8), 24, 16, 8, 0> { };
 
-struct A8R8G8B8toR8G8B8: public PixelConverter <Ogre::uint32, Col3b, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_BYTE_RGB)>
-{
-    inline static DstType pixelConvert(Ogre::uint32 inp)
-    {
-        return Col3b((Ogre::uint8)((inp>>16)&0xFF), (Ogre::uint8)((inp>>8)&0xFF), (Ogre::uint8)((inp>>0)&0xFF));
-    }
-};
-struct A8R8G8B8toB8G8R8: public PixelConverter <Ogre::uint32, Col3b, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_BYTE_BGR)>
-{
-    inline static DstType pixelConvert(Ogre::uint32 inp)
+    static void initLayout(PixelLayout& layout, Ogre::PixelFormat pf)
     {
-        return Col3b((Ogre::uint8)((inp>>0)&0xFF), (Ogre::uint8)((inp>>8)&0xFF), (Ogre::uint8)((inp>>16)&0xFF));
+        using namespace Ogre;
+        setLayout(layout, CT_NONE, 0, -1, -1, -1, -1);
+        switch (pf)
+        {
+        case PF_BYTE_LA:
+            setLayout(layout, CT_BYTE, 2, 0, -1, -1, 1);
+            layout.read[1] = layout.read[2] = 0;
+            return;
+        case PF_FLOAT16_R:
+            setLayout(layout, CT_HALF, 2, 0, -1, -1, -1);
+            layout.read[1] = layout.read[2] = 0;
+            return;
+        case PF_FLOAT16_GR:
+            setLayout(layout, CT_HALF, 4, 2, 0, -1, -1);
+            layout.read[2] = 2;
+            return;
+        case PF_FLOAT16_RGB:
+            setLayout(layout, CT_HALF, 6, 0, 2, 4, -1);
+            return;
+        case PF_FLOAT16_RGBA:
+            setLayout(layout, CT_HALF, 8, 0, 2, 4, 6);
+            return;
+        case PF_FLOAT32_R:
+            setLayout(layout, CT_FLOAT, 4, 0, -1, -1, -1);
+            layout.read[1] = layout.read[2] = 0;
+            return;
+        case PF_FLOAT32_GR:
+            setLayout(layout, CT_FLOAT, 8, 4, 0, -1, -1);
+            layout.read[2] = 4;
+            return;
+        case PF_FLOAT32_RGB:
+            setLayout(layout, CT_FLOAT, 12, 0, 4, 8, -1);
+            return;
+        case PF_FLOAT32_RGBA:
+            setLayout(layout, CT_FLOAT, 16, 0, 4, 8, 12);
+            return;
+        default:
+            break;
+        }
+
+        // Native endian formats of whole bytes, as the integer pack and
+        // unpack code handles them
+        const PixelFormatDescription& des = _pixelFormats[pf];
+        if (!(des.flags & PFF_NATIVEENDIAN) || (des.flags & PFF_COMPRESSED) || des.elemBytes > 4)
+            return;
+        int r = getByteOffset(des, des.rbits, des.rmask, des.rshift);
+        int g = getByteOffset(des, des.gbits, des.gmask, des.gshift);
+        int b = getByteOffset(des, des.bbits, des.bmask, des.bshift);
+        int a = getByteOffset(des, des.abits, des.amask, des.ashift);
+        if (r == -2 || g == -2 || b == -2 || a == -2)
+            return;
+        setLayout(layout, CT_BYTE, des.elemBytes, r, g, b, a);
+        if (des.flags & PFF_LUMINANCE)
+            layout.read[1] = layout.read[2] = r;
+        if (!(des.flags & PFF_HASALPHA))
+            layout.read[3] = -1;
+    }
+
+    void shuffle(const WordShuffle& s, const Ogre::uint8* src, Ogre::uint8* dst, size_t count) const
+    {
+        mShuffleRows[s.srcSize - 1][s.dstSize - 1](s, src, dst, count);
+    }
+
+    static float readChannel(const Ogre::uint16* src) { return Ogre::Bitwise::halfToFloat(*src); }
+    static float readChannel(const float* src) { return *src; }
+    static void writeChannel(Ogre::uint16* dst, float value) { *dst = Ogre::Bitwise::floatToHalf(value); }
+    static void writeChannel(float* dst, float value) { *dst = value; }
+
+    /// Reads half or float formats into RGBA floats
+    template <typename T>
+    static void readFloats(const PixelLayout& layout, const Ogre::uint8* src, float* rgba, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i, src += layout.size, rgba += 4)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                int offset = layout.read[c];
+                if (offset < 0)
+                    rgba[c] = c == 3 ? 1.0f : 0.0f;
+                else
+                    rgba[c] = readChannel((const T*)(src + offset));
+            }
+        }
     }
-};
 
-// Only conversions from X8R8G8B8 to formats with alpha need to be defined, the rest is implicitly the same
-// as A8R8G8B8
-struct X8R8G8B8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return inp | 0xFF000000;
-    }
-};
-struct X8R8G8B8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF)<<16)|((inp&0xFF0000)>>16)|(inp&0x00FF00)|0xFF000000;
-    }
-};
-struct X8R8G8B8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF)<<24)|((inp&0xFF0000)>>8)|((inp&0x00FF00)<<8)|0x000000FF;
-    }
-};
-struct X8R8G8B8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    /// Writes RGBA floats to half or float formats
+    template <typename T>
+    static void writeFloats(const PixelLayout& layout, const float* rgba, Ogre::uint8* dst, size_t count)
     {
-        return ((inp&0xFFFFFF)<<8)|0x000000FF;
+        for (size_t i = 0; i < count; ++i, dst += layout.size, rgba += 4)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                if (layout.write[c] >= 0)
+                    writeChannel((T*)(dst + layout.write[c]), rgba[c]);
+            }
+        }
     }
-};
 
-// X8B8G8R8
-struct X8B8G8R8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF)<<16)|((inp&0xFF0000)>>16)|(inp&0x00FF00)|0xFF000000;
-    }
-};
-struct X8B8G8R8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+    /// Writes RGBA bytes to half and float formats through the lookup tables
+    template <typename T>
+    static void writeBytes(const PixelLayout& layout, const T* table, const Ogre::uint8* rgba,
+                           Ogre::uint8* dst, size_t count)
     {
-        return inp | 0xFF000000;
+        for (size_t i = 0; i < count; ++i, dst += layout.size, rgba += 4)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                if (layout.write[c] >= 0)
+                    *(T*)(dst + layout.write[c]) = table[rgba[c]];
+            }
+        }
     }
-};
-struct X8B8G8R8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+
+    void floatsToBytes(const float* src, Ogre::uint8* dst, size_t count) const
     {
-        return ((inp&0xFFFFFF)<<8)|0x000000FF;
+#if __OGRE_HAVE_SSE
+        if (mUseSSE2)
+        {
+            floatsToBytesSSE2(src, dst, count);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (Ogre::uint8)Ogre::Bitwise::floatToFixed(src[i], 8);
     }
-};
-struct X8B8G8R8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
+
+    void convertPixels(const PixelLayout& srcLayout, const PixelLayout& dstLayout, const WordShuffle& s,
+                       const Ogre::uint8* src, Ogre::uint8* dst, size_t count) const
     {
-        return ((inp&0x0000FF)<<24)|((inp&0xFF0000)>>8)|((inp&0x00FF00)<<8)|0x000000FF;
+        if (srcLayout.type == CT_BYTE && dstLayout.type == CT_BYTE)
+        {
+            shuffle(s, src, dst, count);
+            return;
+        }
+
+        Ogre::uint8 rgba8[CONVERSION_CHUNK_SIZE * 4];
+        if (srcLayout.type == CT_BYTE)
+        {
+            shuffle(s, src, rgba8, count);
+            if (dstLayout.type == CT_HALF)
+                writeBytes(dstLayout, mByteToHalf, rgba8, dst, count);
+            else
+                writeBytes(dstLayout, mByteToFloat, rgba8, dst, count);
+            return;
+        }
+
+        float rgba[CONVERSION_CHUNK_SIZE * 4];
+        if (srcLayout.type == CT_HALF)
+            readFloats<Ogre::uint16>(srcLayout, src, rgba, count);
+        else
+            readFloats<float>(srcLayout, src, rgba, count);
+        if (dstLayout.type == CT_BYTE)
+        {
+            floatsToBytes(rgba, rgba8, count * 4);
+            shuffle(s, rgba8, dst, count);
+        }
+        else if (dstLayout.type == CT_HALF)
+        {
+            writeFloats<Ogre::uint16>(dstLayout, rgba, dst, count);
+        }
+        else
+        {
+            writeFloats<float>(dstLayout, rgba, dst, count);
+        }
     }
 };
 
+const PixelConversionTable pixelConversionTable;
 
 #define CASECONVERTER(type) case type::ID : PixelBoxConverter<type>::conversion(src, dst); return 1;
 
@@ -386,48 +712,13 @@ inline int doOptimizedConversion(const Ogre::PixelBox &src, const Ogre::PixelBox
     switch(FMTCONVERTERID(src.format, dst.format))
     {
         // Register converters here
-        CASECONVERTER(A8R8G8B8toA8B8G8R8);
-        CASECONVERTER(A8R8G8B8toB8G8R8A8);
-        CASECONVERTER(A8R8G8B8toR8G8B8A8);
-        CASECONVERTER(A8B8G8R8toA8R8G8B8);
-        CASECONVERTER(A8B8G8R8toB8G8R8A8);
-        CASECONVERTER(A8B8G8R8toR8G8B8A8);
-        CASECONVERTER(B8G8R8A8toA8R8G8B8);
-        CASECONVERTER(B8G8R8A8toA8B8G8R8);
-        CASECONVERTER(B8G8R8A8toR8G8B8A8);
-        CASECONVERTER(R8G8B8A8toA8R8G8B8);
-        CASECONVERTER(R8G8B8A8toA8B8G8R8);
-        CASECONVERTER(R8G8B8A8toB8G8R8A8);
-        CASECONVERTER(A8B8G8R8toL8);
-        CASECONVERTER(L8toA8B8G8R8);
-        CASECONVERTER(A8R8G8B8toL8);
-        CASECONVERTER(L8toA8R8G8B8);
-        CASECONVERTER(B8G8R8A8toL8);
-        CASECONVERTER(L8toB8G8R8A8);
         CASECONVERTER(L8toL16);
         CASECONVERTER(L16toL8);
-        CASECONVERTER(B8G8R8toR8G8B8);
-        CASECONVERTER(R8G8B8toB8G8R8);
-        CASECONVERTER(R8G8B8toA8R8G8B8);
-        CASECONVERTER(B8G8R8toA8R8G8B8);
-        CASECONVERTER(R8G8B8toA8B8G8R8);
-        CASECONVERTER(B8G8R8toA8B8G8R8);
-        CASECONVERTER(R8G8B8toB8G8R8A8);
-        CASECONVERTER(B8G8R8toB8G8R8A8);
-        CASECONVERTER(A8R8G8B8toR8G8B8);
-        CASECONVERTER(A8R8G8B8toB8G8R8);
-        CASECONVERTER(X8R8G8B8toA8R8G8B8);
-        CASECONVERTER(X8R8G8B8toA8B8G8R8);
-        CASECONVERTER(X8R8G8B8toB8G8R8A8);
-        CASECONVERTER(X8R8G8B8toR8G8B8A8);
-        CASECONVERTER(X8B8G8R8toA8R8G8B8);
-        CASECONVERTER(X8B8G8R8toA8B8G8R8);
-        CASECONVERTER(X8B8G8R8toB8G8R8A8);
-        CASECONVERTER(X8B8G8R8toR8G8B8A8);
 
         default:
-            return 0;
+            break;
     }
+    return pixelConversionTable.convert(src, dst);
 }
 #undef CASECONVERTER
 /** @} */
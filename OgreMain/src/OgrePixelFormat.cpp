@@ -31,6 +31,11 @@ THE SOFTWARE.
 #include "OgreColourValue.h"
 #include "OgreException.h"
 #include "OgrePixelFormatDescriptions.h"
+#include "OgreSIMDHelper.h"
+
+#if __OGRE_HAVE_SSE
+#include <emmintrin.h>
+#endif
 
 namespace {
 #include "OgrePixelConversions.h"
@@ -150,11 +150,22 @@ namespace Ogre {
     }
 
     //---------------------------------------------------------------------
-    // Performs CPUID instruction with 'query', fill the results, and return value of eax.
-    static uint _performCpuid(int query, CpuidResult& result)
+    // Performs CPUID instruction with 'query' and 'subQuery' (in ecx), fill the
+    // results, and return value of eax.
+    static uint _performCpuid(int query, CpuidResult& result, int subQuery = 0)
     {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
-    #if _MSC_VER >= 1400 
+    #if _MSC_VER >= 1500
+        int CPUInfo[4];
+        __cpuidex(CPUInfo, query, subQuery);
+        result._eax = CPUInfo[0];
+        result._ebx = CPUInfo[1];
+        result._ecx = CPUInfo[2];
+        result._edx = CPUInfo[3];
+        return result._eax;
+    #elif _MSC_VER >= 1400
+        // Only queries without sub-leaves are issued to compilers this old
+        (void)subQuery;
         int CPUInfo[4];
         __cpuid(CPUInfo, query);
         result._eax = CPUInfo[0];
@@ -167,6 +178,7 @@ namespace Ogre {
         {
             mov     edi, result
             mov     eax, query
+            mov     ecx, subQuery
             cpuid
             mov     [edi]._eax, eax
             mov     [edi]._ebx, ebx
@@ -179,7 +191,7 @@ namespace Ogre {
         #if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
         __asm__
         (
-            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query)
+            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query), "c" (subQuery)
         );
         #else
         __asm__
@@ -189,11 +201,39 @@ namespace Ogre {
             "movl   %%ebx, %%edi    \n\t"
             "popl   %%ebx           \n\t"
             : "=a" (result._eax), "=D" (result._ebx), "=c" (result._ecx), "=d" (result._edx)
-            : "a" (query)
+            : "a" (query), "c" (subQuery)
         );
        #endif // OGRE_ARCHITECTURE_64
         return result._eax;
 
+#else
+        // TODO: Supports other compiler
+        (void)subQuery;
+        return 0;
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Reads the extended control register XCR0, which tells the register
+    // states the operating system saves on context switches. Must only be
+    // called if CPUID reports OSXSAVE.
+    static uint _readXcr0(void)
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+    #if defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+        return (uint)_xgetbv(0);
+    #else
+        // Compiler can't emit XGETBV, behave as if the OS saves nothing
+        return 0;
+    #endif
+#elif (OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG) && OGRE_PLATFORM != OGRE_PLATFORM_NACL && OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        uint eax, edx;
+        // xgetbv, spelled out for old assemblers
+        __asm__ __volatile__
+        (
+            ".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0)
+        );
+        return eax;
 #else
         // TODO: Supports other compiler
         return 0;
@@ -300,6 +340,13 @@ namespace Ogre {
 #define CPUID_STD_SSE3              (1<<0)      // ECX[0]  - Bit 0 of standard function 1 indicate SSE3 supported
 #define CPUID_STD_SSE41             (1<<19)     // ECX[19] - Bit 0 of standard function 1 indicate SSE41 supported
 #define CPUID_STD_SSE42             (1<<20)     // ECX[20] - Bit 0 of standard function 1 indicate SSE42 supported
+#define CPUID_STD_FMA               (1<<12)     // ECX[12] - Bit 12 of standard function 1 indicate FMA3 supported
+#define CPUID_STD_OSXSAVE           (1<<27)     // ECX[27] - Bit 27 of standard function 1 indicate XGETBV usable
+#define CPUID_STD_AVX               (1<<28)     // ECX[28] - Bit 28 of standard function 1 indicate AVX supported
+
+#define CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES 0x7
+#define CPUID_SEF_AVX2              (1<<5)      // EBX[5]  - Bit 5 of function 7, sub-leaf 0 indicate AVX2 supported
+#define CPUID_SEF_AVX512F           (1<<16)     // EBX[16] - Bit 16 of function 7, sub-leaf 0 indicate AVX-512F supported
 
 #define CPUID_FAMILY_ID_MASK        0x0F00      // EAX[11:8] - Bit 11 thru 8 contains family  processor id
 #define CPUID_EXT_FAMILY_ID_MASK    0x0F00000   // EAX[23:20] - Bit 23 thru 20 contains extended family processor id
@@ -416,6 +463,27 @@ namespace Ogre {
                             features |= PlatformInformation::CPU_FEATURE_INVARIANT_TSC;
                     }
                 }
+
+                // AVX family, reported the same way by all vendors
+                const uint maxFunctionSupport = _performCpuid(CPUID_FUNC_VENDOR_ID, result);
+                _performCpuid(CPUID_FUNC_STANDARD_FEATURES, result);
+                if (result._ecx & CPUID_STD_OSXSAVE)
+                {
+                    if (result._ecx & CPUID_STD_AVX)
+                        features |= PlatformInformation::CPU_FEATURE_AVX;
+                    if (result._ecx & CPUID_STD_FMA)
+                        features |= PlatformInformation::CPU_FEATURE_FMA;
+
+                    if (maxFunctionSupport >= CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES)
+                    {
+                        _performCpuid(CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES, result, 0);
+
+                        if (result._ebx & CPUID_SEF_AVX2)
+                            features |= PlatformInformation::CPU_FEATURE_AVX2;
+                        if (result._ebx & CPUID_SEF_AVX512F)
+                            features |= PlatformInformation::CPU_FEATURE_AVX512F;
+                    }
+                }
             }
         }
 
@@ -433,9 +501,28 @@ namespace Ogre {
             | PlatformInformation::CPU_FEATURE_SSE41
             | PlatformInformation::CPU_FEATURE_SSE42;
 
+        const uint avx_features = 0
+            | PlatformInformation::CPU_FEATURE_AVX
+            | PlatformInformation::CPU_FEATURE_AVX2
+            | PlatformInformation::CPU_FEATURE_FMA
+            | PlatformInformation::CPU_FEATURE_AVX512F;
+
         if ((features & sse_features) && !_checkOperatingSystemSupportSSE())
         {
-            features &= ~sse_features;
+            features &= ~(sse_features | avx_features);
+        }
+
+        // The wider registers are only usable if the OS saves them, only
+        // queried when CPUID reported OSXSAVE
+        if (features & avx_features)
+        {
+            const uint xcr0 = _readXcr0();
+            // XMM and YMM state
+            if ((xcr0 & 0x06) != 0x06)
+                features &= ~avx_features;
+            // Opmask, upper ZMM0-15 and ZMM16-31 state
+            if ((xcr0 & 0xE0) != 0xE0)
+                features &= ~PlatformInformation::CPU_FEATURE_AVX512F;
         }
 
         return features;
@@ -699,6 +786,14 @@ namespace Ogre {
                 " *        SSE41: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE41), true));
             pLog->logMessage(
                 " *        SSE42: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE42), true));
+            pLog->logMessage(
+                " *          AVX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX), true));
+            pLog->logMessage(
+                " *         AVX2: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX2), true));
+            pLog->logMessage(
+                " *          FMA: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_FMA), true));
+            pLog->logMessage(
+                " *      AVX512F: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX512F), true));
             pLog->logMessage(
                 " *          MMX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_MMX), true));
             pLog->logMessage(
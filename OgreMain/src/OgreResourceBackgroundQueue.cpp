@@ -34,7 +34,8 @@ THE SOFTWARE.
 namespace Ogre {
 
     // Note, no locks are required here anymore because all of the parallelisation
-    // is now contained in WorkQueue - this class is entirely single-threaded
+    // is now contained in WorkQueue and AsyncReadQueue - this class is single-threaded,
+    // apart from the aborted file requests and the reads completing in FileRead
     //------------------------------------------------------------------------
     //-----------------------------------------------------------------------
     template<> ResourceBackgroundQueue* Singleton<ResourceBackgroundQueue>::msSingleton = 0;
@@ -48,7 +49,30 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------   
     //------------------------------------------------------------------------
-    ResourceBackgroundQueue::ResourceBackgroundQueue() : mWorkQueueChannel(0)
+    /// Hands a file over to the WorkQueue once it has been read
+    class ResourceBackgroundQueue::FileRead : public AsyncReadQueue::Listener, public ResourceAlloc
+    {
+    public:
+        FileRead(ResourceBackgroundQueue* queue, const ResourceRequest& request,
+            OutstandingRequest* outstanding)
+            : mQueue(queue), mRequest(request), mOutstanding(outstanding)
+        {
+        }
+
+        void readCompleted(const AsyncReadQueue::Result& result)
+        {
+            mQueue->addFileRequest(mRequest, result, mOutstanding);
+            OGRE_DELETE this;
+        }
+
+    private:
+        ResourceBackgroundQueue* mQueue;
+        ResourceRequest mRequest;
+        /// Stays in mOutstandingRequests until the WorkQueue request completes
+        OutstandingRequest* mOutstanding;
+    };
+    //------------------------------------------------------------------------
+    ResourceBackgroundQueue::ResourceBackgroundQueue() : mWorkQueueChannel(0), mNextTicket(0)
     {
     }
     //------------------------------------------------------------------------
@@ -71,6 +95,20 @@ namespace Ogre {
         wq->abortRequestsByChannel(mWorkQueueChannel);
         wq->removeRequestHandler(mWorkQueueChannel, this);
         wq->removeResponseHandler(mWorkQueueChannel, this);
+
+        // Drop the files waiting to be read, those being read are dropped by
+        // the WorkQueue as nothing handles the channel anymore
+        AsyncReadQueue* readQueue = Root::getSingleton().getAsyncReadQueue();
+        for (OutstandingRequestMap::iterator i = mOutstandingRequests.begin(); i != mOutstandingRequests.end();)
+        {
+            if (i->second.read && readQueue->abortRequest(i->second.readID))
+            {
+                OGRE_DELETE i->second.read;
+                mOutstandingRequests.erase(i++);
+            }
+            else
+                ++i;
+        }
     }
     //------------------------------------------------------------------------
     BackgroundProcessTicket ResourceBackgroundQueue::initialiseResourceGroup(
@@ -257,34 +295,131 @@ namespace Ogre {
         return 0; 
 #endif
 
+    }
+    //---------------------------------------------------------------------
+    BackgroundProcessTicket ResourceBackgroundQueue::readFile(const String& filename,
+        const String& group, FileProcessor* processor, Listener* listener)
+    {
+#if OGRE_THREAD_SUPPORT
+        ResourceRequest req;
+        req.type = RT_PROCESS_FILE;
+        req.resourceName = filename;
+        req.groupName = group;
+        req.isManual = false;
+        req.loader = 0;
+        req.loadParams = 0;
+        req.processor = processor;
+        req.listener = listener;
+        req.ticket = ++mNextTicket;
+
+        // The WorkQueue request is added once the file has been read
+        OutstandingRequest& outstanding = mOutstandingRequests[req.ticket];
+        FileRead* read = OGRE_NEW FileRead(this, req, &outstanding);
+        {
+            OGRE_LOCK_MUTEX(mFileRequestsMutex);
+            outstanding.workQueueID = 0;
+            outstanding.read = read;
+            outstanding.readID = 0;
+        }
+        AsyncReadQueue::RequestID readID = Root::getSingleton().getAsyncReadQueue()->readFile(filename, group, read);
+        {
+            // May have been read synchronously already
+            OGRE_LOCK_MUTEX(mFileRequestsMutex);
+            if (outstanding.read)
+                outstanding.readID = readID;
+        }
+        return req.ticket;
+#else
+        // synchronous
+        DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(filename, group);
+        processor->processFile(stream, filename, group);
+        return 0;
+#endif
     }
     //------------------------------------------------------------------------
     bool ResourceBackgroundQueue::isProcessComplete(
             BackgroundProcessTicket ticket)
     {
-        return mOutstandingRequestSet.find(ticket) == mOutstandingRequestSet.end();
+        return mOutstandingRequests.find(ticket) == mOutstandingRequests.end();
     }
     //------------------------------------------------------------------------
     void ResourceBackgroundQueue::abortRequest( BackgroundProcessTicket ticket )
     {
+        OutstandingRequestMap::iterator i = mOutstandingRequests.find(ticket);
+        if (i == mOutstandingRequests.end())
+            return;
+
+        WorkQueue::RequestID workQueueID;
+        {
+            OGRE_LOCK_MUTEX(mFileRequestsMutex);
+            if (i->second.read)
+            {
+                // Still waiting to be read, FileRead won't be called
+                if (Root::getSingleton().getAsyncReadQueue()->abortRequest(i->second.readID))
+                {
+                    OGRE_DELETE i->second.read;
+                    mOutstandingRequests.erase(i);
+                    return;
+                }
+
+                // Being read, the WorkQueue request is skipped once added
+                mAbortedFileRequests.insert(ticket);
+                return;
+            }
+            workQueueID = i->second.workQueueID;
+        }
+
         WorkQueue* queue = Root::getSingleton().getWorkQueue();
 
-        queue->abortRequest( ticket );
+        queue->abortRequest( workQueueID );
+    }
+    //------------------------------------------------------------------------
+    bool ResourceBackgroundQueue::wasFileRequestAborted(BackgroundProcessTicket ticket, bool forget)
+    {
+        OGRE_LOCK_MUTEX(mFileRequestsMutex);
+        TicketSet::iterator i = mAbortedFileRequests.find(ticket);
+        if (i == mAbortedFileRequests.end())
+            return false;
+        if (forget)
+            mAbortedFileRequests.erase(i);
+        return true;
     }
     //------------------------------------------------------------------------
     BackgroundProcessTicket ResourceBackgroundQueue::addRequest(ResourceRequest& req)
     {
         WorkQueue* queue = Root::getSingleton().getWorkQueue();
 
+        req.ticket = ++mNextTicket;
+        OutstandingRequest& outstanding = mOutstandingRequests[req.ticket];
+        outstanding.read = 0;
+        outstanding.readID = 0;
+
         Any data(req);
 
-        WorkQueue::RequestID requestID = 
+        outstanding.workQueueID = 
             queue->addRequest(mWorkQueueChannel, (uint16)req.type, data);
 
+        return req.ticket;
+    }
+    //------------------------------------------------------------------------
+    void ResourceBackgroundQueue::addFileRequest(const ResourceRequest& req,
+        const AsyncReadQueue::Result& result, OutstandingRequest* outstanding)
+    {
+        ResourceRequest fileReq = req;
+        if (result.succeeded())
+            fileReq.stream = result.data;
+        else
+        {
+            fileReq.result.error = true;
+            fileReq.result.message = result.error;
+        }
 
-        mOutstandingRequestSet.insert(requestID);
-
-        return requestID;
+        // Held while adding, so abortRequest sees either the read or the
+        // WorkQueue request
+        OGRE_LOCK_MUTEX(mFileRequestsMutex);
+        outstanding->workQueueID =
+            Root::getSingleton().getWorkQueue()->addRequest(mWorkQueueChannel, RT_PROCESS_FILE, Any(fileReq));
+        outstanding->read = 0;
     }
     //-----------------------------------------------------------------------
     bool ResourceBackgroundQueue::canHandleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
@@ -297,7 +432,8 @@ namespace Ogre {
 
         ResourceRequest resreq = any_cast<ResourceRequest>(req->getData());
 
-        if( req->getAborted() )
+        if( req->getAborted() ||
+            (resreq.type == RT_PROCESS_FILE && wasFileRequestAborted(resreq.ticket, false)) )
         {
             if( resreq.type == RT_PREPARE_RESOURCE || resreq.type == RT_LOAD_RESOURCE )
             {
@@ -309,6 +445,13 @@ namespace Ogre {
             return OGRE_NEW WorkQueue::Response(req, true, Any(resresp));
         }
 
+        // The file couldn't be read
+        if( resreq.result.error )
+        {
+            ResourceResponse resresp(ResourcePtr(), resreq);
+            return OGRE_NEW WorkQueue::Response(req, false, Any(resresp), resreq.result.message);
+        }
+
         ResourceManager* rm = 0;
         ResourcePtr resource;
         try
@@ -365,6 +508,9 @@ namespace Ogre {
                 else
                     rm->unload(resreq.resourceName, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
                 break;
+            case RT_PROCESS_FILE:
+                resreq.processor->processFile(resreq.stream, resreq.resourceName, resreq.groupName);
+                break;
             };
         }
         catch (Exception& e)
@@ -404,7 +550,16 @@ namespace Ogre {
     {
         if( res->getRequest()->getAborted() )
         {
-            mOutstandingRequestSet.erase(res->getRequest()->getID());
+            // The response data is gone, look the ticket up by the request
+            OGRE_LOCK_MUTEX(mFileRequestsMutex);
+            for (OutstandingRequestMap::iterator i = mOutstandingRequests.begin(); i != mOutstandingRequests.end(); ++i)
+            {
+                if (i->second.workQueueID == res->getRequest()->getID())
+                {
+                    mOutstandingRequests.erase(i);
+                    break;
+                }
+            }
             return ;
         }
 
@@ -413,6 +568,12 @@ namespace Ogre {
         // Complete full loading in main thread if semithreading
         const ResourceRequest& req = resresp.request;
 
+        if (req.type == RT_PROCESS_FILE && wasFileRequestAborted(req.ticket, true))
+        {
+            mOutstandingRequests.erase(req.ticket);
+            return;
+        }
+
         if (res->succeeded())
         {
 #if OGRE_THREAD_SUPPORT == 2
@@ -428,8 +589,6 @@ namespace Ogre {
                 ResourceGroupManager::getSingleton().loadResourceGroup(req.groupName);
             }
 #endif
-            mOutstandingRequestSet.erase(res->getRequest()->getID());
-
             // Call resource listener
             if (resresp.resource) 
             {
@@ -444,9 +603,11 @@ namespace Ogre {
                 }
             }
         }
+        mOutstandingRequests.erase(req.ticket);
+
         // Call queue listener
         if (req.listener)
-            req.listener->operationCompleted(res->getRequest()->getID(), req.result);
+            req.listener->operationCompleted(req.ticket, req.result);
     }
     //------------------------------------------------------------------------
 
@@ -34,6 +34,8 @@ THE SOFTWARE.
 #include "OgreScriptLoader.h"
 #include "OgreSceneManager.h"
 #include "OgreResourceManager.h"
+#include "OgreRoot.h"
+#include "Threading/OgreTaskScheduler.h"
 
 namespace Ogre {
 
@@ -61,7 +63,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     ResourceGroupManager::ResourceGroupManager()
-        : mLoadingListener(0), mCurrentGroup(0)
+        : mLoadingListener(0), mCurrentGroup(0), mPrepareInParallel(false), mParseScriptsInParallel(false),
+          mUseResourceIndexCache(false), mResourceIndexCacheDirty(false)
     {
         // Create the 'General' group
         createResourceGroup(DEFAULT_RESOURCE_GROUP_NAME, true); // the "General" group is synonymous to global pool
@@ -101,6 +104,7 @@ namespace Ogre {
         grp->worldGeometrySceneManager = 0;
 
         OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_RW_MUTEX_WRITE(mLookupMutex);
         mResourceGroupMap.insert(
             ResourceGroupMap::value_type(name, grp));
     }
@@ -176,34 +180,44 @@ namespace Ogre {
                 "ResourceGroupManager::prepareResourceGroup");
         }
 
-        OGRE_LOCK_AUTO_MUTEX;
-        OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
-        // Set current group
-        mCurrentGroup = grp;
-
-        // Count up resources for starting event
-        ResourceGroup::LoadResourceOrderMap::iterator oi;
-        size_t resourceCount = 0;
-        if (prepareMainResources)
         {
-            for (oi = grp->loadResourceOrderMap.begin(); oi != grp->loadResourceOrderMap.end(); ++oi)
+            OGRE_LOCK_AUTO_MUTEX;
+            OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
+            // Set current group
+            mCurrentGroup = grp;
+
+            // Count up resources for starting event
+            ResourceGroup::LoadResourceOrderMap::iterator oi;
+            size_t resourceCount = 0;
+            if (prepareMainResources)
             {
-                resourceCount += oi->second.size();
+                for (oi = grp->loadResourceOrderMap.begin(); oi != grp->loadResourceOrderMap.end(); ++oi)
+                {
+                    resourceCount += oi->second.size();
+                }
+            }
+            // Estimate world geometry size
+            if (grp->worldGeometrySceneManager && prepareWorldGeom)
+            {
+                resourceCount += 
+                    grp->worldGeometrySceneManager->estimateWorldGeometry(
+                        grp->worldGeometry);
             }
-        }
-        // Estimate world geometry size
-        if (grp->worldGeometrySceneManager && prepareWorldGeom)
-        {
-            resourceCount += 
-                grp->worldGeometrySceneManager->estimateWorldGeometry(
-                    grp->worldGeometry);
-        }
 
-        fireResourceGroupPrepareStarted(name, resourceCount);
+            fireResourceGroupPrepareStarted(name, resourceCount);
+        }
 
         // Now load for real
-        if (prepareMainResources)
+        if (prepareMainResources && mPrepareInParallel && Root::getSingletonPtr())
         {
+            processResourcesInParallel(grp, false);
+        }
+        else if (prepareMainResources)
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
+
+            ResourceGroup::LoadResourceOrderMap::iterator oi;
             for (oi = grp->loadResourceOrderMap.begin(); 
                 oi != grp->loadResourceOrderMap.end(); ++oi)
             {
@@ -242,6 +256,9 @@ namespace Ogre {
                 }
             }
         }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
         // Load World Geometry
         if (grp->worldGeometrySceneManager && prepareWorldGeom)
         {
@@ -271,34 +288,44 @@ namespace Ogre {
                 "ResourceGroupManager::loadResourceGroup");
         }
 
-        OGRE_LOCK_AUTO_MUTEX;
-        OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
-        // Set current group
-        mCurrentGroup = grp;
-
-        // Count up resources for starting event
-        ResourceGroup::LoadResourceOrderMap::iterator oi;
-        size_t resourceCount = 0;
-        if (loadMainResources)
         {
-            for (oi = grp->loadResourceOrderMap.begin(); oi != grp->loadResourceOrderMap.end(); ++oi)
+            OGRE_LOCK_AUTO_MUTEX;
+            OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
+            // Set current group
+            mCurrentGroup = grp;
+
+            // Count up resources for starting event
+            ResourceGroup::LoadResourceOrderMap::iterator oi;
+            size_t resourceCount = 0;
+            if (loadMainResources)
             {
-                resourceCount += oi->second.size();
+                for (oi = grp->loadResourceOrderMap.begin(); oi != grp->loadResourceOrderMap.end(); ++oi)
+                {
+                    resourceCount += oi->second.size();
+                }
+            }
+            // Estimate world geometry size
+            if (grp->worldGeometrySceneManager && loadWorldGeom)
+            {
+                resourceCount += 
+                    grp->worldGeometrySceneManager->estimateWorldGeometry(
+                        grp->worldGeometry);
             }
-        }
-        // Estimate world geometry size
-        if (grp->worldGeometrySceneManager && loadWorldGeom)
-        {
-            resourceCount += 
-                grp->worldGeometrySceneManager->estimateWorldGeometry(
-                    grp->worldGeometry);
-        }
 
-        fireResourceGroupLoadStarted(name, resourceCount);
+            fireResourceGroupLoadStarted(name, resourceCount);
+        }
 
         // Now load for real
-        if (loadMainResources)
+        if (loadMainResources && mPrepareInParallel && Root::getSingletonPtr())
+        {
+            processResourcesInParallel(grp, true);
+        }
+        else if (loadMainResources)
         {
+            OGRE_LOCK_AUTO_MUTEX;
+            OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
+
+            ResourceGroup::LoadResourceOrderMap::iterator oi;
             for (oi = grp->loadResourceOrderMap.begin(); 
                 oi != grp->loadResourceOrderMap.end(); ++oi)
             {
@@ -337,6 +364,9 @@ namespace Ogre {
                 }
             }
         }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex 
         // Load World Geometry
         if (grp->worldGeometrySceneManager && loadWorldGeom)
         {
@@ -354,6 +384,104 @@ namespace Ogre {
         LogManager::getSingleton().logMessage("Finished loading resource group " + name);
     }
     //-----------------------------------------------------------------------
+    namespace
+    {
+        /// Prepares a resource on the task scheduler
+        class ResourcePrepareTask : public Task
+        {
+        public:
+            Resource* resource;
+
+            ResourcePrepareTask() : resource(0) {}
+            ResourcePrepareTask(const ResourcePrepareTask& rhs) : Task(), resource(rhs.resource) {}
+
+            void execute()
+            {
+                try
+                {
+                    resource->prepare();
+                }
+                catch (...)
+                {
+                    // The resource is left unprepared. The waiting thread
+                    // prepares it again, which reports the error just like
+                    // preparing serially does.
+                }
+            }
+        };
+    }
+    //-----------------------------------------------------------------------
+    void ResourceGroupManager::processResourcesInParallel(ResourceGroup* grp, bool load)
+    {
+        TaskScheduler* scheduler = Root::getSingleton().getTaskScheduler();
+        set<ResourceHandle>::type processed;
+
+        // Preparing or loading may create resources in this group, which
+        // are appended to it, so keep going until there are no new ones
+        while (true)
+        {
+            vector<ResourcePtr>::type resources;
+            {
+                OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex
+                ResourceGroup::LoadResourceOrderMap::iterator oi;
+                for (oi = grp->loadResourceOrderMap.begin(); 
+                    oi != grp->loadResourceOrderMap.end(); ++oi)
+                {
+                    LoadUnloadResourceList::iterator l;
+                    for (l = oi->second.begin(); l != oi->second.end(); ++l)
+                    {
+                        if (processed.insert((*l)->getHandle()).second)
+                            resources.push_back(*l);
+                    }
+                }
+            }
+            if (resources.empty())
+                break;
+
+            vector<ResourcePrepareTask>::type tasks(resources.size());
+            for (size_t i = 0; i < resources.size(); ++i)
+            {
+                tasks[i].resource = resources[i].get();
+                scheduler->submit(&tasks[i]);
+            }
+
+            // Fire the events and finish the resources on this thread, in order
+            size_t i = 0;
+            try
+            {
+                for (; i < resources.size(); ++i)
+                {
+                    const ResourcePtr& res = resources[i];
+                    if (load)
+                        fireResourceLoadStarted(res);
+                    else
+                        fireResourcePrepareStarted(res);
+
+                    scheduler->wait(&tasks[i]);
+
+                    // Already prepared, unless preparing failed
+                    if (load)
+                    {
+                        res->load();
+                        fireResourceLoadEnded();
+                    }
+                    else
+                    {
+                        res->prepare();
+                        fireResourcePrepareEnded();
+                    }
+                }
+            }
+            catch (...)
+            {
+                // The tasks mustn't be destroyed while still queued or running
+                for (; i < tasks.size(); ++i)
+                    scheduler->wait(&tasks[i]);
+                throw;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::unloadResourceGroup(const String& name, bool reloadableOnly)
     {
         LogManager::getSingleton().logMessage("Unloading resource group " + name);
@@ -476,8 +604,12 @@ namespace Ogre {
         mCurrentGroup = grp;
         unloadResourceGroup(name, false); // will throw an exception if name not valid
         dropGroupContents(grp);
+        {
+            // Remove before deleting, lookups don't hold the auto mutex
+            OGRE_LOCK_RW_MUTEX_WRITE(mLookupMutex);
+            mResourceGroupMap.erase(mResourceGroupMap.find(name));
+        }
         deleteGroup(grp);
-        mResourceGroupMap.erase(mResourceGroupMap.find(name));
         // reset current group
         mCurrentGroup = 0;
     }
@@ -542,7 +674,10 @@ namespace Ogre {
         ResourceLocation* loc = OGRE_NEW_T(ResourceLocation, MEMCATEGORY_RESOURCE);
         loc->archive = pArch;
         loc->recursive = recursive;
-        StringVectorPtr vec = pArch->find("*", recursive);
+        bool fromCache = false;
+        StringVectorPtr vec = listResourceLocation(pArch, recursive, fromCache);
+        if (mUseResourceIndexCache)
+            loc->files = vec;
 
         ResourceGroup* grp = getResourceGroup(resGroup);
         if (!grp)
@@ -563,10 +698,226 @@ namespace Ogre {
             << "' to resource group '" << resGroup << "'";
         if (recursive)
             msg << " with recursive option";
+        if (fromCache)
+            msg << " from the index cache";
         LogManager::getSingleton().logMessage(msg.str());
 
     }
     //-----------------------------------------------------------------------
+    StringVectorPtr ResourceGroupManager::listResourceLocation(Archive* arch,
+        bool recursive, bool& fromCache)
+    {
+        fromCache = false;
+        if (!mUseResourceIndexCache)
+            return arch->find("*", recursive);
+
+        String key = arch->getType() + ":" + arch->getName() + (recursive ? ":recursive" : "");
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            ResourceIndexCache::iterator i = mResourceIndexCache.find(key);
+            if (i != mResourceIndexCache.end())
+            {
+                fromCache = true;
+                map<String, int64>::type::iterator d;
+                for (d = i->second.directoryTimes.begin(); d != i->second.directoryTimes.end(); ++d)
+                {
+                    if (arch->getModifiedTime(d->first) != d->second)
+                    {
+                        fromCache = false;
+                        break;
+                    }
+                }
+                if (fromCache)
+                    return i->second.files;
+            }
+        }
+
+        // Get the times before listing, so changes made meanwhile invalidate
+        // the listing next time
+        time_t now = time(0);
+        ResourceIndexCacheEntry entry;
+        entry.directoryTimes[BLANKSTRING] = arch->getModifiedTime(BLANKSTRING);
+        if (recursive)
+        {
+            StringVectorPtr dirs = arch->list(true, true);
+            for (StringVector::iterator d = dirs->begin(); d != dirs->end(); ++d)
+                entry.directoryTimes[*d] = arch->getModifiedTime(*d);
+        }
+        entry.files = arch->find("*", recursive);
+
+        // Modification times have a resolution of a second, so a change in
+        // the same second as the recorded time would go unnoticed. Only cache
+        // archives which weren't modified that recently, or whose times are
+        // unknown.
+        bool cacheable = true;
+        map<String, int64>::type::iterator d;
+        for (d = entry.directoryTimes.begin(); d != entry.directoryTimes.end(); ++d)
+        {
+            if (d->second == 0 || d->second >= now - 1)
+                cacheable = false;
+        }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        if (cacheable)
+        {
+            mResourceIndexCache[key] = entry;
+            mResourceIndexCacheDirty = true;
+        }
+        else if (mResourceIndexCache.erase(key))
+        {
+            mResourceIndexCacheDirty = true;
+        }
+        return entry.files;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr ResourceGroupManager::findFileInfoInLocation(
+        const ResourceLocation* loc, const String& pattern) const
+    {
+        if (!loc->files)
+            return loc->archive->findFileInfo(pattern, loc->recursive);
+
+        // Match the way the archives do, against the file name unless the
+        // pattern includes a path, which may use either separator
+        String normalisedPattern = pattern;
+        std::replace(normalisedPattern.begin(), normalisedPattern.end(), '\\', '/');
+        bool fullMatch = normalisedPattern.find('/') != String::npos;
+        bool caseSensitive = loc->archive->isCaseSensitive();
+
+        FileInfoListPtr ret(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        for (StringVector::const_iterator i = loc->files->begin(); i != loc->files->end(); ++i)
+        {
+            FileInfo fi;
+            size_t pos = i->find_last_of('/');
+            fi.basename = pos == String::npos ? *i : i->substr(pos + 1);
+            if (StringUtil::match(fullMatch ? *i : fi.basename, normalisedPattern, caseSensitive))
+            {
+                fi.archive = loc->archive;
+                fi.filename = *i;
+                fi.path = pos == String::npos ? BLANKSTRING : i->substr(0, pos + 1);
+                // Not known without asking the archive
+                fi.compressedSize = 0;
+                fi.uncompressedSize = 0;
+                ret->push_back(fi);
+            }
+        }
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    bool ResourceGroupManager::isResourceIndexCacheDirty(void) const
+    {
+        return mResourceIndexCacheDirty;
+    }
+    //-----------------------------------------------------------------------
+    static const uint32 RESOURCE_INDEX_CACHE_ID = 0x52494331; // "RIC1"
+    //-----------------------------------------------------------------------
+    static void writeString(const DataStreamPtr& stream, const String& str)
+    {
+        uint32 length = static_cast<uint32>(str.size());
+        stream->write(&length, sizeof(uint32));
+        stream->write(str.data(), length);
+    }
+    //-----------------------------------------------------------------------
+    static bool readString(const DataStreamPtr& stream, String& str)
+    {
+        uint32 length = 0;
+        if (stream->read(&length, sizeof(uint32)) != sizeof(uint32) ||
+            length > stream->size() - stream->tell())
+            return false;
+        str.resize(length);
+        return length == 0 || stream->read(&str[0], length) == length;
+    }
+    //-----------------------------------------------------------------------
+    void ResourceGroupManager::saveResourceIndexCache(DataStreamPtr stream)
+    {
+        if (!stream->isWriteable())
+        {
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                "Unable to write to stream " + stream->getName(),
+                "ResourceGroupManager::saveResourceIndexCache");
+        }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        stream->write(&RESOURCE_INDEX_CACHE_ID, sizeof(uint32));
+        uint32 numEntries = static_cast<uint32>(mResourceIndexCache.size());
+        stream->write(&numEntries, sizeof(uint32));
+
+        ResourceIndexCache::const_iterator i;
+        for (i = mResourceIndexCache.begin(); i != mResourceIndexCache.end(); ++i)
+        {
+            writeString(stream, i->first);
+
+            const map<String, int64>::type& times = i->second.directoryTimes;
+            uint32 numDirs = static_cast<uint32>(times.size());
+            stream->write(&numDirs, sizeof(uint32));
+            for (map<String, int64>::type::const_iterator d = times.begin(); d != times.end(); ++d)
+            {
+                writeString(stream, d->first);
+                stream->write(&d->second, sizeof(int64));
+            }
+
+            const StringVector& files = *i->second.files;
+            uint32 numFiles = static_cast<uint32>(files.size());
+            stream->write(&numFiles, sizeof(uint32));
+            for (StringVector::const_iterator f = files.begin(); f != files.end(); ++f)
+                writeString(stream, *f);
+        }
+
+        mResourceIndexCacheDirty = false;
+    }
+    //-----------------------------------------------------------------------
+    void ResourceGroupManager::loadResourceIndexCache(DataStreamPtr stream)
+    {
+        ResourceIndexCache cache;
+        bool valid = true;
+
+        uint32 id = 0, numEntries = 0;
+        if (stream->read(&id, sizeof(uint32)) != sizeof(uint32) || id != RESOURCE_INDEX_CACHE_ID ||
+            stream->read(&numEntries, sizeof(uint32)) != sizeof(uint32))
+            valid = false;
+
+        for (uint32 i = 0; valid && i < numEntries; ++i)
+        {
+            String key;
+            ResourceIndexCacheEntry entry;
+            uint32 numDirs = 0;
+            valid = readString(stream, key) &&
+                stream->read(&numDirs, sizeof(uint32)) == sizeof(uint32);
+            for (uint32 d = 0; valid && d < numDirs; ++d)
+            {
+                String dir;
+                int64 time = 0;
+                valid = readString(stream, dir) &&
+                    stream->read(&time, sizeof(int64)) == sizeof(int64);
+                entry.directoryTimes[dir] = time;
+            }
+
+            uint32 numFiles = 0;
+            valid = valid && stream->read(&numFiles, sizeof(uint32)) == sizeof(uint32) &&
+                numFiles <= stream->size() - stream->tell();
+            if (!valid)
+                break;
+            entry.files = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+            entry.files->resize(numFiles);
+            for (uint32 f = 0; valid && f < numFiles; ++f)
+                valid = readString(stream, (*entry.files)[f]);
+
+            cache[key] = entry;
+        }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        if (valid)
+        {
+            mResourceIndexCache.swap(cache);
+        }
+        else
+        {
+            LogManager::getSingleton().logMessage(
+                "Ignoring invalid resource index cache " + stream->getName());
+            mResourceIndexCache.clear();
+        }
+        mResourceIndexCacheDirty = false;
+    }
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::removeResourceLocation(const String& name, 
         const String& resGroup)
     {
@@ -890,6 +1241,7 @@ namespace Ogre {
 
         LogManager::getSingleton().logMessage(
             "Registering ResourceManager for type " + resourceType);
+        OGRE_LOCK_RW_MUTEX_WRITE(mLookupMutex);
         mResourceManagerMap[resourceType] = rm;
     }
     //-----------------------------------------------------------------------
@@ -901,6 +1253,7 @@ namespace Ogre {
         LogManager::getSingleton().logMessage(
             "Unregistering ResourceManager for type " + resourceType);
         
+        OGRE_LOCK_RW_MUTEX_WRITE(mLookupMutex);
         ResourceManagerMap::iterator i = mResourceManagerMap.find(resourceType);
         if (i != mResourceManagerMap.end())
         {
@@ -959,6 +1312,42 @@ namespace Ogre {
         return 0; // No loader was found
     }
     //-----------------------------------------------------------------------
+    namespace
+    {
+        /// Reads and prepares a script on the task scheduler
+        class ScriptPrepareTask : public Task
+        {
+        public:
+            ScriptLoader* loader;
+            const FileInfo* file;
+            const String* group;
+            ScriptLoader::PreparedScript* result;
+
+            ScriptPrepareTask() : loader(0), file(0), group(0), result(0) {}
+            ScriptPrepareTask(const ScriptPrepareTask& rhs)
+                : Task(), loader(rhs.loader), file(rhs.file), group(rhs.group), result(0) {}
+            ~ScriptPrepareTask() { OGRE_DELETE result; }
+
+            void execute()
+            {
+                try
+                {
+                    DataStreamPtr stream = file->archive->open(file->filename);
+                    if (stream)
+                        result = loader->prepareScript(stream, *group);
+                }
+                catch (...)
+                {
+                    // Without a result the script is parsed as usual, which
+                    // reports the error
+                }
+            }
+        };
+
+        /// How many scripts may be prepared ahead of the one being parsed
+        const size_t MAX_SCRIPTS_PREPARED_AHEAD = 64;
+    }
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::parseResourceGroupScripts(ResourceGroup* grp) const
     {
 
@@ -985,7 +1374,13 @@ namespace Ogre {
             const StringVector& patterns = su->getScriptPatterns();
             for (StringVector::const_iterator p = patterns.begin(); p != patterns.end(); ++p)
             {
-                FileInfoListPtr fileList = findResourceFileInfo(grp->name, *p);
+                OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex
+                FileInfoListPtr fileList(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+                for (LocationList::iterator li = grp->locationList.begin(); li != grp->locationList.end(); ++li)
+                {
+                    FileInfoListPtr lst = findFileInfoInLocation(*li, *p);
+                    fileList->insert(fileList->end(), lst->begin(), lst->end());
+                }
                 scriptCount += fileList->size();
                 fileListList->push_back(fileList);
             }
@@ -995,36 +1390,82 @@ namespace Ogre {
         // Fire scripting event
         fireResourceGroupScriptingStarted(grp->name, scriptCount);
 
+        TaskScheduler* scheduler = 0;
+        if (mParseScriptsInParallel && !mLoadingListener && Root::getSingletonPtr())
+            scheduler = Root::getSingleton().getTaskScheduler();
+
         // Iterate over scripts and parse
         // Note we respect original ordering
         for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
             slfli != scriptLoaderFileList.end(); ++slfli)
         {
             ScriptLoader* su = slfli->first;
+            vector<const FileInfo*>::type files;
             // Iterate over each list
             for (FileListList::iterator flli = slfli->second->begin(); flli != slfli->second->end(); ++flli)
             {
                 // Iterate over each item in the list
                 for (FileInfoList::iterator fii = (*flli)->begin(); fii != (*flli)->end(); ++fii)
+                    files.push_back(&*fii);
+            }
+
+            // Scripts are prepared on the scheduler a little ahead of being
+            // parsed here, the window bounds the memory the prepared ones use
+            vector<ScriptPrepareTask>::type tasks(scheduler ? files.size() : 0);
+            size_t numSubmitted = 0;
+            size_t i = 0;
+            try
+            {
+                for (; i < files.size(); ++i)
                 {
+                    const FileInfo* fi = files[i];
+                    if (scheduler)
+                    {
+                        size_t end = std::min(files.size(), i + MAX_SCRIPTS_PREPARED_AHEAD);
+                        for (; numSubmitted < end; ++numSubmitted)
+                        {
+                            // Other archives may not be read from several threads
+                            if (files[numSubmitted]->archive->getType() != "FileSystem")
+                                continue;
+                            ScriptPrepareTask& task = tasks[numSubmitted];
+                            task.loader = su;
+                            task.file = files[numSubmitted];
+                            task.group = &grp->name;
+                            scheduler->submit(&task);
+                        }
+                    }
+
+                    ScriptLoader::PreparedScript* prepared = 0;
+                    if (scheduler && tasks[i].file)
+                    {
+                        scheduler->wait(&tasks[i]);
+                        prepared = tasks[i].result;
+                    }
+
                     bool skipScript = false;
-                    fireScriptStarted(fii->filename, skipScript);
+                    fireScriptStarted(fi->filename, skipScript);
                     if(skipScript)
                     {
                         LogManager::getSingleton().logMessage(
-                            "Skipping script " + fii->filename);
+                            "Skipping script " + fi->filename);
+                    }
+                    else if (prepared)
+                    {
+                        LogManager::getSingleton().logMessage(
+                            "Parsing script " + fi->filename);
+                        su->parsePreparedScript(prepared, grp->name);
                     }
                     else
                     {
                         LogManager::getSingleton().logMessage(
-                            "Parsing script " + fii->filename);
-                        DataStreamPtr stream = fii->archive->open(fii->filename);
+                            "Parsing script " + fi->filename);
+                        DataStreamPtr stream = fi->archive->open(fi->filename);
                         if (stream)
                         {
                             if (mLoadingListener)
-                                mLoadingListener->resourceStreamOpened(fii->filename, grp->name, 0, stream);
+                                mLoadingListener->resourceStreamOpened(fi->filename, grp->name, 0, stream);
 
-                            if(fii->archive->getType() == "FileSystem" && stream->size() <= 1024 * 1024)
+                            if(fi->archive->getType() == "FileSystem" && stream->size() <= 1024 * 1024)
                             {
                                 DataStreamPtr cachedCopy(OGRE_NEW MemoryDataStream(stream->getName(), stream));
                                 su->parseScript(cachedCopy, grp->name);
@@ -1033,8 +1474,24 @@ namespace Ogre {
                                 su->parseScript(stream, grp->name);
                         }
                     }
-                    fireScriptEnded(fii->filename, skipScript);
+                    fireScriptEnded(fi->filename, skipScript);
+
+                    if (prepared)
+                    {
+                        OGRE_DELETE prepared;
+                        tasks[i].result = 0;
+                    }
+                }
+            }
+            catch (...)
+            {
+                // The tasks mustn't be destroyed while still queued or running
+                for (; i < numSubmitted; ++i)
+                {
+                    if (tasks[i].file)
+                        scheduler->wait(&tasks[i]);
                 }
+                throw;
             }
         }
 
@@ -1209,14 +1666,14 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ResourceGroupManager::ResourceGroup* ResourceGroupManager::getResourceGroup(const String& name) const
     {
-        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_RW_MUTEX_READ(mLookupMutex);
         ResourceGroupMap::const_iterator i = mResourceGroupMap.find(name);
         return i != mResourceGroupMap.end() ? i->second : NULL;
     }
     //-----------------------------------------------------------------------
     ResourceManager* ResourceGroupManager::_getResourceManager(const String& resourceType) const
     {
-        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_RW_MUTEX_READ(mLookupMutex);
 
         ResourceManagerMap::const_iterator i = mResourceManagerMap.find(resourceType);
         if (i == mResourceManagerMap.end())
@@ -1587,27 +2044,33 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     Archive* ResourceGroupManager::resourceExists(ResourceGroup* grp, const String& resourceName) const
     {
+        {
+            // Only lock the indexes, the group may be busy loading
+            OGRE_LOCK_RW_MUTEX_READ(grp->indexMutex);
 
-            OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex
+            // Try indexes first
+            ResourceLocationIndex::iterator rit = grp->resourceIndexCaseSensitive.find(resourceName);
+            if (rit != grp->resourceIndexCaseSensitive.end())
+            {
+                // Found in the index
+                return rit->second;
+            }
 
-        // Try indexes first
-        ResourceLocationIndex::iterator rit = grp->resourceIndexCaseSensitive.find(resourceName);
-        if (rit != grp->resourceIndexCaseSensitive.end())
-        {
-            // Found in the index
-            return rit->second;
+#if !OGRE_RESOURCEMANAGER_STRICT
+            // try case insensitive
+            String lcResourceName = resourceName;
+            StringUtil::toLowerCase(lcResourceName);
+            rit = grp->resourceIndexCaseInsensitive.find(lcResourceName);
+            if (rit != grp->resourceIndexCaseInsensitive.end())
+            {
+                // Found in the index
+                return rit->second;
+            }
+#endif
         }
 
 #if !OGRE_RESOURCEMANAGER_STRICT
-        // try case insensitive
-        String lcResourceName = resourceName;
-        StringUtil::toLowerCase(lcResourceName);
-        rit = grp->resourceIndexCaseInsensitive.find(lcResourceName);
-        if (rit != grp->resourceIndexCaseInsensitive.end())
-        {
-            // Found in the index
-            return rit->second;
-        }
+        OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME); // lock group mutex
 
         // Search the hard way
         LocationList::iterator li, liend;
@@ -1843,6 +2306,7 @@ namespace Ogre {
     void ResourceGroupManager::ResourceGroup::addToIndex(const String& filename, Archive* arch)
     {
         // internal, assumes mutex lock has already been obtained
+        OGRE_LOCK_RW_MUTEX_WRITE(indexMutex);
         this->resourceIndexCaseSensitive[filename] = arch;
 
 #if !OGRE_RESOURCEMANAGER_STRICT
@@ -1858,6 +2322,7 @@ namespace Ogre {
     void ResourceGroupManager::ResourceGroup::removeFromIndex(const String& filename, Archive* arch)
     {
         // internal, assumes mutex lock has already been obtained
+        OGRE_LOCK_RW_MUTEX_WRITE(indexMutex);
         ResourceLocationIndex::iterator i = this->resourceIndexCaseSensitive.find(filename);
         if (i != this->resourceIndexCaseSensitive.end() && i->second == arch)
             this->resourceIndexCaseSensitive.erase(i);
@@ -1876,6 +2341,7 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void ResourceGroupManager::ResourceGroup::removeFromIndex(Archive* arch)
     {
+        OGRE_LOCK_RW_MUTEX_WRITE(indexMutex);
         // Delete indexes
         ResourceLocationIndex::iterator rit, ritend;
 #if !OGRE_RESOURCEMANAGER_STRICT
@@ -69,10 +69,15 @@ namespace Ogre {
         bool isManual, ManualResourceLoader* loader, 
         const NameValuePairList* params)
     {
+        // Usually the resource exists already, which only needs a lookup
+        ResourcePtr res = getResourceByName(name, group);
+        if (res)
+            return ResourceCreateOrRetrieveResult(res, false);
+
         // Lock for the whole get / insert
-            OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_AUTO_MUTEX;
 
-        ResourcePtr res = getResourceByName(name, group);
+        res = getResourceByName(name, group);
         bool created = false;
         if (!res)
         {
@@ -108,24 +113,28 @@ namespace Ogre {
     {
             OGRE_LOCK_AUTO_MUTEX;
 
-            std::pair<ResourceMap::iterator, bool> result;
-        if(ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(res->getGroup()))
+        bool inGlobalPool = ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(res->getGroup());
+        std::pair<ResourceMap::iterator, bool> result;
         {
-            result = mResources.insert( ResourceMap::value_type( res->getName(), res ) );
-        }
-        else
-        {
-            ResourceWithGroupMap::iterator itGroup = mResourcesWithGroup.find(res->getGroup());
-
-            // we will create the group if it doesn't exists in our list
-            if( itGroup == mResourcesWithGroup.end())
+            OGRE_LOCK_RW_MUTEX_WRITE(mResourcesMutex);
+            if(inGlobalPool)
             {
-                ResourceMap dummy;
-                mResourcesWithGroup.insert( ResourceWithGroupMap::value_type( res->getGroup(), dummy ) );
-                itGroup = mResourcesWithGroup.find(res->getGroup());
+                result = mResources.insert( ResourceMap::value_type( res->getName(), res ) );
             }
-            result = itGroup->second.insert( ResourceMap::value_type( res->getName(), res ) );
+            else
+            {
+                ResourceWithGroupMap::iterator itGroup = mResourcesWithGroup.find(res->getGroup());
+
+                // we will create the group if it doesn't exists in our list
+                if( itGroup == mResourcesWithGroup.end())
+                {
+                    ResourceMap dummy;
+                    mResourcesWithGroup.insert( ResourceWithGroupMap::value_type( res->getGroup(), dummy ) );
+                    itGroup = mResourcesWithGroup.find(res->getGroup());
+                }
+                result = itGroup->second.insert( ResourceMap::value_type( res->getName(), res ) );
 
+            }
         }
 
         // Attempt to resolve the collision
@@ -139,7 +148,8 @@ namespace Ogre {
             }
 
             // Try to do the addition again, no seconds attempts to resolve collisions are allowed
-            if(ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(res->getGroup()))
+            OGRE_LOCK_RW_MUTEX_WRITE(mResourcesMutex);
+            if(inGlobalPool)
             {
                 result = mResources.insert( ResourceMap::value_type( res->getName(), res ) );
             }
@@ -157,8 +167,11 @@ namespace Ogre {
         }
 
         // Insert the handle
-        std::pair<ResourceHandleMap::iterator, bool> resultHandle =
-            mResourcesByHandle.insert( ResourceHandleMap::value_type( res->getHandle(), res ) );
+        std::pair<ResourceHandleMap::iterator, bool> resultHandle;
+        {
+            OGRE_LOCK_RW_MUTEX_WRITE(mResourcesMutex);
+            resultHandle = mResourcesByHandle.insert( ResourceHandleMap::value_type( res->getHandle(), res ) );
+        }
         if (!resultHandle.second)
         {
             OGRE_EXCEPT(Exception::ERR_DUPLICATE_ITEM, "Resource with the handle " +
@@ -173,36 +186,40 @@ namespace Ogre {
 
         OGRE_LOCK_AUTO_MUTEX;
 
-        if(ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(res->getGroup()))
+        bool inGlobalPool = ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(res->getGroup());
         {
-            ResourceMap::iterator nameIt = mResources.find(res->getName());
-            if (nameIt != mResources.end())
+            OGRE_LOCK_RW_MUTEX_WRITE(mResourcesMutex);
+            if(inGlobalPool)
             {
-                mResources.erase(nameIt);
+                ResourceMap::iterator nameIt = mResources.find(res->getName());
+                if (nameIt != mResources.end())
+                {
+                    mResources.erase(nameIt);
+                }
             }
-        }
-        else
-        {
-            ResourceWithGroupMap::iterator groupIt = mResourcesWithGroup.find(res->getGroup());
-            if (groupIt != mResourcesWithGroup.end())
+            else
             {
-                ResourceMap::iterator nameIt = groupIt->second.find(res->getName());
-                if (nameIt != groupIt->second.end())
+                ResourceWithGroupMap::iterator groupIt = mResourcesWithGroup.find(res->getGroup());
+                if (groupIt != mResourcesWithGroup.end())
                 {
-                    groupIt->second.erase(nameIt);
-                }
+                    ResourceMap::iterator nameIt = groupIt->second.find(res->getName());
+                    if (nameIt != groupIt->second.end())
+                    {
+                        groupIt->second.erase(nameIt);
+                    }
 
-                if (groupIt->second.empty())
-                {
-                    mResourcesWithGroup.erase(groupIt);
+                    if (groupIt->second.empty())
+                    {
+                        mResourcesWithGroup.erase(groupIt);
+                    }
                 }
             }
-        }
 
-        ResourceHandleMap::iterator handleIt = mResourcesByHandle.find(res->getHandle());
-        if (handleIt != mResourcesByHandle.end())
-        {
-            mResourcesByHandle.erase(handleIt);
+            ResourceHandleMap::iterator handleIt = mResourcesByHandle.find(res->getHandle());
+            if (handleIt != mResourcesByHandle.end())
+            {
+                mResourcesByHandle.erase(handleIt);
+            }
         }
         // Tell resource group manager
         ResourceGroupManager::getSingleton()._notifyResourceRemoved(res);
@@ -333,9 +350,17 @@ namespace Ogre {
     {
             OGRE_LOCK_AUTO_MUTEX;
 
-        mResources.clear();
-        mResourcesWithGroup.clear();
-        mResourcesByHandle.clear();
+        // Keep the resources alive until after the lock is released, as
+        // destroying them may look up other resources
+        ResourceMap resources;
+        ResourceWithGroupMap resourcesWithGroup;
+        ResourceHandleMap resourcesByHandle;
+        {
+            OGRE_LOCK_RW_MUTEX_WRITE(mResourcesMutex);
+            mResources.swap(resources);
+            mResourcesWithGroup.swap(resourcesWithGroup);
+            mResourcesByHandle.swap(resourcesByHandle);
+        }
         // Notify resource group manager
         ResourceGroupManager::getSingleton()._notifyAllResourcesRemoved(this);
     }
@@ -367,11 +392,11 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ResourcePtr ResourceManager::getResourceByName(const String& name, const String& groupName /* = ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME */)
     {
-        OGRE_LOCK_AUTO_MUTEX;
-
         // resource should be in global pool
         bool isGlobal = ResourceGroupManager::getSingleton().isResourceGroupInGlobalPool(groupName);
 
+        OGRE_LOCK_RW_MUTEX_READ(mResourcesMutex);
+
         if(isGlobal)
         {
             ResourceMap::iterator it = mResources.find(name);
@@ -425,7 +450,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ResourcePtr ResourceManager::getByHandle(ResourceHandle handle)
     {
-        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_LOCK_RW_MUTEX_READ(mResourcesMutex);
         ResourceHandleMap::iterator it = mResourcesByHandle.find(handle);
         return it == mResourcesByHandle.end() ? ResourcePtr() : it->second;
     }
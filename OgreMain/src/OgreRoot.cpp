@@ -64,6 +64,8 @@ THE SOFTWARE.
 #include "OgreFrameListener.h"
 #include "OgreLodStrategyManager.h"
 #include "Threading/OgreDefaultWorkQueue.h"
+#include "Threading/OgreTaskScheduler.h"
+#include "Threading/OgreAsyncReadQueue.h"
 #include "OgreFileSystemLayer.h"
 
 #if OGRE_NO_FREEIMAGE == 0
@@ -78,6 +80,7 @@ THE SOFTWARE.
 #if OGRE_NO_ZIP_ARCHIVE == 0
 #include "OgreZip.h"
 #endif
+#include "OgrePackArchive.h"
 
 #include "OgreHardwareBufferManager.h"
 #include "OgreHighLevelGpuProgramManager.h"
@@ -183,6 +186,19 @@ namespace Ogre {
 #endif
         mWorkQueue = defaultQ;
 
+        // TaskScheduler, the thread waiting for the tasks makes up for the
+        // missing hardware thread
+        mTaskScheduler = OGRE_NEW TaskScheduler("Root");
+#if OGRE_THREAD_SUPPORT
+        mTaskScheduler->setWorkerThreadCount(threadCount - 1);
+#endif
+
+        // A few I/O threads, they mostly wait for the disk
+        mAsyncReadQueue = OGRE_NEW AsyncReadQueue("Root");
+#if OGRE_THREAD_SUPPORT
+        mAsyncReadQueue->setThreadCount(4);
+#endif
+
         // ResourceBackgroundQueue
         mResourceBackgroundQueue = OGRE_NEW ResourceBackgroundQueue();
 
@@ -222,6 +238,8 @@ namespace Ogre {
 
         mFileSystemArchiveFactory = OGRE_NEW FileSystemArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mFileSystemArchiveFactory );
+        mPackArchiveFactory = OGRE_NEW PackArchiveFactory();
+        ArchiveManager::getSingleton().addArchiveFactory( mPackArchiveFactory );
 #   if OGRE_NO_ZIP_ARCHIVE == 0
         mZipArchiveFactory = OGRE_NEW ZipArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mZipArchiveFactory );
@@ -322,6 +340,7 @@ namespace Ogre {
         OGRE_DELETE mZipArchiveFactory;
         OGRE_DELETE mEmbeddedZipArchiveFactory;
 #   endif
+        OGRE_DELETE mPackArchiveFactory;
         OGRE_DELETE mFileSystemArchiveFactory;
 
         OGRE_DELETE mSkeletonManager;
@@ -345,6 +364,8 @@ namespace Ogre {
         OGRE_DELETE mRibbonTrailFactory;
 
         OGRE_DELETE mWorkQueue;
+        OGRE_DELETE mAsyncReadQueue;
+        OGRE_DELETE mTaskScheduler;
 
         OGRE_DELETE mTimer;
 
@@ -1023,7 +1044,9 @@ namespace Ogre {
         // Since background thread might be access resources,
         // ensure shutdown before destroying resource manager.
         mResourceBackgroundQueue->shutdown();
+        mAsyncReadQueue->shutdown();
         mWorkQueue->shutdown();
+        mTaskScheduler->shutdown();
 
         SceneManagerEnumerator::getSingleton().shutdownAll();
         shutdownPlugins();
@@ -1413,6 +1436,8 @@ namespace Ogre {
             // Background loader
             mResourceBackgroundQueue->initialise();
             mWorkQueue->startup();
+            mTaskScheduler->startup();
+            mAsyncReadQueue->startup();
             // Initialise material manager
             mMaterialManager->initialise();
             // Init particle systems manager
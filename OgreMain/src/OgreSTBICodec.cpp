@@ -131,12 +131,21 @@ namespace Ogre {
     //---------------------------------------------------------------------
     Codec::DecodeResult STBIImageCodec::decode(DataStreamPtr& input) const
     {
-        // Buffer stream into memory (TODO: override IO functions instead?)
-        MemoryDataStream memStream(input, true);
+        // Decode in place if the stream is held in memory already,
+        // otherwise buffer it (TODO: override IO functions instead?)
+        const uchar* data = input->getCurrentMemoryPtr();
+        size_t dataSize = input->size() - input->tell();
+        MemoryDataStreamPtr memStream;
+        if (!data)
+        {
+            memStream.reset(OGRE_NEW MemoryDataStream(input, true));
+            data = memStream->getPtr();
+            dataSize = memStream->size();
+        }
 
         int width, height, components;
-        stbi_uc* pixelData = stbi_load_from_memory(memStream.getPtr(),
-                static_cast<int>(memStream.size()), &width, &height, &components, 0);
+        stbi_uc* pixelData = stbi_load_from_memory(data,
+                static_cast<int>(dataSize), &width, &height, &components, 0);
 
         if (!pixelData)
         {
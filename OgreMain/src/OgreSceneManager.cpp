@@ -64,6 +64,9 @@ THE SOFTWARE.
 #include "OgreLodListener.h"
 #include "OgreInstancedGeometry.h"
 #include "OgreUnifiedHighLevelGpuProgram.h"
+#include "OgreNodeTransformStorage.h"
+#include "Threading/OgreBarrier.h"
+#include "Threading/OgreTaskScheduler.h"
 
 // This class implements the most basic scene manager
 
@@ -145,6 +148,13 @@ mShadowTextureCustomCasterPass(0),
 mShadowTextureCustomReceiverPass(0),
 mVisibilityMask(0xFFFFFFFF),
 mFindVisibleObjects(true),
+mNumWorkerThreads(0),
+mWorkerThreadRequest(WTR_NONE),
+mWorkerThreadsBarrier(0),
+mCullCamera(0),
+mNodeTransformStorage(0),
+mParallelSoftwareSkinning(false),
+mSoftwareSkinningBatch(0),
 mSuppressRenderStateChanges(false),
 mSuppressShadows(false),
 mCameraRelativeRendering(false),
@@ -187,6 +197,8 @@ mGpuParamsDirty((uint16)GPV_ALL)
 //-----------------------------------------------------------------------
 SceneManager::~SceneManager()
 {
+    stopWorkerThreads();
+
     fireSceneManagerDestroyed();
     destroyShadowTextures();
     clearScene();
@@ -212,6 +224,8 @@ SceneManager::~SceneManager()
     OGRE_DELETE mShadowCasterAABBQuery;
     OGRE_DELETE mRenderQueue;
     OGRE_DELETE mAutoParamDataSource;
+    OGRE_DELETE mNodeTransformStorage;
+    OGRE_DELETE mSoftwareSkinningBatch;
 }
 //-----------------------------------------------------------------------
 RenderQueue* SceneManager::getRenderQueue(void)
@@ -1544,6 +1558,8 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
             firePreFindVisibleObjects(vp);
             _findVisibleObjects(camera, &(camVisObjIt->second),
                 mIlluminationStage == IRS_RENDER_TO_TEXTURE? true : false);
+            // Skin the entities which queued themselves while being found
+            _updateQueuedSoftwareSkinning();
             firePostFindVisibleObjects(vp);
 
             mAutoParamDataSource->setMainCamBoundsInfo(&(camVisObjIt->second));
@@ -2302,24 +2318,367 @@ void SceneManager::_updateSceneGraph(Camera* cam)
     // Process queued needUpdate calls 
     Node::processQueuedUpdates();
 
+    // Concatenate all the transforms in batches up front, the nodes
+    // then pick up their derived transforms from the storage
+    if (mNodeTransformStorage)
+        mNodeTransformStorage->update(getRootSceneNode());
+
     // Cascade down the graph updating transforms & world bounds
     // In this implementation, just update from the root
     // Smarter SceneManager subclasses may choose to update only
     //   certain scene graph branches
-    getRootSceneNode()->_update(true, false);
+    if (mNumWorkerThreads > 0)
+        updateSceneGraphParallel();
+    else
+        getRootSceneNode()->_update(true, false);
+
+    if (mNodeTransformStorage)
+        mNodeTransformStorage->_finishUpdate();
 
     firePostUpdateSceneGraph(cam);
 }
 //-----------------------------------------------------------------------
+namespace {
+    /// Subtrees with more nodes than this are split further between the threads
+    const size_t SUBTREE_SPLIT_THRESHOLD = 256;
+
+    /// Counts the nodes of the given subtree, stopping once there are more than limit
+    size_t countSubtreeNodes(Node* node, size_t limit)
+    {
+        size_t count = 1;
+        Node::ChildNodeIterator it = node->getChildIterator();
+        while (it.hasMoreElements() && count <= limit)
+            count += countSubtreeNodes(it.getNext(), limit - count);
+        return count;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphParallel(void)
+{
+    SceneNode* root = getRootSceneNode();
+
+    // Update the root itself and gather the subtrees below it, these don't
+    // share any nodes so they can be updated at the same time. Large subtrees
+    // are split the same way, so a scene with few top level nodes is still
+    // shared out evenly
+    mSubtreesToUpdate.clear();
+    mSplitNodes.clear();
+    Node::ChildUpdateList pending;
+    root->_updateSelf(false, pending);
+    mSplitNodes.push_back(root);
+    while (!pending.empty())
+    {
+        Node::ChildUpdateList::value_type subtree = pending.back();
+        pending.pop_back();
+        if (countSubtreeNodes(subtree.first, SUBTREE_SPLIT_THRESHOLD) > SUBTREE_SPLIT_THRESHOLD)
+        {
+            subtree.first->_updateSelf(subtree.second, pending);
+            mSplitNodes.push_back(static_cast<SceneNode*>(subtree.first));
+        }
+        else
+        {
+            mSubtreesToUpdate.push_back(subtree);
+        }
+    }
+
+    if (!mSubtreesToUpdate.empty())
+    {
+        Node::_setDeferUpdateCallbacks(true);
+        fireWorkerThreadsAndWait(WTR_UPDATE_SCENE_GRAPH);
+        Node::_setDeferUpdateCallbacks(false);
+
+        // Raise the listener events the worker threads skipped
+        Node::processDeferredUpdates();
+    }
+
+    // Finish what SceneNode::_update would have done for the split nodes,
+    // children before their parents
+    for (vector<SceneNode*>::type::reverse_iterator i = mSplitNodes.rbegin(); i != mSplitNodes.rend(); ++i)
+    {
+        (*i)->_updateBounds();
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSubtreesThread(size_t threadIdx)
+{
+    // Static, contiguous partitioning keeps the work of each thread deterministic
+    const size_t numThreads = mNumWorkerThreads + 1;
+    const size_t numSubtrees = mSubtreesToUpdate.size();
+    const size_t begin = (numSubtrees * threadIdx) / numThreads;
+    const size_t end = (numSubtrees * (threadIdx + 1)) / numThreads;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        mSubtreesToUpdate[i].first->_update(true, mSubtreesToUpdate[i].second);
+    }
+}
+//-----------------------------------------------------------------------
+unsigned long updateWorkerThread(ThreadHandle* threadHandle)
+{
+    SceneManager* sceneManager = reinterpret_cast<SceneManager*>(threadHandle->getUserParam());
+    return sceneManager->_updateWorkerThread(threadHandle);
+}
+THREAD_DECLARE(updateWorkerThread);
+//-----------------------------------------------------------------------
+void SceneManager::setNumWorkerThreads(size_t numThreads)
+{
+#if OGRE_THREAD_SUPPORT == 0
+    // Without thread support the mutexes compile away, so stay serial
+    numThreads = 0;
+#endif
+    if (numThreads == mNumWorkerThreads)
+        return;
+
+    stopWorkerThreads();
+    mNumWorkerThreads = numThreads;
+    startWorkerThreads();
+}
+//-----------------------------------------------------------------------
+void SceneManager::setNodeTransformStorageEnabled(bool enabled)
+{
+    if (enabled == isNodeTransformStorageEnabled())
+        return;
+
+    if (enabled)
+    {
+        // Laid out on the next update
+        mNodeTransformStorage = OGRE_NEW NodeTransformStorage();
+    }
+    else
+    {
+        OGRE_DELETE mNodeTransformStorage;
+        mNodeTransformStorage = 0;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::setParallelSoftwareSkinningEnabled(bool enabled)
+{
+    if (enabled == mParallelSoftwareSkinning)
+        return;
+
+    if (enabled)
+    {
+        mSoftwareSkinningBatch = OGRE_NEW SoftwareVertexBlendBatch();
+    }
+    else
+    {
+        // Don't leave anything half done
+        _updateQueuedSoftwareSkinning();
+        OGRE_DELETE mSoftwareSkinningBatch;
+        mSoftwareSkinningBatch = 0;
+    }
+    mParallelSoftwareSkinning = enabled;
+}
+//-----------------------------------------------------------------------
+void SceneManager::_queueSoftwareSkinning(Entity* entity)
+{
+    mSoftwareSkinningQueue.push_back(entity);
+}
+//-----------------------------------------------------------------------
+namespace {
+    /// Skins a range of the queued entities, for TaskScheduler::parallelFor
+    struct SoftwareSkinningRange
+    {
+        Entity* const* entities;
+        SoftwareVertexBlendBatch* batch;
+
+        void operator()(size_t begin, size_t end) const
+        {
+            for (size_t i = begin; i < end; ++i)
+                entities[i]->_updateQueuedSoftwareSkinning(*batch);
+        }
+    };
+}
+//-----------------------------------------------------------------------
+void SceneManager::_updateQueuedSoftwareSkinning(void)
+{
+    if (mSoftwareSkinningQueue.empty())
+        return;
+
+    // Lock all the buffers up front, which has to happen on this thread
+    mSoftwareSkinningBatch->lock();
+    SoftwareSkinningRange range = { &mSoftwareSkinningQueue[0], mSoftwareSkinningBatch };
+    TaskScheduler* scheduler = Root::getSingleton().getTaskScheduler();
+    if (scheduler)
+    {
+        // An entity at a time, they vary a lot in size
+        scheduler->parallelFor(0, mSoftwareSkinningQueue.size(), 1, range);
+    }
+    else
+    {
+        range(0, mSoftwareSkinningQueue.size());
+    }
+    // Uploads the results
+    mSoftwareSkinningBatch->unlock();
+
+    mSoftwareSkinningQueue.clear();
+}
+//-----------------------------------------------------------------------
+void SceneManager::startWorkerThreads(void)
+{
+    if (mNumWorkerThreads == 0)
+        return;
+
+    // The main thread takes part in every request too
+    mWorkerThreadsBarrier = new Barrier(mNumWorkerThreads + 1);
+    mWorkerThreads.reserve(mNumWorkerThreads);
+    for (size_t i = 0; i < mNumWorkerThreads; ++i)
+    {
+        mWorkerThreads.push_back(Threads::CreateThread(THREAD_GET(updateWorkerThread), i, this));
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::stopWorkerThreads(void)
+{
+    if (mWorkerThreadsBarrier)
+    {
+        mWorkerThreadRequest = WTR_SHUTDOWN;
+        mWorkerThreadsBarrier->sync();
+        Threads::WaitForThreads(mWorkerThreads);
+        mWorkerThreadRequest = WTR_NONE;
+
+        delete mWorkerThreadsBarrier;
+        mWorkerThreadsBarrier = 0;
+        mWorkerThreads.clear();
+    }
+    mNumWorkerThreads = 0;
+}
+//-----------------------------------------------------------------------
+void SceneManager::fireWorkerThreadsAndWait(WorkerThreadRequest request)
+{
+    mWorkerThreadRequest = request;
+
+    // Wake up the workers, do our own share and wait for everyone to finish
+    mWorkerThreadsBarrier->sync();
+    executeWorkerThreadRequest(mNumWorkerThreads);
+    mWorkerThreadsBarrier->sync();
+
+    mWorkerThreadRequest = WTR_NONE;
+}
+//-----------------------------------------------------------------------
+void SceneManager::executeWorkerThreadRequest(size_t threadIdx)
+{
+    switch (mWorkerThreadRequest)
+    {
+    case WTR_UPDATE_SCENE_GRAPH:
+        updateSubtreesThread(threadIdx);
+        break;
+    case WTR_FIND_VISIBLE_OBJECTS:
+        findVisibleObjectsThread(threadIdx);
+        break;
+    default:
+        break;
+    }
+}
+//-----------------------------------------------------------------------
+unsigned long SceneManager::_updateWorkerThread(ThreadHandle* threadHandle)
+{
+    const size_t threadIdx = threadHandle->getThreadIdx();
+
+    while (true)
+    {
+        mWorkerThreadsBarrier->sync();
+        if (mWorkerThreadRequest == WTR_SHUTDOWN)
+            break;
+
+        executeWorkerThreadRequest(threadIdx);
+        mWorkerThreadsBarrier->sync();
+    }
+
+    return 0;
+}
+//-----------------------------------------------------------------------
 void SceneManager::_findVisibleObjects(
     Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
 {
+    if (mNumWorkerThreads > 0)
+    {
+        findVisibleObjectsParallel(cam, visibleBounds, onlyShadowCasters);
+        return;
+    }
+
     // Tell nodes to find, cascade down all nodes
     getRootSceneNode()->_findVisibleObjects(cam, getRenderQueue(), visibleBounds, true, 
         mDisplayNodes, onlyShadowCasters);
 
 }
 //-----------------------------------------------------------------------
+void SceneManager::findVisibleObjectsParallel(
+    Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+{
+    SceneNode* root = getRootSceneNode();
+    if (!cam->isVisible(root->_getWorldAABB()))
+        return;
+
+    // Make any pending updates to the frustum planes before the worker threads read them
+    cam->getFrustumPlane(FRUSTUM_PLANE_NEAR);
+
+    // Gather the subtrees below the root, splitting large ones the same way
+    // updateSceneGraphParallel does. The split nodes are tested here and only
+    // their own objects are queued, their children are culled as subtrees
+    mSubtreesToCull.clear();
+    mSplitNodes.clear();
+    mSplitNodes.push_back(root);
+    VisibleNodeList pending;
+    SceneNode::ChildNodeIterator it = root->getChildIterator();
+    while (it.hasMoreElements())
+        pending.push_back(static_cast<SceneNode*>(it.getNext()));
+    while (!pending.empty())
+    {
+        SceneNode* subtree = pending.back();
+        pending.pop_back();
+        if (countSubtreeNodes(subtree, SUBTREE_SPLIT_THRESHOLD) > SUBTREE_SPLIT_THRESHOLD)
+        {
+            if (!cam->isVisible(subtree->_getWorldAABB()))
+                continue;
+            mSplitNodes.push_back(subtree);
+            SceneNode::ChildNodeIterator child = subtree->getChildIterator();
+            while (child.hasMoreElements())
+                pending.push_back(static_cast<SceneNode*>(child.getNext()));
+        }
+        else
+        {
+            mSubtreesToCull.push_back(subtree);
+        }
+    }
+
+    mVisibleNodesPerThread.resize(mNumWorkerThreads + 1);
+    mCullCamera = cam;
+    fireWorkerThreadsAndWait(WTR_FIND_VISIBLE_OBJECTS);
+    mCullCamera = 0;
+
+    // Queueing touches shared state, so merge on this thread
+    RenderQueue* queue = getRenderQueue();
+    for (VisibleNodeList::iterator n = mSplitNodes.begin(); n != mSplitNodes.end(); ++n)
+    {
+        (*n)->_addVisibleObjectsToQueue(cam, queue, visibleBounds, mDisplayNodes, onlyShadowCasters);
+    }
+    for (size_t i = 0; i < mVisibleNodesPerThread.size(); ++i)
+    {
+        VisibleNodeList& visibleNodes = mVisibleNodesPerThread[i];
+        for (VisibleNodeList::iterator n = visibleNodes.begin(); n != visibleNodes.end(); ++n)
+        {
+            (*n)->_addVisibleObjectsToQueue(cam, queue, visibleBounds, mDisplayNodes, onlyShadowCasters);
+        }
+        visibleNodes.clear();
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::findVisibleObjectsThread(size_t threadIdx)
+{
+    // Same static partitioning as updateSubtreesThread
+    const size_t numThreads = mNumWorkerThreads + 1;
+    const size_t numSubtrees = mSubtreesToCull.size();
+    const size_t begin = (numSubtrees * threadIdx) / numThreads;
+    const size_t end = (numSubtrees * (threadIdx + 1)) / numThreads;
+
+    VisibleNodeList& visibleNodes = mVisibleNodesPerThread[threadIdx];
+    for (size_t i = begin; i < end; ++i)
+    {
+        mSubtreesToCull[i]->_findVisibleNodes(mCullCamera, visibleNodes);
+    }
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderVisibleObjects(void)
 {
     RenderQueueInvocationSequence* invocationSequence = 
@@ -6785,6 +7144,7 @@ void SceneManager::destroyInstancedEntity( InstancedEntity *instancedEntity )
 //---------------------------------------------------------------------
 void SceneManager::_addDirtyInstanceManager( InstanceManager *dirtyManager )
 {
+    OGRE_LOCK_MUTEX( mDirtyInstanceManagersMutex );
     mDirtyInstanceManagers.push_back( dirtyManager );
 }
 //---------------------------------------------------------------------
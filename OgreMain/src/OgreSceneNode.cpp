@@ -317,6 +317,44 @@ namespace Ogre {
 
     }
 
+    //-----------------------------------------------------------------------
+    void SceneNode::_findVisibleNodes(Camera* cam, VisibleNodeList& visibleNodes)
+    {
+        if (!cam->isVisible(mWorldAABB))
+            return;
+
+        visibleNodes.push_back(this);
+
+        ChildNodeMap::iterator child, childend;
+        childend = mChildren.end();
+        for (child = mChildren.begin(); child != childend; ++child)
+        {
+            static_cast<SceneNode*>(child->second)->_findVisibleNodes(cam, visibleNodes);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SceneNode::_addVisibleObjectsToQueue(Camera* cam, RenderQueue* queue,
+        VisibleObjectsBoundsInfo* visibleBounds, bool displayNodes, bool onlyShadowCasters)
+    {
+        ObjectMap::iterator iobj;
+        ObjectMap::iterator iobjend = mObjectsByName.end();
+        for (iobj = mObjectsByName.begin(); iobj != iobjend; ++iobj)
+        {
+            queue->processVisibleObject(iobj->second, cam, onlyShadowCasters, visibleBounds);
+        }
+
+        if (displayNodes)
+        {
+            queue->addRenderable(getDebugRenderable());
+        }
+
+        if ( !mHideBoundingBox &&
+             (mShowBoundingBox || (mCreator && mCreator->getShowBoundingBoxes())) )
+        {
+            _addBoundingBoxToQueue(queue);
+        }
+    }
+    //-----------------------------------------------------------------------
     Node::DebugRenderable* SceneNode::getDebugRenderable()
     {
         Vector3 hs = mWorldAABB.getHalfSize();
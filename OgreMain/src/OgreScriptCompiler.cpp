@@ -32,6 +32,11 @@ THE SOFTWARE.
 #include "OgreScriptTranslator.h"
 #include "OgreLogManager.h"
 #include "OgreResourceGroupManager.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreMurmurHash3.h"
+
+#include <fstream>
+#include <new>
 
 namespace Ogre
 {
@@ -275,13 +280,23 @@ namespace Ogre
     }
 
     ScriptCompiler::ScriptCompiler()
-        :mListener(0)
+        :mDeferErrors(false), mListener(0)
     {
         initWordMap();
     }
 
     bool ScriptCompiler::compile(const String &str, const String &source, const String &group)
     {
+        // Without a listener to pass the CST to, the script is parsed
+        // straight to an AST. The cache holds the AST from after the steps
+        // the listener can change too.
+        if(!mListener)
+        {
+            ParsedScript script;
+            _parse(str, source, group, script);
+            return _compileParsed(script, group);
+        }
+
         ConcreteNodeListPtr nodes = ScriptParser::parse(ScriptLexer::tokenize(str, source));
         return compile(nodes, group);
     }
@@ -354,13 +369,108 @@ namespace Ogre
 
         // Convert our nodes to an AST
         AbstractNodeListPtr ast = convertToAST(nodes);
+        processAST(ast);
+        return translateAST(ast);
+    }
+
+    void ScriptCompiler::_parse(const String &str, const String &source, const String &group, ParsedScript &script)
+    {
+        mGroup = group;
+        mErrors.clear();
+        mEnv.clear();
+
+        if(!mCacheDirectory.empty())
+        {
+            script.source = source;
+            MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), 0, script.checksum);
+            script.nodes = readCache(source, script.checksum, script.imports);
+            if(script.nodes)
+            {
+                // The imports are checked by _compileParsed, as opening
+                // resources here could block on the thread waiting for us
+                script.cached = true;
+                script.text = str;
+                return;
+            }
+        }
+
+        mDeferErrors = true;
+        try
+        {
+            script.nodes = convertToAST(str, source);
+        }
+        catch(...)
+        {
+            mDeferErrors = false;
+            throw;
+        }
+        mDeferErrors = false;
+
+        script.env.swap(mEnv);
+        script.errors.swap(mErrors);
+    }
+
+    bool ScriptCompiler::_compileParsed(ParsedScript &script, const String &group)
+    {
+        mGroup = group;
+        mErrors.clear();
+        mEnv.swap(script.env);
+
+        // Report the errors now, in script order
+        for(ErrorList::iterator i = script.errors.begin(); i != script.errors.end(); ++i)
+        {
+            reportError(**i);
+            mErrors.push_back(*i);
+        }
+
+        if(script.cached && !checkImports(script.imports))
+        {
+            // An imported script has changed, the entry is out of date
+            script.cached = false;
+            script.nodes = convertToAST(script.text, script.source);
+        }
+
+        if(!script.cached)
+        {
+            processAST(script.nodes);
+            if(!script.source.empty() && !mCacheDirectory.empty() && mErrors.empty())
+                writeCache(script.source, script.checksum, *script.nodes);
+        }
+        return translateAST(script.nodes);
+    }
+
+    bool ScriptCompiler::_buildCache(const String &str, const String &source, const String &group)
+    {
+        mGroup = group;
+        mErrors.clear();
+        mEnv.clear();
+
+        uint64 checksum[2];
+        MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), 0, checksum);
+        AbstractNodeListPtr ast = convertToAST(str, source);
+        processAST(ast);
+        bool cached = mErrors.empty() && writeCache(source, checksum, *ast);
+
+        mImports.clear();
+        mImportRequests.clear();
+        mImportTable.clear();
+
+        return cached;
+    }
+
+    void ScriptCompiler::processAST(AbstractNodeListPtr &ast)
+    {
+        mImportChecksums.clear();
         // Processes the imports for this script
         processImports(ast);
         // Process object inheritance
         processObjects(ast.get(), ast);
         // Process variable expansion
         processVariables(ast.get());
+    }
 
+    bool ScriptCompiler::translateAST(const AbstractNodeListPtr &ast)
+    {
         // Allows early bail-out through the listener
         if(mListener && !mListener->postConversion(this, ast))
             return mErrors.empty();
@@ -451,21 +561,27 @@ namespace Ogre
         err->line = line;
         err->message = msg;
 
+        if(!mDeferErrors)
+            reportError(*err);
+
+        mErrors.push_back(err);
+    }
+
+    void ScriptCompiler::reportError(const Error &err)
+    {
         if(mListener)
         {
-            mListener->handleError(this, code, file, line, msg);
+            mListener->handleError(this, err.code, err.file, err.line, err.message);
         }
         else
         {
             Ogre::String str = "Compiler error: ";
-            str = str + formatErrorCode(code) + " in " + file + "(" +
-                Ogre::StringConverter::toString(line) + ")";
-            if(!msg.empty())
-                str = str + ": " + msg;
+            str = str + formatErrorCode(err.code) + " in " + err.file + "(" +
+                Ogre::StringConverter::toString(err.line) + ")";
+            if(!err.message.empty())
+                str = str + ": " + err.message;
             Ogre::LogManager::getSingleton().logMessage(str, LML_CRITICAL);
         }
-
-        mErrors.push_back(err);
     }
 
     void ScriptCompiler::setListener(ScriptCompilerListener *listener)
@@ -483,6 +599,472 @@ namespace Ogre
         return mGroup;
     }
 
+    void ScriptCompiler::setCacheDirectory(const String &path)
+    {
+        mCacheDirectory = path;
+    }
+
+    const String &ScriptCompiler::getCacheDirectory() const
+    {
+        return mCacheDirectory;
+    }
+
+    namespace
+    {
+        /// Identifies script cache entries, "SCH1"
+        const uint32 SCRIPT_CACHE_ID = 0x53434831;
+
+        /** Writes ASTs in the format of the script cache.
+        @remarks
+            Every string is stored once in a table, which is written before
+            the nodes referring to it by index.
+        */
+        class ScriptCacheWriter
+        {
+        public:
+            ScriptCacheWriter() : mFailed(false) {}
+
+            void writeNodes(const AbstractNodeList &nodes)
+            {
+                writeUInt(static_cast<uint32>(nodes.size()));
+                for(AbstractNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+                    writeNode(**i);
+            }
+
+            /// Writes the string table and the nodes written so far
+            void finish(const DataStreamPtr &stream) const
+            {
+                uint32 numStrings = static_cast<uint32>(mStrings.size());
+                stream->write(&numStrings, sizeof(numStrings));
+                for(uint32 i = 0; i < numStrings; ++i)
+                {
+                    uint32 length = static_cast<uint32>(mStrings[i]->size());
+                    stream->write(&length, sizeof(length));
+                    stream->write(mStrings[i]->data(), length);
+                }
+                if(!mData.empty())
+                    stream->write(&mData[0], mData.size());
+            }
+
+            /// Whether a node couldn't be written, as its type isn't supported
+            bool hasFailed() const { return mFailed; }
+
+        private:
+            typedef map<String,uint32>::type StringIndexMap;
+            StringIndexMap mStringIndices;
+            vector<const String*>::type mStrings;
+            vector<uint8>::type mData;
+            bool mFailed;
+
+            void writeUInt(uint32 value)
+            {
+                const uint8 *bytes = reinterpret_cast<const uint8*>(&value);
+                mData.insert(mData.end(), bytes, bytes + sizeof(value));
+            }
+
+            void writeString(const String &str)
+            {
+                std::pair<StringIndexMap::iterator,bool> entry =
+                    mStringIndices.insert(std::make_pair(str, static_cast<uint32>(mStrings.size())));
+                if(entry.second)
+                    mStrings.push_back(&entry.first->first);
+                writeUInt(entry.first->second);
+            }
+
+            void writeNode(const AbstractNode &node)
+            {
+                mData.push_back(static_cast<uint8>(node.type));
+                writeString(node.file);
+                writeUInt(node.line);
+                switch(node.type)
+                {
+                case ANT_ATOM:
+                    writeString(static_cast<const AtomAbstractNode&>(node).value);
+                    break;
+                case ANT_OBJECT:
+                    {
+                        const ObjectAbstractNode &obj = static_cast<const ObjectAbstractNode&>(node);
+                        writeString(obj.name);
+                        writeString(obj.cls);
+                        writeUInt(static_cast<uint32>(obj.bases.size()));
+                        for(vector<String>::type::const_iterator i = obj.bases.begin(); i != obj.bases.end(); ++i)
+                            writeString(*i);
+                        mData.push_back(obj.abstract ? 1 : 0);
+                        const map<String,String>::type &vars = obj.getVariables();
+                        writeUInt(static_cast<uint32>(vars.size()));
+                        for(map<String,String>::type::const_iterator i = vars.begin(); i != vars.end(); ++i)
+                        {
+                            writeString(i->first);
+                            writeString(i->second);
+                        }
+                        writeNodes(obj.values);
+                        writeNodes(obj.children);
+                    }
+                    break;
+                case ANT_PROPERTY:
+                    {
+                        const PropertyAbstractNode &prop = static_cast<const PropertyAbstractNode&>(node);
+                        writeString(prop.name);
+                        writeNodes(prop.values);
+                    }
+                    break;
+                case ANT_IMPORT:
+                    writeString(static_cast<const ImportAbstractNode&>(node).target);
+                    writeString(static_cast<const ImportAbstractNode&>(node).source);
+                    break;
+                case ANT_VARIABLE_ACCESS:
+                    writeString(static_cast<const VariableAccessAbstractNode&>(node).name);
+                    break;
+                default:
+                    mFailed = true;
+                }
+            }
+        };
+
+        /** Reads ASTs written by ScriptCacheWriter.
+        @remarks
+            Word ids aren't stored, they are looked up again like the
+            AbstractTreeBuilder does, so entries stay valid when custom words
+            are registered.
+        */
+        class ScriptCacheReader
+        {
+        public:
+            ScriptCacheReader(const uint8 *data, size_t size, const ScriptCompiler::IdMap &ids)
+                : mPos(data), mEnd(data + size), mFailed(false)
+            {
+                uint32 numStrings = readUInt();
+                if(numStrings > size)
+                    mFailed = true;
+                else
+                {
+                    mStrings.resize(numStrings);
+                    mIds.resize(numStrings, 0);
+                }
+                for(uint32 i = 0; i < numStrings && !mFailed; ++i)
+                {
+                    uint32 length = readUInt();
+                    if(length > static_cast<size_t>(mEnd - mPos))
+                    {
+                        mFailed = true;
+                        break;
+                    }
+                    mStrings[i].assign(reinterpret_cast<const char*>(mPos), length);
+                    mPos += length;
+                    ScriptCompiler::IdMap::const_iterator id = ids.find(mStrings[i]);
+                    if(id != ids.end())
+                        mIds[i] = id->second;
+                }
+            }
+
+            void readNodes(AbstractNodeList &nodes, AbstractNode *parent)
+            {
+                uint32 count = readUInt();
+                for(uint32 i = 0; i < count && !mFailed; ++i)
+                {
+                    AbstractNode *node = readNode(parent);
+                    if(node)
+                        nodes.push_back(AbstractNodePtr(node));
+                }
+            }
+
+            /// Whether the data was cut short or corrupt, or has data left over
+            bool hasFailed() const { return mFailed || mPos != mEnd; }
+
+        private:
+            const uint8 *mPos, *mEnd;
+            vector<String>::type mStrings;
+            vector<uint32>::type mIds;
+            bool mFailed;
+
+            uint8 readByte()
+            {
+                if(mPos == mEnd)
+                {
+                    mFailed = true;
+                    return 0;
+                }
+                return *mPos++;
+            }
+
+            uint32 readUInt()
+            {
+                uint32 value = 0;
+                if(static_cast<size_t>(mEnd - mPos) < sizeof(value))
+                    mFailed = true;
+                else
+                {
+                    memcpy(&value, mPos, sizeof(value));
+                    mPos += sizeof(value);
+                }
+                return value;
+            }
+
+            uint32 readStringIndex()
+            {
+                uint32 index = readUInt();
+                if(index >= mStrings.size())
+                {
+                    mFailed = true;
+                    return 0;
+                }
+                return index;
+            }
+
+            const String &readString()
+            {
+                if(mStrings.empty())
+                {
+                    mFailed = true;
+                    return BLANKSTRING;
+                }
+                return mStrings[readStringIndex()];
+            }
+
+            AbstractNode *readNode(AbstractNode *parent)
+            {
+                uint8 type = readByte();
+                const String &file = readString();
+                uint32 line = readUInt();
+
+                AbstractNode *node = 0;
+                switch(type)
+                {
+                case ANT_ATOM:
+                    {
+                        AtomAbstractNode *atom = OGRE_NEW AtomAbstractNode(parent);
+                        uint32 index = readStringIndex();
+                        atom->value = mStrings.empty() ? BLANKSTRING : mStrings[index];
+                        atom->id = mIds.empty() ? 0 : mIds[index];
+                        node = atom;
+                    }
+                    break;
+                case ANT_OBJECT:
+                    {
+                        ObjectAbstractNode *obj = OGRE_NEW ObjectAbstractNode(parent);
+                        node = obj;
+                        obj->name = readString();
+                        uint32 index = readStringIndex();
+                        obj->cls = mStrings.empty() ? BLANKSTRING : mStrings[index];
+                        obj->id = mIds.empty() ? 0 : mIds[index];
+                        uint32 numBases = readUInt();
+                        for(uint32 i = 0; i < numBases && !mFailed; ++i)
+                            obj->bases.push_back(readString());
+                        obj->abstract = readByte() != 0;
+                        uint32 numVars = readUInt();
+                        for(uint32 i = 0; i < numVars && !mFailed; ++i)
+                        {
+                            const String &name = readString();
+                            obj->setVariable(name, readString());
+                        }
+                        readNodes(obj->values, obj);
+                        readNodes(obj->children, obj);
+                    }
+                    break;
+                case ANT_PROPERTY:
+                    {
+                        PropertyAbstractNode *prop = OGRE_NEW PropertyAbstractNode(parent);
+                        node = prop;
+                        uint32 index = readStringIndex();
+                        prop->name = mStrings.empty() ? BLANKSTRING : mStrings[index];
+                        prop->id = mIds.empty() ? 0 : mIds[index];
+                        readNodes(prop->values, prop);
+                    }
+                    break;
+                case ANT_IMPORT:
+                    {
+                        ImportAbstractNode *import = OGRE_NEW ImportAbstractNode();
+                        import->parent = parent;
+                        node = import;
+                        import->target = readString();
+                        import->source = readString();
+                    }
+                    break;
+                case ANT_VARIABLE_ACCESS:
+                    {
+                        VariableAccessAbstractNode *var = OGRE_NEW VariableAccessAbstractNode(parent);
+                        node = var;
+                        var->name = readString();
+                    }
+                    break;
+                default:
+                    mFailed = true;
+                    return 0;
+                }
+
+                node->file = file;
+                node->line = line;
+                return node;
+            }
+        };
+    }
+
+    String ScriptCompiler::getCachePath(const String &source) const
+    {
+        // The base name keeps the cache readable, the hash of the full name
+        // tells scripts from different directories or groups apart
+        String baseName, path;
+        StringUtil::splitFilename(source, baseName, path);
+        String key = mGroup + "/" + source;
+        uint32 hash = FastHash(key.c_str(), static_cast<int>(key.size()));
+
+        String dir = mCacheDirectory;
+        if(!StringUtil::endsWith(dir, "/", false) && !StringUtil::endsWith(dir, "\\", false))
+            dir += "/";
+        char hashString[9];
+        sprintf(hashString, "%08x", hash);
+        return dir + baseName + "." + hashString + ".scriptcache";
+    }
+
+    AbstractNodeListPtr ScriptCompiler::readCache(const String &source, const uint64 checksum[2], ImportChecksumMap &imports)
+    {
+        String path = getCachePath(source);
+        if(!FileSystemLayer::fileExists(path))
+            return AbstractNodeListPtr();
+
+        MemoryDataStreamPtr entry;
+        try
+        {
+            std::ifstream *file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)();
+            file->open(path.c_str(), std::ios::in | std::ios::binary);
+            DataStreamPtr fileStream(OGRE_NEW FileStreamDataStream(path, file, true));
+            entry = MemoryDataStreamPtr(OGRE_NEW MemoryDataStream(fileStream));
+        }
+        catch(Exception &e)
+        {
+            LogManager::getSingleton().logMessage(
+                "ScriptCompiler: Cannot open script cache entry " + path + ": " + e.getDescription());
+            return AbstractNodeListPtr();
+        }
+
+        uint32 header[2];
+        uint64 entryChecksum[2];
+        if(entry->read(header, sizeof(header)) != sizeof(header) ||
+            header[0] != SCRIPT_CACHE_ID || header[1] != OGRE_VERSION ||
+            entry->read(entryChecksum, sizeof(entryChecksum)) != sizeof(entryChecksum) ||
+            entryChecksum[0] != checksum[0] || entryChecksum[1] != checksum[1])
+        {
+            return AbstractNodeListPtr();
+        }
+
+        uint32 numImports;
+        if(entry->read(&numImports, sizeof(numImports)) != sizeof(numImports))
+            return AbstractNodeListPtr();
+        imports.clear();
+        for(uint32 i = 0; i < numImports; ++i)
+        {
+            uint32 length;
+            if(entry->read(&length, sizeof(length)) != sizeof(length) ||
+                length > entry->size() - entry->tell())
+            {
+                return AbstractNodeListPtr();
+            }
+            String name(reinterpret_cast<const char*>(entry->getCurrentMemoryPtr()), length);
+            entry->skip(length);
+            uint8 found;
+            ImportChecksum &import = imports[name];
+            if(entry->read(&found, sizeof(found)) != sizeof(found) ||
+                entry->read(import.checksum, sizeof(import.checksum)) != sizeof(import.checksum))
+            {
+                return AbstractNodeListPtr();
+            }
+            import.found = found != 0;
+        }
+
+        AbstractNodeListPtr nodes(OGRE_NEW_T(AbstractNodeList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        ScriptCacheReader reader(entry->getCurrentMemoryPtr(), entry->size() - entry->tell(), mIds);
+        reader.readNodes(*nodes, 0);
+        if(reader.hasFailed())
+        {
+            LogManager::getSingleton().logMessage(
+                "ScriptCompiler: Ignoring corrupt script cache entry " + path);
+            return AbstractNodeListPtr();
+        }
+        return nodes;
+    }
+
+    bool ScriptCompiler::checkImports(const ImportChecksumMap &imports)
+    {
+        for(ImportChecksumMap::const_iterator i = imports.begin(); i != imports.end(); ++i)
+        {
+            DataStreamPtr stream;
+            try
+            {
+                stream = ResourceGroupManager::getSingleton().openResource(i->first, mGroup);
+            }
+            catch(FileNotFoundException&)
+            {
+            }
+            if(!stream != !i->second.found)
+                return false;
+            if(stream)
+            {
+                String str = stream->getAsString();
+                uint64 checksum[2];
+                MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), 0, checksum);
+                if(checksum[0] != i->second.checksum[0] || checksum[1] != i->second.checksum[1])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool ScriptCompiler::writeCache(const String &source, const uint64 checksum[2], const AbstractNodeList &nodes)
+    {
+        ScriptCacheWriter writer;
+        writer.writeNodes(nodes);
+        if(writer.hasFailed())
+            return false;
+
+        // Written under another name first, so a partly written entry is
+        // never picked up
+        String path = getCachePath(source);
+        String tempPath = path + ".tmp";
+        try
+        {
+            std::fstream *file = OGRE_NEW_T(std::fstream, MEMCATEGORY_GENERAL)();
+            file->open(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            DataStreamPtr stream(OGRE_NEW FileStreamDataStream(tempPath, file, true));
+            if(!*file)
+            {
+                OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                    "Cannot create " + tempPath, "ScriptCompiler::writeCache");
+            }
+
+            uint32 header[2] = { SCRIPT_CACHE_ID, OGRE_VERSION };
+            stream->write(header, sizeof(header));
+            stream->write(checksum, 2 * sizeof(uint64));
+            uint32 numImports = static_cast<uint32>(mImportChecksums.size());
+            stream->write(&numImports, sizeof(numImports));
+            for(ImportChecksumMap::const_iterator i = mImportChecksums.begin(); i != mImportChecksums.end(); ++i)
+            {
+                uint32 length = static_cast<uint32>(i->first.size());
+                stream->write(&length, sizeof(length));
+                stream->write(i->first.data(), length);
+                uint8 found = i->second.found ? 1 : 0;
+                stream->write(&found, sizeof(found));
+                stream->write(i->second.checksum, sizeof(i->second.checksum));
+            }
+            writer.finish(stream);
+            stream->close();
+
+            if(!FileSystemLayer::renameFile(tempPath, path))
+            {
+                OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                    "Cannot rename " + tempPath, "ScriptCompiler::writeCache");
+            }
+        }
+        catch(Exception &e)
+        {
+            FileSystemLayer::removeFile(tempPath);
+            LogManager::getSingleton().logMessage(
+                "ScriptCompiler: Cannot cache script " + source + ": " + e.getDescription(),
+                LML_CRITICAL);
+            return false;
+        }
+        return true;
+    }
+
     bool ScriptCompiler::_fireEvent(ScriptCompilerEvent *evt, void *retval)
     {
         if(mListener)
@@ -490,10 +1072,50 @@ namespace Ogre
         return false;
     }
 
+    namespace
+    {
+        /// Adds views of the given nodes and of all their children to a list
+        void addConcreteNodeViews(const ConcreteNodeList &nodes, ConcreteNodeView *parent,
+            ConcreteNodeViewList &views, ScriptArena &arena)
+        {
+            for(ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+            {
+                ConcreteNodeView *view = new(arena.allocate(sizeof(ConcreteNodeView))) ConcreteNodeView();
+                view->token = (*i)->token.data();
+                view->length = (*i)->token.size();
+                view->file = &(*i)->file;
+                view->line = (*i)->line;
+                view->type = (*i)->type;
+                view->parent = parent;
+                views.push_back(view);
+                addConcreteNodeViews((*i)->children, view, view->children, arena);
+            }
+        }
+    }
+
     AbstractNodeListPtr ScriptCompiler::convertToAST(const Ogre::ConcreteNodeListPtr &nodes)
     {
+        mArena.reset();
+        ConcreteNodeViewList views;
+        addConcreteNodeViews(*nodes, 0, views, mArena);
+
         AbstractTreeBuilder builder(this);
-        AbstractTreeBuilder::visit(&builder, *nodes.get());
+        AbstractTreeBuilder::visit(&builder, views);
+        return builder.getResult();
+    }
+
+    AbstractNodeListPtr ScriptCompiler::convertToAST(const String &str, const String &source)
+    {
+        // The tokens and the concrete nodes refer to str, and are only
+        // needed until the AST is built
+        mArena.reset();
+        mTokens.clear();
+        ScriptLexer::tokenize(str, source, mTokens, mArena);
+        ConcreteNodeViewList nodes;
+        ScriptParser::parse(mTokens, nodes, mArena);
+
+        AbstractTreeBuilder builder(this);
+        AbstractTreeBuilder::visit(&builder, nodes);
         return builder.getResult();
     }
 
@@ -594,14 +1216,25 @@ namespace Ogre
             }
             catch (FileNotFoundException&)
             {
+                // Adding the script later changes the result too
+                ImportChecksum missing = { false, { 0, 0 } };
+                mImportChecksums[name] = missing;
                 return retval;
             }
 
-            nodes = ScriptParser::parse(ScriptLexer::tokenize(stream->getAsString(), name));
+            String str = stream->getAsString();
+            if(!mCacheDirectory.empty())
+            {
+                ImportChecksum &checksum = mImportChecksums[name];
+                checksum.found = true;
+                MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), 0, checksum.checksum);
+            }
+            retval = convertToAST(str, name);
         }
-
-        if(nodes)
+        else if(nodes)
+        {
             retval = convertToAST(nodes);
+        }
 
         return retval;
     }
@@ -1309,60 +1942,60 @@ namespace Ogre
         return mNodes;
     }
 
-    void ScriptCompiler::AbstractTreeBuilder::visit(ConcreteNode *node)
+    void ScriptCompiler::AbstractTreeBuilder::visit(ConcreteNodeView *node)
     {
         AbstractNodePtr asn;
 
         // Import = "import" >> 2 children, mCurrent == null
         if(node->type == CNT_IMPORT && mCurrent == 0)
         {
-            if(node->children.size() > 2)
+            if(node->children.size > 2)
             {
-                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, node->file, node->line);
+                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, *node->file, node->line);
                 return;
             }
-            if(node->children.size() < 2)
+            if(node->children.size < 2)
             {
-                mCompiler->addError(CE_STRINGEXPECTED, node->file, node->line);
+                mCompiler->addError(CE_STRINGEXPECTED, *node->file, node->line);
                 return;
             }
 
             ImportAbstractNode *impl = OGRE_NEW ImportAbstractNode();
             impl->line = node->line;
-            impl->file = node->file;
+            impl->file = *node->file;
             
-            ConcreteNodeList::iterator iter = node->children.begin();
-            impl->target = (*iter)->token;
+            ConcreteNodeView *iter = node->children.front;
+            impl->target = iter->getToken();
 
-            iter++;
-            impl->source = (*iter)->token;
+            iter = iter->next;
+            impl->source = iter->getToken();
 
             asn = AbstractNodePtr(impl);
         }
         // variable set = "set" >> 2 children, children[0] == variable
         else if(node->type == CNT_VARIABLE_ASSIGN)
         {
-            if(node->children.size() > 2)
+            if(node->children.size > 2)
             {
-                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, node->file, node->line);
+                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, *node->file, node->line);
                 return;
             }
-            if(node->children.size() < 2)
+            if(node->children.size < 2)
             {
-                mCompiler->addError(CE_STRINGEXPECTED, node->file, node->line);
+                mCompiler->addError(CE_STRINGEXPECTED, *node->file, node->line);
                 return;
             }
-            if(node->children.front()->type != CNT_VARIABLE)
+            if(node->children.front->type != CNT_VARIABLE)
             {
-                mCompiler->addError(CE_VARIABLEEXPECTED, node->children.front()->file, node->children.front()->line);
+                mCompiler->addError(CE_VARIABLEEXPECTED, *node->children.front->file, node->children.front->line);
                 return;
             }
 
-            ConcreteNodeList::iterator i = node->children.begin();
-            String name = (*i)->token;
+            ConcreteNodeView *i = node->children.front;
+            String name = i->getToken();
 
-            ++i;
-            String value = (*i)->token;
+            i = i->next;
+            String value = i->getToken();
 
             if(mCurrent && mCurrent->type == ANT_OBJECT)
             {
@@ -1377,108 +2010,92 @@ namespace Ogre
         // variable = $*, no children
         else if(node->type == CNT_VARIABLE)
         {
-            if(!node->children.empty())
+            if(node->children.size != 0)
             {
-                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, node->file, node->line);
+                mCompiler->addError(CE_FEWERPARAMETERSEXPECTED, *node->file, node->line);
                 return;
             }
 
             VariableAccessAbstractNode *impl = OGRE_NEW VariableAccessAbstractNode(mCurrent);
             impl->line = node->line;
-            impl->file = node->file;
-            impl->name = node->token;
+            impl->file = *node->file;
+            impl->name = node->getToken();
 
             asn = AbstractNodePtr(impl);
         }
         // Handle properties and objects here
-        else if(!node->children.empty())
+        else if(node->children.size != 0)
         {
             // Grab the last two nodes
-            ConcreteNodePtr temp1, temp2;
-            ConcreteNodeList::reverse_iterator riter = node->children.rbegin();
-            if(riter != node->children.rend())
-            {
-                temp1 = *riter;
-                riter++;
-            }
-            if(riter != node->children.rend())
-                temp2 = *riter;
+            ConcreteNodeView *temp1 = node->children.back, *temp2 = temp1->prev;
 
             // object = last 2 children == { and }
             if(temp1 && temp2 &&
                 temp1->type == CNT_RBRACE && temp2->type == CNT_LBRACE)
             {
-                if(node->children.size() < 2)
+                if(node->children.size < 2)
                 {
-                    mCompiler->addError(CE_STRINGEXPECTED, node->file, node->line);
+                    mCompiler->addError(CE_STRINGEXPECTED, *node->file, node->line);
                     return;
                 }
 
                 ObjectAbstractNode *impl = OGRE_NEW ObjectAbstractNode(mCurrent);
                 impl->line = node->line;
-                impl->file = node->file;
+                impl->file = *node->file;
                 impl->abstract = false;
 
-                // Create a temporary detail list
-                list<ConcreteNode*>::type temp;
-                if(node->token == "abstract")
+                // The details are the node and its children, or only the
+                // children for abstract objects
+                ConcreteNodeView *iter = node;
+                if(node->equals("abstract"))
                 {
                     impl->abstract = true;
-                    for(ConcreteNodeList::const_iterator i = node->children.begin(); i != node->children.end(); ++i)
-                        temp.push_back((*i).get());
-                }
-                else
-                {
-                    temp.push_back(node);
-                    for(ConcreteNodeList::const_iterator i = node->children.begin(); i != node->children.end(); ++i)
-                        temp.push_back((*i).get());
+                    iter = node->children.front;
                 }
 
                 // Get the type of object
-                list<ConcreteNode*>::type::const_iterator iter = temp.begin();
-                impl->cls = (*iter)->token;
-                ++iter;
+                impl->cls = iter->getToken();
+                iter = iter == node ? node->children.front : iter->next;
 
                 // Get the name
                 // Unless the type is in the exclusion list
-                if(iter != temp.end() && ((*iter)->type == CNT_WORD || (*iter)->type == CNT_QUOTE) &&
+                if(iter && (iter->type == CNT_WORD || iter->type == CNT_QUOTE) &&
                     !mCompiler->isNameExcluded(impl->cls, mCurrent))
                 {
-                    impl->name = (*iter)->token;
-                    ++iter;
+                    impl->name = iter->getToken();
+                    iter = iter->next;
                 }
 
                 // Everything up until the colon is a "value" of this object
-                while(iter != temp.end() && (*iter)->type != CNT_COLON && (*iter)->type != CNT_LBRACE)
+                while(iter && iter->type != CNT_COLON && iter->type != CNT_LBRACE)
                 {
-                    if((*iter)->type == CNT_VARIABLE)
+                    if(iter->type == CNT_VARIABLE)
                     {
                         VariableAccessAbstractNode *var = OGRE_NEW VariableAccessAbstractNode(impl);
-                        var->file = (*iter)->file;
-                        var->line = (*iter)->line;
+                        var->file = *iter->file;
+                        var->line = iter->line;
                         var->type = ANT_VARIABLE_ACCESS;
-                        var->name = (*iter)->token;
+                        var->name = iter->getToken();
                         impl->values.push_back(AbstractNodePtr(var));
                     }
                     else
                     {
                         AtomAbstractNode *atom = OGRE_NEW AtomAbstractNode(impl);
-                        atom->file = (*iter)->file;
-                        atom->line = (*iter)->line;
+                        atom->file = *iter->file;
+                        atom->line = iter->line;
                         atom->type = ANT_ATOM;
-                        atom->value = (*iter)->token;
+                        atom->value = iter->getToken();
                         impl->values.push_back(AbstractNodePtr(atom));
                     }
-                    ++iter;
+                    iter = iter->next;
                 }
 
                 // Find the bases
-                if(iter != temp.end() && (*iter)->type == CNT_COLON)
+                if(iter && iter->type == CNT_COLON)
                 {
                     // Children of the ':' are bases
-                    for(ConcreteNodeList::iterator j = (*iter)->children.begin(); j != (*iter)->children.end(); ++j)
-                        impl->bases.push_back((*j)->token);
-                    ++iter;
+                    for(ConcreteNodeView *j = iter->children.front; j; j = j->next)
+                        impl->bases.push_back(j->getToken());
                 }
 
                 // Finally try to map the cls to an id
@@ -1506,8 +2123,8 @@ namespace Ogre
             {
                 PropertyAbstractNode *impl = OGRE_NEW PropertyAbstractNode(mCurrent);
                 impl->line = node->line;
-                impl->file = node->file;
-                impl->name = node->token;
+                impl->file = *node->file;
+                impl->name = node->getToken();
 
                 ScriptCompiler::IdMap::const_iterator iter2 = mCompiler->mIds.find(impl->name);
                 if(iter2 != mCompiler->mIds.end())
@@ -1528,8 +2145,8 @@ namespace Ogre
         {
             AtomAbstractNode *impl = OGRE_NEW AtomAbstractNode(mCurrent);
             impl->line = node->line;
-            impl->file = node->file;
-            impl->value = node->token;
+            impl->file = *node->file;
+            impl->value = node->getToken();
 
             ScriptCompiler::IdMap::const_iterator iter2 = mCompiler->mIds.find(impl->value);
             if(iter2 != mCompiler->mIds.end())
@@ -1561,10 +2178,10 @@ namespace Ogre
         }
     }
 
-    void ScriptCompiler::AbstractTreeBuilder::visit(AbstractTreeBuilder *visitor, const ConcreteNodeList &nodes)
+    void ScriptCompiler::AbstractTreeBuilder::visit(AbstractTreeBuilder *visitor, const ConcreteNodeViewList &nodes)
     {
-        for(ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
-            visitor->visit((*i).get());
+        for(ConcreteNodeView *i = nodes.front; i; i = i->next)
+            visitor->visit(i);
     }
     
 
@@ -1582,7 +2199,7 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------
     ScriptCompilerManager::ScriptCompilerManager()
-        :mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler)
+        :mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler), mPrepareCompilersGeneration(0)
     {
             OGRE_LOCK_AUTO_MUTEX;
         mScriptPatterns.push_back("*.program");
@@ -1601,6 +2218,8 @@ namespace Ogre
     ScriptCompilerManager::~ScriptCompilerManager()
     {
         OGRE_THREAD_POINTER_DELETE(mScriptCompiler);
+        for(size_t i = 0; i < mPrepareCompilers.size(); ++i)
+            OGRE_DELETE mPrepareCompilers[i];
         OGRE_DELETE mBuiltinTranslatorManager;
     }
     //-----------------------------------------------------------------------
@@ -1659,9 +2278,30 @@ namespace Ogre
 	//-----------------------------------------------------------------------
 	uint32 ScriptCompilerManager::registerCustomWordId(const String &word)
 	{
+        {
+            OGRE_LOCK_MUTEX(mPrepareCompilersMutex);
+            if(std::find(mCustomWords.begin(), mCustomWords.end(), word) == mCustomWords.end())
+            {
+                mCustomWords.push_back(word);
+                // Idle compilers don't know the new word, nor do the ones in use
+                for(size_t i = 0; i < mPrepareCompilers.size(); ++i)
+                    OGRE_DELETE mPrepareCompilers[i];
+                mPrepareCompilers.clear();
+                ++mPrepareCompilersGeneration;
+            }
+        }
 		return OGRE_THREAD_POINTER_GET(mScriptCompiler)->registerCustomWordId(word);
     }
     //-----------------------------------------------------------------------
+    ScriptCompiler *ScriptCompilerManager::createPrepareCompiler()
+    {
+        // Registering the words in the same order gives them the same ids
+        ScriptCompiler *compiler = OGRE_NEW ScriptCompiler();
+        for(StringVector::iterator i = mCustomWords.begin(); i != mCustomWords.end(); ++i)
+            compiler->registerCustomWordId(*i);
+        return compiler;
+    }
+    //-----------------------------------------------------------------------
     void ScriptCompilerManager::addScriptPattern(const String &pattern)
     {
         mScriptPatterns.push_back(pattern);
@@ -1693,9 +2333,124 @@ namespace Ogre
         {
                     OGRE_LOCK_AUTO_MUTEX;
             OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setCacheDirectory(mScriptCacheDirectory);
         }
         OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(stream->getAsString(), stream->getName(), groupName);
     }
+    //-----------------------------------------------------------------------
+    ScriptLoader::PreparedScript* ScriptCompilerManager::prepareScript(DataStreamPtr& stream, const String& groupName)
+    {
+        String cacheDirectory;
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            if(mListener)
+                return 0;
+            cacheDirectory = mScriptCacheDirectory;
+        }
+
+        // Take an idle compiler, the ones in use belong to other threads
+        ScriptCompiler *compiler;
+        size_t generation;
+        {
+            OGRE_LOCK_MUTEX(mPrepareCompilersMutex);
+            generation = mPrepareCompilersGeneration;
+            if(mPrepareCompilers.empty())
+            {
+                compiler = createPrepareCompiler();
+            }
+            else
+            {
+                compiler = mPrepareCompilers.back();
+                mPrepareCompilers.pop_back();
+            }
+        }
+
+        PreparedScript *script = OGRE_NEW PreparedScript();
+        try
+        {
+            compiler->setCacheDirectory(cacheDirectory);
+            compiler->_parse(stream->getAsString(), stream->getName(), groupName, script->parsed);
+        }
+        catch(...)
+        {
+            // Leave it to parseScript, which reports the error as usual
+            OGRE_DELETE script;
+            script = 0;
+        }
+
+        OGRE_LOCK_MUTEX(mPrepareCompilersMutex);
+        if(generation != mPrepareCompilersGeneration)
+        {
+            // A word was registered while parsing, parseScript will see it
+            OGRE_DELETE compiler;
+            OGRE_DELETE script;
+            return 0;
+        }
+        mPrepareCompilers.push_back(compiler);
+        return script;
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::parsePreparedScript(ScriptLoader::PreparedScript* script, const String& groupName)
+    {
+#if OGRE_THREAD_SUPPORT
+        if (!OGRE_THREAD_POINTER_GET(mScriptCompiler))
+            OGRE_THREAD_POINTER_SET(mScriptCompiler, OGRE_NEW ScriptCompiler());
+#endif
+        {
+                    OGRE_LOCK_AUTO_MUTEX;
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setCacheDirectory(mScriptCacheDirectory);
+        }
+        OGRE_THREAD_POINTER_GET(mScriptCompiler)->_compileParsed(
+            static_cast<PreparedScript*>(script)->parsed, groupName);
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::setScriptCacheDirectory(const String& path)
+    {
+        {
+                    OGRE_LOCK_AUTO_MUTEX;
+            mScriptCacheDirectory = path;
+        }
+        if(!path.empty() && !FileSystemLayer::createDirectory(path))
+        {
+            LogManager::getSingleton().logMessage(
+                "ScriptCompilerManager: Cannot create script cache directory " + path, LML_CRITICAL);
+        }
+    }
+    //-----------------------------------------------------------------------
+    size_t ScriptCompilerManager::buildScriptCache(const String& groupName)
+    {
+#if OGRE_THREAD_SUPPORT
+        if (!OGRE_THREAD_POINTER_GET(mScriptCompiler))
+            OGRE_THREAD_POINTER_SET(mScriptCompiler, OGRE_NEW ScriptCompiler());
+#endif
+        ScriptCompiler *compiler = OGRE_THREAD_POINTER_GET(mScriptCompiler);
+        {
+                    OGRE_LOCK_AUTO_MUTEX;
+            // Without the listener, like the scripts are read back
+            compiler->setListener(0);
+            compiler->setCacheDirectory(mScriptCacheDirectory);
+        }
+        if(compiler->getCacheDirectory().empty())
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE, "No script cache directory set",
+                "ScriptCompilerManager::buildScriptCache");
+        }
+
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        size_t numCached = 0;
+        for(StringVector::iterator p = mScriptPatterns.begin(); p != mScriptPatterns.end(); ++p)
+        {
+            StringVectorPtr names = rgm.findResourceNames(groupName, *p);
+            for(StringVector::iterator i = names->begin(); i != names->end(); ++i)
+            {
+                DataStreamPtr stream = rgm.openResource(*i, groupName);
+                if(compiler->_buildCache(stream->getAsString(), stream->getName(), groupName))
+                    ++numCached;
+            }
+        }
+        return numCached;
+    }
 
     //-------------------------------------------------------------------------
     String PreApplyTextureAliasesScriptCompilerEvent::eventType = "preApplyTextureAliases";
@@ -30,7 +30,70 @@ THE SOFTWARE.
 #include "OgreScriptLexer.h"
 
 namespace Ogre{
+    ScriptArena::ScriptArena()
+        :mCurrent(0), mUsed(0)
+    {
+    }
+
+    ScriptArena::~ScriptArena()
+    {
+        for(size_t i = 0; i < mBlocks.size(); ++i)
+            OGRE_FREE_SIMD(mBlocks[i].data, MEMCATEGORY_SCRIPTING);
+    }
+
+    void *ScriptArena::allocate(size_t size)
+    {
+        const size_t blockSize = 64 * 1024, alignment = 16;
+        size = (size + alignment - 1) & ~(alignment - 1);
+
+        // Move on to the next block with enough room, a block too small
+        // for this allocation is still used for the next ones
+        while(mCurrent < mBlocks.size() && mUsed + size > mBlocks[mCurrent].size)
+        {
+            ++mCurrent;
+            mUsed = 0;
+        }
+        if(mCurrent == mBlocks.size())
+        {
+            Block block;
+            block.size = std::max(blockSize, size);
+            block.data = static_cast<char*>(OGRE_MALLOC_SIMD(block.size, MEMCATEGORY_SCRIPTING));
+            mBlocks.push_back(block);
+            mUsed = 0;
+        }
+
+        void *ptr = mBlocks[mCurrent].data + mUsed;
+        mUsed += size;
+        return ptr;
+    }
+
+    void ScriptArena::reset()
+    {
+        mCurrent = 0;
+        mUsed = 0;
+    }
+
     ScriptTokenListPtr ScriptLexer::tokenize(const String &str, const String &source)
+    {
+        ScriptArena arena;
+        ScriptTokenViewList views;
+        tokenize(str, source, views, arena);
+
+        ScriptTokenListPtr tokens(OGRE_NEW_T(ScriptTokenList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        tokens->reserve(views.size());
+        for(ScriptTokenViewList::const_iterator i = views.begin(); i != views.end(); ++i)
+        {
+            ScriptTokenPtr token(OGRE_NEW_T(ScriptToken, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+            token->lexeme.assign(i->lexeme, i->length);
+            token->file = source;
+            token->type = i->type;
+            token->line = i->line;
+            tokens->push_back(token);
+        }
+        return tokens;
+    }
+
+    void ScriptLexer::tokenize(const String &str, const String &source, ScriptTokenViewList &tokens, ScriptArena &arena)
     {
         // State enums
         enum{ READY = 0, COMMENT, MULTICOMMENT, WORD, QUOTE, VAR, POSSIBLECOMMENT };
@@ -39,16 +102,18 @@ namespace Ogre{
         const wchar_t varopener = '$', quote = '\"', slash = '/', backslash = '\\', openbrace = '{', closebrace = '}', colon = ':', star = '*', cr = '\r', lf = '\n';
         char c = 0, lastc = 0;
 
-        String lexeme;
+        // The lexeme being read runs from start to the current character
+        const char *data = str.data();
+        size_t start = 0;
+        // Whether the quote being read has backslashes, which are unescaped
+        bool escaped = false;
         uint32 line = 1, state = READY, lastQuote = 0;
-        ScriptTokenListPtr tokens(OGRE_NEW_T(ScriptTokenList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
 
         // Iterate over the input
-        String::const_iterator i = str.begin(), end = str.end();
-        while(i != end)
+        for(size_t i = 0, end = str.size(); i != end; ++i)
         {
             lastc = c;
-            c = *i;
+            c = data[i];
 
             if(c == quote)
                 lastQuote = line;
@@ -58,35 +123,31 @@ namespace Ogre{
             case READY:
                 if(c == slash && lastc == slash)
                 {
-                    // Comment start, clear out the lexeme
-                    lexeme = "";
                     state = COMMENT;
                 }
                 else if(c == star && lastc == slash)
                 {
-                    lexeme = "";
                     state = MULTICOMMENT;
                 }
                 else if(c == quote)
                 {
-                    // Clear out the lexeme ready to be filled with quotes!
-                    lexeme = c;
+                    start = i;
+                    escaped = false;
                     state = QUOTE;
                 }
                 else if(c == varopener)
                 {
                     // Set up to read in a variable
-                    lexeme = c;
+                    start = i;
                     state = VAR;
                 }
                 else if(isNewline(c))
                 {
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
+                    setToken(data + i, 1, line, source, tokens);
                 }
                 else if(!isWhitespace(c))
                 {
-                    lexeme = c;
+                    start = i;
                     if(c == slash)
                         state = POSSIBLECOMMENT;
                     else
@@ -96,8 +157,7 @@ namespace Ogre{
             case COMMENT:
                 if(isNewline(c))
                 {
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
+                    setToken(data + i, 1, line, source, tokens);
                     state = READY;
                 }
                 break;
@@ -108,13 +168,11 @@ namespace Ogre{
             case POSSIBLECOMMENT:
                 if(c == slash && lastc == slash)
                 {
-                    lexeme = "";
                     state = COMMENT;
                     break;  
                 }
                 else if(c == star && lastc == slash)
                 {
-                    lexeme = "";
                     state = MULTICOMMENT;
                     break;
                 }
@@ -123,93 +181,51 @@ namespace Ogre{
                     state = WORD;
                 }
             case WORD:
+            case VAR:
                 if(isNewline(c))
                 {
-                    setToken(lexeme, line, source, tokens.get());
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
+                    setToken(data + start, i - start, line, source, tokens);
+                    setToken(data + i, 1, line, source, tokens);
                     state = READY;
                 }
                 else if(isWhitespace(c))
                 {
-                    setToken(lexeme, line, source, tokens.get());
+                    setToken(data + start, i - start, line, source, tokens);
                     state = READY;
                 }
                 else if(c == openbrace || c == closebrace || c == colon)
                 {
-                    setToken(lexeme, line, source, tokens.get());
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
+                    setToken(data + start, i - start, line, source, tokens);
+                    setToken(data + i, 1, line, source, tokens);
                     state = READY;
                 }
-                else
-                {
-                    lexeme += c;
-                }
                 break;
             case QUOTE:
-                if(c != backslash)
+                if(c == backslash)
                 {
-                    // Allow embedded quotes with escaping
-                    if(c == quote && lastc == backslash)
-                    {
-                        lexeme += c;
-                    }
-                    else if(c == quote)
-                    {
-                        lexeme += c;
-                        setToken(lexeme, line, source, tokens.get());
-                        state = READY;
-                    }
-                    else
-                    {
-                        // Backtrack here and allow a backslash normally within the quote
-                        if(lastc == backslash)
-                            lexeme = lexeme + "\\" + c;
-                        else
-                            lexeme += c;
-                    }
+                    escaped = true;
                 }
-                break;
-            case VAR:
-                if(isNewline(c))
+                else if(c == quote && lastc != backslash)
                 {
-                    setToken(lexeme, line, source, tokens.get());
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
+                    const char *lexeme = data + start;
+                    size_t length = i + 1 - start;
+                    if(escaped)
+                        lexeme = unescapeQuote(lexeme, length, arena);
+                    setToken(lexeme, length, line, source, tokens);
                     state = READY;
                 }
-                else if(isWhitespace(c))
-                {
-                    setToken(lexeme, line, source, tokens.get());
-                    state = READY;
-                }
-                else if(c == openbrace || c == closebrace || c == colon)
-                {
-                    setToken(lexeme, line, source, tokens.get());
-                    lexeme = c;
-                    setToken(lexeme, line, source, tokens.get());
-                    state = READY;
-                }
-                else
-                {
-                    lexeme += c;
-                }
                 break;
             }
 
             // Separate check for newlines just to track line numbers
             if(c == cr || (c == lf && lastc != cr))
                 line++;
-
-            i++;
         }
 
         // Check for valid exit states
         if(state == WORD || state == VAR)
         {
-            if(!lexeme.empty())
-                setToken(lexeme, line, source, tokens.get());
+            setToken(data + start, str.size() - start, line, source, tokens);
         }
         else
         {
@@ -221,51 +237,70 @@ namespace Ogre{
                     "ScriptLexer::tokenize");
             }
         }
-
-        return tokens;
     }
 
-    void ScriptLexer::setToken(const Ogre::String &lexeme, Ogre::uint32 line, const String &source, Ogre::ScriptTokenList *tokens)
+    void ScriptLexer::setToken(const char *lexeme, size_t length, uint32 line, const String &source, ScriptTokenViewList &tokens)
     {
         const char openBracket = '{', closeBracket = '}', colon = ':',
             quote = '\"', var = '$';
 
-        ScriptTokenPtr token(OGRE_NEW_T(ScriptToken, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
-        token->lexeme = lexeme;
-        token->line = line;
-        token->file = source;
-        bool ignore = false;
+        ScriptTokenView token;
+        token.lexeme = lexeme;
+        token.length = length;
+        token.file = &source;
+        token.line = line;
 
-        // Check the user token map first
-        if(lexeme.size() == 1 && isNewline(lexeme[0]))
+        if(length == 1 && isNewline(lexeme[0]))
         {
-            token->type = TID_NEWLINE;
-            if(!tokens->empty() && tokens->back()->type == TID_NEWLINE)
-                ignore = true;
+            // Consecutive newlines are kept as one
+            if(!tokens.empty() && tokens.back().type == TID_NEWLINE)
+                return;
+            token.type = TID_NEWLINE;
         }
-        else if(lexeme.size() == 1 && lexeme[0] == openBracket)
-            token->type = TID_LBRACKET;
-        else if(lexeme.size() == 1 && lexeme[0] == closeBracket)
-            token->type = TID_RBRACKET;
-        else if(lexeme.size() == 1 && lexeme[0] == colon)
-            token->type = TID_COLON;
+        else if(length == 1 && lexeme[0] == openBracket)
+            token.type = TID_LBRACKET;
+        else if(length == 1 && lexeme[0] == closeBracket)
+            token.type = TID_RBRACKET;
+        else if(length == 1 && lexeme[0] == colon)
+            token.type = TID_COLON;
         else if(lexeme[0] == var)
-            token->type = TID_VARIABLE;
+            token.type = TID_VARIABLE;
         else
         {
             // This is either a non-zero length phrase or quoted phrase
-            if(lexeme.size() >= 2 && lexeme[0] == quote && lexeme[lexeme.size() - 1] == quote)
+            if(length >= 2 && lexeme[0] == quote && lexeme[length - 1] == quote)
             {
-                token->type = TID_QUOTE;
+                token.type = TID_QUOTE;
             }
             else
             {
-                token->type = TID_WORD;
+                token.type = TID_WORD;
             }
         }
 
-        if(!ignore)
-            tokens->push_back(token);
+        tokens.push_back(token);
+    }
+
+    const char *ScriptLexer::unescapeQuote(const char *lexeme, size_t &length, ScriptArena &arena)
+    {
+        // Backslashes before quotes are dropped, other runs of them are
+        // kept as a single one
+        char *result = static_cast<char*>(arena.allocate(length));
+        size_t resultLength = 0;
+        char lastc = 0;
+        for(size_t i = 0; i < length; ++i)
+        {
+            char c = lexeme[i];
+            if(c != '\\')
+            {
+                if(lastc == '\\' && c != '\"')
+                    result[resultLength++] = '\\';
+                result[resultLength++] = c;
+            }
+            lastc = c;
+        }
+        length = resultLength;
+        return result;
     }
 
     bool ScriptLexer::isWhitespace(Ogre::String::value_type c)
@@ -279,4 +314,3 @@ namespace Ogre{
     }
 
 }
-
@@ -29,219 +29,169 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreScriptParser.h"
 
+#include <new>
+
 namespace Ogre
 {
+    namespace
+    {
+        /// Copies nodes built from views into ConcreteNodes
+        void copyConcreteNodes(const ConcreteNodeViewList &views, ConcreteNode *parent, ConcreteNodeList &nodes)
+        {
+            for(ConcreteNodeView *i = views.front; i; i = i->next)
+            {
+                ConcreteNodePtr node(OGRE_NEW ConcreteNode());
+                node->token.assign(i->token, i->length);
+                node->file = *i->file;
+                node->line = i->line;
+                node->type = i->type;
+                node->parent = parent;
+                nodes.push_back(node);
+                copyConcreteNodes(i->children, node.get(), node->children);
+            }
+        }
+    }
+
     ConcreteNodeListPtr ScriptParser::parse(const ScriptTokenListPtr &tokens)
     {
+        // Parses views of the tokens, then copies the result
+        ScriptTokenViewList views;
+        views.reserve(tokens->size());
+        for(ScriptTokenList::const_iterator i = tokens->begin(); i != tokens->end(); ++i)
+        {
+            ScriptTokenView view = { (*i)->lexeme.data(), (*i)->lexeme.size(), &(*i)->file, (*i)->type, (*i)->line };
+            views.push_back(view);
+        }
+        ScriptArena arena;
+        ConcreteNodeViewList viewNodes;
+        parse(views, viewNodes, arena);
+
         // MEMCATEGORY_GENERAL because SharedPtr can only free using that category
         ConcreteNodeListPtr nodes(OGRE_NEW_T(ConcreteNodeList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+        copyConcreteNodes(viewNodes, 0, *nodes);
+        return nodes;
+    }
 
+    void ScriptParser::parse(const ScriptTokenViewList &tokens, ConcreteNodeViewList &nodes, ScriptArena &arena)
+    {
         enum{READY, OBJECT};
         uint32 state = READY;
 
-        ConcreteNode *parent = 0;
-        ConcreteNodePtr node;
-        ScriptToken *token = 0;
-        ScriptTokenList::iterator i = tokens->begin(), end = tokens->end();
-        while(i != end)
+        ConcreteNodeView *parent = 0, *node = 0;
+        for(size_t i = 0, end = tokens.size(); i < end; ++i)
         {
-            token = (*i).get();
+            const ScriptTokenView &token = tokens[i];
 
             switch(state)
             {
             case READY:
-                if(token->type == TID_WORD)
+                if(token.type == TID_WORD)
                 {
-                    if(token->lexeme == "import")
+                    if(token.equals("import"))
                     {
-                        node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        node->token = token->lexeme;
-                        node->file = token->file;
-                        node->line = token->line;
-                        node->type = CNT_IMPORT;
+                        node = createNode(token, CNT_IMPORT, arena);
 
                         // The next token is the target
                         ++i;
-                        if(i == end || ((*i)->type != TID_WORD && (*i)->type != TID_QUOTE))
+                        if(i == end || (tokens[i].type != TID_WORD && tokens[i].type != TID_QUOTE))
                             OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
                                 Ogre::String("expected import target at line ") + 
                                     Ogre::StringConverter::toString(node->line),
                                 "ScriptParser::parse");
-                        ConcreteNodePtr temp(OGRE_NEW ConcreteNode());
-                        temp->parent = node.get();
-                        temp->file = (*i)->file;
-                        temp->line = (*i)->line;
-                        temp->type = (*i)->type == TID_WORD ? CNT_WORD : CNT_QUOTE;
-                        if(temp->type == CNT_QUOTE)
-                            temp->token = (*i)->lexeme.substr(1, token->lexeme.size() - 2);
-                        else
-                            temp->token = (*i)->lexeme;
+                        ConcreteNodeView *temp = createNode(tokens[i], tokens[i].type == TID_WORD ? CNT_WORD : CNT_QUOTE, arena);
+                        temp->parent = node;
                         node->children.push_back(temp);
 
                         // The second-next token is the source
                         ++i;
-                        ++i;
-                        if(i == end || ((*i)->type != TID_WORD && (*i)->type != TID_QUOTE))
+                        if(i != end)
+                            ++i;
+                        if(i == end || (tokens[i].type != TID_WORD && tokens[i].type != TID_QUOTE))
                             OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
                                 Ogre::String("expected import source at line ") + 
                                     Ogre::StringConverter::toString(node->line),
                                 "ScriptParser::parse");
-                        temp = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        temp->parent = node.get();
-                        temp->file = (*i)->file;
-                        temp->line = (*i)->line;
-                        temp->type = (*i)->type == TID_WORD ? CNT_WORD : CNT_QUOTE;
-                        if(temp->type == CNT_QUOTE)
-                            temp->token = (*i)->lexeme.substr(1, (*i)->lexeme.size() - 2);
-                        else
-                            temp->token = (*i)->lexeme;
+                        temp = createNode(tokens[i], tokens[i].type == TID_WORD ? CNT_WORD : CNT_QUOTE, arena);
+                        temp->parent = node;
                         node->children.push_back(temp);
 
                         // Consume all the newlines
-                        i = skipNewlines(i, end);
+                        i = skipNewlines(tokens, i);
 
                         // Insert the node
-                        if(parent)
-                        {
-                            node->parent = parent;
-                            parent->children.push_back(node);
-                        }
-                        else
-                        {
-                            node->parent = 0;
-                            nodes->push_back(node);
-                        }
-                        node = ConcreteNodePtr();
+                        addNode(node, parent, nodes);
                     }
-                    else if(token->lexeme == "set")
+                    else if(token.equals("set"))
                     {
-                        node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        node->token = token->lexeme;
-                        node->file = token->file;
-                        node->line = token->line;
-                        node->type = CNT_VARIABLE_ASSIGN;
+                        node = createNode(token, CNT_VARIABLE_ASSIGN, arena);
 
                         // The next token is the variable
                         ++i;
-                        if(i == end || (*i)->type != TID_VARIABLE)
+                        if(i == end || tokens[i].type != TID_VARIABLE)
                             OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
                                 Ogre::String("expected variable name at line ") + 
                                     Ogre::StringConverter::toString(node->line),
                                 "ScriptParser::parse");
-                        ConcreteNodePtr temp(OGRE_NEW ConcreteNode());
-                        temp->parent = node.get();
-                        temp->file = (*i)->file;
-                        temp->line = (*i)->line;
-                        temp->type = CNT_VARIABLE;
-                        temp->token = (*i)->lexeme;
+                        ConcreteNodeView *temp = createNode(tokens[i], CNT_VARIABLE, arena);
+                        temp->parent = node;
                         node->children.push_back(temp);
 
                         // The next token is the assignment
                         ++i;
-                        if(i == end || ((*i)->type != TID_WORD && (*i)->type != TID_QUOTE))
+                        if(i == end || (tokens[i].type != TID_WORD && tokens[i].type != TID_QUOTE))
                             OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
                                 Ogre::String("expected variable value at line ") + 
                                     Ogre::StringConverter::toString(node->line),
                                 "ScriptParser::parse");
-                        temp = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        temp->parent = node.get();
-                        temp->file = (*i)->file;
-                        temp->line = (*i)->line;
-                        temp->type = (*i)->type == TID_WORD ? CNT_WORD : CNT_QUOTE;
-                        if(temp->type == CNT_QUOTE)
-                            temp->token = (*i)->lexeme.substr(1, (*i)->lexeme.size() - 2);
-                        else
-                            temp->token = (*i)->lexeme;
+                        temp = createNode(tokens[i], tokens[i].type == TID_WORD ? CNT_WORD : CNT_QUOTE, arena);
+                        temp->parent = node;
                         node->children.push_back(temp);
 
                         // Consume all the newlines
-                        i = skipNewlines(i, end);
+                        i = skipNewlines(tokens, i);
 
                         // Insert the node
-                        if(parent)
-                        {
-                            node->parent = parent;
-                            parent->children.push_back(node);
-                        }
-                        else
-                        {
-                            node->parent = 0;
-                            nodes->push_back(node);
-                        }
-                        node = ConcreteNodePtr();
+                        addNode(node, parent, nodes);
                     }
                     else
                     {
-                        node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        node->file = token->file;
-                        node->line = token->line;
-                        node->type = token->type == TID_WORD ? CNT_WORD : CNT_QUOTE;
-                        if(node->type == CNT_QUOTE)
-                            node->token = token->lexeme.substr(1, token->lexeme.size() - 2);
-                        else
-                            node->token = token->lexeme;
+                        node = createNode(token, CNT_WORD, arena);
 
                         // Insert the node
-                        if(parent)
-                        {
-                            node->parent = parent;
-                            parent->children.push_back(node);
-                        }
-                        else
-                        {
-                            node->parent = 0;
-                            nodes->push_back(node);
-                        }
+                        addNode(node, parent, nodes);
 
                         // Set the parent
-                        parent = node.get();
+                        parent = node;
 
                         // Switch states
                         state = OBJECT;
-
-                        node = ConcreteNodePtr();
                     }
                 }
-                else if(token->type == TID_RBRACKET)
+                else if(token.type == TID_RBRACKET)
                 {
                     // Go up one level if we can
                     if(parent)
                         parent = parent->parent;
 
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_RBRACE;
+                    node = createNode(token, CNT_RBRACE, arena);
 
                     // Consume all the newlines
-                    i = skipNewlines(i, end);
+                    i = skipNewlines(tokens, i);
 
                     // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
+                    addNode(node, parent, nodes);
 
                     // Move up another level
                     if(parent)
                         parent = parent->parent;
-
-                    node = ConcreteNodePtr();
                 }
                 break;
             case OBJECT:
-                if(token->type == TID_NEWLINE)
+                if(token.type == TID_NEWLINE)
                 {
                     // Look ahead to the next non-newline token and if it isn't an {, this was a property
-                    ScriptTokenList::iterator next = skipNewlines(i, end);
-                    if(next == end || (*next)->type != TID_LBRACKET)
+                    size_t next = skipNewlines(tokens, i);
+                    if(next == end || tokens[next].type != TID_LBRACKET)
                     {
                         // Ended a property here
                         if(parent)
@@ -249,86 +199,58 @@ namespace Ogre
                         state = READY;
                     }
                 }
-                else if(token->type == TID_COLON)
+                else if(token.type == TID_COLON)
                 {
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_COLON;
+                    node = createNode(token, CNT_COLON, arena);
 
                     // The following token are the parent objects (base classes).
                     // Require at least one of them.
 
-                    ScriptTokenList::iterator j = i + 1;
-                    j = skipNewlines(j, end);
-                    if(j == end || ((*j)->type != TID_WORD && (*j)->type != TID_QUOTE)) {
+                    size_t j = skipNewlines(tokens, i + 1);
+                    if(j == end || (tokens[j].type != TID_WORD && tokens[j].type != TID_QUOTE)) {
                         OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
                             Ogre::String("expected object identifier at line ") + 
                                     Ogre::StringConverter::toString(node->line),
                             "ScriptParser::parse");
                     }
 
-                    while(j != end && ((*j)->type == TID_WORD || (*j)->type == TID_QUOTE))
+                    while(j != end && (tokens[j].type == TID_WORD || tokens[j].type == TID_QUOTE))
                     {
-                        ConcreteNodePtr tempNode = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                        tempNode->token = (*j)->lexeme;
-                        tempNode->file = (*j)->file;
-                        tempNode->line = (*j)->line;
-                        tempNode->type = (*j)->type == TID_WORD ? CNT_WORD : CNT_QUOTE;
-                        tempNode->parent = node.get();
-                        node->children.push_back(tempNode);
+                        // The bases keep their quotes
+                        ConcreteNodeView *temp = createNode(tokens[j], tokens[j].type == TID_WORD ? CNT_WORD : CNT_QUOTE, arena);
+                        if(temp->type == CNT_QUOTE)
+                        {
+                            temp->token = tokens[j].lexeme;
+                            temp->length = tokens[j].length;
+                        }
+                        temp->parent = node;
+                        node->children.push_back(temp);
                         ++j;
                     }
 
                     // Move it backwards once, since the end of the loop moves it forwards again anyway
-                    i = --j;
+                    i = j - 1;
 
                     // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
-                    node = ConcreteNodePtr();
+                    addNode(node, parent, nodes);
                 }
-                else if(token->type == TID_LBRACKET)
+                else if(token.type == TID_LBRACKET)
                 {
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_LBRACE;
+                    node = createNode(token, CNT_LBRACE, arena);
 
                     // Consume all the newlines
-                    i = skipNewlines(i, end);
+                    i = skipNewlines(tokens, i);
 
                     // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
+                    addNode(node, parent, nodes);
 
                     // Set the parent
-                    parent = node.get();
+                    parent = node;
 
                     // Change the state
                     state = READY;
-
-                    node = ConcreteNodePtr();
                 }
-                else if(token->type == TID_RBRACKET)
+                else if(token.type == TID_RBRACKET)
                 {
                     // Go up one level if we can
                     if(parent)
@@ -338,104 +260,35 @@ namespace Ogre
                     if(parent && parent->type == CNT_LBRACE && parent->parent)
                         parent = parent->parent;
 
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_RBRACE;
+                    node = createNode(token, CNT_RBRACE, arena);
 
                     // Consume all the newlines
-                    i = skipNewlines(i, end);
+                    i = skipNewlines(tokens, i);
 
                     // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
+                    addNode(node, parent, nodes);
 
                     // Move up another level
                     if(parent)
                         parent = parent->parent;
 
-                    node = ConcreteNodePtr();
                     state = READY;
                 }
-                else if(token->type == TID_VARIABLE)
+                else if(token.type == TID_VARIABLE)
                 {
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_VARIABLE;
-
-                    // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
-                    node = ConcreteNodePtr();
+                    addNode(createNode(token, CNT_VARIABLE, arena), parent, nodes);
                 }
-                else if(token->type == TID_QUOTE)
+                else if(token.type == TID_QUOTE)
                 {
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme.substr(1, token->lexeme.size() - 2);
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_QUOTE;
-
-                    // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
-                    node = ConcreteNodePtr();
+                    addNode(createNode(token, CNT_QUOTE, arena), parent, nodes);
                 }
-                else if(token->type == TID_WORD)
+                else if(token.type == TID_WORD)
                 {
-                    node = ConcreteNodePtr(OGRE_NEW ConcreteNode());
-                    node->token = token->lexeme;
-                    node->file = token->file;
-                    node->line = token->line;
-                    node->type = CNT_WORD;
-
-                    // Insert the node
-                    if(parent)
-                    {
-                        node->parent = parent;
-                        parent->children.push_back(node);
-                    }
-                    else
-                    {
-                        node->parent = 0;
-                        nodes->push_back(node);
-                    }
-                    node = ConcreteNodePtr();
+                    addNode(createNode(token, CNT_WORD, arena), parent, nodes);
                 }
                 break;
             }
-
-            ++i;
         }
-
-        return nodes;
     }
 
     ConcreteNodeListPtr ScriptParser::parseChunk(const ScriptTokenListPtr &tokens)
@@ -488,18 +341,36 @@ namespace Ogre
         return nodes;
     }
 
-    ScriptToken *ScriptParser::getToken(ScriptTokenList::iterator i, ScriptTokenList::iterator end, int offset)
+    ConcreteNodeView *ScriptParser::createNode(const ScriptTokenView &token, ConcreteNodeType type, ScriptArena &arena)
     {
-        ScriptToken *token = 0;
-        ScriptTokenList::iterator iter = i + offset;
-        if(iter != end)
-            token = (*i).get();
-        return token;
+        ConcreteNodeView *node = new(arena.allocate(sizeof(ConcreteNodeView))) ConcreteNodeView();
+        node->token = token.lexeme;
+        node->length = token.length;
+        node->file = token.file;
+        node->line = token.line;
+        node->type = type;
+        node->parent = 0;
+        // Quotes are stripped
+        if(type == CNT_QUOTE)
+        {
+            ++node->token;
+            node->length -= 2;
+        }
+        return node;
+    }
+
+    void ScriptParser::addNode(ConcreteNodeView *node, ConcreteNodeView *parent, ConcreteNodeViewList &nodes)
+    {
+        node->parent = parent;
+        if(parent)
+            parent->children.push_back(node);
+        else
+            nodes.push_back(node);
     }
 
-    ScriptTokenList::iterator ScriptParser::skipNewlines(ScriptTokenList::iterator i, ScriptTokenList::iterator end)
+    size_t ScriptParser::skipNewlines(const ScriptTokenViewList &tokens, size_t i)
     {
-        while(i != end && (*i)->type == TID_NEWLINE)
+        while(i < tokens.size() && tokens[i].type == TID_NEWLINE)
             ++i;
         return i;
     }
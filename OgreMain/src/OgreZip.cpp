@@ -80,6 +80,8 @@ namespace Ogre {
         return errorMsg;
     }
     //-----------------------------------------------------------------------
+    bool ZipArchive::msUseMemoryMapping = true;
+    //-----------------------------------------------------------------------
     ZipArchive::ZipArchive(const String& name, const String& archType, zzip_plugin_io_handlers* pluginIo)
         : Archive(name, archType), mZzipDir(0), mPluginIo(pluginIo)
     {
@@ -0,0 +1,352 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "Threading/OgreAsyncReadQueue.h"
+#include "OgreArchive.h"
+#include "OgreException.h"
+#include "OgreLogManager.h"
+#include "OgreResourceGroupManager.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        /// The smallest page size of the platforms supported
+        const size_t PAGE_SIZE = 4096;
+        /// Reads of streams with an unknown size grow by this much
+        const size_t READ_BLOCK_SIZE = 65536;
+
+        /// Reads a byte of every page, so the OS brings them into memory now
+        uchar touchPages(const uchar* data, size_t size)
+        {
+            // Volatile reads aren't optimised away
+            const volatile uchar* pages = data;
+            uchar sum = 0;
+            for (size_t i = 0; i < size; i += PAGE_SIZE)
+                sum += pages[i];
+            if (size)
+                sum += pages[size - 1];
+            return sum;
+        }
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::WorkerFunc::operator()()
+    {
+        mQueue->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::WorkerFunc::operator()() const
+    {
+        mQueue->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::WorkerFunc::run()
+    {
+        mQueue->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    AsyncReadQueue::AsyncReadQueue(const String& name)
+        : mName(name)
+        , mThreadCount(0)
+        , mIsRunning(false)
+        , mShuttingDown(false)
+        , mNextRequestID(0)
+        , mNumPending(0)
+#if OGRE_ASYNC_READ_THREADS
+        , mWorkerFunc(0)
+#endif
+    {
+    }
+    //---------------------------------------------------------------------
+    AsyncReadQueue::~AsyncReadQueue()
+    {
+        shutdown();
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::startup(bool forceRestart)
+    {
+        if (mIsRunning)
+        {
+            if (forceRestart)
+                shutdown();
+            else
+                return;
+        }
+
+        mShuttingDown = false;
+
+#if OGRE_ASYNC_READ_THREADS
+        LogManager::getSingleton().stream() <<
+            "AsyncReadQueue('" << mName << "') starting " << mThreadCount << " I/O threads.";
+
+        mWorkerFunc = OGRE_NEW_T(WorkerFunc(this), MEMCATEGORY_GENERAL);
+        OGRE_LOCK_MUTEX(mQueueMutex);
+        for (size_t i = 0; i < mThreadCount; ++i)
+        {
+            OGRE_THREAD_CREATE(t, *mWorkerFunc);
+            mThreads.push_back(t);
+        }
+#endif
+
+        mIsRunning = true;
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::shutdown()
+    {
+        if (!mIsRunning)
+            return;
+
+#if OGRE_ASYNC_READ_THREADS
+        LogManager::getSingleton().stream() <<
+            "AsyncReadQueue('" << mName << "') shutting down.";
+
+        ThreadList threads;
+        {
+            OGRE_LOCK_MUTEX(mQueueMutex);
+            mShuttingDown = true;
+            // Reads issued from now on run on the calling thread
+            threads.swap(mThreads);
+            // wake all threads, they exit once the queue is empty
+            OGRE_THREAD_NOTIFY_ALL(mQueueCondition);
+        }
+
+        for (ThreadList::iterator i = threads.begin(); i != threads.end(); ++i)
+        {
+            (*i)->join();
+            OGRE_THREAD_DESTROY(*i);
+        }
+
+        OGRE_DELETE_T(mWorkerFunc, WorkerFunc, MEMCATEGORY_GENERAL);
+        mWorkerFunc = 0;
+#endif
+
+        mIsRunning = false;
+    }
+    //---------------------------------------------------------------------
+    AsyncReadQueue::RequestID AsyncReadQueue::read(const DataStreamPtr& stream, size_t offset,
+        size_t count, Listener* listener)
+    {
+        Request request;
+        request.stream = stream;
+        request.offset = offset;
+        request.count = count;
+        request.archive = 0;
+        request.listener = listener;
+        return addRequest(request);
+    }
+    //---------------------------------------------------------------------
+    AsyncReadQueue::RequestID AsyncReadQueue::readFile(Archive* archive, const String& filename,
+        Listener* listener)
+    {
+        Request request;
+        request.offset = 0;
+        request.count = ~size_t(0);
+        request.archive = archive;
+        request.filename = filename;
+        request.listener = listener;
+        return addRequest(request);
+    }
+    //---------------------------------------------------------------------
+    AsyncReadQueue::RequestID AsyncReadQueue::readFile(const String& filename, const String& group,
+        Listener* listener)
+    {
+        Request request;
+        request.offset = 0;
+        request.count = ~size_t(0);
+        request.archive = 0;
+        request.filename = filename;
+        request.group = group;
+        request.listener = listener;
+        return addRequest(request);
+    }
+    //---------------------------------------------------------------------
+    bool AsyncReadQueue::abortRequest(RequestID id)
+    {
+        OGRE_LOCK_MUTEX(mQueueMutex);
+        for (RequestQueue::iterator i = mQueue.begin(); i != mQueue.end(); ++i)
+        {
+            if (i->id == id)
+            {
+                mQueue.erase(i);
+                --mNumPending;
+                return true;
+            }
+        }
+        return false;
+    }
+    //---------------------------------------------------------------------
+    AsyncReadQueue::RequestID AsyncReadQueue::addRequest(Request& request)
+    {
+        request.id = ++mNextRequestID;
+        ++mNumPending;
+
+#if OGRE_ASYNC_READ_THREADS
+        {
+            OGRE_LOCK_MUTEX(mQueueMutex);
+            if (!mThreads.empty())
+            {
+                mQueue.push_back(request);
+                OGRE_THREAD_NOTIFY_ONE(mQueueCondition);
+                return request.id;
+            }
+        }
+#endif
+
+        processRequest(request);
+        return request.id;
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::processRequest(const Request& request)
+    {
+        Result result;
+        result.id = request.id;
+        try
+        {
+            DataStreamPtr stream = request.stream;
+            if (!stream)
+            {
+                if (request.archive)
+                    stream = request.archive->open(request.filename);
+                else
+                    stream = ResourceGroupManager::getSingleton().openResource(request.filename, request.group);
+
+                if (!stream)
+                {
+                    OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                        "Cannot open file " + request.filename,
+                        "AsyncReadQueue::processRequest");
+                }
+            }
+            result.source = stream;
+            result.data = readStream(request, stream);
+        }
+        catch (Exception& e)
+        {
+            result.error = e.getFullDescription();
+        }
+        catch (std::exception& e)
+        {
+            // For example std::bad_alloc for a large file
+            result.error = e.what();
+        }
+
+        request.listener->readCompleted(result);
+        --mNumPending;
+    }
+    //---------------------------------------------------------------------
+    MemoryDataStreamPtr AsyncReadQueue::readStream(const Request& request, const DataStreamPtr& stream)
+    {
+        size_t size = stream->size();
+        size_t count = request.count;
+        if (size)
+            count = request.offset < size ? std::min(count, size - request.offset) : 0;
+
+        stream->seek(request.offset);
+
+        // In memory already, just make sure it's resident
+        const uchar* mem = stream->getCurrentMemoryPtr();
+        if (mem && size)
+        {
+            touchPages(mem, count);
+            return MemoryDataStreamPtr(OGRE_NEW StreamViewDataStream(stream, mem, count));
+        }
+
+        if (size)
+        {
+            MemoryDataStreamPtr data(OGRE_NEW MemoryDataStream(stream->getName(), count));
+            if (count && stream->read(data->getPtr(), count) != count)
+            {
+                OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                    "Unexpected end of stream " + stream->getName(),
+                    "AsyncReadQueue::readStream");
+            }
+            return data;
+        }
+
+        // Unknown size, read until the end
+        vector<uchar>::type buffer;
+        while (buffer.size() < count && !stream->eof())
+        {
+            size_t used = buffer.size();
+            buffer.resize(used + std::min(READ_BLOCK_SIZE, count - used));
+            buffer.resize(used + stream->read(&buffer[used], buffer.size() - used));
+            if (buffer.size() == used)
+                break;
+        }
+        MemoryDataStreamPtr data(OGRE_NEW MemoryDataStream(stream->getName(), buffer.size()));
+        if (!buffer.empty())
+            memcpy(data->getPtr(), &buffer[0], buffer.size());
+        return data;
+    }
+    //---------------------------------------------------------------------
+    void AsyncReadQueue::_threadMain()
+    {
+#if OGRE_ASYNC_READ_THREADS
+        while (true)
+        {
+            Request request;
+            {
+                OGRE_LOCK_MUTEX_NAMED(mQueueMutex, queueLock);
+                RequestQueue::iterator i;
+                while (true)
+                {
+                    // The first read whose stream isn't being read already
+                    for (i = mQueue.begin(); i != mQueue.end(); ++i)
+                    {
+                        if (!i->stream || !mBusyStreams.count(i->stream.get()))
+                            break;
+                    }
+                    if (i != mQueue.end())
+                        break;
+                    if (mShuttingDown && mQueue.empty())
+                        return;
+                    OGRE_THREAD_WAIT(mQueueCondition, mQueueMutex, queueLock);
+                }
+
+                request = *i;
+                mQueue.erase(i);
+                if (request.stream)
+                    mBusyStreams.insert(request.stream.get());
+            }
+
+            processRequest(request);
+
+            if (request.stream)
+            {
+                OGRE_LOCK_MUTEX(mQueueMutex);
+                mBusyStreams.erase(request.stream.get());
+                // Reads of the stream may have been waiting
+                OGRE_THREAD_NOTIFY_ALL(mQueueCondition);
+            }
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,281 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "Threading/OgreTaskScheduler.h"
+#include "OgreLogManager.h"
+
+namespace Ogre
+{
+    //---------------------------------------------------------------------
+    Task::Task()
+        : mUnfinished(1)
+        , mFinished(0)
+        , mDependentsClosed(false)
+        , mScheduler(0)
+    {
+    }
+    //---------------------------------------------------------------------
+    Task::~Task()
+    {
+    }
+    //---------------------------------------------------------------------
+    void Task::addDependency(Task* task)
+    {
+        OGRE_LOCK_MUTEX(task->mDependentsMutex);
+
+        // Already finished, nothing to wait for
+        if (task->mDependentsClosed)
+            return;
+
+        ++mUnfinished;
+        task->mDependents.push_back(this);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void TaskScheduler::WorkerFunc::operator()()
+    {
+        mScheduler->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::WorkerFunc::operator()() const
+    {
+        mScheduler->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::WorkerFunc::run()
+    {
+        mScheduler->_threadMain();
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    TaskScheduler::TaskScheduler(const String& name)
+        : mName(name)
+        , mWorkerThreadCount(0)
+        , mIsRunning(false)
+        , mShuttingDown(false)
+        , mNumQueued(0)
+#if OGRE_TASK_SCHEDULER_THREADS
+        , mNumSleeping(0)
+        , mWorkerFunc(0)
+#endif
+    {
+    }
+    //---------------------------------------------------------------------
+    TaskScheduler::~TaskScheduler()
+    {
+        shutdown();
+        // Tasks submitted without anyone waiting for them
+        while (_runNextTask()) {}
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::startup(bool forceRestart)
+    {
+        if (mIsRunning)
+        {
+            if (forceRestart)
+                shutdown();
+            else
+                return;
+        }
+
+        mShuttingDown = false;
+
+#if OGRE_TASK_SCHEDULER_THREADS
+        LogManager::getSingleton().stream() <<
+            "TaskScheduler('" << mName << "') starting " << mWorkerThreadCount << " worker threads.";
+
+        mWorkerFunc = OGRE_NEW_T(WorkerFunc(this), MEMCATEGORY_GENERAL);
+        for (size_t i = 0; i < mWorkerThreadCount; ++i)
+        {
+            OGRE_THREAD_CREATE(t, *mWorkerFunc);
+            mWorkers.push_back(t);
+        }
+#endif
+
+        mIsRunning = true;
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::shutdown()
+    {
+        if (!mIsRunning)
+            return;
+
+#if OGRE_TASK_SCHEDULER_THREADS
+        LogManager::getSingleton().stream() <<
+            "TaskScheduler('" << mName << "') shutting down.";
+
+        {
+            OGRE_LOCK_MUTEX(mQueueMutex);
+            mShuttingDown = true;
+            // wake all threads, they exit once the queue is empty
+            OGRE_THREAD_NOTIFY_ALL(mQueueCondition);
+        }
+
+        for (WorkerThreadList::iterator i = mWorkers.begin(); i != mWorkers.end(); ++i)
+        {
+            (*i)->join();
+            OGRE_THREAD_DESTROY(*i);
+        }
+        mWorkers.clear();
+
+        OGRE_DELETE_T(mWorkerFunc, WorkerFunc, MEMCATEGORY_GENERAL);
+        mWorkerFunc = 0;
+#endif
+
+        mIsRunning = false;
+    }
+    //---------------------------------------------------------------------
+    size_t TaskScheduler::getNumThreads() const
+    {
+#if OGRE_TASK_SCHEDULER_THREADS
+        return mWorkers.size() + 1;
+#else
+        return 1;
+#endif
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::submit(Task* task)
+    {
+        {
+            OGRE_LOCK_MUTEX(task->mDependentsMutex);
+            task->mDependentsClosed = false;
+        }
+        task->mFinished.set(0);
+        task->mScheduler = this;
+
+        // Release the count held until submission
+        if (--task->mUnfinished == 0)
+            enqueue(task);
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::enqueue(Task* task)
+    {
+        OGRE_LOCK_MUTEX(mQueueMutex);
+        mQueue.push_back(task);
+        ++mNumQueued;
+#if OGRE_TASK_SCHEDULER_THREADS
+        if (mNumSleeping.get())
+            OGRE_THREAD_NOTIFY_ONE(mQueueCondition);
+#endif
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::finish(Task* task)
+    {
+        Task::TaskList dependents;
+        {
+            OGRE_LOCK_MUTEX(task->mDependentsMutex);
+            task->mDependentsClosed = true;
+            dependents.swap(task->mDependents);
+        }
+        task->mUnfinished.set(1);
+
+        // Last access to the task, a waiting thread may destroy it right away.
+        // This is a full barrier, so either the waiting thread sees the task
+        // finished or it is counted as sleeping below. It comes before the
+        // dependents are released, so they never see it unfinished.
+        task->mFinished.cas(0, 1);
+
+        for (Task::TaskList::iterator i = dependents.begin(); i != dependents.end(); ++i)
+        {
+            if (--(*i)->mUnfinished == 0)
+                (*i)->mScheduler->enqueue(*i);
+        }
+
+#if OGRE_TASK_SCHEDULER_THREADS
+        if (mNumSleeping.get())
+        {
+            OGRE_LOCK_MUTEX(mQueueMutex);
+            OGRE_THREAD_NOTIFY_ALL(mQueueCondition);
+        }
+#endif
+    }
+    //---------------------------------------------------------------------
+    bool TaskScheduler::_runNextTask()
+    {
+        if (!mNumQueued.get())
+            return false;
+
+        Task* task;
+        {
+            OGRE_LOCK_MUTEX(mQueueMutex);
+            if (mQueue.empty())
+                return false;
+            task = mQueue.front();
+            mQueue.pop_front();
+            --mNumQueued;
+        }
+
+        task->execute();
+        finish(task);
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::wait(Task* task)
+    {
+        while (!task->isFinished())
+        {
+            // Help rather than block
+            if (_runNextTask())
+                continue;
+
+#if OGRE_TASK_SCHEDULER_THREADS
+            // Running on another thread
+            OGRE_LOCK_MUTEX_NAMED(mQueueMutex, queueLock);
+            ++mNumSleeping;
+            if (!task->isFinished() && !mNumQueued.get())
+                OGRE_THREAD_WAIT(mQueueCondition, mQueueMutex, queueLock);
+            --mNumSleeping;
+#else
+            // Everything runs on this thread, so the task or one of its
+            // dependencies was never submitted
+            assert(false && "Waiting for a task which can't run");
+            return;
+#endif
+        }
+    }
+    //---------------------------------------------------------------------
+    void TaskScheduler::_threadMain()
+    {
+#if OGRE_TASK_SCHEDULER_THREADS
+        while (true)
+        {
+            if (_runNextTask())
+                continue;
+
+            OGRE_LOCK_MUTEX_NAMED(mQueueMutex, queueLock);
+            if (mShuttingDown && mQueue.empty())
+                break;
+            ++mNumSleeping;
+            if (!mShuttingDown && !mNumQueued.get())
+                OGRE_THREAD_WAIT(mQueueCondition, mQueueMutex, queueLock);
+            --mNumSleeping;
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,637 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "Threading/OgreWorkStealingWorkQueue.h"
+#include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+
+namespace Ogre
+{
+    /// Number of requests each worker queue can hold before spilling over
+    static const size_t RING_CAPACITY = 1024;
+    /// Index used for threads which don't own a ring
+    static const size_t NO_RING = ~size_t(0);
+
+    //---------------------------------------------------------------------
+    // The rings follow the well known bounded queue design where every cell
+    // carries a sequence number telling whether it is free for the push or
+    // the pop at a given position. All read-modify-write operations of
+    // AtomicScalar are full barriers, they order the accesses to the cells.
+    //---------------------------------------------------------------------
+    WorkStealingWorkQueue::RequestRing::RequestRing(size_t capacity)
+        : mCells(capacity)
+        , mMask(capacity - 1)
+        , mPushPos(0)
+        , mPopPos(0)
+    {
+        assert((capacity & mMask) == 0 && "Capacity must be a power of two");
+
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            mCells[i].sequence.set(i);
+            mCells[i].request = 0;
+        }
+    }
+    //---------------------------------------------------------------------
+    bool WorkStealingWorkQueue::RequestRing::push(Request* r)
+    {
+        size_t pos = mPushPos.get();
+        while (true)
+        {
+            Cell& cell = mCells[pos & mMask];
+            ptrdiff_t diff = static_cast<ptrdiff_t>(cell.sequence.get() - pos);
+            if (diff == 0)
+            {
+                // Free for this position, claim it
+                if (mPushPos.cas(pos, pos + 1))
+                {
+                    cell.request = r;
+                    // Publish, the cell is ours so this always succeeds
+                    cell.sequence.cas(pos, pos + 1);
+                    return true;
+                }
+                pos = mPushPos.get();
+            }
+            else if (diff < 0)
+            {
+                // Still holds the request pushed one lap ago
+                return false;
+            }
+            else
+            {
+                // Another producer got there first
+                pos = mPushPos.get();
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    WorkQueue::Request* WorkStealingWorkQueue::RequestRing::pop()
+    {
+        size_t pos = mPopPos.get();
+        while (true)
+        {
+            Cell& cell = mCells[pos & mMask];
+            ptrdiff_t diff = static_cast<ptrdiff_t>(cell.sequence.get() - (pos + 1));
+            if (diff == 0)
+            {
+                // Holds the request for this position, claim it
+                if (mPopPos.cas(pos, pos + 1))
+                {
+                    Request* r = cell.request;
+                    // Free the cell for the push one lap ahead
+                    cell.sequence.cas(pos + 1, pos + mMask + 1);
+                    return r;
+                }
+                pos = mPopPos.get();
+            }
+            else if (diff < 0)
+            {
+                // Nothing pushed at this position yet
+                return 0;
+            }
+            else
+            {
+                // Another consumer got there first
+                pos = mPopPos.get();
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::IndexedWorkerFunc::operator()()
+    {
+        mQueue->_threadMain(mIndex);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::IndexedWorkerFunc::operator()() const
+    {
+        mQueue->_threadMain(mIndex);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::IndexedWorkerFunc::run()
+    {
+        mQueue->_threadMain(mIndex);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    WorkStealingWorkQueue::WorkStealingWorkQueue(const String& name)
+        : DefaultWorkQueueBase(name)
+        , mNextRing(0)
+        , mNextRequestID(0)
+        , mNumQueued(0)
+        , mOverflowQueued(0)
+        , mIdleQueued(0)
+        , mNumSleeping(0)
+        , mNumThreadsRegisteredWithRS(0)
+    {
+    }
+    //---------------------------------------------------------------------
+    WorkStealingWorkQueue::~WorkStealingWorkQueue()
+    {
+        shutdown();
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::startup(bool forceRestart)
+    {
+        if (mIsRunning)
+        {
+            if (forceRestart)
+                shutdown();
+            else
+                return;
+        }
+
+        mShuttingDown = false;
+
+        LogManager::getSingleton().stream() <<
+            "WorkStealingWorkQueue('" << mName << "') initialising on thread " <<
+#if OGRE_THREAD_SUPPORT
+            OGRE_THREAD_CURRENT_ID
+#else
+            "main"
+#endif
+            << ".";
+
+#if OGRE_THREAD_SUPPORT
+        // A ring even without workers, so _processNextRequest can be driven manually
+        size_t numRings = std::max(mWorkerThreadCount, size_t(1));
+        for (size_t i = 0; i < numRings; ++i)
+            mRings.push_back(OGRE_NEW RequestRing(RING_CAPACITY));
+
+        if (mWorkerRenderSystemAccess)
+            Root::getSingleton().getRenderSystem()->preExtraThreadsStarted();
+
+        mNumThreadsRegisteredWithRS = 0;
+        for (size_t i = 0; i < mWorkerThreadCount; ++i)
+        {
+            IndexedWorkerFunc* func = OGRE_NEW_T(IndexedWorkerFunc(this, i), MEMCATEGORY_GENERAL);
+            mWorkerFuncs.push_back(func);
+            OGRE_THREAD_CREATE(t, *func);
+            mWorkers.push_back(t);
+        }
+
+        if (mWorkerRenderSystemAccess)
+        {
+            OGRE_LOCK_MUTEX_NAMED(mInitMutex, initLock);
+            // have to wait until all threads are registered with the render system
+            while (mNumThreadsRegisteredWithRS < mWorkerThreadCount)
+                OGRE_THREAD_WAIT(mInitSync, mInitMutex, initLock);
+
+            Root::getSingleton().getRenderSystem()->postExtraThreadsStarted();
+        }
+
+        // Requests added before startup wait in the overflow queue
+        notifyWorkers();
+#endif
+
+        mIsRunning = true;
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::notifyThreadRegistered()
+    {
+        OGRE_LOCK_MUTEX(mInitMutex);
+
+        ++mNumThreadsRegisteredWithRS;
+
+        // wake up main thread
+        OGRE_THREAD_NOTIFY_ALL(mInitSync);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::shutdown()
+    {
+        if (!mIsRunning)
+            return;
+
+        LogManager::getSingleton().stream() <<
+            "WorkStealingWorkQueue('" << mName << "') shutting down on thread " <<
+#if OGRE_THREAD_SUPPORT
+            OGRE_THREAD_CURRENT_ID
+#else
+            "main"
+#endif
+            << ".";
+
+        mShuttingDown = true;
+        abortAllRequests();
+#if OGRE_THREAD_SUPPORT
+        {
+            // wake all threads (they check shutting down as first thing after wait)
+            OGRE_LOCK_MUTEX(mSleepMutex);
+            OGRE_THREAD_NOTIFY_ALL(mRequestCondition);
+        }
+
+        for (WorkerThreadList::iterator i = mWorkers.begin(); i != mWorkers.end(); ++i)
+        {
+            (*i)->join();
+            OGRE_THREAD_DESTROY(*i);
+        }
+        mWorkers.clear();
+
+        for (WorkerFuncList::iterator i = mWorkerFuncs.begin(); i != mWorkerFuncs.end(); ++i)
+            OGRE_DELETE_T(*i, IndexedWorkerFunc, MEMCATEGORY_GENERAL);
+        mWorkerFuncs.clear();
+
+        // Keep what's left for a restart, the base class deletes it otherwise
+        {
+            OGRE_LOCK_MUTEX(mRequestMutex);
+            for (RequestRingList::iterator i = mRings.begin(); i != mRings.end(); ++i)
+            {
+                while (Request* r = (*i)->pop())
+                {
+                    --mNumQueued;
+                    mRequestQueue.push_back(r);
+                }
+                OGRE_DELETE *i;
+            }
+            mRings.clear();
+            mOverflowQueued.set(mRequestQueue.empty() ? 0 : 1);
+        }
+#endif
+
+        mIsRunning = false;
+    }
+    //---------------------------------------------------------------------
+    WorkQueue::RequestID WorkStealingWorkQueue::addRequest(uint16 channel, uint16 requestType,
+        const Any& rData, uint8 retryCount, bool forceSynchronous, bool idleThread)
+    {
+        if (!mAcceptRequests || mShuttingDown)
+            return 0;
+
+        RequestID rid = ++mNextRequestID;
+        Request* req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid);
+
+#if OGRE_THREAD_SUPPORT
+        if (idleThread)
+        {
+            OGRE_LOCK_MUTEX(mIdleMutex);
+            mIdleRequestQueue.push_back(req);
+            if (!mIdleThreadRunning)
+                notifyWorkers();
+            return rid;
+        }
+
+        if (!forceSynchronous)
+        {
+            {
+                PendingRequests& pending = getPending(rid);
+                OGRE_LOCK_MUTEX(pending.mutex);
+                pending.queued[rid] = req;
+            }
+            pushRequest(req);
+            return rid;
+        }
+#endif
+
+        processRequestSynchronous(req);
+        return rid;
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::pushRequest(Request* r)
+    {
+        size_t numRings = mRings.size();
+        size_t first = mNextRing++;
+        for (size_t i = 0; i < numRings; ++i)
+        {
+            if (mRings[(first + i) % numRings]->push(r))
+            {
+                ++mNumQueued;
+                wakeWorker();
+                return;
+            }
+        }
+
+        // All full, or not started yet
+        OGRE_LOCK_MUTEX(mRequestMutex);
+        mRequestQueue.push_back(r);
+        notifyWorkers();
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::notifyWorkers()
+    {
+        // Called with mRequestMutex or mIdleMutex locked, so the flag can't be
+        // cleared before the request it announces is visible
+        mOverflowQueued.cas(0, 1);
+        mIdleQueued.cas(0, 1);
+        wakeWorker();
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::wakeWorker()
+    {
+#if OGRE_THREAD_SUPPORT
+        // The caller has published the request with a full barrier, so either
+        // a worker about to sleep sees it, or it is counted as sleeping here
+        if (mNumSleeping.get())
+        {
+            OGRE_LOCK_MUTEX(mSleepMutex);
+            OGRE_THREAD_NOTIFY_ONE(mRequestCondition);
+        }
+#endif
+    }
+    //---------------------------------------------------------------------
+    bool WorkStealingWorkQueue::hasQueuedRequests() const
+    {
+        return mNumQueued.get() || mOverflowQueued.get() || mIdleQueued.get();
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::waitForNextRequest()
+    {
+#if OGRE_THREAD_SUPPORT
+        OGRE_LOCK_MUTEX_NAMED(mSleepMutex, sleepLock);
+        ++mNumSleeping;
+        if (!isShuttingDown() && !hasQueuedRequests())
+        {
+            // frees lock and suspends the thread
+            OGRE_THREAD_WAIT(mRequestCondition, mSleepMutex, sleepLock);
+        }
+        --mNumSleeping;
+#endif
+    }
+    //---------------------------------------------------------------------
+    WorkQueue::Request* WorkStealingWorkQueue::takeRequest(size_t workerIndex)
+    {
+        // Own ring first, then steal from the others
+        size_t numRings = mRings.size();
+        size_t first = workerIndex < numRings ? workerIndex : 0;
+        for (size_t i = 0; i < numRings && mNumQueued.get(); ++i)
+        {
+            if (Request* r = mRings[(first + i) % numRings]->pop())
+            {
+                --mNumQueued;
+                return r;
+            }
+        }
+
+        if (mOverflowQueued.get())
+        {
+            mOverflowQueued.set(0);
+            OGRE_LOCK_MUTEX(mRequestMutex);
+            if (!mRequestQueue.empty())
+            {
+                Request* r = mRequestQueue.front();
+                mRequestQueue.pop_front();
+                if (!mRequestQueue.empty())
+                    mOverflowQueued.cas(0, 1);
+                return r;
+            }
+        }
+
+        return 0;
+    }
+    //---------------------------------------------------------------------
+    bool WorkStealingWorkQueue::processNextRequest(size_t workerIndex)
+    {
+        if (mIdleQueued.get())
+        {
+            mIdleQueued.set(0);
+            if (processIdleRequests())
+                return true;
+        }
+
+        Request* r = takeRequest(workerIndex);
+        if (!r)
+            return false;
+
+        processQueuedRequest(r);
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::_processNextRequest()
+    {
+        processNextRequest(NO_RING);
+    }
+    //---------------------------------------------------------------------
+    WorkQueue::Response* WorkStealingWorkQueue::handleRequest(Request* r)
+    {
+        // Unlike DefaultWorkQueueBase::processRequest, copy the handlers of this
+        // channel only and don't log every request, both serialise the workers
+        RequestHandlerList handlers;
+        {
+            OGRE_LOCK_RW_MUTEX_READ(mRequestHandlerMutex);
+            RequestHandlerListByChannel::iterator i = mRequestHandlers.find(r->getChannel());
+            if (i != mRequestHandlers.end())
+                handlers = i->second;
+        }
+
+        Response* response = 0;
+        for (RequestHandlerList::reverse_iterator j = handlers.rbegin(); j != handlers.rend() && !response; ++j)
+        {
+            // threadsafe call which tests canHandleRequest and calls it if so
+            response = (*j)->handleRequest(r, this);
+        }
+        return response;
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::processQueuedRequest(Request* r)
+    {
+        const RequestID rid = r->getID();
+        PendingRequests& pending = getPending(rid);
+        {
+            OGRE_LOCK_MUTEX(pending.mutex);
+            pending.queued.erase(rid);
+            pending.processing[rid] = r;
+        }
+
+        Response* response = handleRequest(r);
+
+        // Stay registered until the response is queued, so aborts can't miss it
+        OGRE_LOCK_MUTEX(pending.mutex);
+        pending.processing.erase(rid);
+
+        if (!response)
+        {
+            if (!r->getAborted())
+            {
+                LogManager::getSingleton().stream() <<
+                    "WorkStealingWorkQueue('" << mName << "') warning: no handler processed request "
+                    << rid << ", channel " << r->getChannel()
+                    << ", type " << r->getType();
+            }
+            OGRE_DELETE r;
+            return;
+        }
+
+        if (!response->succeeded() && r->getRetryCount() && !mShuttingDown)
+        {
+            Request* retry = OGRE_NEW Request(r->getChannel(), r->getType(), r->getData(),
+                r->getRetryCount() - 1, rid);
+            pending.queued[rid] = retry;
+            // discard response (this also deletes request)
+            OGRE_DELETE response;
+            pushRequest(retry);
+            return;
+        }
+
+        if (r->getAborted())
+        {
+            // destroy response user data
+            response->abortRequest();
+        }
+        OGRE_LOCK_MUTEX(mResponseMutex);
+        mResponseQueue.push_back(response);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::processRequestSynchronous(Request* r)
+    {
+        Response* response = 0;
+        while (true)
+        {
+            response = handleRequest(r);
+            if (!response)
+            {
+                LogManager::getSingleton().stream() <<
+                    "WorkStealingWorkQueue('" << mName << "') warning: no handler processed request "
+                    << r->getID() << ", channel " << r->getChannel()
+                    << ", type " << r->getType();
+                OGRE_DELETE r;
+                return;
+            }
+
+            if (response->succeeded() || !r->getRetryCount() || mShuttingDown)
+                break;
+
+            // Retried right away, the caller expects it to be done on return
+            Request* retry = OGRE_NEW Request(r->getChannel(), r->getType(), r->getData(),
+                r->getRetryCount() - 1, r->getID());
+            // discard response (this also deletes request)
+            OGRE_DELETE response;
+            r = retry;
+        }
+
+        processResponse(response);
+        OGRE_DELETE response;
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::abortRequest(RequestID id)
+    {
+        {
+            PendingRequests& pending = getPending(id);
+            OGRE_LOCK_MUTEX(pending.mutex);
+
+            PendingRequests::RequestMap::iterator i = pending.queued.find(id);
+            if (i != pending.queued.end())
+                i->second->abortRequest();
+            i = pending.processing.find(id);
+            if (i != pending.processing.end())
+                i->second->abortRequest();
+        }
+
+        // Overflow, idle and response queues
+        DefaultWorkQueueBase::abortRequest(id);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::abortRequestsByChannel(uint16 channel)
+    {
+        for (size_t p = 0; p < NUM_PENDING_PARTS; ++p)
+        {
+            PendingRequests& pending = mPending[p];
+            OGRE_LOCK_MUTEX(pending.mutex);
+
+            PendingRequests::RequestMap::iterator i;
+            for (i = pending.queued.begin(); i != pending.queued.end(); ++i)
+            {
+                if (i->second->getChannel() == channel)
+                    i->second->abortRequest();
+            }
+            for (i = pending.processing.begin(); i != pending.processing.end(); ++i)
+            {
+                if (i->second->getChannel() == channel)
+                    i->second->abortRequest();
+            }
+        }
+
+        DefaultWorkQueueBase::abortRequestsByChannel(channel);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::abortPendingRequestsByChannel(uint16 channel)
+    {
+        for (size_t p = 0; p < NUM_PENDING_PARTS; ++p)
+        {
+            PendingRequests& pending = mPending[p];
+            OGRE_LOCK_MUTEX(pending.mutex);
+
+            for (PendingRequests::RequestMap::iterator i = pending.queued.begin(); i != pending.queued.end(); ++i)
+            {
+                if (i->second->getChannel() == channel)
+                    i->second->abortRequest();
+            }
+        }
+
+        DefaultWorkQueueBase::abortPendingRequestsByChannel(channel);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::abortAllRequests()
+    {
+        for (size_t p = 0; p < NUM_PENDING_PARTS; ++p)
+        {
+            PendingRequests& pending = mPending[p];
+            OGRE_LOCK_MUTEX(pending.mutex);
+
+            PendingRequests::RequestMap::iterator i;
+            for (i = pending.queued.begin(); i != pending.queued.end(); ++i)
+                i->second->abortRequest();
+            for (i = pending.processing.begin(); i != pending.processing.end(); ++i)
+                i->second->abortRequest();
+        }
+
+        DefaultWorkQueueBase::abortAllRequests();
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::_threadMain()
+    {
+        _threadMain(NO_RING);
+    }
+    //---------------------------------------------------------------------
+    void WorkStealingWorkQueue::_threadMain(size_t workerIndex)
+    {
+#if OGRE_THREAD_SUPPORT
+        LogManager::getSingleton().stream() <<
+            "WorkStealingWorkQueue('" << getName() << "')::WorkerFunc - thread "
+            << OGRE_THREAD_CURRENT_ID << " starting.";
+
+        // Initialise the thread for RS if necessary
+        if (mWorkerRenderSystemAccess)
+        {
+            Root::getSingleton().getRenderSystem()->registerThread();
+            notifyThreadRegistered();
+        }
+
+        // Spin forever until we're told to shut down
+        while (!isShuttingDown())
+        {
+            if (!processNextRequest(workerIndex))
+                waitForNextRequest();
+        }
+
+        LogManager::getSingleton().stream() <<
+            "WorkStealingWorkQueue('" << getName() << "')::WorkerFunc - thread "
+            << OGRE_THREAD_CURRENT_ID << " stopped.";
+#endif
+    }
+
+}
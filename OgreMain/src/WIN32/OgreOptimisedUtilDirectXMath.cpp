@@ -99,6 +99,8 @@ namespace DirectX
 
 namespace Ogre {
 
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+
 //-------------------------------------------------------------------------
 // Local classes
 //-------------------------------------------------------------------------
@@ -159,6 +161,25 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateNodeTransforms
+        virtual void concatenateNodeTransforms(
+            const float* const* localStreams,
+            float* const* derivedStreams,
+            const uint32* parentIndices,
+            const uint32* inheritOrientation,
+            const uint32* inheritScale,
+            size_t first,
+            size_t numNodes);
+
+        /// @copydoc OptimisedUtil::calculateBoxVisibility
+        virtual void calculateBoxVisibility(
+            const float* planes,
+            size_t numPlanes,
+            const float* centres,
+            const float* halfSizes,
+            uint32* visibility,
+            size_t numBoxes);
     };
 
 //---------------------------------------------------------------------
@@ -2032,6 +2053,34 @@ static OGRE_FORCE_INLINE bool _isAlignedForDirectXMath(const void *p)
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilDirectXMath::concatenateNodeTransforms(
+        const float* const* localStreams,
+        float* const* derivedStreams,
+        const uint32* parentIndices,
+        const uint32* inheritOrientation,
+        const uint32* inheritScale,
+        size_t first,
+        size_t numNodes)
+    {
+        // The gather of the parent transforms dominates, no gain over the general version
+        _getOptimisedUtilGeneral()->concatenateNodeTransforms(
+            localStreams, derivedStreams,
+            parentIndices, inheritOrientation, inheritScale,
+            first, numNodes);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilDirectXMath::calculateBoxVisibility(
+        const float* planes,
+        size_t numPlanes,
+        const float* centres,
+        const float* halfSizes,
+        uint32* visibility,
+        size_t numBoxes)
+    {
+        _getOptimisedUtilGeneral()->calculateBoxVisibility(
+            planes, numPlanes, centres, halfSizes, visibility, numBoxes);
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilDirectXMath(void)
@@ -129,6 +129,11 @@ protected:
     */
     void _updateBounds( void );
 
+    /** Overridden from Node to move this node to its new octant, which can't be
+        done while the scene graph is being updated in parallel.
+    */
+    void deferredUpdateImpl( void );
+
     void _removeNodeAndChildren( );
 
     /// Local bounding box
@@ -121,6 +121,11 @@ public:
         VisibleObjectsBoundsInfo* visibleBounds, bool foundvisible, 
         bool onlyShadowCasters);
 
+    /** Walks through the octree like walkOctree, but only collects the nodes of
+        the visible octants into mCullCandidates for the worker threads to cull.
+    */
+    void gatherOctreeNodes( OctreeCamera *, Octree *, bool foundvisible );
+
     /** Checks the given OctreeNode, and determines if it needs to be moved
     * to a different octant.
     */
@@ -187,10 +192,16 @@ public:
     IntersectionSceneQuery* createIntersectionQuery(uint32 mask);
 
 protected:
-
+    /// Culls the given thread's share of mCullCandidates
+    virtual void findVisibleObjectsThread(size_t threadIdx);
 
     Octree::NodeList mVisible;
 
+    /// Nodes in visible octants, in the order walkOctree would visit them
+    vector< OctreeNode * >::type mCullCandidates;
+    /// Per candidate, 1 if known to be visible, otherwise set by the worker threads
+    vector< char >::type mCullVisibility;
+
     /// The root octree
     Octree *mOctree;
 
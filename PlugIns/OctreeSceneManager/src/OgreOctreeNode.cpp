@@ -132,11 +132,29 @@ void OctreeNode::_updateBounds( void )
     // enough to leave it's current node, we'll update it.
     if ( ! mWorldAABB.isNull() && mIsInSceneGraph )
     {
-        static_cast < OctreeSceneManager * > ( mCreator ) -> _updateOctreeNode( this );
+        if ( Node::_getDeferUpdateCallbacks() )
+        {
+            // The octree may only be modified from the main thread, so just check
+            // whether we have left our octant and move later if so
+            if ( mOctant == 0 || ! _isIn( mOctant -> mBox ) )
+                queueDeferredUpdate();
+        }
+        else
+        {
+            static_cast < OctreeSceneManager * > ( mCreator ) -> _updateOctreeNode( this );
+        }
     }
 
 }
 
+void OctreeNode::deferredUpdateImpl( void )
+{
+    if ( ! mWorldAABB.isNull() && mIsInSceneGraph )
+    {
+        static_cast < OctreeSceneManager * > ( mCreator ) -> _updateOctreeNode( this );
+    }
+}
+
 /** Since we are loose, only check the center.
 */
 bool OctreeNode::_isIn( AxisAlignedBox &box )
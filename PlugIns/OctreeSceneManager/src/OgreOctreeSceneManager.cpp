@@ -572,9 +572,45 @@ void OctreeSceneManager::_findVisibleObjects(Camera * cam,
 
     mNumObjects = 0;
 
-    //walk the octree, adding all visible Octreenodes nodes to the render queue.
-    walkOctree( static_cast < OctreeCamera * > ( cam ), getRenderQueue(), mOctree, 
-                visibleBounds, false, onlyShadowCasters );
+    if ( mNumWorkerThreads > 0 )
+    {
+        // Walk the octree here, test the nodes on all threads, then queue them here
+        mCullCandidates.clear();
+        mCullVisibility.clear();
+        gatherOctreeNodes( static_cast < OctreeCamera * > ( cam ), mOctree, false );
+
+        // Make any pending updates to the frustum planes before the worker threads read them
+        cam->getFrustumPlane( FRUSTUM_PLANE_NEAR );
+        mCullCamera = cam;
+        fireWorkerThreadsAndWait( WTR_FIND_VISIBLE_OBJECTS );
+        mCullCamera = 0;
+
+        RenderQueue* queue = getRenderQueue();
+        for ( size_t i = 0; i < mCullCandidates.size(); ++i )
+        {
+            if ( !mCullVisibility[ i ] )
+                continue;
+
+            OctreeNode * sn = mCullCandidates[ i ];
+            mNumObjects++;
+            sn -> _addToRenderQueue(cam, queue, onlyShadowCasters, visibleBounds );
+
+            mVisible.push_back( sn );
+
+            if ( mDisplayNodes )
+                queue -> addRenderable( sn->getDebugRenderable() );
+
+            // check if the scene manager or this node wants the bounding box shown.
+            if (sn->getShowBoundingBox() || mShowBoundingBoxes)
+                sn->_addBoundingBoxToQueue(queue);
+        }
+    }
+    else
+    {
+        //walk the octree, adding all visible Octreenodes nodes to the render queue.
+        walkOctree( static_cast < OctreeCamera * > ( cam ), getRenderQueue(), mOctree, 
+                    visibleBounds, false, onlyShadowCasters );
+    }
 
     // Show the octree boxes & cull camera if required
     if ( mShowBoxes )
@@ -586,6 +622,48 @@ void OctreeSceneManager::_findVisibleObjects(Camera * cam,
     }
 }
 
+/** Number of nodes culled with a single batched test. */
+static const size_t CULL_BATCH_SIZE = 64;
+
+/** Culls up to CULL_BATCH_SIZE nodes against the camera at once.
+@remarks
+    Null boxes are never visible and infinite boxes always are, exactly like
+    Camera::isVisible( const AxisAlignedBox & ) treats them.
+*/
+static void cullNodeBatch( const Camera *camera, OctreeNode * const *nodes, size_t numNodes, char *visibility )
+{
+    assert( numNodes <= CULL_BATCH_SIZE );
+
+    float centres[ CULL_BATCH_SIZE * 3 ];
+    float halfSizes[ CULL_BATCH_SIZE * 3 ];
+    uint32 bits[ CULL_BATCH_SIZE / 32 ];
+    size_t indices[ CULL_BATCH_SIZE ];
+    size_t numBoxes = 0;
+
+    for ( size_t i = 0; i < numNodes; ++i )
+    {
+        const AxisAlignedBox &box = nodes[ i ] -> _getWorldAABB();
+        if ( box.isFinite() )
+        {
+            Vector3 centre = box.getCenter();
+            Vector3 halfSize = box.getHalfSize();
+            for ( size_t j = 0; j < 3; ++j )
+            {
+                centres[ numBoxes * 3 + j ] = static_cast< float >( centre[ j ] );
+                halfSizes[ numBoxes * 3 + j ] = static_cast< float >( halfSize[ j ] );
+            }
+            indices[ numBoxes++ ] = i;
+        }
+        visibility[ i ] = box.isInfinite();
+    }
+
+    if ( numBoxes == 0 || !camera -> isVisible( centres, halfSizes, numBoxes, bits ) )
+        return;
+
+    for ( size_t i = 0; i < numBoxes; ++i )
+        visibility[ indices[ i ] ] = ( bits[ i >> 5 ] >> ( i & 31 ) ) & 1;
+}
+
 void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue, 
     Octree *octant, VisibleObjectsBoundsInfo* visibleBounds, 
     bool foundvisible, bool onlyShadowCasters )
@@ -627,20 +705,29 @@ void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue,
             mBoxes.push_back( octant->getWireBoundingBox() );
         }
 
-        bool vis = true;
+        OctreeNode * batch[ CULL_BATCH_SIZE ];
+        char vis[ CULL_BATCH_SIZE ];
 
         while ( it != octant -> mNodes.end() )
         {
-            OctreeNode * sn = *it;
+            size_t numNodes = 0;
+            while ( it != octant -> mNodes.end() && numNodes < CULL_BATCH_SIZE )
+                batch[ numNodes++ ] = *it++;
 
             // if this octree is partially visible, manually cull all
             // scene nodes attached directly to this level.
 
             if ( v == OctreeCamera::PARTIAL )
-                vis = camera -> isVisible( sn -> _getWorldAABB() );
+                cullNodeBatch( camera, batch, numNodes, vis );
+            else
+                std::fill( vis, vis + numNodes, 1 );
 
-            if ( vis )
+            for ( size_t i = 0; i < numNodes; ++i )
             {
+                if ( !vis[ i ] )
+                    continue;
+
+                OctreeNode * sn = batch[ i ];
 
                 mNumObjects++;
                 sn -> _addToRenderQueue(camera, queue, onlyShadowCasters, visibleBounds );
@@ -654,8 +741,6 @@ void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue,
                 if (sn->getShowBoundingBox() || mShowBoundingBoxes)
                     sn->_addBoundingBoxToQueue(queue);
             }
-
-            ++it;
         }
 
         Octree* child;
@@ -688,6 +773,93 @@ void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue,
 
 }
 
+void OctreeSceneManager::gatherOctreeNodes( OctreeCamera *camera, Octree *octant, bool foundvisible )
+{
+    //return immediately if nothing is in the node.
+    if ( octant -> numNodes() == 0 )
+        return ;
+
+    OctreeCamera::Visibility v = OctreeCamera::NONE;
+
+    if ( foundvisible )
+    {
+        v = OctreeCamera::FULL;
+    }
+
+    else if ( octant == mOctree )
+    {
+        v = OctreeCamera::PARTIAL;
+    }
+
+    else
+    {
+        AxisAlignedBox box;
+        octant -> _getCullBounds( &box );
+        v = camera -> getVisibility( box );
+    }
+
+    if ( v != OctreeCamera::NONE )
+    {
+        if ( mShowBoxes )
+        {
+            mBoxes.push_back( octant->getWireBoundingBox() );
+        }
+
+        // Nodes of partially visible octants are culled by the worker threads
+        char visible = ( v == OctreeCamera::FULL );
+        for ( Octree::NodeList::iterator it = octant -> mNodes.begin(); it != octant -> mNodes.end(); ++it )
+        {
+            mCullCandidates.push_back( *it );
+            mCullVisibility.push_back( visible );
+        }
+
+        bool childfoundvisible = (v == OctreeCamera::FULL);
+        for ( int z = 0; z < 2; ++z )
+        {
+            for ( int y = 0; y < 2; ++y )
+            {
+                for ( int x = 0; x < 2; ++x )
+                {
+                    Octree* child = octant -> mChildren[ x ][ y ][ z ];
+                    if ( child != 0 )
+                        gatherOctreeNodes( camera, child, childfoundvisible );
+                }
+            }
+        }
+    }
+}
+
+void OctreeSceneManager::findVisibleObjectsThread( size_t threadIdx )
+{
+    const size_t numThreads = mNumWorkerThreads + 1;
+    const size_t numCandidates = mCullCandidates.size();
+    const size_t begin = (numCandidates * threadIdx) / numThreads;
+    const size_t end = (numCandidates * (threadIdx + 1)) / numThreads;
+
+    OctreeNode * batch[ CULL_BATCH_SIZE ];
+    size_t indices[ CULL_BATCH_SIZE ];
+    char vis[ CULL_BATCH_SIZE ];
+
+    size_t i = begin;
+    while ( i < end )
+    {
+        // Nodes of fully visible octants have been marked visible already
+        size_t numNodes = 0;
+        for ( ; i < end && numNodes < CULL_BATCH_SIZE; ++i )
+        {
+            if ( !mCullVisibility[ i ] )
+            {
+                batch[ numNodes ] = mCullCandidates[ i ];
+                indices[ numNodes++ ] = i;
+            }
+        }
+
+        cullNodeBatch( mCullCamera, batch, numNodes, vis );
+        for ( size_t j = 0; j < numNodes; ++j )
+            mCullVisibility[ indices[ j ] ] = vis[ j ];
+    }
+}
+
 // --- non template versions
 void _findNodes( const AxisAlignedBox &t, list< SceneNode * >::type &list, SceneNode *exclude, bool full, Octree *octant )
 {
@@ -39,6 +39,7 @@ public:
     virtual bool isVisible(const AxisAlignedBox& bound, FrustumPlane* culledBy = 0) const {return true;};
     virtual bool isVisible(const Sphere& bound, FrustumPlane* culledBy = 0) const {return true;};
     virtual bool isVisible(const Vector3& vert, FrustumPlane* culledBy = 0) const {return true;};
+    virtual bool isVisible(const float* centres, const float* halfSizes, size_t numBoxes, uint32* visibility) const {std::fill(visibility, visibility + (numBoxes + 31) / 32, 0xFFFFFFFF); return numBoxes > 0;};
     bool projectSphere(const Sphere& sphere, 
         Real* left, Real* top, Real* right, Real* bottom) const {*left = *bottom = -1.0f; *right = *top = 1.0f; return true;};
     Real getNearClipDistance(void) const {return 1.0;};
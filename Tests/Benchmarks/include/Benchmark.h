@@ -0,0 +1,247 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef TESTS_BENCHMARKS_INCLUDE_BENCHMARK_H_
+#define TESTS_BENCHMARKS_INCLUDE_BENCHMARK_H_
+
+#include <OgrePrerequisites.h>
+#include <OgreTimer.h>
+
+/** A minimal benchmark harness in the spirit of Google Benchmark.
+
+    Benchmarks register themselves during static initialisation, either as
+    plain functions through OGRE_BENCHMARK or as Benchmark subclasses through
+    registerBenchmark. Each one is run once per argument set it was given:
+    @code
+    void BM_Something(Benchmark::State& state)
+    {
+        Data data(state.range(0));
+        while (state.keepRunning())
+            doSomething(data);
+        state.setItemsProcessed(state.iterations() * state.range(0));
+    }
+    OGRE_BENCHMARK(BM_Something)->arg(1000)->arg(100000);
+    @endcode
+*/
+namespace Benchmark
+{
+    typedef std::vector<Ogre::int64> Arguments;
+
+    /// Passed to a benchmark run, controls the timed loop and collects results
+    class State
+    {
+    public:
+        State(const Arguments& args, double minTime)
+            : mArgs(args)
+            , mMinTime(minTime)
+            , mIterations(0)
+            , mElapsed(0)
+            , mStarted(false)
+            , mPaused(false)
+            , mItemsProcessed(0)
+            , mBytesProcessed(0)
+            , mFailed(false)
+        {
+        }
+
+        /** Returns true as long as another iteration should be run.
+        @remarks
+            Runs at least one iteration, then continues until the minimum
+            time has been spent inside the loop.
+        */
+        bool keepRunning()
+        {
+            if (mFailed)
+                return false;
+
+            if (!mStarted)
+            {
+                mStarted = true;
+                mTimer.reset();
+                return true;
+            }
+
+            ++mIterations;
+            if (elapsedSeconds() < mMinTime)
+                return true;
+
+            if (!mPaused)
+                mElapsed += mTimer.getMicroseconds();
+            mPaused = true;
+            return false;
+        }
+
+        /// Stops the clock, for per iteration setup which shouldn't be measured
+        void pauseTiming()
+        {
+            assert(!mPaused);
+            mElapsed += mTimer.getMicroseconds();
+            mPaused = true;
+        }
+
+        void resumeTiming()
+        {
+            assert(mPaused);
+            mTimer.reset();
+            mPaused = false;
+        }
+
+        /// The argument at the given position
+        Ogre::int64 range(size_t i) const { return mArgs.at(i); }
+
+        size_t iterations() const { return mIterations; }
+        /// The time spent inside the loop, excluding paused time
+        double elapsedSeconds() const
+        {
+            return (mElapsed + (mPaused ? 0 : mTimer.getMicroseconds())) * 1e-6;
+        }
+
+        /// Reported as items per second, named after the given unit
+        void setItemsProcessed(Ogre::uint64 items, const Ogre::String& unit = "items")
+        {
+            mItemsProcessed = items;
+            mItemUnit = unit;
+        }
+        Ogre::uint64 getItemsProcessed() const { return mItemsProcessed; }
+        const Ogre::String& getItemUnit() const { return mItemUnit; }
+        /// Reported as bytes per second
+        void setBytesProcessed(Ogre::uint64 bytes) { mBytesProcessed = bytes; }
+        Ogre::uint64 getBytesProcessed() const { return mBytesProcessed; }
+
+        /// Appended to the results line
+        void setLabel(const Ogre::String& label) { mLabel = label; }
+        const Ogre::String& getLabel() const { return mLabel; }
+
+        /** Marks the run as failed, e.g. when the results don't verify.
+        @remarks
+            keepRunning returns false from then on and the harness exits with
+            an error once all benchmarks have run.
+        */
+        void skipWithError(const Ogre::String& error)
+        {
+            mFailed = true;
+            mError = error;
+        }
+        bool hasFailed() const { return mFailed; }
+        const Ogre::String& getError() const { return mError; }
+
+    private:
+        Arguments mArgs;
+        double mMinTime;
+        size_t mIterations;
+        unsigned long mElapsed;
+        mutable Ogre::Timer mTimer;
+        bool mStarted;
+        bool mPaused;
+        Ogre::uint64 mItemsProcessed;
+        Ogre::String mItemUnit;
+        Ogre::uint64 mBytesProcessed;
+        bool mFailed;
+        Ogre::String mError;
+        Ogre::String mLabel;
+    };
+
+    /// A registered benchmark along with the arguments to run it with
+    class Benchmark
+    {
+    public:
+        Benchmark(const Ogre::String& name) : mName(name) {}
+        virtual ~Benchmark() {}
+
+        virtual void run(State& state) = 0;
+
+        const Ogre::String& getName() const { return mName; }
+
+        /// Adds a run with a single argument
+        Benchmark* arg(Ogre::int64 a)
+        {
+            mArgs.push_back(Arguments(1, a));
+            return this;
+        }
+
+        /// Adds a run with two arguments
+        Benchmark* args(Ogre::int64 a, Ogre::int64 b)
+        {
+            Arguments values;
+            values.push_back(a);
+            values.push_back(b);
+            mArgs.push_back(values);
+            return this;
+        }
+
+        /// Adds a run for every combination of the values in both lists
+        Benchmark* argPairs(const Arguments& a, const Arguments& b)
+        {
+            for (size_t i = 0; i < a.size(); ++i)
+                for (size_t j = 0; j < b.size(); ++j)
+                    args(a[i], b[j]);
+            return this;
+        }
+
+        /// The argument sets, a single empty one if none were added
+        std::vector<Arguments> getArguments() const
+        {
+            return mArgs.empty() ? std::vector<Arguments>(1) : mArgs;
+        }
+
+    private:
+        Ogre::String mName;
+        std::vector<Arguments> mArgs;
+    };
+
+    typedef void (*Function)(State&);
+
+    /// Adapts a plain function
+    class FunctionBenchmark : public Benchmark
+    {
+    public:
+        FunctionBenchmark(const Ogre::String& name, Function function)
+            : Benchmark(name), mFunction(function) {}
+
+        void run(State& state) { mFunction(state); }
+
+    private:
+        Function mFunction;
+    };
+
+    /// Registers a benchmark, the harness takes ownership
+    Benchmark* registerBenchmark(Benchmark* benchmark);
+
+    /// Runs the registered benchmarks, returns the process exit code
+    int runBenchmarks(int argc, char** argv);
+}
+
+#define OGRE_BENCHMARK_CONCAT2(a, b) a##b
+#define OGRE_BENCHMARK_CONCAT(a, b) OGRE_BENCHMARK_CONCAT2(a, b)
+
+/// Registers a void(Benchmark::State&) function, arguments may be chained on
+#define OGRE_BENCHMARK(function) \
+    static ::Benchmark::Benchmark* OGRE_BENCHMARK_CONCAT(_benchmark_, __LINE__) = \
+        ::Benchmark::registerBenchmark(new ::Benchmark::FunctionBenchmark(#function, function))
+
+#endif /* TESTS_BENCHMARKS_INCLUDE_BENCHMARK_H_ */
@@ -0,0 +1,182 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreLogManager.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+namespace Benchmark
+{
+    namespace
+    {
+        typedef std::vector<Benchmark*> BenchmarkList;
+
+        /// Function local, so registration works from any static initialiser
+        BenchmarkList& getBenchmarks()
+        {
+            static BenchmarkList benchmarks;
+            return benchmarks;
+        }
+
+        Ogre::String getRunName(const Benchmark* benchmark, const Arguments& args)
+        {
+            Ogre::StringStream name;
+            name << benchmark->getName();
+            for (size_t i = 0; i < args.size(); ++i)
+                name << "/" << args[i];
+            return name.str();
+        }
+
+        /// Formats a rate with a k/M/G suffix
+        Ogre::String formatRate(double perSecond, const Ogre::String& unit)
+        {
+            const char* prefixes[] = { "", "k", "M", "G" };
+            size_t prefix = 0;
+            while (perSecond >= 1000 && prefix < 3)
+            {
+                perSecond /= 1000;
+                ++prefix;
+            }
+            char buffer[64];
+            sprintf(buffer, "%.3g %s", perSecond, prefixes[prefix]);
+            return buffer + unit + "/s";
+        }
+
+        void printUsage(const char* exe)
+        {
+            printf("Usage: %s [options]\n"
+                   "  --benchmark_filter=<text>    only run benchmarks whose name contains text\n"
+                   "  --benchmark_min_time=<secs>  minimum time to run each benchmark for (0.5)\n"
+                   "  --benchmark_list_tests       list the benchmarks without running them\n",
+                   exe);
+        }
+    }
+    //---------------------------------------------------------------------
+    Benchmark* registerBenchmark(Benchmark* benchmark)
+    {
+        getBenchmarks().push_back(benchmark);
+        return benchmark;
+    }
+    //---------------------------------------------------------------------
+    int runBenchmarks(int argc, char** argv)
+    {
+        Ogre::String filter;
+        double minTime = 0.5;
+        bool listOnly = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* filterArg = "--benchmark_filter=";
+            const char* minTimeArg = "--benchmark_min_time=";
+            if (strncmp(argv[i], filterArg, strlen(filterArg)) == 0)
+                filter = argv[i] + strlen(filterArg);
+            else if (strncmp(argv[i], minTimeArg, strlen(minTimeArg)) == 0)
+                minTime = atof(argv[i] + strlen(minTimeArg));
+            else if (strcmp(argv[i], "--benchmark_list_tests") == 0)
+                listOnly = true;
+            else
+            {
+                printUsage(argv[0]);
+                return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+            }
+        }
+
+        BenchmarkList& benchmarks = getBenchmarks();
+        size_t numFailed = 0;
+
+        if (!listOnly)
+        {
+            printf("%-50s %14s %12s %20s\n", "Benchmark", "Time", "Iterations", "Rate");
+            printf("%s\n", Ogre::String(99, '-').c_str());
+        }
+
+        for (BenchmarkList::iterator b = benchmarks.begin(); b != benchmarks.end(); ++b)
+        {
+            std::vector<Arguments> argSets = (*b)->getArguments();
+            for (size_t a = 0; a < argSets.size(); ++a)
+            {
+                Ogre::String name = getRunName(*b, argSets[a]);
+                if (!filter.empty() && name.find(filter) == Ogre::String::npos)
+                    continue;
+
+                if (listOnly)
+                {
+                    printf("%s\n", name.c_str());
+                    continue;
+                }
+
+                State state(argSets[a], minTime);
+                (*b)->run(state);
+
+                if (state.hasFailed())
+                {
+                    printf("%-50s ERROR: %s\n", name.c_str(), state.getError().c_str());
+                    ++numFailed;
+                    continue;
+                }
+
+                double seconds = state.elapsedSeconds();
+                size_t iterations = std::max<size_t>(state.iterations(), 1);
+                double nsPerIteration = seconds * 1e9 / iterations;
+
+                Ogre::String rate;
+                if (state.getItemsProcessed() && seconds > 0)
+                    rate = formatRate(state.getItemsProcessed() / seconds, state.getItemUnit());
+                else if (state.getBytesProcessed() && seconds > 0)
+                    rate = formatRate(state.getBytesProcessed() / seconds, "B");
+
+                printf("%-50s %11.0f ns %12lu %20s %s\n", name.c_str(), nsPerIteration,
+                       (unsigned long)iterations, rate.c_str(), state.getLabel().c_str());
+                fflush(stdout);
+            }
+        }
+
+        for (BenchmarkList::iterator b = benchmarks.begin(); b != benchmarks.end(); ++b)
+            delete *b;
+        benchmarks.clear();
+
+        if (numFailed)
+        {
+            printf("%lu benchmark(s) failed\n", (unsigned long)numFailed);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Some of the code under test logs, keep it off the console
+    Ogre::LogManager logManager;
+    logManager.createLog("Benchmark_Ogre.log", true, false, false);
+
+    return Benchmark::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,134 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreCodec.h>
+#include <OgreConfigFile.h>
+#include <OgreDDSCodec.h>
+#include <OgreFileSystem.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreImage.h>
+#include <OgreImageCodec.h>
+#include <OgreRoot.h>
+#include <OgreStringConverter.h>
+#include <Threading/OgreTaskScheduler.h>
+
+using namespace Ogre;
+
+namespace {
+    /// Reads a file of Tests/Media into memory
+    MemoryDataStreamPtr readTestMedia(const String& name)
+    {
+        ConfigFile cf;
+        cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+        FileSystemArchive media(cf.getSettings("Tests").begin()->second, "FileSystem", true);
+        media.load();
+        DataStreamPtr file = media.open(name);
+        return MemoryDataStreamPtr(OGRE_NEW MemoryDataStream(file));
+    }
+
+    /// Spreads the Root's task scheduler over the given number of threads
+    void setThreadCount(Root& root, size_t numThreads)
+    {
+        root.getTaskScheduler()->setWorkerThreadCount(numThreads - 1);
+        root.getTaskScheduler()->startup(true);
+    }
+
+    /** Decodes a DDS file from memory without a render system, which
+        decompresses it in software.
+    */
+    void decodeDDS(Benchmark::State& state, const String& fileName)
+    {
+        Root root("", "", "");
+        setThreadCount(root, (size_t)state.range(0));
+
+        MemoryDataStreamPtr file = readTestMedia(fileName);
+        Codec* codec = Codec::getCodec("dds");
+        size_t numPixels = 0;
+        while (state.keepRunning())
+        {
+            DataStreamPtr stream = file;
+            stream->seek(0);
+            Codec::DecodeResult result = codec->decode(stream);
+            ImageCodec::ImageData* data = static_cast<ImageCodec::ImageData*>(result.second.get());
+            numPixels = data->width * data->height * data->depth;
+        }
+
+        state.setItemsProcessed((uint64)state.iterations() * numPixels, "pixels");
+        state.setLabel(StringConverter::toString(numPixels) + " pixels");
+    }
+
+    void BM_DDSDecodeDXT1(Benchmark::State& state)
+    {
+        decodeDDS(state, "BumpyMetal_dxt1.dds");
+    }
+    OGRE_BENCHMARK(BM_DDSDecodeDXT1)->arg(1)->arg(2)->arg(4);
+
+    void BM_DDSDecodeDXT5(Benchmark::State& state)
+    {
+        decodeDDS(state, "ogreborderUp_dxt5.dds");
+    }
+    OGRE_BENCHMARK(BM_DDSDecodeDXT5)->arg(1)->arg(2)->arg(4);
+
+    /** Compresses the decoded pixels of a DDS file, as when baking textures.
+    */
+    void compressDDS(Benchmark::State& state, const String& fileName, PixelFormat format)
+    {
+        Root root("", "", "");
+        setThreadCount(root, (size_t)state.range(0));
+
+        DataStreamPtr file = readTestMedia(fileName);
+        Image image;
+        image.load(file, "dds");
+        PixelBox src = image.getPixelBox();
+        std::vector<uchar> blocks(PixelUtil::getMemorySize(src.getWidth(), src.getHeight(), 1, format));
+        PixelBox dst(src.getWidth(), src.getHeight(), 1, format, &blocks[0]);
+        while (state.keepRunning())
+            DDSCodec::compress(src, dst);
+
+        state.setItemsProcessed((uint64)state.iterations() * src.getWidth() * src.getHeight(), "pixels");
+    }
+
+    void BM_DDSCompressDXT1(Benchmark::State& state)
+    {
+        compressDDS(state, "BumpyMetal_dxt1.dds", PF_DXT1);
+    }
+    OGRE_BENCHMARK(BM_DDSCompressDXT1)->arg(1)->arg(2)->arg(4);
+
+    void BM_DDSCompressDXT5(Benchmark::State& state)
+    {
+        compressDDS(state, "ogreborderUp_dxt5.dds", PF_DXT5);
+    }
+    OGRE_BENCHMARK(BM_DDSCompressDXT5)->arg(1)->arg(2)->arg(4);
+
+    void BM_DDSCompressBC5(Benchmark::State& state)
+    {
+        compressDDS(state, "BumpyMetal_dxt1.dds", PF_BC5_UNORM);
+    }
+    OGRE_BENCHMARK(BM_DDSCompressBC5)->arg(1)->arg(2)->arg(4);
+}
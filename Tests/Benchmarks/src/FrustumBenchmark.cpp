@@ -0,0 +1,88 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include "TestData.h"
+#include <OgreCamera.h>
+#include <OgreDefaultHardwareBufferManager.h>
+#include <OgreMaterialManager.h>
+#include <OgreRoot.h>
+
+using namespace Ogre;
+
+namespace {
+    /** Culls boxes against a camera one AxisAlignedBox at a time (0) or
+        all of them with the batched Camera::isVisible (1).
+    */
+    void BM_CameraBoxVisibility(Benchmark::State& state)
+    {
+        size_t numBoxes = (size_t)state.range(0);
+        bool batched = state.range(1) != 0;
+
+        // Cameras need the default material
+        Root root("", "", "");
+        DefaultHardwareBufferManager hardwareBufferManager;
+        MaterialManager::getSingleton().initialise();
+        Camera camera("Camera", 0);
+        camera.setPosition(10, 20, 30);
+        camera.lookAt(50, 0, -100);
+        camera.setNearClipDistance(1);
+        camera.setFarClipDistance(150);
+
+        std::vector<float> centres, halfSizes;
+        createBoxes(centres, halfSizes, numBoxes);
+        std::vector<AxisAlignedBox> boxes;
+        for (size_t i = 0; i < numBoxes; ++i)
+        {
+            Vector3 centre(centres[i * 3], centres[i * 3 + 1], centres[i * 3 + 2]);
+            Vector3 halfSize(halfSizes[i * 3], halfSizes[i * 3 + 1], halfSizes[i * 3 + 2]);
+            boxes.push_back(AxisAlignedBox(centre - halfSize, centre + halfSize));
+        }
+        std::vector<uint32> visibility((numBoxes + 31) / 32);
+
+        size_t numVisible = 0;
+        while (state.keepRunning())
+        {
+            if (batched)
+            {
+                camera.isVisible(&centres[0], &halfSizes[0], numBoxes, &visibility[0]);
+            }
+            else
+            {
+                numVisible = 0;
+                for (size_t i = 0; i < numBoxes; ++i)
+                    numVisible += camera.isVisible(boxes[i]);
+            }
+        }
+
+        state.setItemsProcessed((uint64)state.iterations() * numBoxes, "boxes");
+        state.setLabel(batched ? "batched" : StringConverter::toString(numVisible) + " visible, one at a time");
+    }
+    OGRE_BENCHMARK(BM_CameraBoxVisibility)
+        ->args(1000, 0)->args(1000, 1)
+        ->args(100000, 0)->args(100000, 1);
+}
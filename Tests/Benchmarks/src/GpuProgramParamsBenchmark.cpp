@@ -0,0 +1,212 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreAutoParamDataSource.h>
+#include <OgreCamera.h>
+#include <OgreDefaultHardwareBufferManager.h>
+#include <OgreGpuProgramParams.h>
+#include <OgreLight.h>
+#include <OgreMaterialManager.h>
+#include <OgreRoot.h>
+#include <OgreStringConverter.h>
+#include <OgreVector4.h>
+
+using namespace Ogre;
+
+namespace {
+    const char* BASE_NAMES[] = {
+        "worldViewProj", "worldMatrix", "viewMatrix", "lightPosition", "lightDiffuse",
+        "lightSpecular", "lightAttenuation", "cameraPosition", "ambientColour", "diffuseColour",
+        "specularColour", "emissiveColour", "shininess", "fogColour", "fogParams",
+        "time", "windDirection", "windStrength", "uvScroll", "uvScale"
+    };
+    const size_t NUM_BASE_NAMES = sizeof(BASE_NAMES) / sizeof(BASE_NAMES[0]);
+
+    /** Parameters with the given number of float4 constants, named like a
+        material would name them: a handful of base names, with numbered
+        variants sharing their prefixes.
+    */
+    GpuProgramParametersSharedPtr createParameters(size_t numConstants, StringVector& names)
+    {
+        GpuNamedConstantsPtr constants(OGRE_NEW GpuNamedConstants());
+        for (size_t i = 0; i < numConstants; ++i)
+        {
+            String name = BASE_NAMES[i % NUM_BASE_NAMES];
+            if (i >= NUM_BASE_NAMES)
+                name += StringConverter::toString(i / NUM_BASE_NAMES);
+
+            GpuConstantDefinition def;
+            def.constType = GCT_FLOAT4;
+            def.elementSize = 4;
+            def.physicalIndex = constants->floatBufferSize;
+            constants->floatBufferSize += def.elementSize;
+            constants->map[name] = def;
+            names.push_back(name);
+        }
+
+        GpuProgramParametersSharedPtr params(OGRE_NEW GpuProgramParameters());
+        params->_setNamedConstants(constants);
+        return params;
+    }
+
+    /** Sets every constant of the parameters once per iteration, by name (0)
+        or by handle resolved up front (1).
+    */
+    void BM_SetNamedConstant(Benchmark::State& state)
+    {
+        size_t numConstants = (size_t)state.range(0);
+        bool byHandle = state.range(1) != 0;
+
+        StringVector names;
+        GpuProgramParametersSharedPtr params = createParameters(numConstants, names);
+        std::vector<GpuConstantHandle> handles;
+        for (size_t i = 0; i < names.size(); ++i)
+            handles.push_back(GpuNamedConstants::getConstantHandle(names[i]));
+
+        Vector4 value(1, 2, 3, 4);
+        while (state.keepRunning())
+        {
+            if (byHandle)
+            {
+                for (size_t i = 0; i < handles.size(); ++i)
+                    params->setNamedConstant(handles[i], value);
+            }
+            else
+            {
+                for (size_t i = 0; i < names.size(); ++i)
+                    params->setNamedConstant(names[i], value);
+            }
+            value.x += 1;
+        }
+
+        state.setItemsProcessed((uint64)state.iterations() * numConstants, "constants");
+        state.setLabel(StringConverter::toString(numConstants) + " constants, by " +
+                       (byHandle ? "handle" : "name"));
+    }
+    OGRE_BENCHMARK(BM_SetNamedConstant)
+        ->args(8, 0)->args(8, 1)
+        ->args(32, 0)->args(32, 1)
+        ->args(200, 0)->args(200, 1);
+
+    const size_t NUM_DRAWS = 100;
+    const size_t NUM_LIGHTS = 8;
+
+    /// Adds an auto constant taking the given number of float4 registers
+    void addAutoConstant(GpuProgramParameters& params, size_t& index,
+                         GpuProgramParameters::AutoConstantType type, size_t registers, size_t data = 0)
+    {
+        std::vector<float> zero(registers * 4, 0.0f);
+        params.setConstant(index, &zero[0], registers);
+        params.setAutoConstant(index, type, data);
+        index += registers;
+    }
+
+    /** Updates the autos of a forward lit vertex program for a frame of small
+        batches, the way the scene manager does. The light list changes every
+        given number of draws, and the pass every draw (1) or never (0).
+    */
+    void BM_UpdateAutoParams(Benchmark::State& state)
+    {
+        size_t drawsPerLightList = (size_t)state.range(0);
+        bool passPerDraw = state.range(1) != 0;
+
+        Root root("", "", "");
+        DefaultHardwareBufferManager hardwareBufferManager;
+        MaterialManager::getSingleton().initialise();
+        Camera camera("Camera", 0);
+        camera.setPosition(0, 100, 500);
+        camera.lookAt(Vector3::ZERO);
+
+        std::vector<Light*> lights;
+        LightList lightLists[2];
+        for (size_t i = 0; i < NUM_LIGHTS * 2; ++i)
+        {
+            lights.push_back(OGRE_NEW Light("Light" + StringConverter::toString(i)));
+            lights.back()->setType(i % 3 ? Light::LT_POINT : Light::LT_SPOTLIGHT);
+            lights.back()->setPosition(Real(i) * 10, 50, Real(i) * -10);
+            lights.back()->setDirection(0, -1, 0);
+            lightLists[i / NUM_LIGHTS].push_back(lights.back());
+        }
+
+        Matrix4 worlds[NUM_DRAWS];
+        for (size_t i = 0; i < NUM_DRAWS; ++i)
+            worlds[i].makeTransform(Vector3(Real(i), 0, Real(i) * 2), Vector3::UNIT_SCALE, Quaternion::IDENTITY);
+
+        GpuProgramParameters params;
+        params._setLogicalIndexes(GpuLogicalBufferStructPtr(OGRE_NEW GpuLogicalBufferStruct()),
+                                  GpuLogicalBufferStructPtr(), GpuLogicalBufferStructPtr(),
+                                  GpuLogicalBufferStructPtr(), GpuLogicalBufferStructPtr());
+        size_t index = 0;
+        addAutoConstant(params, index, GpuProgramParameters::ACT_WORLDVIEWPROJ_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_WORLD_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_INVERSE_TRANSPOSE_WORLD_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_VIEWPROJ_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_VIEW_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_INVERSE_VIEW_MATRIX, 4);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_CAMERA_POSITION, 1);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_AMBIENT_LIGHT_COLOUR, 1);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_FOG_COLOUR, 1);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_FOG_PARAMS, 1);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_LIGHT_POSITION_ARRAY, NUM_LIGHTS, NUM_LIGHTS);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_LIGHT_DIRECTION_VIEW_SPACE_ARRAY, NUM_LIGHTS, NUM_LIGHTS);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR_ARRAY, NUM_LIGHTS, NUM_LIGHTS);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_LIGHT_ATTENUATION_ARRAY, NUM_LIGHTS, NUM_LIGHTS);
+        addAutoConstant(params, index, GpuProgramParameters::ACT_SPOTLIGHT_PARAMS_ARRAY, NUM_LIGHTS, NUM_LIGHTS);
+
+        AutoParamDataSource source;
+        source.setAmbientLightColour(ColourValue(0.2f, 0.2f, 0.2f));
+        source.setFog(FOG_LINEAR, ColourValue::White, 0, 100, 1000);
+        while (state.keepRunning())
+        {
+            source.setCurrentCamera(&camera, false);
+            for (size_t d = 0; d < NUM_DRAWS; ++d)
+            {
+                uint16 mask = GPV_PER_OBJECT;
+                if (passPerDraw || d == 0)
+                    mask |= GPV_GLOBAL;
+                if (d % drawsPerLightList == 0)
+                {
+                    source.setCurrentLightList(&lightLists[d / drawsPerLightList % 2]);
+                    mask |= GPV_LIGHTS;
+                }
+                source.setCurrentRenderable(0);
+                source.setWorldMatrices(&worlds[d], 1);
+                params._updateAutoParams(&source, mask);
+            }
+        }
+
+        for (size_t i = 0; i < lights.size(); ++i)
+            OGRE_DELETE lights[i];
+
+        state.setItemsProcessed((uint64)state.iterations() * NUM_DRAWS, "draws");
+        state.setLabel("light list every " + StringConverter::toString(drawsPerLightList) +
+                       (passPerDraw ? " draws, pass every draw" : " draws, one pass"));
+    }
+    OGRE_BENCHMARK(BM_UpdateAutoParams)->args(1, 1)->args(8, 1)->args(8, 0);
+}
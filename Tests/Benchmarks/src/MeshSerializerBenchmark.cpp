@@ -0,0 +1,167 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include "TestData.h"
+#include <OgreDefaultHardwareBufferManager.h>
+#include <OgreFileSystem.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreMesh.h>
+#include <OgreMeshManager.h>
+#include <OgreMeshSerializer.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreStringConverter.h>
+
+using namespace Ogre;
+
+namespace {
+    struct MeshFile
+    {
+        String name;
+        String group;
+        MemoryDataStreamPtr data;
+    };
+
+    /// Reads every mesh of the media into memory
+    std::vector<MeshFile> readMeshFiles(size_t& totalSize)
+    {
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        std::vector<MeshFile> files;
+        totalSize = 0;
+        StringVector groups = rgm.getResourceGroups();
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            StringVectorPtr names = rgm.findResourceNames(groups[g], "*.mesh");
+            for (size_t i = 0; i < names->size(); ++i)
+            {
+                DataStreamPtr stream = rgm.openResource(names->at(i), groups[g]);
+                MeshFile file = { names->at(i), groups[g], MemoryDataStreamPtr(OGRE_NEW MemoryDataStream(stream)) };
+                files.push_back(file);
+                totalSize += file.data->size();
+            }
+        }
+        return files;
+    }
+
+    /** Imports every mesh of the configured media from memory, so only the
+        serializer is measured and not the disk.
+    @remarks
+        The skeletons are loaded once, during the first import.
+    */
+    void BM_MeshImport(Benchmark::State& state)
+    {
+        Root root("", "", "");
+        DefaultHardwareBufferManager hardwareBufferManager;
+        addMediaLocations();
+
+        size_t totalSize;
+        std::vector<MeshFile> files = readMeshFiles(totalSize);
+        if (files.empty())
+        {
+            state.skipWithError("no meshes found");
+            return;
+        }
+
+        MeshSerializer serializer;
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                MeshPtr mesh = MeshManager::getSingleton().createManual(files[i].name, files[i].group);
+                DataStreamPtr stream = files[i].data;
+                stream->seek(0);
+                serializer.importMesh(stream, mesh.get());
+                MeshManager::getSingleton().remove(mesh);
+            }
+        }
+
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setLabel(StringConverter::toString(files.size()) + " meshes, " +
+                       StringConverter::toString(totalSize / 1024) + " KiB");
+    }
+    OGRE_BENCHMARK(BM_MeshImport);
+
+    /** Loads every mesh of the configured media through the MeshManager,
+        prepared for shadow volumes, with the mesh cache off (0) or on (1).
+    @remarks
+        The cache is filled before timing starts. Files come from the OS
+        cache either way, so this measures parsing and post processing.
+    */
+    void BM_MeshLoad(Benchmark::State& state)
+    {
+        const String cacheDir = "MeshLoadBenchmarkCache";
+        bool useCache = state.range(0) != 0;
+
+        Root root("", "", "");
+        DefaultHardwareBufferManager hardwareBufferManager;
+        addMediaLocations();
+        MeshManager& meshManager = MeshManager::getSingleton();
+        meshManager.setPrepareAllMeshesForShadowVolumes(true);
+        if (useCache)
+            meshManager.setMeshCacheDirectory(cacheDir);
+
+        size_t totalSize;
+        std::vector<MeshFile> files = readMeshFiles(totalSize);
+        if (files.empty())
+        {
+            state.skipWithError("no meshes found");
+            return;
+        }
+
+        // Writes the cache entries
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            MeshPtr mesh = meshManager.load(files[i].name, files[i].group);
+            meshManager.remove(mesh);
+        }
+
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                MeshPtr mesh = meshManager.load(files[i].name, files[i].group);
+                meshManager.remove(mesh);
+            }
+        }
+
+        if (useCache)
+        {
+            FileSystemArchive cache(cacheDir, "FileSystem", false);
+            cache.load();
+            StringVectorPtr entries = cache.list(false);
+            for (size_t i = 0; i < entries->size(); ++i)
+                cache.remove(entries->at(i));
+            FileSystemLayer::removeDirectory(cacheDir);
+        }
+
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setLabel(StringConverter::toString(files.size()) + " meshes");
+    }
+    OGRE_BENCHMARK(BM_MeshLoad)->arg(0)->arg(1);
+}
@@ -0,0 +1,246 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include "TestData.h"
+#include <OgrePlatformInformation.h>
+
+namespace Ogre {
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+#if __OGRE_HAVE_SSE
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+#endif
+#if __OGRE_HAVE_AVX2
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void);
+#endif
+}
+
+using namespace Ogre;
+
+namespace {
+    /// softwareVertexSkinning with positions and normals, for one implementation
+    class SkinningBenchmark : public ::Benchmark::Benchmark
+    {
+    public:
+        SkinningBenchmark(const String& name, OptimisedUtil* impl, bool mixed)
+            : ::Benchmark::Benchmark(name), mImpl(impl), mMixed(mixed) {}
+
+        void run(::Benchmark::State& state)
+        {
+            size_t numVertices = (size_t)state.range(0);
+            size_t numWeights = mMixed ? 4 : (size_t)state.range(1);
+            SkinnedMesh mesh(numVertices, numWeights, mMixed);
+
+            std::vector<float> result(mesh.vertices.size());
+            mesh.skin(mImpl, result);
+            String error = mesh.verify(result);
+            if (!error.empty())
+            {
+                state.skipWithError(error);
+                return;
+            }
+
+            while (state.keepRunning())
+                mesh.skin(mImpl, result);
+
+            state.setItemsProcessed((uint64)state.iterations() * numVertices, "vertices");
+        }
+
+    private:
+        OptimisedUtil* mImpl;
+        bool mMixed;
+    };
+
+    /// The remaining OptimisedUtil operations, over range(0) vertices or triangles
+    class OperationBenchmark : public ::Benchmark::Benchmark
+    {
+    public:
+        enum Operation
+        {
+            OP_MORPH,
+            OP_CONCATENATE,
+            OP_FACE_NORMALS,
+            OP_LIGHT_FACING,
+            OP_EXTRUDE,
+            OP_BOX_VISIBILITY
+        };
+
+        OperationBenchmark(const String& name, OptimisedUtil* impl, Operation op)
+            : ::Benchmark::Benchmark(name), mImpl(impl), mOperation(op) {}
+
+        void run(::Benchmark::State& state)
+        {
+            size_t count = (size_t)state.range(0);
+            const Vector4 lightPos(30, -20, 10, 1);
+            const char* unit = "vertices";
+
+            switch (mOperation)
+            {
+            case OP_MORPH:
+            {
+                SkinnedMesh mesh(count, 1);
+                std::vector<float> target(mesh.vertices.rbegin(), mesh.vertices.rend());
+                std::vector<float> result(mesh.vertices.size());
+                const size_t vsize = 6 * sizeof(float);
+                while (state.keepRunning())
+                {
+                    mImpl->softwareVertexMorph(0.3f, &mesh.vertices[0], &target[0], &result[0],
+                        vsize, vsize, vsize, count, true);
+                }
+                break;
+            }
+            case OP_CONCATENATE:
+            {
+                // count is the number of matrices, repeating the mesh palette
+                SkinnedMesh mesh(1, 1);
+                std::vector<Matrix4> matrices, result(count);
+                while (matrices.size() < count)
+                    matrices.push_back(mesh.matrices[matrices.size() % mesh.matrices.size()]);
+                while (state.keepRunning())
+                    mImpl->concatenateAffineMatrices(mesh.matrices[0], &matrices[0], &result[0], count);
+                unit = "matrices";
+                break;
+            }
+            case OP_FACE_NORMALS:
+            case OP_LIGHT_FACING:
+            {
+                // Roughly a triangle and a half per vertex, as in a closed mesh
+                std::vector<float> positions;
+                createPositions(positions, count * 2 / 3 + 3);
+                std::vector<EdgeData::Triangle> triangles;
+                createTriangles(triangles, count, positions.size() / 3);
+                std::vector<Vector4> faceNormals(count);
+                std::vector<char> lightFacings(count);
+                mImpl->calculateFaceNormals(&positions[0], &triangles[0], &faceNormals[0], count);
+                while (state.keepRunning())
+                {
+                    if (mOperation == OP_FACE_NORMALS)
+                        mImpl->calculateFaceNormals(&positions[0], &triangles[0], &faceNormals[0], count);
+                    else
+                        mImpl->calculateLightFacing(lightPos, &faceNormals[0], &lightFacings[0], count);
+                }
+                unit = "triangles";
+                break;
+            }
+            case OP_EXTRUDE:
+            {
+                std::vector<float> positions;
+                createPositions(positions, count);
+                std::vector<float> result(positions.size());
+                while (state.keepRunning())
+                    mImpl->extrudeVertices(lightPos, 1000, &positions[0], &result[0], count);
+                break;
+            }
+            case OP_BOX_VISIBILITY:
+            {
+                // Six planes like a frustum's, axis aligned and oblique, many boxes crossing them
+                const float planes[] = {
+                    1, 0, 0, 50,
+                    -1, 0, 0, 50,
+                    0, 1, 0, 80,
+                    0, -1, 0, 80,
+                    0.6f, 0, 0.8f, 20,
+                    -0.48f, 0.6f, -0.64f, 100,
+                };
+                std::vector<float> centres, halfSizes;
+                createBoxes(centres, halfSizes, count);
+                std::vector<uint32> visibility((count + 31) / 32);
+                while (state.keepRunning())
+                    mImpl->calculateBoxVisibility(planes, 6, &centres[0], &halfSizes[0], &visibility[0], count);
+                unit = "boxes";
+                break;
+            }
+            }
+
+            state.setItemsProcessed((uint64)state.iterations() * count, unit);
+        }
+
+    private:
+        OptimisedUtil* mImpl;
+        Operation mOperation;
+    };
+
+    void registerOperation(const String& name, OptimisedUtil* impl, OperationBenchmark::Operation op,
+                           const ::Benchmark::Arguments& sizes)
+    {
+        ::Benchmark::Benchmark* benchmark = ::Benchmark::registerBenchmark(new OperationBenchmark(name, impl, op));
+        for (size_t i = 0; i < sizes.size(); ++i)
+            benchmark->arg(sizes[i]);
+    }
+
+    void registerImplementation(const String& name, OptimisedUtil* impl)
+    {
+        ::Benchmark::Arguments sizes;
+        sizes.push_back(1000);
+        sizes.push_back(10000);
+        sizes.push_back(100000);
+        sizes.push_back(1000000);
+        ::Benchmark::Arguments weightCounts;
+        for (int i = 1; i <= 4; ++i)
+            weightCounts.push_back(i);
+
+        ::Benchmark::registerBenchmark(
+            new SkinningBenchmark("SoftwareVertexSkinning/" + name, impl, false))->argPairs(sizes, weightCounts);
+
+        ::Benchmark::Benchmark* mixed = ::Benchmark::registerBenchmark(
+            new SkinningBenchmark("SoftwareVertexSkinningMixedWeights/" + name, impl, true));
+        for (size_t i = 0; i < sizes.size(); ++i)
+            mixed->arg(sizes[i]);
+
+        registerOperation("SoftwareVertexMorph/" + name, impl, OperationBenchmark::OP_MORPH, sizes);
+        registerOperation("CalculateFaceNormals/" + name, impl, OperationBenchmark::OP_FACE_NORMALS, sizes);
+        registerOperation("CalculateLightFacing/" + name, impl, OperationBenchmark::OP_LIGHT_FACING, sizes);
+        registerOperation("ExtrudeVertices/" + name, impl, OperationBenchmark::OP_EXTRUDE, sizes);
+        registerOperation("CalculateBoxVisibility/" + name, impl, OperationBenchmark::OP_BOX_VISIBILITY, sizes);
+
+        // Bone palettes are small, a skeleton or a batch of them
+        ::Benchmark::Arguments matrixCounts;
+        matrixCounts.push_back(60);
+        matrixCounts.push_back(256);
+        matrixCounts.push_back(4096);
+        registerOperation("ConcatenateAffineMatrices/" + name, impl, OperationBenchmark::OP_CONCATENATE, matrixCounts);
+    }
+
+    /// Registers every implementation the CPU supports
+    bool registerBenchmarks()
+    {
+        registerImplementation("General", _getOptimisedUtilGeneral());
+#if __OGRE_HAVE_SSE
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+            registerImplementation("SSE", _getOptimisedUtilSSE());
+#endif
+#if __OGRE_HAVE_AVX2
+        if ((PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX2) &&
+            (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_FMA))
+            registerImplementation("AVX2", _getOptimisedUtilAVX2());
+#endif
+        return true;
+    }
+
+    bool registered = registerBenchmarks();
+}
@@ -0,0 +1,233 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreConfigFile.h>
+#include <OgreFileSystem.h>
+#include <OgreFileSystemLayer.h>
+#include <OgrePackArchive.h>
+#include <OgreStringConverter.h>
+#if OGRE_NO_ZIP_ARCHIVE == 0
+#include <OgreZip.h>
+#include <zlib.h>
+#endif
+
+using namespace Ogre;
+
+namespace {
+    const char* PACK_NAME = "BenchmarkMedia.pack";
+    const char* ZIP_NAME = "BenchmarkMedia.zip";
+
+    /// Tests/Media, the same content is read from every archive type
+    String getMediaPath()
+    {
+        ConfigFile cf;
+        cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+        return cf.getSettings("Tests").begin()->second;
+    }
+
+#if OGRE_NO_ZIP_ARCHIVE == 0
+    void appendUint16(std::vector<uchar>& buffer, uint16 v)
+    {
+        buffer.push_back(uchar(v));
+        buffer.push_back(uchar(v >> 8));
+    }
+
+    void appendUint32(std::vector<uchar>& buffer, uint32 v)
+    {
+        appendUint16(buffer, uint16(v));
+        appendUint16(buffer, uint16(v >> 16));
+    }
+
+    /** Writes the files of an archive to a zip, deflated at zlib's default level.
+    @remarks
+        Just enough of the format for the zip archives to read it back.
+    */
+    void writeZip(Archive* source, const DataStreamPtr& out)
+    {
+        std::vector<uchar> centralDir;
+        uint32 offset = 0;
+        uint16 numFiles = 0;
+
+        FileInfoListPtr files = source->listFileInfo(true, false);
+        for (FileInfoList::const_iterator i = files->begin(); i != files->end(); ++i, ++numFiles)
+        {
+            String name = i->path + i->basename;
+            String data = source->open(name)->getAsString();
+
+            std::vector<uchar> compressed(compressBound(uLong(data.size())));
+            z_stream zs;
+            memset(&zs, 0, sizeof(zs));
+            deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+            zs.next_in = (Bytef*)data.data();
+            zs.avail_in = uInt(data.size());
+            zs.next_out = &compressed[0];
+            zs.avail_out = uInt(compressed.size());
+            deflate(&zs, Z_FINISH);
+            uint32 compressedSize = uint32(zs.total_out);
+            deflateEnd(&zs);
+            uint32 crc = uint32(crc32(0, (const Bytef*)data.data(), uInt(data.size())));
+
+            // Local header, then the central directory record for it
+            std::vector<uchar> header;
+            appendUint32(header, 0x04034b50);
+            appendUint16(header, 20);
+            appendUint16(header, 0);
+            appendUint16(header, 8);
+            appendUint32(header, 0);
+            appendUint32(header, crc);
+            appendUint32(header, compressedSize);
+            appendUint32(header, uint32(data.size()));
+            appendUint16(header, uint16(name.size()));
+            appendUint16(header, 0);
+            header.insert(header.end(), name.begin(), name.end());
+            out->write(&header[0], header.size());
+            out->write(&compressed[0], compressedSize);
+
+            appendUint32(centralDir, 0x02014b50);
+            appendUint16(centralDir, 20);
+            centralDir.insert(centralDir.end(), header.begin() + 4, header.begin() + 30);
+            appendUint16(centralDir, 0);
+            appendUint16(centralDir, 0);
+            appendUint16(centralDir, 0);
+            appendUint32(centralDir, 0);
+            appendUint32(centralDir, offset);
+            centralDir.insert(centralDir.end(), name.begin(), name.end());
+
+            offset += uint32(header.size() + compressedSize);
+        }
+
+        std::vector<uchar> end;
+        appendUint32(end, 0x06054b50);
+        appendUint32(end, 0);
+        appendUint16(end, numFiles);
+        appendUint16(end, numFiles);
+        appendUint32(end, uint32(centralDir.size()));
+        appendUint32(end, offset);
+        appendUint16(end, 0);
+        out->write(&centralDir[0], centralDir.size());
+        out->write(&end[0], end.size());
+    }
+#endif
+
+    /// Opens and reads every file of an archive, returns the bytes read
+    size_t readAll(Archive* archive, const StringVector& files, std::vector<uchar>& buffer)
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            DataStreamPtr stream = archive->open(files[i]);
+            buffer.resize(std::max(buffer.size(), stream->size()));
+            total += stream->read(&buffer[0], stream->size());
+        }
+        return total;
+    }
+
+    /** Reads all of Tests/Media from an archive of each type.
+    @remarks
+        The packs are written to the working directory first. The rate is of
+        the uncompressed data, the label has the size of the archive.
+    */
+    class ReadArchiveBenchmark : public ::Benchmark::Benchmark
+    {
+    public:
+        ReadArchiveBenchmark(const String& type) : ::Benchmark::Benchmark("ReadArchive/" + type), mType(type) {}
+
+        void run(::Benchmark::State& state)
+        {
+            FileSystemArchive media(getMediaPath(), "FileSystem", true);
+            media.load();
+            FileSystemArchive output(".", "FileSystem", false);
+            output.load();
+
+            Archive* archive = 0;
+            ArchiveFactory* factory = 0;
+            String packName;
+            if (mType == "FileSystem")
+            {
+                archive = &media;
+            }
+            else if (mType == "Pack")
+            {
+                packName = PACK_NAME;
+                PackArchiveWriter writer(output.create(packName));
+                writer.addArchive(&media);
+                writer.finish();
+                factory = OGRE_NEW PackArchiveFactory();
+            }
+#if OGRE_NO_ZIP_ARCHIVE == 0
+            else if (mType == "Zip")
+            {
+                packName = ZIP_NAME;
+                writeZip(&media, output.create(packName));
+                factory = OGRE_NEW ZipArchiveFactory();
+            }
+#endif
+            if (factory)
+            {
+                archive = factory->createInstance(packName, true);
+                archive->load();
+            }
+
+            // Full paths, all archive types open files by them
+            StringVector files;
+            FileInfoListPtr infos = media.listFileInfo(true, false);
+            for (FileInfoList::const_iterator i = infos->begin(); i != infos->end(); ++i)
+                files.push_back(i->path + i->basename);
+
+            std::vector<uchar> buffer;
+            uint64 bytes = 0;
+            while (state.keepRunning())
+                bytes += readAll(archive, files, buffer);
+            state.setBytesProcessed(bytes);
+
+            if (factory)
+            {
+                state.setLabel(StringConverter::toString(output.open(packName)->size() / 1024) + " KiB archive");
+                factory->destroyInstance(archive);
+                OGRE_DELETE factory;
+                output.remove(packName);
+            }
+        }
+
+    private:
+        String mType;
+    };
+
+    bool registerBenchmarks()
+    {
+        ::Benchmark::registerBenchmark(new ReadArchiveBenchmark("FileSystem"));
+        ::Benchmark::registerBenchmark(new ReadArchiveBenchmark("Pack"));
+#if OGRE_NO_ZIP_ARCHIVE == 0
+        ::Benchmark::registerBenchmark(new ReadArchiveBenchmark("Zip"));
+#endif
+        return true;
+    }
+
+    bool registered = registerBenchmarks();
+}
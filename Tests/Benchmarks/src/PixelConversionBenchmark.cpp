@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include "TestData.h"
+#include <OgrePixelFormat.h>
+#include <OgreStringConverter.h>
+
+using namespace Ogre;
+
+namespace {
+    const size_t IMAGE_SIZE = 256;
+
+    /** The formats packColour and unpackColour handle.
+    @remarks
+        The integer and signed formats are left out, their descriptions are
+        placeholders and don't round trip through floats.
+    */
+    const PixelFormat FORMATS[] = {
+        PF_L8, PF_L16, PF_A8, PF_A4L4, PF_BYTE_LA, PF_R5G6B5, PF_B5G6R5, PF_R3G3B2,
+        PF_A4R4G4B4, PF_A1R5G5B5, PF_R8G8B8, PF_B8G8R8, PF_A8R8G8B8, PF_A8B8G8R8,
+        PF_B8G8R8A8, PF_R8G8B8A8, PF_X8R8G8B8, PF_X8B8G8R8, PF_A2R10G10B10,
+        PF_A2B10G10R10, PF_FLOAT16_R, PF_FLOAT16_GR, PF_FLOAT16_RGB, PF_FLOAT16_RGBA,
+        PF_FLOAT32_R, PF_FLOAT32_GR, PF_FLOAT32_RGB, PF_FLOAT32_RGBA, PF_SHORT_GR,
+        PF_SHORT_RGB, PF_SHORT_RGBA, PF_R11G11B10_FLOAT, PF_R8, PF_RG8
+    };
+    const size_t NUM_FORMATS = sizeof(FORMATS) / sizeof(FORMATS[0]);
+
+    /// A square image of random colours
+    struct Image
+    {
+        PixelFormat format;
+        std::vector<uint8> data;
+
+        Image(PixelFormat pf)
+            : format(pf)
+            , data(IMAGE_SIZE * IMAGE_SIZE * PixelUtil::getNumElemBytes(pf))
+        {
+            TestRandom random(1234);
+            size_t pixelSize = PixelUtil::getNumElemBytes(pf);
+            for (size_t i = 0; i < IMAGE_SIZE * IMAGE_SIZE; ++i)
+            {
+                float c[4];
+                for (int j = 0; j < 4; ++j)
+                    c[j] = random.next(0, 1);
+                PixelUtil::packColour(c[0], c[1], c[2], c[3], pf, &data[i * pixelSize]);
+            }
+        }
+
+        PixelBox getPixelBox()
+        {
+            return PixelBox(IMAGE_SIZE, IMAGE_SIZE, 1, format, &data[0]);
+        }
+    };
+
+    /// Converts an image from the first format to the second one
+    void BM_PixelConversion(Benchmark::State& state)
+    {
+        Image src((PixelFormat)state.range(0));
+        Image dst((PixelFormat)state.range(1));
+        while (state.keepRunning())
+            PixelUtil::bulkPixelConversion(src.getPixelBox(), dst.getPixelBox());
+
+        state.setItemsProcessed((uint64)state.iterations() * IMAGE_SIZE * IMAGE_SIZE, "pixels");
+        state.setLabel(PixelUtil::getFormatName(src.format) + " -> " + PixelUtil::getFormatName(dst.format));
+    }
+    OGRE_BENCHMARK(BM_PixelConversion)
+        ->args(PF_BYTE_RGB, PF_BYTE_RGBA)
+        ->args(PF_BYTE_RGB, PF_BYTE_BGRA)
+        ->args(PF_BYTE_BGR, PF_BYTE_RGBA)
+        ->args(PF_BYTE_RGBA, PF_BYTE_RGB)
+        ->args(PF_BYTE_BGRA, PF_BYTE_RGBA)
+        ->args(PF_BYTE_RGBA, PF_BYTE_BGRA)
+        ->args(PF_BYTE_BGRA, PF_X8R8G8B8)
+        ->args(PF_L8, PF_BYTE_RGBA)
+        ->args(PF_A8, PF_BYTE_RGBA)
+        ->args(PF_BYTE_LA, PF_BYTE_RGBA)
+        ->args(PF_BYTE_RGBA, PF_FLOAT16_RGBA)
+        ->args(PF_FLOAT16_RGBA, PF_BYTE_RGBA)
+        ->args(PF_BYTE_RGB, PF_FLOAT32_RGB)
+        ->args(PF_BYTE_RGBA, PF_FLOAT32_RGBA)
+        ->args(PF_FLOAT32_RGBA, PF_BYTE_RGBA)
+        ->args(PF_FLOAT32_RGBA, PF_FLOAT16_RGBA);
+
+    /** Converts an image from the given format to every other format of the
+        list, so every pair is covered by one of the runs.
+    */
+    void BM_PixelConversionFrom(Benchmark::State& state)
+    {
+        Image src((PixelFormat)state.range(0));
+        std::vector<Image*> dsts;
+        for (size_t i = 0; i < NUM_FORMATS; ++i)
+        {
+            if (FORMATS[i] != src.format)
+                dsts.push_back(new Image(FORMATS[i]));
+        }
+
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < dsts.size(); ++i)
+                PixelUtil::bulkPixelConversion(src.getPixelBox(), dsts[i]->getPixelBox());
+        }
+
+        for (size_t i = 0; i < dsts.size(); ++i)
+            delete dsts[i];
+
+        state.setItemsProcessed((uint64)state.iterations() * dsts.size() * IMAGE_SIZE * IMAGE_SIZE, "pixels");
+        state.setLabel(PixelUtil::getFormatName(src.format) + " -> " +
+                       StringConverter::toString(dsts.size()) + " formats");
+    }
+
+    bool registerBenchmarks()
+    {
+        ::Benchmark::Benchmark* from = ::Benchmark::registerBenchmark(
+            new ::Benchmark::FunctionBenchmark("BM_PixelConversionFrom", BM_PixelConversionFrom));
+        for (size_t i = 0; i < NUM_FORMATS; ++i)
+            from->arg(FORMATS[i]);
+        return true;
+    }
+
+    bool registered = registerBenchmarks();
+}
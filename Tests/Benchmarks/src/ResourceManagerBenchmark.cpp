@@ -0,0 +1,192 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreResourceGroupManager.h>
+#include <OgreResourceManager.h>
+#include <OgreStringConverter.h>
+
+using namespace Ogre;
+
+#if OGRE_THREAD_SUPPORT
+namespace {
+    const size_t NUM_RESOURCES = 1000;
+    const size_t LOOKUPS_PER_ITERATION = 1000;
+    const char* GROUP = "Benchmark";
+
+    /// Resource which doesn't load anything
+    class EmptyResource : public Resource
+    {
+    public:
+        EmptyResource(ResourceManager* creator, const String& name, ResourceHandle handle,
+                      const String& group)
+            : Resource(creator, name, handle, group) {}
+
+    protected:
+        void loadImpl(void) {}
+        void unloadImpl(void) {}
+    };
+
+    class EmptyResourceManager : public ResourceManager
+    {
+    public:
+        EmptyResourceManager()
+        {
+            mResourceType = "Empty";
+            mLoadOrder = 100;
+            ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this);
+        }
+
+        ~EmptyResourceManager()
+        {
+            ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
+        }
+
+    protected:
+        Resource* createImpl(const String& name, ResourceHandle handle, const String& group,
+                             bool, ManualResourceLoader*, const NameValuePairList*)
+        {
+            return OGRE_NEW EmptyResource(this, name, handle, group);
+        }
+    };
+
+    /// State shared with the threads
+    struct Context
+    {
+        EmptyResourceManager* manager;
+        StringVector names;
+        AtomicScalar<uint32> stop;
+        AtomicScalar<uint32> failed;
+        AtomicScalar<uint32> loaded;
+
+        Context() : manager(0), stop(0), failed(0), loaded(0) {}
+
+        /// Looks up resources starting at the given index, returns the next index
+        size_t lookup(size_t index, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i, ++index)
+            {
+                if (!manager->getResourceByName(names[index % names.size()], GROUP))
+                    failed = 1;
+            }
+            return index;
+        }
+    };
+
+    /// Looks up resources until stopped
+    struct Reader
+    {
+        Context* context;
+        size_t start;
+
+        void operator()()
+        {
+            size_t index = start;
+            while (!context->stop.get())
+                index = context->lookup(index, 100);
+        }
+    };
+
+    /// Creates, loads and removes resources until stopped
+    struct Loader
+    {
+        Context* context;
+
+        void operator()()
+        {
+            StringVector names;
+            for (uint32 i = 0; !context->stop.get(); ++i)
+            {
+                names.push_back("Background" + StringConverter::toString(i));
+                context->manager->load(names.back(), GROUP);
+                ++context->loaded;
+                // Keep the number of resources constant
+                if (names.size() > 100)
+                {
+                    context->manager->remove(names.front(), GROUP);
+                    names.erase(names.begin());
+                }
+            }
+        }
+    };
+
+    /** getResourceByName from the timed thread, with more threads looking up
+        resources and one loading more of them in the background.
+    @remarks
+        Reports the lookups of the timed thread only. With lookups that don't
+        block each other, the rate stays the same as threads are added, as
+        long as there are enough cores.
+    */
+    void BM_ResourceLookupContention(Benchmark::State& state)
+    {
+        size_t numThreads = (size_t)state.range(0);
+
+        ResourceGroupManager* rgm = OGRE_NEW ResourceGroupManager();
+        rgm->createResourceGroup(GROUP);
+
+        Context context;
+        context.manager = OGRE_NEW EmptyResourceManager();
+        for (size_t i = 0; i < NUM_RESOURCES; ++i)
+        {
+            context.names.push_back("Resource" + StringConverter::toString(i));
+            context.manager->createResource(context.names.back(), GROUP);
+        }
+
+        std::vector<OGRE_THREAD_TYPE*> threads;
+        Loader loader = { &context };
+        OGRE_THREAD_CREATE(loaderThread, loader);
+        threads.push_back(loaderThread);
+        for (size_t i = 1; i < numThreads; ++i)
+        {
+            Reader reader = { &context, i * NUM_RESOURCES / numThreads };
+            OGRE_THREAD_CREATE(t, reader);
+            threads.push_back(t);
+        }
+
+        size_t index = 0;
+        while (state.keepRunning())
+            index = context.lookup(index, LOOKUPS_PER_ITERATION);
+
+        context.stop = 1;
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            threads[i]->join();
+            OGRE_THREAD_DESTROY(threads[i]);
+        }
+
+        if (context.failed.get())
+            state.skipWithError("a resource wasn't found");
+        state.setItemsProcessed((uint64)state.iterations() * LOOKUPS_PER_ITERATION, "lookups");
+        state.setLabel(StringConverter::toString(context.loaded.get()) + " loaded in the background");
+
+        OGRE_DELETE context.manager;
+        OGRE_DELETE rgm;
+    }
+    OGRE_BENCHMARK(BM_ResourceLookupContention)->arg(1)->arg(2)->arg(4)->arg(8);
+}
+#endif
@@ -0,0 +1,122 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include "TestData.h"
+#include <OgreCamera.h>
+#include <OgreDefaultHardwareBufferManager.h>
+#include <OgreMaterialManager.h>
+#include <OgreMesh.h>
+#include <OgreMeshManager.h>
+#include <OgreRoot.h>
+#include <Threading/OgreTaskScheduler.h>
+
+using namespace Ogre;
+
+namespace {
+    /** Updates a scene graph where every node moved, with the classic
+        per-node transforms (0) or the NodeTransformStorage (1).
+    */
+    void BM_UpdateSceneGraph(Benchmark::State& state)
+    {
+        size_t numNodes = (size_t)state.range(0);
+        bool soa = state.range(1) != 0;
+
+        Root root("", "", "");
+        SceneManager* sceneMgr = root.createSceneManager(ST_GENERIC);
+        sceneMgr->setNodeTransformStorageEnabled(soa);
+
+        std::vector<SceneNode*> nodes;
+        createNodeHierarchy(sceneMgr, nodes, numNodes);
+        // Lay out the storage outside of the timing
+        sceneMgr->_updateSceneGraph(0);
+
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < nodes.size(); ++i)
+                nodes[i]->yaw(Degree(1));
+            sceneMgr->_updateSceneGraph(0);
+        }
+
+        root.destroySceneManager(sceneMgr);
+
+        state.setItemsProcessed((uint64)state.iterations() * numNodes, "nodes");
+        state.setLabel(soa ? "NodeTransformStorage" : "classic");
+    }
+    OGRE_BENCHMARK(BM_UpdateSceneGraph)
+        ->args(10000, 0)->args(10000, 1)
+        ->args(100000, 0)->args(100000, 1)
+        ->args(1000000, 0)->args(1000000, 1);
+
+    /** Animates and finds a frame of 512 software skinned robots, blending
+        each entity as it is queued (0) or all of them at once (1), over the
+        given number of threads.
+    */
+    void BM_SoftwareSkinning(Benchmark::State& state)
+    {
+        bool parallel = state.range(0) != 0;
+        size_t numThreads = (size_t)state.range(1);
+
+        Root root("", "", "");
+        root.getTaskScheduler()->setWorkerThreadCount(numThreads - 1);
+        root.getTaskScheduler()->startup(true);
+        DefaultHardwareBufferManager hardwareBufferManager;
+        MaterialManager::getSingleton().initialise();
+        addMediaLocations();
+
+        SceneManager* sceneMgr = root.createSceneManager(ST_GENERIC);
+        sceneMgr->setParallelSoftwareSkinningEnabled(parallel);
+        RejectingRenderableListener rejectingListener;
+        sceneMgr->getRenderQueue()->setRenderableListener(&rejectingListener);
+        std::vector<Entity*> robots;
+        createRobots(sceneMgr, robots, 512);
+        Camera camera("Camera", sceneMgr);
+        camera.setPosition(0, 500, 1000);
+        camera.lookAt(0, 0, -800);
+        sceneMgr->_updateSceneGraph(&camera);
+
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < robots.size(); ++i)
+                robots[i]->getAnimationState("Walk")->addTime(0.02f);
+            VisibleObjectsBoundsInfo bounds;
+            sceneMgr->_findVisibleObjects(&camera, &bounds, false);
+            sceneMgr->_updateQueuedSoftwareSkinning();
+            // Releases the blended buffers
+            root._fireFrameRenderingQueued();
+        }
+
+        ResourceHandle meshHandle = robots[0]->getMesh()->getHandle();
+        root.destroySceneManager(sceneMgr);
+        MeshManager::getSingleton().remove(meshHandle);
+
+        state.setItemsProcessed((uint64)state.iterations() * robots.size(), "entities");
+        state.setLabel(parallel ? "batched" : "as queued");
+    }
+    OGRE_BENCHMARK(BM_SoftwareSkinning)
+        ->args(0, 1)->args(1, 1)->args(1, 2)->args(1, 4)->args(1, 8);
+}
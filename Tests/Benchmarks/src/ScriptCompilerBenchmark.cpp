@@ -0,0 +1,326 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Benchmark.h"
+#include <OgreConfigFile.h>
+#include <OgreFileSystem.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreMaterialManager.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreScriptCompiler.h>
+#include <OgreScriptParser.h>
+#include <OgreStringConverter.h>
+#include <Threading/OgreTaskScheduler.h>
+
+#include <fstream>
+
+using namespace Ogre;
+
+namespace {
+    const char* SCRIPT_DIR = "ScriptCompilerBenchmarkScripts";
+    const size_t NUM_SCRIPTS = 1000;
+    const size_t MATERIALS_PER_SCRIPT = 4;
+
+    /// Writes material scripts of a few typical materials each, returns their total size
+    size_t writeScripts()
+    {
+        FileSystemLayer::createDirectory(SCRIPT_DIR);
+        size_t totalSize = 0;
+        for (size_t i = 0; i < NUM_SCRIPTS; ++i)
+        {
+            StringStream script;
+            for (size_t j = 0; j < MATERIALS_PER_SCRIPT; ++j)
+            {
+                String name = StringConverter::toString(i) + "_" + StringConverter::toString(j);
+                script << "// Material " << name << "\n"
+                       << "material Benchmark" << name << "\n{\n"
+                       << "    receive_shadows on\n"
+                       << "    technique\n    {\n"
+                       << "        pass\n        {\n"
+                       << "            ambient 0.5 0.5 0.5 1\n"
+                       << "            diffuse 0.8 0.8 0.8 1\n"
+                       << "            specular 0.2 0.2 0.2 1 32\n"
+                       << "            scene_blend alpha_blend\n"
+                       << "            depth_write off\n"
+                       << "            texture_unit\n            {\n"
+                       << "                texture diffuse" << name << ".png\n"
+                       << "                tex_address_mode clamp\n"
+                       << "                filtering trilinear\n"
+                       << "            }\n"
+                       << "            texture_unit\n            {\n"
+                       << "                texture normal" << name << ".png\n"
+                       << "                scroll_anim 0.1 0.2\n"
+                       << "            }\n"
+                       << "        }\n    }\n}\n\n";
+            }
+            String text = script.str();
+            std::ofstream file((String(SCRIPT_DIR) + "/script" + StringConverter::toString(i) + ".material").c_str());
+            file << text;
+            totalSize += text.size();
+        }
+        return totalSize;
+    }
+
+    void removeScripts()
+    {
+        for (size_t i = 0; i < NUM_SCRIPTS; ++i)
+            FileSystemLayer::removeFile(String(SCRIPT_DIR) + "/script" + StringConverter::toString(i) + ".material");
+        FileSystemLayer::removeDirectory(SCRIPT_DIR);
+    }
+
+    /** Initialises a group of material scripts, serially (0) or in parallel
+        on the given number of threads.
+    @remarks
+        The files come from the OS cache after the first iteration.
+    */
+    void BM_ParseScripts(Benchmark::State& state)
+    {
+        size_t numThreads = (size_t)state.range(0);
+
+        Root root("", "", "");
+        if (numThreads)
+        {
+            root.getTaskScheduler()->setWorkerThreadCount(numThreads - 1);
+            root.getTaskScheduler()->startup(true);
+        }
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        rgm.setParseScriptsInParallel(numThreads != 0);
+        size_t totalSize = writeScripts();
+
+        while (state.keepRunning())
+        {
+            rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", "Benchmark");
+            rgm.initialiseResourceGroup("Benchmark");
+            rgm.destroyResourceGroup("Benchmark");
+        }
+
+        removeScripts();
+
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setItemsProcessed((uint64)state.iterations() * NUM_SCRIPTS, "scripts");
+        state.setLabel(numThreads ? StringConverter::toString(numThreads) + " threads" : "serial");
+    }
+    OGRE_BENCHMARK(BM_ParseScripts)->arg(0)->arg(1)->arg(2)->arg(4);
+
+    void removeCache(const String& cacheDir)
+    {
+        FileSystemArchive cache(cacheDir, "FileSystem", false);
+        cache.load();
+        StringVectorPtr entries = cache.list(false);
+        for (size_t i = 0; i < entries->size(); ++i)
+            cache.remove(entries->at(i));
+        FileSystemLayer::removeDirectory(cacheDir);
+    }
+
+    /** Turns the scripts into ASTs from memory, parsing them (0) or reading
+        them from the script cache (1), without translating them.
+    @remarks
+        The cache is filled before timing starts.
+    */
+    void BM_ScriptCacheParse(Benchmark::State& state)
+    {
+        const String cacheDir = "ScriptCacheBenchmarkCache";
+        bool useCache = state.range(0) != 0;
+
+        Root root("", "", "");
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        size_t totalSize = writeScripts();
+        rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", "Benchmark");
+        ScriptCompilerManager::getSingleton().setScriptCacheDirectory(cacheDir);
+        ScriptCompilerManager::getSingleton().buildScriptCache("Benchmark");
+
+        std::vector<std::pair<String, String> > scripts;
+        StringVectorPtr names = rgm.findResourceNames("Benchmark", "*.material");
+        for (size_t i = 0; i < names->size(); ++i)
+        {
+            DataStreamPtr stream = rgm.openResource(names->at(i), "Benchmark");
+            scripts.push_back(std::make_pair(stream->getName(), stream->getAsString()));
+        }
+
+        ScriptCompiler compiler;
+        if (useCache)
+            compiler.setCacheDirectory(cacheDir);
+        size_t numCached = 0;
+        while (state.keepRunning())
+        {
+            numCached = 0;
+            for (size_t i = 0; i < scripts.size(); ++i)
+            {
+                ScriptCompiler::ParsedScript script;
+                compiler._parse(scripts[i].second, scripts[i].first, "Benchmark", script);
+                numCached += script.cached;
+            }
+        }
+
+        rgm.destroyResourceGroup("Benchmark");
+        removeCache(cacheDir);
+        removeScripts();
+
+        if (useCache && numCached != scripts.size())
+            state.skipWithError("a script wasn't read from the cache");
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setItemsProcessed((uint64)state.iterations() * scripts.size(), "scripts");
+        state.setLabel(useCache ? "cache" : "parse");
+    }
+    OGRE_BENCHMARK(BM_ScriptCacheParse)->arg(0)->arg(1);
+
+    /** Initialises a group of material scripts with the script cache off (0)
+        or on (1), so includes creating the materials.
+    */
+    void BM_ScriptCacheInitialise(Benchmark::State& state)
+    {
+        const String cacheDir = "ScriptCacheBenchmarkCache";
+        bool useCache = state.range(0) != 0;
+
+        Root root("", "", "");
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        size_t totalSize = writeScripts();
+        if (useCache)
+        {
+            rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", "Benchmark");
+            ScriptCompilerManager::getSingleton().setScriptCacheDirectory(cacheDir);
+            ScriptCompilerManager::getSingleton().buildScriptCache("Benchmark");
+            rgm.destroyResourceGroup("Benchmark");
+        }
+
+        while (state.keepRunning())
+        {
+            rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", "Benchmark");
+            rgm.initialiseResourceGroup("Benchmark");
+            rgm.destroyResourceGroup("Benchmark");
+        }
+
+        if (useCache)
+            removeCache(cacheDir);
+        removeScripts();
+
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setItemsProcessed((uint64)state.iterations() * NUM_SCRIPTS, "scripts");
+        state.setLabel(useCache ? "cache" : "parse");
+    }
+    OGRE_BENCHMARK(BM_ScriptCacheInitialise)->arg(0)->arg(1);
+
+    /** Reads every script of the configured media into memory, as pairs of
+        name and text.
+    */
+    std::vector<std::pair<String, String> > readMediaScripts(size_t& totalSize)
+    {
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        ConfigFile cf;
+        cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+        ConfigFile::SettingsBySection_::const_iterator seci;
+        for (seci = cf.getSettingsBySection().begin(); seci != cf.getSettingsBySection().end(); ++seci)
+        {
+            ConfigFile::SettingsMultiMap::const_iterator i;
+            for (i = seci->second.begin(); i != seci->second.end(); ++i)
+            {
+                if (i->first == "FileSystem")
+                    rgm.addResourceLocation(i->second, i->first, seci->first);
+            }
+        }
+
+        std::vector<std::pair<String, String> > scripts;
+        totalSize = 0;
+        const StringVector& patterns = ScriptCompilerManager::getSingleton().getScriptPatterns();
+        StringVector groups = rgm.getResourceGroups();
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            for (size_t p = 0; p < patterns.size(); ++p)
+            {
+                StringVectorPtr names = rgm.findResourceNames(groups[g], patterns[p]);
+                for (size_t i = 0; i < names->size(); ++i)
+                {
+                    DataStreamPtr stream = rgm.openResource(names->at(i), groups[g]);
+                    scripts.push_back(std::make_pair(stream->getName(), stream->getAsString()));
+                    totalSize += scripts.back().second.size();
+                }
+            }
+        }
+        return scripts;
+    }
+
+    /** Parses every script of the configured media from memory:
+        - 0: into ScriptTokens and ConcreteNodes, as passed to listeners
+        - 1: into token and node views in an arena reused for every script
+        - 2: on to an AST, as compiling does before processing imports
+    */
+    void BM_ParseMediaScripts(Benchmark::State& state)
+    {
+        int mode = (int)state.range(0);
+
+        Root root("", "", "");
+        size_t totalSize;
+        std::vector<std::pair<String, String> > scripts = readMediaScripts(totalSize);
+        if (scripts.empty())
+        {
+            state.skipWithError("no scripts found");
+            return;
+        }
+
+        ScriptArena arena;
+        ScriptTokenViewList tokens;
+        ScriptCompiler compiler;
+        while (state.keepRunning())
+        {
+            for (size_t i = 0; i < scripts.size(); ++i)
+            {
+                try
+                {
+                    if (mode == 0)
+                    {
+                        ScriptParser::parse(ScriptLexer::tokenize(scripts[i].second, scripts[i].first));
+                    }
+                    else if (mode == 1)
+                    {
+                        arena.reset();
+                        tokens.clear();
+                        ScriptLexer::tokenize(scripts[i].second, scripts[i].first, tokens, arena);
+                        ConcreteNodeViewList nodes;
+                        ScriptParser::parse(tokens, nodes, arena);
+                    }
+                    else
+                    {
+                        ScriptCompiler::ParsedScript script;
+                        compiler._parse(scripts[i].second, scripts[i].first, "Benchmark", script);
+                    }
+                }
+                catch (Exception&)
+                {
+                    // Scripts with syntax errors are timed up to the error
+                }
+            }
+        }
+
+        state.setBytesProcessed((uint64)state.iterations() * totalSize);
+        state.setItemsProcessed((uint64)state.iterations() * scripts.size(), "scripts");
+        const char* modes[] = { "tokens and nodes", "views", "AST" };
+        state.setLabel(StringConverter::toString(scripts.size()) + " scripts, " + modes[mode]);
+    }
+    OGRE_BENCHMARK(BM_ParseMediaScripts)->arg(0)->arg(1)->arg(2);
+}
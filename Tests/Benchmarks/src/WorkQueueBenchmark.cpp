@@ -0,0 +1,143 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include <OgreRoot.h>
+#include <OgreStringConverter.h>
+#include <OgreTimer.h>
+#include <Threading/OgreDefaultWorkQueue.h>
+#include <Threading/OgreWorkStealingWorkQueue.h>
+
+using namespace Ogre;
+
+#if OGRE_THREAD_SUPPORT
+namespace {
+    const uint32 NUM_PRODUCERS = 4;
+    const uint32 REQUESTS_PER_ITERATION = 20000;
+
+    /// Burns a little time in every request, and measures its latency
+    struct BenchmarkHandler : public WorkQueue::RequestHandler, public WorkQueue::ResponseHandler
+    {
+        Timer* timer;
+        AtomicScalar<unsigned long> latency;
+        uint32 responses;
+        volatile float sink;
+
+        BenchmarkHandler(Timer* t) : timer(t), latency(0), responses(0), sink(0) {}
+
+        WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue*)
+        {
+            latency += timer->getMicroseconds() - any_cast<unsigned long>(req->getData());
+            float f = 0;
+            for (int i = 0; i < 200; ++i)
+                f += Math::Sqrt(float(i));
+            sink = f;
+            return OGRE_NEW WorkQueue::Response(req, true, Any());
+        }
+
+        void handleResponse(const WorkQueue::Response*, const WorkQueue*)
+        {
+            ++responses;
+        }
+    };
+
+    struct Producer
+    {
+        WorkQueue* queue;
+        Timer* timer;
+        uint32 numRequests;
+
+        void operator()()
+        {
+            for (uint32 i = 0; i < numRequests; ++i)
+                queue->addRequest(0, 0, Any(timer->getMicroseconds()));
+        }
+    };
+
+    /** Several threads adding small requests at once, while the main thread
+        processes the responses, with DefaultWorkQueue (0) or
+        WorkStealingWorkQueue (1) and the given number of workers.
+    */
+    void BM_WorkQueueThroughput(Benchmark::State& state)
+    {
+        bool stealing = state.range(0) != 0;
+        size_t numWorkers = (size_t)state.range(1);
+
+        Root root("", "", "");
+        DefaultWorkQueueBase* queue;
+        if (stealing)
+            queue = OGRE_NEW WorkStealingWorkQueue("Benchmark");
+        else
+            queue = OGRE_NEW DefaultWorkQueue("Benchmark");
+
+        Timer timer;
+        BenchmarkHandler handler(&timer);
+        queue->setWorkerThreadCount(numWorkers);
+        queue->setResponseProcessingTimeLimit(0);
+        queue->startup();
+        queue->addRequestHandler(0, &handler);
+        queue->addResponseHandler(0, &handler);
+
+        Producer producer = { queue, &timer, REQUESTS_PER_ITERATION / NUM_PRODUCERS };
+        while (state.keepRunning())
+        {
+            handler.responses = 0;
+            std::vector<OGRE_THREAD_TYPE*> producers;
+            for (uint32 i = 0; i < NUM_PRODUCERS; ++i)
+            {
+                OGRE_THREAD_CREATE(t, producer);
+                producers.push_back(t);
+            }
+            while (handler.responses < REQUESTS_PER_ITERATION)
+            {
+                queue->processResponses();
+                OGRE_THREAD_YIELD;
+            }
+            for (size_t i = 0; i < producers.size(); ++i)
+            {
+                producers[i]->join();
+                OGRE_THREAD_DESTROY(producers[i]);
+            }
+        }
+
+        queue->shutdown();
+        queue->removeRequestHandler(0, &handler);
+        queue->removeResponseHandler(0, &handler);
+        OGRE_DELETE queue;
+
+        uint64 numRequests = (uint64)state.iterations() * REQUESTS_PER_ITERATION;
+        state.setItemsProcessed(numRequests, "requests");
+        state.setLabel(String(stealing ? "WorkStealingWorkQueue, " : "DefaultWorkQueue, ") +
+                       StringConverter::toString(size_t(handler.latency.get() / std::max(numRequests, (uint64)1))) +
+                       " us mean latency");
+    }
+    OGRE_BENCHMARK(BM_WorkQueueThroughput)
+        ->args(0, 1)->args(1, 1)
+        ->args(0, 4)->args(1, 4)
+        ->args(0, 16)->args(1, 16);
+}
+#endif
@@ -0,0 +1,293 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef TESTS_COMMON_INCLUDE_TESTDATA_H_
+#define TESTS_COMMON_INCLUDE_TESTDATA_H_
+
+#include <OgreOptimisedUtil.h>
+#include <OgreMatrix4.h>
+#include <OgreAnimationState.h>
+#include <OgreConfigFile.h>
+#include <OgreEdgeListBuilder.h>
+#include <OgreEntity.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreRenderQueue.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreStringConverter.h>
+#include <vector>
+
+/** Random numbers for generated test and benchmark data.
+@remarks
+    A linear congruential generator, so the data is the same on every
+    platform, unlike with rand().
+*/
+class TestRandom
+{
+public:
+    explicit TestRandom(Ogre::uint32 seed) : mSeed(seed) {}
+
+    /// Gets the next 32 random bits, the high ones are the most random
+    Ogre::uint32 next(void)
+    {
+        mSeed = mSeed * 1664525 + 1013904223;
+        return mSeed;
+    }
+
+    /// Gets a random float in [min, max)
+    float next(float min, float max)
+    {
+        return min + float(next() >> 8) / float(1 << 24) * (max - min);
+    }
+
+private:
+    Ogre::uint32 mSeed;
+};
+
+/** Synthetic skinned mesh, positions and normals interleaved.
+@remarks
+    With a fixed weight count every vertex uses all of its weights. Mixed
+    meshes store 4 weights per vertex but only use 1 to 4 of them, the
+    rest are zero, which is how the mesh tools pad vertices influenced by
+    fewer bones.
+*/
+struct SkinnedMesh
+{
+    static const size_t NUM_MATRICES = 60;
+
+    size_t numVertices;
+    size_t numWeights;
+    bool mixed;
+    std::vector<float> vertices;
+    std::vector<float> weights;
+    std::vector<unsigned char> indices;
+    std::vector<Ogre::Matrix4> matrices;
+    std::vector<const Ogre::Matrix4*> matrixPtrs;
+    /// Blended with plain Matrix4 math, to verify the implementations against
+    std::vector<float> reference;
+
+    SkinnedMesh(size_t vertexCount, size_t weightCount, bool mixedWeights = false)
+        : numVertices(vertexCount), numWeights(weightCount), mixed(mixedWeights)
+    {
+        TestRandom random(1234);
+        for (size_t i = 0; i < NUM_MATRICES; ++i)
+        {
+            Ogre::Quaternion q(random.next(-1, 1), random.next(-1, 1), random.next(-1, 1), random.next(-1, 1));
+            q.normalise();
+            Ogre::Matrix4 m;
+            m.makeTransform(Ogre::Vector3(random.next(-5, 5), random.next(-5, 5), random.next(-5, 5)),
+                            Ogre::Vector3::UNIT_SCALE, q);
+            matrices.push_back(m);
+        }
+        for (size_t i = 0; i < NUM_MATRICES; ++i)
+            matrixPtrs.push_back(&matrices[i]);
+
+        vertices.reserve(numVertices * 6);
+        weights.reserve(numVertices * numWeights);
+        indices.reserve(numVertices * numWeights);
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            Ogre::Vector3 normal(random.next(-1, 1), random.next(-1, 1), random.next(-1, 1));
+            normal.normalise();
+            for (int j = 0; j < 3; ++j)
+                vertices.push_back(random.next(-50, 50));
+            vertices.push_back(normal.x);
+            vertices.push_back(normal.y);
+            vertices.push_back(normal.z);
+
+            size_t used = mixed ? std::min(size_t(random.next(1, 5)), numWeights) : numWeights;
+            float sum = 0;
+            for (size_t j = 0; j < numWeights; ++j)
+            {
+                float w = j < used ? random.next(0.1f, 1) : 0;
+                weights.push_back(w);
+                sum += w;
+                indices.push_back(j < used ? (unsigned char)(random.next(0, 1) * (NUM_MATRICES - 1)) : 0);
+            }
+            for (size_t j = 0; j < numWeights; ++j)
+                weights[weights.size() - 1 - j] /= sum;
+        }
+
+        calculateReference();
+    }
+
+    void calculateReference(void)
+    {
+        reference.resize(vertices.size());
+        for (size_t v = 0; v < numVertices; ++v)
+        {
+            const float* src = &vertices[v * 6];
+            Ogre::Vector3 pos(src), norm(src + 3);
+            Ogre::Vector3 blendedPos(Ogre::Vector3::ZERO), blendedNorm(Ogre::Vector3::ZERO);
+            for (size_t j = 0; j < numWeights; ++j)
+            {
+                float w = weights[v * numWeights + j];
+                const Ogre::Matrix4& m = matrices[indices[v * numWeights + j]];
+                blendedPos += m.transformAffine(pos) * w;
+                Ogre::Matrix3 m3x3;
+                m.extract3x3Matrix(m3x3);
+                blendedNorm += m3x3 * norm * w;
+            }
+            blendedNorm.normalise();
+            float* dst = &reference[v * 6];
+            dst[0] = blendedPos.x; dst[1] = blendedPos.y; dst[2] = blendedPos.z;
+            dst[3] = blendedNorm.x; dst[4] = blendedNorm.y; dst[5] = blendedNorm.z;
+        }
+    }
+
+    /// Blends the vertices into result, which must be as large as vertices
+    void skin(Ogre::OptimisedUtil* impl, std::vector<float>& result, bool blendNormals = true) const
+    {
+        impl->softwareVertexSkinning(
+            &vertices[0], &result[0],
+            blendNormals ? &vertices[3] : 0, &result[3],
+            &weights[0], &indices[0], &matrixPtrs[0],
+            6 * sizeof(float), 6 * sizeof(float),
+            6 * sizeof(float), 6 * sizeof(float),
+            numWeights * sizeof(float), numWeights,
+            numWeights, numVertices);
+    }
+
+    /// Returns an empty string if the result of skin matches the reference
+    Ogre::String verify(const std::vector<float>& result) const
+    {
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            float tolerance = 1e-3f * std::max(1.0f, Ogre::Math::Abs(reference[i]));
+            if (Ogre::Math::Abs(reference[i] - result[i]) > tolerance)
+            {
+                return "vertex " + Ogre::StringConverter::toString(i / 6) +
+                    " element " + Ogre::StringConverter::toString(i % 6) +
+                    " is " + Ogre::StringConverter::toString(result[i]) +
+                    ", expected " + Ogre::StringConverter::toString(reference[i]);
+            }
+        }
+        return Ogre::StringUtil::BLANK;
+    }
+};
+
+/// Random positions, 3 floats per vertex, for the shadow volume functions of OptimisedUtil
+inline void createPositions(std::vector<float>& positions, size_t numVertices)
+{
+    TestRandom random(98765);
+    for (size_t i = 0; i < numVertices * 3; ++i)
+        positions.push_back(random.next(-100, 100));
+}
+
+/// Random triangles of the positions, none of them degenerate
+inline void createTriangles(std::vector<Ogre::EdgeData::Triangle>& triangles, size_t numTriangles, size_t numVertices)
+{
+    TestRandom random(24680);
+    for (size_t i = 0; i < numTriangles; ++i)
+    {
+        // The normals of degenerate triangles are rounding noise
+        Ogre::EdgeData::Triangle t;
+        t.vertIndex[0] = std::min(size_t(random.next(0, 1) * numVertices), numVertices - 3);
+        t.vertIndex[1] = t.vertIndex[0] + 1;
+        t.vertIndex[2] = t.vertIndex[0] + 2;
+        if (i % 2)
+            std::swap(t.vertIndex[0], t.vertIndex[2]);
+        triangles.push_back(t);
+    }
+}
+
+/// Random boxes around the origin for the frustum tests, packed (x, y, z) centres and half sizes
+inline void createBoxes(std::vector<float>& centres, std::vector<float>& halfSizes, size_t numBoxes)
+{
+    TestRandom random(12345);
+    for (size_t i = 0; i < numBoxes * 3; ++i)
+    {
+        centres.push_back(random.next(-200, 200));
+        halfSizes.push_back(random.next(0, 10));
+    }
+}
+
+/// Creates a hierarchy of numNodes nodes including the root, each node having up to 4 children
+inline void createNodeHierarchy(Ogre::SceneManager* sceneMgr, std::vector<Ogre::SceneNode*>& nodes, size_t numNodes)
+{
+    nodes.push_back(sceneMgr->getRootSceneNode());
+    for (size_t i = 1; i < numNodes; ++i)
+    {
+        Ogre::SceneNode* node = nodes[(i - 1) / 4]->createChildSceneNode(
+            Ogre::Vector3(Ogre::Real(i % 7), Ogre::Real(i % 3), 1),
+            Ogre::Quaternion(Ogre::Degree(Ogre::Real(i % 11)), Ogre::Vector3::UNIT_Y));
+        node->setScale(Ogre::Vector3(1.01f, 1.0f, 0.99f));
+        node->setInheritOrientation(i % 5 != 0);
+        node->setInheritScale(i % 6 != 0);
+        nodes.push_back(node);
+    }
+}
+
+/// Adds the file system locations of the configured media
+inline void addMediaLocations(void)
+{
+    Ogre::ConfigFile cf;
+    cf.load(Ogre::FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+    Ogre::ConfigFile::SettingsBySection_::const_iterator seci;
+    for (seci = cf.getSettingsBySection().begin(); seci != cf.getSettingsBySection().end(); ++seci)
+    {
+        Ogre::ConfigFile::SettingsMultiMap::const_iterator i;
+        for (i = seci->second.begin(); i != seci->second.end(); ++i)
+        {
+            if (i->first == "FileSystem")
+                Ogre::ResourceGroupManager::getSingleton().addResourceLocation(i->second, i->first, seci->first);
+        }
+    }
+}
+
+/// Keeps renderables out of the queue, there's no render system to pick techniques
+struct RejectingRenderableListener : public Ogre::RenderQueue::RenderableListener
+{
+    bool renderableQueued(Ogre::Renderable*, Ogre::uint8, Ogre::ushort, Ogre::Technique**, Ogre::RenderQueue*)
+    {
+        return false;
+    }
+};
+
+/// Creates rows of 16 walking robots, robot.mesh has to be in the media
+inline void createRobots(Ogre::SceneManager* sceneMgr, std::vector<Ogre::Entity*>& robots, int count = 16)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Ogre::Entity* robot = sceneMgr->createEntity("robot.mesh");
+        Ogre::AnimationState* walk = robot->getAnimationState("Walk");
+        walk->setEnabled(true);
+        walk->setTimePosition(Ogre::Real(i) * 0.1f);
+        Ogre::SceneNode* node = sceneMgr->getRootSceneNode()->createChildSceneNode(
+            Ogre::Vector3(Ogre::Real(i % 16 - 8) * 50, 0, Ogre::Real(i / 16) * -50));
+        node->attachObject(robot);
+        // The cached transform isn't always computed by _update, depending on the build
+        Ogre::Matrix4 transform;
+        transform.makeTransform(node->getPosition(), Ogre::Vector3::UNIT_SCALE, Ogre::Quaternion::IDENTITY);
+        node->overrideCachedTransform(transform);
+        robots.push_back(robot);
+    }
+}
+
+#endif /* TESTS_COMMON_INCLUDE_TESTDATA_H_ */
@@ -32,11 +32,13 @@ THE SOFTWARE.
 #include <gtest/gtest.h>
 #include "OgreZip.h"
 
-class ZipArchiveTests : public ::testing::Test
+/// Run with ZipArchive::setUseMemoryMapping false and true
+class ZipArchiveTests : public ::testing::TestWithParam<bool>
 {
 
 protected:
-    Ogre::ZipArchive* arch;
+    Ogre::ZipArchiveFactory factory;
+    Ogre::Archive* arch;
 public:
     void SetUp();
     void TearDown();
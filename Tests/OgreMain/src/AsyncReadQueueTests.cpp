@@ -0,0 +1,330 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <Threading/OgreAsyncReadQueue.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+#include <fstream>
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture AsyncReadQueueTests;
+
+namespace {
+    /// Collects the results, optionally holding up the I/O thread
+    struct ReadCollector : public AsyncReadQueue::Listener
+    {
+        typedef std::map<AsyncReadQueue::RequestID, AsyncReadQueue::Result> ResultMap;
+        ResultMap results;
+        AtomicScalar<uint32> hold;
+        AtomicScalar<uint32> started;
+        OGRE_MUTEX(mutex);
+
+        ReadCollector() : hold(0), started(0) {}
+
+        void readCompleted(const AsyncReadQueue::Result& result)
+        {
+            ++started;
+            while (hold.get())
+                OGRE_THREAD_SLEEP(1);
+            OGRE_LOCK_MUTEX(mutex);
+            results[result.id] = result;
+        }
+
+        String getData(AsyncReadQueue::RequestID id)
+        {
+            OGRE_LOCK_MUTEX(mutex);
+            ResultMap::iterator i = results.find(id);
+            if (i == results.end() || !i->second.succeeded())
+                return "<failed>";
+            return i->second.data->getAsString();
+        }
+    };
+
+    String getArchiveTestPath()
+    {
+        return ResourceGroupManager::getSingleton().getResourceLocationList("Tests").front()->archive->getName() +
+            "/misc/ArchiveTest";
+    }
+
+    String readWholeFile(const String& path)
+    {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        return String((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    /// A stream which isn't in memory, whatever the archive does
+    DataStreamPtr openFileStream(const String& path)
+    {
+        std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(path.c_str(), std::ios::binary);
+        return DataStreamPtr(OGRE_NEW FileStreamDataStream(path, file, true));
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ReadOnCallingThread)
+{
+    // Without I/O threads the read completes right away
+    AsyncReadQueue queue("Test");
+    queue.startup();
+
+    String path = getArchiveTestPath() + "/rootfile.txt";
+    ReadCollector collector;
+    AsyncReadQueue::RequestID id = queue.read(openFileStream(path), 5, 10, &collector);
+    EXPECT_EQ(0u, queue.getPendingCount());
+    EXPECT_EQ(readWholeFile(path).substr(5, 10), collector.getData(id));
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// A stream whose reads fail with a standard exception
+    struct ThrowingDataStream : public DataStream
+    {
+        size_t read(void*, size_t) { throw std::bad_alloc(); }
+        void skip(long) {}
+        void seek(size_t) {}
+        size_t tell(void) const { return 0; }
+        bool eof(void) const { return false; }
+        void close(void) {}
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ReadFailsOnStandardException)
+{
+    AsyncReadQueue queue("Test");
+    queue.startup();
+
+    ReadCollector collector;
+    AsyncReadQueue::RequestID id = queue.read(DataStreamPtr(OGRE_NEW ThrowingDataStream()), 0, 10, &collector);
+    EXPECT_EQ(0u, queue.getPendingCount());
+    ASSERT_EQ(1u, collector.results.count(id));
+    EXPECT_FALSE(collector.results[id].succeeded());
+    EXPECT_FALSE(collector.results[id].error.empty());
+}
+#if OGRE_ASYNC_READ_THREADS
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ReadRanges)
+{
+    AsyncReadQueue queue("Test");
+    queue.setThreadCount(3);
+    queue.startup();
+
+    // Reads of the same stream from several threads
+    String path = getArchiveTestPath() + "/rootfile2.txt";
+    String contents = readWholeFile(path);
+    ASSERT_FALSE(contents.empty());
+    DataStreamPtr stream = openFileStream(path);
+    ReadCollector collector;
+    std::vector<AsyncReadQueue::RequestID> ids;
+    for (size_t i = 0; i < 100; ++i)
+        ids.push_back(queue.read(stream, i % contents.size(), 17, &collector));
+    // Stops at the end
+    AsyncReadQueue::RequestID pastEnd = queue.read(stream, contents.size() - 3, 100, &collector);
+    AsyncReadQueue::RequestID wholeFile = queue.read(stream, 0, contents.size(), &collector);
+
+    queue.shutdown();
+    EXPECT_EQ(0u, queue.getPendingCount());
+    for (size_t i = 0; i < ids.size(); ++i)
+        EXPECT_EQ(contents.substr(i % contents.size(), 17), collector.getData(ids[i])) << "read " << i;
+    EXPECT_EQ(contents.substr(contents.size() - 3), collector.getData(pastEnd));
+    EXPECT_EQ(contents, collector.getData(wholeFile));
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ReadFiles)
+{
+    AsyncReadQueue queue("Test");
+    queue.setThreadCount(3);
+    queue.startup();
+
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.addResourceLocation(getArchiveTestPath(), "FileSystem", "AsyncRead", true);
+    rgm.initialiseResourceGroup("AsyncRead");
+    Archive* archive = rgm.getResourceLocationList("AsyncRead").front()->archive;
+
+    ReadCollector collector;
+    AsyncReadQueue::RequestID fromGroup = queue.readFile("level2/materials/scripts/file3.material", "AsyncRead", &collector);
+    AsyncReadQueue::RequestID fromArchive = queue.readFile(archive, "rootfile.txt", &collector);
+    AsyncReadQueue::RequestID missing = queue.readFile("missing.txt", "AsyncRead", &collector);
+
+    queue.shutdown();
+    EXPECT_EQ(readWholeFile(getArchiveTestPath() + "/level2/materials/scripts/file3.material"),
+              collector.getData(fromGroup));
+    EXPECT_EQ(readWholeFile(getArchiveTestPath() + "/rootfile.txt"), collector.getData(fromArchive));
+    EXPECT_FALSE(collector.results[fromArchive].source.isNull());
+
+    ASSERT_EQ(1u, collector.results.count(missing));
+    EXPECT_FALSE(collector.results[missing].succeeded());
+    EXPECT_FALSE(collector.results[missing].error.empty());
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, Abort)
+{
+    AsyncReadQueue queue("Test");
+    queue.setThreadCount(1);
+    queue.startup();
+
+    String path = getArchiveTestPath() + "/rootfile.txt";
+    ReadCollector collector;
+    collector.hold = 1;
+    AsyncReadQueue::RequestID running = queue.read(openFileStream(path), 0, 10, &collector);
+    Timer timer;
+    while (!collector.started.get() && timer.getMilliseconds() < 10000)
+        OGRE_THREAD_SLEEP(1);
+
+    // The first read holds up the only thread, so the second one can't start
+    AsyncReadQueue::RequestID queued = queue.read(openFileStream(path), 0, 10, &collector);
+    EXPECT_EQ(2u, queue.getPendingCount());
+    EXPECT_FALSE(queue.abortRequest(running));
+    EXPECT_TRUE(queue.abortRequest(queued));
+    EXPECT_FALSE(queue.abortRequest(queued));
+    EXPECT_EQ(1u, queue.getPendingCount());
+
+    collector.hold = 0;
+    queue.shutdown();
+    EXPECT_EQ(0u, queue.getPendingCount());
+    EXPECT_EQ(1u, collector.results.size());
+    EXPECT_EQ(1u, collector.results.count(running));
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// Counts the bytes of the files it processes, on the worker threads
+    struct ByteCounter : public ResourceBackgroundQueue::FileProcessor, public ResourceBackgroundQueue::Listener
+    {
+        AtomicScalar<size_t> bytes;
+        std::map<BackgroundProcessTicket, BackgroundProcessResult> results;
+
+        ByteCounter() : bytes(0) {}
+
+        void processFile(const DataStreamPtr& stream, const String&, const String&)
+        {
+            // The bytes are in memory already
+            EXPECT_TRUE(stream->getCurrentMemoryPtr() != 0);
+            bytes += stream->size();
+        }
+
+        void operationCompleted(BackgroundProcessTicket ticket, const BackgroundProcessResult& result)
+        {
+            results[ticket] = result;
+        }
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ResourceBackgroundQueueReadFile)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.addResourceLocation(getArchiveTestPath(), "FileSystem", "AsyncRead", true);
+    rgm.initialiseResourceGroup("AsyncRead");
+
+    WorkQueue* workQueue = Root::getSingleton().getWorkQueue();
+    ResourceBackgroundQueue& rbq = ResourceBackgroundQueue::getSingleton();
+    rbq.initialise();
+    workQueue->startup();
+    Root::getSingleton().getAsyncReadQueue()->startup();
+
+    const char* files[] = { "rootfile.txt", "rootfile2.txt", "level1/materials/scripts/file.material", "level2/materials/scripts/file4.material" };
+    size_t expectedBytes = 0;
+    ByteCounter counter;
+    std::vector<BackgroundProcessTicket> tickets;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        tickets.push_back(rbq.readFile(files[i], "AsyncRead", &counter, &counter));
+        expectedBytes += rgm.openResource(files[i], "AsyncRead")->size();
+    }
+    BackgroundProcessTicket missing = rbq.readFile("missing.txt", "AsyncRead", &counter, &counter);
+
+    Timer timer;
+    while (counter.results.size() < 5 && timer.getMilliseconds() < 10000)
+    {
+        workQueue->processResponses();
+        OGRE_THREAD_SLEEP(1);
+    }
+
+    EXPECT_EQ(expectedBytes, counter.bytes.get());
+    for (size_t i = 0; i < tickets.size(); ++i)
+    {
+        EXPECT_TRUE(rbq.isProcessComplete(tickets[i]));
+        ASSERT_EQ(1u, counter.results.count(tickets[i]));
+        EXPECT_FALSE(counter.results[tickets[i]].error) << counter.results[tickets[i]].message;
+    }
+    EXPECT_TRUE(rbq.isProcessComplete(missing));
+    ASSERT_EQ(1u, counter.results.count(missing));
+    EXPECT_TRUE(counter.results[missing].error);
+
+    rbq.shutdown();
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// Holds up the worker thread processing the file until released
+    struct HoldingProcessor : public ByteCounter
+    {
+        AtomicScalar<uint32> hold;
+        AtomicScalar<uint32> started;
+
+        HoldingProcessor() : hold(1), started(0) {}
+
+        void processFile(const DataStreamPtr& stream, const String& filename, const String& group)
+        {
+            ++started;
+            while (hold.get())
+                OGRE_THREAD_SLEEP(1);
+            ByteCounter::processFile(stream, filename, group);
+        }
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(AsyncReadQueueTests, ResourceBackgroundQueueAbortProcessedFile)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.addResourceLocation(getArchiveTestPath(), "FileSystem", "AsyncRead", true);
+    rgm.initialiseResourceGroup("AsyncRead");
+
+    WorkQueue* workQueue = Root::getSingleton().getWorkQueue();
+    ResourceBackgroundQueue& rbq = ResourceBackgroundQueue::getSingleton();
+    rbq.initialise();
+    workQueue->startup();
+    Root::getSingleton().getAsyncReadQueue()->startup();
+
+    // Aborted once the file has been read and handed to the WorkQueue
+    HoldingProcessor processor;
+    BackgroundProcessTicket ticket = rbq.readFile("rootfile.txt", "AsyncRead", &processor, &processor);
+    Timer timer;
+    while (!processor.started.get() && timer.getMilliseconds() < 10000)
+        OGRE_THREAD_SLEEP(1);
+    ASSERT_TRUE(processor.started.get() != 0);
+    rbq.abortRequest(ticket);
+    processor.hold = 0;
+
+    while (!rbq.isProcessComplete(ticket) && timer.getMilliseconds() < 10000)
+    {
+        workQueue->processResponses();
+        OGRE_THREAD_SLEEP(1);
+    }
+    EXPECT_TRUE(rbq.isProcessComplete(ticket));
+    EXPECT_TRUE(processor.results.empty());
+
+    rbq.shutdown();
+}
+#endif
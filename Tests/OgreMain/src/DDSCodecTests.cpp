@@ -0,0 +1,189 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreDDSCodec.h>
+#include <Threading/OgreTaskScheduler.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include "TestData.h"
+
+#include <fstream>
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture DDSCodecTests;
+
+namespace {
+    /// Smooth gradients with a little noise, in RGBA
+    std::vector<uint8> makeImage(size_t width, size_t height)
+    {
+        std::vector<uint8> pixels(width * height * 4);
+        TestRandom random(1234);
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                uint32 bits = random.next();
+                uint8* p = &pixels[(y * width + x) * 4];
+                p[0] = uint8(x * 255 / width);
+                p[1] = uint8(y * 255 / height);
+                p[2] = uint8(128 + (bits >> 28));
+                p[3] = uint8((x + y) * 255 / (width + height));
+            }
+        }
+        return pixels;
+    }
+
+    /// Compresses RGBA pixels and decompresses them again
+    std::vector<uint8> roundTrip(std::vector<uint8>& pixels, size_t width, size_t height,
+                                 PixelFormat format)
+    {
+        std::vector<uint8> blocks(PixelUtil::getMemorySize(width, height, 1, format));
+        std::vector<uint8> result(pixels.size());
+        PixelBox src(width, height, 1, PF_BYTE_RGBA, &pixels[0]);
+        PixelBox compressed(width, height, 1, format, &blocks[0]);
+        DDSCodec::compress(src, compressed);
+        DDSCodec::decompress(compressed, PixelBox(width, height, 1, PF_BYTE_RGBA, &result[0]));
+        return result;
+    }
+
+    /// Largest difference of a channel
+    int getMaxError(const std::vector<uint8>& a, const std::vector<uint8>& b, size_t channel)
+    {
+        int maxError = 0;
+        for (size_t i = channel; i < a.size(); i += 4)
+            maxError = std::max(maxError, std::abs(int(a[i]) - int(b[i])));
+        return maxError;
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(DDSCodecTests, DecompressDXT1)
+{
+    // Red and blue, indexes 0 to 3 in every row
+    uint8 block[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+    uint8 texels[16 * 4];
+    DDSCodec::decompress(PixelBox(4, 4, 1, PF_DXT1, block), PixelBox(4, 4, 1, PF_BYTE_RGBA, texels));
+
+    const uint8 expected[4][4] = { { 255, 0, 0, 255 }, { 0, 0, 255, 255 },
+                                   { 170, 0, 85, 255 }, { 85, 0, 170, 255 } };
+    for (size_t i = 0; i < 16; ++i)
+    {
+        for (size_t c = 0; c < 4; ++c)
+            EXPECT_EQ(expected[i % 4][c], texels[i * 4 + c]);
+    }
+
+    // The same colours the other way round select the transparent palette
+    std::swap(block[0], block[2]);
+    std::swap(block[1], block[3]);
+    DDSCodec::decompress(PixelBox(4, 4, 1, PF_DXT1, block), PixelBox(4, 4, 1, PF_BYTE_RGBA, texels));
+    EXPECT_EQ(128, texels[2 * 4]);
+    EXPECT_EQ(128, texels[2 * 4 + 2]);
+    EXPECT_EQ(0, texels[3 * 4 + 3]);
+}
+//--------------------------------------------------------------------------
+TEST_F(DDSCodecTests, CompressRoundTrip)
+{
+    // Not a multiple of the block size
+    const size_t width = 70, height = 38;
+    std::vector<uint8> pixels = makeImage(width, height);
+
+    // Opaque, as DXT1 makes texels with little alpha transparent black
+    std::vector<uint8> opaque = pixels;
+    for (size_t i = 3; i < opaque.size(); i += 4)
+        opaque[i] = 255;
+    std::vector<uint8> dxt1 = roundTrip(opaque, width, height, PF_DXT1);
+    for (size_t c = 0; c < 4; ++c)
+        EXPECT_GE(12, getMaxError(opaque, dxt1, c));
+
+    std::vector<uint8> dxt3 = roundTrip(pixels, width, height, PF_DXT3);
+    EXPECT_GE(12, getMaxError(pixels, dxt3, 0));
+    EXPECT_GE(9, getMaxError(pixels, dxt3, 3));
+
+    std::vector<uint8> dxt5 = roundTrip(pixels, width, height, PF_DXT5);
+    EXPECT_GE(12, getMaxError(pixels, dxt5, 1));
+    EXPECT_GE(4, getMaxError(pixels, dxt5, 3));
+
+    std::vector<uint8> bc5 = roundTrip(pixels, width, height, PF_BC5_UNORM);
+    EXPECT_GE(4, getMaxError(pixels, bc5, 0));
+    EXPECT_GE(4, getMaxError(pixels, bc5, 1));
+    EXPECT_EQ(0, bc5[2]);
+    EXPECT_EQ(255, bc5[3]);
+}
+//--------------------------------------------------------------------------
+TEST_F(DDSCodecTests, CompressDXT1Transparency)
+{
+    std::vector<uint8> pixels = makeImage(8, 8);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+        pixels[i + 3] = (i / 4) % 3 ? 255 : 0;
+
+    std::vector<uint8> result = roundTrip(pixels, 8, 8, PF_DXT1);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+        EXPECT_EQ(pixels[i + 3], result[i + 3]);
+}
+//--------------------------------------------------------------------------
+TEST_F(DDSCodecTests, ThreadsDontChangeResult)
+{
+    const size_t width = 512, height = 256;
+    std::vector<uint8> pixels = makeImage(width, height);
+
+    mRoot->getTaskScheduler()->setWorkerThreadCount(0);
+    mRoot->getTaskScheduler()->startup(true);
+    std::vector<uint8> serial = roundTrip(pixels, width, height, PF_DXT5);
+
+    mRoot->getTaskScheduler()->setWorkerThreadCount(3);
+    mRoot->getTaskScheduler()->startup(true);
+    std::vector<uint8> parallel = roundTrip(pixels, width, height, PF_DXT5);
+    EXPECT_TRUE(serial == parallel);
+}
+//--------------------------------------------------------------------------
+TEST_F(DDSCodecTests, SaveCompressed)
+{
+    const size_t width = 64, height = 32;
+    std::vector<uint8> pixels = makeImage(width, height);
+    std::vector<uint8> expected = roundTrip(pixels, width, height, PF_DXT5);
+
+    uchar* blocks = OGRE_ALLOC_T(uchar, PixelUtil::getMemorySize(width, height, 1, PF_DXT5),
+                                 MEMCATEGORY_GENERAL);
+    Image image;
+    image.loadDynamicImage(blocks, width, height, 1, PF_DXT5, true);
+    DDSCodec::compress(PixelBox(width, height, 1, PF_BYTE_RGBA, &pixels[0]), image.getPixelBox());
+    image.save("DDSCodecTests.dds");
+
+    // Without a render system it's decompressed when loading
+    std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+        "DDSCodecTests.dds", std::ios::in | std::ios::binary);
+    DataStreamPtr stream(OGRE_NEW FileStreamDataStream(file, true));
+    Image loaded;
+    loaded.load(stream, "dds");
+    stream->close();
+    FileSystemLayer::removeFile("DDSCodecTests.dds");
+
+    ASSERT_EQ(PF_BYTE_RGBA, loaded.getFormat());
+    ASSERT_EQ(width, loaded.getWidth());
+    ASSERT_EQ(height, loaded.getHeight());
+    EXPECT_EQ(0, memcmp(&expected[0], loaded.getData(), expected.size()));
+}
@@ -330,3 +330,66 @@ TEST_F(FileSystemArchiveTests,CreateAndRemoveFile)
     EXPECT_TRUE(!arch.exists(fileName));
 }
 //--------------------------------------------------------------------------
+TEST_F(FileSystemArchiveTests,MemoryMappedRead)
+{
+    FileSystemArchive arch(mTestPath, "FileSystem", true);
+    arch.load();
+
+    DataStreamPtr stream = arch.open("rootfile.txt");
+    if (MappedFileDataStream::isSupported())
+    {
+        // Readable in place
+        ASSERT_TRUE(stream->getCurrentMemoryPtr() != 0);
+        EXPECT_EQ(mFileSizeRoot1, stream->size());
+        EXPECT_EQ(String("this is line 1"), String((const char*)stream->getCurrentMemoryPtr(), 14));
+    }
+    EXPECT_EQ(String("this is line 1 in file 1"), stream->getLine());
+    if (MappedFileDataStream::isSupported())
+    {
+        EXPECT_EQ(String("this is line 2"), String((const char*)stream->getCurrentMemoryPtr(), 14));
+    }
+    EXPECT_EQ(String("this is line 2 in file 1"), stream->getLine());
+    stream->close();
+
+    FileSystemArchive::setUseMemoryMapping(false);
+    stream = arch.open("rootfile.txt");
+    FileSystemArchive::setUseMemoryMapping(true);
+    EXPECT_TRUE(stream->getCurrentMemoryPtr() == 0);
+    EXPECT_EQ(String("this is line 1 in file 1"), stream->getLine());
+}
+//--------------------------------------------------------------------------
+TEST_F(FileSystemArchiveTests,MemoryMappedCreatedFile)
+{
+    FileSystemArchive arch("./", "FileSystem", false);
+    arch.load();
+
+    String fileName = "a_mapped_test_file.txt";
+    String testString = "Some text here";
+    DataStreamPtr stream = arch.create(fileName);
+    stream->write(testString.c_str(), testString.size());
+    stream->close();
+
+    // Streams opened for writing are never mapped
+    stream = arch.open(fileName, false);
+    EXPECT_TRUE(stream->getCurrentMemoryPtr() == 0);
+    EXPECT_TRUE(stream->isWriteable());
+    stream->close();
+
+    stream = arch.open(fileName);
+    EXPECT_FALSE(stream->isWriteable());
+    EXPECT_EQ(testString.size(), stream->size());
+    EXPECT_EQ(testString, stream->getAsString());
+    stream->close();
+
+    // Empty files can't be mapped but are opened all the same
+    stream = arch.create(fileName);
+    stream->close();
+    stream = arch.open(fileName);
+    EXPECT_EQ((size_t)0, stream->size());
+    EXPECT_EQ(BLANKSTRING, stream->getAsString());
+    EXPECT_TRUE(stream->eof());
+    stream->close();
+
+    arch.remove(fileName);
+    EXPECT_TRUE(!arch.exists(fileName));
+}
@@ -0,0 +1,134 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreOptimisedUtil.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include "TestData.h"
+
+namespace Ogre {
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+#if __OGRE_HAVE_SSE
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+#endif
+}
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture FrustumTests;
+
+namespace {
+    void setupCamera(Camera& cam)
+    {
+        cam.setPosition(10, 20, 30);
+        cam.lookAt(50, 0, -100);
+        cam.setNearClipDistance(1);
+        cam.setFarClipDistance(150);
+    }
+
+    std::vector<OptimisedUtil*> getImplementations(void)
+    {
+        std::vector<OptimisedUtil*> impls;
+        impls.push_back(_getOptimisedUtilGeneral());
+#if __OGRE_HAVE_SSE
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+            impls.push_back(_getOptimisedUtilSSE());
+#endif
+        return impls;
+    }
+}
+
+TEST_F(FrustumTests, BatchedBoxVisibility)
+{
+    SceneManager* sceneMgr = mRoot->createSceneManager(ST_GENERIC);
+    // Not created through the scene manager, which needs a render system for cameras
+    Camera cam("Cam", sceneMgr);
+    setupCamera(cam);
+
+    // Not a multiple of 4 nor of 32, so the tails are exercised too
+    const size_t numBoxes = 1003;
+    std::vector<float> centres, halfSizes;
+    createBoxes(centres, halfSizes, numBoxes);
+
+    std::vector<uint32> visibility((numBoxes + 31) / 32, 0xDEADBEEF);
+    bool anyVisible = cam.isVisible(&centres[0], &halfSizes[0], numBoxes, &visibility[0]);
+
+    size_t numVisible = 0;
+    for (size_t i = 0; i < numBoxes; ++i)
+    {
+        Vector3 centre(centres[i * 3], centres[i * 3 + 1], centres[i * 3 + 2]);
+        Vector3 halfSize(halfSizes[i * 3], halfSizes[i * 3 + 1], halfSizes[i * 3 + 2]);
+        bool expected = cam.isVisible(AxisAlignedBox(centre - halfSize, centre + halfSize));
+        bool actual = ((visibility[i / 32] >> (i % 32)) & 1) != 0;
+        EXPECT_EQ(expected, actual) << "box " << i;
+        numVisible += expected;
+    }
+    EXPECT_GT(numVisible, 0u);
+    EXPECT_LT(numVisible, numBoxes);
+    EXPECT_TRUE(anyVisible);
+    // Unused bits of the last word are cleared
+    EXPECT_EQ(0u, visibility.back() >> (numBoxes % 32));
+
+    // Nothing visible behind the camera
+    std::vector<float> behind(numBoxes * 3, 0);
+    for (size_t i = 0; i < numBoxes; ++i)
+    {
+        Vector3 pos = cam.getDerivedPosition() - cam.getDerivedDirection() * Real(50 + i);
+        behind[i * 3 + 0] = pos.x;
+        behind[i * 3 + 1] = pos.y;
+        behind[i * 3 + 2] = pos.z;
+    }
+    EXPECT_FALSE(cam.isVisible(&behind[0], &halfSizes[0], numBoxes, &visibility[0]));
+
+    mRoot->destroySceneManager(sceneMgr);
+}
+
+TEST_F(FrustumTests, BoxVisibilityImplementationsMatch)
+{
+    const size_t numBoxes = 4099;
+    std::vector<float> centres, halfSizes;
+    createBoxes(centres, halfSizes, numBoxes);
+
+    // A few axis aligned and a few oblique planes
+    const float planes[] = {
+        1, 0, 0, 50,
+        0, -1, 0, 80,
+        0.6f, 0, 0.8f, 20,
+        -0.48f, 0.6f, -0.64f, 100,
+    };
+
+    std::vector<OptimisedUtil*> impls = getImplementations();
+    std::vector<uint32> expected((numBoxes + 31) / 32);
+    impls[0]->calculateBoxVisibility(planes, 4, &centres[0], &halfSizes[0], &expected[0], numBoxes);
+    for (size_t i = 1; i < impls.size(); ++i)
+    {
+        std::vector<uint32> actual((numBoxes + 31) / 32, 0xFFFFFFFF);
+        impls[i]->calculateBoxVisibility(planes, 4, &centres[0], &halfSizes[0], &actual[0], numBoxes);
+        EXPECT_EQ(expected, actual);
+    }
+}
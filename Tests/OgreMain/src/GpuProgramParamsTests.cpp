@@ -0,0 +1,180 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <gtest/gtest.h>
+#include <OgreAutoParamDataSource.h>
+#include <OgreCamera.h>
+#include <OgreException.h>
+#include <OgreGpuProgramParams.h>
+#include <OgreVector4.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture GpuProgramAutoParamsTests;
+
+namespace {
+    /// Adds a constant, float4 unless given, or an array of them
+    void addConstant(GpuNamedConstants& constants, const String& name, size_t arraySize = 1,
+                     GpuConstantType type = GCT_FLOAT4)
+    {
+        GpuConstantDefinition def;
+        def.constType = type;
+        def.elementSize = GpuConstantDefinition::getElementSize(type, true);
+        def.arraySize = arraySize;
+        size_t& bufferSize = def.isInt() ? constants.intBufferSize : constants.floatBufferSize;
+        def.physicalIndex = bufferSize;
+        bufferSize += def.elementSize * arraySize;
+        constants.map[name] = def;
+        if (arraySize > 1)
+            constants.generateConstantDefinitionArrayEntries(name, def);
+    }
+}
+//--------------------------------------------------------------------------
+TEST(GpuProgramParamsTests, FindByNameAndHandle)
+{
+    GpuNamedConstants constants;
+    addConstant(constants, "colour");
+    addConstant(constants, "lights", 3);
+
+    ASSERT_TRUE(constants.findConstantDefinition("colour"));
+    EXPECT_EQ(0u, constants.findConstantDefinition("colour")->physicalIndex);
+    EXPECT_EQ(8u, constants.findConstantDefinition("lights[1]")->physicalIndex);
+    EXPECT_FALSE(constants.findConstantDefinition("missing"));
+
+    GpuConstantHandle lights = GpuNamedConstants::getConstantHandle("lights[2]");
+    EXPECT_EQ(lights, GpuNamedConstants::getConstantHandle("lights[2]"));
+    EXPECT_EQ("lights[2]", GpuNamedConstants::getConstantName(lights));
+    EXPECT_EQ(constants.findConstantDefinition("lights[2]"), constants.findConstantDefinition(lights));
+    EXPECT_FALSE(constants.findConstantDefinition(GpuNamedConstants::getConstantHandle("missing")));
+
+    // Entries added later are found too
+    addConstant(constants, "added");
+    EXPECT_TRUE(constants.findConstantDefinition("added"));
+
+    // Replaced entries are found, rather than the ones they replace
+    GpuConstantDefinition replaced = constants.map["added"];
+    constants.map.erase("added");
+    EXPECT_FALSE(constants.findConstantDefinition("added"));
+    EXPECT_FALSE(constants.findConstantDefinition(GpuNamedConstants::getConstantHandle("added")));
+    replaced.physicalIndex = 100;
+    constants.map.insert(GpuConstantDefinitionMap::value_type("added", replaced));
+    ASSERT_TRUE(constants.findConstantDefinition("added"));
+    EXPECT_EQ(&constants.map["added"], constants.findConstantDefinition("added"));
+    EXPECT_EQ(100u, constants.findConstantDefinition(GpuNamedConstants::getConstantHandle("added"))->physicalIndex);
+
+    // Copies have their own index
+    GpuNamedConstants copy(constants);
+    constants.map.clear();
+    EXPECT_FALSE(constants.findConstantDefinition("colour"));
+    ASSERT_TRUE(copy.findConstantDefinition("colour"));
+    EXPECT_EQ(&copy.map["colour"], copy.findConstantDefinition("colour"));
+    EXPECT_EQ(&copy.map["lights[2]"], copy.findConstantDefinition(lights));
+}
+//--------------------------------------------------------------------------
+TEST(GpuProgramParamsTests, SetNamedConstantByHandle)
+{
+    GpuNamedConstantsPtr constants(OGRE_NEW GpuNamedConstants());
+    addConstant(*constants, "colour");
+    addConstant(*constants, "position");
+    GpuProgramParameters params;
+    params._setNamedConstants(constants);
+
+    params.setNamedConstant("colour", Vector4(1, 2, 3, 4));
+    params.setNamedConstant(GpuNamedConstants::getConstantHandle("position"), Vector4(5, 6, 7, 8));
+    const float* values = params.getFloatPointer(0);
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(float(i + 1), values[i]);
+
+    // Missing names throw unless they're ignored, whichever way they're set
+    GpuConstantHandle missing = GpuNamedConstants::getConstantHandle("missing");
+    EXPECT_THROW(params.setNamedConstant("missing", Vector4::ZERO), Exception);
+    EXPECT_THROW(params.setNamedConstant(missing, Vector4::ZERO), Exception);
+    params.setIgnoreMissingParams(true);
+    params.setNamedConstant("missing", Vector4::ZERO);
+    params.setNamedConstant(missing, Vector4::ZERO);
+    EXPECT_FALSE(params._findNamedConstantDefinition(missing));
+}
+//--------------------------------------------------------------------------
+TEST_F(GpuProgramAutoParamsTests, SkipUnchangedInputs)
+{
+    GpuNamedConstantsPtr constants(OGRE_NEW GpuNamedConstants());
+    addConstant(*constants, "world", 1, GCT_MATRIX_4X4);
+    addConstant(*constants, "view", 1, GCT_MATRIX_4X4);
+    addConstant(*constants, "fogColour");
+    GpuProgramParameters params;
+    params._setNamedConstants(constants);
+    params.setNamedAutoConstant("world", GpuProgramParameters::ACT_WORLD_MATRIX);
+    params.setNamedAutoConstant("view", GpuProgramParameters::ACT_VIEW_MATRIX);
+    params.setNamedAutoConstant("fogColour", GpuProgramParameters::ACT_FOG_COLOUR);
+    float* world = params.getFloatPointer(0);
+    float* view = params.getFloatPointer(16);
+    float* fogColour = params.getFloatPointer(32);
+
+    Camera camera("Camera", 0);
+    camera.setPosition(10, 20, 30);
+    Matrix4 worlds[2] = { Matrix4::getTrans(1, 2, 3), Matrix4::getTrans(4, 5, 6) };
+    AutoParamDataSource source;
+    source.setCurrentCamera(&camera, false);
+    source.setFog(FOG_LINEAR, ColourValue::Red, 0, 10, 100);
+    source.setCurrentRenderable(0);
+    source.setWorldMatrices(&worlds[0], 1);
+    params._updateAutoParams(&source, GPV_ALL);
+    EXPECT_EQ(worlds[0][0][3], world[3]);
+    EXPECT_EQ(camera.getViewMatrix()[2][3], view[11]);
+    EXPECT_EQ(1.0f, fogColour[0]);
+
+    // Values changed behind its back show which autos were computed again
+    view[11] = 0;
+    fogColour[0] = 0;
+    source.setCurrentRenderable(0);
+    source.setWorldMatrices(&worlds[1], 1);
+    source.setFog(FOG_LINEAR, ColourValue::Red, 0, 10, 100);
+    params._updateAutoParams(&source, GPV_ALL);
+    EXPECT_EQ(worlds[1][0][3], world[3]);
+    EXPECT_EQ(0, view[11]);
+    EXPECT_EQ(0, fogColour[0]);
+
+    source.setFog(FOG_LINEAR, ColourValue::Green, 0, 10, 100);
+    params._updateAutoParams(&source, GPV_ALL);
+    EXPECT_EQ(0, view[11]);
+    EXPECT_EQ(1.0f, fogColour[1]);
+
+    // A new frame, or another source, updates everything
+    source.setCurrentCamera(&camera, false);
+    params._updateAutoParams(&source, GPV_ALL);
+    EXPECT_EQ(camera.getViewMatrix()[2][3], view[11]);
+
+    view[11] = 0;
+    AutoParamDataSource other;
+    other.setCurrentCamera(&camera, false);
+    other.setCurrentRenderable(0);
+    other.setWorldMatrices(&worlds[1], 1);
+    params._updateAutoParams(&other, GPV_ALL);
+    EXPECT_EQ(camera.getViewMatrix()[2][3], view[11]);
+}
@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include "OgreLZ4.h"
+#include "TestData.h"
+
+using namespace Ogre;
+
+namespace {
+    /// Text like runs with some random parts, so there are literals and matches of all lengths
+    std::vector<uchar> makeData(size_t size)
+    {
+        std::vector<uchar> data(size);
+        TestRandom random(5678);
+        for (size_t i = 0; i < size; ++i)
+        {
+            uint32 bits = random.next();
+            if ((i / 1000) % 3 == 2 || i % 97 == 0)
+                data[i] = uchar(bits >> 24);
+            else
+                data[i] = uchar("abcdefgh"[(i / 10) % 8]);
+        }
+        return data;
+    }
+
+    std::vector<uchar> compress(const std::vector<uchar>& data)
+    {
+        std::vector<uchar> block(LZ4::compressBound(data.size()));
+        block.resize(LZ4::compress(&data[0], data.size(), &block[0]));
+        return block;
+    }
+
+    /** Decompresses into a buffer with guard bytes after it.
+    @return Whether it succeeded, the guard bytes are checked either way
+    */
+    bool decompress(const std::vector<uchar>& block, std::vector<uchar>& data, size_t dstSize)
+    {
+        const size_t GUARD = 64;
+        data.assign(dstSize + GUARD, 0xCD);
+        bool ok = LZ4::decompress(block.empty() ? 0 : &block[0], block.size(), &data[0], dstSize);
+        for (size_t i = dstSize; i < data.size(); ++i)
+            EXPECT_EQ(0xCD, data[i]) << "wrote past the end";
+        data.resize(dstSize);
+        return ok;
+    }
+}
+//--------------------------------------------------------------------------
+TEST(LZ4Tests,RoundTrip)
+{
+    const size_t sizes[] = { 1, 12, 13, 100, 4096, 65536, 300000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        std::vector<uchar> data = makeData(sizes[i]);
+        std::vector<uchar> block = compress(data);
+        if (sizes[i] > 1000)
+            EXPECT_LT(block.size(), data.size());
+
+        std::vector<uchar> result;
+        ASSERT_TRUE(decompress(block, result, data.size())) << sizes[i] << " bytes";
+        EXPECT_TRUE(result == data) << sizes[i] << " bytes";
+
+        // The size has to be exact
+        EXPECT_FALSE(decompress(block, result, data.size() - 1));
+        EXPECT_FALSE(decompress(block, result, data.size() + 1));
+    }
+}
+//--------------------------------------------------------------------------
+TEST(LZ4Tests,Truncated)
+{
+    std::vector<uchar> data = makeData(4096);
+    std::vector<uchar> block = compress(data);
+    std::vector<uchar> result;
+    // Blocks end with literals, so no shorter block decodes to all the data
+    for (size_t size = 0; size < block.size(); ++size)
+    {
+        std::vector<uchar> truncated(block.begin(), block.begin() + size);
+        EXPECT_FALSE(decompress(truncated, result, data.size())) << size << " bytes";
+    }
+}
+//--------------------------------------------------------------------------
+TEST(LZ4Tests,Corrupted)
+{
+    std::vector<uchar> data = makeData(4096);
+    std::vector<uchar> block = compress(data);
+    std::vector<uchar> result;
+    // Whether it fails depends on what was hit, but it stays in bounds
+    TestRandom random(8765);
+    for (size_t i = 0; i < block.size(); ++i)
+    {
+        std::vector<uchar> corrupted = block;
+        corrupted[i] ^= uchar(random.next() >> 24 | 1);
+        decompress(corrupted, result, data.size());
+        corrupted[i] = 0xFF;
+        decompress(corrupted, result, data.size());
+    }
+}
+//--------------------------------------------------------------------------
+TEST(LZ4Tests,Malformed)
+{
+    std::vector<uchar> result;
+    // 4 literals then a match
+    const uchar valid[] = { 0x40, 'a', 'b', 'c', 'd', 0x04, 0x00, 0x10, 'e' };
+    std::vector<uchar> block(valid, valid + sizeof(valid));
+    ASSERT_TRUE(decompress(block, result, 9));
+    EXPECT_EQ(String("abcdabcde"), String(result.begin(), result.end()));
+
+    // Matches before the start of the output, or at offset 0
+    block[5] = 0x05;
+    EXPECT_FALSE(decompress(block, result, 9));
+    block[5] = 0x00;
+    EXPECT_FALSE(decompress(block, result, 9));
+
+    // Lengths longer than the rest of the output, or running off the input
+    const uchar longLiterals[] = { 0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0x10, 'a' };
+    EXPECT_FALSE(decompress(std::vector<uchar>(longLiterals, longLiterals + sizeof(longLiterals)), result, 100));
+    const uchar longMatch[] = { 0x1F, 'a', 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0x00 };
+    EXPECT_FALSE(decompress(std::vector<uchar>(longMatch, longMatch + sizeof(longMatch)), result, 100));
+    const uchar unfinished[] = { 0xF0, 0xFF, 0xFF };
+    EXPECT_FALSE(decompress(std::vector<uchar>(unfinished, unfinished + sizeof(unfinished)), result, 1000));
+    const uchar noOffset[] = { 0x10, 'a', 0x01 };
+    EXPECT_FALSE(decompress(std::vector<uchar>(noOffset, noOffset + sizeof(noOffset)), result, 10));
+}
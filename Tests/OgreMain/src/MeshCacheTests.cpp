@@ -0,0 +1,263 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreMeshSerializer.h>
+#include <OgreFileSystem.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+#include <fstream>
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#   include <sys/utime.h>
+#   define utime _utime
+#   define utimbuf _utimbuf
+#else
+#   include <utime.h>
+#endif
+
+using namespace Ogre;
+
+namespace {
+    const char* SOURCE_DIR = "MeshCacheTests";
+    const char* CACHE_DIR = "MeshCacheTests/cache";
+    const char* GROUP = "MeshCacheTests";
+    const char* MESH_NAME = "knot.mesh";
+
+    /// Lists the files in a directory
+    StringVectorPtr listFiles(const String& dir)
+    {
+        FileSystemArchive arch(dir, "FileSystem", true);
+        arch.load();
+        return arch.list(false);
+    }
+
+    const VertexData* getVertexData(const MeshPtr& mesh)
+    {
+        SubMesh* sm = mesh->getSubMesh(0);
+        return sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+    }
+
+    size_t getVertexCount(const MeshPtr& mesh)
+    {
+        return getVertexData(mesh)->vertexCount;
+    }
+
+    String getContents(HardwareBuffer* buf)
+    {
+        String contents(static_cast<const char*>(buf->lock(HardwareBuffer::HBL_READ_ONLY)), buf->getSizeInBytes());
+        buf->unlock();
+        return contents;
+    }
+
+    /// The bytes of the vertex and index buffers of the first submesh
+    String getBufferContents(const MeshPtr& mesh)
+    {
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            getVertexData(mesh)->vertexBufferBinding->getBindings();
+        String contents;
+        VertexBufferBinding::VertexBufferBindingMap::const_iterator i;
+        for (i = bindings.begin(); i != bindings.end(); ++i)
+            contents += getContents(i->second.get());
+        return contents + getContents(mesh->getSubMesh(0)->indexData->indexBuffer.get());
+    }
+
+    /// The number of vertices in the position buffer of the first submesh
+    size_t getPositionBufferSize(const MeshPtr& mesh)
+    {
+        const VertexData* vertexData = getVertexData(mesh);
+        const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        return vertexData->vertexBufferBinding->getBuffer(posElem->getSource())->getNumVertices();
+    }
+
+    /// Sets the modification time of a file
+    void setFileTime(const String& path, time_t t)
+    {
+        utimbuf times;
+        times.actime = t;
+        times.modtime = t;
+        utime(path.c_str(), &times);
+    }
+
+    void removeDirectory(const String& dir)
+    {
+        StringVectorPtr files = listFiles(dir);
+        for (size_t i = 0; i < files->size(); ++i)
+            FileSystemLayer::removeFile(dir + "/" + files->at(i));
+        FileSystemLayer::removeDirectory(dir);
+    }
+}
+
+class MeshCacheTests : public RootWithoutRenderSystemFixture
+{
+public:
+    AxisAlignedBox mOriginalBounds;
+
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        // A source file of our own, so it can be changed
+        FileSystemLayer::createDirectory(SOURCE_DIR);
+        MeshPtr mesh = MeshManager::getSingleton().load(MESH_NAME, "General");
+        mOriginalBounds = mesh->getBounds();
+        MeshSerializer().exportMesh(mesh.get(), String(SOURCE_DIR) + "/" + MESH_NAME);
+        MeshManager::getSingleton().remove(mesh);
+
+        ResourceGroupManager::getSingleton().addResourceLocation(SOURCE_DIR, "FileSystem", GROUP);
+        MeshManager::getSingleton().setMeshCacheDirectory(CACHE_DIR);
+    }
+
+    void TearDown()
+    {
+        // The buffers have to go before the buffer manager does
+        MeshManager::getSingleton().removeAll();
+        RootWithoutRenderSystemFixture::TearDown();
+        removeDirectory(CACHE_DIR);
+        removeDirectory(SOURCE_DIR);
+    }
+
+    /// Loads the mesh fresh
+    MeshPtr reload(MeshPtr& mesh)
+    {
+        if (mesh)
+            MeshManager::getSingleton().remove(mesh);
+        mesh = MeshManager::getSingleton().load(MESH_NAME, GROUP);
+        return mesh;
+    }
+
+    /// Makes the cache entry of the mesh recognisable
+    void markCacheEntry(const MeshPtr& mesh)
+    {
+        mesh->_setBounds(AxisAlignedBox(-1000, -1000, -1000, 1000, 1000, 1000), false);
+        MeshManager::getSingleton().updateMeshCache(mesh);
+    }
+};
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, WritesEntry)
+{
+    EXPECT_EQ(0U, listFiles(CACHE_DIR)->size());
+
+    MeshPtr mesh;
+    reload(mesh);
+
+    StringVectorPtr files = listFiles(CACHE_DIR);
+    ASSERT_EQ(1U, files->size());
+    EXPECT_TRUE(StringUtil::endsWith(files->at(0), ".meshcache"));
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, UsesEntry)
+{
+    MeshPtr mesh;
+    reload(mesh);
+    size_t vertexCount = getVertexCount(mesh);
+    size_t vertexSize = getVertexData(mesh)->vertexDeclaration->getVertexSize(0);
+    size_t indexCount = mesh->getSubMesh(0)->indexData->indexCount;
+    String contents = getBufferContents(mesh);
+    ASSERT_TRUE(mesh->isEdgeListBuilt());
+    size_t numTriangles = mesh->getEdgeList()->triangles.size();
+    markCacheEntry(mesh);
+
+    reload(mesh);
+    EXPECT_EQ(Vector3(1000, 1000, 1000), mesh->getBounds().getMaximum());
+    EXPECT_EQ(vertexCount, getVertexCount(mesh));
+    EXPECT_EQ(vertexSize, getVertexData(mesh)->vertexDeclaration->getVertexSize(0));
+    EXPECT_EQ(indexCount, mesh->getSubMesh(0)->indexData->indexCount);
+    EXPECT_TRUE(contents == getBufferContents(mesh));
+    ASSERT_TRUE(mesh->isEdgeListBuilt());
+    EXPECT_EQ(numTriangles, mesh->getEdgeList()->triangles.size());
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, StoresGeometryUnprepared)
+{
+    MeshManager::getSingleton().setPrepareAllMeshesForShadowVolumes(true);
+    MeshPtr mesh;
+    reload(mesh);
+    ASSERT_TRUE(mesh->isPreparedForShadowVolumes());
+    size_t positionBufferSize = getPositionBufferSize(mesh);
+    EXPECT_EQ(2 * getVertexCount(mesh), positionBufferSize);
+    markCacheEntry(mesh);
+
+    // Prepared once again, rather than twice
+    reload(mesh);
+    EXPECT_EQ(Vector3(1000, 1000, 1000), mesh->getBounds().getMaximum());
+    EXPECT_TRUE(mesh->isPreparedForShadowVolumes());
+    EXPECT_EQ(positionBufferSize, getPositionBufferSize(mesh));
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, ReplacesStaleEntry)
+{
+    MeshPtr mesh;
+    reload(mesh);
+    markCacheEntry(mesh);
+
+    // Same mesh, different bytes
+    mesh->_setBounds(mOriginalBounds, false);
+    MeshSerializer().exportMesh(mesh.get(), String(SOURCE_DIR) + "/" + MESH_NAME,
+                                Serializer::ENDIAN_BIG);
+    reload(mesh);
+    EXPECT_EQ(mOriginalBounds, mesh->getBounds());
+
+    // The replacement is used from now on
+    markCacheEntry(mesh);
+    reload(mesh);
+    EXPECT_EQ(Vector3(1000, 1000, 1000), mesh->getBounds().getMaximum());
+    EXPECT_EQ(1U, listFiles(CACHE_DIR)->size());
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, IgnoresInvalidEntry)
+{
+    MeshPtr mesh;
+    reload(mesh);
+    markCacheEntry(mesh);
+
+    StringVectorPtr files = listFiles(CACHE_DIR);
+    ASSERT_EQ(1U, files->size());
+    std::ofstream file((String(CACHE_DIR) + "/" + files->at(0)).c_str(), std::ios::binary);
+    file << "not a mesh";
+    file.close();
+
+    reload(mesh);
+    EXPECT_EQ(mOriginalBounds, mesh->getBounds());
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshCacheTests, SkipsSourceWhileTimeMatches)
+{
+    // Old enough for its time to be recorded
+    String sourcePath = String(SOURCE_DIR) + "/" + MESH_NAME;
+    time_t sourceTime = time(0) - 3600;
+    setFileTime(sourcePath, sourceTime);
+    MeshPtr mesh;
+    reload(mesh);
+
+    // Not read at all, or loading would fail
+    std::ofstream file(sourcePath.c_str(), std::ios::binary);
+    file << "not a mesh";
+    file.close();
+    setFileTime(sourcePath, sourceTime);
+    reload(mesh);
+    EXPECT_EQ(mOriginalBounds, mesh->getBounds());
+}
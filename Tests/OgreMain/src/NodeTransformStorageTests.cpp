@@ -0,0 +1,104 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreNodeTransformStorage.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include "TestData.h"
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture NodeTransformStorageTests;
+
+namespace {
+    void expectSameTransforms(const std::vector<SceneNode*>& expected, const std::vector<SceneNode*>& actual)
+    {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_TRUE(expected[i]->_getDerivedPosition().positionEquals(actual[i]->_getDerivedPosition(), 1e-3f));
+            EXPECT_TRUE(expected[i]->_getDerivedScale().positionEquals(actual[i]->_getDerivedScale(), 1e-4f));
+            EXPECT_NEAR(1.0f, expected[i]->_getDerivedOrientation().Dot(actual[i]->_getDerivedOrientation()), 1e-4f);
+        }
+    }
+}
+
+TEST_F(NodeTransformStorageTests, MatchesNodeTransforms)
+{
+    SceneManager* classicMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* soaMgr = mRoot->createSceneManager(ST_GENERIC);
+    soaMgr->setNodeTransformStorageEnabled(true);
+
+    std::vector<SceneNode*> classicNodes, soaNodes;
+    createNodeHierarchy(classicMgr, classicNodes, 1000);
+    createNodeHierarchy(soaMgr, soaNodes, 1000);
+
+    classicMgr->_updateSceneGraph(0);
+    soaMgr->_updateSceneGraph(0);
+    expectSameTransforms(classicNodes, soaNodes);
+
+    NodeTransformStorage* storage = soaMgr->_getNodeTransformStorage();
+    ASSERT_TRUE(storage != 0);
+    EXPECT_FALSE(storage->isHierarchyDirty());
+    EXPECT_FALSE(storage->isDerivedValid());
+    EXPECT_EQ(storage, soaNodes.back()->_getTransformStorage());
+
+    // Move some nodes, change the hierarchy and destroy a subtree
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        classicNodes[frame * 3 + 1]->roll(Degree(5));
+        soaNodes[frame * 3 + 1]->roll(Degree(5));
+        classicNodes[frame * 17 + 50]->setPosition(1, 2, 3);
+        soaNodes[frame * 17 + 50]->setPosition(1, 2, 3);
+
+        classicMgr->_updateSceneGraph(0);
+        soaMgr->_updateSceneGraph(0);
+        expectSameTransforms(classicNodes, soaNodes);
+    }
+
+    classicNodes[500]->getParentSceneNode()->removeChild(classicNodes[500]);
+    classicNodes[2]->addChild(classicNodes[500]);
+    soaNodes[500]->getParentSceneNode()->removeChild(soaNodes[500]);
+    soaNodes[2]->addChild(soaNodes[500]);
+    classicMgr->destroySceneNode(classicNodes[900]);
+    classicNodes.erase(classicNodes.begin() + 900);
+    soaMgr->destroySceneNode(soaNodes[900]);
+    soaNodes.erase(soaNodes.begin() + 900);
+    EXPECT_TRUE(storage->isHierarchyDirty());
+
+    classicMgr->_updateSceneGraph(0);
+    soaMgr->_updateSceneGraph(0);
+    expectSameTransforms(classicNodes, soaNodes);
+    EXPECT_FALSE(storage->isHierarchyDirty());
+
+    soaMgr->setNodeTransformStorageEnabled(false);
+    EXPECT_TRUE(soaNodes.back()->_getTransformStorage() == 0);
+
+    mRoot->destroySceneManager(soaMgr);
+    mRoot->destroySceneManager(classicMgr);
+}
@@ -0,0 +1,225 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreOptimisedUtil.h>
+#include <gtest/gtest.h>
+#include "TestData.h"
+
+namespace Ogre {
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+#if __OGRE_HAVE_SSE
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+#endif
+#if __OGRE_HAVE_AVX2
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void);
+#endif
+}
+
+using namespace Ogre;
+
+namespace {
+    struct Implementation
+    {
+        const char* name;
+        OptimisedUtil* impl;
+    };
+
+    /// The implementations the CPU supports, the general one first
+    std::vector<Implementation> getImplementations(void)
+    {
+        std::vector<Implementation> impls;
+        Implementation general = { "General", _getOptimisedUtilGeneral() };
+        impls.push_back(general);
+#if __OGRE_HAVE_SSE
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+        {
+            Implementation sse = { "SSE", _getOptimisedUtilSSE() };
+            impls.push_back(sse);
+        }
+#endif
+#if __OGRE_HAVE_AVX2
+        if ((PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX2) &&
+            (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_FMA))
+        {
+            Implementation avx2 = { "AVX2", _getOptimisedUtilAVX2() };
+            impls.push_back(avx2);
+        }
+#endif
+        return impls;
+    }
+
+    void expectNear(const std::vector<float>& expected, const std::vector<float>& actual,
+                    float tolerance, const char* name)
+    {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(expected[i], actual[i], tolerance * std::max(1.0f, Math::Abs(expected[i])))
+                << name << ", element " << i;
+        }
+    }
+}
+
+TEST(OptimisedUtilTests, SoftwareVertexSkinning)
+{
+    std::vector<Implementation> impls = getImplementations();
+    // Not a multiple of 8, so the tails are exercised too
+    for (size_t numWeights = 1; numWeights <= 4; ++numWeights)
+    {
+        SkinnedMesh data(1003, numWeights);
+        for (int normals = 0; normals < 2; ++normals)
+        {
+            std::vector<float> expected(data.vertices.size()), actual(data.vertices.size());
+            data.skin(impls[0].impl, expected, normals != 0);
+            if (normals)
+                EXPECT_EQ("", data.verify(expected));
+            for (size_t i = 1; i < impls.size(); ++i)
+            {
+                data.skin(impls[i].impl, actual, normals != 0);
+                expectNear(expected, actual, 1e-3f, impls[i].name);
+            }
+        }
+    }
+}
+
+TEST(OptimisedUtilTests, SoftwareVertexMorph)
+{
+    std::vector<Implementation> impls = getImplementations();
+    SkinnedMesh data(1003, 1);
+    std::vector<float> target(data.vertices.rbegin(), data.vertices.rend());
+
+    for (int normals = 0; normals < 2; ++normals)
+    {
+        // Positions only are packed, the normals are left out
+        std::vector<float> src1, src2;
+        for (size_t i = 0; i < data.vertices.size(); ++i)
+        {
+            if (normals || i % 6 < 3)
+            {
+                src1.push_back(data.vertices[i]);
+                src2.push_back(target[i]);
+            }
+        }
+        size_t vsize = (normals ? 6 : 3) * sizeof(float);
+
+        std::vector<float> expected(src1.size()), actual(src1.size());
+        impls[0].impl->softwareVertexMorph(0.3f, &src1[0], &src2[0], &expected[0],
+            vsize, vsize, vsize, data.numVertices, normals != 0);
+        for (size_t i = 1; i < impls.size(); ++i)
+        {
+            impls[i].impl->softwareVertexMorph(0.3f, &src1[0], &src2[0], &actual[0],
+                vsize, vsize, vsize, data.numVertices, normals != 0);
+            expectNear(expected, actual, 1e-4f, impls[i].name);
+        }
+    }
+}
+
+TEST(OptimisedUtilTests, ConcatenateAffineMatrices)
+{
+    std::vector<Implementation> impls = getImplementations();
+    SkinnedMesh data(1, 1);
+    const Matrix4& base = data.matrices[0];
+    std::vector<Matrix4> expected(data.matrices.size()), actual(data.matrices.size());
+
+    impls[0].impl->concatenateAffineMatrices(base, &data.matrices[0], &expected[0], expected.size());
+    for (size_t i = 1; i < impls.size(); ++i)
+    {
+        impls[i].impl->concatenateAffineMatrices(base, &data.matrices[0], &actual[0], actual.size());
+        for (size_t j = 0; j < expected.size(); ++j)
+        {
+            for (int k = 0; k < 16; ++k)
+                EXPECT_NEAR(expected[j][k / 4][k % 4], actual[j][k / 4][k % 4], 1e-4f)
+                    << impls[i].name << ", matrix " << j;
+        }
+    }
+}
+
+TEST(OptimisedUtilTests, FaceNormalsAndLightFacing)
+{
+    std::vector<Implementation> impls = getImplementations();
+    const size_t numVertices = 500, numTriangles = 1003;
+    std::vector<float> positions;
+    createPositions(positions, numVertices);
+    std::vector<EdgeData::Triangle> triangles;
+    createTriangles(triangles, numTriangles, numVertices);
+
+    std::vector<Vector4> expected(numTriangles), actual(numTriangles);
+    impls[0].impl->calculateFaceNormals(&positions[0], &triangles[0], &expected[0], numTriangles);
+    for (size_t i = 1; i < impls.size(); ++i)
+    {
+        impls[i].impl->calculateFaceNormals(&positions[0], &triangles[0], &actual[0], numTriangles);
+        for (size_t j = 0; j < numTriangles; ++j)
+        {
+            // w cancels out terms of the magnitude of the normal times the positions
+            float tolerance = 1e-5f * (Vector3(expected[j].ptr()).length() + 1) * 100;
+            for (int k = 0; k < 4; ++k)
+                ASSERT_NEAR(expected[j][k], actual[j][k], tolerance) << impls[i].name << ", triangle " << j;
+        }
+    }
+
+    const Vector4 lightPos(30, -20, 10, 1);
+    std::vector<char> expectedFacing(numTriangles), actualFacing(numTriangles);
+    impls[0].impl->calculateLightFacing(lightPos, &expected[0], &expectedFacing[0], numTriangles);
+    EXPECT_NE(0, std::count(expectedFacing.begin(), expectedFacing.end(), 1));
+    EXPECT_NE(0, std::count(expectedFacing.begin(), expectedFacing.end(), 0));
+    for (size_t i = 1; i < impls.size(); ++i)
+    {
+        impls[i].impl->calculateLightFacing(lightPos, &expected[0], &actualFacing[0], numTriangles);
+        for (size_t j = 0; j < numTriangles; ++j)
+        {
+            // Rounding may tip faces seen edge-on either way
+            if (Math::Abs(lightPos.dotProduct(expected[j])) > 1e-2f * Vector3(expected[j].ptr()).length())
+            {
+                ASSERT_EQ(expectedFacing[j], actualFacing[j]) << impls[i].name << ", face " << j;
+            }
+        }
+    }
+}
+
+TEST(OptimisedUtilTests, ExtrudeVertices)
+{
+    std::vector<Implementation> impls = getImplementations();
+    const size_t numVertices = 1003;
+    std::vector<float> positions;
+    createPositions(positions, numVertices);
+
+    const Vector4 lights[] = { Vector4(1, -2, 3, 0), Vector4(30, -20, 10, 1) };
+    for (int l = 0; l < 2; ++l)
+    {
+        std::vector<float> expected(positions.size()), actual(positions.size());
+        impls[0].impl->extrudeVertices(lights[l], 1000, &positions[0], &expected[0], numVertices);
+        for (size_t i = 1; i < impls.size(); ++i)
+        {
+            impls[i].impl->extrudeVertices(lights[l], 1000, &positions[0], &actual[0], numVertices);
+            // The point light uses reciprocal square root estimates
+            for (size_t j = 0; j < expected.size(); ++j)
+                ASSERT_NEAR(expected[j], actual[j], 1.0f) << impls[i].name << ", element " << j;
+        }
+    }
+}
@@ -0,0 +1,341 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include "OgrePackArchive.h"
+#include "OgreFileSystem.h"
+#include "OgreException.h"
+#include "OgreConfigFile.h"
+#include "OgreFileSystemLayer.h"
+#include "TestData.h"
+
+using namespace Ogre;
+
+namespace {
+    const char* PACK_NAME = "PackArchiveTests.pack";
+    /// Where the header of a pack keeps its chunk size
+    const size_t HEADER_CHUNK_SIZE_OFFSET = 8;
+
+    String fileId(const String& path)
+    {
+#if !OGRE_RESOURCEMANAGER_STRICT
+        String file;
+        String base;
+        StringUtil::splitFilename(path, file, base);
+        return file;
+#endif
+        return path;
+    }
+
+    /// Data which compresses well, with some random parts which don't
+    std::vector<uchar> makeData(size_t size)
+    {
+        std::vector<uchar> data(size);
+        TestRandom random(1234);
+        for (size_t i = 0; i < size; ++i)
+        {
+            uint32 bits = random.next();
+            data[i] = (i / 10000) % 2 ? uchar(bits >> 24) : uchar("abcdefgh"[(i / 100) % 8]);
+        }
+        return data;
+    }
+}
+
+class PackArchiveTests : public ::testing::Test
+{
+protected:
+    FileSystemArchive* mOutput;
+    PackArchive* mArch;
+    std::vector<uchar> mBigData;
+
+public:
+    void SetUp()
+    {
+        ConfigFile cf;
+        cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+        FileSystemArchive source(cf.getSettings("Tests").begin()->second + "/misc/ArchiveTest",
+                                 "FileSystem", true);
+        source.load();
+
+        mOutput = OGRE_NEW FileSystemArchive(".", "FileSystem", false);
+        mOutput->load();
+        {
+            // Small chunks, so the text files are split into several
+            PackArchiveWriter writer(mOutput->create(PACK_NAME), 64);
+            writer.addArchive(&source);
+
+            mBigData = makeData(100000);
+            DataStreamPtr big(OGRE_NEW MemoryDataStream(&mBigData[0], mBigData.size()));
+            writer.addFile("data/big.bin", big);
+            writer.finish();
+        }
+
+        mArch = OGRE_NEW PackArchive(PACK_NAME, "Pack");
+        mArch->load();
+    }
+
+    void TearDown()
+    {
+        OGRE_DELETE mArch;
+        mOutput->remove(PACK_NAME);
+        OGRE_DELETE mOutput;
+    }
+
+    std::vector<uchar> readPack()
+    {
+        DataStreamPtr stream = mOutput->open(PACK_NAME);
+        std::vector<uchar> data(stream->size());
+        stream->read(&data[0], data.size());
+        return data;
+    }
+
+    /// The trailer of a pack starts with the offset of its index
+    static size_t getIndexOffset(const std::vector<uchar>& data)
+    {
+        size_t offset = 0;
+        for (int i = 0; i < 8; ++i)
+            offset |= size_t(data[data.size() - 16 + i]) << (i * 8);
+        return offset;
+    }
+
+    /// Writes a damaged copy of the pack and tries loading it
+    bool loads(const std::vector<uchar>& data)
+    {
+        const String name = "PackArchiveTests.damaged.pack";
+        {
+            DataStreamPtr stream = mOutput->create(name);
+            if (!data.empty())
+                stream->write(&data[0], data.size());
+        }
+        PackArchive arch(name, "Pack");
+        bool loaded = true;
+        try
+        {
+            arch.load();
+        }
+        catch (Exception&)
+        {
+            loaded = false;
+        }
+        arch.unload();
+        mOutput->remove(name);
+        return loaded;
+    }
+};
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,ListNonRecursive)
+{
+    StringVectorPtr vec = mArch->list(false);
+    std::sort(vec->begin(), vec->end());
+
+    EXPECT_EQ((size_t)2, vec->size());
+    EXPECT_EQ(String("rootfile.txt"), vec->at(0));
+    EXPECT_EQ(String("rootfile2.txt"), vec->at(1));
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,ListRecursive)
+{
+    StringVectorPtr vec = mArch->list(true);
+    std::sort(vec->begin(), vec->end());
+
+    EXPECT_EQ((size_t)7, vec->size());
+    EXPECT_TRUE(std::count(vec->begin(), vec->end(), fileId("level1/materials/scripts/file.material")));
+    EXPECT_TRUE(std::count(vec->begin(), vec->end(), fileId("level2/materials/scripts/file4.material")));
+    EXPECT_TRUE(std::count(vec->begin(), vec->end(), fileId("data/big.bin")));
+    EXPECT_TRUE(std::count(vec->begin(), vec->end(), String("rootfile2.txt")));
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,ListDirectories)
+{
+    StringVectorPtr vec = mArch->list(true, true);
+    std::sort(vec->begin(), vec->end());
+
+    ASSERT_EQ((size_t)7, vec->size());
+    EXPECT_EQ(String("data"), vec->at(0));
+    EXPECT_EQ(String("level1"), vec->at(1));
+    EXPECT_EQ(String("level1/materials"), vec->at(2));
+    EXPECT_EQ(String("level1/materials/scripts"), vec->at(3));
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,FindFileInfo)
+{
+    FileInfoListPtr vec = mArch->findFileInfo("rootfile*.txt", false);
+
+    ASSERT_EQ((size_t)2, vec->size());
+    const FileInfo& fi = vec->at(0).basename == "rootfile.txt" ? vec->at(0) : vec->at(1);
+    EXPECT_EQ(String("rootfile.txt"), fi.filename);
+    EXPECT_EQ(BLANKSTRING, fi.path);
+    EXPECT_EQ((size_t)125, fi.uncompressedSize);
+    EXPECT_EQ(mArch, fi.archive);
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,FileRead)
+{
+    DataStreamPtr stream = mArch->open("rootfile.txt");
+    EXPECT_EQ((size_t)125, stream->size());
+    EXPECT_EQ(String("this is line 1 in file 1"), stream->getLine());
+    EXPECT_EQ(String("this is line 2 in file 1"), stream->getLine());
+    EXPECT_EQ(String("this is line 3 in file 1"), stream->getLine());
+    EXPECT_EQ(String("this is line 4 in file 1"), stream->getLine());
+    EXPECT_EQ(String("this is line 5 in file 1"), stream->getLine());
+    EXPECT_TRUE(stream->eof());
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,FileSeek)
+{
+    DataStreamPtr stream = mArch->open("rootfile2.txt");
+    stream->seek(125);
+    EXPECT_EQ(String("this is line 6 in file 2"), stream->getLine());
+    EXPECT_TRUE(stream->eof());
+    stream->seek(25);
+    EXPECT_EQ(String("this is line 2 in file 2"), stream->getLine());
+    stream->skip(-50);
+    EXPECT_EQ(String("this is line 1 in file 2"), stream->getLine());
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,LargeFile)
+{
+    DataStreamPtr stream = mArch->open("data/big.bin");
+    ASSERT_EQ(mBigData.size(), stream->size());
+
+    // Whole chunks are decompressed into the buffer, partial ones copied
+    std::vector<uchar> data(mBigData.size());
+    EXPECT_EQ((size_t)10, stream->read(&data[0], 10));
+    EXPECT_EQ(data.size() - 10, stream->read(&data[10], data.size()));
+    EXPECT_TRUE(stream->eof());
+    EXPECT_TRUE(data == mBigData);
+
+    stream->seek(54321);
+    uchar b;
+    stream->read(&b, 1);
+    EXPECT_EQ(mBigData[54321], b);
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,Exists)
+{
+    EXPECT_TRUE(mArch->exists("rootfile.txt"));
+    EXPECT_TRUE(mArch->exists("level2/materials/scripts/file3.material"));
+    EXPECT_FALSE(mArch->exists("missing.txt"));
+    EXPECT_THROW(mArch->open("missing.txt"), FileNotFoundException);
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,NotAPack)
+{
+    DataStreamPtr stream = mOutput->create("PackArchiveTests.txt");
+    stream->write("this is not a pack, although it is long enough to be one", 56);
+    stream->close();
+
+    PackArchive arch("PackArchiveTests.txt", "Pack");
+    EXPECT_THROW(arch.load(), InvalidParametersException);
+    mOutput->remove("PackArchiveTests.txt");
+}
+//--------------------------------------------------------------------------
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,Truncated)
+{
+    std::vector<uchar> data = readPack();
+    const size_t sizes[] = { 0, 16, 31, data.size() / 2, data.size() - 16, data.size() - 1 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        std::vector<uchar> truncated(data.begin(), data.begin() + sizes[i]);
+        EXPECT_FALSE(loads(truncated)) << sizes[i] << " bytes";
+    }
+    EXPECT_TRUE(loads(data));
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,CorruptedIndex)
+{
+    std::vector<uchar> data = readPack();
+    // The index starts with the file count, followed by the name, size,
+    // data offset and chunk sizes of each file
+    size_t index = getIndexOffset(data);
+    size_t entry = index + 4;
+    size_t nameLength = data[entry] | (data[entry + 1] << 8);
+    size_t fileSize = entry + 2 + nameLength;
+    size_t dataOffset = fileSize + 8;
+    size_t firstChunk = dataOffset + 8;
+
+    struct Damage
+    {
+        const char* what;
+        size_t offset;
+        size_t length;
+        uchar value;
+    };
+    const Damage damages[] = {
+        { "file count", index, 4, 0xFF },
+        { "name length", entry, 2, 0xFF },
+        { "file size", fileSize, 8, 0xFF },
+        { "data offset", dataOffset, 8, 0 },
+        { "data offset", dataOffset, 8, 0xFF },
+        { "empty chunk", firstChunk, 4, 0 },
+        { "oversized chunk", firstChunk, 4, 0x7F },
+        { "stored chunk size", firstChunk, 4, 0xFF },
+        { "chunk size", HEADER_CHUNK_SIZE_OFFSET, 4, 0 },
+        { "chunk size", HEADER_CHUNK_SIZE_OFFSET, 4, 0xFF },
+    };
+    for (size_t i = 0; i < sizeof(damages) / sizeof(damages[0]); ++i)
+    {
+        std::vector<uchar> damaged = data;
+        std::fill(damaged.begin() + damages[i].offset,
+                  damaged.begin() + damages[i].offset + damages[i].length, damages[i].value);
+        EXPECT_FALSE(loads(damaged)) << damages[i].what;
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(PackArchiveTests,CorruptedChunks)
+{
+    // The index is intact. Blocks aren't checksummed, so reading either fails
+    // or gives wrong data, but never reads or writes outside of the buffers
+    const String name = "PackArchiveTests.damaged.pack";
+    std::vector<uchar> data = readPack();
+    TestRandom random(4321);
+    for (size_t i = 16; i < getIndexOffset(data); i += 7)
+        data[i] = uchar(random.next() >> 24);
+    {
+        DataStreamPtr stream = mOutput->create(name);
+        stream->write(&data[0], data.size());
+    }
+
+    PackArchive arch(name, "Pack");
+    arch.load();
+    StringVectorPtr files = arch.list(true);
+    for (size_t i = 0; i < files->size(); ++i)
+    {
+        try
+        {
+            DataStreamPtr stream = arch.open(files->at(i));
+            std::vector<uchar> contents(stream->size() + 1);
+            EXPECT_LE(stream->read(&contents[0], contents.size()), stream->size());
+        }
+        catch (Exception&)
+        {
+        }
+    }
+    arch.unload();
+    mOutput->remove(name);
+}
@@ -26,6 +26,7 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "PixelFormatTests.h"
+#include "OgreException.h"
 #include <cstdlib>
 #include <iomanip>
 
@@ -223,3 +224,73 @@ TEST_F(PixelFormatTests,BulkConversion)
 }
 //--------------------------------------------------------------------------
 
+TEST_F(PixelFormatTests,BulkConversionAllPairs)
+{
+    // An odd width and a row pitch, so the ends of the rows are covered
+    const size_t width = 37, height = 3, srcRowPitch = 40;
+    const uint8 guard = 0xCD;
+
+    for(int s = 1; s < PF_COUNT; s++)
+    {
+        PixelFormat srcFormat = (PixelFormat)s;
+        if(PixelUtil::isCompressed(srcFormat))
+            continue;
+
+        // Pack the colours, so float formats hold sensible values
+        size_t srcPixelSize = PixelUtil::getNumElemBytes(srcFormat);
+        std::vector<uint8> srcData(srcPixelSize * srcRowPitch * height);
+        srand(s);
+        float r, g, b, a;
+        try
+        {
+            for(size_t i = 0; i < srcRowPitch * height; i++)
+            {
+                PixelUtil::packColour(rand() * 1.2f / RAND_MAX - 0.1f, rand() * 1.2f / RAND_MAX - 0.1f,
+                                      rand() * 1.2f / RAND_MAX - 0.1f, rand() * 1.2f / RAND_MAX - 0.1f,
+                                      srcFormat, &srcData[i * srcPixelSize]);
+            }
+            PixelUtil::unpackColour(&r, &g, &b, &a, srcFormat, &srcData[0]);
+        }
+        catch(Exception&)
+        {
+            continue;
+        }
+        // Colour missing from the source unpacks to NaN
+        bool missingColour = r != r || g != g || b != b;
+
+        PixelBox src(Box(0, 0, width, height), srcFormat, &srcData[0]);
+        src.rowPitch = srcRowPitch;
+        src.slicePitch = srcRowPitch * height;
+
+        for(int d = 1; d < PF_COUNT; d++)
+        {
+            PixelFormat dstFormat = (PixelFormat)d;
+            // Conversion to the X8 formats fills in alpha, unlike packColour
+            if(dstFormat == srcFormat || PixelUtil::isCompressed(dstFormat) ||
+               dstFormat == PF_X8R8G8B8 || dstFormat == PF_X8B8G8R8)
+                continue;
+            if(missingColour && PixelUtil::isFloatingPoint(dstFormat))
+                continue;
+
+            size_t dstSize = PixelUtil::getNumElemBytes(dstFormat) * width * height;
+            std::vector<uint8> dstData(dstSize + 2, guard), dstRef(dstSize + 2, guard);
+            PixelBox dst(width, height, 1, dstFormat, &dstData[0]);
+            PixelBox ref(width, height, 1, dstFormat, &dstRef[0]);
+            try
+            {
+                naiveBulkPixelConversion(src, ref);
+            }
+            catch(Exception&)
+            {
+                continue;
+            }
+            PixelUtil::bulkPixelConversion(src, dst);
+
+            EXPECT_TRUE(dstData == dstRef) << "Conversion mismatch [" << PixelUtil::getFormatName(srcFormat) <<
+                "->" << PixelUtil::getFormatName(dstFormat) << "]";
+            EXPECT_EQ(dstData[dstSize], guard);
+            EXPECT_EQ(dstData[dstSize + 1], guard);
+        }
+    }
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,588 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <Threading/OgreTaskScheduler.h>
+#include <OgreFileSystem.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreScriptCompiler.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include <fstream>
+
+using namespace Ogre;
+
+class ResourceGroupManagerTests : public RootWithoutRenderSystemFixture
+{
+public:
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+        // Prepare on other threads even on single core machines
+        mRoot->getTaskScheduler()->setWorkerThreadCount(3);
+        mRoot->getTaskScheduler()->startup();
+    }
+
+    void TearDown()
+    {
+        // The loaded meshes own hardware buffers, free them before the
+        // fixture deletes the buffer manager
+        MeshManager::getSingleton().removeAll();
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+};
+
+namespace {
+    const char* MESHES[] = { "knot.mesh", "ogrehead.mesh", "athene.mesh", "robot.mesh",
+                             "ninja.mesh", "razor.mesh", "sphere.mesh", "cube.mesh" };
+    const size_t NUM_MESHES = sizeof(MESHES) / sizeof(MESHES[0]);
+
+    /// Counts the events fired for a group
+    struct CountingGroupListener : public ResourceGroupListener
+    {
+        size_t groupStarted, groupEnded, started, ended, announced;
+        std::vector<String> order;
+
+        CountingGroupListener() : groupStarted(0), groupEnded(0), started(0), ended(0), announced(0) {}
+
+        void resourceGroupScriptingStarted(const String&, size_t) {}
+        void scriptParseStarted(const String&, bool&) {}
+        void scriptParseEnded(const String&, bool) {}
+        void resourceGroupScriptingEnded(const String&) {}
+
+        void resourceGroupPrepareStarted(const String&, size_t count) { ++groupStarted; announced = count; }
+        void resourcePrepareStarted(const ResourcePtr& res) { ++started; order.push_back(res->getName()); }
+        void resourcePrepareEnded(void) { ++ended; }
+        void resourceGroupPrepareEnded(const String&) { ++groupEnded; }
+
+        void resourceGroupLoadStarted(const String&, size_t count) { ++groupStarted; announced = count; }
+        void resourceLoadStarted(const ResourcePtr& res) { ++started; order.push_back(res->getName()); }
+        void resourceLoadEnded(void) { ++ended; }
+        void resourceGroupLoadEnded(const String&) { ++groupEnded; }
+    };
+
+    void createMeshGroup(const String& group)
+    {
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        rgm.createResourceGroup(group, false);
+        rgm.addResourceLocation(rgm.getResourceLocationList(
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME).front()->archive->getName(),
+            "FileSystem", group);
+        rgm.initialiseResourceGroup(group);
+        for (size_t i = 0; i < NUM_MESHES; ++i)
+            MeshManager::getSingleton().createResource(MESHES[i], group);
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, PrepareResourceGroupInParallel)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    createMeshGroup("Parallel");
+
+    CountingGroupListener listener;
+    rgm.addResourceGroupListener(&listener);
+    rgm.setPrepareInParallel(true);
+    rgm.prepareResourceGroup("Parallel");
+    rgm.removeResourceGroupListener(&listener);
+
+    EXPECT_EQ(1U, listener.groupStarted);
+    EXPECT_EQ(1U, listener.groupEnded);
+    EXPECT_EQ(NUM_MESHES, listener.announced);
+    EXPECT_EQ(NUM_MESHES, listener.started);
+    EXPECT_EQ(NUM_MESHES, listener.ended);
+
+    // Fired in the order the resources were created in
+    ASSERT_EQ(NUM_MESHES, listener.order.size());
+    for (size_t i = 0; i < NUM_MESHES; ++i)
+    {
+        EXPECT_EQ(MESHES[i], listener.order[i]);
+        EXPECT_TRUE(MeshManager::getSingleton().getByName(MESHES[i], "Parallel")->isPrepared());
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, LoadResourceGroupInParallel)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    createMeshGroup("Serial");
+    createMeshGroup("Parallel");
+
+    rgm.loadResourceGroup("Serial");
+
+    CountingGroupListener listener;
+    rgm.addResourceGroupListener(&listener);
+    rgm.setPrepareInParallel(true);
+    rgm.loadResourceGroup("Parallel");
+    rgm.removeResourceGroupListener(&listener);
+
+    EXPECT_EQ(1U, listener.groupStarted);
+    EXPECT_EQ(1U, listener.groupEnded);
+    // Loading the meshes creates their skeletons in the group, which are
+    // loaded as well
+    EXPECT_LE(NUM_MESHES, listener.started);
+    EXPECT_EQ(listener.started, listener.ended);
+    EXPECT_TRUE(SkeletonManager::getSingleton().getByName("robot.skeleton", "Parallel")->isLoaded());
+
+    for (size_t i = 0; i < NUM_MESHES; ++i)
+    {
+        MeshPtr serial = MeshManager::getSingleton().getByName(MESHES[i], "Serial");
+        MeshPtr parallel = MeshManager::getSingleton().getByName(MESHES[i], "Parallel");
+        ASSERT_TRUE(parallel->isLoaded());
+        EXPECT_EQ(serial->getNumSubMeshes(), parallel->getNumSubMeshes());
+        EXPECT_EQ(serial->getBounds().getMinimum(), parallel->getBounds().getMinimum());
+        EXPECT_EQ(serial->getBounds().getMaximum(), parallel->getBounds().getMaximum());
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, PrepareResourceGroupInParallelMissingFile)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    createMeshGroup("Parallel");
+    MeshManager::getSingleton().createResource("missing.mesh", "Parallel");
+
+    rgm.setPrepareInParallel(true);
+    EXPECT_THROW(rgm.prepareResourceGroup("Parallel"), FileNotFoundException);
+
+    // The resources before the missing one were finished before failing
+    EXPECT_TRUE(MeshManager::getSingleton().getByName(MESHES[0], "Parallel")->isPrepared());
+    EXPECT_FALSE(MeshManager::getSingleton().getByName("missing.mesh", "Parallel")->isPrepared());
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// Lists the scripts found while initialising a group, without parsing them
+    struct ScriptListener : public ResourceGroupListener
+    {
+        StringVector scripts;
+
+        void resourceGroupScriptingStarted(const String&, size_t) {}
+        void scriptParseStarted(const String& name, bool& skip) { scripts.push_back(name); skip = true; }
+        void scriptParseEnded(const String&, bool) {}
+        void resourceGroupScriptingEnded(const String&) {}
+        void resourceGroupLoadStarted(const String&, size_t) {}
+        void resourceLoadStarted(const ResourcePtr&) {}
+        void resourceLoadEnded(void) {}
+        void resourceGroupLoadEnded(const String&) {}
+    };
+
+    String getArchiveTestPath()
+    {
+        return ResourceGroupManager::getSingleton().getResourceLocationList("Tests").front()->archive->getName() +
+            "/misc/ArchiveTest";
+    }
+
+    /// Adds the archive test location to a new group and returns the scripts found in it
+    StringVector initialiseArchiveTestGroup(const String& group)
+    {
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        rgm.addResourceLocation(getArchiveTestPath(), "FileSystem", group, true);
+
+        ScriptListener listener;
+        rgm.addResourceGroupListener(&listener);
+        rgm.initialiseResourceGroup(group);
+        rgm.removeResourceGroupListener(&listener);
+
+        std::sort(listener.scripts.begin(), listener.scripts.end());
+        return listener.scripts;
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ResourceIndexCache)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    StringVector scanned = initialiseArchiveTestGroup("Scanned");
+    EXPECT_EQ(4U, scanned.size());
+    EXPECT_FALSE(rgm.isResourceIndexCacheDirty());
+
+    rgm.setUseResourceIndexCache(true);
+    initialiseArchiveTestGroup("First");
+    ASSERT_TRUE(rgm.isResourceIndexCacheDirty());
+
+    DataStreamPtr cache(OGRE_NEW MemoryDataStream(4096));
+    rgm.saveResourceIndexCache(cache);
+    EXPECT_FALSE(rgm.isResourceIndexCacheDirty());
+
+    cache->seek(0);
+    rgm.loadResourceIndexCache(cache);
+    EXPECT_EQ(scanned, initialiseArchiveTestGroup("Cached"));
+    // Nothing was scanned
+    EXPECT_FALSE(rgm.isResourceIndexCacheDirty());
+
+    EXPECT_TRUE(rgm.resourceExists("Cached", "rootfile2.txt"));
+    EXPECT_TRUE(rgm.resourceExists("Cached", "level2/materials/scripts/file4.material"));
+    EXPECT_FALSE(rgm.resourceExists("Cached", "level2/materials/scripts/file5.material"));
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ResourceIndexCacheStale)
+{
+    // A listing of the archive which is out of date
+    DataStreamPtr cache(OGRE_NEW MemoryDataStream(4096));
+    uint32 header[] = { 0x52494331, 1 };
+    cache->write(header, sizeof(header));
+    // Archive key, one directory with its time and one file
+    String strings[] = { "FileSystem:" + getArchiveTestPath() + ":recursive", "", "removed.txt" };
+    for (int i = 0; i < 3; ++i)
+    {
+        uint32 count = 1;
+        uint32 length = uint32(strings[i].size());
+        if (i > 0)
+            cache->write(&count, sizeof(uint32));
+        cache->write(&length, sizeof(uint32));
+        cache->write(strings[i].data(), length);
+        if (i == 1)
+        {
+            int64 time = 1;
+            cache->write(&time, sizeof(int64));
+        }
+    }
+
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.setUseResourceIndexCache(true);
+    cache->seek(0);
+    rgm.loadResourceIndexCache(cache);
+
+    EXPECT_EQ(4U, initialiseArchiveTestGroup("Stale").size());
+    EXPECT_TRUE(rgm.resourceExists("Stale", "rootfile.txt"));
+    EXPECT_FALSE(rgm.resourceExists("Stale", "removed.txt"));
+    // Rescanned and replaced
+    EXPECT_TRUE(rgm.isResourceIndexCacheDirty());
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ResourceIndexCacheInvalid)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.setUseResourceIndexCache(true);
+
+    String garbage = "not a resource index cache";
+    DataStreamPtr cache(OGRE_NEW MemoryDataStream(&garbage[0], garbage.size()));
+    rgm.loadResourceIndexCache(cache);
+
+    EXPECT_EQ(4U, initialiseArchiveTestGroup("Invalid").size());
+    EXPECT_TRUE(rgm.resourceExists("Invalid", "rootfile.txt"));
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// Asks for the scripts in one directory of the archive test location
+    struct DirectoryScriptLoader : public ScriptLoader
+    {
+        StringVector patterns;
+
+        DirectoryScriptLoader(const String& pattern) { patterns.push_back(pattern); }
+        const StringVector& getScriptPatterns(void) const { return patterns; }
+        void parseScript(DataStreamPtr&, const String&) {}
+        Real getLoadingOrder(void) const { return 1000; }
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ResourceIndexCacheSeparators)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.setUseResourceIndexCache(true);
+
+    // Both separators find the same scripts in the cached listing
+    DirectoryScriptLoader slashLoader("level1/materials/scripts/*.material");
+    DirectoryScriptLoader backslashLoader("level1\\materials\\scripts\\*.material");
+    rgm._registerScriptLoader(&slashLoader);
+    rgm._registerScriptLoader(&backslashLoader);
+    StringVector scripts = initialiseArchiveTestGroup("Separators");
+    rgm._unregisterScriptLoader(&backslashLoader);
+    rgm._unregisterScriptLoader(&slashLoader);
+
+    // Four materials found by the material manager, two by each loader
+    ASSERT_EQ(8U, scripts.size());
+    EXPECT_EQ(3, std::count(scripts.begin(), scripts.end(), "level1/materials/scripts/file.material"));
+    EXPECT_EQ(3, std::count(scripts.begin(), scripts.end(), "level1/materials/scripts/file2.material"));
+}
+//--------------------------------------------------------------------------
+#if OGRE_THREAD_SUPPORT
+namespace {
+    struct LookupThread
+    {
+        const StringVector* names;
+        AtomicScalar<uint32>* stop;
+        AtomicScalar<uint32>* failed;
+
+        void operator()()
+        {
+            while (!stop->get())
+            {
+                for (size_t i = 0; i < names->size(); ++i)
+                {
+                    if (!MaterialManager::getSingleton().getByName((*names)[i], "Lookup"))
+                        *failed = 1;
+                }
+            }
+        }
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ConcurrentLookups)
+{
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.createResourceGroup("Lookup");
+    rgm.createResourceGroup("Changing");
+
+    StringVector names;
+    for (int i = 0; i < 100; ++i)
+    {
+        names.push_back("Material" + StringConverter::toString(i));
+        MaterialManager::getSingleton().create(names.back(), "Lookup");
+    }
+
+    AtomicScalar<uint32> stop(0), failed(0);
+    LookupThread lookup = { &names, &stop, &failed };
+    std::vector<OGRE_THREAD_TYPE*> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        OGRE_THREAD_CREATE(t, lookup);
+        threads.push_back(t);
+    }
+
+    // Change the maps and groups while they are being looked up in
+    for (int i = 0; i < 500; ++i)
+    {
+        String name = "Changing" + StringConverter::toString(i);
+        MaterialManager::getSingleton().create(name, "Changing");
+        EXPECT_TRUE(MaterialManager::getSingleton().getByName(name, "Changing"));
+        if (i % 10 == 9)
+        {
+            rgm.createResourceGroup(name);
+            rgm.destroyResourceGroup(name);
+        }
+        MaterialManager::getSingleton().remove(name, "Changing");
+    }
+
+    stop = 1;
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->join();
+        OGRE_THREAD_DESTROY(threads[i]);
+    }
+    EXPECT_EQ(0U, failed.get());
+}
+#endif
+//--------------------------------------------------------------------------
+namespace {
+    const char* SCRIPT_DIR = "ParseScriptsTest";
+    const size_t NUM_SCRIPTS = 150;
+
+    /// Records the order of the script events
+    struct ScriptOrderListener : public ResourceGroupListener
+    {
+        StringVector events;
+
+        void resourceGroupScriptingStarted(const String&, size_t) {}
+        void scriptParseStarted(const String& name, bool&) { events.push_back("started " + name); }
+        void scriptParseEnded(const String& name, bool) { events.push_back("ended " + name); }
+        void resourceGroupScriptingEnded(const String&) {}
+        void resourceGroupLoadStarted(const String&, size_t) {}
+        void resourceLoadStarted(const ResourcePtr&) {}
+        void resourceLoadEnded(void) {}
+        void resourceGroupLoadEnded(const String&) {}
+    };
+
+    /// Writes the script the others import
+    void writeBaseScript(const char* ambient)
+    {
+        std::ofstream base((String(SCRIPT_DIR) + "/base.material").c_str());
+        base << "abstract material Base\n{\n    technique\n    {\n        pass Lit\n        {\n"
+                "            ambient " << ambient << "\n        }\n    }\n}\n";
+    }
+
+    /// Writes material scripts using variables, inheritance and imports, some with errors
+    void writeScripts()
+    {
+        FileSystemLayer::createDirectory(SCRIPT_DIR);
+        writeBaseScript("0.5 0.5 0.5");
+        for (size_t i = 0; i < NUM_SCRIPTS; ++i)
+        {
+            String index = StringConverter::toString(i);
+            std::ofstream file((String(SCRIPT_DIR) + "/script" + index + ".material").c_str());
+            file << "import Base from \"base.material\"\n";
+            file << "set $colour \"" << (i % 10) / 10.0f << " 0 1\"\n";
+            file << "material Inherited" << index << " : Base\n{\n    technique\n    {\n"
+                    "        pass Lit\n        {\n            diffuse $colour\n"
+                    "            texture_unit { texture tex" << index << ".png }\n        }\n    }\n}\n";
+            file << "material Plain" << index << "\n{\n    technique Script" << index << "\n    {\n"
+                    "        pass\n        {\n            ambient $colour\n        }\n    }\n}\n";
+            if (i % 13 == 0)
+                file << "not_a_class Broken" << index << "\n{\n}\n";
+        }
+    }
+
+    void removeScripts()
+    {
+        FileSystemLayer::removeFile(String(SCRIPT_DIR) + "/base.material");
+        for (size_t i = 0; i < NUM_SCRIPTS; ++i)
+            FileSystemLayer::removeFile(String(SCRIPT_DIR) + "/script" + StringConverter::toString(i) + ".material");
+        FileSystemLayer::removeDirectory(SCRIPT_DIR);
+    }
+
+    /** Parses the scripts into a new group and describes the materials
+        created, in creation order, then destroys the group.
+    */
+    StringVector parseScripts(const String& group, bool parallel, StringVector& events)
+    {
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+        rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", group);
+
+        ScriptOrderListener listener;
+        rgm.addResourceGroupListener(&listener);
+        rgm.setParseScriptsInParallel(parallel);
+        rgm.initialiseResourceGroup(group);
+        rgm.setParseScriptsInParallel(false);
+        rgm.removeResourceGroupListener(&listener);
+        events = listener.events;
+
+        StringVector materials;
+        ResourceManager::ResourceMapIterator it = MaterialManager::getSingleton().getResourceIterator();
+        while (it.hasMoreElements())
+        {
+            Material* mat = static_cast<Material*>(it.getNext().get());
+            if (mat->getGroup() != group)
+                continue;
+            String desc = mat->getName();
+            for (unsigned short t = 0; t < mat->getNumTechniques(); ++t)
+            {
+                Technique* tech = mat->getTechnique(t);
+                desc += " | " + tech->getName();
+                for (unsigned short p = 0; p < tech->getNumPasses(); ++p)
+                {
+                    Pass* pass = tech->getPass(p);
+                    desc += " " + pass->getName() + " " + StringConverter::toString(pass->getAmbient()) +
+                        " " + StringConverter::toString(pass->getDiffuse());
+                    for (unsigned short u = 0; u < pass->getNumTextureUnitStates(); ++u)
+                        desc += " " + pass->getTextureUnitState(u)->getTextureName();
+                }
+            }
+            materials.push_back(desc);
+        }
+
+        rgm.destroyResourceGroup(group);
+        return materials;
+    }
+}
+//--------------------------------------------------------------------------
+namespace {
+    /// Registers a custom word while its script is being prepared
+    struct WordRegisteringStream : public MemoryDataStream
+    {
+        String word;
+
+        WordRegisteringStream(String& script, const String& w)
+            : MemoryDataStream(&script[0], script.size()), word(w) {}
+
+        String getAsString(void)
+        {
+            ScriptCompilerManager::getSingleton().registerCustomWordId(word);
+            return MemoryDataStream::getAsString();
+        }
+    };
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, PrepareScriptWithStaleCompiler)
+{
+    ScriptCompilerManager& scm = ScriptCompilerManager::getSingleton();
+    String script = "material Stale {}";
+
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(&script[0], script.size()));
+    ScriptLoader::PreparedScript* prepared = scm.prepareScript(stream, "General");
+    EXPECT_TRUE(prepared != 0);
+    OGRE_DELETE prepared;
+
+    // The compiler doesn't know the word registered meanwhile, so the
+    // script is left to parseScript
+    DataStreamPtr registering(OGRE_NEW WordRegisteringStream(script, "stale_compiler_word"));
+    EXPECT_TRUE(scm.prepareScript(registering, "General") == 0);
+
+    // The compilers created from then on know it
+    stream->seek(0);
+    prepared = scm.prepareScript(stream, "General");
+    EXPECT_TRUE(prepared != 0);
+    OGRE_DELETE prepared;
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ParseScriptsInParallel)
+{
+    writeScripts();
+    StringVector serialEvents, parallelEvents;
+    StringVector serial = parseScripts("Serial", false, serialEvents);
+    StringVector parallel = parseScripts("Parallel", true, parallelEvents);
+    removeScripts();
+
+    ASSERT_EQ(NUM_SCRIPTS * 2, serial.size());
+    // Inherited the pass and expanded the variable
+    EXPECT_NE(serial.end(), std::find(serial.begin(), serial.end(),
+                                      "Inherited3 |  Lit 0.5 0.5 0.5 1 0.3 0 1 1 tex3.png"));
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serialEvents, parallelEvents);
+}
+//--------------------------------------------------------------------------
+TEST_F(ResourceGroupManagerTests, ScriptCache)
+{
+    const String cacheDir = "ScriptCacheTest";
+    writeScripts();
+    StringVector events, cachedEvents;
+    StringVector uncached = parseScripts("Cached", false, events);
+
+    // Fills the cache, then reads it back, serially and in parallel
+    ScriptCompilerManager::getSingleton().setScriptCacheDirectory(cacheDir);
+    StringVector cold = parseScripts("Cached", false, cachedEvents);
+    EXPECT_EQ(uncached, cold);
+    StringVector warm = parseScripts("Cached", false, cachedEvents);
+    EXPECT_EQ(uncached, warm);
+    EXPECT_EQ(events, cachedEvents);
+    StringVector warmParallel = parseScripts("Cached", true, cachedEvents);
+    EXPECT_EQ(uncached, warmParallel);
+    EXPECT_EQ(events, cachedEvents);
+
+    // The scripts are read from the cache
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+    rgm.addResourceLocation(SCRIPT_DIR, "FileSystem", "Cached");
+    {
+        ScriptCompiler compiler;
+        compiler.setCacheDirectory(cacheDir);
+        DataStreamPtr stream = rgm.openResource("script3.material", "Cached");
+        ScriptCompiler::ParsedScript script;
+        compiler._parse(stream->getAsString(), stream->getName(), "Cached", script);
+        EXPECT_TRUE(script.cached);
+    }
+    rgm.destroyResourceGroup("Cached");
+
+    // Changing an imported script makes the entries importing it out of date
+    writeBaseScript("0.25 0.25 0.25");
+    StringVector changed = parseScripts("Cached", true, cachedEvents);
+    EXPECT_NE(changed.end(), std::find(changed.begin(), changed.end(),
+                                       "Inherited3 |  Lit 0.25 0.25 0.25 1 0.3 0 1 1 tex3.png"));
+
+    ScriptCompilerManager::getSingleton().setScriptCacheDirectory("");
+    removeScripts();
+    FileSystemArchive cache(cacheDir, "FileSystem", false);
+    cache.load();
+    StringVectorPtr entries = cache.list(false);
+    for (size_t i = 0; i < entries->size(); ++i)
+        cache.remove(entries->at(i));
+    FileSystemLayer::removeDirectory(cacheDir);
+}
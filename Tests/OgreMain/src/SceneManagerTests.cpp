@@ -0,0 +1,396 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <Threading/OgreTaskScheduler.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include "TestData.h"
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture SceneManagerTests;
+
+namespace {
+    /// Counts nodeUpdated events
+    struct CountingListener : public Node::Listener
+    {
+        size_t count;
+        CountingListener() : count(0) {}
+        void nodeUpdated(const Node*) { ++count; }
+    };
+
+    /// Creates chains of nodes below the given node, or below the root node
+    void createHierarchy(SceneManager* sceneMgr, std::vector<SceneNode*>& nodes, Node::Listener* listener,
+                         SceneNode* top = 0)
+    {
+        if (!top)
+            top = sceneMgr->getRootSceneNode();
+        for (int i = 0; i < 64; ++i)
+        {
+            SceneNode* parent = top->createChildSceneNode(
+                Vector3(Real(i), 0, 0), Quaternion(Degree(Real(i)), Vector3::UNIT_Y));
+            nodes.push_back(parent);
+            for (int depth = 0; depth < 8; ++depth)
+            {
+                parent = parent->createChildSceneNode(
+                    Vector3(0, Real(depth), 1), Quaternion(Degree(10), Vector3::UNIT_X));
+                parent->setScale(Vector3(1.1f, 1.0f, 0.9f));
+                parent->setListener(listener);
+                nodes.push_back(parent);
+            }
+        }
+    }
+
+    /// Counts the objects queued for rendering
+    struct CountingObjectListener : public MovableObject::Listener
+    {
+        std::set<const MovableObject*> rendered;
+        bool objectRendering(const MovableObject* obj, const Camera*) { rendered.insert(obj); return true; }
+    };
+
+    /// Unit sized object which doesn't render anything
+    struct TestObject : public MovableObject
+    {
+        AxisAlignedBox box;
+        TestObject() : box(Vector3::ZERO, Vector3::UNIT_SCALE) {}
+        const String& getMovableType(void) const { static String type = "TestObject"; return type; }
+        const AxisAlignedBox& getBoundingBox(void) const { return box; }
+        Real getBoundingRadius(void) const { return 1; }
+        void _updateRenderQueue(RenderQueue*) {}
+        void visitRenderables(Renderable::Visitor*, bool) {}
+    };
+
+    /// Creates a grid of objects, each of them below one of the children of the given node, or of the root node
+    void createObjects(SceneManager* sceneMgr, std::vector<TestObject*>& objects, MovableObject::Listener* listener,
+                       SceneNode* top = 0)
+    {
+        if (!top)
+            top = sceneMgr->getRootSceneNode();
+        for (int i = 0; i < 20; ++i)
+        {
+            SceneNode* parent = top->createChildSceneNode(Vector3(Real(i - 10) * 10, 0, 0));
+            for (int j = 0; j < 20; ++j)
+            {
+                TestObject* obj = new TestObject();
+                obj->setListener(listener);
+                SceneNode* node = parent->createChildSceneNode(Vector3(0, 0, Real(j - 10) * 10));
+                node->attachObject(obj);
+                // The full transform is maintained by the application
+                Matrix4 transform;
+                transform.makeTransform(parent->getPosition() + node->getPosition(),
+                    Vector3::UNIT_SCALE, Quaternion::IDENTITY);
+                node->overrideCachedTransform(transform);
+                objects.push_back(obj);
+            }
+        }
+    }
+
+    /// Reads back the blended positions of all the robots
+    std::vector<float> getBlendedPositions(const std::vector<Entity*>& robots)
+    {
+        std::vector<float> positions;
+        for (size_t i = 0; i < robots.size(); ++i)
+        {
+            std::vector<VertexData*> vertexData;
+            if (robots[i]->getMesh()->sharedVertexData)
+                vertexData.push_back(robots[i]->_getSkelAnimVertexData());
+            for (size_t j = 0; j < robots[i]->getNumSubEntities(); ++j)
+            {
+                if (!robots[i]->getSubEntity(j)->getSubMesh()->useSharedVertices)
+                    vertexData.push_back(robots[i]->getSubEntity(j)->_getSkelAnimVertexData());
+            }
+
+            for (size_t j = 0; j < vertexData.size(); ++j)
+            {
+                const VertexElement* posElem =
+                    vertexData[j]->vertexDeclaration->findElementBySemantic(VES_POSITION);
+                HardwareVertexBufferSharedPtr buf =
+                    vertexData[j]->vertexBufferBinding->getBuffer(posElem->getSource());
+                unsigned char* vertex = static_cast<unsigned char*>(buf->lock(HardwareBuffer::HBL_READ_ONLY));
+                for (size_t v = 0; v < vertexData[j]->vertexCount; ++v, vertex += buf->getVertexSize())
+                {
+                    float* pos;
+                    posElem->baseVertexPointerToElement(vertex, &pos);
+                    positions.insert(positions.end(), pos, pos + 3);
+                }
+                buf->unlock();
+            }
+        }
+        return positions;
+    }
+}
+
+TEST_F(SceneManagerTests, ParallelUpdateSceneGraph)
+{
+    SceneManager* serialMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* parallelMgr = mRoot->createSceneManager(ST_GENERIC);
+    parallelMgr->setNumWorkerThreads(3);
+
+    CountingListener serialListener, parallelListener;
+    std::vector<SceneNode*> serialNodes, parallelNodes;
+    createHierarchy(serialMgr, serialNodes, &serialListener);
+    createHierarchy(parallelMgr, parallelNodes, &parallelListener);
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        // Move a few subtrees so that selective updates are exercised too
+        serialNodes[frame * 9]->yaw(Degree(5));
+        parallelNodes[frame * 9]->yaw(Degree(5));
+
+        serialMgr->_updateSceneGraph(0);
+        parallelMgr->_updateSceneGraph(0);
+
+        // Listeners are only called back once the update has been joined
+        EXPECT_GT(parallelListener.count, 0u);
+        EXPECT_EQ(serialListener.count, parallelListener.count);
+        for (size_t i = 0; i < serialNodes.size(); ++i)
+        {
+            // Same operations in the same order, so the results must match exactly
+            EXPECT_EQ(serialNodes[i]->_getDerivedPosition(), parallelNodes[i]->_getDerivedPosition());
+            EXPECT_EQ(serialNodes[i]->_getDerivedOrientation(), parallelNodes[i]->_getDerivedOrientation());
+        }
+    }
+
+    mRoot->destroySceneManager(parallelMgr);
+    mRoot->destroySceneManager(serialMgr);
+}
+
+TEST_F(SceneManagerTests, ParallelUpdateSingleSubtree)
+{
+    SceneManager* serialMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* parallelMgr = mRoot->createSceneManager(ST_GENERIC);
+    parallelMgr->setNumWorkerThreads(3);
+
+    // Everything below one top level node, which has to be split further
+    CountingListener serialListener, parallelListener;
+    std::vector<SceneNode*> serialNodes, parallelNodes;
+    SceneNode* serialTop = serialMgr->getRootSceneNode()->createChildSceneNode(Vector3(1, 2, 3));
+    SceneNode* parallelTop = parallelMgr->getRootSceneNode()->createChildSceneNode(Vector3(1, 2, 3));
+    serialTop->setListener(&serialListener);
+    parallelTop->setListener(&parallelListener);
+    createHierarchy(serialMgr, serialNodes, &serialListener, serialTop);
+    createHierarchy(parallelMgr, parallelNodes, &parallelListener, parallelTop);
+    std::vector<TestObject*> objects;
+    for (size_t i = 0; i < serialNodes.size(); i += 9)
+    {
+        // The full transform is maintained by the application
+        Matrix4 transform;
+        transform.makeTransform(Vector3(Real(i), 0, 0), Vector3::UNIT_SCALE, Quaternion::IDENTITY);
+        objects.push_back(new TestObject());
+        serialNodes[i]->attachObject(objects.back());
+        serialNodes[i]->overrideCachedTransform(transform);
+        objects.push_back(new TestObject());
+        parallelNodes[i]->attachObject(objects.back());
+        parallelNodes[i]->overrideCachedTransform(transform);
+    }
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        serialTop->roll(Degree(5));
+        parallelTop->roll(Degree(5));
+        serialNodes[frame * 9]->yaw(Degree(5));
+        parallelNodes[frame * 9]->yaw(Degree(5));
+
+        serialMgr->_updateSceneGraph(0);
+        parallelMgr->_updateSceneGraph(0);
+
+        EXPECT_EQ(serialListener.count, parallelListener.count);
+        for (size_t i = 0; i < serialNodes.size(); ++i)
+        {
+            EXPECT_EQ(serialNodes[i]->_getDerivedPosition(), parallelNodes[i]->_getDerivedPosition());
+            EXPECT_EQ(serialNodes[i]->_getDerivedOrientation(), parallelNodes[i]->_getDerivedOrientation());
+        }
+        // The bounds of the split nodes are merged once their children are done
+        EXPECT_EQ(serialTop->_getWorldAABB(), parallelTop->_getWorldAABB());
+        EXPECT_EQ(serialMgr->getRootSceneNode()->_getWorldAABB(),
+                  parallelMgr->getRootSceneNode()->_getWorldAABB());
+    }
+
+    mRoot->destroySceneManager(parallelMgr);
+    mRoot->destroySceneManager(serialMgr);
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+}
+
+TEST_F(SceneManagerTests, ParallelFindVisibleObjects)
+{
+    SceneManager* serialMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* parallelMgr = mRoot->createSceneManager(ST_GENERIC);
+    parallelMgr->setNumWorkerThreads(3);
+
+    CountingObjectListener serialListener, parallelListener;
+    std::vector<TestObject*> objects;
+    createObjects(serialMgr, objects, &serialListener);
+    createObjects(parallelMgr, objects, &parallelListener);
+
+    // Not created through the scene managers, which need a render system for cameras
+    Camera serialCamera("Cam", serialMgr);
+    Camera parallelCamera("Cam", parallelMgr);
+    Camera* serialCam = &serialCamera;
+    Camera* parallelCam = &parallelCamera;
+    serialCam->setPosition(0, 0, 50);
+    parallelCam->setPosition(0, 0, 50);
+    serialCam->lookAt(20, 0, 0);
+    parallelCam->lookAt(20, 0, 0);
+
+    serialMgr->_updateSceneGraph(serialCam);
+    parallelMgr->_updateSceneGraph(parallelCam);
+
+    VisibleObjectsBoundsInfo serialBounds, parallelBounds;
+    serialMgr->_findVisibleObjects(serialCam, &serialBounds, false);
+    parallelMgr->_findVisibleObjects(parallelCam, &parallelBounds, false);
+
+    // Some, but not all, objects are in view
+    EXPECT_GT(serialListener.rendered.size(), 0u);
+    EXPECT_LT(serialListener.rendered.size(), 400u);
+    EXPECT_EQ(serialListener.rendered.size(), parallelListener.rendered.size());
+    EXPECT_EQ(serialBounds.aabb, parallelBounds.aabb);
+    EXPECT_EQ(serialBounds.minDistance, parallelBounds.minDistance);
+    EXPECT_EQ(serialBounds.maxDistance, parallelBounds.maxDistance);
+
+    mRoot->destroySceneManager(parallelMgr);
+    mRoot->destroySceneManager(serialMgr);
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+}
+
+TEST_F(SceneManagerTests, ParallelFindVisibleObjectsSingleSubtree)
+{
+    SceneManager* serialMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* parallelMgr = mRoot->createSceneManager(ST_GENERIC);
+    parallelMgr->setNumWorkerThreads(3);
+
+    // Everything below one top level node, which has to be split further
+    CountingObjectListener serialListener, parallelListener;
+    std::vector<TestObject*> objects;
+    SceneNode* serialTop = serialMgr->getRootSceneNode()->createChildSceneNode();
+    SceneNode* parallelTop = parallelMgr->getRootSceneNode()->createChildSceneNode();
+    createObjects(serialMgr, objects, &serialListener, serialTop);
+    createObjects(parallelMgr, objects, &parallelListener, parallelTop);
+    objects.push_back(new TestObject());
+    objects.back()->setListener(&serialListener);
+    serialTop->attachObject(objects.back());
+    objects.push_back(new TestObject());
+    objects.back()->setListener(&parallelListener);
+    parallelTop->attachObject(objects.back());
+
+    Camera serialCamera("Cam", serialMgr);
+    Camera parallelCamera("Cam", parallelMgr);
+    serialCamera.setPosition(0, 0, 50);
+    parallelCamera.setPosition(0, 0, 50);
+    serialCamera.lookAt(20, 0, 0);
+    parallelCamera.lookAt(20, 0, 0);
+
+    serialMgr->_updateSceneGraph(&serialCamera);
+    parallelMgr->_updateSceneGraph(&parallelCamera);
+
+    VisibleObjectsBoundsInfo serialBounds, parallelBounds;
+    serialMgr->_findVisibleObjects(&serialCamera, &serialBounds, false);
+    parallelMgr->_findVisibleObjects(&parallelCamera, &parallelBounds, false);
+
+    // The objects of the split node itself are queued too
+    EXPECT_GT(serialListener.rendered.size(), 1u);
+    EXPECT_LT(serialListener.rendered.size(), 401u);
+    EXPECT_EQ(1u, serialListener.rendered.count(objects[objects.size() - 2]));
+    EXPECT_EQ(1u, parallelListener.rendered.count(objects.back()));
+    EXPECT_EQ(serialListener.rendered.size(), parallelListener.rendered.size());
+    EXPECT_EQ(serialBounds.aabb, parallelBounds.aabb);
+    EXPECT_EQ(serialBounds.minDistance, parallelBounds.minDistance);
+    EXPECT_EQ(serialBounds.maxDistance, parallelBounds.maxDistance);
+
+    mRoot->destroySceneManager(parallelMgr);
+    mRoot->destroySceneManager(serialMgr);
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+}
+
+TEST_F(SceneManagerTests, ParallelSoftwareSkinning)
+{
+    SceneManager* serialMgr = mRoot->createSceneManager(ST_GENERIC);
+    SceneManager* parallelMgr = mRoot->createSceneManager(ST_GENERIC);
+    mRoot->getTaskScheduler()->setWorkerThreadCount(3);
+    mRoot->getTaskScheduler()->startup(true);
+    parallelMgr->setParallelSoftwareSkinningEnabled(true);
+
+    std::vector<Entity*> serialRobots, parallelRobots;
+    createRobots(serialMgr, serialRobots);
+    createRobots(parallelMgr, parallelRobots);
+    ResourceHandle meshHandle = serialRobots[0]->getMesh()->getHandle();
+
+    RejectingRenderableListener rejectingListener;
+    serialMgr->getRenderQueue()->setRenderableListener(&rejectingListener);
+    parallelMgr->getRenderQueue()->setRenderableListener(&rejectingListener);
+
+    Camera serialCamera("Cam", serialMgr);
+    Camera parallelCamera("Cam", parallelMgr);
+    serialCamera.setPosition(0, 50, 1500);
+    parallelCamera.setPosition(0, 50, 1500);
+
+    std::vector<float> previous;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        for (size_t i = 0; i < serialRobots.size(); ++i)
+        {
+            serialRobots[i]->getAnimationState("Walk")->addTime(0.25f);
+            parallelRobots[i]->getAnimationState("Walk")->addTime(0.25f);
+        }
+
+        serialMgr->_updateSceneGraph(&serialCamera);
+        parallelMgr->_updateSceneGraph(&parallelCamera);
+
+        VisibleObjectsBoundsInfo serialBounds, parallelBounds;
+        serialMgr->_findVisibleObjects(&serialCamera, &serialBounds, false);
+        parallelMgr->_findVisibleObjects(&parallelCamera, &parallelBounds, false);
+        // Queued until all the visible objects have been found
+        EXPECT_TRUE(parallelRobots[0]->_isSoftwareSkinningQueued());
+        parallelMgr->_updateQueuedSoftwareSkinning();
+        EXPECT_FALSE(parallelRobots[0]->_isSoftwareSkinningQueued());
+
+        // Same matrices and the same blend, so the results must match exactly
+        std::vector<float> positions = getBlendedPositions(parallelRobots);
+        ASSERT_FALSE(positions.empty());
+        EXPECT_TRUE(getBlendedPositions(serialRobots) == positions);
+        // Moved on since the last frame
+        EXPECT_FALSE(previous == positions);
+        previous = positions;
+
+        mRoot->_fireFrameRenderingQueued();
+    }
+
+    // Destroying a queued entity flushes the queue first
+    parallelMgr->_updateSceneGraph(&parallelCamera);
+    parallelRobots[0]->getAnimationState("Walk")->addTime(0.25f);
+    VisibleObjectsBoundsInfo parallelBounds;
+    parallelMgr->_findVisibleObjects(&parallelCamera, &parallelBounds, false);
+    EXPECT_TRUE(parallelRobots[0]->_isSoftwareSkinningQueued());
+    parallelMgr->destroyEntity(parallelRobots[0]);
+
+    mRoot->destroySceneManager(parallelMgr);
+    mRoot->destroySceneManager(serialMgr);
+    MeshManager::getSingleton().remove(meshHandle);
+}
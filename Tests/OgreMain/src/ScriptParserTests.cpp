@@ -0,0 +1,160 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <gtest/gtest.h>
+#include <OgreScriptParser.h>
+#include <OgreStringConverter.h>
+
+using namespace Ogre;
+
+namespace {
+    const char* SCRIPT =
+        "// comment\r\n"
+        "import \"Quoted Target\" from \"base file.material\"\r\n"
+        "set $colour \"0.5 \\\"0\\\" 1\"\r\n"
+        "material \"Name \\\\ with escapes\" : \"Base\" Other\r\n"
+        "{\r\n"
+        "    /* multi\r\n"
+        "       line */ technique {\r\n"
+        "        pass { ambient $colour }\r\n"
+        "    }\r\n"
+        "}\r\n"
+        "{a b} c /d //x\r\n"
+        "abstract pass P { }";
+
+    /// Describes nodes and their children, one per line
+    String describe(const ConcreteNodeList& nodes, ConcreteNode* parent, int depth = 0)
+    {
+        String desc;
+        for (ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+        {
+            desc += String(depth, ' ') + StringConverter::toString((*i)->type) + " [" + (*i)->token + "] " +
+                (*i)->file + ":" + StringConverter::toString((*i)->line) +
+                ((*i)->parent == parent ? "\n" : " wrong parent\n");
+            desc += describe((*i)->children, (*i).get(), depth + 1);
+        }
+        return desc;
+    }
+
+    String describe(const ConcreteNodeViewList& nodes, ConcreteNodeView* parent, int depth = 0)
+    {
+        String desc;
+        size_t size = 0;
+        for (ConcreteNodeView* i = nodes.front; i; i = i->next, ++size)
+        {
+            desc += String(depth, ' ') + StringConverter::toString(i->type) + " [" + i->getToken() + "] " +
+                *i->file + ":" + StringConverter::toString(i->line) +
+                (i->parent == parent ? "\n" : " wrong parent\n");
+            desc += describe(i->children, i, depth + 1);
+        }
+        if (size != nodes.size)
+            desc += "wrong size\n";
+        return desc;
+    }
+}
+//--------------------------------------------------------------------------
+TEST(ScriptParserTests, TokenViews)
+{
+    // The views point into the script, so it has to outlive them
+    String script = SCRIPT, source = "test.material";
+    ScriptTokenListPtr tokens = ScriptLexer::tokenize(script, source);
+    ScriptArena arena;
+    ScriptTokenViewList views;
+    ScriptLexer::tokenize(script, source, views, arena);
+
+    ASSERT_EQ(tokens->size(), views.size());
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        EXPECT_EQ((*tokens)[i]->lexeme, String(views[i].lexeme, views[i].length));
+        EXPECT_EQ((*tokens)[i]->type, views[i].type);
+        EXPECT_EQ((*tokens)[i]->line, views[i].line);
+        EXPECT_EQ(&source, views[i].file);
+    }
+
+    // Escaped quotes lose their backslash, other backslashes are kept once
+    StringVector quotes;
+    for (size_t i = 0; i < tokens->size(); ++i)
+    {
+        if ((*tokens)[i]->type == TID_QUOTE)
+            quotes.push_back((*tokens)[i]->lexeme);
+    }
+    ASSERT_EQ(5u, quotes.size());
+    EXPECT_EQ("\"0.5 \"0\" 1\"", quotes[2]);
+    EXPECT_EQ("\"Name \\ with escapes\"", quotes[3]);
+}
+//--------------------------------------------------------------------------
+TEST(ScriptParserTests, NodeViews)
+{
+    String script = SCRIPT, source = "test.material";
+    ConcreteNodeListPtr nodes = ScriptParser::parse(ScriptLexer::tokenize(script, source));
+
+    ScriptArena arena;
+    ScriptTokenViewList tokens;
+    ScriptLexer::tokenize(script, source, tokens, arena);
+    ConcreteNodeViewList views;
+    ScriptParser::parse(tokens, views, arena);
+
+    String desc = describe(*nodes, 0);
+    EXPECT_EQ(desc, describe(views, 0));
+    EXPECT_EQ(String::npos, desc.find("wrong"));
+
+    // Quotes are stripped, except from the bases
+    ConcreteNodePtr import = nodes->front();
+    EXPECT_EQ(CNT_IMPORT, import->type);
+    EXPECT_EQ("Quoted Target", import->children.front()->token);
+    EXPECT_EQ("base file.material", import->children.back()->token);
+    ConcreteNodeList::iterator material = nodes->begin();
+    std::advance(material, 2);
+    EXPECT_EQ("material", (*material)->token);
+    ConcreteNodeList::iterator colon = (*material)->children.begin();
+    ++colon;
+    EXPECT_EQ(CNT_COLON, (*colon)->type);
+    EXPECT_EQ("\"Base\"", (*colon)->children.front()->token);
+}
+//--------------------------------------------------------------------------
+TEST(ScriptParserTests, ArenaReuse)
+{
+    ScriptArena arena;
+    ScriptTokenViewList tokens;
+    String source = "test.material";
+    // Larger than a block, so the arena grows
+    String script;
+    for (int i = 0; i < 2000; ++i)
+        script += "material M" + StringConverter::toString(i) + " { technique { pass { } } }\n";
+
+    for (int run = 0; run < 3; ++run)
+    {
+        arena.reset();
+        tokens.clear();
+        ScriptLexer::tokenize(script, source, tokens, arena);
+        ConcreteNodeViewList nodes;
+        ScriptParser::parse(tokens, nodes, arena);
+        ASSERT_EQ(2000u, nodes.size);
+        EXPECT_EQ("M1999", nodes.back->children.front->getToken());
+    }
+}
@@ -0,0 +1,202 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <Threading/OgreTaskScheduler.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture TaskSchedulerTests;
+
+namespace {
+    /// Counts how often each index is visited
+    struct CountingLoop
+    {
+        std::vector<uint32>* counts;
+        size_t grainSize;
+        AtomicScalar<uint32>* oversizedChunks;
+
+        void operator()(size_t begin, size_t end) const
+        {
+            if (end - begin > grainSize)
+                ++*oversizedChunks;
+            for (size_t i = begin; i < end; ++i)
+                ++(*counts)[i];
+        }
+    };
+
+    void testParallelFor(TaskScheduler& scheduler)
+    {
+        const size_t grainSizes[] = { 0, 1, 7, 64, 100000 };
+        for (size_t g = 0; g < 5; ++g)
+        {
+            std::vector<uint32> counts(10000, 0);
+            AtomicScalar<uint32> oversizedChunks(0);
+            CountingLoop loop = { &counts, grainSizes[g] ? grainSizes[g] : counts.size(), &oversizedChunks };
+            scheduler.parallelFor(3, counts.size(), grainSizes[g], loop);
+
+            EXPECT_EQ(0u, oversizedChunks.get());
+            for (size_t i = 0; i < counts.size(); ++i)
+                ASSERT_EQ(i < 3 ? 0u : 1u, counts[i]) << "index " << i << ", grain size " << grainSizes[g];
+        }
+
+        // Empty range
+        std::vector<uint32> counts(1, 0);
+        AtomicScalar<uint32> oversizedChunks(0);
+        CountingLoop loop = { &counts, 1, &oversizedChunks };
+        scheduler.parallelFor(1, 1, 1, loop);
+        EXPECT_EQ(0u, counts[0]);
+    }
+
+    /// Records the order in which the tasks ran
+    struct OrderTask : public Task
+    {
+        AtomicScalar<uint32>* counter;
+        uint32 order;
+
+        OrderTask(AtomicScalar<uint32>* c) : counter(c), order(0) {}
+        void execute() { order = ++*counter; }
+    };
+
+    void testDependencies(TaskScheduler& scheduler)
+    {
+        for (int run = 0; run < 50; ++run)
+        {
+            // Diamond: a -> (b, c) -> d
+            AtomicScalar<uint32> counter(0);
+            OrderTask a(&counter), b(&counter), c(&counter), d(&counter);
+            b.addDependency(&a);
+            c.addDependency(&a);
+            d.addDependency(&b);
+            d.addDependency(&c);
+            // Submitted in reverse, so nothing may run early
+            scheduler.submit(&d);
+            scheduler.submit(&c);
+            scheduler.submit(&b);
+            EXPECT_FALSE(d.isFinished());
+            scheduler.submit(&a);
+            scheduler.wait(&d);
+
+            EXPECT_TRUE(a.isFinished() && b.isFinished() && c.isFinished() && d.isFinished());
+            EXPECT_LT(a.order, b.order);
+            EXPECT_LT(a.order, c.order);
+            EXPECT_LT(b.order, d.order);
+            EXPECT_LT(c.order, d.order);
+            EXPECT_EQ(4u, counter.get());
+
+            // A finished dependency doesn't hold the task back
+            OrderTask e(&counter);
+            e.addDependency(&d);
+            scheduler.run(&e);
+            EXPECT_EQ(5u, e.order);
+
+            // Tasks can be submitted again
+            scheduler.run(&a);
+            EXPECT_EQ(6u, a.order);
+            // b and c don't wait for anyone this time
+            scheduler.submit(&b);
+            scheduler.submit(&c);
+            scheduler.wait(&b);
+            scheduler.wait(&c);
+            EXPECT_EQ(8u, counter.get());
+        }
+    }
+
+    /// Runs a parallelFor from within a task
+    struct NestedTask : public Task
+    {
+        TaskScheduler* scheduler;
+        std::vector<uint32> counts;
+
+        NestedTask(TaskScheduler* s) : scheduler(s), counts(1000, 0) {}
+        void execute()
+        {
+            AtomicScalar<uint32> oversizedChunks(0);
+            CountingLoop loop = { &counts, 10, &oversizedChunks };
+            scheduler->parallelFor(0, counts.size(), 10, loop);
+        }
+    };
+
+    void testNested(TaskScheduler& scheduler)
+    {
+        std::vector<NestedTask*> tasks;
+        for (int i = 0; i < 16; ++i)
+        {
+            tasks.push_back(new NestedTask(&scheduler));
+            scheduler.submit(tasks.back());
+        }
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            scheduler.wait(tasks[i]);
+            EXPECT_EQ(std::vector<uint32>(1000, 1), tasks[i]->counts);
+            delete tasks[i];
+        }
+    }
+}
+
+TEST_F(TaskSchedulerTests, RootScheduler)
+{
+    ASSERT_TRUE(mRoot->getTaskScheduler() != 0);
+    testParallelFor(*mRoot->getTaskScheduler());
+}
+
+TEST_F(TaskSchedulerTests, ParallelFor)
+{
+    TaskScheduler scheduler("Test");
+    scheduler.setWorkerThreadCount(3);
+    scheduler.startup();
+    testParallelFor(scheduler);
+}
+
+TEST_F(TaskSchedulerTests, Dependencies)
+{
+    TaskScheduler scheduler("Test");
+    scheduler.setWorkerThreadCount(3);
+    scheduler.startup();
+    testDependencies(scheduler);
+}
+
+TEST_F(TaskSchedulerTests, NestedWait)
+{
+    TaskScheduler scheduler("Test");
+    scheduler.setWorkerThreadCount(2);
+    scheduler.startup();
+    testNested(scheduler);
+}
+
+TEST_F(TaskSchedulerTests, Serial)
+{
+    // No worker threads, everything runs on this thread
+    TaskScheduler scheduler("Test");
+    scheduler.startup();
+    EXPECT_EQ(1u, scheduler.getNumThreads());
+    testParallelFor(scheduler);
+    testDependencies(scheduler);
+    testNested(scheduler);
+}
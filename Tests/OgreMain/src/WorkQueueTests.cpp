@@ -0,0 +1,218 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <Threading/OgreDefaultWorkQueue.h>
+#include <Threading/OgreWorkStealingWorkQueue.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+typedef RootWithoutRenderSystemFixture WorkQueueTests;
+
+#if OGRE_THREAD_SUPPORT
+namespace {
+    enum
+    {
+        REQUEST_NORMAL,
+        /// Fails while retries are left
+        REQUEST_FAIL,
+        /// Blocks the worker while the handler is on hold
+        REQUEST_HOLD
+    };
+
+    const uint16 NUM_CHANNELS = 2;
+
+    struct TestHandler : public WorkQueue::RequestHandler, public WorkQueue::ResponseHandler
+    {
+        AtomicScalar<uint32> hold;
+        AtomicScalar<uint32> handled[NUM_CHANNELS];
+        // Only touched by the main thread
+        uint32 responses[NUM_CHANNELS];
+        uint32 failures;
+        std::set<WorkQueue::RequestID> respondedIDs;
+
+        TestHandler() : hold(0), failures(0)
+        {
+            for (uint16 i = 0; i < NUM_CHANNELS; ++i)
+            {
+                handled[i].set(0);
+                responses[i] = 0;
+            }
+        }
+
+        WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue*)
+        {
+            ++handled[req->getChannel()];
+            if (req->getType() == REQUEST_HOLD)
+            {
+                while (hold.get())
+                    OGRE_THREAD_SLEEP(1);
+            }
+            bool success = req->getType() != REQUEST_FAIL || req->getRetryCount() == 0;
+            return OGRE_NEW WorkQueue::Response(req, success, req->getData());
+        }
+
+        void handleResponse(const WorkQueue::Response* res, const WorkQueue*)
+        {
+            ++responses[res->getRequest()->getChannel()];
+            failures += !res->succeeded();
+            respondedIDs.insert(res->getRequest()->getID());
+        }
+    };
+
+    /// Pumps the responses until the count of responses in the channel is reached
+    bool waitForResponses(WorkQueue* queue, TestHandler& handler, uint16 channel, uint32 count)
+    {
+        Timer timer;
+        while (handler.responses[channel] < count && timer.getMilliseconds() < 10000)
+        {
+            queue->processResponses();
+            OGRE_THREAD_SLEEP(1);
+        }
+        return handler.responses[channel] == count;
+    }
+
+    void testQueue(DefaultWorkQueueBase* queue)
+    {
+        TestHandler handler;
+        queue->setWorkerThreadCount(3);
+        queue->setResponseProcessingTimeLimit(0);
+        queue->startup();
+        for (uint16 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            queue->addRequestHandler(channel, &handler);
+            queue->addResponseHandler(channel, &handler);
+        }
+
+        // More requests than fit in the queues of the work stealing queue
+        const uint32 numRequests = 5000;
+        for (uint32 i = 0; i < numRequests; ++i)
+            EXPECT_NE(0u, queue->addRequest(0, REQUEST_NORMAL, Any(i)));
+        EXPECT_TRUE(waitForResponses(queue, handler, 0, numRequests));
+        EXPECT_EQ(numRequests, handler.handled[0].get());
+        EXPECT_EQ(numRequests, handler.respondedIDs.size());
+        EXPECT_EQ(0u, handler.failures);
+
+        // Retried until the retries run out
+        queue->addRequest(1, REQUEST_FAIL, Any(0), 2);
+        EXPECT_TRUE(waitForResponses(queue, handler, 1, 1));
+        EXPECT_EQ(3u, handler.handled[1].get());
+        EXPECT_EQ(0u, handler.failures);
+
+        // Synchronous requests are answered right away
+        queue->addRequest(1, REQUEST_NORMAL, Any(0), 0, true);
+        EXPECT_EQ(2u, handler.responses[1]);
+
+        // And retried too
+        queue->addRequest(1, REQUEST_FAIL, Any(0), 2, true);
+        EXPECT_TRUE(waitForResponses(queue, handler, 1, 3));
+        EXPECT_EQ(7u, handler.handled[1].get());
+        EXPECT_EQ(0u, handler.failures);
+
+        // Idle requests
+        queue->addRequest(1, REQUEST_NORMAL, Any(0), 0, false, true);
+        EXPECT_TRUE(waitForResponses(queue, handler, 1, 4));
+
+        queue->shutdown();
+        for (uint16 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            queue->removeRequestHandler(channel, &handler);
+            queue->removeResponseHandler(channel, &handler);
+        }
+    }
+
+    void testAbort(DefaultWorkQueueBase* queue)
+    {
+        TestHandler handler;
+        // A single worker processes the requests in order
+        queue->setWorkerThreadCount(1);
+        queue->setResponseProcessingTimeLimit(0);
+        queue->startup();
+        for (uint16 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            queue->addRequestHandler(channel, &handler);
+            queue->addResponseHandler(channel, &handler);
+        }
+
+        handler.hold.set(1);
+        queue->addRequest(1, REQUEST_HOLD, Any(0));
+        Timer timer;
+        while (handler.handled[1].get() == 0 && timer.getMilliseconds() < 10000)
+            OGRE_THREAD_SLEEP(1);
+        ASSERT_EQ(1u, handler.handled[1].get());
+
+        // Queued behind the held request
+        for (int i = 0; i < 10; ++i)
+            queue->addRequest(0, REQUEST_NORMAL, Any(i));
+        WorkQueue::RequestID aborted = queue->addRequest(1, REQUEST_NORMAL, Any(0));
+        WorkQueue::RequestID last = queue->addRequest(1, REQUEST_NORMAL, Any(0));
+
+        queue->abortRequestsByChannel(0);
+        queue->abortRequest(aborted);
+        handler.hold.set(0);
+
+        EXPECT_TRUE(waitForResponses(queue, handler, 1, 2));
+        EXPECT_EQ(1u, handler.respondedIDs.count(last));
+        EXPECT_EQ(0u, handler.respondedIDs.count(aborted));
+        EXPECT_EQ(0u, handler.handled[0].get());
+        EXPECT_EQ(0u, handler.responses[0]);
+
+        queue->shutdown();
+        for (uint16 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            queue->removeRequestHandler(channel, &handler);
+            queue->removeResponseHandler(channel, &handler);
+        }
+    }
+}
+
+TEST_F(WorkQueueTests, DefaultWorkQueue)
+{
+    DefaultWorkQueue queue("Test");
+    testQueue(&queue);
+}
+
+TEST_F(WorkQueueTests, WorkStealingWorkQueue)
+{
+    WorkStealingWorkQueue queue("Test");
+    testQueue(&queue);
+}
+
+TEST_F(WorkQueueTests, DefaultWorkQueueAbort)
+{
+    DefaultWorkQueue queue("Test");
+    testAbort(&queue);
+}
+
+TEST_F(WorkQueueTests, WorkStealingWorkQueueAbort)
+{
+    WorkStealingWorkQueue queue("Test");
+    testAbort(&queue);
+}
+#endif
@@ -50,16 +50,18 @@ void ZipArchiveTests::SetUp()
     cf.load(Ogre::FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
     Ogre::String testPath = cf.getSettings("Tests").begin()->second+"/misc/ArchiveTest.zip";
 
-    arch = OGRE_NEW ZipArchive(testPath, "Zip");
+    ZipArchive::setUseMemoryMapping(GetParam());
+    arch = factory.createInstance(testPath, true);
     arch->load();
 }
 //--------------------------------------------------------------------------
 void ZipArchiveTests::TearDown()
 {
-    OGRE_DELETE arch;
+    factory.destroyInstance(arch);
+    ZipArchive::setUseMemoryMapping(true);
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,ListNonRecursive)
+TEST_P(ZipArchiveTests,ListNonRecursive)
 {
     StringVectorPtr vec = arch->list(false);
 
@@ -70,7 +72,7 @@ TEST_F(ZipArchiveTests,ListNonRecursive)
 
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,ListRecursive)
+TEST_P(ZipArchiveTests,ListRecursive)
 {
     StringVectorPtr vec = arch->list(true);
 
@@ -83,7 +85,7 @@ TEST_F(ZipArchiveTests,ListRecursive)
     EXPECT_EQ(String("rootfile2.txt"), vec->at(5));
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,ListFileInfoNonRecursive)
+TEST_P(ZipArchiveTests,ListFileInfoNonRecursive)
 {
     FileInfoListPtr vec = arch->listFileInfo(false);
 
@@ -101,7 +103,7 @@ TEST_F(ZipArchiveTests,ListFileInfoNonRecursive)
     EXPECT_EQ((size_t)156, fi2.uncompressedSize);
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,ListFileInfoRecursive)
+TEST_P(ZipArchiveTests,ListFileInfoRecursive)
 {
     FileInfoListPtr vec = arch->listFileInfo(true);
 
@@ -143,7 +145,7 @@ TEST_F(ZipArchiveTests,ListFileInfoRecursive)
     EXPECT_EQ((size_t)156, fi2.uncompressedSize);
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,FindNonRecursive)
+TEST_P(ZipArchiveTests,FindNonRecursive)
 {
     StringVectorPtr vec = arch->find("*.txt", false);
 
@@ -152,7 +154,7 @@ TEST_F(ZipArchiveTests,FindNonRecursive)
     EXPECT_EQ(String("rootfile2.txt"), vec->at(1));
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,FindRecursive)
+TEST_P(ZipArchiveTests,FindRecursive)
 {
     StringVectorPtr vec = arch->find("*.material", true);
 
@@ -163,7 +165,7 @@ TEST_F(ZipArchiveTests,FindRecursive)
     EXPECT_EQ(fileId("level2/materials/scripts/file4.material"), vec->at(3));
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,FindFileInfoNonRecursive)
+TEST_P(ZipArchiveTests,FindFileInfoNonRecursive)
 {
     FileInfoListPtr vec = arch->findFileInfo("*.txt", false);
 
@@ -181,7 +183,7 @@ TEST_F(ZipArchiveTests,FindFileInfoNonRecursive)
     EXPECT_EQ((size_t)156, fi2.uncompressedSize);
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,FindFileInfoRecursive)
+TEST_P(ZipArchiveTests,FindFileInfoRecursive)
 {
     FileInfoListPtr vec = arch->findFileInfo("*.material", true);
 
@@ -212,7 +214,7 @@ TEST_F(ZipArchiveTests,FindFileInfoRecursive)
     EXPECT_EQ((size_t)0, fi6.uncompressedSize);
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,FileRead)
+TEST_P(ZipArchiveTests,FileRead)
 {
     DataStreamPtr stream = arch->open("rootfile.txt");
     EXPECT_EQ(String("this is line 1 in file 1"), stream->getLine());
@@ -223,7 +225,7 @@ TEST_F(ZipArchiveTests,FileRead)
     EXPECT_TRUE(stream->eof());
 }
 //--------------------------------------------------------------------------
-TEST_F(ZipArchiveTests,ReadInterleave)
+TEST_P(ZipArchiveTests,ReadInterleave)
 {
     // Test overlapping reads from same archive
     // File 1
@@ -250,3 +252,34 @@ TEST_F(ZipArchiveTests,ReadInterleave)
     EXPECT_TRUE(stream2->eof());
 }
 //--------------------------------------------------------------------------
+TEST_P(ZipArchiveTests,FileSeek)
+{
+    DataStreamPtr stream = arch->open("rootfile2.txt");
+    EXPECT_EQ((size_t)156, stream->size());
+    stream->seek(130);
+    EXPECT_EQ(String("this is line 6 in file 2"), stream->getLine());
+    EXPECT_TRUE(stream->eof());
+    stream->seek(0);
+    EXPECT_EQ(String("this is line 1 in file 2"), stream->getLine());
+}
+//--------------------------------------------------------------------------
+TEST_P(ZipArchiveTests,StoredEmptyFile)
+{
+    DataStreamPtr stream = arch->open("level1/materials/scripts/file.material");
+    EXPECT_EQ((size_t)0, stream->size());
+    EXPECT_TRUE(stream->eof());
+}
+//--------------------------------------------------------------------------
+TEST_P(ZipArchiveTests,Exists)
+{
+    EXPECT_TRUE(arch->exists("rootfile.txt"));
+    EXPECT_TRUE(arch->exists(fileId("level2/materials/scripts/file3.material")));
+    EXPECT_FALSE(arch->exists("missing.txt"));
+}
+//--------------------------------------------------------------------------
+TEST_P(ZipArchiveTests,OpenMissingFile)
+{
+    EXPECT_THROW(arch->open("missing.txt"), FileNotFoundException);
+}
+//--------------------------------------------------------------------------
+INSTANTIATE_TEST_CASE_P(ZipArchive, ZipArchiveTests, ::testing::Bool());
@@ -0,0 +1,113 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Ogre.h"
+#include "OgreFileSystem.h"
+#include "OgrePackArchive.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace Ogre;
+
+void help(void)
+{
+    // Print help message
+    cout << endl << "OgrePackBuilder: Builds a pack for the Pack archive type from a directory." << endl << endl;
+    cout << "Usage: OgrePackBuilder [opts] sourcedir packfile" << endl;
+    cout << "-c chunksize   = Size files are split into, in bytes (default 65536)" << endl;
+    cout << "-q             = Quiet mode, don't list the files" << endl;
+    cout << "sourcedir      = Directory to pack, with all of its subdirectories" << endl;
+    cout << "packfile       = Name of the pack to write" << endl;
+    cout << endl;
+}
+
+int main(int numargs, char** args)
+{
+    uint32 chunkSize = PackArchiveWriter::DEFAULT_CHUNK_SIZE;
+    bool quiet = false;
+    int arg = 1;
+    for (; arg < numargs && args[arg][0] == '-'; ++arg)
+    {
+        String opt = args[arg];
+        if (opt == "-c" && arg + 1 < numargs)
+            chunkSize = StringConverter::parseUnsignedInt(args[++arg]);
+        else if (opt == "-q")
+            quiet = true;
+        else
+        {
+            help();
+            return -1;
+        }
+    }
+    if (numargs - arg != 2)
+    {
+        help();
+        return -1;
+    }
+    String sourceDir = args[arg];
+    String packFile = args[arg + 1];
+
+    LogManager* logMgr = new LogManager();
+    // The log isn't needed, the tool reports to the console
+    logMgr->createLog("OgrePackBuilder.log", true, false, true);
+
+    int ret = 0;
+    try
+    {
+        FileSystemArchive source(sourceDir, "FileSystem", true);
+        source.load();
+
+        String packName, packDir;
+        StringUtil::splitFilename(packFile, packName, packDir);
+        FileSystemArchive output(packDir.empty() ? "." : packDir, "FileSystem", false);
+        output.load();
+
+        PackArchiveWriter writer(output.create(packName), chunkSize);
+        FileInfoListPtr files = source.listFileInfo(true, false);
+        for (FileInfoList::const_iterator i = files->begin(); i != files->end(); ++i)
+        {
+            String filename = i->path + i->basename;
+            if (!quiet)
+                cout << filename << endl;
+            writer.addFile(filename, source.open(filename));
+        }
+        writer.finish();
+
+        cout << files->size() << " files, " << writer.getUncompressedSize() << " bytes packed into "
+             << writer.getSize() << " bytes" << endl;
+    }
+    catch (Exception& e)
+    {
+        cout << "Exception caught: " << e.getDescription() << endl;
+        ret = 1;
+    }
+
+    delete logMgr;
+    return ret;
+}
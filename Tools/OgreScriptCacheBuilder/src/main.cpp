@@ -0,0 +1,123 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Ogre.h"
+#include "OgreConfigFile.h"
+#include "OgreScriptCompiler.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace Ogre;
+
+void help(void)
+{
+    // Print help message
+    cout << endl << "OgreScriptCacheBuilder: Writes the script cache entries of resource groups." << endl << endl;
+    cout << "Usage: OgreScriptCacheBuilder [opts] cachedir" << endl;
+    cout << "-r resourcecfg = Resource locations to read, in the format of resources.cfg" << endl;
+    cout << "                 (default resources.cfg)" << endl;
+    cout << "-g group       = Only cache the scripts of this group (default all groups)" << endl;
+    cout << "cachedir       = Directory to write the entries to, the directory passed to" << endl;
+    cout << "                 ScriptCompilerManager::setScriptCacheDirectory" << endl;
+    cout << endl;
+    cout << "Entries are keyed by group and script name, so the groups and locations have" << endl;
+    cout << "to be the ones the application uses. Scripts using words registered by" << endl;
+    cout << "components, like the RTShaderSystem, are reported as errors and left for the" << endl;
+    cout << "application to cache." << endl;
+    cout << endl;
+}
+
+int main(int numargs, char** args)
+{
+    String resourceCfg = "resources.cfg";
+    String onlyGroup;
+    int arg = 1;
+    for (; arg < numargs && args[arg][0] == '-'; ++arg)
+    {
+        String opt = args[arg];
+        if (opt == "-r" && arg + 1 < numargs)
+            resourceCfg = args[++arg];
+        else if (opt == "-g" && arg + 1 < numargs)
+            onlyGroup = args[++arg];
+        else
+        {
+            help();
+            return -1;
+        }
+    }
+    if (numargs - arg != 1)
+    {
+        help();
+        return -1;
+    }
+    String cacheDir = args[arg];
+
+    int ret = 0;
+    try
+    {
+        // No plugins or render system, the scripts are not translated
+        Root root("", "", "OgreScriptCacheBuilder.log");
+        ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+
+        ConfigFile cf;
+        cf.load(resourceCfg);
+        StringVector groups;
+        ConfigFile::SettingsBySection_::const_iterator seci;
+        for (seci = cf.getSettingsBySection().begin(); seci != cf.getSettingsBySection().end(); ++seci)
+        {
+            if (!onlyGroup.empty() && seci->first != onlyGroup)
+                continue;
+            ConfigFile::SettingsMultiMap::const_iterator i;
+            for (i = seci->second.begin(); i != seci->second.end(); ++i)
+                rgm.addResourceLocation(i->second, i->first, seci->first);
+            if (!seci->second.empty())
+                groups.push_back(seci->first);
+        }
+        if (groups.empty())
+        {
+            cout << "No resource locations found in " << resourceCfg << endl;
+            return 1;
+        }
+
+        ScriptCompilerManager& scm = ScriptCompilerManager::getSingleton();
+        scm.setScriptCacheDirectory(cacheDir);
+        for (StringVector::iterator g = groups.begin(); g != groups.end(); ++g)
+        {
+            size_t numCached = scm.buildScriptCache(*g);
+            cout << *g << ": " << numCached << " scripts cached" << endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        cout << "Exception caught: " << e.getDescription() << endl;
+        ret = 1;
+    }
+
+    return ret;
+}
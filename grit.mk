@@ -74,7 +74,9 @@ OGRESHARED_WEAK_CPP_SRCS= \
 	OgreMain/src/OgreLodStrategyManager.cpp \
 	OgreMain/src/OgreLog.cpp \
 	OgreMain/src/OgreLogManager.cpp \
+	OgreMain/src/OgreLZ4.cpp \
 	OgreMain/src/OgreManualObject.cpp \
+	OgreMain/src/OgreMappedZip.cpp \
 	OgreMain/src/OgreMaterial.cpp \
 	OgreMain/src/OgreMaterialManager.cpp \
 	OgreMain/src/OgreMaterialSerializer.cpp \
@@ -84,6 +86,7 @@ OGRESHARED_WEAK_CPP_SRCS= \
 	OgreMain/src/OgreMemoryAllocatedObject.cpp \
 	OgreMain/src/OgreMemoryNedAlloc.cpp \
 	OgreMain/src/OgreMesh.cpp \
+	OgreMain/src/OgreMeshCacheSerializer.cpp \
 	OgreMain/src/OgreMeshManager.cpp \
 	OgreMain/src/OgreMeshSerializer.cpp \
 	OgreMain/src/OgreMeshSerializerImpl.cpp \
@@ -91,10 +94,13 @@ OGRESHARED_WEAK_CPP_SRCS= \
 	OgreMain/src/OgreMovablePlane.cpp \
 	OgreMain/src/OgreMurmurHash3.cpp \
 	OgreMain/src/OgreNode.cpp \
+	OgreMain/src/OgreNodeTransformStorage.cpp \
 	OgreMain/src/OgreNumerics.cpp \
 	OgreMain/src/OgreOptimisedUtil.cpp \
+	OgreMain/src/OgreOptimisedUtilAVX2.cpp \
 	OgreMain/src/OgreOptimisedUtilGeneral.cpp \
 	OgreMain/src/OgreOptimisedUtilSSE.cpp \
+	OgreMain/src/OgrePackArchive.cpp \
 	OgreMain/src/OgreParticle.cpp \
 	OgreMain/src/OgreParticleEmitterCommands.cpp \
 	OgreMain/src/OgreParticleEmitter.cpp \
@@ -184,7 +190,12 @@ OGRESHARED_WEAK_CPP_SRCS= \
 	OgreMain/src/OgreWireBoundingBox.cpp \
 	OgreMain/src/OgreWorkQueue.cpp \
 	OgreMain/src/OgreZip.cpp \
+	OgreMain/src/Threading/OgreAsyncReadQueue.cpp \
+	OgreMain/src/Threading/OgreBarrierPThreads.cpp \
 	OgreMain/src/Threading/OgreDefaultWorkQueueStandard.cpp \
+	OgreMain/src/Threading/OgreTaskScheduler.cpp \
+	OgreMain/src/Threading/OgreThreadsPThreads.cpp \
+	OgreMain/src/Threading/OgreWorkStealingWorkQueue.cpp \
 
 
 OGRE_WEAK_CPP_SRCS= \